@@ -303,6 +303,13 @@ BOOLEAN doCreateCmd( const CreationStruct* createData, CARDINAL32* LVMError )
          allocationAlgorithm = From_Smallest;
          break;
 
+      case Allocation_Aligned:
+         allocationAlgorithm = Aligned;
+
+         // Convert the specified alignment in KB to 512-byte sectors.  If none was given, the engine uses its default.
+         Set_Partition_Alignment( pCreatePart->pAlignment ? strtol( pCreatePart->pAlignment, (char**)NULL, 0 ) * 2 : 0 );
+         break;
+
       case Allocation_None:
       case Allocation_FreespaceID:
       case Allocation_Error:
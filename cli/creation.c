@@ -203,6 +203,7 @@ BOOLEAN Creation_Parameters(LIST Tokens, pCreationStruct pCreationParameters, pS
                  pPartitionParameters->AllocationOptionType = Allocation_Error;
                  pPartitionParameters->AllocationSubOptionType = Allocation_FromError;
                  pPartitionParameters->pFreespaceID = NULL;   /* @206528 */
+                 pPartitionParameters->pAlignment = NULL;
 
                  pCreationParameters->pParameters = pPartitionParameters;
                  if ( Partition_Parameters(Tokens, pPartitionParameters, pCommandLine) ) {
@@ -576,6 +577,7 @@ static BOOLEAN Optional_Partition_Parameters(LIST Tokens, pPartitionStruct pPart
   Token    CurrentToken;         /* Used to hold the token being examined. */
   CARDINAL Error = 0;            /* Used to hold the error return code from LIST operations. */
   BOOLEAN  ReturnValue = FALSE;  /* Used to hold the function return value. */
+  pSTRING  pAlignment = NULL;
   unsigned int TokenPosition;
 
 
@@ -600,6 +602,37 @@ static BOOLEAN Optional_Partition_Parameters(LIST Tokens, pPartitionStruct pPart
            return ReturnValue;
         } /* endif */
 
+        /* The Aligned option may be followed by the alignment, in KB. */
+        if ( (pPartitionParameters->AllocationOptionType == Allocation_Aligned) && (CurrentToken.TokenType == Number) ) {
+           pAlignment = (pSTRING) malloc(strlen(CurrentToken.pTokenText)+1);
+           if (pAlignment != NULL) {
+             strcpy(pAlignment, CurrentToken.pTokenText);
+             pPartitionParameters->pAlignment = pAlignment;
+           } else {
+              ReportError(Not_Enough_Memory);
+              return ReturnValue;
+           } /* endif */
+
+           /* Number found, advance to next token */
+           NextToken(Tokens,&Error);
+           SkipOptionalWhitespace(Tokens);
+
+           /* The alignment may be followed by a comma and FromStart or FromEnd. */
+           if ( !IsComma(Tokens) ) {
+              /* The next token was NOT a comma but we have a complete command anyway */
+              ReturnValue = TRUE;
+              return ReturnValue;
+           } /* endif */
+
+           SkipOptionalWhitespace(Tokens);
+           GetToken(Tokens,sizeof(Token),&CurrentToken,&TokenPosition,&Error);
+           if ( Error ) {
+              /* Report any errors accessing the token list as an internal error! */
+              ReportError(Internal_Error);
+              return ReturnValue;
+           } /* endif */
+        } /* endif */
+
         /* The token following the comma must be FromStart or FromEnd */
         if ( (CurrentToken.TokenType == FromStart) || (CurrentToken.TokenType == FromEnd) ) {
            /* We have a complete /create command */
@@ -708,6 +741,11 @@ static BOOLEAN CLI_Allocation_Algorithm(LIST Tokens, pPartitionStruct pPartition
        ReturnValue = TRUE;
        NextToken(Tokens,&Error);
        break;
+    case Aligned_CLI:
+       pPartitionParameters->AllocationOptionType = Allocation_Aligned;
+       ReturnValue = TRUE;
+       NextToken(Tokens,&Error);
+       break;
     default:
        /* must satisfy free space id rule */
        if ( Acceptable_Name(Tokens, Comma, &pFreespaceID) ) {
@@ -130,6 +130,9 @@ void PrintTokenType(LIST Tokens)
   case Install    :
     printf("Current Token Type is Install\n");
     break;
+  case Aligned_CLI :
+    printf("Current Token Type is Aligned\n");
+    break;
   case All_CLI    :
     printf("Current Token Type is All\n");
     break;
@@ -331,6 +334,14 @@ BOOLEAN PrintCommands(pCommandStruct pCurrentCommand)
                   case Allocation_FromSmallest:
                      strcat(CommandStr, "FromSmallest");
                      break;
+                  case Allocation_Aligned:
+                     strcat(CommandStr, "Aligned");
+                     if ( ((pPartitionStruct)((pCreationStruct)pCurrentCommand->pCommandData)->pParameters)->pAlignment != NULL ) {
+                        strcat(CommandStr, "(");
+                        strcat(CommandStr, ((pPartitionStruct)((pCreationStruct)pCurrentCommand->pCommandData)->pParameters)->pAlignment);
+                        strcat(CommandStr, ")");
+                     } /* endif */
+                     break;
                   case Allocation_None:
                      strcat(CommandStr, "none specified");
                      break;
@@ -111,6 +111,7 @@ typedef DLIST LIST;
    in the state table.                                                        */
 typedef enum {
                  AcceptableCharsStr,
+                 Aligned_CLI,
                  All_CLI,
                  BestFit,
                  BootDOS,
@@ -100,6 +100,7 @@ typedef struct {
                            | LastFit [, (FromStart|FromEnd)]
                            | FromLargest [, (FromStart|FromEnd)]
                            | FromSmallest [, (FromStart|FromEnd)]
+                           | Aligned [, <Alignment>] [, (FromStart|FromEnd)]
                            | <Free Space ID> [, (FromStart|FromEnd)]
 
 ****************************************************************************/
@@ -112,6 +113,7 @@ typedef enum {
                Allocation_LastFit,
                Allocation_FromLargest,
                Allocation_FromSmallest,
+               Allocation_Aligned,
                Allocation_FreespaceID,
                Allocation_Error
              } AllocationOptionTypes;
@@ -169,6 +171,7 @@ typedef struct {
                   PartitionSubOptionTypes          SubOptionType;
                   AllocationOptionTypes            AllocationOptionType;
                   pSTRING                          pFreespaceID;
+                  pSTRING                          pAlignment;
                   AllocationSubOptionTypes         AllocationSubOptionType;
                } PartitionStruct, * pPartitionStruct;
 
@@ -569,6 +569,10 @@ void FreeCommandMemory(pCommandStruct pCurrentCommand)
                      if ( pPartitionParameters->pFreespaceID != NULL) {
                         free( pPartitionParameters->pFreespaceID );
                      } /* endif */
+
+                     if ( pPartitionParameters->pAlignment != NULL) {
+                        free( pPartitionParameters->pAlignment );
+                     } /* endif */
                   } /* endif */
                   break;
                case Create_Volume_Option:
@@ -145,6 +145,7 @@
 
 /* String value of the LVM reserved words, in uppercase */
 #define  InstallStr        "/INSTALL"
+#define  AlignedStr        "ALIGNED"
 #define  AllStr            "ALL"
 #define  BestFitStr        "BESTFIT"
 #define  BootDOSStr        "BOOTDOS"
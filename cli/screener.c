@@ -98,6 +98,7 @@
 /* This table must always have Eof as its last element */
 Token ReservedWords[] = {
   InstallStr        ,  Install       ,
+  AlignedStr        ,  Aligned_CLI   ,
   AllStr            ,  All_CLI       ,
   BestFitStr        ,  BestFit       ,
   BootDOSStr        ,  BootDOS       ,
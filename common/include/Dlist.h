@@ -53,10 +53,22 @@
  *            void        GoToEndOfList
  *            void        GoToSpecifiedItem
  *            void        SortList
+ *            void        SortListByKey
  *            void        ForEachItem
  *            void        PruneList
  *            void        AppendList
  *            void        TransferItem
+ *            void        GetListPoolStatistics
+ *            void        CreateListIndex
+ *            void        DestroyListIndex
+ *            ADDRESS     FindByKey
+ *            void        ReindexItem
+ *            void        ShareList
+ *            void        LockList
+ *            void        UnlockList
+ *            void        BeginListRead
+ *            ADDRESS     ReadNextObject
+ *            void        EndListRead
  *
  * Description:  This module implements a simple, generic, doubly linked list.
  *               Data objects of any type can be placed into a linked list
@@ -90,6 +102,10 @@
  *
  *         This module is single threaded.  If used in a multi-threaded
  *         environment, the user must implement appropriate access controls.
+ *         The one exception is a list which has been passed to ShareList.
+ *         Any number of threads may walk a shared list, using BeginListRead,
+ *         ReadNextObject and EndListRead, while one thread at a time changes
+ *         it between calls to LockList and UnlockList.
  *
  *         When an item is inserted or appended to a list, this module
  *         allocates memory on the heap to hold the item and then copies
@@ -143,6 +159,13 @@
  *         users of this module should not call free on an object returned by this
  *         module as long as that object is still within a list.
  *
+ *         Small items added to a list by InsertItem are kept inside the
+ *         records this module uses to track items, rather than in memory of
+ *         their own.  Such an item goes away when it is removed from the list,
+ *         even if the FreeMemory parameter of DeleteItem, DeleteAllItems or
+ *         PruneList is FALSE.  ExtractObject and ReplaceObject return a copy
+ *         of such an item on the heap, which then belongs to the caller.
+ *
  *****************************************************************************/
 
 #ifndef DLISTHANDLER
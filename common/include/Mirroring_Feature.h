@@ -0,0 +1,89 @@
+/*
+ *
+ *   Copyright (c) International Business Machines  Corp., 2000
+ *
+ *   This program is free software;  you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY;  without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ *   the GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program;  if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Module: Mirroring_Feature.h
+ */
+
+/*
+ * Change History:
+ *
+ */
+
+/*
+ * Description: Describes the on-disk data structures used for mirroring.
+ *
+ */
+
+
+
+#ifndef MIRRORING_STRUCTURES
+
+#define MIRRORING_STRUCTURES 1
+
+#include "gbltypes.h"
+#include "lvm_types.h"
+
+/* The following defines uniquely identify Mirroring. */
+#define MIRRORING_FEATURE_ID  103
+#define MIRRORING_MAJOR_VERSION  1
+#define MIRRORING_MINOR_VERSION  0
+
+
+/* The following definitions are used for the disk structures supporting mirroring. */
+
+#define MIRROR_TABLE_SIGNATURE   0x5252494DL
+#define MIRROR_BITMAP_SIGNATURE  0x50414D42L
+
+#define MAXIMUM_MIRROR_MEMBERS  4
+
+/* The mirror table is followed by one bitmap sector for each member. */
+#define MIRRORING_RESERVED_SECTOR_COUNT ( 1 + MAXIMUM_MIRROR_MEMBERS )
+
+/* Each member is divided into MIRROR_REGION_COUNT regions of equal size.  A bit set in the bitmap of a member means that the
+   corresponding region of that member missed a write, and must be copied from another member before it can be read.           */
+#define MIRROR_BITMAP_SIZE   500                          /* In bytes.  This fills the rest of the bitmap sector. */
+#define MIRROR_REGION_COUNT  ( MIRROR_BITMAP_SIZE * 8 )
+
+typedef struct _Mirror_Member {
+                                 DoubleWord       Drive_Serial_Number;
+                                 DoubleWord       Partition_Serial_Number;
+                               } Mirror_Member;
+
+typedef struct _LVM_Mirror_Table_Sector {
+                                           DoubleWord         Mirror_Table_Signature;            /* Use the MIRROR_TABLE_SIGNATURE here. */
+                                           DoubleWord         Mirror_Table_CRC;
+                                           DoubleWord         Sequence_Number;                   /* Used to resolve conflicts when the primary and secondary tables do not match. */
+                                           DoubleWord         Members_In_Use;
+                                           DoubleWord         Member_Size;                       /* The number of sectors used on each member.  This is the size of the aggregate. */
+                                           DoubleWord         Region_Size;                       /* The number of sectors covered by each bit in a bitmap. */
+                                           Mirror_Member      Member_Table[MAXIMUM_MIRROR_MEMBERS];
+                                           DoubleWord         Aggregate_Serial_Number;
+                                           LVM_Classes        Actual_Class;                      /* Assigned by LVM.  This should always be Aggregate_Class or something wrong! */
+                                           BOOLEAN            Top_Of_Class;                      /* Assigned by LVM.  */
+                                           CARDINAL32         Feature_Sequence_Number;           /* Assigned by LVM.  */
+                                        } LVM_Mirror_Table_Sector;
+
+typedef struct _LVM_Mirror_Bitmap_Sector {
+                                            DoubleWord         Mirror_Bitmap_Signature;           /* Use the MIRROR_BITMAP_SIGNATURE here. */
+                                            DoubleWord         Mirror_Bitmap_CRC;
+                                            DoubleWord         Sequence_Number;                   /* Must match the Sequence_Number of the mirror table. */
+                                            BYTE               Stale_Regions[MIRROR_BITMAP_SIZE];  /* Bit ( n % 8 ) of byte ( n / 8 ) is set if region n is stale. */
+                                         } LVM_Mirror_Bitmap_Sector;
+
+#endif
+
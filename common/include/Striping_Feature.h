@@ -0,0 +1,84 @@
+/*
+ *
+ *   Copyright (c) International Business Machines  Corp., 2000
+ *
+ *   This program is free software;  you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY;  without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ *   the GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program;  if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Module: Striping_Feature.h
+ */
+
+/*
+ * Change History:
+ *
+ */
+
+/*
+ * Description: Describes the on-disk data structures used for striping.
+ *
+ */
+
+
+#ifndef STRIPING_STRUCTURES
+
+#define STRIPING_STRUCTURES 1
+
+#include "gbltypes.h"
+#include "lvm_types.h"
+
+/* The following defines uniquely identify Striping. */
+#define STRIPING_FEATURE_ID  102
+#define STRIPING_MAJOR_VERSION  1
+#define STRIPING_MINOR_VERSION  0
+
+
+/* The following definitions are used for the disk structures supporting striping. */
+
+#define STRIPE_TABLE_SIGNATURE  0x50525453L
+
+#define MAXIMUM_STRIPE_MEMBERS  32
+
+#define STRIPING_RESERVED_SECTOR_COUNT 1
+
+/* Chunk sizes are in sectors, and must be a power of 2. */
+#define DEFAULT_CHUNK_SIZE  128      /* 64KB */
+#define MINIMUM_CHUNK_SIZE  8        /* 4KB  */
+#define MAXIMUM_CHUNK_SIZE  2048     /* 1MB  */
+
+typedef struct _Stripe_Member {
+                                 DoubleWord       Drive_Serial_Number;
+                                 DoubleWord       Partition_Serial_Number;
+                               } Stripe_Member;
+
+typedef struct _LVM_Stripe_Table_Sector {
+                                           DoubleWord         Stripe_Table_Signature;            /* Use the STRIPE_TABLE_SIGNATURE here. */
+                                           DoubleWord         Stripe_Table_CRC;
+                                           DoubleWord         Sequence_Number;                   /* Used to resolve conflicts when the primary and secondary tables do not match. */
+                                           DoubleWord         Members_In_Use;
+                                           DoubleWord         Chunk_Size;                        /* The number of consecutive sectors placed on a member before moving to the next member. */
+                                           DoubleWord         Member_Size;                       /* The number of sectors used on each member.  This is a multiple of Chunk_Size. */
+                                           Stripe_Member      Member_Table[MAXIMUM_STRIPE_MEMBERS]; /* In stripe order. */
+                                           DoubleWord         Aggregate_Serial_Number;
+                                           LVM_Classes        Actual_Class;                      /* Assigned by LVM.  This should always be Aggregate_Class or something wrong! */
+                                           BOOLEAN            Top_Of_Class;                      /* Assigned by LVM.  */
+                                           CARDINAL32         Feature_Sequence_Number;           /* Assigned by LVM.  */
+                                        } LVM_Stripe_Table_Sector;
+
+/* The initialization data returned by the command line parser and accepted by the Create function. */
+typedef struct _Stripe_Comm_Struct {
+                                     CARDINAL32   Chunk_Size;       /* In sectors. */
+                                   } Stripe_Comm_Struct;
+
+#endif
+
@@ -27,6 +27,8 @@
 /*
  * Functions: CARDINAL32 CalculateCRC
  *            void       Build_CRC_Table
+ *            CARDINAL32 CombineCRC
+ *            CARDINAL32 PatchCRC
  *
  * Description: The functions in this module provide a means of calculating
  *              the 32 bit CRC for a block of data.  Build_CRC_Table must
@@ -129,6 +131,72 @@ void _System Build_CRC_Table( void );
 CARDINAL32 _System CalculateCRC( CARDINAL32 CRC, ADDRESS Buffer, CARDINAL32 BufferSize);
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: CombineCRC                                       */
+/*                                                                   */
+/*   Descriptive Name: This function calculates the CRC of two blocks*/
+/*                     of data placed end to end, given the CRC of   */
+/*                     each block.                                   */
+/*                                                                   */
+/*   Input: CARDINAL32 CRC1 : The CRC of the first block, as returned*/
+/*                            by CalculateCRC.                       */
+/*          CARDINAL32 CRC2 : The CRC of the second block, as        */
+/*                            returned by CalculateCRC when starting */
+/*                            from INITIAL_CRC.                      */
+/*          CARDINAL32 Length2 : The size, in bytes, of the second   */
+/*                               block.                              */
+/*                                                                   */
+/*   Output: The value that CalculateCRC would have returned had it  */
+/*           been called on the second block with CRC1 as its        */
+/*           starting CRC.                                           */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  The time taken depends upon the number of bits in       */
+/*           Length2, not upon its value, so the CRCs of the pieces  */
+/*           of a large buffer may be calculated separately (even at */
+/*           the same time) and then combined cheaply.               */
+/*                                                                   */
+/*********************************************************************/
+CARDINAL32 _System CombineCRC( CARDINAL32 CRC1, CARDINAL32 CRC2, CARDINAL32 Length2 );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: PatchCRC                                         */
+/*                                                                   */
+/*   Descriptive Name: This function updates the CRC of a buffer to  */
+/*                     account for a change to some of the bytes in  */
+/*                     the buffer, without processing the rest of the*/
+/*                     buffer.                                       */
+/*                                                                   */
+/*   Input: CARDINAL32 Old_CRC : The CRC of the buffer before the    */
+/*                               change.                             */
+/*          CARDINAL32 BufferSize : The size of the buffer, in bytes.*/
+/*          CARDINAL32 Offset : The offset, within the buffer, of the*/
+/*                              first byte changed.                  */
+/*          ADDRESS Old_Bytes : The bytes which were at Offset.      */
+/*          ADDRESS New_Bytes : The bytes which are now at Offset.   */
+/*          CARDINAL32 Count : The number of bytes changed.          */
+/*                                                                   */
+/*   Output: The CRC of the buffer after the change.                 */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  Old_CRC may have been calculated from any starting CRC. */
+/*           The result is the same as calling CalculateCRC on the   */
+/*           changed buffer from that starting CRC.  Offset + Count  */
+/*           must not exceed BufferSize.                             */
+/*                                                                   */
+/*********************************************************************/
+CARDINAL32 _System PatchCRC( CARDINAL32 Old_CRC, CARDINAL32 BufferSize, CARDINAL32 Offset, ADDRESS Old_Bytes, ADDRESS New_Bytes, CARDINAL32 Count );
+
+
 #endif
 
 
@@ -34,7 +34,8 @@
  * Description: This module provides a uniform way for creating a handle
  *              and associating it with something.
  *
- * Notes: This module makes use of DLIST.
+ * Notes: Handles are generation checked, so a handle which has been
+ *        destroyed is rejected by Translate_Handle.
  *
  */
 
@@ -193,14 +194,14 @@ void _System Destroy_All_Handles( CARDINAL32 * Error_Code );
 /*           If there is a failure, *Error will contain a non-zero   */
 /*              error code.                                          */
 /*                                                                   */
-/*   Error Handling: *Error_Code will be non-zero if a recoverable   */
-/*                   error occurs.  If Handle is invalid, then a     */
-/*                   trap or exception may occur.                    */
+/*   Error Handling: *Error_Code will be HANDLE_MANAGER_BAD_HANDLE   */
+/*                   if Handle was never created or has already been */
+/*                   destroyed.                                      */
 /*                                                                   */
-/*   Side Effects: If Handle is invalid, a trap or exception may     */
-/*                 occur.                                            */
+/*   Side Effects: None.                                             */
 /*                                                                   */
-/*   Notes:  None.                                                   */
+/*   Notes:  The Handle Manager is not changed by this function, so  */
+/*           a translation can be done while another is in progress. */
 /*                                                                   */
 /*********************************************************************/
 void _System Translate_Handle( ADDRESS Handle, ADDRESS * Object, TAG * ObjectTag, CARDINAL32 * Error_Code );
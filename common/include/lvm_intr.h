@@ -109,6 +109,12 @@ typedef struct _Drive_Information_Record {
                                             char         Drive_Name[DISK_NAME_SIZE];     /* User assigned name for this disk drive. */
                                          } Drive_Information_Record;
 
+/* The following structure is returned by the Get_Drive_Status_Array function. */
+typedef struct _Drive_Information_Array{
+                                         Drive_Information_Record *  Drive_Information_Data;   /* An array of drive information records. */
+                                         CARDINAL32                  Count;                    /* The number of entries in the array of drive information records. */
+                                       } Drive_Information_Array;
+
 typedef struct _Partition_Information_Record {
                                                 ADDRESS      Partition_Handle;                      /* The handle used to perform operations on this partition. */
                                                 ADDRESS      Volume_Handle;                         /* If this partition is part of a volume, this will be the handle of
@@ -247,6 +253,12 @@ typedef struct _Volume_Information_Record {
                                              char       File_System_Name[FILESYSTEM_NAME_SIZE];/* The name of the filesystem in use on this partition, if it is known. */
                                           } Volume_Information_Record;
 
+/* The following structure is returned by the Get_Volume_Information_Array function. */
+typedef struct _Volume_Information_Array{
+                                           Volume_Information_Record * Volume_Information_Data;  /* An array of volume information records. */
+                                           CARDINAL32                  Count;                    /* The number of entries in the array of volume information records. */
+                                         } Volume_Information_Array;
+
 
 /* The following structure is used to return the feature information for the installed features, or the features on a volume. */
 typedef struct _Feature_Information_Array {
@@ -336,9 +348,15 @@ typedef enum _Allocation_Algorithm {
                                       Last_Fit,                /* Use the last block of free space on the disk which is large enough to hold a partition of the specified size. */
                                       From_Largest,            /* Find the largest block of free space and allocate the partition from that block of free space. */
                                       From_Smallest,           /* Find the smallest block of free space that can accommodate a partition of the size specified. */
-                                      All                      /* Turn the specified drive or block of free space into a single partition. */
+                                      All,                     /* Turn the specified drive or block of free space into a single partition. */
+                                      Aligned                  /* Use the first block of free space which can hold the partition with its start and size
+                                                                  both multiples of the partition alignment.  See Set_Partition_Alignment.                 */
                                    } Allocation_Algorithm;
 
+/* The following is the partition alignment, in sectors, used by the Aligned allocation algorithm unless Set_Partition_Alignment is used to change it.
+   2048 sectors is 1 MB, which is a multiple of the sector size of 4K sector disks and of the erase block size of most SSDs.                          */
+#define DEFAULT_PARTITION_ALIGNMENT  2048
+
 
 /* Error codes returned by the LVM Engine. */
 #define LVM_ENGINE_NO_ERROR                            0
@@ -910,6 +928,53 @@ Drive_Control_Array _System Get_Drive_Control_Data( CARDINAL32 * Error_Code );
 Drive_Information_Record _System Get_Drive_Status( ADDRESS Drive_Handle, CARDINAL32 * Error_Code );
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  Get_Drive_Status_Array                          */
+/*                                                                   */
+/*   Descriptive Name:  Returns the Drive_Information_Records for a  */
+/*                      group of drives in a single array.           */
+/*                                                                   */
+/*   Input: ADDRESS Drive_Handles[] - The handles of the drives to   */
+/*                             use.  If this is NULL, then the       */
+/*                             records for all of the drives are     */
+/*                             returned.                             */
+/*          CARDINAL32 Count - The number of entries in              */
+/*                             Drive_Handles.  This is ignored if    */
+/*                             Drive_Handles is NULL.                */
+/*          CARDINAL32 * Error_Code - The address of a CARDINAL32 in */
+/*                                    in which to store an error code*/
+/*                                    should an error occur.         */
+/*                                                                   */
+/*   Output: A Drive_Information_Array is returned.  If no errors    */
+/*           occur, the Nth entry of Drive_Information_Data will be  */
+/*           the record for the Nth entry of Drive_Handles, and      */
+/*           *Error_Code will be set to 0.  If an error does occur,  */
+/*           then *Error_Code will be non-zero.                      */
+/*                                                                   */
+/*   Error Handling:  If any entry of Drive_Handles is not the handle*/
+/*                    of a drive, *Error_Code will be                */
+/*                    LVM_ENGINE_BAD_HANDLE.  Any memory allocated   */
+/*                    for the return value will be freed, and the    */
+/*                    Drive_Information_Array returned will have a   */
+/*                    NULL Drive_Information_Data and a Count of 0.  */
+/*                                                                   */
+/*   Side Effects:  Memory for the returned array is allocated.      */
+/*                                                                   */
+/*   Notes:  This does the work of calling Get_Drive_Status for each */
+/*           handle, but with one entry into the engine and one      */
+/*           allocation.  When Drive_Handles is NULL, the records    */
+/*           are in the same order as the records returned by        */
+/*           Get_Drive_Control_Data.                                 */
+/*                                                                   */
+/*           The caller becomes responsible for the memory allocated */
+/*           for Drive_Information_Data, and should free it with     */
+/*           Free_Engine_Memory when they are done using it.         */
+/*                                                                   */
+/*********************************************************************/
+Drive_Information_Array _System Get_Drive_Status_Array( ADDRESS Drive_Handles[], CARDINAL32 Count, CARDINAL32 * Error_Code );
+
+
 
 
 /* ************************************************************************** *
@@ -1038,6 +1103,59 @@ ADDRESS _System Get_Partition_Handle( CARDINAL32 Serial_Number, CARDINAL32 * Err
 Partition_Information_Record  _System Get_Partition_Information( ADDRESS Partition_Handle, CARDINAL32 * Error_Code );
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Get_Partition_Information_Array                  */
+/*                                                                   */
+/*   Descriptive Name: Returns the Partition_Information_Records for */
+/*                     a group of partitions in a single array.      */
+/*                                                                   */
+/*   Input: ADDRESS Partition_Handles[] - The handles of the         */
+/*                                        partitions whose           */
+/*                                        Partition_Information_     */
+/*                                        Records are desired.  If   */
+/*                                        this is NULL, then the     */
+/*                                        records for all of the     */
+/*                                        partitions and blocks of   */
+/*                                        free space on all of the   */
+/*                                        drives are returned.       */
+/*          CARDINAL32 Count - The number of entries in              */
+/*                             Partition_Handles.  This is ignored   */
+/*                             if Partition_Handles is NULL.         */
+/*          CARDINAL32 * Error_Code - The address of a CARDINAL32 in */
+/*                                    in which to store an error code*/
+/*                                    should an error occur.         */
+/*                                                                   */
+/*   Output: A Partition_Information_Array is returned.  If there is */
+/*           no error, then the Nth entry of Partition_Array will be */
+/*           the record for the Nth entry of Partition_Handles, and  */
+/*           *Error_Code will be 0.  If an error occurs, *Error_Code */
+/*           will be non-zero.                                       */
+/*                                                                   */
+/*   Error Handling: If any entry of Partition_Handles is not the    */
+/*                   handle of a partition, *Error_Code will be      */
+/*                   LVM_ENGINE_BAD_HANDLE.  Any memory allocated for*/
+/*                   the return value will be freed, and the         */
+/*                   Partition_Information_Array returned will have a*/
+/*                   NULL Partition_Array and a Count of 0.          */
+/*                                                                   */
+/*   Side Effects:  Memory will be allocated to hold the array       */
+/*                  returned by this function.                       */
+/*                                                                   */
+/*   Notes:  This does the work of calling Get_Partition_Information */
+/*           for each handle, but with one entry into the engine and */
+/*           one allocation.  When Partition_Handles is NULL, the    */
+/*           records are in drive order, and the records for each    */
+/*           drive are in the order that Get_Partitions returns them.*/
+/*                                                                   */
+/*           The caller becomes responsible for the memory allocated */
+/*           for Partition_Array, and should free it with            */
+/*           Free_Engine_Memory when they are done using it.         */
+/*                                                                   */
+/*********************************************************************/
+Partition_Information_Array _System Get_Partition_Information_Array( ADDRESS Partition_Handles[], CARDINAL32 Count, CARDINAL32 * Error_Code );
+
+
 /*********************************************************************/
 /*                                                                   */
 /*   Function Name: Create_Partition                                 */
@@ -1045,7 +1163,12 @@ Partition_Information_Record  _System Get_Partition_Information( ADDRESS Partiti
 /*   Descriptive Name: Creates a partition on a disk drive.          */
 /*                                                                   */
 /*   Input: ADDRESS         Handle - The handle of a disk drive or   */
-/*                                   a block of free space.          */
+/*                                   a block of free space.  If      */
+/*                                   Handle is NULL, then the engine */
+/*                                   will use the block of free      */
+/*                                   space, on any drive, which is   */
+/*                                   closest in size to the          */
+/*                                   partition.                      */
 /*          CARDINAL32      Size - The size, in sectors, of the      */
 /*                                 partition to create.              */
 /*          char            Name[] - The name to give to the newly   */
@@ -1058,6 +1181,10 @@ Partition_Information_Record  _System Get_Partition_Information( ADDRESS Partiti
 /*                                           tells the engine which  */
 /*                                           memory management       */
 /*                                           algorithm to use.       */
+/*                                           If Handle is NULL,      */
+/*                                           then this must be       */
+/*                                           Automatic or            */
+/*                                           Best_Fit.               */
 /*          BOOLEAN         Bootable - If TRUE, then the engine will */
 /*                                     only create the partition if  */
 /*                                     it can be booted from.  If    */
@@ -1123,6 +1250,36 @@ ADDRESS _System Create_Partition( ADDRESS               Handle,
                                 );
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Get_Alignment_Waste                              */
+/*                                                                   */
+/*   Descriptive Name: Returns the number of sectors that were left  */
+/*                     unused by the last partition created with the */
+/*                     Aligned allocation algorithm.                 */
+/*                                                                   */
+/*   Input: None.                                                    */
+/*                                                                   */
+/*   Output: The number of sectors skipped, between the edge of the  */
+/*           block of free space that the partition was allocated    */
+/*           from and the partition itself, to align the partition.  */
+/*           This is 0 if the last call to Create_Partition failed or*/
+/*           did not use the Aligned allocation algorithm.           */
+/*                                                                   */
+/*   Error Handling: None required.                                  */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: The sectors counted are not lost.  They remain free      */
+/*          space, but they are too few to hold an aligned partition.*/
+/*          The extra sectors added to round the size of a partition */
+/*          up to a multiple of the partition alignment are part of  */
+/*          the partition, so they are not counted.                  */
+/*                                                                   */
+/*********************************************************************/
+CARDINAL32 _System Get_Alignment_Waste( void );
+
+
 /*********************************************************************/
 /*                                                                   */
 /*   Function Name: Delete_Partition                                 */
@@ -1334,6 +1491,56 @@ Volume_Control_Array _System Get_Volume_Control_Data( CARDINAL32 * Error_Code );
 Volume_Information_Record _System Get_Volume_Information( ADDRESS Volume_Handle, CARDINAL32 * Error_Code );
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Get_Volume_Information_Array                     */
+/*                                                                   */
+/*   Descriptive Name:  Returns the Volume_Information_Records for a */
+/*                      group of volumes in a single array.          */
+/*                                                                   */
+/*   Input: ADDRESS Volume_Handles[] - The handles of the volumes    */
+/*                                     about which information is    */
+/*                                     desired.  If this is NULL,    */
+/*                                     then the records for all of   */
+/*                                     the volumes are returned.     */
+/*          CARDINAL32 Count - The number of entries in              */
+/*                             Volume_Handles.  This is ignored if   */
+/*                             Volume_Handles is NULL.               */
+/*          CARDINAL32 * Error_Code - The address of a CARDINAL32 in */
+/*                                    in which to store an error code*/
+/*                                    should an error occur.         */
+/*                                                                   */
+/*   Output: A Volume_Information_Array is returned.  If there is no */
+/*           error, then the Nth entry of Volume_Information_Data    */
+/*           will be the record for the Nth entry of Volume_Handles, */
+/*           and *Error_Code will be 0.  If an error occurs, then    */
+/*           *Error_Code will be > 0.                                */
+/*                                                                   */
+/*   Error Handling:  If any entry of Volume_Handles is not the      */
+/*                    handle of a volume, *Error_Code will be        */
+/*                    LVM_ENGINE_BAD_HANDLE.  Any memory allocated   */
+/*                    for the return value will be freed, and the    */
+/*                    Volume_Information_Array returned will have a  */
+/*                    NULL Volume_Information_Data and a Count of 0. */
+/*                                                                   */
+/*   Side Effects:  Memory for the returned array is allocated.  If  */
+/*                  Volume_Handles is NULL, the Volumes list is      */
+/*                  sorted as it is by Get_Volume_Control_Data.      */
+/*                                                                   */
+/*   Notes:  This does the work of calling Get_Volume_Information    */
+/*           for each handle, but with one entry into the engine and */
+/*           one allocation.  When Volume_Handles is NULL, the       */
+/*           records are in the same order as the records returned   */
+/*           by Get_Volume_Control_Data.                             */
+/*                                                                   */
+/*           The caller becomes responsible for the memory allocated */
+/*           for Volume_Information_Data, and should free it with    */
+/*           Free_Engine_Memory when they are done using it.         */
+/*                                                                   */
+/*********************************************************************/
+Volume_Information_Array _System Get_Volume_Information_Array( ADDRESS Volume_Handles[], CARDINAL32 Count, CARDINAL32 * Error_Code );
+
+
 /*********************************************************************/
 /*                                                                   */
 /*   Function Name: Create_Volume                                    */
@@ -2765,6 +2972,34 @@ void _System Set_Min_Install_Size ( CARDINAL32  Min_Sectors );
 void _System Set_Free_Space_Threshold( CARDINAL32  Min_Sectors );
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Set_Partition_Alignment                          */
+/*                                                                   */
+/*   Descriptive Name: This function tells the LVM Engine what       */
+/*                     boundary to align partitions on when they are */
+/*                     created using the Aligned allocation          */
+/*                     algorithm.  The engine defaults to            */
+/*                     DEFAULT_PARTITION_ALIGNMENT, which is 2048    */
+/*                     sectors (1 MB).                               */
+/*                                                                   */
+/*   Input: CARDINAL32 Alignment_Sectors - The alignment, in sectors.*/
+/*                                         If this is 0, then the    */
+/*                                         default alignment is used.*/
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None required.                                  */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: The alignment does not have to be a power of 2, so it can*/
+/*          be set to the full stripe size of a RAID array.          */
+/*                                                                   */
+/*********************************************************************/
+void _System Set_Partition_Alignment( CARDINAL32  Alignment_Sectors );
+
+
 /*********************************************************************/
 /*                                                                   */
 /*   Function Name: Read_Sectors                                     */
@@ -2834,7 +3069,9 @@ void _System Read_Sectors ( CARDINAL32          Drive_Number,
 /*                                                                   */
 /*   Error Handling: *Error will be > 0 if an error occurs.          */
 /*                                                                   */
-/*   Side Effects: Data may be written to disk.                      */
+/*   Side Effects: Data may be written to disk.  Any other sectors   */
+/*                 on the drive which are waiting to be written by   */
+/*                 the LVM Engine are written to disk as well.       */
 /*                                                                   */
 /*   Notes:  None.                                                   */
 /*                                                                   */
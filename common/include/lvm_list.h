@@ -52,10 +52,22 @@
  *            void        GoToEndOfList
  *            void        GoToSpecifiedItem
  *            void        SortList
+ *            void        SortListByKey
  *            void        ForEachItem
  *            void        PruneList
  *            void        AppendList
  *            void        TransferItem
+ *            void        GetListPoolStatistics
+ *            void        CreateListIndex
+ *            void        DestroyListIndex
+ *            ADDRESS     FindByKey
+ *            void        ReindexItem
+ *            void        ShareList
+ *            void        LockList
+ *            void        UnlockList
+ *            void        BeginListRead
+ *            ADDRESS     ReadNextObject
+ *            void        EndListRead
  *
  * Description:  This module implements a simple, generic, doubly linked list.
  *               Data objects of any type can be placed into a linked list
@@ -89,6 +101,10 @@
  *
  *         This module is single threaded.  If used in a multi-threaded
  *         environment, the user must implement appropriate access controls.
+ *         The one exception is a list which has been passed to ShareList.
+ *         Any number of threads may walk a shared list, using BeginListRead,
+ *         ReadNextObject and EndListRead, while one thread at a time changes
+ *         it between calls to LockList and UnlockList.
  *
  *         When an item is inserted or appended to a list, this module
  *         allocates memory on the heap to hold the item and then copies
@@ -142,6 +158,13 @@
  *         users of this module should not call free on an object returned by this
  *         module as long as that object is still within a list.
  *
+ *         Small items added to a list by InsertItem are kept inside the
+ *         records this module uses to track items, rather than in memory of
+ *         their own.  Such an item goes away when it is removed from the list,
+ *         even if the FreeMemory parameter of DeleteItem, DeleteAllItems or
+ *         PruneList is FALSE.  ExtractObject and ReplaceObject return a copy
+ *         of such an item on the heap, which then belongs to the caller.
+ *
  *
  */
 
@@ -171,6 +194,34 @@ typedef enum _Insertion_Modes {
                                 AppendToList,
                               } Insertion_Modes;
 
+/* The following structure holds the counters kept for the pool of link nodes belonging to a DLIST.  See GetListPoolStatistics. */
+typedef struct _DLIST_Pool_Statistics {
+                                         CARDINAL32   Slab_Count;          /* The number of slabs in the pool. */
+                                         CARDINAL32   Node_Count;          /* The number of link nodes in those slabs. */
+                                         CARDINAL32   Nodes_In_Use;        /* The number of link nodes from the pool in use, by this or any other list. */
+                                         CARDINAL32   Peak_Nodes_In_Use;   /* The highest value Nodes_In_Use has reached. */
+                                         CARDINAL32   Node_Allocations;    /* The number of link nodes taken from the pool. */
+                                         CARDINAL32   Slabs_Allocated;     /* The number of slabs added to the pool. */
+                                         CARDINAL32   Slabs_Freed;         /* The number of slabs freed while the list was in use. */
+                                       } DLIST_Pool_Statistics;
+
+/* The following type describes the function used by the index of a DLIST to find the key of an item.  See CreateListIndex.
+   The function returns TRUE and sets *Key and *KeySize if the item has a key.  The key must be part of the item itself, or
+   be otherwise stable for as long as the item is in the list.  If the function returns FALSE, the item is not indexed.        */
+typedef BOOLEAN (* _System DLIST_Key_Function) (ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS * Key, CARDINAL32 * KeySize);
+
+/* The following type describes the function used by SortListByKey to find the sort key of an item.  The function returns the
+   key of the item.  If it sets *Error to a non-zero value, SortListByKey stops and returns that error code.                     */
+typedef CARDINAL32 (* _System DLIST_Sort_Key_Function) (ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, CARDINAL32 * Error);
+
+/* The following structure is the cursor used by a thread reading a shared DLIST.  See BeginListRead.  Its fields are for the
+   use of this module only.                                                                                                   */
+typedef struct _DLIST_Reader {
+                                DLIST        List;         /* The list being read. */
+                                ADDRESS      Position;     /* The item last returned by ReadNextObject, or NULL. */
+                                CARDINAL32   Slot;         /* The reader slot claimed by BeginListRead. */
+                             } DLIST_Reader;
+
 
 /************************************************
  *           Functions Available                *
@@ -196,6 +247,10 @@ typedef enum _Insertion_Modes {
  *    11 : Already at start of list!
  *    12 : Bad Handle!
  *    13 : Invalid Insertion Mode!
+ *    14 : List has no index!
+ *    15 : List is not shared!
+ *    16 : Too many readers!
+ *    17 : Operation not allowed on a shared list!
  */
 
 #define DLIST_SUCCESS                    0
@@ -212,6 +267,10 @@ typedef enum _Insertion_Modes {
 #define DLIST_ALREADY_AT_START          11
 #define DLIST_BAD_HANDLE                12
 #define DLIST_INVALID_INSERTION_MODE    13
+#define DLIST_NO_INDEX                  14
+#define DLIST_NOT_SHARED                15
+#define DLIST_TOO_MANY_READERS          16
+#define DLIST_LIST_IS_SHARED            17
 
 
 /* The following code is special.  It is for use with the PruneList and ForEachItem functions.  Basically, these functions
@@ -224,6 +283,52 @@ typedef enum _Insertion_Modes {
 #define DLIST_SEARCH_COMPLETE  0xFF
 
 
+/* The DLIST_FOREACH macros walk a list in place, without calling a function for each item the way ForEachItem does.  This
+   lets the compiler inline the body of the loop.  Handle must be a variable of type ADDRESS.  On each pass through the loop,
+   Handle is the handle of an item in the list, and DLIST_HANDLE_OBJECT, DLIST_HANDLE_TAG and DLIST_HANDLE_SIZE give the item,
+   its tag, and its size.  The current item in the list is not changed.
+
+   No checks are made on the list, so the list must be valid.  The body of a DLIST_FOREACH or DLIST_FOREACH_REVERSE loop must
+   not remove the item referred to by Handle from the list.  DLIST_FOREACH_SAFE saves the handle of the next item before the
+   body is run, so the body may remove the item referred to by Handle, but no other item.
+
+   The following structures describe the leading fields of the records this module uses for lists and items.  They are here
+   only for the use of these macros and must never be used to modify a list.                                                   */
+typedef struct _DLIST_Item_View {
+                                   ADDRESS                    Object;      /* The item. */
+                                   CARDINAL32                 ObjectSize;  /* The size of the item. */
+                                   TAG                        ObjectTag;   /* The tag of the item. */
+                                   ADDRESS                    List;        /* The list containing the item. */
+                                   struct _DLIST_Item_View *  Next;        /* The next item in the list. */
+                                   struct _DLIST_Item_View *  Previous;    /* The previous item in the list. */
+                                 } DLIST_Item_View;
+
+typedef struct _DLIST_List_View {
+                                   CARDINAL32                 ItemCount;   /* The number of items in the list. */
+                                   DLIST_Item_View *          First;       /* The first item in the list. */
+                                   DLIST_Item_View *          Last;        /* The last item in the list. */
+                                 } DLIST_List_View;
+
+#define DLIST_FIRST_HANDLE( List )          ( (ADDRESS) ( (DLIST_List_View *) (List) )->First )
+#define DLIST_LAST_HANDLE( List )           ( (ADDRESS) ( (DLIST_List_View *) (List) )->Last )
+#define DLIST_NEXT_HANDLE( Handle )         ( (ADDRESS) ( (DLIST_Item_View *) (Handle) )->Next )
+#define DLIST_PREVIOUS_HANDLE( Handle )     ( (ADDRESS) ( (DLIST_Item_View *) (Handle) )->Previous )
+#define DLIST_HANDLE_OBJECT( Handle )       ( ( (DLIST_Item_View *) (Handle) )->Object )
+#define DLIST_HANDLE_TAG( Handle )          ( ( (DLIST_Item_View *) (Handle) )->ObjectTag )
+#define DLIST_HANDLE_SIZE( Handle )         ( ( (DLIST_Item_View *) (Handle) )->ObjectSize )
+
+#define DLIST_FOREACH( List, Handle )                                                        \
+        for ( (Handle) = DLIST_FIRST_HANDLE( List ); (Handle) != NULL; (Handle) = DLIST_NEXT_HANDLE( Handle ) )
+
+#define DLIST_FOREACH_REVERSE( List, Handle )                                                \
+        for ( (Handle) = DLIST_LAST_HANDLE( List ); (Handle) != NULL; (Handle) = DLIST_PREVIOUS_HANDLE( Handle ) )
+
+#define DLIST_FOREACH_SAFE( List, Handle, Next_Handle )                                      \
+        for ( (Handle) = DLIST_FIRST_HANDLE( List );                                         \
+              ( (Handle) != NULL ) && ( ( (Next_Handle) = DLIST_NEXT_HANDLE( Handle ) ), TRUE ); \
+              (Handle) = (Next_Handle) )
+
+
 #ifdef USE_POOLMAN
 
 /*********************************************************************/
@@ -376,6 +481,11 @@ DLIST _System CreateList( void );
 /*           DLISTs.  However, a pointer to a local variable         */
 /*           should not be appended to the DLIST.                    */
 /*                                                                   */
+/*           Items of up to 16 bytes are copied into the record the  */
+/*           list keeps for the item instead of into a block of      */
+/*           memory of their own.  The address of such an item is    */
+/*           only valid while the item is in the list.               */
+/*                                                                   */
 /*           It is assumed that TargetHandle is valid, or is at least*/
 /*           the address of an accessible block of storage.  If      */
 /*           TargetHandle is invalid, or is not the address of an    */
@@ -1220,6 +1330,7 @@ ADDRESS _System ExtractObject( DLIST          ListToGetItemFrom,
 /*                         The memory required can not be allocated. */
 /*                         Handle is invalid, or is for an item      */
 /*                             which is not in ListToGetItemFrom     */
+/*                         ListToReplaceItemIn is a shared list      */
 /*                    If any of these conditions occurs, *Error      */
 /*                    will contain a non-zero error code.            */
 /*                                                                   */
@@ -1293,6 +1404,7 @@ void _System ReplaceItem( DLIST         ListToReplaceItemIn,
 /*                         The memory required can not be allocated. */
 /*                         Handle is invalid, or is for an item      */
 /*                             which is not in ListToGetItemFrom     */
+/*                         ListToReplaceItemIn is a shared list      */
 /*                    If any of these conditions occurs, *Error      */
 /*                    will contain a non-zero error code.            */
 /*                                                                   */
@@ -1778,9 +1890,9 @@ void _System GoToSpecifiedItem( DLIST ListToReposition, ADDRESS Handle, CARDINAL
 /*   Function Name:  SortList                                        */
 /*                                                                   */
 /*   Descriptive Name:  This function sorts the contents of a list.  */
-/*                      The sorting algorithm used is a stable sort  */
-/*                      whose performance is not dependent upon the  */
-/*                      initial order of the items in the list.      */
+/*                      The sorting algorithm used is a stable sort. */
+/*                      Lists which are already in order, or nearly  */
+/*                      so, are sorted with very few comparisons.    */
 /*                                                                   */
 /*   Input: DLIST ListToSort : The DLIST that is to be sorted.       */
 /*                                                                   */
@@ -1824,7 +1936,9 @@ void _System GoToSpecifiedItem( DLIST ListToReposition, ADDRESS Handle, CARDINAL
 /*                   is invalid.  If this function does terminate in */
 /*                   the middle of a sort, the order of the items in */
 /*                   ListToSort may be different than it was before  */
-/*                   the function was called.                        */
+/*                   the function was called.  It fails with         */
+/*                   DLIST_LIST_IS_SHARED if ListToSort is a shared  */
+/*                   list.                                           */
 /*                                                                   */
 /*   Side Effects: None.                                             */
 /*                                                                   */
@@ -1838,6 +1952,54 @@ void _System SortList(DLIST        ListToSort,
                       CARDINAL32 * Error);
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  SortListByKey                                   */
+/*                                                                   */
+/*   Descriptive Name:  This function sorts the contents of a list   */
+/*                      into ascending order by an integer key.      */
+/*                      The sort is stable, so items with the same   */
+/*                      key keep their order relative to each other. */
+/*                                                                   */
+/*   Input: DLIST ListToSort : The DLIST that is to be sorted.       */
+/*          DLIST_Sort_Key_Function GetSortKey : The function which  */
+/*                                  returns the sort key of an item. */
+/*                                  It is normally called once for   */
+/*                                  each item in the list.  If it    */
+/*                                  sets its Error parameter to a    */
+/*                                  non-zero value, the sort is      */
+/*                                  abandoned and that error code is */
+/*                                  returned.                        */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return value.             */
+/*                                                                   */
+/*   Output:  If successful, this function will set *Error to        */
+/*               DLIST_SUCCESS and ListToSort will have been sorted. */
+/*            If unsuccessful, *Error will contain an error code.    */
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToSort is        */
+/*                   invalid or if GetSortKey reports an error.  If  */
+/*                   GetSortKey reports an error, the items in       */
+/*                   ListToSort are normally left in their original  */
+/*                   order.  It fails with DLIST_LIST_IS_SHARED if   */
+/*                   ListToSort is a shared list.                    */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  It is assumed that Error contains a valid address. If   */
+/*           this assumption is violated, an exception or trap       */
+/*           may occur.                                              */
+/*                                                                   */
+/*           Since the key of each item is only obtained once and no */
+/*           comparison function is called, this is much faster than */
+/*           SortList for items which can be ordered by an integer.  */
+/*                                                                   */
+/*********************************************************************/
+void _System SortListByKey( DLIST                     ListToSort,
+                            DLIST_Sort_Key_Function   GetSortKey,
+                            CARDINAL32 *              Error );
+
+
 /*********************************************************************/
 /*                                                                   */
 /*   Function Name:  ForEachItem                                     */
@@ -2067,6 +2229,8 @@ void _System PruneList(DLIST        ListToProcess,
 /*                    SourceList are appended to TargetList, so if an*/
 /*                    error is detected and the function aborts,     */
 /*                    SourceList and TargetList are unaltered.       */
+/*                    It fails with DLIST_LIST_IS_SHARED if either   */
+/*                    SourceList or TargetList is a shared list.     */
 /*                                                                   */
 /*   Side Effects: None.                                             */
 /*                                                                   */
@@ -2125,6 +2289,8 @@ void _System AppendList(DLIST        TargetList,
 /*                    SourceList are appended to TargetList, so if an*/
 /*                    error is detected and the function aborts,     */
 /*                    SourceList and TargetList are unaltered.       */
+/*                    It fails with DLIST_LIST_IS_SHARED if either   */
+/*                    SourceList or TargetList is a shared list.     */
 /*                                                                   */
 /*   Side Effects: None.                                             */
 /*                                                                   */
@@ -2167,5 +2333,404 @@ void _System TransferItem(DLIST             SourceList,
 BOOLEAN _System CheckListIntegrity(DLIST ListToCheck);
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  CreateListIndex                                 */
+/*                                                                   */
+/*   Descriptive Name: Attaches an index to a DLIST so that items    */
+/*                     can be found by key using FindByKey.          */
+/*                                                                   */
+/*   Input:  DLIST ListToIndex : The list to create an index for.    */
+/*           DLIST_Key_Function GetKey : The function which returns  */
+/*                               the key of an item in the list.     */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, *Error will be set to DLIST_SUCCESS.     */
+/*           If unsuccessful, *Error will be set to a non-zero value.*/
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToIndex is not a */
+/*                   valid list, if GetKey is NULL, or if there is   */
+/*                   not enough memory for the index.                */
+/*                                                                   */
+/*   Side Effects: Any items already in the list are indexed.  If    */
+/*                 the list already has an index, it is replaced.    */
+/*                                                                   */
+/*   Notes: Once a list has an index, every function in this module  */
+/*          which adds, removes, or replaces items keeps the index   */
+/*          up to date.  If the key of an item is changed while the  */
+/*          item is in the list, ReindexItem must be called for the  */
+/*          item or FindByKey may not find it.                       */
+/*                                                                   */
+/*********************************************************************/
+void _System CreateListIndex( DLIST                ListToIndex,
+                              DLIST_Key_Function   GetKey,
+                              CARDINAL32 *         Error );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  DestroyListIndex                                */
+/*                                                                   */
+/*   Descriptive Name: Removes the index from a DLIST.               */
+/*                                                                   */
+/*   Input:  DLIST ListToChange : The list whose index is to be      */
+/*                                removed.                           */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, *Error will be set to DLIST_SUCCESS.     */
+/*           If unsuccessful, *Error will be set to a non-zero value.*/
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToChange is not  */
+/*                   a valid list or if it has no index.             */
+/*                                                                   */
+/*   Side Effects: The memory used by the index is freed.            */
+/*                                                                   */
+/*   Notes: DestroyList frees the index of a list automatically.     */
+/*                                                                   */
+/*********************************************************************/
+void _System DestroyListIndex( DLIST ListToChange, CARDINAL32 * Error );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  FindByKey                                       */
+/*                                                                   */
+/*   Descriptive Name: Uses the index of a DLIST to find the item    */
+/*                     with the specified key.                       */
+/*                                                                   */
+/*   Input:  DLIST ListToSearch : The list to search.                */
+/*           ADDRESS Key : The address of the key to search for.     */
+/*           CARDINAL32 KeySize : The size of the key, in bytes.     */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If an item with the key is found, the function return   */
+/*              value will be the handle of the item and *Error will */
+/*              be set to DLIST_SUCCESS.                             */
+/*           If no item has the key, the function return value will  */
+/*              be NULL and *Error will be set to DLIST_SUCCESS.     */
+/*           If unsuccessful, the function return value will be NULL */
+/*              and *Error will be set to a non-zero value.          */
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToSearch is not  */
+/*                   a valid list, or with DLIST_NO_INDEX if the     */
+/*                   list has no index.                              */
+/*                                                                   */
+/*   Side Effects: None.  The current item is not changed.           */
+/*                                                                   */
+/*   Notes: Keys are compared byte for byte.  If more than one item  */
+/*          has the key, one of them is returned.  The handle may be */
+/*          used with the _By_Handle functions, GoToSpecifiedItem,   */
+/*          or GetObject to get to the item.                         */
+/*                                                                   */
+/*********************************************************************/
+ADDRESS _System FindByKey( DLIST          ListToSearch,
+                           ADDRESS        Key,
+                           CARDINAL32     KeySize,
+                           CARDINAL32 *   Error );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  ReindexItem                                     */
+/*                                                                   */
+/*   Descriptive Name: Updates the index of a DLIST after the key of */
+/*                     one of its items has been changed in place.   */
+/*                                                                   */
+/*   Input:  DLIST ListToChange : The list containing the item.      */
+/*           ADDRESS Handle : The handle of the item whose key has   */
+/*                            changed.  If NULL, the current item in */
+/*                            the list is used.                      */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, *Error will be set to DLIST_SUCCESS.     */
+/*           If unsuccessful, *Error will be set to a non-zero value.*/
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToChange is not  */
+/*                   a valid list, if it is empty, if Handle does    */
+/*                   not belong to it, or with DLIST_NO_INDEX if the */
+/*                   list has no index.                              */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: None.                                                    */
+/*                                                                   */
+/*********************************************************************/
+void _System ReindexItem( DLIST          ListToChange,
+                          ADDRESS        Handle,
+                          CARDINAL32 *   Error );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  ShareList                                       */
+/*                                                                   */
+/*   Descriptive Name: Prepares a DLIST to be read by several threads*/
+/*                     while another thread changes it.              */
+/*                                                                   */
+/*   Input:  DLIST ListToShare : The list to be shared.              */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, *Error will be set to DLIST_SUCCESS.     */
+/*           If unsuccessful, *Error will be set to a non-zero value.*/
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToShare is not a */
+/*                   valid list, or with DLIST_OUT_OF_MEMORY if the  */
+/*                   locks for the list can not be created.          */
+/*                                                                   */
+/*   Side Effects: From now on, LinkNodes removed from the list are  */
+/*                 not reused until every reader which might still   */
+/*                 be looking at them has finished.                  */
+/*                                                                   */
+/*   Notes: It is assumed that Error contains a valid address.       */
+/*                                                                   */
+/*          Sharing a list which is already shared does nothing.     */
+/*          This function must not be called while other threads     */
+/*          are using the list.                                      */
+/*                                                                   */
+/*          See the notes for LockList and BeginListRead.            */
+/*                                                                   */
+/*********************************************************************/
+void _System ShareList( DLIST ListToShare, CARDINAL32 * Error );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  LockList                                        */
+/*                                                                   */
+/*   Descriptive Name: Gives the calling thread the right to change a*/
+/*                     shared DLIST.                                 */
+/*                                                                   */
+/*   Input:  DLIST ListToLock : The list to be changed.              */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, *Error will be set to DLIST_SUCCESS.     */
+/*           If unsuccessful, *Error will be set to a non-zero value.*/
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToLock is not a  */
+/*                   valid list, or with DLIST_NOT_SHARED if         */
+/*                   ShareList has not been called for it.           */
+/*                                                                   */
+/*   Side Effects: The calling thread waits until no other thread    */
+/*                 holds the lock on the list.                       */
+/*                                                                   */
+/*   Notes: It is assumed that Error contains a valid address.       */
+/*                                                                   */
+/*          Only one thread at a time may change a shared list, and  */
+/*          it must call LockList before making any changes, and     */
+/*          UnlockList when it is done.  Any of the functions in     */
+/*          this module may be used on the list in between.  The     */
+/*          list must not be changed without holding the lock, even  */
+/*          if only one thread is changing it, as UnlockList is      */
+/*          where LinkNodes removed from the list are freed.         */
+/*                                                                   */
+/*          Readers of a shared list do not take the lock.  A reader */
+/*          will see each item as it was either before or after each */
+/*          change.  ReplaceItem, ReplaceObject, SortList,           */
+/*          SortListByKey, AppendList and TransferItem can not be    */
+/*          done that way, so they fail with DLIST_LIST_IS_SHARED    */
+/*          when used on a shared list.                              */
+/*                                                                   */
+/*          An item taken out of a shared list by ExtractObject must */
+/*          not be freed until every reader active at the time has   */
+/*          finished.                                                */
+/*                                                                   */
+/*********************************************************************/
+void _System LockList( DLIST ListToLock, CARDINAL32 * Error );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  UnlockList                                      */
+/*                                                                   */
+/*   Descriptive Name: Ends a set of changes to a shared DLIST and   */
+/*                     frees those LinkNodes removed from the list   */
+/*                     which are no longer in use by any reader.     */
+/*                                                                   */
+/*   Input:  DLIST ListToUnlock : The list which was changed.        */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, *Error will be set to DLIST_SUCCESS.     */
+/*           If unsuccessful, *Error will be set to a non-zero value.*/
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToUnlock is not  */
+/*                   a valid list, or with DLIST_NOT_SHARED if it is */
+/*                   not a shared list.                              */
+/*                                                                   */
+/*   Side Effects: The current epoch is advanced if any LinkNodes    */
+/*                 were removed from the list since it was locked.   */
+/*                 Items removed from the list by DeleteItem,        */
+/*                 DeleteAllItems, PruneList and ExtractItem are     */
+/*                 freed along with their LinkNodes.                 */
+/*                                                                   */
+/*   Notes: It is assumed that Error contains a valid address, and   */
+/*          that the calling thread holds the lock on the list.      */
+/*                                                                   */
+/*          A LinkNode removed while a reader was active is kept     */
+/*          until a later call to UnlockList finds that reader has   */
+/*          finished, so readers should not remain active for long.  */
+/*                                                                   */
+/*********************************************************************/
+void _System UnlockList( DLIST ListToUnlock, CARDINAL32 * Error );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  BeginListRead                                   */
+/*                                                                   */
+/*   Descriptive Name: Starts a walk through a shared DLIST by a     */
+/*                     thread which does not hold the lock on it.    */
+/*                                                                   */
+/*   Input:  DLIST ListToRead : The list to be read.                 */
+/*           DLIST_Reader * Reader : The cursor to use for the walk. */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, *Reader will be set up to return the     */
+/*           first item in the list, and *Error will be set to       */
+/*           DLIST_SUCCESS.                                          */
+/*           If unsuccessful, *Error will be set to a non-zero value.*/
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToRead is not a  */
+/*                   valid list, with DLIST_NOT_SHARED if it is not  */
+/*                   a shared list, or with DLIST_TOO_MANY_READERS if*/
+/*                   64 readers are already active.                  */
+/*                                                                   */
+/*   Side Effects: LinkNodes removed from any shared list from now   */
+/*                 on will not be freed until EndListRead is called  */
+/*                 for Reader.                                       */
+/*                                                                   */
+/*   Notes: It is assumed that Error and Reader contain valid        */
+/*          addresses.                                               */
+/*                                                                   */
+/*          Each thread uses its own DLIST_Reader, and any number of */
+/*          threads may read the same list at once.  Readers never   */
+/*          change the list, and do not use or change its current    */
+/*          item.  The items returned by ReadNextObject remain valid */
+/*          until EndListRead is called, even if they are removed    */
+/*          from the list in the meantime.                           */
+/*                                                                   */
+/*********************************************************************/
+void _System BeginListRead( DLIST ListToRead, DLIST_Reader * Reader, CARDINAL32 * Error );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  ReadNextObject                                  */
+/*                                                                   */
+/*   Descriptive Name: Returns the next item in a shared DLIST to a  */
+/*                     reader.                                       */
+/*                                                                   */
+/*   Input:  DLIST_Reader * Reader : The cursor set up by            */
+/*                                   BeginListRead.                  */
+/*           CARDINAL32 * ObjectSize : The address of a variable to  */
+/*                                     hold the size of the item.    */
+/*           TAG * ObjectTag : The address of a variable to hold the */
+/*                             tag of the item.                      */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, the function return value will be the    */
+/*           address of the item, *ObjectSize and *ObjectTag will be */
+/*           set to its size and tag, and *Error will be set to      */
+/*           DLIST_SUCCESS.                                          */
+/*           If there are no more items in the list, the function    */
+/*           return value will be NULL, and *Error will be set to    */
+/*           DLIST_END_OF_LIST.                                      */
+/*                                                                   */
+/*   Error Handling: This function will fail if the list being read  */
+/*                   is not a valid list.                            */
+/*                                                                   */
+/*   Side Effects: Reader is advanced to the item returned.          */
+/*                                                                   */
+/*   Notes: It is assumed that Error, ObjectSize and ObjectTag       */
+/*          contain valid addresses.                                 */
+/*                                                                   */
+/*          The first call after BeginListRead returns the first item*/
+/*          in the list.  Once the end of the list has been reached, */
+/*          further calls return any items added to the end of the   */
+/*          list since.  If the item Reader is positioned on is      */
+/*          removed from the list, the walk continues with the item  */
+/*          which followed it at the time.                           */
+/*                                                                   */
+/*********************************************************************/
+ADDRESS _System ReadNextObject( DLIST_Reader *  Reader,
+                                CARDINAL32 *    ObjectSize,
+                                TAG *           ObjectTag,
+                                CARDINAL32 *    Error );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  EndListRead                                     */
+/*                                                                   */
+/*   Descriptive Name: Ends a walk through a shared DLIST.           */
+/*                                                                   */
+/*   Input:  DLIST_Reader * Reader : The cursor set up by            */
+/*                                   BeginListRead.                  */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, *Error will be set to DLIST_SUCCESS.     */
+/*           If unsuccessful, *Error will be set to a non-zero value.*/
+/*                                                                   */
+/*   Error Handling: This function will fail if Reader was not set up*/
+/*                   by BeginListRead.                               */
+/*                                                                   */
+/*   Side Effects: The items returned to Reader may be freed once the*/
+/*                 writer of the list calls UnlockList.              */
+/*                                                                   */
+/*   Notes: It is assumed that Error and Reader contain valid        */
+/*          addresses.                                               */
+/*                                                                   */
+/*********************************************************************/
+void _System EndListRead( DLIST_Reader * Reader, CARDINAL32 * Error );
+
+
+#ifndef USE_POOLMAN
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  GetListPoolStatistics                           */
+/*                                                                   */
+/*   Descriptive Name: Returns the counters kept for the pool of     */
+/*                     link nodes belonging to a DLIST.              */
+/*                                                                   */
+/*   Input:  DLIST ListToCheck : The list whose pool is to be        */
+/*                               reported on.                        */
+/*           DLIST_Pool_Statistics * Statistics : The location of a  */
+/*                               buffer to hold the counters.        */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, *Statistics will be filled in and *Error */
+/*              will be set to DLIST_SUCCESS.                        */
+/*           If unsuccessful, *Error will be set to a non-zero value.*/
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToCheck is not a */
+/*                   valid list or if Statistics is NULL.            */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: Link nodes are allocated from slabs belonging to the     */
+/*          list which needed them, and stay in those slabs when     */
+/*          their items are moved to other lists by AppendList or    */
+/*          TransferItem.  The counters therefore describe the link  */
+/*          nodes allocated for this list, wherever they are now.    */
+/*                                                                   */
+/*********************************************************************/
+void _System GetListPoolStatistics( DLIST                    ListToCheck,
+                                    DLIST_Pool_Statistics *  Statistics,
+                                    CARDINAL32 *             Error );
+
+#endif
+
+
 #endif
 
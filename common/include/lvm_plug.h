@@ -212,6 +212,16 @@ typedef struct _Plugin_Function_Table_V1{
 /* The following defines the TAG value used to identify items of type Plugin_Function_Table_V1 in DLISTs. */
 #define PLUGIN_FUNCTION_TABLE_V1_TAG  354385987
 
+/* The following structure describes one piece of a read or write which an aggregate sends to one of its partitions.  An array of
+   these is given to the Transfer_Segments service, which keeps the pieces on different drives in progress at the same time.      */
+typedef struct _Segment_Transfer {
+                                    Partition_Data *  PartitionRecord;   /* The partition to send the piece to.  Its Read or Write function is used if the piece can not be started without waiting. */
+                                    LBA               Starting_Sector;   /* The first sector of the piece, as the Read and Write functions of the partition expect it. */
+                                    CARDINAL32        Sector_Count;      /* The number of sectors in the piece. */
+                                    ADDRESS           Buffer;            /* The data to write, or where to put the data read. */
+                                    CARDINAL32        Error_Code;        /* Output - The result of the transfer of this piece. */
+                                  } Segment_Transfer;
+
 /* The following structure defines the services provided by the LVM Engine to plugin modules.  The memory management services
    must be used by any plugins since, if the plugin has its own memory allocated, bad things could happen if memory is allocated
    by the plugin and freed by the LVM Engine!                                                                                     */
@@ -385,6 +395,17 @@ typedef struct _LVM_Common_Services_V1 {
                                                                        Insertion_Modes  TransferCode,
                                                                        BOOLEAN          MakeCurrent,
                                                                        CARDINAL32 *     Error);
+                                         /* Feature data validation - Checks the signature, CRC and sequence number of each sector of a multi-sector feature table. */
+                                         CARDINAL32 (* _System Validate_Feature_Sectors)( ADDRESS      Buffer,
+                                                                                          CARDINAL32   Sector_Count,
+                                                                                          CARDINAL32   First_Signature,
+                                                                                          CARDINAL32   Signature,
+                                                                                          BYTE *       Valid_Sectors);
+                                         /* Transfers a set of pieces to or from the partitions of an aggregate, with the pieces on different drives in progress at once. */
+                                         void (* _System Transfer_Segments)( Segment_Transfer *  Segments,
+                                                                             CARDINAL32          Segment_Count,
+                                                                             BOOLEAN             Write,
+                                                                             CARDINAL32 *        Error_Code);
 #ifdef DEBUG
                                          BOOLEAN (* _System CheckListIntegrity)(DLIST ListToCheck);
 #endif
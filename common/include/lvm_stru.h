@@ -67,6 +67,8 @@ typedef struct _Disk_Drive_Data {
                                   DoubleWord             Boot_Drive_Serial_Number;         /* The serial number of the boot drive when this disk was partitioned. */
                                   CARDINAL32             Install_Flags;                    /* Reserved for use by the Install program. */
                                   DLIST                  Partitions;                       /* A list of the partitions on this drive. */
+                                  ADDRESS                Free_Space_Index;                 /* Used by the Partition Manager to find blocks of free space in Partitions without walking the list.  NULL until needed. */
+                                  ADDRESS                Metadata_Table;                   /* Used by the Partition Manager to avoid rewriting metadata sectors which have not changed.  NULL until needed. */
                                   CARDINAL32             Primary_Partition_Count;          /* The number of primary partitions on this drive. */
                                   CARDINAL32             Logical_Partition_Count;          /* The number of logical drives on this drive. */
                                   Drive_Geometry_Record  Geometry;                         /* The geometry for this disk drive. */
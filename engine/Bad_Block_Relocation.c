@@ -62,7 +62,7 @@
  * Necessary include files
  --------------------------------------------------*/
 
-#include <stdlib.h>   /* malloc, free */
+#include <stdlib.h>   /* malloc, free, qsort */
 #include <stdio.h>    /* sprintf */
 #include <string.h>   /* strlen */
 
@@ -76,6 +76,8 @@
 
 #include "Bad_Block_Relocation.h"
 
+#include "Pass_Thru.h"   /* Pass_Thru_Start_Transfer */
+
 #ifdef DEBUG
 
 #ifdef PARANOID
@@ -117,9 +119,14 @@ typedef struct _BBR_Data_Record {
                                   CARDINAL32        Sequence_Number;
                                   CARDINAL32        Feature_Sequence_Number;
                                   BBR_Table_Entry * BBR_Table;
+                                  BBR_Table_Entry * Remap_Table;          /* The entries of BBR_Table which are in use, sorted by BadSector. */
+                                  CARDINAL32        Remap_Count;          /* The number of entries in Remap_Table. */
+                                  CARDINAL32        First_Replacement_Sector;  /* The LSN of the first replacement sector. */
+                                  CARDINAL32        Last_Replacement_Sector;   /* The LSN of the last replacement sector. */
                                   LVM_Classes       Actual_Class;
                                   BOOLEAN           ChangesMade;
                                   BOOLEAN           Top_Of_Class;
+                                  BOOLEAN           Remap_Table_Built;    /* Remap_Table is built the first time it is needed. */
                                 } BBR_Data_Record;
 
 typedef struct {
@@ -148,6 +155,11 @@ static void    _System Remove_BBR_Data(ADDRESS Object, TAG ObjectTag, CARDINAL32
 static BOOLEAN _System Find_BBR_Partitions(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, BOOLEAN * FreeMemory, CARDINAL32 * Error_Code);
 static BOOLEAN Feature_Data_Is_Valid( BOOLEAN  Use_Primary_Buffer, CARDINAL32  Sectors_To_Validate );
 static void    Extract_BBR_Table(Partition_Data * PartitionRecord, BOOLEAN Use_Primary_Buffer, BOOLEAN Old_BBR_Format);
+static int     Compare_BBR_Entries( const void * First, const void * Second );
+static BOOLEAN Valid_BBR_Entry( Partition_Data * PartitionRecord, BBR_Data_Record * BBR_Data, BBR_Table_Entry * Entry );
+static BOOLEAN Build_Remap_Table( Partition_Data * PartitionRecord, BBR_Data_Record * BBR_Data );
+static BOOLEAN Range_Is_Relocated( Partition_Data * PartitionRecord, BBR_Data_Record * BBR_Data, LBA Starting_Sector, CARDINAL32 Sector_Count );
+static void    Transfer_Sectors( Partition_Data * PartitionRecord, BBR_Data_Record * BBR_Data, Plugin_Function_Table_V1 * Old_Function_Table, LBA Starting_Sector, CARDINAL32 Sector_Count, ADDRESS Buffer, BOOLEAN Write, CARDINAL32 * Error_Code );
 static void    _System Discover_BBR_Partitions( DLIST  Partition_List, CARDINAL32 * Error_Code );
 static void    _System Create_BBR_Volume( DLIST Partition_List,
                                           ADDRESS VData,
@@ -264,6 +276,36 @@ ADDRESS BBR_Exchange_Function_Tables( ADDRESS Common_Services )
 }
 
 
+/* Starts a read or write on the partition without waiting for it, for Transfer_Segments.  This is only possible when the layer
+   below us is Pass Thru and none of the sectors in Request have been relocated, since the request then goes to the same sectors
+   that BBR_Read or BBR_Write would send it to.  Returns TRUE if the request was started, in which case it will be returned by
+   ReapSectorIO.  Returns FALSE if it was not, in which case BBR_Read or BBR_Write must be used instead.                           */
+BOOLEAN BBR_Start_Transfer( Partition_Data * PartitionRecord, Sector_IO_Request * Request )
+{
+
+  Feature_Context_Data *  Current_Feature_Data = PartitionRecord->Feature_Data;
+  BBR_Data_Record *       BBR_Data;
+
+  if ( ( Current_Feature_Data == NULL ) ||
+       ( Current_Feature_Data->Old_Context == NULL ) ||
+       ( Current_Feature_Data->Old_Context->Function_Table != PassThru_Function_Table )
+     )
+    return FALSE;
+
+  BBR_Data = (BBR_Data_Record *) Current_Feature_Data->Data;
+
+  /* The sorted table of relocated sectors is built the first time it is needed. */
+  if ( ( ! BBR_Data->Remap_Table_Built ) && ( ! Build_Remap_Table( PartitionRecord, BBR_Data ) ) )
+    return FALSE;
+
+  if ( Range_Is_Relocated( PartitionRecord, BBR_Data, Request->Starting_Sector, Request->Sector_Count ) )
+    return FALSE;
+
+  return Pass_Thru_Start_Transfer( PartitionRecord, Request );
+
+}
+
+
 
 /*--------------------------------------------------
  * Private Functions Available
@@ -331,7 +373,7 @@ static void _System Commit_BBR_Changes( ADDRESS VData, ADDRESS PData, CARDINAL32
   LVM_Feature_Data     *       Feature_Data;
   CARDINAL32                   FeatureIndex;
   LVM_BBR_Table_First_Sector * BBR_First_Sector = ( LVM_BBR_Table_First_Sector *) &Feature_Data_Buffer1;
-  LVM_BBR_Table_Sector *       BBR_Sector = (LVM_BBR_Table_Sector *) &Feature_Data_Buffer2;
+  LVM_BBR_Table_Sector *       BBR_Sector = (LVM_BBR_Table_Sector *) &Feature_Data_Buffer1;
   CARDINAL32                   Sector_Count;
   CARDINAL32                   BBR_Table_Index;
   CARDINAL32                   BBR_Entries_Moved = 0;
@@ -455,8 +497,9 @@ static void _System Commit_BBR_Changes( ADDRESS VData, ADDRESS PData, CARDINAL32
 
   }
 
-  /* We need to build the first sector of the BBR Data in Feature_Data_Buffer1. */
-  memset(&Feature_Data_Buffer1,0,BYTES_PER_SECTOR);
+  /* We need to build an image of the BBR Data in Feature_Data_Buffer1.  The first sector goes at the start of the buffer, and
+     the sectors holding the BBR Table follow it, just as they will on disk.                                                     */
+  memset(&Feature_Data_Buffer1,0, BYTES_PER_SECTOR * MAX_SECTORS_IN_BBR_TABLE);
 
   /* Initialize the first sector of the BBR Data. */
   BBR_First_Sector->Signature = BBR_TABLE_MASTER_SIGNATURE;
@@ -496,16 +539,15 @@ static void _System Commit_BBR_Changes( ADDRESS VData, ADDRESS PData, CARDINAL32
   /* Calculate the CRC. */
   BBR_First_Sector->CRC = LVM_Common_Services->CalculateCRC( LVM_Common_Services->Initial_CRC, BBR_First_Sector, BYTES_PER_SECTOR);
 
-  /* Now we will use Feature_Data_Buffer2 to build the sectors holding the BBR Table. */
-  memset(&Feature_Data_Buffer2,0, BYTES_PER_SECTOR * MAX_SECTORS_IN_BBR_TABLE);
+  /* Now we will build the sectors holding the BBR Table, which follow the first sector in Feature_Data_Buffer1. */
 
   /* Setup each sector of data contained in the buffer. */
   for ( Sector_Count = 1; Sector_Count <= BBR_First_Sector->Sectors_Per_Table; Sector_Count++)
   {
 
     /* Locate the next sector within the buffer. */
-    Offset = BYTES_PER_SECTOR * ( Sector_Count - 1 );
-    BBR_Sector = (LVM_BBR_Table_Sector *) &Feature_Data_Buffer2;
+    Offset = BYTES_PER_SECTOR * Sector_Count;
+    BBR_Sector = (LVM_BBR_Table_Sector *) &Feature_Data_Buffer1;
     BBR_Sector = (LVM_BBR_Table_Sector *) ( (CARDINAL32) BBR_Sector + Offset );
 
     /* Set the signature. */
@@ -540,27 +582,14 @@ static void _System Commit_BBR_Changes( ADDRESS VData, ADDRESS PData, CARDINAL32
 
   }
 
-  /* Write the Primary Copy of the Feature Data. */
-
-  /* Write the first sector. If the write fails, set the I/O error flag in the corresponding entry in the DriveArray. */
-  Function_Table.Write( PartitionRecord, Feature_Data->Location_Of_Primary_Feature_Data + Signature_Sector->Partition_Start, 1, &Feature_Data_Buffer1, Error_Code);
+  /* Write the Primary Copy of the Feature Data.  The first sector and the BBR Table are written together.  If the write fails,
+     set the I/O error flag in the corresponding entry in the DriveArray.                                                        */
+  Function_Table.Write( PartitionRecord, Feature_Data->Location_Of_Primary_Feature_Data + Signature_Sector->Partition_Start, 1 + BBR_First_Sector->Sectors_Per_Table, &Feature_Data_Buffer1, Error_Code);
   if ( *Error_Code != LVM_ENGINE_NO_ERROR )
     DriveArray[PartitionRecord->Drive_Index].IO_Error = TRUE;
 
-  /* Write the sectors containing the BBR Table. If the write fails, set the I/O error flag in the corresponding entry in the DriveArray. */
-  Function_Table.Write( PartitionRecord, Feature_Data->Location_Of_Primary_Feature_Data + 1 + Signature_Sector->Partition_Start, BBR_First_Sector->Sectors_Per_Table, &Feature_Data_Buffer2, Error_Code);
-  if ( *Error_Code != LVM_ENGINE_NO_ERROR )
-    DriveArray[PartitionRecord->Drive_Index].IO_Error = TRUE;
-
-  /* Write the Secondary Copy of the Feature Data. */
-
-  /* Write the first sector. If the write fails, set the I/O error flag in the corresponding entry in the DriveArray. */
-  Function_Table.Write( PartitionRecord, Feature_Data->Location_Of_Secondary_Feature_Data + Signature_Sector->Partition_Start, 1, &Feature_Data_Buffer1, Error_Code);
-  if ( *Error_Code != LVM_ENGINE_NO_ERROR )
-    DriveArray[PartitionRecord->Drive_Index].IO_Error = TRUE;
-
-  /* Write the sectors containing the BBR Table. If the write fails, set the I/O error flag in the corresponding entry in the DriveArray. */
-  Function_Table.Write( PartitionRecord, Feature_Data->Location_Of_Secondary_Feature_Data + 1 + Signature_Sector->Partition_Start, BBR_First_Sector->Sectors_Per_Table, &Feature_Data_Buffer2, Error_Code);
+  /* Write the Secondary Copy of the Feature Data the same way. */
+  Function_Table.Write( PartitionRecord, Feature_Data->Location_Of_Secondary_Feature_Data + Signature_Sector->Partition_Start, 1 + BBR_First_Sector->Sectors_Per_Table, &Feature_Data_Buffer1, Error_Code);
   if ( *Error_Code != LVM_ENGINE_NO_ERROR )
     DriveArray[PartitionRecord->Drive_Index].IO_Error = TRUE;
 
@@ -952,6 +981,8 @@ static void _System Delete_BBR_Partition( ADDRESS AData, BOOLEAN Kill_Partitions
   /* Free the BBR Data for the partition. */
   BBR_Data = (BBR_Data_Record *) Current_Feature_Data->Data;
   LVM_Common_Services->Deallocate(BBR_Data->BBR_Table);
+  if ( BBR_Data->Remap_Table != NULL )
+    LVM_Common_Services->Deallocate(BBR_Data->Remap_Table);
   LVM_Common_Services->Deallocate(Current_Feature_Data->Data);
 
   /* Free the feature data for the partition. */
@@ -972,6 +1003,7 @@ static void _System BBR_Write( ADDRESS PData, LBA Starting_Sector, CARDINAL32 Se
   Partition_Data *           PartitionRecord = (Partition_Data *) PData;
   Feature_Context_Data *     Current_Feature_Data;
   Plugin_Function_Table_V1 * Old_Function_Table;
+  BBR_Data_Record *          BBR_Data;
 
   FEATURE_FUNCTION_ENTRY("BBR_Write")
 
@@ -1026,6 +1058,7 @@ static void _System BBR_Write( ADDRESS PData, LBA Starting_Sector, CARDINAL32 Se
 
   /* Place the feature data for the layer below us into the Feature_Data field of the Partition Record. */
   Current_Feature_Data = PartitionRecord->Feature_Data;
+  BBR_Data = (BBR_Data_Record *) Current_Feature_Data->Data;
   PartitionRecord->Feature_Data = Current_Feature_Data->Old_Context;
   Old_Function_Table = PartitionRecord->Feature_Data->Function_Table;
 
@@ -1057,8 +1090,8 @@ static void _System BBR_Write( ADDRESS PData, LBA Starting_Sector, CARDINAL32 Se
 
   }
 
-  /* Now call the write function of the next layer. */
-  Old_Function_Table->Write(PData, Starting_Sector, Sectors_To_Write, Buffer, Error_Code);
+  /* Now call the write function of the next layer, sending any sectors which have been relocated to their replacements. */
+  Transfer_Sectors(PartitionRecord, BBR_Data, Old_Function_Table, Starting_Sector, Sectors_To_Write, Buffer, TRUE, Error_Code);
 
   /* Now restore the feature data to what it was before we called the write function and return. */
   Current_Feature_Data->Old_Context = PartitionRecord->Feature_Data;
@@ -1077,6 +1110,7 @@ static void _System BBR_Read( ADDRESS PData, LBA Starting_Sector, CARDINAL32 Sec
   Partition_Data *           PartitionRecord = (Partition_Data *) PData;
   Feature_Context_Data *     Current_Feature_Data = PartitionRecord->Feature_Data; /* Save the feature data for the PartitionRecord. */
   Plugin_Function_Table_V1 * Old_Function_Table;
+  BBR_Data_Record *          BBR_Data;
 
   FEATURE_FUNCTION_ENTRY("BBR_Read")
 
@@ -1122,6 +1156,7 @@ static void _System BBR_Read( ADDRESS PData, LBA Starting_Sector, CARDINAL32 Sec
   }
 
   /* Place the feature data for the layer below us into the Feature_Data field of the Partition Record. */
+  BBR_Data = (BBR_Data_Record *) Current_Feature_Data->Data;
   PartitionRecord->Feature_Data = Current_Feature_Data->Old_Context;
   Old_Function_Table = PartitionRecord->Feature_Data->Function_Table;
 
@@ -1153,8 +1188,8 @@ static void _System BBR_Read( ADDRESS PData, LBA Starting_Sector, CARDINAL32 Sec
 
   }
 
-  /* Now call the read function of the next layer. */
-  Old_Function_Table->Read(PData, Starting_Sector, Sectors_To_Read, Buffer, Error_Code);
+  /* Now call the read function of the next layer, taking any sectors which have been relocated from their replacements. */
+  Transfer_Sectors(PartitionRecord, BBR_Data, Old_Function_Table, Starting_Sector, Sectors_To_Read, Buffer, FALSE, Error_Code);
 
   /* Now restore the feature data to what it was before we called the read function and return. */
   Current_Feature_Data->Old_Context = PartitionRecord->Feature_Data;
@@ -1315,6 +1350,9 @@ static void _System Create_BBR_Data(ADDRESS Object, TAG ObjectTag, CARDINAL32 Ob
   BBR_Data->Top_Of_Class = BBR_Creation_Data->Top_Of_Class;
   BBR_Data->Feature_Sequence_Number = BBR_Creation_Data->Feature_Sequence_Number;
   BBR_Data->BBR_Table = NULL;
+  BBR_Data->Remap_Table = NULL;
+  BBR_Data->Remap_Count = 0;
+  BBR_Data->Remap_Table_Built = FALSE;
 
   /* Allocate the BBR Table. */
   BBR_Data->BBR_Table = (BBR_Table_Entry *) LVM_Common_Services->Allocate( Table_Size * sizeof(BBR_Table_Entry) );
@@ -1381,6 +1419,9 @@ static void _System Create_BBR_Data(ADDRESS Object, TAG ObjectTag, CARDINAL32 Ob
       Replacement_Sector_LSN = ( Signature_Sector->Partition_End - Signature_Sector->LVM_Reserved_Sector_Count ) + 1;
       Replacement_Sector_LSN -= Signature_Sector->Partition_Start;
 
+      BBR_Data->First_Replacement_Sector = Replacement_Sector_LSN;
+      BBR_Data->Last_Replacement_Sector = ( Replacement_Sector_LSN + Table_Size ) - 1;
+
       /* Now fill in the BBR Table using the LSNs of the replacement sectors. */
       for ( Table_Index = 0; Table_Index < Table_Size; Table_Index++ )
       {
@@ -1785,7 +1826,7 @@ static BOOLEAN _System Find_BBR_Partitions(ADDRESS Object, TAG ObjectTag, CARDIN
               }
 
               /* Allocate memory for the actual BBR Table. */
-              BBR_Data->BBR_Table = (BBR_Table_Entry *) LVM_Common_Services->Allocate( sizeof( BBR_Table_Entry ) * BBR_Primary_First_Sector->Table_Size );
+              BBR_Data->BBR_Table = (BBR_Table_Entry *) LVM_Common_Services->Allocate( sizeof( BBR_Table_Entry ) * BBR_Secondary_First_Sector->Table_Size );
 
               if ( BBR_Data->BBR_Table == NULL )
               {
@@ -1961,7 +2002,7 @@ static BOOLEAN _System Find_BBR_Partitions(ADDRESS Object, TAG ObjectTag, CARDIN
             }
 
             /* Allocate memory for the actual BBR Table. */
-            BBR_Data->BBR_Table = (BBR_Table_Entry *) LVM_Common_Services->Allocate( sizeof( BBR_Table_Entry ) * BBR_Primary_First_Sector->Table_Size );
+            BBR_Data->BBR_Table = (BBR_Table_Entry *) LVM_Common_Services->Allocate( sizeof( BBR_Table_Entry ) * BBR_Secondary_First_Sector->Table_Size );
 
             if ( BBR_Data->BBR_Table == NULL )
             {
@@ -2064,13 +2105,8 @@ static BOOLEAN Feature_Data_Is_Valid( BOOLEAN  Use_Primary_Buffer, CARDINAL32  S
 {
 
   LVM_BBR_Table_First_Sector *     First_Sector;
-  LVM_BBR_Table_Sector *           Next_Sector;
   CARDINAL32                       Sector_Count;
   ADDRESS                          Buffer;
-  CARDINAL32                       Offset;
-  CARDINAL32                       Old_CRC;
-  CARDINAL32                       Calculated_CRC;
-  CARDINAL32                       Sequence_Count;
 
   FEATURE_FUNCTION_ENTRY("Feature_Data_Is_Valid")
 
@@ -2080,156 +2116,54 @@ static BOOLEAN Feature_Data_Is_Valid( BOOLEAN  Use_Primary_Buffer, CARDINAL32  S
   else
     Buffer = &Feature_Data_Buffer2;
 
-  /* Validate each sector of data contained in the buffer. */
-  for ( Sector_Count = 1; Sector_Count < Sectors_To_Validate; Sector_Count++)
+  /* The last sector of the feature data is not part of the BBR table. */
+  if ( Sectors_To_Validate > 1 )
   {
 
-    /* The first sector is different than the ones that follow it.  Handle it separately. */
-    if ( Sector_Count == 1)
-    {
+    Sector_Count = Sectors_To_Validate - 1;
 
-      /* Find the location of the first sector in the buffer. */
-      First_Sector = (LVM_BBR_Table_First_Sector *) Buffer;
-
-      /* Check the signature. */
-      if ( First_Sector->Signature != BBR_TABLE_MASTER_SIGNATURE )
-      {
-
-        if ( LVM_Common_Services->Logging_Enabled )
-        {
-
-          sprintf(LVM_Common_Services->Log_Buffer,"Signature does not match.  Feature Data is invalid.");
-          LVM_Common_Services->Write_Log_Buffer();
-
-        }
-
-        FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
-
-        /* The data in the buffer is not valid! */
-        return FALSE;
-
-      }
+    /* Check the signature, CRC, and sequence number of every sector in the table at once. */
+    if ( LVM_Common_Services->Validate_Feature_Sectors( Buffer, Sector_Count, BBR_TABLE_MASTER_SIGNATURE, BBR_TABLE_SIGNATURE, NULL ) != Sector_Count )
+    {
 
-      /* Check the Table_Size, Replacement_Sector_Count, Sectors_Per_Table, and Table_Entries_In_Use */
-      if ( ( First_Sector->Table_Size == 0 ) ||
-           ( First_Sector->Table_Size < First_Sector->Table_Entries_In_Use ) ||
-           ( First_Sector->Table_Size != First_Sector->Replacement_Sector_Count ) ||
-           ( First_Sector->Table_Size > ( First_Sector->Sectors_Per_Table * BBR_TABLE_ENTRIES_PER_SECTOR ) )
-         )
+      if ( LVM_Common_Services->Logging_Enabled )
       {
 
-        if ( LVM_Common_Services->Logging_Enabled )
-        {
-
-          sprintf(LVM_Common_Services->Log_Buffer,"BBR Table characteristics are inconsistent.  Feature Data is invalid.");
-          LVM_Common_Services->Write_Log_Buffer();
-
-        }
-
-        FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
-
-        /* The data in the buffer is not valid! */
-        return FALSE;
+        sprintf(LVM_Common_Services->Log_Buffer,"Signature, CRC, or sequence number mismatch.  Feature Data is invalid.");
+        LVM_Common_Services->Write_Log_Buffer();
 
       }
 
-      /* Check the CRC. */
-      Old_CRC = First_Sector->CRC;
-      First_Sector->CRC = 0;
-
-      Calculated_CRC = LVM_Common_Services->CalculateCRC( LVM_Common_Services->Initial_CRC, First_Sector, BYTES_PER_SECTOR);
+      FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
 
-      if ( Calculated_CRC != Old_CRC )
-      {
-
-        if ( LVM_Common_Services->Logging_Enabled )
-        {
-
-          sprintf(LVM_Common_Services->Log_Buffer,"CRC failure.  Feature Data is invalid.");
-          LVM_Common_Services->Write_Log_Buffer();
-
-        }
-
-        FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
-
-        /* The data in the buffer is not valid! */
-        return FALSE;
-
-      }
-
-      /* Save the Sequence_Count.  All of the remaining sectors must have the same sequence count! */
-      Sequence_Count = First_Sector->Sequence_Number;
+      /* The data in the buffer is not valid! */
+      return FALSE;
 
     }
-    else
-    {
-
-      /* Locate the next sector within the buffer. */
-      Offset = BYTES_PER_SECTOR * ( Sector_Count - 1 );
-      Next_Sector = (LVM_BBR_Table_Sector *) Buffer;
-      Next_Sector = (LVM_BBR_Table_Sector *) ( (CARDINAL32) Next_Sector + Offset );
-
-      /* Check the signature. */
-      if ( Next_Sector->Signature != BBR_TABLE_SIGNATURE )
-      {
-
-        if ( LVM_Common_Services->Logging_Enabled )
-        {
-
-          sprintf(LVM_Common_Services->Log_Buffer,"Signature does not match.  Feature Data is invalid.");
-          LVM_Common_Services->Write_Log_Buffer();
-
-        }
 
-        FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
+    /* Find the location of the first sector in the buffer. */
+    First_Sector = (LVM_BBR_Table_First_Sector *) Buffer;
 
-        /* The data in the buffer is not valid! */
-        return FALSE;
-
-      }
-
-      /* Check the CRC. */
-      Old_CRC = Next_Sector->CRC;
-      Next_Sector->CRC = 0;
-
-      Calculated_CRC = LVM_Common_Services->CalculateCRC( LVM_Common_Services->Initial_CRC, Next_Sector, BYTES_PER_SECTOR);
+    /* Check the Table_Size, Replacement_Sector_Count, Sectors_Per_Table, and Table_Entries_In_Use */
+    if ( ( First_Sector->Table_Size == 0 ) ||
+         ( First_Sector->Table_Size < First_Sector->Table_Entries_In_Use ) ||
+         ( First_Sector->Table_Size != First_Sector->Replacement_Sector_Count ) ||
+         ( First_Sector->Table_Size > ( First_Sector->Sectors_Per_Table * BBR_TABLE_ENTRIES_PER_SECTOR ) )
+       )
+    {
 
-      if ( Calculated_CRC != Old_CRC )
+      if ( LVM_Common_Services->Logging_Enabled )
       {
 
-        if ( LVM_Common_Services->Logging_Enabled )
-        {
-
-          sprintf(LVM_Common_Services->Log_Buffer,"CRC failure.  Feature Data is invalid.");
-          LVM_Common_Services->Write_Log_Buffer();
-
-        }
-
-        FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
-
-        /* The data in the buffer is not valid! */
-        return FALSE;
+        sprintf(LVM_Common_Services->Log_Buffer,"BBR Table characteristics are inconsistent.  Feature Data is invalid.");
+        LVM_Common_Services->Write_Log_Buffer();
 
       }
 
-      /* Check the Sequence Number. */
-      if ( Next_Sector->Sequence_Number != Sequence_Count )
-      {
-
-        if ( LVM_Common_Services->Logging_Enabled )
-        {
+      FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
 
-          sprintf(LVM_Common_Services->Log_Buffer,"Sequence number mis-match.  Feature Data is invalid.");
-          LVM_Common_Services->Write_Log_Buffer();
-
-        }
-
-        FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
-
-        /* The data in the buffer is not valid! */
-        return FALSE;
-
-      }
+      /* The data in the buffer is not valid! */
+      return FALSE;
 
     }
 
@@ -2277,6 +2211,11 @@ static void Extract_BBR_Table(Partition_Data * PartitionRecord, BOOLEAN Use_Prim
   BBR_Data->BBR_Table_Size = First_Sector->Table_Size;
   BBR_Data->Entries_In_Use = First_Sector->Table_Entries_In_Use;
   BBR_Data->Sequence_Number = First_Sector->Sequence_Number;
+  BBR_Data->Remap_Table = NULL;
+  BBR_Data->Remap_Count = 0;
+  BBR_Data->Remap_Table_Built = FALSE;
+  BBR_Data->First_Replacement_Sector = First_Sector->First_Replacement_Sector;
+  BBR_Data->Last_Replacement_Sector = First_Sector->Last_Replacement_Sector;
   if ( Old_BBR_Format )
   {
 
@@ -2294,12 +2233,15 @@ static void Extract_BBR_Table(Partition_Data * PartitionRecord, BOOLEAN Use_Prim
 
   }
 
-  /* Copy the BBR Table entries from each sector in the buffer to the BBR Table in memory. */
-  for ( Sector_Count = 2; Sector_Count < First_Sector->Sectors_Per_Table; Sector_Count++)
+  /* Copy the BBR Table entries from each sector in the buffer to the BBR Table in memory.  The sectors holding the BBR Table
+     follow the first sector, so they are sectors 1 through Sectors_Per_Table of the buffer.                                   */
+  for ( Sector_Count = 1;
+        ( Sector_Count <= First_Sector->Sectors_Per_Table ) && ( Sector_Count < MAX_SECTORS_IN_BBR_TABLE ) && ( EntriesMoved < BBR_Data->BBR_Table_Size );
+        Sector_Count++)
   {
 
     /* Locate the next sector within the buffer. */
-    Offset = BYTES_PER_SECTOR * ( Sector_Count - 1 );
+    Offset = BYTES_PER_SECTOR * Sector_Count;
     Next_Sector = (LVM_BBR_Table_Sector *) Buffer;
     Next_Sector = (LVM_BBR_Table_Sector *) ( (CARDINAL32) Next_Sector + Offset );
 
@@ -2318,6 +2260,15 @@ static void Extract_BBR_Table(Partition_Data * PartitionRecord, BOOLEAN Use_Prim
 
   }
 
+  /* Any entries which were not found in the buffer are marked as unused. */
+  for ( ; EntriesMoved < BBR_Data->BBR_Table_Size; EntriesMoved++ )
+  {
+
+    BBR_Data->BBR_Table[EntriesMoved].BadSector = (CARDINAL32) -1;
+    BBR_Data->BBR_Table[EntriesMoved].ReplacementSector = (CARDINAL32) -1;
+
+  }
+
   FEATURE_FUNCTION_EXIT("Extract_BBR_Table")
 
   return;
@@ -2325,6 +2276,295 @@ static void Extract_BBR_Table(Partition_Data * PartitionRecord, BOOLEAN Use_Prim
 }
 
 
+static int Compare_BBR_Entries( const void * First, const void * Second )
+{
+
+  BBR_Table_Entry *  First_Entry = (BBR_Table_Entry *) First;
+  BBR_Table_Entry *  Second_Entry = (BBR_Table_Entry *) Second;
+
+  if ( First_Entry->BadSector != Second_Entry->BadSector )
+    return ( First_Entry->BadSector < Second_Entry->BadSector ) ? -1 : 1;
+
+  /* There should never be two entries for the same sector, but if there are, make sure we always pick the same one. */
+  if ( First_Entry->ReplacementSector != Second_Entry->ReplacementSector )
+    return ( First_Entry->ReplacementSector < Second_Entry->ReplacementSector ) ? -1 : 1;
+
+  return 0;
+
+}
+
+
+static BOOLEAN Valid_BBR_Entry( Partition_Data * PartitionRecord, BBR_Data_Record * BBR_Data, BBR_Table_Entry * Entry )
+{
+
+  if ( Entry->BadSector >= PartitionRecord->Partition_Size )
+    return FALSE;
+
+  if ( ( Entry->ReplacementSector < BBR_Data->First_Replacement_Sector ) ||
+       ( Entry->ReplacementSector > BBR_Data->Last_Replacement_Sector ) )
+    return FALSE;
+
+  return TRUE;
+
+}
+
+
+static BOOLEAN Build_Remap_Table( Partition_Data * PartitionRecord, BBR_Data_Record * BBR_Data )
+{
+
+  CARDINAL32   Table_Index;
+  CARDINAL32   Entries_Found = 0;
+  CARDINAL32   Entries_Dropped = 0;
+
+  FEATURE_FUNCTION_ENTRY("Build_Remap_Table")
+
+  /* Count the entries in the BBR Table which are in use.  Unused entries have a BadSector of -1.  The whole table is
+     checked, as entries are not guaranteed to be used in order.  An entry which relocates a sector outside of the
+     partition, or to a sector which is not one of the replacement sectors, can only be the result of a damaged table,
+     so it is ignored rather than used to send I/O somewhere it does not belong.                                         */
+  for ( Table_Index = 0; Table_Index < BBR_Data->BBR_Table_Size; Table_Index++ )
+  {
+
+    if ( BBR_Data->BBR_Table[Table_Index].BadSector == (CARDINAL32) -1 )
+      continue;
+
+    if ( Valid_BBR_Entry( PartitionRecord, BBR_Data, &(BBR_Data->BBR_Table[Table_Index]) ) )
+      Entries_Found++;
+    else
+      Entries_Dropped++;
+
+  }
+
+  if ( ( Entries_Dropped > 0 ) && LVM_Common_Services->Logging_Enabled )
+  {
+
+    sprintf(LVM_Common_Services->Log_Buffer,"%d (decimal) entries in the BBR Table are out of range and will be ignored.", Entries_Dropped);
+    LVM_Common_Services->Write_Log_Buffer();
+
+  }
+
+  if ( Entries_Found > 0 )
+  {
+
+    BBR_Data->Remap_Table = (BBR_Table_Entry *) LVM_Common_Services->Allocate( Entries_Found * sizeof(BBR_Table_Entry) );
+    if ( BBR_Data->Remap_Table == NULL )
+    {
+
+      if ( LVM_Common_Services->Logging_Enabled )
+      {
+
+        sprintf(LVM_Common_Services->Log_Buffer,"Could not allocate memory for the sorted BBR Table!  %d (decimal) bytes are needed.", Entries_Found * sizeof(BBR_Table_Entry) );
+        LVM_Common_Services->Write_Log_Buffer();
+
+      }
+
+      FEATURE_FUNCTION_EXIT("Build_Remap_Table")
+
+      return FALSE;
+
+    }
+
+    /* Copy the entries in use, then sort them so that they can be searched quickly. */
+    Entries_Found = 0;
+    for ( Table_Index = 0; Table_Index < BBR_Data->BBR_Table_Size; Table_Index++ )
+    {
+
+      if ( ( BBR_Data->BBR_Table[Table_Index].BadSector != (CARDINAL32) -1 ) &&
+           Valid_BBR_Entry( PartitionRecord, BBR_Data, &(BBR_Data->BBR_Table[Table_Index]) ) )
+      {
+
+        BBR_Data->Remap_Table[Entries_Found] = BBR_Data->BBR_Table[Table_Index];
+        Entries_Found++;
+
+      }
+
+    }
+
+    qsort( BBR_Data->Remap_Table, Entries_Found, sizeof(BBR_Table_Entry), &Compare_BBR_Entries );
+
+  }
+
+  BBR_Data->Remap_Count = Entries_Found;
+  BBR_Data->Remap_Table_Built = TRUE;
+
+  if ( LVM_Common_Services->Logging_Enabled )
+  {
+
+    sprintf(LVM_Common_Services->Log_Buffer,"The BBR Table has %d (decimal) relocated sectors.", Entries_Found);
+    LVM_Common_Services->Write_Log_Buffer();
+
+  }
+
+  FEATURE_FUNCTION_EXIT("Build_Remap_Table")
+
+  return TRUE;
+
+}
+
+
+static BOOLEAN Range_Is_Relocated( Partition_Data * PartitionRecord, BBR_Data_Record * BBR_Data, LBA Starting_Sector, CARDINAL32 Sector_Count )
+{
+
+  BBR_Table_Entry *  Remap_Table = BBR_Data->Remap_Table;
+  CARDINAL32         Remap_Count = BBR_Data->Remap_Count;
+  CARDINAL32         Low;
+  CARDINAL32         High;
+  CARDINAL32         Middle;
+  LBA                Current_Sector;                  /* Starting_Sector as an offset from the start of the partition. */
+
+  /* Sectors before the start of the partition are never relocated, and neither are the sectors of an empty request. */
+  if ( ( Sector_Count == 0 ) || ( Remap_Count == 0 ) || ( Starting_Sector < PartitionRecord->Starting_Sector ) )
+    return FALSE;
+
+  Current_Sector = Starting_Sector - PartitionRecord->Starting_Sector;
+
+  /* Find the first relocated sector at or after the start of the request. */
+  Low = 0;
+  High = Remap_Count;
+  while ( Low < High )
+  {
+
+    Middle = ( Low + High ) / 2;
+
+    if ( Remap_Table[Middle].BadSector < Current_Sector )
+      Low = Middle + 1;
+    else
+      High = Middle;
+
+  }
+
+  return ( ( Low < Remap_Count ) && ( Remap_Table[Low].BadSector - Current_Sector < Sector_Count ) );
+
+}
+
+
+static void Transfer_Sectors( Partition_Data * PartitionRecord, BBR_Data_Record * BBR_Data, Plugin_Function_Table_V1 * Old_Function_Table, LBA Starting_Sector, CARDINAL32 Sector_Count, ADDRESS Buffer, BOOLEAN Write, CARDINAL32 * Error_Code )
+{
+
+  BBR_Table_Entry *  Remap_Table;
+  CARDINAL32         Remap_Count;
+  CARDINAL32         Low;
+  CARDINAL32         High;
+  CARDINAL32         Middle;
+  CARDINAL32         Run_Size;
+  LBA                Current_Sector;                  /* Starting_Sector as an offset from the start of the partition. */
+  LBA                Last_Sector;
+  LBA                Target_Sector;
+  BYTE *             Current_Buffer = (BYTE *) Buffer;
+
+  FEATURE_FUNCTION_ENTRY("Transfer_Sectors")
+
+  /* The sorted table of relocated sectors is built the first time it is needed. */
+  if ( ! BBR_Data->Remap_Table_Built )
+  {
+
+    if ( ! Build_Remap_Table( PartitionRecord, BBR_Data ) )
+    {
+
+      /* We can not tell which sectors have been relocated, so we can not do the I/O safely. */
+      *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+      FEATURE_FUNCTION_EXIT("Transfer_Sectors")
+
+      return;
+
+    }
+
+  }
+
+  Remap_Table = BBR_Data->Remap_Table;
+  Remap_Count = BBR_Data->Remap_Count;
+
+  /* The BBR Table holds sector numbers relative to the start of the partition. */
+  Current_Sector = Starting_Sector - PartitionRecord->Starting_Sector;
+  Last_Sector = Current_Sector + Sector_Count - 1;
+
+  /* Most requests do not touch a relocated sector, so check the request against the range of relocated sectors first. */
+  if ( ( Sector_Count == 0 ) ||
+       ( Remap_Count == 0 ) ||
+       ( Starting_Sector < PartitionRecord->Starting_Sector ) ||
+       ( Current_Sector > Remap_Table[Remap_Count - 1].BadSector ) ||
+       ( Last_Sector < Remap_Table[0].BadSector )
+     )
+  {
+
+    if ( Write )
+      Old_Function_Table->Write(PartitionRecord, Starting_Sector, Sector_Count, Buffer, Error_Code);
+    else
+      Old_Function_Table->Read(PartitionRecord, Starting_Sector, Sector_Count, Buffer, Error_Code);
+
+    FEATURE_FUNCTION_EXIT("Transfer_Sectors")
+
+    return;
+
+  }
+
+  /* Find the first relocated sector at or after the start of the request. */
+  Low = 0;
+  High = Remap_Count;
+  while ( Low < High )
+  {
+
+    Middle = ( Low + High ) / 2;
+
+    if ( Remap_Table[Middle].BadSector < Current_Sector )
+      Low = Middle + 1;
+    else
+      High = Middle;
+
+  }
+
+  /* Split the request into runs of sectors which have not been relocated, which are sent along as they are, and relocated
+     sectors, which are sent to their replacement sectors one at a time.                                                    */
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+  while ( Sector_Count > 0 )
+  {
+
+    if ( ( Low < Remap_Count ) && ( Remap_Table[Low].BadSector == Current_Sector ) )
+    {
+
+      Target_Sector = PartitionRecord->Starting_Sector + Remap_Table[Low].ReplacementSector;
+      Run_Size = 1;
+
+      /* Skip any duplicate entries for this sector. */
+      while ( ( Low < Remap_Count ) && ( Remap_Table[Low].BadSector == Current_Sector ) )
+        Low++;
+
+    }
+    else
+    {
+
+      Target_Sector = Starting_Sector;
+      Run_Size = Sector_Count;
+
+      /* Stop the run at the next relocated sector. */
+      if ( ( Low < Remap_Count ) && ( Remap_Table[Low].BadSector - Current_Sector < Run_Size ) )
+        Run_Size = Remap_Table[Low].BadSector - Current_Sector;
+
+    }
+
+    if ( Write )
+      Old_Function_Table->Write(PartitionRecord, Target_Sector, Run_Size, Current_Buffer, Error_Code);
+    else
+      Old_Function_Table->Read(PartitionRecord, Target_Sector, Run_Size, Current_Buffer, Error_Code);
+
+    if ( *Error_Code != LVM_ENGINE_NO_ERROR )
+      break;
+
+    Starting_Sector += Run_Size;
+    Current_Sector += Run_Size;
+    Sector_Count -= Run_Size;
+    Current_Buffer += Run_Size * BYTES_PER_SECTOR;
+
+  }
+
+  FEATURE_FUNCTION_EXIT("Transfer_Sectors")
+
+  return;
+
+}
+
+
 static void _System Remove_BBR_Data(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error_Code)
 {
 
@@ -2402,6 +2642,9 @@ static void _System Remove_BBR_Data(ADDRESS Object, TAG ObjectTag, CARDINAL32 Ob
   if ( BBR_Data->BBR_Table != NULL )
     LVM_Common_Services->Deallocate(BBR_Data->BBR_Table);
 
+  if ( BBR_Data->Remap_Table != NULL )
+    LVM_Common_Services->Deallocate(BBR_Data->Remap_Table);
+
   /* Calculate the number of sectors required to hold the BBR Table. */
   Sectors_Per_Table = BBR_Data->BBR_Table_Size / BBR_TABLE_ENTRIES_PER_SECTOR;
   if ( (BBR_Data->BBR_Table_Size % BBR_TABLE_ENTRIES_PER_SECTOR) != 0 )
@@ -36,9 +36,13 @@
 
 #include "lvm_plug.h"
 
+#include "diskio.h"
+
 void BBR_Get_Required_LVM_Version( CARDINAL32 * Major_Version_Number, CARDINAL32 * Minor_Version_Number);
 
 ADDRESS BBR_Exchange_Function_Tables( ADDRESS Common_Services );
 
+BOOLEAN BBR_Start_Transfer( Partition_Data * PartitionRecord, Sector_IO_Request * Request );
+
 #endif
 
@@ -27,6 +27,8 @@
 /*
  * Functions: CARDINAL32 CalculateCRC
  *            void       Build_CRC_Table
+ *            CARDINAL32 CombineCRC
+ *            CARDINAL32 PatchCRC
  *
  * Description: The functions in this module provide a means of calculating
  *              the 32 bit CRC for a block of data.  Build_CRC_Table must
@@ -39,16 +41,36 @@
  * Notes: Build_CRC_Table only needs to be called once.  Once the internal
  *        CRC table has been built, there is no need to build it again.
  *
+ *        CalculateCRC processes 8 bytes at a time using a set of 8 tables
+ *        (the "slicing-by-8" method).  When built with GCC for x86, and
+ *        running on a processor with the PCLMULQDQ instruction, buffers of
+ *        64 bytes or more are folded 64 bytes at a time using carry-less
+ *        multiplication instead.  Build_CRC_Table decides which method to
+ *        use.  All methods produce the same CRC values.
+ *
  */
 
 #define NEED_BYTE_DEFINED
 #include "gbltypes.h" /* CARDINAL32, BYTE, ADDRESS */
+#include "crc.h"      /* INITIAL_CRC */
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+
+#define CRC_PCLMUL_SUPPORTED 1
+
+#include <wmmintrin.h>  /* _mm_clmulepi64_si128 */
+#include <emmintrin.h>  /* __m128i and the SSE2 intrinsics */
+
+#endif
 
 
 /*--------------------------------------------------
  * Private Constants
  --------------------------------------------------*/
 #define CRC_POLYNOMIAL     0xEDB88320L
+#define CRC_SLICES         8             /* The number of bytes processed at a time by the table driven method. */
+#define CRC_FOLD_MINIMUM   64            /* The smallest buffer that the PCLMULQDQ method will process. */
+#define CRC_X0             0x80000000L   /* The polynomial x^0 (i.e. 1) in the bit reflected representation used here. */
 
 
 
@@ -60,12 +82,30 @@
 /*--------------------------------------------------
  * Private Global Variables.
  --------------------------------------------------*/
-static CARDINAL32 CRC_Table[ 256 ];                     /* Used by the CalculateCRC function. */
+static CARDINAL32 CRC_Table[ CRC_SLICES ][ 256 ];       /* Used by the CalculateCRC function.  CRC_Table[0] is the classic byte at a time table.
+                                                           CRC_Table[n][i] is the CRC of byte i followed by n zero bytes.                       */
+
+static CARDINAL32 X2N_Table[ 32 ];                      /* X2N_Table[k] is x^(2^k) modulo the CRC polynomial.  Used to advance a CRC past zero bytes. */
+
+#ifdef CRC_PCLMUL_SUPPORTED
+
+static BOOLEAN    Use_PCLMUL = FALSE;                   /* Set by Build_CRC_Table if the processor supports PCLMULQDQ. */
+
+#endif
 
 
 /*--------------------------------------------------
- * There are no Private functions.
+ * Private functions.
  --------------------------------------------------*/
+static CARDINAL32 Multiply_Modulo_P( CARDINAL32 A, CARDINAL32 B );
+
+static CARDINAL32 Advance_CRC( CARDINAL32 CRC, CARDINAL32 Byte_Count );
+
+#ifdef CRC_PCLMUL_SUPPORTED
+
+static CARDINAL32 Fold_CRC( CARDINAL32 CRC, BYTE * Buffer, CARDINAL32 BufferSize ) __attribute__(( target("pclmul,sse2") ));
+
+#endif
 
 
 
@@ -116,10 +156,43 @@ void _System Build_CRC_Table( void )
             CRC >>= 1;
       }
 
-      CRC_Table[ i ] = CRC;
+      CRC_Table[ 0 ][ i ] = CRC;
+
+    }
+
+    /* Each of the remaining tables extends the previous one by a zero byte. */
+    for ( j = 1; j < CRC_SLICES; j++ )
+    {
+
+      for ( i = 0; i <= 255 ; i++ )
+      {
+
+        CRC = CRC_Table[ j - 1 ][ i ];
+        CRC_Table[ j ][ i ] = ( CRC >> 8 ) ^ CRC_Table[ 0 ][ CRC & 0xff ];
+
+      }
 
     }
 
+    /* Build the table of x^(2^k) used to advance a CRC past a run of zero bytes. */
+    CRC = CRC_X0 >> 1;   /* x^1 */
+
+    for ( j = 0; j < 32; j++ )
+    {
+
+      X2N_Table[ j ] = CRC;
+      CRC = Multiply_Modulo_P( CRC, CRC );
+
+    }
+
+#ifdef CRC_PCLMUL_SUPPORTED
+
+    __builtin_cpu_init();
+
+    Use_PCLMUL = ( __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse2") );
+
+#endif
+
 }
 
 
@@ -156,18 +229,54 @@ CARDINAL32 _System CalculateCRC( CARDINAL32 CRC, ADDRESS Buffer, CARDINAL32 Buff
   BYTE   *   Current_Byte;
   CARDINAL32 Temp1;
   CARDINAL32 Temp2;
-  CARDINAL32 I;             /* Used to walk the buffer. */
+  CARDINAL32 Fold_Size;     /* The number of bytes handed to Fold_CRC. */
 
   /* Establish access to the buffer on a byte by byte basis. */
   Current_Byte = ( BYTE *) Buffer;
 
-  /* Process each byte in the buffer. */
-  for ( I = 0; I < BufferSize; I++ )
+  /* Only the low 32 bits of the CRC are meaningful. */
+  CRC &= 0xFFFFFFFFL;
+
+#ifdef CRC_PCLMUL_SUPPORTED
+
+  /* Fold as many 16 byte blocks as we can, and leave the rest for the table driven method. */
+  if ( Use_PCLMUL && ( BufferSize >= CRC_FOLD_MINIMUM ) )
+  {
+
+    Fold_Size = BufferSize & ~( (CARDINAL32) 15 );
+    CRC = Fold_CRC( CRC, Current_Byte, Fold_Size );
+    Current_Byte += Fold_Size;
+    BufferSize -= Fold_Size;
+
+  }
+
+#endif
+
+  /* Process the buffer 8 bytes at a time.  The bytes are combined individually so that the result does not depend upon the byte order
+     of the processor or upon the alignment of the buffer.                                                                             */
+  while ( BufferSize >= CRC_SLICES )
+  {
+
+    Temp1 = CRC ^ ( (CARDINAL32) Current_Byte[0] | ( (CARDINAL32) Current_Byte[1] << 8 ) | ( (CARDINAL32) Current_Byte[2] << 16 ) | ( (CARDINAL32) Current_Byte[3] << 24 ) );
+
+    CRC = CRC_Table[ 7 ][ Temp1 & 0xff ]          ^ CRC_Table[ 6 ][ ( Temp1 >> 8 ) & 0xff ] ^
+          CRC_Table[ 5 ][ ( Temp1 >> 16 ) & 0xff ] ^ CRC_Table[ 4 ][ ( Temp1 >> 24 ) & 0xff ] ^
+          CRC_Table[ 3 ][ Current_Byte[4] ]         ^ CRC_Table[ 2 ][ Current_Byte[5] ]        ^
+          CRC_Table[ 1 ][ Current_Byte[6] ]         ^ CRC_Table[ 0 ][ Current_Byte[7] ];
+
+    Current_Byte += CRC_SLICES;
+    BufferSize -= CRC_SLICES;
+
+  }
+
+  /* Process any bytes left over one at a time. */
+  while ( BufferSize > 0 )
   {
 
     Temp1 = (CRC >> 8) & 0x00FFFFFFL;
-    Temp2 = CRC_Table[ ( CRC ^ (CARDINAL32) *Current_Byte ) & (CARDINAL32) 0xff ];
+    Temp2 = CRC_Table[ 0 ][ ( CRC ^ (CARDINAL32) *Current_Byte ) & (CARDINAL32) 0xff ];
     Current_Byte++;
+    BufferSize--;
     CRC = Temp1 ^ Temp2;
 
   }
@@ -177,4 +286,311 @@ CARDINAL32 _System CalculateCRC( CARDINAL32 CRC, ADDRESS Buffer, CARDINAL32 Buff
 }
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: CombineCRC                                       */
+/*                                                                   */
+/*   Descriptive Name: This function calculates the CRC of two blocks*/
+/*                     of data placed end to end, given the CRC of   */
+/*                     each block.                                   */
+/*                                                                   */
+/*   Input: CARDINAL32 CRC1 : The CRC of the first block, as returned*/
+/*                            by CalculateCRC.                       */
+/*          CARDINAL32 CRC2 : The CRC of the second block, as        */
+/*                            returned by CalculateCRC when starting */
+/*                            from INITIAL_CRC.                      */
+/*          CARDINAL32 Length2 : The size, in bytes, of the second   */
+/*                               block.                              */
+/*                                                                   */
+/*   Output: The value that CalculateCRC would have returned had it  */
+/*           been called on the second block with CRC1 as its        */
+/*           starting CRC.                                           */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  The time taken depends upon the number of bits in       */
+/*           Length2, not upon its value, so the CRCs of the pieces  */
+/*           of a large buffer may be calculated separately (even at */
+/*           the same time) and then combined cheaply.               */
+/*                                                                   */
+/*********************************************************************/
+CARDINAL32 _System CombineCRC( CARDINAL32 CRC1, CARDINAL32 CRC2, CARDINAL32 Length2 )
+{
+
+  /* Since CalculateCRC does no final inversion, CalculateCRC(CRC1, Block2) is CRC1 advanced past Length2 zero bytes, XORed with
+     CalculateCRC(0, Block2).  CRC2 is CalculateCRC(INITIAL_CRC, Block2), which differs from CalculateCRC(0, Block2) by INITIAL_CRC
+     advanced past Length2 zero bytes.                                                                                              */
+  return Advance_CRC( ( CRC1 ^ INITIAL_CRC ) & 0xFFFFFFFFL, Length2 ) ^ ( CRC2 & 0xFFFFFFFFL );
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: PatchCRC                                         */
+/*                                                                   */
+/*   Descriptive Name: This function updates the CRC of a buffer to  */
+/*                     account for a change to some of the bytes in  */
+/*                     the buffer, without processing the rest of the*/
+/*                     buffer.                                       */
+/*                                                                   */
+/*   Input: CARDINAL32 Old_CRC : The CRC of the buffer before the    */
+/*                               change.                             */
+/*          CARDINAL32 BufferSize : The size of the buffer, in bytes.*/
+/*          CARDINAL32 Offset : The offset, within the buffer, of the*/
+/*                              first byte changed.                  */
+/*          ADDRESS Old_Bytes : The bytes which were at Offset.      */
+/*          ADDRESS New_Bytes : The bytes which are now at Offset.   */
+/*          CARDINAL32 Count : The number of bytes changed.          */
+/*                                                                   */
+/*   Output: The CRC of the buffer after the change.                 */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  Old_CRC may have been calculated from any starting CRC. */
+/*           The result is the same as calling CalculateCRC on the   */
+/*           changed buffer from that starting CRC.  Offset + Count  */
+/*           must not exceed BufferSize.                             */
+/*                                                                   */
+/*********************************************************************/
+CARDINAL32 _System PatchCRC( CARDINAL32 Old_CRC, CARDINAL32 BufferSize, CARDINAL32 Offset, ADDRESS Old_Bytes, ADDRESS New_Bytes, CARDINAL32 Count )
+{
+
+  BYTE *     Old_Byte = (BYTE *) Old_Bytes;
+  BYTE *     New_Byte = (BYTE *) New_Bytes;
+  CARDINAL32 Delta_CRC = 0;    /* The CRC, from 0, of the bytes which differ between the old and new contents. */
+  CARDINAL32 I;
+
+  /* The CRC is linear in the data, so the change in the CRC is the CRC, from 0, of the XOR of the old and new bytes, advanced past
+     the bytes which follow them in the buffer.                                                                                     */
+  for ( I = 0; I < Count; I++ )
+    Delta_CRC = ( Delta_CRC >> 8 ) ^ CRC_Table[ 0 ][ ( Delta_CRC ^ (CARDINAL32) ( Old_Byte[I] ^ New_Byte[I] ) ) & 0xff ];
+
+  return ( Old_CRC & 0xFFFFFFFFL ) ^ Advance_CRC( Delta_CRC, BufferSize - Offset - Count );
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Multiply_Modulo_P                                */
+/*                                                                   */
+/*   Descriptive Name: Multiplies two polynomials modulo the CRC     */
+/*                     polynomial.                                   */
+/*                                                                   */
+/*   Input: CARDINAL32 A, B : The polynomials to multiply, in the bit*/
+/*                            reflected form used by CalculateCRC.   */
+/*                                                                   */
+/*   Output: A * B modulo the CRC polynomial.                        */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static CARDINAL32 Multiply_Modulo_P( CARDINAL32 A, CARDINAL32 B )
+{
+
+  CARDINAL32 Mask = CRC_X0;
+  CARDINAL32 Product = 0;
+
+  while ( ( A & 0xFFFFFFFFL ) != 0 )
+  {
+
+    if ( A & Mask )
+    {
+
+      Product ^= B;
+      A ^= Mask;
+
+    }
+
+    Mask >>= 1;
+    B = ( B & 1 ) ? ( B >> 1 ) ^ CRC_POLYNOMIAL : B >> 1;
+
+  }
+
+  return Product;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Advance_CRC                                      */
+/*                                                                   */
+/*   Descriptive Name: Calculates the effect of processing a run of  */
+/*                     zero bytes on a CRC.                          */
+/*                                                                   */
+/*   Input: CARDINAL32 CRC : The starting CRC.                       */
+/*          CARDINAL32 Byte_Count : The number of zero bytes.        */
+/*                                                                   */
+/*   Output: CalculateCRC( CRC, <Byte_Count zero bytes> ).           */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  This multiplies CRC by x^(8 * Byte_Count), one power of */
+/*           two at a time using X2N_Table.                          */
+/*                                                                   */
+/*********************************************************************/
+static CARDINAL32 Advance_CRC( CARDINAL32 CRC, CARDINAL32 Byte_Count )
+{
+
+  CARDINAL32 Power = 3;   /* Start at x^(2^3), since each byte is 8 bits. */
+
+  Byte_Count &= 0xFFFFFFFFL;
+
+  while ( Byte_Count != 0 )
+  {
+
+    if ( Byte_Count & 1 )
+      CRC = Multiply_Modulo_P( X2N_Table[ Power ], CRC );
+
+    Byte_Count >>= 1;
+    Power = ( Power + 1 ) & 31;
+
+  }
+
+  return CRC;
+
+}
+
+
+#ifdef CRC_PCLMUL_SUPPORTED
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Fold_CRC                                         */
+/*                                                                   */
+/*   Descriptive Name: Calculates the CRC of a buffer using carry-   */
+/*                     less multiplication (PCLMULQDQ).              */
+/*                                                                   */
+/*   Input: CARDINAL32 CRC : The starting CRC, as for CalculateCRC.  */
+/*          BYTE * Buffer : The data to process.                     */
+/*          CARDINAL32 BufferSize : The number of bytes to process.  */
+/*                                  This must be a multiple of 16,   */
+/*                                  and at least CRC_FOLD_MINIMUM.   */
+/*                                                                   */
+/*   Output: The same CRC that the table driven method would produce.*/
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  Four 128 bit accumulators are folded forward 64 bytes   */
+/*           at a time, then folded into one, which is reduced to 32 */
+/*           bits using Barrett reduction.  The constants are powers */
+/*           of x modulo the bit reflected CRC polynomial, as given  */
+/*           in Intel's paper "Fast CRC Computation for Generic      */
+/*           Polynomials Using PCLMULQDQ Instruction".               */
+/*                                                                   */
+/*********************************************************************/
+static CARDINAL32 Fold_CRC( CARDINAL32 CRC, BYTE * Buffer, CARDINAL32 BufferSize )
+{
+
+  __m128i  Fold_By_4;       /* x^(512+32) mod P and x^(512-32) mod P, used to fold 64 bytes forward. */
+  __m128i  Fold_By_1;       /* x^(128+32) mod P and x^(128-32) mod P, used to fold 16 bytes forward. */
+  __m128i  Barrett;         /* P and floor(x^64 / P), used for the final reduction. */
+  __m128i  Low_32_Mask;
+  __m128i  X1, X2, X3, X4;  /* The accumulators. */
+  __m128i  T1, T2, T3, T4;
+
+  Fold_By_4   = _mm_set_epi64x( 0x01C6E41596LL, 0x0154442BD4LL );
+  Fold_By_1   = _mm_set_epi64x( 0x00CCAA009ELL, 0x01751997D0LL );
+  Barrett     = _mm_set_epi64x( 0x01F7011641LL, 0x01DB710641LL );
+  Low_32_Mask = _mm_setr_epi32( ~0, 0, ~0, 0 );
+
+  /* Load the first 64 bytes and fold in the starting CRC. */
+  X1 = _mm_loadu_si128( (__m128i *) ( Buffer + 0x00 ) );
+  X2 = _mm_loadu_si128( (__m128i *) ( Buffer + 0x10 ) );
+  X3 = _mm_loadu_si128( (__m128i *) ( Buffer + 0x20 ) );
+  X4 = _mm_loadu_si128( (__m128i *) ( Buffer + 0x30 ) );
+
+  X1 = _mm_xor_si128( X1, _mm_cvtsi32_si128( (int) CRC ) );
+
+  Buffer += 64;
+  BufferSize -= 64;
+
+  /* Fold 64 bytes at a time. */
+  while ( BufferSize >= 64 )
+  {
+
+    T1 = _mm_clmulepi64_si128( X1, Fold_By_4, 0x00 );
+    T2 = _mm_clmulepi64_si128( X2, Fold_By_4, 0x00 );
+    T3 = _mm_clmulepi64_si128( X3, Fold_By_4, 0x00 );
+    T4 = _mm_clmulepi64_si128( X4, Fold_By_4, 0x00 );
+
+    X1 = _mm_clmulepi64_si128( X1, Fold_By_4, 0x11 );
+    X2 = _mm_clmulepi64_si128( X2, Fold_By_4, 0x11 );
+    X3 = _mm_clmulepi64_si128( X3, Fold_By_4, 0x11 );
+    X4 = _mm_clmulepi64_si128( X4, Fold_By_4, 0x11 );
+
+    X1 = _mm_xor_si128( _mm_xor_si128( X1, T1 ), _mm_loadu_si128( (__m128i *) ( Buffer + 0x00 ) ) );
+    X2 = _mm_xor_si128( _mm_xor_si128( X2, T2 ), _mm_loadu_si128( (__m128i *) ( Buffer + 0x10 ) ) );
+    X3 = _mm_xor_si128( _mm_xor_si128( X3, T3 ), _mm_loadu_si128( (__m128i *) ( Buffer + 0x20 ) ) );
+    X4 = _mm_xor_si128( _mm_xor_si128( X4, T4 ), _mm_loadu_si128( (__m128i *) ( Buffer + 0x30 ) ) );
+
+    Buffer += 64;
+    BufferSize -= 64;
+
+  }
+
+  /* Fold the four accumulators into one. */
+  T1 = _mm_clmulepi64_si128( X1, Fold_By_1, 0x00 );
+  X1 = _mm_clmulepi64_si128( X1, Fold_By_1, 0x11 );
+  X1 = _mm_xor_si128( _mm_xor_si128( X1, T1 ), X2 );
+
+  T1 = _mm_clmulepi64_si128( X1, Fold_By_1, 0x00 );
+  X1 = _mm_clmulepi64_si128( X1, Fold_By_1, 0x11 );
+  X1 = _mm_xor_si128( _mm_xor_si128( X1, T1 ), X3 );
+
+  T1 = _mm_clmulepi64_si128( X1, Fold_By_1, 0x00 );
+  X1 = _mm_clmulepi64_si128( X1, Fold_By_1, 0x11 );
+  X1 = _mm_xor_si128( _mm_xor_si128( X1, T1 ), X4 );
+
+  /* Fold in any remaining 16 byte blocks. */
+  while ( BufferSize >= 16 )
+  {
+
+    T1 = _mm_clmulepi64_si128( X1, Fold_By_1, 0x00 );
+    X1 = _mm_clmulepi64_si128( X1, Fold_By_1, 0x11 );
+    X1 = _mm_xor_si128( _mm_xor_si128( X1, T1 ), _mm_loadu_si128( (__m128i *) Buffer ) );
+
+    Buffer += 16;
+    BufferSize -= 16;
+
+  }
+
+  /* Reduce 128 bits to 64 bits. */
+  T1 = _mm_clmulepi64_si128( X1, Fold_By_1, 0x10 );
+  X1 = _mm_xor_si128( _mm_srli_si128( X1, 8 ), T1 );
+
+  T1 = _mm_srli_si128( X1, 4 );
+  X1 = _mm_and_si128( X1, Low_32_Mask );
+  X1 = _mm_clmulepi64_si128( X1, _mm_set_epi64x( 0, 0x0163CD6124LL ), 0x00 );
+  X1 = _mm_xor_si128( X1, T1 );
+
+  /* Barrett reduce 64 bits to 32 bits. */
+  T1 = _mm_and_si128( X1, Low_32_Mask );
+  T1 = _mm_clmulepi64_si128( T1, Barrett, 0x10 );
+  T1 = _mm_and_si128( T1, Low_32_Mask );
+  T1 = _mm_clmulepi64_si128( T1, Barrett, 0x00 );
+  X1 = _mm_xor_si128( X1, T1 );
+
+  /* The CRC is in the second 32 bit lane. */
+  return (CARDINAL32) (unsigned int) _mm_cvtsi128_si32( _mm_srli_si128( X1, 4 ) );
+
+}
+
+#endif
+
+
 
@@ -31,11 +31,21 @@
  *            void       GetDriveGeometry
  *            void       ReadSectors
  *            void       WriteSectors
+ *            void       ReadSectorsV
+ *            void       WriteSectorsV
+ *            void       SubmitSectorIO
+ *            Sector_IO_Request * ReapSectorIO
+ *
+ *            FlushSectorCache, SetSectorCacheSize and
+ *            GetSectorCacheStatistics are implemented in Sector_Cache.c.
  *
  * Description: This module provides an LBA based means of reading and writing
  *              to the various disk drives in the system.
  *
- * Notes: This module is single threaded and is not reentrant.
+ * Notes: This module is single threaded and is not reentrant.  OS/2 provides
+ *        no asynchronous form of DosDevIOCtl, so SubmitSectorIO performs each
+ *        request before returning and ReapSectorIO hands the completed
+ *        requests back in the order they were submitted.
  *
  */
 
@@ -59,6 +69,7 @@
 #include "lvm_intr.h"        /* Get_LVM_View */
 #include "dlist.h"           /* DLIST, CreateList, InsertItem */
 #include "diskio.h"          /* Prototypes for functions in this file. */
+#include "Sector_Cache.h"    /* Create_Sector_Cache, Destroy_Sector_Cache, Cache_IO_Vector, Cache_Prepare_Range */
 #include "logging.h"
 
 #ifdef DEBUG
@@ -145,6 +156,8 @@ typedef struct _DDI_SETPRMSTATE_data
 --------------------------------------------------*/
 static CARDINAL16       DriveCount = 0;       /* The number of hard drives in the system. */
 static DiskDriveData *  DriveTable = NULL;    /* Points to an array of DiskDriveData structures - 1 per physical drive in the system. */
+static Sector_IO_Request * Completed_Head = NULL;  /* The oldest request completed by SubmitSectorIO which has not been reaped. */
+static Sector_IO_Request * Completed_Tail = NULL;  /* The newest request completed by SubmitSectorIO which has not been reaped. */
 
 
 /*--------------------------------------------------
@@ -157,6 +170,17 @@ static void Do_IO ( CARDINAL32   Drive_Number,
                     BOOLEAN      Write,
                     CARDINAL32 * Error);
 
+static void Do_IO_Vector ( CARDINAL32          Drive_Number,
+                           Sector_IO_Segment * Segments,
+                           CARDINAL32          Segment_Count,
+                           BOOLEAN             Write,
+                           CARDINAL32 *        Error);
+
+static BOOLEAN Check_IO_Request( CARDINAL32   Drive_Number,
+                                 LBA          Starting_Sector,
+                                 CARDINAL32   SectorCount,
+                                 CARDINAL32 * Error );
+
 
 /*--------------------------------------------------
  There are no public global variables.
@@ -215,6 +239,12 @@ CARDINAL32 Rediscover( PDDI_Rediscover_param  Rediscovery_Parameters, PDDI_Redis
   CARDINAL32           Parameter_Size;     /* Used for the DosDevIOCtl API. */
   CARDINAL32           Data_Size;          /* Used for the DosDevIOCtl API. */
   APIRET               Return_Code;        /* Used for the DosDevIOCtl API. */
+  CARDINAL32           Cache_Error;        /* Used to hold the error return code from FlushSectorCache. */
+
+  /* OS2DASD and OS2LVM will read the partition tables from disk, so anything still in the sector cache must be written first. */
+  FlushSectorCache( 0, &Cache_Error );
+  if ( Cache_Error != DISKIO_NO_ERROR )
+    return ERROR_WRITE_FAULT;
 
   /* Initialize the IOCTL data. */
   Data_Size =  ( Rediscovery_Data->DDI_TotalExtends * sizeof(DDI_ExtendRecord) ) + sizeof(DDI_Rediscover_data) - sizeof(DDI_ExtendRecord);
@@ -795,6 +825,16 @@ BOOLEAN OpenDrives( CARDINAL32 * Error )
 
   }
 
+  /* Set up the sector cache for the drives we just opened. */
+  if ( ! Create_Sector_Cache( DriveCount, &Check_IO_Request, &Do_IO_Vector, Error ) )
+  {
+
+    CloseDrives();
+
+    return FALSE;
+
+  }
+
 
   /* All done!  Signal success! */
   *Error = DISKIO_NO_ERROR;
@@ -816,7 +856,8 @@ BOOLEAN OpenDrives( CARDINAL32 * Error )
 /*                                                                   */
 /*   Output: None.                                                   */
 /*                                                                   */
-/*   Error Handling: N/A                                             */
+/*   Error Handling: If the sectors held in the sector cache can not */
+/*                   be written to disk, the failure is logged.      */
 /*                                                                   */
 /*   Side Effects: All drive handles opened by OpenDrives are closed.*/
 /*                 All memory allocated by OpenDrives is released.   */
@@ -828,6 +869,7 @@ void CloseDrives( void )
 {
   APIRET                 ReturnCode;             /* Used to hold the return code from OS/2 API calls. */
   CARDINAL32             I;                      /* Used to traverse the DriveTable. */
+  CARDINAL32             Error;                  /* Used to hold the error return code from Destroy_Sector_Cache. */
 
   /* If the DriveTable is NULL, or if there are no drives, then we have nothing to do! */
   if ( ( DriveTable == NULL ) || ( DriveCount == 0 ) )
@@ -837,6 +879,18 @@ void CloseDrives( void )
 
   }
 
+  /* Write out anything left in the sector cache while we still have the drive handles. */
+  Destroy_Sector_Cache( &Error );
+
+  /* CloseDrives has no way to return an error, so record the sectors which were lost in the log. */
+  if ( ( Error != DISKIO_NO_ERROR ) && Logging_Enabled )
+  {
+
+    sprintf(Log_Buffer,"CloseDrives: Dirty sectors in the sector cache could not be written to disk.  Error code: %u", Error);
+    Write_Log_Buffer();
+
+  }
+
   /* Loop through the drive table.  For each initialized entry, close the drive handle and free the track layout table. */
   for ( I = 0; ( I < DriveCount ) && ( DriveTable[I].Initialized ) ; I++)
   {
@@ -863,6 +917,10 @@ void CloseDrives( void )
   DriveTable = NULL;
   DriveCount = 0;
 
+  /* Discard any completed requests which were never reaped.  The requests belong to their submitters, so there is nothing to free. */
+  Completed_Head = NULL;
+  Completed_Tail = NULL;
+
   /* Return to caller. */
   return;
 
@@ -1328,8 +1386,14 @@ void ReadSectors ( CARDINAL32   Drive_Number,
                    CARDINAL32 * Error)
 {
 
-  /* Do_IO is our common routine for reading or writing.  Call it here and indicate that we want to Read, not write. */
-  Do_IO( Drive_Number, Starting_Sector, Sectors_To_Read, Buffer, FALSE, Error);
+  Sector_IO_Segment   Segment;    /* Describes the request to the sector cache. */
+
+  Segment.Starting_Sector = Starting_Sector;
+  Segment.Sector_Count = Sectors_To_Read;
+  Segment.Buffer = Buffer;
+
+  /* The sector cache will call Do_IO_Vector for anything it can't supply itself.  Indicate that we want to Read, not write. */
+  Cache_IO_Vector( Drive_Number, &Segment, 1, FALSE, Error);
 
   return;
 
@@ -1377,11 +1441,211 @@ void WriteSectors ( CARDINAL32   Drive_Number,
                     CARDINAL32 * Error)
 {
 
-  /* Do_IO is our common routine for reading or writing.  Call it here and indicate that we want to Write, not read. */
-  Do_IO( Drive_Number, Starting_Sector, Sectors_To_Write, Buffer, TRUE, Error);
+  Sector_IO_Segment   Segment;    /* Describes the request to the sector cache. */
+
+  Segment.Starting_Sector = Starting_Sector;
+  Segment.Sector_Count = Sectors_To_Write;
+  Segment.Buffer = Buffer;
+
+  /* The sector cache holds the data until it is flushed, or hands it to Do_IO_Vector if it is too large to cache.  Indicate that
+     we want to Write, not read.                                                                                                  */
+  Cache_IO_Vector( Drive_Number, &Segment, 1, TRUE, Error);
+
+  return;
+
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: ReadSectorsV                                     */
+/*                                                                   */
+/*   Descriptive Name: This function reads several groups of sectors */
+/*                     from the specified drive, placing each group  */
+/*                     in its own buffer.                            */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the hard drive to*/
+/*                                    read from.                     */
+/*          Sector_IO_Segment * Segments : The segments to read.     */
+/*          CARDINAL32 Segment_Count : The number of entries in      */
+/*                                     Segments.                     */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If Successful, *Error will be 0.                        */
+/*           If Unsuccessful, then *Error will be > 0.               */
+/*                                                                   */
+/*   Error Handling: *Error will be > 0 if an error occurs.          */
+/*                                                                   */
+/*   Side Effects: Data may be read into the segment buffers.        */
+/*                                                                   */
+/*   Notes:  See Do_IO_Vector.                                       */
+/*                                                                   */
+/*********************************************************************/
+void ReadSectorsV ( CARDINAL32          Drive_Number,
+                    Sector_IO_Segment * Segments,
+                    CARDINAL32          Segment_Count,
+                    CARDINAL32 *        Error)
+{
+
+  /* The sector cache will call Do_IO_Vector for any segments it can't supply itself.  Indicate that we want to Read, not write. */
+  Cache_IO_Vector( Drive_Number, Segments, Segment_Count, FALSE, Error);
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: WriteSectorsV                                    */
+/*                                                                   */
+/*   Descriptive Name: This function writes several groups of sectors*/
+/*                     to the specified drive, taking the data for   */
+/*                     each group from its own buffer.               */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the hard drive to*/
+/*                                    write to.                      */
+/*          Sector_IO_Segment * Segments : The segments to write.    */
+/*          CARDINAL32 Segment_Count : The number of entries in      */
+/*                                     Segments.                     */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If Successful, *Error will be 0.                        */
+/*           If Unsuccessful, then *Error will be > 0.               */
+/*                                                                   */
+/*   Error Handling: *Error will be > 0 if an error occurs.          */
+/*                                                                   */
+/*   Side Effects: Data may be written to disk.                      */
+/*                                                                   */
+/*   Notes:  See Do_IO_Vector.                                       */
+/*                                                                   */
+/*********************************************************************/
+void WriteSectorsV ( CARDINAL32          Drive_Number,
+                     Sector_IO_Segment * Segments,
+                     CARDINAL32          Segment_Count,
+                     CARDINAL32 *        Error)
+{
+
+  /* The sector cache holds the segments until it is flushed, or hands them to Do_IO_Vector if they are too large to cache.  Indicate
+     that we want to Write, not read.                                                                                                  */
+  Cache_IO_Vector( Drive_Number, Segments, Segment_Count, TRUE, Error);
 
   return;
 
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: SubmitSectorIO                                   */
+/*                                                                   */
+/*   Descriptive Name: This function starts a read or write of one or*/
+/*                     more sectors and returns without waiting for  */
+/*                     the transfer to complete.                     */
+/*                                                                   */
+/*   Input: Sector_IO_Request * Request : The request to start.      */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If the request was accepted, *Error will be 0 and the   */
+/*           request will be returned by a later call to             */
+/*           ReapSectorIO.  If the request was not accepted, *Error  */
+/*           will be > 0.                                            */
+/*                                                                   */
+/*   Error Handling: Requests which are out of range are rejected.   */
+/*                   Errors which occur during the transfer are      */
+/*                   reported in the Error field of the request.     */
+/*                                                                   */
+/*   Side Effects: Data may be read into memory or written to disk.  */
+/*                 Cached sectors in the range of the request may be */
+/*                 written to disk or discarded.                     */
+/*                                                                   */
+/*   Notes:  The transfer is performed by Do_IO before this function */
+/*           returns.                                                */
+/*                                                                   */
+/*********************************************************************/
+void SubmitSectorIO( Sector_IO_Request * Request, CARDINAL32 * Error )
+{
+
+  /* Requests which can never be performed are rejected rather than queued. */
+  if ( ! Check_IO_Request( Request->Drive_Number, Request->Starting_Sector, Request->Sector_Count, Error ) )
+    return;
+
+  /* The request bypasses the sector cache, so make sure that the disk is up to date, and that the cache won't hold stale copies of
+     anything the request writes.                                                                                                   */
+  Cache_Prepare_Range( Request->Drive_Number, Request->Starting_Sector, Request->Sector_Count, Request->Write, Error );
+  if ( *Error != DISKIO_NO_ERROR )
+    return;
+
+  /* Do the I/O now.  The result goes into the request, where ReapSectorIO will report it. */
+  Do_IO( Request->Drive_Number, Request->Starting_Sector, Request->Sector_Count, Request->Buffer, Request->Write, &(Request->Error) );
+
+  /* Add the request to the end of the completed queue. */
+  Request->Next = NULL;
+  if ( Completed_Tail == NULL )
+    Completed_Head = Request;
+  else
+    Completed_Tail->Next = Request;
+
+  Completed_Tail = Request;
+
+  *Error = DISKIO_NO_ERROR;
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: ReapSectorIO                                     */
+/*                                                                   */
+/*   Descriptive Name: This function returns a request started by    */
+/*                     SubmitSectorIO once it has completed.         */
+/*                                                                   */
+/*   Input: BOOLEAN Wait : Ignored, since every outstanding request  */
+/*                         has already completed.                    */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: The oldest completed request, with *Error set to 0, or  */
+/*           NULL with *Error set to DISKIO_NO_IO_OUTSTANDING if     */
+/*           there are none.                                         */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+Sector_IO_Request * ReapSectorIO( BOOLEAN Wait, CARDINAL32 * Error )
+{
+
+  Sector_IO_Request *  Request;   /* The request being returned. */
+
+  Request = Completed_Head;
+  if ( Request == NULL )
+  {
+
+    *Error = DISKIO_NO_IO_OUTSTANDING;
+    return NULL;
+
+  }
+
+  /* Remove the request from the completed queue. */
+  Completed_Head = Request->Next;
+  if ( Completed_Head == NULL )
+    Completed_Tail = NULL;
+
+  Request->Next = NULL;
+
+  *Error = DISKIO_NO_ERROR;
+
+  return Request;
 
 }
 
@@ -1682,6 +1946,171 @@ static void Do_IO ( CARDINAL32   Drive_Number,
 }
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Do_IO_Vector                                     */
+/*                                                                   */
+/*   Descriptive Name: This function reads or writes each of the     */
+/*                     segments given, in order.                     */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the hard drive to*/
+/*                                    use.                           */
+/*          Sector_IO_Segment * Segments : The segments to transfer. */
+/*          CARDINAL32 Segment_Count : The number of entries in      */
+/*                                     Segments.                     */
+/*          BOOLEAN Write : If TRUE, perform writes.  If FALSE,      */
+/*                          perform reads.                           */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If Successful, *Error will be 0.                        */
+/*           If Unsuccessful, then *Error will be > 0.               */
+/*                                                                   */
+/*   Error Handling: Stops at the first segment which fails.  Every  */
+/*                   segment is range checked before any I/O is done.*/
+/*                                                                   */
+/*   Side Effects: Data may be read into memory or written to disk.  */
+/*                                                                   */
+/*   Notes:  DosDevIOCtl takes a single buffer per track, so there is*/
+/*           nothing to be gained by combining segments here.  Each  */
+/*           segment is handed to Do_IO as is.                       */
+/*                                                                   */
+/*********************************************************************/
+static void Do_IO_Vector ( CARDINAL32          Drive_Number,
+                           Sector_IO_Segment * Segments,
+                           CARDINAL32          Segment_Count,
+                           BOOLEAN             Write,
+                           CARDINAL32 *        Error)
+{
+
+  CARDINAL32     Index;                          /* Used to walk the Segments array. */
+  CARDINAL32     TotalSectors;                   /* The number of sectors on the drive. */
+
+  /* If DriveTable is NULL, then we have not been initialized yet by a call to OpenDrives, or CloseDrives has been called.
+     Return an error.                                                                                                       */
+  if ( DriveTable == NULL )
+  {
+
+    *Error = DISKIO_DRIVES_NOT_OPEN;
+    return;
+
+  }
+
+  /* Is the Drive_Number requested valid? */
+  if ( ( Drive_Number > DriveCount ) || ( Drive_Number == 0 ) )
+  {
+
+    *Error = DISKIO_REQUEST_OUT_OF_RANGE;
+    return;
+
+  }
+
+  TotalSectors = (CARDINAL32) DriveTable[Drive_Number - 1].Cylinders * (CARDINAL32) DriveTable[Drive_Number - 1].Heads * (CARDINAL32) DriveTable[Drive_Number - 1].SectorsPerTrack;
+
+  /* Make sure that every segment is on the drive before we transfer any of them. */
+  for ( Index = 0; Index < Segment_Count; Index++ )
+  {
+
+    if ( ( Segments[Index].Sector_Count > 0 ) &&
+         ( ( Segments[Index].Starting_Sector >= TotalSectors ) ||
+           ( Segments[Index].Sector_Count > TotalSectors - Segments[Index].Starting_Sector ) ) )
+    {
+
+      *Error = DISKIO_REQUEST_OUT_OF_RANGE;
+      return;
+
+    }
+
+  }
+
+  *Error = DISKIO_NO_ERROR;
+
+  for ( Index = 0; ( Index < Segment_Count ) && ( *Error == DISKIO_NO_ERROR ); Index++ )
+    Do_IO( Drive_Number, Segments[Index].Starting_Sector, Segments[Index].Sector_Count, Segments[Index].Buffer, Write, Error);
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Check_IO_Request                                 */
+/*                                                                   */
+/*   Descriptive Name: Makes sure that an I/O request refers to a    */
+/*                     drive which is open and to sectors which exist*/
+/*                     on that drive.                                */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the hard drive to*/
+/*                                    use.                           */
+/*          LBA Starting_Sector : The first sector to read from/write*/
+/*                                to.                                */
+/*          CARDINAL32 SectorCount : The number of sectors to        */
+/*                                   read/write.                     */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: TRUE if the request may be performed.  Otherwise FALSE, */
+/*           with *Error set to the reason.                          */
+/*                                                                   */
+/*   Error Handling: See Output.                                     */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  The sector cache uses this function to check requests   */
+/*           which it may satisfy without calling Do_IO.  A request  */
+/*           for 0 sectors is always accepted as long as the drive is*/
+/*           valid.                                                  */
+/*                                                                   */
+/*********************************************************************/
+static BOOLEAN Check_IO_Request( CARDINAL32   Drive_Number,
+                                 LBA          Starting_Sector,
+                                 CARDINAL32   SectorCount,
+                                 CARDINAL32 * Error )
+{
+
+  CARDINAL32     TotalSectors;                   /* The number of sectors on the drive. */
+
+  /* If DriveTable is NULL, then we have not been initialized yet by a call to OpenDrives, or CloseDrives has been called.
+     Return an error.                                                                                                       */
+  if ( DriveTable == NULL )
+  {
+
+    *Error = DISKIO_DRIVES_NOT_OPEN;
+    return FALSE;
+
+  }
+
+  /* Is the Drive_Number requested valid? */
+  if ( ( Drive_Number > DriveCount ) || ( Drive_Number == 0 ) )
+  {
+
+    *Error = DISKIO_REQUEST_OUT_OF_RANGE;
+    return FALSE;
+
+  }
+
+  *Error = DISKIO_NO_ERROR;
+
+  if ( SectorCount == 0 )
+    return TRUE;
+
+  TotalSectors = (CARDINAL32) DriveTable[Drive_Number - 1].Cylinders * (CARDINAL32) DriveTable[Drive_Number - 1].Heads * (CARDINAL32) DriveTable[Drive_Number - 1].SectorsPerTrack;
+
+  /* Are we trying to read or write past the end of the disk? */
+  if ( ( Starting_Sector >= TotalSectors ) || ( SectorCount > TotalSectors - Starting_Sector ) )
+  {
+
+    *Error = DISKIO_REQUEST_OUT_OF_RANGE;
+    return FALSE;
+
+  }
+
+  return TRUE;
+
+}
+
+
 /*********************************************************************/
 /*                                                                   */
 /*   Function Name: Issue_Ring0_Feature_Command                      */
@@ -0,0 +1,2697 @@
+/*
+ *
+ *   Copyright (c) International Business Machines  Corp., 2000
+ *
+ *   This program is free software;  you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY;  without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ *   the GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program;  if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Module: DiskIO_Linux.c
+ */
+
+/*
+ * Change History:
+ *
+ */
+
+/*
+ * Functions: BOOLEAN    OpenDrives
+ *            void       CloseDrives
+ *            CARDINAL32 GetDriveCount
+ *            void       GetDriveGeometry
+ *            void       ReadSectors
+ *            void       WriteSectors
+ *            void       ReadSectorsV
+ *            void       WriteSectorsV
+ *            void       SubmitSectorIO
+ *            Sector_IO_Request * ReapSectorIO
+ *
+ *            FlushSectorCache, SetSectorCacheSize and
+ *            GetSectorCacheStatistics are implemented in Sector_Cache.c.
+ *
+ * Description: This module provides an LBA based means of reading and writing
+ *              to the various disk drives in the system.  It implements the
+ *              interface defined in diskio.h for Linux, and is used in place
+ *              of DiskIO.c when the LVM Engine is built for Linux.
+ *
+ *              The drives to be managed are block devices or raw image files.
+ *              Their names are taken from the LVM_DISKS environment variable,
+ *              which holds a ':' separated list of path names.  If LVM_DISKS
+ *              is not set, then the names are read from the file named by the
+ *              LVM_DISK_CONFIG environment variable, or from
+ *              DEFAULT_DISK_CONFIG_FILE if that is not set either.  The config
+ *              file contains one path name per line.  Blank lines and lines
+ *              starting with '#' are ignored.  Drives are numbered in the
+ *              order in which they are listed.
+ *
+ *              Unlike DiskIO.c, which must convert each request into CHS
+ *              form and split it at track boundaries, this module issues
+ *              each request as a single pread/pwrite at the byte offset of
+ *              the starting LBA.  The geometry reported by GetDriveGeometry
+ *              is only used by the engine for partition placement.
+ *              ReadSectorsV and WriteSectorsV combine segments which are
+ *              adjacent on disk and issue each run with a single preadv or
+ *              pwritev.
+ *
+ *              Requests started by SubmitSectorIO are handed to io_uring when
+ *              the engine is built with USE_IO_URING and the kernel supports
+ *              it.  Otherwise they are handed to a small pool of worker
+ *              threads, each of which performs one request at a time using
+ *              the same pread/pwrite loop as ReadSectors and WriteSectors.
+ *              Polling interfaces such as epoll are of no use here, since
+ *              regular files and block devices are always reported as ready.
+ *
+ *              ReadSectors, WriteSectors, ReadSectorsV and WriteSectorsV go
+ *              through the sector cache in Sector_Cache.c, which calls
+ *              Do_IO_Vector for whatever it can not handle itself.
+ *              SubmitSectorIO bypasses the cache.
+ *
+ * Notes: pread and pwrite do not use the file position, so no lock is held
+ *        while I/O is in progress.  The io_uring instance and the worker
+ *        threads are not created until the first call to SubmitSectorIO.
+ *
+ */
+
+#define _GNU_SOURCE
+#define _FILE_OFFSET_BITS 64
+#include <stdio.h>           /* sprintf, fopen, fgets, fclose */
+#include <stdlib.h>          /* malloc, realloc, free, getenv */
+#include <string.h>          /* strlen, strcpy, strchr */
+#include <ctype.h>           /* isspace */
+#include <errno.h>           /* errno, EINTR */
+#include <fcntl.h>           /* open, O_RDWR */
+#include <unistd.h>          /* pread, pwrite, close, fsync */
+#include <dirent.h>          /* opendir, readdir, closedir */
+#include <fnmatch.h>         /* fnmatch */
+#include <sys/types.h>       /* off_t */
+#include <sys/stat.h>        /* fstat, S_ISBLK, S_ISREG */
+#include <sys/ioctl.h>       /* ioctl */
+#include <sys/uio.h>         /* preadv, pwritev, struct iovec */
+#include <linux/fs.h>        /* BLKGETSIZE64, BLKSSZGET, BLKRRPART */
+#include <linux/hdreg.h>     /* HDIO_GETGEO, struct hd_geometry */
+#include <sys/sysmacros.h>   /* major, minor */
+#include <pthread.h>         /* pthread_create, pthread_join, pthread_mutex_t, pthread_cond_t */
+
+#ifdef USE_IO_URING
+
+#include <liburing.h>        /* io_uring_queue_init, io_uring_get_sqe, io_uring_prep_read, io_uring_prep_write */
+
+#endif
+
+#include "gbltypes.h"        /* BOOLEAN, CARDINAL16, CARDINAL32 */
+#include "lvm_types.h"       /* LBA */
+#include "lvm_constants.h"   /* BYTES_PER_SECTOR */
+#include "lvm_intr.h"        /* Get_LVM_View */
+#include "dlist.h"           /* DLIST, CreateList, InsertItem, DestroyList */
+#include "diskio.h"          /* Prototypes for functions in this file. */
+#include "Sector_Cache.h"    /* Create_Sector_Cache, Destroy_Sector_Cache, Cache_IO_Vector, Cache_Prepare_Range */
+#include "logging.h"
+
+#ifdef DEBUG
+
+#include <assert.h>
+
+#endif
+
+
+
+
+/*--------------------------------------------------
+ * Private Constants
+ --------------------------------------------------*/
+#define DISK_LIST_VARIABLE         "LVM_DISKS"
+#define DISK_CONFIG_VARIABLE       "LVM_DISK_CONFIG"
+#define DEFAULT_DISK_CONFIG_FILE   "/etc/lvm/disks.conf"
+#define DISK_NAME_SEPARATOR        ':'
+#define MAX_DISK_NAME_LENGTH       256
+#define DEFAULT_HEADS              255
+#define DEFAULT_SECTORS_PER_TRACK  63
+#define MAXIMUM_CYLINDERS          65535
+#define MAXIMUM_TOTAL_SECTORS      0xFFFFFFFFULL  /* LVM keeps sector numbers in 32 bits, both on disk and in the engine. */
+#define MAX_IO_VECTORS             64         /* The most iovecs passed to a single preadv/pwritev call.  Well below IOV_MAX. */
+#define IO_WORKER_COUNT            8          /* The number of threads used for SubmitSectorIO requests when io_uring is not in use. */
+#define IO_RING_ENTRIES            64         /* The most requests that will be in flight in the io_uring instance at one time. */
+
+
+/*--------------------------------------------------
+ * Private Type definitions
+ --------------------------------------------------*/
+typedef struct _DiskDriveData {
+                                 CARDINAL16     Cylinders;               /* The number of cylinders on the drive. */
+                                 CARDINAL16     Heads;                   /* The number of heads on the drive. */
+                                 CARDINAL16     SectorsPerTrack;         /* The number of sectors per track on the drive. */
+                                 int            DriveHandle;             /* The file descriptor used to access this drive. */
+                                 LBA            TotalSectors;            /* The number of sectors on the device, which may exceed Cylinders * Heads * SectorsPerTrack. */
+                                 char *         DeviceName;              /* The path name of the block device or image file for this drive. */
+                                 BOOLEAN        Initialized;             /* If TRUE, then this structure has been initialized. */
+                                 BOOLEAN        Is_PRM;                  /* If TRUE, then the drive represented by this structure is a removable media device. */
+                                 BOOLEAN        Cylinder_Limit_Applies;  /* Set to TRUE if the 1024 cylinder limit applies to this drive. */
+                                 BOOLEAN        Is_Block_Device;         /* If TRUE, then DriveHandle refers to a block device rather than an image file. */
+                              } DiskDriveData;
+
+
+/*--------------------------------------------------
+ Private global variables.
+--------------------------------------------------*/
+static CARDINAL16       DriveCount = 0;       /* The number of hard drives in the system. */
+static DiskDriveData *  DriveTable = NULL;    /* Points to an array of DiskDriveData structures - 1 per physical drive in the system. */
+
+/* The following variables are used by SubmitSectorIO and ReapSectorIO.  The queues are protected by Queue_Lock since the worker
+   threads use them.  Outstanding_Requests is only used by the thread calling this module.                                       */
+static pthread_mutex_t     Queue_Lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t      Work_Available = PTHREAD_COND_INITIALIZER;   /* Signalled when a request is added to the pending queue. */
+static pthread_cond_t      Work_Completed = PTHREAD_COND_INITIALIZER;   /* Signalled when a request is added to the completed queue. */
+static Sector_IO_Request * Pending_Head = NULL;                          /* Requests waiting for a worker thread. */
+static Sector_IO_Request * Pending_Tail = NULL;
+static Sector_IO_Request * Completed_Head = NULL;                        /* Requests which have completed but have not been reaped. */
+static Sector_IO_Request * Completed_Tail = NULL;
+static CARDINAL32          Outstanding_Requests = 0;                     /* Requests which have been submitted but not reaped. */
+static pthread_t           Workers[IO_WORKER_COUNT];
+static CARDINAL32          Worker_Count = 0;                             /* The number of entries in Workers which are running. */
+static BOOLEAN             Stop_Workers = FALSE;                         /* Tells the worker threads to exit once the pending queue is empty. */
+static BOOLEAN             Async_IO_Started = FALSE;
+
+#ifdef USE_IO_URING
+
+static struct io_uring     Ring;
+static BOOLEAN             Ring_Active = FALSE;                          /* TRUE if Ring was successfully initialized. */
+static CARDINAL32          Ring_In_Flight = 0;                           /* The number of requests in Ring which have not been moved to the completed queue. */
+
+#endif
+
+
+/*--------------------------------------------------
+ Private functions.
+--------------------------------------------------*/
+static void Do_IO ( CARDINAL32   Drive_Number,
+                    LBA          Starting_Sector,
+                    CARDINAL32   SectorCount,
+                    ADDRESS      Buffer,
+                    BOOLEAN      Write,
+                    CARDINAL32 * Error);
+
+static char ** Get_Disk_Names( CARDINAL32 * Name_Count, CARDINAL32 * Error );
+static BOOLEAN Add_Disk_Name( char *** Disk_Names, CARDINAL32 * Name_Count, char * Name, CARDINAL32 * Error );
+static void    Free_Disk_Names( char ** Disk_Names, CARDINAL32 Name_Count );
+static BOOLEAN Initialize_Drive( DiskDriveData * Drive, CARDINAL32 * Error );
+static BOOLEAN Device_Is_Removable( int DriveHandle );
+static BOOLEAN Check_IO_Request( CARDINAL32 Drive_Number, LBA Starting_Sector, CARDINAL32 SectorCount, CARDINAL32 * Error );
+static size_t  Transfer_Data( int DriveHandle, off_t Offset, char * Buffer, size_t Bytes_Remaining, BOOLEAN Write );
+static void    Do_IO_Vector( CARDINAL32 Drive_Number, Sector_IO_Segment * Segments, CARDINAL32 Segment_Count, BOOLEAN Write, CARDINAL32 * Error );
+static size_t  Transfer_Vector( int DriveHandle, off_t Offset, struct iovec * Vector, CARDINAL32 Vector_Count, BOOLEAN Write );
+static void    Start_Async_IO( void );
+static void    Stop_Async_IO( void );
+static void *  IO_Worker( void * Unused );
+static void    Append_Request( Sector_IO_Request ** Head, Sector_IO_Request ** Tail, Sector_IO_Request * Request );
+static Sector_IO_Request * Remove_First_Request( Sector_IO_Request ** Head, Sector_IO_Request ** Tail );
+
+#ifdef USE_IO_URING
+
+static void    Complete_Ring_Request( struct io_uring_cqe * Completion );
+
+#endif
+
+
+/*--------------------------------------------------
+ There are no public global variables.
+--------------------------------------------------*/
+
+
+
+/*--------------------------------------------------
+ * Public Functions Available
+ --------------------------------------------------*/
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Rediscover                                       */
+/*                                                                   */
+/*   Descriptive Name:  This function causes the I/O subsystem to    */
+/*                      re-examine the specified physical drives and */
+/*                      discover any changes that may have been made */
+/*                      to them.                                     */
+/*                                                                   */
+/*   Input:  PDDI_Rediscover_param Rediscovery_Parameters : This is  */
+/*                      the number of drives to perform rediscovery  */
+/*                      on and an array of the drive numbers of      */
+/*                      those drives.                                */
+/*           PDDI_Rediscover_data Rediscovery_Data : Not used under  */
+/*                      Linux other than to clear NewIFSMUnits.      */
+/*                                                                   */
+/*   Output:  The function return value will be DISKIO_NO_ERROR if   */
+/*            the kernel accepted the request to re-read the         */
+/*            partition tables of all of the specified block         */
+/*            devices.  Otherwise it will be                         */
+/*            DISKIO_UNEXPECTED_OS_ERROR.                            */
+/*                                                                   */
+/*   Error Handling: If the kernel refuses to re-read a partition    */
+/*                   table, usually because a partition on that      */
+/*                   drive is in use, the remaining drives are still */
+/*                   processed and an error is returned.             */
+/*                                                                   */
+/*   Side Effects: The kernel may recreate the partition devices for */
+/*                 the specified drives.                             */
+/*                                                                   */
+/*   Notes:  A PRM only rediscover (DDI_TotalDrives == 0) has no     */
+/*           Linux equivalent and always succeeds.  Image files are  */
+/*           skipped.  If the sector cache can not be flushed, the   */
+/*           error from FlushSectorCache is returned and nothing is  */
+/*           rediscovered.                                           */
+/*                                                                   */
+/*********************************************************************/
+CARDINAL32 Rediscover( PDDI_Rediscover_param  Rediscovery_Parameters, PDDI_Rediscover_data Rediscovery_Data)
+{
+
+  CARDINAL32    Index;          /* Used to walk the list of drives to rediscover. */
+  CARDINAL32    DriveIndex;     /* Used to convert a drive number into an index into the DriveTable. */
+  CARDINAL32    Return_Code;    /* The value to return to the caller. */
+
+  Rediscovery_Data->NewIFSMUnits = 0;
+  Return_Code = DISKIO_NO_ERROR;
+
+  if ( DriveTable == NULL )
+    return DISKIO_DRIVES_NOT_OPEN;
+
+  /* The kernel will read the partition tables from disk, so anything still in the sector cache must be written first. */
+  FlushSectorCache( 0, &Return_Code );
+  if ( Return_Code != DISKIO_NO_ERROR )
+    return Return_Code;
+
+  for ( Index = 0; Index < Rediscovery_Parameters->DDI_TotalDrives; Index++ )
+  {
+
+    DriveIndex = Rediscovery_Parameters->DDI_aDriveNums[Index];
+
+    /* Skip drive numbers we don't know about. */
+    if ( ( DriveIndex == 0 ) || ( DriveIndex > DriveCount ) )
+      continue;
+
+    DriveIndex--;
+
+    /* Only block devices have a partition table in the kernel. */
+    if ( ! DriveTable[DriveIndex].Is_Block_Device )
+      continue;
+
+    if ( ioctl( DriveTable[DriveIndex].DriveHandle, BLKRRPART ) != 0 )
+    {
+
+      LOG_EVENT1("BLKRRPART failed.", "errno", errno)
+
+      Return_Code = DISKIO_UNEXPECTED_OS_ERROR;
+
+    }
+
+  }
+
+ return Return_Code;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Get_LVM_View                                     */
+/*                                                                   */
+/*   Descriptive Name:  This function gets the OS2LVM data for the   */
+/*                      specified drive letter.                      */
+/*                                                                   */
+/*   Input:  char  IFSM_Drive_Letter : The drive letter for which the*/
+/*                                     OS2LVM data is requested.     */
+/*           CARDINAL32 * Drive_Number : Set to 0.                   */
+/*           CARDINAL32 * Partition_LBA : Set to 0.                  */
+/*           char * LVM_Drive_Letter : Set to 0.                     */
+/*           BYTE * UnitID : Set to 0xFF.                            */
+/*                                                                   */
+/*   Output:  The function return value is always FALSE.             */
+/*                                                                   */
+/*   Error Handling: N/A                                             */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  There is no OS2LVM under Linux, so no drive letter is   */
+/*           ever controlled by it.                                  */
+/*                                                                   */
+/*********************************************************************/
+BOOLEAN Get_LVM_View( char IFSM_Drive_Letter, CARDINAL32 * Drive_Number, CARDINAL32 * Partition_LBA, char * LVM_Drive_Letter, BYTE * UnitID)
+{
+
+  *Drive_Number = 0;
+  *Partition_LBA = 0;
+  *LVM_Drive_Letter = 0;
+  *UnitID = 0xFF;
+
+  return FALSE;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: PRM_Rediscovery_Control                          */
+/*                                                                   */
+/*   Descriptive Name:  This function enables or disables the PRM    */
+/*                      rediscovery process in OS2LVM.               */
+/*                                                                   */
+/*   Input:  BOOLEAN Enable : Ignored.                               */
+/*                                                                   */
+/*   Output:  None.                                                  */
+/*                                                                   */
+/*   Error Handling: This function should never fail.                */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  There is no PRM rediscovery process under Linux.        */
+/*                                                                   */
+/*********************************************************************/
+void PRM_Rediscovery_Control( BOOLEAN  Enable )
+{
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: OpenDrives                                       */
+/*                                                                   */
+/*   Descriptive Name:  This function prepares the DiskIo module for */
+/*                      for use.  It determines the block devices    */
+/*                      and image files to be managed, gathers some  */
+/*                      basic information about them, and opens each */
+/*                      one.                                         */
+/*                                                                   */
+/*   Input:  CARDINAL32 *  Error : The address of a variable to hold */
+/*                                 the error return code.            */
+/*                                                                   */
+/*   Output:  *Error will be 0 if this function completed            */
+/*            successfully.  *Error will be > 0 if this function     */
+/*            failed.                                                */
+/*                                                                   */
+/*   Error Handling: If this function fails, it will attempt to      */
+/*                   restore the system to the state it was in prior */
+/*                   to this function being called.                  */
+/*                                                                   */
+/*   Side Effects: A file descriptor will be opened for each drive   */
+/*                 listed in LVM_DISKS or the disk config file.      */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+BOOLEAN OpenDrives( CARDINAL32 * Error )
+{
+
+  CARDINAL32             I;                      /* Used to traverse the DriveTable. */
+  char **                Disk_Names;             /* The names of the drives to open. */
+  CARDINAL32             Name_Count;             /* The number of entries in Disk_Names. */
+  BOOLEAN                Success;                /* Used to stop the initialization loop on the first failure. */
+
+
+  /* If the array of DiskDriveData structures already exists, then this function has already been called and
+     the DriveTable has already been established!  Return an error!                                           */
+  if ( DriveTable != NULL )
+  {
+     *Error = DISKIO_DRIVES_ALREADY_OPEN;
+     return FALSE;
+  }
+
+  /* Find out which drives we are to manage so that we can properly size the drive table. */
+  Disk_Names = Get_Disk_Names( &Name_Count, Error );
+  if ( Disk_Names == NULL )
+  {
+
+    DriveCount = 0;
+    return FALSE;
+
+  }
+
+  /* Allocate memory for the array to hold that many DiskDriveData structures. */
+  DriveTable = ( DiskDriveData * ) malloc( Name_Count * sizeof( DiskDriveData ) );
+
+  /* Did we get the memory? */
+  if ( DriveTable == NULL )
+  {
+
+    /* We are out of memory!  Abort! */
+    Free_Disk_Names( Disk_Names, Name_Count );
+    DriveCount = 0;
+    *Error = DISKIO_OUT_OF_MEMORY;
+    return FALSE;
+
+  }
+
+  DriveCount = (CARDINAL16) Name_Count;
+
+  /* Initialize the memory we just got.  Every entry gets its name now so that CloseDrives can free them all, and no entry owns
+     a file descriptor until Initialize_Drive opens one.                                                                          */
+  memset( DriveTable, 0, DriveCount * sizeof( DiskDriveData ) );
+  for ( I = 0; I < DriveCount; I++ )
+  {
+
+    DriveTable[I].Initialized = FALSE;
+    DriveTable[I].DriveHandle = -1;
+    DriveTable[I].DeviceName = Disk_Names[I];
+
+  }
+
+  /* The names now belong to the DriveTable, so only the array itself is freed. */
+  free( Disk_Names );
+
+  /* Initialize the array of DiskDriveData structures. */
+  for ( I = 0, Success = TRUE; (I < DriveCount) && Success; I++ )
+  {
+
+    Success = Initialize_Drive( &(DriveTable[I]), Error );
+
+  }
+
+  if ( ! Success )
+  {
+
+    /* There was an error of some sort.  *Error has already been set, so we don't need to do it here.  We just need to call CloseDrives to have
+       it clean up the DriveTable for us, and then return to caller indicating failure.                                                           */
+    CloseDrives();
+
+    return FALSE;
+
+  }
+
+  /* Set up the sector cache for the drives we just opened. */
+  if ( ! Create_Sector_Cache( DriveCount, &Check_IO_Request, &Do_IO_Vector, Error ) )
+  {
+
+    CloseDrives();
+
+    return FALSE;
+
+  }
+
+
+  /* All done!  Signal success! */
+  *Error = DISKIO_NO_ERROR;
+
+  return TRUE;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: CloseDrives                                      */
+/*                                                                   */
+/*   Descriptive Name: This function closes any and all drive handles*/
+/*                     that this module may have, as well as freeing */
+/*                     all memory allocated by this module.          */
+/*                                                                   */
+/*   Input: None.                                                    */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: If the sectors held in the sector cache can not */
+/*                   be written to disk, the failure is logged.      */
+/*                                                                   */
+/*   Side Effects: All drive handles opened by OpenDrives are closed.*/
+/*                 All memory allocated by OpenDrives is released.   */
+/*                 Data written to each drive is flushed to stable   */
+/*                 storage before its handle is closed.              */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+void CloseDrives( void )
+{
+  CARDINAL32             I;                      /* Used to traverse the DriveTable. */
+  CARDINAL32             Error;                  /* Used to hold the error return code from Destroy_Sector_Cache. */
+
+  /* If the DriveTable is NULL, or if there are no drives, then we have nothing to do! */
+  if ( ( DriveTable == NULL ) || ( DriveCount == 0 ) )
+  {
+
+    return;
+
+  }
+
+  /* Let any requests started by SubmitSectorIO finish before their drive handles go away. */
+  Stop_Async_IO();
+
+  /* Write out anything left in the sector cache while we still have the drive handles. */
+  Destroy_Sector_Cache( &Error );
+
+  /* CloseDrives has no way to return an error, so record the sectors which were lost in the log. */
+  if ( ( Error != DISKIO_NO_ERROR ) && Logging_Enabled )
+  {
+
+    sprintf(Log_Buffer,"CloseDrives: Dirty sectors in the sector cache could not be written to disk.  Error code: %lu", Error);
+    Write_Log_Buffer();
+
+  }
+
+  /* Loop through the drive table.  Unlike DiskIO.c, every entry owns a name even if it was never initialized, so every entry must
+     be examined.                                                                                                                   */
+  for ( I = 0; I < DriveCount; I++ )
+  {
+
+    if ( DriveTable[I].DriveHandle >= 0 )
+    {
+
+      /* Make sure that anything we wrote reaches the device, then close the drive handle. */
+      fsync( DriveTable[I].DriveHandle );
+      close( DriveTable[I].DriveHandle );
+
+    }
+
+    free( DriveTable[I].DeviceName );
+
+    /* Clear out the fields in this drive table entry. */
+    DriveTable[I].DeviceName = NULL;
+    DriveTable[I].Initialized = FALSE;
+    DriveTable[I].DriveHandle = -1;
+
+  }
+
+  /* Free the memory occupied by the drive table. */
+  free( DriveTable );
+
+  /* Set DriveTable to NULL and DiskCount to 0 so that we don't accidentally try to use them again. */
+  DriveTable = NULL;
+  DriveCount = 0;
+
+  /* Return to caller. */
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: GetDriveCount                                    */
+/*                                                                   */
+/*   Descriptive Name: This function returns the number of hard      */
+/*                     drives in the system.                         */
+/*                                                                   */
+/*   Input:  CARDINAL32 *  Error : The address of a variable to hold */
+/*                                 the error return code.            */
+/*                                                                   */
+/*   Output: The function return value will be the number of hard    */
+/*           drives in the system if no errors occur.  If an error   */
+/*           occurs, then the function return value will be 0 and    */
+/*           *Error will be > 0.                                     */
+/*                                                                   */
+/*   Error Handling: If no errors occur, *Error will be 0.  If an    */
+/*                   error occurs, then *Error will be > 0.          */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+CARDINAL32 GetDriveCount( CARDINAL32 * Error )
+{
+
+  /* If DriveTable is NULL, then we have not been initialized yet by a call to OpenDrives, or CloseDrives has been called.
+     Return an error.                                                                                                       */
+  if ( DriveTable == NULL )
+  {
+
+    *Error = DISKIO_DRIVES_NOT_OPEN;
+    return 0;
+
+  }
+
+  /* Indicate success and return DriveCount. */
+  *Error = DISKIO_NO_ERROR;
+
+  return DriveCount;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: GetDriveGeometry                                 */
+/*                                                                   */
+/*   Descriptive Name: This function returns the geometry values for */
+/*                     the specified drive.                          */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the hard drive to*/
+/*                                    get the geometry for.  The     */
+/*                                    drives in the system are       */
+/*                                    numbered from 1 to n, where n  */
+/*                                    is the total number of hard    */
+/*                                    drives in the system.          */
+/*           Drive_Geometry_Record * Geometry : The location of a    */
+/*                                              buffer to hold the   */
+/*                                              drive geometry record*/
+/*                                              for the specified    */
+/*                                              drive.               */
+/*           BOOLEAN * Is_PRM : The address of a variable which will */
+/*                              be set to TRUE if the specified drive*/
+/*                              is a PRM.                            */
+/*           BOOLEAN * Cylinder_Limit_Applies : The address of a     */
+/*                                              variable which will  */
+/*                                              be set to TRUE if the*/
+/*                                              1024 cylinder limit  */
+/*                                              applies to this drive*/
+/*           CARDINAL32 *  Error : The address of a variable to hold */
+/*                                 the error return code.            */
+/*                                                                   */
+/*   Output: If there are no errors, *Error will be 0 and *Geometry  */
+/*           will contain a valid Drive_Geometry_Record for the      */
+/*           specified drive.  If an error occurs, *Error will be >0 */
+/*           and *Geometry will contain all 0s.                      */
+/*                                                                   */
+/*   Error Handling: *Error will be 0 unless an error occurs.        */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+void GetDriveGeometry( CARDINAL32              Drive_Number,
+                       Drive_Geometry_Record * Geometry,
+                       BOOLEAN *               Is_PRM,
+                       BOOLEAN *               Cylinder_Limit_Applies,
+                       CARDINAL32 *            Error )
+{
+
+  /* If DriveTable is NULL, then we have not been initialized yet by a call to OpenDrives, or CloseDrives has been called.
+     Return an error.                                                                                                       */
+  if ( DriveTable == NULL )
+  {
+
+    *Error = DISKIO_DRIVES_NOT_OPEN;
+    return;
+
+  }
+
+  /* Is the Drive_Number requested valid? */
+  if ( ( Drive_Number == 0 ) || ( Drive_Number > DriveCount ) )
+  {
+
+    /* Drive_Number is invalid!  Return an error. */
+    *Error = DISKIO_REQUEST_OUT_OF_RANGE;
+
+    /* Zero out the Geometry. */
+    Geometry->Cylinders = 0;
+    Geometry->Heads = 0;
+    Geometry->Sectors = 0;
+
+    /* Set *Is_PRM to FALSE. */
+    *Is_PRM = FALSE;
+
+    /* Set Cylinder_Limit_Applies to TRUE. */
+    *Cylinder_Limit_Applies = TRUE;
+
+    /* Return to caller. */
+    return;
+
+  }
+
+  /* copy the geometry data for the drive from its entry in the DriveTable to *Geometry. */
+  Geometry->Cylinders = DriveTable[Drive_Number - 1].Cylinders;
+  Geometry->Heads = DriveTable[Drive_Number -1 ].Heads;
+  Geometry->Sectors = DriveTable[Drive_Number - 1].SectorsPerTrack;
+  *Is_PRM = DriveTable[Drive_Number - 1 ].Is_PRM;
+  *Cylinder_Limit_Applies = DriveTable[Drive_Number - 1].Cylinder_Limit_Applies;
+
+  /* Indicate success and return to caller. */
+  *Error = DISKIO_NO_ERROR;
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: GetBootDrive                                     */
+/*                                                                   */
+/*   Descriptive Name: This function returns the drive letter of the */
+/*                     drive that the system booted off of.          */
+/*                                                                   */
+/*   Input: None.                                                    */
+/*                                                                   */
+/*   Output: Always 0, as Linux does not boot from a drive letter.   */
+/*                                                                   */
+/*   Error Handling: N/A                                             */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+char GetBootDrive(void)
+{
+
+  return 0x0;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: GetDirectoryList                                 */
+/*                                                                   */
+/*   Descriptive Name: This function returns a DLIST containing      */
+/*                     one entry for each file/directory which       */
+/*                     matched the FileSpecification passed in.      */
+/*                     Each entry in the DLIST is the NULL terminated*/
+/*                     name of a file which matched the              */
+/*                     FileSpecification provided by the caller.     */
+/*                                                                   */
+/*   Input: char * DirectorySpecification - The fully qualified name */
+/*                                          of the directory to      */
+/*                                          search.                  */
+/*          char * FileMask - A search mask, which may include the   */
+/*                            standard * and ? wildcards, to control */
+/*                            which items in the specified directory */
+/*                            are selected and returned.             */
+/*          CARDINAL32 * Error_Code : The address of a variable to   */
+/*                                    hold the error return code.    */
+/*                                                                   */
+/*   Output: If successful, then the function return value will be   */
+/*           non-NULL and *Error_Code will be set to DISKIO_NO_ERROR.*/
+/*           Each entry in the DLIST returned by this function will  */
+/*           be the NULL terminated name of a file which matched the */
+/*           FileSpecification.  The size of each entry will be the  */
+/*           length of the filename in that entry plus 1.  The TAG   */
+/*           value for each entry will be FILENAME_TAG, defined      */
+/*           previously.                                             */
+/*                                                                   */
+/*           If unsuccessful, then NULL is returned and *Error_Code  */
+/*           will be set to a non-zero error code.                   */
+/*                                                                   */
+/*   Error Handling: If an error occurs, then all memory allocated by*/
+/*                   this function is freed, NULL is returned, and   */
+/*                   *Error_Code will be non-zero.                   */
+/*                                                                   */
+/*   Side Effects: Memory is allocated for the DLIST being returned. */
+/*                                                                   */
+/*   Notes:  This function uses opendir, readdir, and fnmatch.       */
+/*                                                                   */
+/*********************************************************************/
+DLIST GetDirectoryList(char * DirectorySpecification, char * FileMask, CARDINAL32 * Error_Code)
+{
+
+  DIR *          Directory;   /* The directory being searched. */
+  struct dirent * Entry;      /* The directory entry currently being examined. */
+  struct stat    File_Status; /* Used to skip anything which is not a regular file. */
+  DLIST          FileList;    /* The list of filenames that we are going to build. */
+  CARDINAL32     Error;       /* Used to hold error codes from functions called on an error path. */
+  char           FileSpecification[256];  /* Used to hold the fully qualified name of each file found. */
+  CARDINAL32     Length;      /* Used when computing string lengths. */
+
+  /* Create the FileList. */
+  FileList = CreateList();
+
+  /* Did we succeed? */
+  if (FileList == NULL)
+  {
+
+    /* Since we could not create the FileList, we must be out of memory. */
+    *Error_Code = DISKIO_OUT_OF_MEMORY;
+    return (DLIST) NULL;
+
+  }
+
+  if ( Logging_Enabled )
+  {
+
+    sprintf(Log_Buffer,"GetDirectoryList is about to search the path %s", DirectorySpecification);
+    Write_Log_Buffer();
+
+  }
+
+  Length = strlen(DirectorySpecification);
+  Directory = opendir( ( Length > 0 ) ? DirectorySpecification : "." );
+  if ( Directory == NULL )
+  {
+
+    /* An empty directory, or one that does not exist, produces an empty list, just as DosFindFirst would. */
+    *Error_Code = DISKIO_NO_ERROR;
+    return FileList;
+
+  }
+
+  while ( ( Entry = readdir( Directory ) ) != NULL )
+  {
+
+    if ( fnmatch( FileMask, Entry->d_name, FNM_CASEFOLD ) != 0 )
+      continue;
+
+    /* Build the fully qualified name of the file we found. */
+    FileSpecification[0] = 0x0;
+    if ( Length > 0 )
+    {
+
+      strcat(FileSpecification, DirectorySpecification);
+
+      /* Does the FileSpecification end in a '/' character? */
+      if ( FileSpecification[Length - 1] != '/' )
+        strcat(FileSpecification,"/");
+
+    }
+
+    if ( strlen(FileSpecification) + strlen(Entry->d_name) >= sizeof(FileSpecification) )
+      continue;
+
+    strcat(FileSpecification, Entry->d_name);
+
+    /* DosFindFirst with FILE_NORMAL only returned files, so skip directories and devices. */
+    if ( ( stat( FileSpecification, &File_Status ) != 0 ) || ( ! S_ISREG(File_Status.st_mode) ) )
+      continue;
+
+    if ( Logging_Enabled )
+    {
+
+      sprintf(Log_Buffer,"Adding %s to the FileList.",Entry->d_name);
+      Write_Log_Buffer();
+
+    }
+
+    /* Add the filename to the FileList being returned to the caller. */
+    InsertItem( FileList, strlen(FileSpecification) + 1, FileSpecification, FILENAME_TAG, NULL, AppendToList, FALSE, Error_Code);
+
+    /* Did we succeed? */
+    if ( *Error_Code != DLIST_SUCCESS )
+    {
+
+      /* We could not add the item to the list.  Are we out of memory? */
+      if ( *Error_Code == DLIST_OUT_OF_MEMORY )
+        *Error_Code = DISKIO_OUT_OF_MEMORY;
+      else
+        *Error_Code = DISKIO_INTERNAL_ERROR;
+
+      /* Free memory. */
+      DestroyList(&FileList,TRUE,&Error);
+      closedir( Directory );
+
+      /* Return NULL. */
+      return (DLIST) NULL;
+
+    }
+
+  }
+
+  closedir( Directory );
+
+  /* Indicate success. */
+  *Error_Code = DISKIO_NO_ERROR;
+
+  return FileList;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: ReadSectors                                      */
+/*                                                                   */
+/*   Descriptive Name: This function reads one or more sectors from  */
+/*                     the specified drive and places the data read  */
+/*                     in Buffer.                                    */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the hard drive to*/
+/*                                    read from.  The drives in the  */
+/*                                    system are numbered from 1 to  */
+/*                                    n, where n is the total number */
+/*                                    of hard drives in the system.  */
+/*          LBA Starting_Sector : The first sector to read from.     */
+/*          CARDINAL32 Sectors_To_Read : The number of sectors to    */
+/*                                       read into memory.           */
+/*          ADDRESS Buffer : The location to put the data read into. */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If Successful, then the data read will be placed in     */
+/*              memory starting at Buffer, and *Error will be 0.     */
+/*           If Unsuccessful, then *Error will be > 0 and the        */
+/*              contents of memory starting at Buffer is undefined.  */
+/*                                                                   */
+/*   Error Handling: *Error will be > 0 if an error occurs.          */
+/*                                                                   */
+/*   Side Effects: Data may be read into memory starting at Buffer.  */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+void ReadSectors ( CARDINAL32   Drive_Number,
+                   LBA          Starting_Sector,
+                   CARDINAL32   Sectors_To_Read,
+                   ADDRESS      Buffer,
+                   CARDINAL32 * Error)
+{
+
+  Sector_IO_Segment   Segment;    /* Describes the request to the sector cache. */
+
+  Segment.Starting_Sector = Starting_Sector;
+  Segment.Sector_Count = Sectors_To_Read;
+  Segment.Buffer = Buffer;
+
+  /* The sector cache will call Do_IO_Vector for anything it can't supply itself.  Indicate that we want to Read, not write. */
+  Cache_IO_Vector( Drive_Number, &Segment, 1, FALSE, Error);
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: WriteSectors                                     */
+/*                                                                   */
+/*   Descriptive Name: This function writes data from memory to one  */
+/*                     or more sectors on the specified drive.       */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the hard drive to*/
+/*                                    write to.  The drives in the   */
+/*                                    system are numbered from 1 to  */
+/*                                    n, where n is the total number */
+/*                                    of hard drives in the system.  */
+/*          LBA Starting_Sector : The first sector to write to.      */
+/*          CARDINAL32 Sectors_To_Read : The number of sectors to    */
+/*                                       be written.                 */
+/*          ADDRESS Buffer : The location of the data to be written  */
+/*                           to disk.                                */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If Successful, then the data at Buffer will be placed   */
+/*              on the disk starting at the sector specified, and    */
+/*              *Error will be 0.                                    */
+/*           If Unsuccessful, then *Error will be > 0 and the        */
+/*              contents of the disk starting at sector              */
+/*              Starting_Sector is undefined.                        */
+/*                                                                   */
+/*   Error Handling: *Error will be > 0 if an error occurs.          */
+/*                                                                   */
+/*   Side Effects: Data may be written to disk.                      */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+void WriteSectors ( CARDINAL32   Drive_Number,
+                    LBA          Starting_Sector,
+                    CARDINAL32   Sectors_To_Write,
+                    ADDRESS      Buffer,
+                    CARDINAL32 * Error)
+{
+
+  Sector_IO_Segment   Segment;    /* Describes the request to the sector cache. */
+
+  Segment.Starting_Sector = Starting_Sector;
+  Segment.Sector_Count = Sectors_To_Write;
+  Segment.Buffer = Buffer;
+
+  /* The sector cache holds the data until it is flushed, or hands it to Do_IO_Vector if it is too large to cache.  Indicate that
+     we want to Write, not read.                                                                                                  */
+  Cache_IO_Vector( Drive_Number, &Segment, 1, TRUE, Error);
+
+  return;
+
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: ReadSectorsV                                     */
+/*                                                                   */
+/*   Descriptive Name: This function reads several groups of sectors */
+/*                     from the specified drive, placing each group  */
+/*                     in its own buffer.                            */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the hard drive to*/
+/*                                    read from.                     */
+/*          Sector_IO_Segment * Segments : The segments to read.     */
+/*          CARDINAL32 Segment_Count : The number of entries in      */
+/*                                     Segments.                     */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If Successful, *Error will be 0.                        */
+/*           If Unsuccessful, then *Error will be > 0.               */
+/*                                                                   */
+/*   Error Handling: *Error will be > 0 if an error occurs.          */
+/*                                                                   */
+/*   Side Effects: Data may be read into the segment buffers.        */
+/*                                                                   */
+/*   Notes:  See Do_IO_Vector.                                       */
+/*                                                                   */
+/*********************************************************************/
+void ReadSectorsV ( CARDINAL32          Drive_Number,
+                    Sector_IO_Segment * Segments,
+                    CARDINAL32          Segment_Count,
+                    CARDINAL32 *        Error)
+{
+
+  /* The sector cache will call Do_IO_Vector for any segments it can't supply itself.  Indicate that we want to Read, not write. */
+  Cache_IO_Vector( Drive_Number, Segments, Segment_Count, FALSE, Error);
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: WriteSectorsV                                    */
+/*                                                                   */
+/*   Descriptive Name: This function writes several groups of sectors*/
+/*                     to the specified drive, taking the data for   */
+/*                     each group from its own buffer.               */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the hard drive to*/
+/*                                    write to.                      */
+/*          Sector_IO_Segment * Segments : The segments to write.    */
+/*          CARDINAL32 Segment_Count : The number of entries in      */
+/*                                     Segments.                     */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If Successful, *Error will be 0.                        */
+/*           If Unsuccessful, then *Error will be > 0.               */
+/*                                                                   */
+/*   Error Handling: *Error will be > 0 if an error occurs.          */
+/*                                                                   */
+/*   Side Effects: Data may be written to disk.                      */
+/*                                                                   */
+/*   Notes:  See Do_IO_Vector.                                       */
+/*                                                                   */
+/*********************************************************************/
+void WriteSectorsV ( CARDINAL32          Drive_Number,
+                     Sector_IO_Segment * Segments,
+                     CARDINAL32          Segment_Count,
+                     CARDINAL32 *        Error)
+{
+
+  /* The sector cache holds the segments until it is flushed, or hands them to Do_IO_Vector if they are too large to cache.  Indicate
+     that we want to Write, not read.                                                                                                  */
+  Cache_IO_Vector( Drive_Number, Segments, Segment_Count, TRUE, Error);
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: SubmitSectorIO                                   */
+/*                                                                   */
+/*   Descriptive Name: This function starts a read or write of one or*/
+/*                     more sectors and returns without waiting for  */
+/*                     the transfer to complete.                     */
+/*                                                                   */
+/*   Input: Sector_IO_Request * Request : The request to start.  All */
+/*                                        fields except User_Data,   */
+/*                                        Error and Next must be set.*/
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If the request was accepted, *Error will be 0 and the   */
+/*           request will be returned by a later call to             */
+/*           ReapSectorIO.  If the request was not accepted, *Error  */
+/*           will be > 0 and the request will never be returned by   */
+/*           ReapSectorIO.                                           */
+/*                                                                   */
+/*   Error Handling: Requests which are out of range are rejected    */
+/*                   here.  Errors which occur during the transfer   */
+/*                   are reported in the Error field of the request  */
+/*                   when it is reaped.                              */
+/*                                                                   */
+/*   Side Effects: The io_uring instance or the worker threads are   */
+/*                 created on the first call.  Data may be read into */
+/*                 memory or written to disk.  Cached sectors in the */
+/*                 range of the request may be written to disk or    */
+/*                 discarded.                                        */
+/*                                                                   */
+/*   Notes:  If neither io_uring nor the worker threads are          */
+/*           available, the request is performed before this        */
+/*           function returns.                                       */
+/*                                                                   */
+/*********************************************************************/
+void SubmitSectorIO( Sector_IO_Request * Request, CARDINAL32 * Error )
+{
+
+#ifdef USE_IO_URING
+
+  struct io_uring_sqe *  Submission;     /* The submission queue entry used for Request. */
+  struct io_uring_cqe *  Completion;     /* Used to make room in the ring when it is full. */
+  int                    DriveHandle;    /* The file descriptor for the drive being accessed. */
+
+#endif
+
+  /* Reject anything we could never perform. */
+  if ( ! Check_IO_Request( Request->Drive_Number, Request->Starting_Sector, Request->Sector_Count, Error ) )
+    return;
+
+  /* The request bypasses the sector cache, so make sure that the disk is up to date, and that the cache won't hold stale copies of
+     anything the request writes.                                                                                                   */
+  Cache_Prepare_Range( Request->Drive_Number, Request->Starting_Sector, Request->Sector_Count, Request->Write, Error );
+  if ( *Error != DISKIO_NO_ERROR )
+    return;
+
+  if ( ! Async_IO_Started )
+    Start_Async_IO();
+
+  Request->Error = DISKIO_NO_ERROR;
+  Request->Next = NULL;
+  Outstanding_Requests++;
+
+  *Error = DISKIO_NO_ERROR;
+
+#ifdef USE_IO_URING
+
+  if ( Ring_Active && ( Request->Sector_Count > 0 ) )
+  {
+
+    /* Never have more requests in the ring than the completion queue can hold.  If the ring is full, move the oldest completion
+       to the completed queue to make room.                                                                                      */
+    if ( Ring_In_Flight >= IO_RING_ENTRIES )
+    {
+
+      if ( io_uring_submit_and_wait( &Ring, 1 ) >= 0 )
+      {
+
+        while ( io_uring_peek_cqe( &Ring, &Completion ) == 0 )
+          Complete_Ring_Request( Completion );
+
+      }
+
+    }
+
+    Submission = io_uring_get_sqe( &Ring );
+    if ( Submission != NULL )
+    {
+
+      DriveHandle = DriveTable[Request->Drive_Number - 1].DriveHandle;
+
+      if ( Request->Write )
+        io_uring_prep_write( Submission, DriveHandle, Request->Buffer, Request->Sector_Count * BYTES_PER_SECTOR, (off_t) Request->Starting_Sector * BYTES_PER_SECTOR );
+      else
+        io_uring_prep_read( Submission, DriveHandle, Request->Buffer, Request->Sector_Count * BYTES_PER_SECTOR, (off_t) Request->Starting_Sector * BYTES_PER_SECTOR );
+
+      io_uring_sqe_set_data( Submission, Request );
+
+      /* Once io_uring_get_sqe has handed out an entry, the entry belongs to the ring.  If io_uring_submit fails, the entry is
+         still submitted by the next call to io_uring_submit_and_wait, so the request is counted as in flight either way.     */
+      io_uring_submit( &Ring );
+      Ring_In_Flight++;
+
+      return;
+
+    }
+
+  }
+
+#endif
+
+  pthread_mutex_lock( &Queue_Lock );
+
+  if ( ( Worker_Count > 0 ) && ( Request->Sector_Count > 0 ) )
+  {
+
+    /* Hand the request to a worker thread. */
+    Append_Request( &Pending_Head, &Pending_Tail, Request );
+    pthread_cond_signal( &Work_Available );
+
+  }
+  else
+  {
+
+    /* There is nothing to do it with, or nothing to do, so do it now. */
+    pthread_mutex_unlock( &Queue_Lock );
+    Do_IO( Request->Drive_Number, Request->Starting_Sector, Request->Sector_Count, Request->Buffer, Request->Write, &(Request->Error) );
+    pthread_mutex_lock( &Queue_Lock );
+
+    Append_Request( &Completed_Head, &Completed_Tail, Request );
+
+  }
+
+  pthread_mutex_unlock( &Queue_Lock );
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: ReapSectorIO                                     */
+/*                                                                   */
+/*   Descriptive Name: This function returns a request started by    */
+/*                     SubmitSectorIO once it has completed.         */
+/*                                                                   */
+/*   Input: BOOLEAN Wait : If TRUE, and there are outstanding        */
+/*                         requests but none have completed, then    */
+/*                         this function will wait for one to        */
+/*                         complete.  If FALSE, this function will   */
+/*                         not wait.                                 */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If a request has completed, the function return value   */
+/*           is the address of that request, its Error field holds   */
+/*           the result of the transfer, and *Error will be 0.  If no*/
+/*           request has completed and Wait is FALSE, the function   */
+/*           return value is NULL and *Error will be 0.  If there are*/
+/*           no outstanding requests, the function return value is   */
+/*           NULL and *Error will be DISKIO_NO_IO_OUTSTANDING.       */
+/*                                                                   */
+/*   Error Handling: *Error will be > 0 if an error occurs.          */
+/*                                                                   */
+/*   Side Effects: Completions are moved from the io_uring instance  */
+/*                 to the completed queue.                           */
+/*                                                                   */
+/*   Notes:  Requests are returned in the order in which they        */
+/*           completed, which need not be the order in which they    */
+/*           were submitted.                                         */
+/*                                                                   */
+/*********************************************************************/
+Sector_IO_Request * ReapSectorIO( BOOLEAN Wait, CARDINAL32 * Error )
+{
+
+  Sector_IO_Request *    Request;        /* The request being returned. */
+
+#ifdef USE_IO_URING
+
+  struct io_uring_cqe *  Completion;     /* A completion taken from the ring. */
+
+#endif
+
+  if ( DriveTable == NULL )
+  {
+
+    *Error = DISKIO_DRIVES_NOT_OPEN;
+    return NULL;
+
+  }
+
+  if ( Outstanding_Requests == 0 )
+  {
+
+    *Error = DISKIO_NO_IO_OUTSTANDING;
+    return NULL;
+
+  }
+
+#ifdef USE_IO_URING
+
+  /* Collect whatever the kernel has already finished. */
+  if ( Ring_Active )
+  {
+
+    while ( io_uring_peek_cqe( &Ring, &Completion ) == 0 )
+      Complete_Ring_Request( Completion );
+
+  }
+
+#endif
+
+  pthread_mutex_lock( &Queue_Lock );
+
+  for (;;)
+  {
+
+    Request = Remove_First_Request( &Completed_Head, &Completed_Tail );
+    if ( ( Request != NULL ) || ( ! Wait ) )
+      break;
+
+#ifdef USE_IO_URING
+
+    /* When the ring is in use, the worker threads are not, so the next completion must come from the ring. */
+    if ( Ring_In_Flight > 0 )
+    {
+
+      pthread_mutex_unlock( &Queue_Lock );
+
+      if ( io_uring_submit_and_wait( &Ring, 1 ) >= 0 )
+      {
+
+        while ( io_uring_peek_cqe( &Ring, &Completion ) == 0 )
+          Complete_Ring_Request( Completion );
+
+      }
+
+      pthread_mutex_lock( &Queue_Lock );
+
+      continue;
+
+    }
+
+#endif
+
+    pthread_cond_wait( &Work_Completed, &Queue_Lock );
+
+  }
+
+  pthread_mutex_unlock( &Queue_Lock );
+
+  if ( Request != NULL )
+    Outstanding_Requests--;
+
+  *Error = DISKIO_NO_ERROR;
+
+  return Request;
+
+}
+
+
+
+/*--------------------------------------------------
+ * Private Functions Available
+ --------------------------------------------------*/
+
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Do_IO                                            */
+/*                                                                   */
+/*   Descriptive Name: This function reads or writes one or more     */
+/*                     sectors from the specified drive.  For reads, */
+/*                     the data read is placed in Buffer.  For       */
+/*                     writes, the data is taken from Buffer and     */
+/*                     written to disk.                              */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the hard drive to*/
+/*                                    use.  The drives in the        */
+/*                                    system are numbered from 1 to  */
+/*                                    n, where n is the total number */
+/*                                    of hard drives in the system.  */
+/*          LBA Starting_Sector : The first sector to read from/write*/
+/*                                to.                                */
+/*          CARDINAL32 Sectors_To_Read : The number of sectors to    */
+/*                                       read/write.                 */
+/*          ADDRESS Buffer : The location to get/put the data.       */
+/*          BOOLEAN Write : If TRUE, Do_IO will perform a write.  If */
+/*                          FALSE, then Do_IO will perform a read.   */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If Successful, *Error will be 0.                        */
+/*           If Unsuccessful, then *Error will be > 0.               */
+/*                                                                   */
+/*   Error Handling: *Error will be > 0 if an error occurs.          */
+/*                                                                   */
+/*   Side Effects: Data may be read into memory starting at Buffer,  */
+/*                 or data may be written from Buffer to disk.       */
+/*                                                                   */
+/*   Notes:  The transfer itself is done by Transfer_Data.           */
+/*                                                                   */
+/*********************************************************************/
+static void Do_IO ( CARDINAL32   Drive_Number,
+                    LBA          Starting_Sector,
+                    CARDINAL32   SectorCount,
+                    ADDRESS      Buffer,
+                    BOOLEAN      Write,
+                    CARDINAL32 * Error)
+{
+
+  size_t         Bytes_Remaining;                /* The number of bytes left to transfer. */
+
+  /* Make sure the request refers to sectors which exist. */
+  if ( ! Check_IO_Request( Drive_Number, Starting_Sector, SectorCount, Error ) )
+    return;
+
+  /* If SectorCount is 0, we have nothing to do! */
+  if ( SectorCount == 0 )
+  {
+
+    /* That was an easy request!  */
+    *Error = DISKIO_NO_ERROR;
+    return;
+
+  }
+
+  /* Now lets do some I/O! */
+  Bytes_Remaining = Transfer_Data( DriveTable[Drive_Number - 1].DriveHandle,
+                                   (off_t) Starting_Sector * BYTES_PER_SECTOR,
+                                   (char *) Buffer,
+                                   (size_t) SectorCount * BYTES_PER_SECTOR,
+                                   Write );
+
+  /* Was there an error? */
+  if ( Bytes_Remaining > 0 )
+  {
+
+    if ( Write )
+      *Error = DISKIO_WRITE_FAILED;
+    else
+      *Error = DISKIO_READ_FAILED;
+
+  }
+  else
+  {
+
+     *Error = DISKIO_NO_ERROR;
+
+  }
+
+  /* Return to caller. */
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Check_IO_Request                                 */
+/*                                                                   */
+/*   Descriptive Name: Makes sure that an I/O request refers to a    */
+/*                     drive which is open and to sectors which exist*/
+/*                     on that drive.                                */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the hard drive to*/
+/*                                    use.                           */
+/*          LBA Starting_Sector : The first sector to read from/write*/
+/*                                to.                                */
+/*          CARDINAL32 SectorCount : The number of sectors to        */
+/*                                   read/write.                     */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: TRUE if the request may be performed.  Otherwise FALSE, */
+/*           with *Error set to the reason.                          */
+/*                                                                   */
+/*   Error Handling: See Output.                                     */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  A request for 0 sectors is always accepted as long as   */
+/*           the drive is valid.                                     */
+/*                                                                   */
+/*********************************************************************/
+static BOOLEAN Check_IO_Request( CARDINAL32 Drive_Number, LBA Starting_Sector, CARDINAL32 SectorCount, CARDINAL32 * Error )
+{
+
+  CARDINAL32     DriveIndex;                     /* Used to convert the Drive_Number in an index into the DriveTable. */
+
+  /* If DriveTable is NULL, then we have not been initialized yet by a call to OpenDrives, or CloseDrives has been called.
+     Return an error.                                                                                                       */
+  if ( DriveTable == NULL )
+  {
+
+    *Error = DISKIO_DRIVES_NOT_OPEN;
+    return FALSE;
+
+  }
+
+  /* Is the Drive_Number requested valid? */
+  if ( ( Drive_Number > DriveCount ) || ( Drive_Number == 0 ) )
+  {
+
+    /* Drive_Number is invalid!  Return an error. */
+    *Error = DISKIO_REQUEST_OUT_OF_RANGE;
+    return FALSE;
+
+  }
+
+#ifdef DEBUG
+
+#ifdef PARANOID
+
+  assert(DriveTable[Drive_Number - 1].Initialized);
+
+#endif
+
+#endif
+
+  if ( SectorCount == 0 )
+  {
+
+    *Error = DISKIO_NO_ERROR;
+    return TRUE;
+
+  }
+
+  /* Convert Drive_Number into an index into the DriveTable. */
+  DriveIndex = Drive_Number - 1;
+
+  /* Are we trying to read or write past the end of the disk? */
+  if ( ( Starting_Sector >= DriveTable[DriveIndex].TotalSectors ) ||
+       ( SectorCount > DriveTable[DriveIndex].TotalSectors - Starting_Sector ) )
+  {
+
+    *Error = DISKIO_REQUEST_OUT_OF_RANGE;
+    return FALSE;
+
+  }
+
+  *Error = DISKIO_NO_ERROR;
+
+  return TRUE;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Transfer_Data                                    */
+/*                                                                   */
+/*   Descriptive Name: Reads or writes a range of bytes, retrying    */
+/*                     until the whole range has been transferred or */
+/*                     an error occurs.                              */
+/*                                                                   */
+/*   Input: int DriveHandle : The file descriptor to use.            */
+/*          off_t Offset : The byte offset of the first byte.        */
+/*          char * Buffer : The location to get/put the data.        */
+/*          size_t Bytes_Remaining : The number of bytes to transfer.*/
+/*          BOOLEAN Write : If TRUE, perform a write.  If FALSE,     */
+/*                          perform a read.                          */
+/*                                                                   */
+/*   Output: The number of bytes which were NOT transferred.  This   */
+/*           is 0 if the transfer was successful.                    */
+/*                                                                   */
+/*   Error Handling: Stops at the first error other than EINTR.      */
+/*                                                                   */
+/*   Side Effects: Data may be read into memory starting at Buffer,  */
+/*                 or data may be written from Buffer to disk.       */
+/*                                                                   */
+/*   Notes:  The whole request is normally handled by one system     */
+/*           call.  Additional calls are only made if the kernel     */
+/*           returns a partial transfer or is interrupted.           */
+/*                                                                   */
+/*********************************************************************/
+static size_t Transfer_Data( int DriveHandle, off_t Offset, char * Buffer, size_t Bytes_Remaining, BOOLEAN Write )
+{
+
+  ssize_t        Bytes_Transferred;              /* The value returned by pread/pwrite. */
+
+  while ( Bytes_Remaining > 0 )
+  {
+
+    if ( Write )
+      Bytes_Transferred = pwrite( DriveHandle, Buffer, Bytes_Remaining, Offset );
+    else
+      Bytes_Transferred = pread( DriveHandle, Buffer, Bytes_Remaining, Offset );
+
+    if ( Bytes_Transferred < 0 )
+    {
+
+      /* A signal is not an I/O error.  Try again. */
+      if ( errno == EINTR )
+        continue;
+
+      break;
+
+    }
+
+    /* Hitting end of file on a request we have already range checked means the device shrank underneath us. */
+    if ( Bytes_Transferred == 0 )
+      break;
+
+    Bytes_Remaining -= (size_t) Bytes_Transferred;
+    Offset += Bytes_Transferred;
+    Buffer += Bytes_Transferred;
+
+  }
+
+  return Bytes_Remaining;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Do_IO_Vector                                     */
+/*                                                                   */
+/*   Descriptive Name: This function reads or writes each of the     */
+/*                     segments given, combining segments which are  */
+/*                     adjacent on disk into a single transfer.      */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the hard drive to*/
+/*                                    use.                           */
+/*          Sector_IO_Segment * Segments : The segments to transfer. */
+/*          CARDINAL32 Segment_Count : The number of entries in      */
+/*                                     Segments.                     */
+/*          BOOLEAN Write : If TRUE, perform writes.  If FALSE,      */
+/*                          perform reads.                           */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If Successful, *Error will be 0.                        */
+/*           If Unsuccessful, then *Error will be > 0.               */
+/*                                                                   */
+/*   Error Handling: Every segment is range checked before any I/O is*/
+/*                   done.  Stops at the first run which fails.      */
+/*                                                                   */
+/*   Side Effects: Data may be read into memory or written to disk.  */
+/*                                                                   */
+/*   Notes:  A run is a sequence of segments, each of which starts   */
+/*           at the sector following the end of the one before it.   */
+/*           Segments whose buffers are also adjacent in memory share*/
+/*           one iovec.  Empty segments are skipped.                 */
+/*                                                                   */
+/*********************************************************************/
+static void Do_IO_Vector( CARDINAL32 Drive_Number, Sector_IO_Segment * Segments, CARDINAL32 Segment_Count, BOOLEAN Write, CARDINAL32 * Error )
+{
+
+  struct iovec   Vector[MAX_IO_VECTORS];         /* The buffers for the current run. */
+  CARDINAL32     Vector_Count;                   /* The number of entries in Vector which are in use. */
+  CARDINAL32     Index;                          /* Used to walk the Segments array. */
+  LBA            Run_Start;                      /* The first sector of the current run. */
+  LBA            Next_Sector;                    /* The sector following the last sector of the current run. */
+  size_t         Length;                         /* The size, in bytes, of the current segment. */
+
+  /* Make sure that the drive is valid, even for an empty list, and that every segment is on the drive, before we transfer any of them. */
+  if ( ! Check_IO_Request( Drive_Number, 0, 0, Error ) )
+    return;
+
+  for ( Index = 0; Index < Segment_Count; Index++ )
+  {
+
+    if ( ! Check_IO_Request( Drive_Number, Segments[Index].Starting_Sector, Segments[Index].Sector_Count, Error ) )
+      return;
+
+  }
+
+  Index = 0;
+  while ( Index < Segment_Count )
+  {
+
+    /* Start a new run with the next segment that has something in it. */
+    if ( Segments[Index].Sector_Count == 0 )
+    {
+
+      Index++;
+      continue;
+
+    }
+
+    Run_Start = Segments[Index].Starting_Sector;
+    Next_Sector = Run_Start;
+    Vector_Count = 0;
+
+    /* Add segments to the run for as long as each one picks up where the last one left off. */
+    while ( Index < Segment_Count )
+    {
+
+      if ( Segments[Index].Sector_Count > 0 )
+      {
+
+        if ( Segments[Index].Starting_Sector != Next_Sector )
+          break;
+
+        Length = (size_t) Segments[Index].Sector_Count * BYTES_PER_SECTOR;
+
+        if ( ( Vector_Count > 0 ) &&
+             ( (char *) Vector[Vector_Count - 1].iov_base + Vector[Vector_Count - 1].iov_len == (char *) Segments[Index].Buffer ) )
+        {
+
+          /* This buffer follows the last one in memory, so just make the last iovec bigger. */
+          Vector[Vector_Count - 1].iov_len += Length;
+
+        }
+        else
+        {
+
+          if ( Vector_Count == MAX_IO_VECTORS )
+            break;
+
+          Vector[Vector_Count].iov_base = Segments[Index].Buffer;
+          Vector[Vector_Count].iov_len = Length;
+          Vector_Count++;
+
+        }
+
+        Next_Sector += Segments[Index].Sector_Count;
+
+      }
+
+      Index++;
+
+    }
+
+    if ( Transfer_Vector( DriveTable[Drive_Number - 1].DriveHandle, (off_t) Run_Start * BYTES_PER_SECTOR, Vector, Vector_Count, Write ) > 0 )
+    {
+
+      if ( Write )
+        *Error = DISKIO_WRITE_FAILED;
+      else
+        *Error = DISKIO_READ_FAILED;
+
+      return;
+
+    }
+
+  }
+
+  *Error = DISKIO_NO_ERROR;
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Transfer_Vector                                  */
+/*                                                                   */
+/*   Descriptive Name: Reads or writes a range of bytes to or from   */
+/*                     several buffers, retrying until the whole     */
+/*                     range has been transferred or an error occurs.*/
+/*                                                                   */
+/*   Input: int DriveHandle : The file descriptor to use.            */
+/*          off_t Offset : The byte offset of the first byte.        */
+/*          struct iovec * Vector : The buffers to use.  This array  */
+/*                                  is modified.                     */
+/*          CARDINAL32 Vector_Count : The number of entries in       */
+/*                                    Vector.                        */
+/*          BOOLEAN Write : If TRUE, perform a write.  If FALSE,     */
+/*                          perform a read.                          */
+/*                                                                   */
+/*   Output: The number of bytes which were NOT transferred.  This   */
+/*           is 0 if the transfer was successful.                    */
+/*                                                                   */
+/*   Error Handling: Stops at the first error other than EINTR.      */
+/*                                                                   */
+/*   Side Effects: Data may be read into memory or written to disk.  */
+/*                                                                   */
+/*   Notes:  After a partial transfer, the entries in Vector which   */
+/*           were completed are skipped and the one which was only   */
+/*           partly completed is trimmed before trying again.        */
+/*                                                                   */
+/*********************************************************************/
+static size_t Transfer_Vector( int DriveHandle, off_t Offset, struct iovec * Vector, CARDINAL32 Vector_Count, BOOLEAN Write )
+{
+
+  size_t         Bytes_Remaining;                /* The number of bytes left to transfer. */
+  ssize_t        Bytes_Transferred;              /* The value returned by preadv/pwritev. */
+  CARDINAL32     Index;                          /* Used to total up the size of the transfer. */
+
+  for ( Index = 0, Bytes_Remaining = 0; Index < Vector_Count; Index++ )
+    Bytes_Remaining += Vector[Index].iov_len;
+
+  while ( Bytes_Remaining > 0 )
+  {
+
+    if ( Write )
+      Bytes_Transferred = pwritev( DriveHandle, Vector, (int) Vector_Count, Offset );
+    else
+      Bytes_Transferred = preadv( DriveHandle, Vector, (int) Vector_Count, Offset );
+
+    if ( Bytes_Transferred < 0 )
+    {
+
+      /* A signal is not an I/O error.  Try again. */
+      if ( errno == EINTR )
+        continue;
+
+      break;
+
+    }
+
+    /* Hitting end of file on a request we have already range checked means the device shrank underneath us. */
+    if ( Bytes_Transferred == 0 )
+      break;
+
+    Bytes_Remaining -= (size_t) Bytes_Transferred;
+    Offset += Bytes_Transferred;
+
+    /* Skip past whatever was transferred. */
+    while ( ( Vector_Count > 0 ) && ( (size_t) Bytes_Transferred >= Vector->iov_len ) )
+    {
+
+      Bytes_Transferred -= (ssize_t) Vector->iov_len;
+      Vector++;
+      Vector_Count--;
+
+    }
+
+    if ( Vector_Count > 0 )
+    {
+
+      Vector->iov_base = (char *) Vector->iov_base + Bytes_Transferred;
+      Vector->iov_len -= (size_t) Bytes_Transferred;
+
+    }
+
+  }
+
+  return Bytes_Remaining;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Start_Async_IO                                   */
+/*                                                                   */
+/*   Descriptive Name: Creates the io_uring instance or the worker   */
+/*                     threads used by SubmitSectorIO.               */
+/*                                                                   */
+/*   Input: None.                                                    */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: If io_uring can not be used, worker threads are */
+/*                   created instead.  If no worker threads can be   */
+/*                   created, SubmitSectorIO performs each request   */
+/*                   itself.                                         */
+/*                                                                   */
+/*   Side Effects: Async_IO_Started is set to TRUE.                  */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static void Start_Async_IO( void )
+{
+
+  Stop_Workers = FALSE;
+  Worker_Count = 0;
+  Async_IO_Started = TRUE;
+
+#ifdef USE_IO_URING
+
+  Ring_In_Flight = 0;
+
+  if ( io_uring_queue_init( IO_RING_ENTRIES, &Ring, 0 ) == 0 )
+  {
+
+    Ring_Active = TRUE;
+    return;
+
+  }
+
+  LOG_EVENT("io_uring is not available.  Worker threads will be used for asynchronous I/O.")
+
+#endif
+
+  while ( Worker_Count < IO_WORKER_COUNT )
+  {
+
+    if ( pthread_create( &(Workers[Worker_Count]), NULL, IO_Worker, NULL ) != 0 )
+    {
+
+      LOG_EVENT1("Unable to create an I/O worker thread.", "errno", errno)
+      break;
+
+    }
+
+    Worker_Count++;
+
+  }
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Stop_Async_IO                                    */
+/*                                                                   */
+/*   Descriptive Name: Waits for all requests started by             */
+/*                     SubmitSectorIO to finish, then releases the   */
+/*                     io_uring instance or the worker threads.      */
+/*                                                                   */
+/*   Input: None.                                                    */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: Completed requests which have not been reaped are */
+/*                 discarded.                                        */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static void Stop_Async_IO( void )
+{
+
+  CARDINAL32             Index;          /* Used to walk the Workers array. */
+
+#ifdef USE_IO_URING
+
+  struct io_uring_cqe *  Completion;     /* A completion taken from the ring. */
+  int                    Result;         /* The value returned by io_uring_submit_and_wait. */
+
+#endif
+
+  if ( ! Async_IO_Started )
+    return;
+
+#ifdef USE_IO_URING
+
+  if ( Ring_Active )
+  {
+
+    while ( Ring_In_Flight > 0 )
+    {
+
+      Result = io_uring_submit_and_wait( &Ring, 1 );
+      if ( ( Result < 0 ) && ( Result != -EINTR ) )
+        break;
+
+      while ( io_uring_peek_cqe( &Ring, &Completion ) == 0 )
+        Complete_Ring_Request( Completion );
+
+    }
+
+    io_uring_queue_exit( &Ring );
+    Ring_Active = FALSE;
+
+  }
+
+#endif
+
+  /* The worker threads finish everything in the pending queue before they exit. */
+  pthread_mutex_lock( &Queue_Lock );
+  Stop_Workers = TRUE;
+  pthread_cond_broadcast( &Work_Available );
+  pthread_mutex_unlock( &Queue_Lock );
+
+  for ( Index = 0; Index < Worker_Count; Index++ )
+    pthread_join( Workers[Index], NULL );
+
+  Completed_Head = NULL;
+  Completed_Tail = NULL;
+  Outstanding_Requests = 0;
+  Worker_Count = 0;
+  Stop_Workers = FALSE;
+  Async_IO_Started = FALSE;
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: IO_Worker                                        */
+/*                                                                   */
+/*   Descriptive Name: The body of each worker thread.  Takes        */
+/*                     requests from the pending queue, performs     */
+/*                     them, and places them on the completed queue. */
+/*                                                                   */
+/*   Input: void * Unused : Not used.                                */
+/*                                                                   */
+/*   Output: NULL.                                                   */
+/*                                                                   */
+/*   Error Handling: Errors are reported in each request.            */
+/*                                                                   */
+/*   Side Effects: Data may be read into memory or written to disk.  */
+/*                                                                   */
+/*   Notes:  Only Do_IO is called without Queue_Lock held.  Do_IO    */
+/*           only reads the DriveTable, which does not change while  */
+/*           any request is outstanding.                             */
+/*                                                                   */
+/*********************************************************************/
+static void * IO_Worker( void * Unused )
+{
+
+  Sector_IO_Request *  Request;   /* The request being performed. */
+
+  pthread_mutex_lock( &Queue_Lock );
+
+  for (;;)
+  {
+
+    while ( ( Pending_Head == NULL ) && ( ! Stop_Workers ) )
+      pthread_cond_wait( &Work_Available, &Queue_Lock );
+
+    Request = Remove_First_Request( &Pending_Head, &Pending_Tail );
+    if ( Request == NULL )
+      break;
+
+    pthread_mutex_unlock( &Queue_Lock );
+
+    Do_IO( Request->Drive_Number, Request->Starting_Sector, Request->Sector_Count, Request->Buffer, Request->Write, &(Request->Error) );
+
+    pthread_mutex_lock( &Queue_Lock );
+
+    Append_Request( &Completed_Head, &Completed_Tail, Request );
+    pthread_cond_signal( &Work_Completed );
+
+  }
+
+  pthread_mutex_unlock( &Queue_Lock );
+
+  return NULL;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Append_Request                                   */
+/*                                                                   */
+/*   Descriptive Name: Adds a request to the end of a queue.         */
+/*                                                                   */
+/*   Input: Sector_IO_Request ** Head : The first request in the     */
+/*                                      queue.                       */
+/*          Sector_IO_Request ** Tail : The last request in the      */
+/*                                      queue.                       */
+/*          Sector_IO_Request * Request : The request to add.        */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: *Head and *Tail may be changed.                   */
+/*                                                                   */
+/*   Notes:  The caller must hold Queue_Lock.                        */
+/*                                                                   */
+/*********************************************************************/
+static void Append_Request( Sector_IO_Request ** Head, Sector_IO_Request ** Tail, Sector_IO_Request * Request )
+{
+
+  Request->Next = NULL;
+
+  if ( *Tail == NULL )
+    *Head = Request;
+  else
+    (*Tail)->Next = Request;
+
+  *Tail = Request;
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Remove_First_Request                             */
+/*                                                                   */
+/*   Descriptive Name: Removes the first request from a queue.       */
+/*                                                                   */
+/*   Input: Sector_IO_Request ** Head : The first request in the     */
+/*                                      queue.                       */
+/*          Sector_IO_Request ** Tail : The last request in the      */
+/*                                      queue.                       */
+/*                                                                   */
+/*   Output: The request removed, or NULL if the queue was empty.    */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: *Head and *Tail may be changed.                   */
+/*                                                                   */
+/*   Notes:  The caller must hold Queue_Lock.                        */
+/*                                                                   */
+/*********************************************************************/
+static Sector_IO_Request * Remove_First_Request( Sector_IO_Request ** Head, Sector_IO_Request ** Tail )
+{
+
+  Sector_IO_Request *  Request;   /* The request being removed. */
+
+  Request = *Head;
+  if ( Request != NULL )
+  {
+
+    *Head = Request->Next;
+    if ( *Head == NULL )
+      *Tail = NULL;
+
+    Request->Next = NULL;
+
+  }
+
+  return Request;
+
+}
+
+
+#ifdef USE_IO_URING
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Complete_Ring_Request                            */
+/*                                                                   */
+/*   Descriptive Name: Records the result of a request performed by  */
+/*                     io_uring and moves the request to the         */
+/*                     completed queue.                              */
+/*                                                                   */
+/*   Input: struct io_uring_cqe * Completion : The completion to     */
+/*                                             process.              */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: The request's Error field is set if the         */
+/*                   transfer failed.                                */
+/*                                                                   */
+/*   Side Effects: The completion is released back to the ring.      */
+/*                                                                   */
+/*   Notes:  io_uring, like pread and pwrite, may transfer less than */
+/*           was asked for.  Whatever is left is finished here with  */
+/*           Transfer_Data.                                          */
+/*                                                                   */
+/*********************************************************************/
+static void Complete_Ring_Request( struct io_uring_cqe * Completion )
+{
+
+  Sector_IO_Request *  Request;          /* The request which completed. */
+  int                  Result;           /* The number of bytes transferred, or a negative errno value. */
+  size_t               Bytes_Requested;  /* The size of the request in bytes. */
+  size_t               Bytes_Remaining;  /* The number of bytes which were not transferred. */
+
+  Request = (Sector_IO_Request *) io_uring_cqe_get_data( Completion );
+  Result = Completion->res;
+  io_uring_cqe_seen( &Ring, Completion );
+  Ring_In_Flight--;
+
+  Bytes_Requested = (size_t) Request->Sector_Count * BYTES_PER_SECTOR;
+
+  /* An interrupted or refused request is simply done again, synchronously. */
+  if ( ( Result == -EINTR ) || ( Result == -EAGAIN ) )
+    Result = 0;
+
+  if ( Result < 0 )
+    Bytes_Remaining = Bytes_Requested;
+  else
+    Bytes_Remaining = Transfer_Data( DriveTable[Request->Drive_Number - 1].DriveHandle,
+                                     (off_t) Request->Starting_Sector * BYTES_PER_SECTOR + Result,
+                                     (char *) Request->Buffer + Result,
+                                     Bytes_Requested - (size_t) Result,
+                                     Request->Write );
+
+  if ( Bytes_Remaining > 0 )
+    Request->Error = Request->Write ? DISKIO_WRITE_FAILED : DISKIO_READ_FAILED;
+  else
+    Request->Error = DISKIO_NO_ERROR;
+
+  pthread_mutex_lock( &Queue_Lock );
+  Append_Request( &Completed_Head, &Completed_Tail, Request );
+  pthread_mutex_unlock( &Queue_Lock );
+
+  return;
+
+}
+
+#endif
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Get_Disk_Names                                   */
+/*                                                                   */
+/*   Descriptive Name: Builds an array of the path names of the      */
+/*                     drives which this module is to manage.        */
+/*                                                                   */
+/*   Input: CARDINAL32 * Name_Count : The address of a variable to   */
+/*                                    hold the number of names found.*/
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If successful, the function return value is an array of */
+/*           *Name_Count NULL terminated path names, each allocated  */
+/*           with malloc, and *Error is DISKIO_NO_ERROR.  If         */
+/*           unsuccessful, or if no names were found, NULL is        */
+/*           returned and *Error is > 0.                             */
+/*                                                                   */
+/*   Error Handling: Any memory allocated is freed on failure.       */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  The LVM_DISKS environment variable takes precedence     */
+/*           over the disk config file.                              */
+/*                                                                   */
+/*********************************************************************/
+static char ** Get_Disk_Names( CARDINAL32 * Name_Count, CARDINAL32 * Error )
+{
+
+  char **    Disk_Names;                        /* The array being built. */
+  char *     Disk_List;                         /* The value of the LVM_DISKS environment variable. */
+  char *     Config_File_Name;                  /* The name of the disk config file. */
+  FILE *     Config_File;                       /* The disk config file. */
+  char       Line[MAX_DISK_NAME_LENGTH];        /* Holds one name from either source. */
+  char *     Start;                             /* The start of a name within Line. */
+  char *     End;                               /* The end of a name within Line or Disk_List. */
+  CARDINAL32 Length;                            /* The length of a name. */
+
+  Disk_Names = NULL;
+  *Name_Count = 0;
+
+  Disk_List = getenv( DISK_LIST_VARIABLE );
+  if ( ( Disk_List != NULL ) && ( *Disk_List != 0x0 ) )
+  {
+
+    /* Split the list at each separator. */
+    while ( *Disk_List != 0x0 )
+    {
+
+      End = strchr( Disk_List, DISK_NAME_SEPARATOR );
+      if ( End == NULL )
+        End = Disk_List + strlen( Disk_List );
+
+      Length = End - Disk_List;
+      if ( Length >= MAX_DISK_NAME_LENGTH )
+      {
+
+        LOG_ERROR("A name in LVM_DISKS is too long.")
+
+        Free_Disk_Names( Disk_Names, *Name_Count );
+        *Error = DISKIO_NO_DRIVES_FOUND;
+        return NULL;
+
+      }
+
+      if ( Length > 0 )
+      {
+
+        memcpy( Line, Disk_List, Length );
+        Line[Length] = 0x0;
+
+        if ( ! Add_Disk_Name( &Disk_Names, Name_Count, Line, Error ) )
+          return NULL;
+
+      }
+
+      Disk_List = ( *End == DISK_NAME_SEPARATOR ) ? End + 1 : End;
+
+    }
+
+  }
+  else
+  {
+
+    /* There is no LVM_DISKS variable, so use the config file. */
+    Config_File_Name = getenv( DISK_CONFIG_VARIABLE );
+    if ( ( Config_File_Name == NULL ) || ( *Config_File_Name == 0x0 ) )
+      Config_File_Name = DEFAULT_DISK_CONFIG_FILE;
+
+    if ( Logging_Enabled )
+    {
+
+      sprintf(Log_Buffer,"Reading the list of drives from %s", Config_File_Name);
+      Write_Log_Buffer();
+
+    }
+
+    Config_File = fopen( Config_File_Name, "r" );
+    if ( Config_File == NULL )
+    {
+
+      *Error = DISKIO_NO_DRIVES_FOUND;
+      return NULL;
+
+    }
+
+    while ( fgets( Line, sizeof(Line), Config_File ) != NULL )
+    {
+
+      /* Strip leading and trailing white space, including the new line. */
+      Start = Line;
+      while ( isspace( (unsigned char) *Start ) )
+        Start++;
+
+      End = Start + strlen( Start );
+      while ( ( End > Start ) && isspace( (unsigned char) *(End - 1) ) )
+        End--;
+
+      *End = 0x0;
+
+      /* Skip blank lines and comments. */
+      if ( ( *Start == 0x0 ) || ( *Start == '#' ) )
+        continue;
+
+      if ( ! Add_Disk_Name( &Disk_Names, Name_Count, Start, Error ) )
+      {
+
+        fclose( Config_File );
+        return NULL;
+
+      }
+
+    }
+
+    fclose( Config_File );
+
+  }
+
+  if ( *Name_Count == 0 )
+  {
+
+    *Error = DISKIO_NO_DRIVES_FOUND;
+    return NULL;
+
+  }
+
+  *Error = DISKIO_NO_ERROR;
+
+  return Disk_Names;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Add_Disk_Name                                    */
+/*                                                                   */
+/*   Descriptive Name: Appends a copy of a path name to the array    */
+/*                     being built by Get_Disk_Names.                */
+/*                                                                   */
+/*   Input: char *** Disk_Names : The address of the array.          */
+/*          CARDINAL32 * Name_Count : The number of names in the     */
+/*                                    array.                         */
+/*          char * Name : The NULL terminated path name to append.   */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: TRUE if the name was added, FALSE otherwise.            */
+/*                                                                   */
+/*   Error Handling: On failure, the whole array is freed and        */
+/*                   *Error is set to DISKIO_OUT_OF_MEMORY.          */
+/*                                                                   */
+/*   Side Effects: *Disk_Names may be reallocated.                   */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static BOOLEAN Add_Disk_Name( char *** Disk_Names, CARDINAL32 * Name_Count, char * Name, CARDINAL32 * Error )
+{
+
+  char **   New_Names;     /* The enlarged array. */
+  char *    Name_Copy;     /* The copy of Name being added. */
+
+  New_Names = (char **) realloc( *Disk_Names, ( *Name_Count + 1 ) * sizeof(char *) );
+  if ( New_Names == NULL )
+  {
+
+    Free_Disk_Names( *Disk_Names, *Name_Count );
+    *Error = DISKIO_OUT_OF_MEMORY;
+    return FALSE;
+
+  }
+
+  *Disk_Names = New_Names;
+
+  Name_Copy = (char *) malloc( strlen(Name) + 1 );
+  if ( Name_Copy == NULL )
+  {
+
+    Free_Disk_Names( *Disk_Names, *Name_Count );
+    *Error = DISKIO_OUT_OF_MEMORY;
+    return FALSE;
+
+  }
+
+  strcpy( Name_Copy, Name );
+  New_Names[*Name_Count] = Name_Copy;
+  (*Name_Count)++;
+
+  *Error = DISKIO_NO_ERROR;
+
+  return TRUE;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Free_Disk_Names                                  */
+/*                                                                   */
+/*   Descriptive Name: Frees an array built by Get_Disk_Names.       */
+/*                                                                   */
+/*   Input: char ** Disk_Names : The array to free.  May be NULL.    */
+/*          CARDINAL32 Name_Count : The number of names in the array.*/
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: N/A                                             */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static void Free_Disk_Names( char ** Disk_Names, CARDINAL32 Name_Count )
+{
+
+  CARDINAL32   Index;
+
+  if ( Disk_Names == NULL )
+    return;
+
+  for ( Index = 0; Index < Name_Count; Index++ )
+    free( Disk_Names[Index] );
+
+  free( Disk_Names );
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Initialize_Drive                                 */
+/*                                                                   */
+/*   Descriptive Name: Opens the device named in Drive->DeviceName   */
+/*                     and fills in the rest of *Drive.              */
+/*                                                                   */
+/*   Input: DiskDriveData * Drive : The DriveTable entry to fill in. */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: TRUE if the drive is ready for use, FALSE otherwise.    */
+/*                                                                   */
+/*   Error Handling: On failure, *Error is set and the device is not */
+/*                   left open.                                      */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  Block devices supply their own size and, where the      */
+/*           driver provides one, their own heads and sectors per    */
+/*           track.  Image files use the size of the file and a      */
+/*           255 head, 63 sector per track geometry, which is what   */
+/*           LBA assisted BIOS translation produces for large disks. */
+/*           Any sectors beyond the last full cylinder are not       */
+/*           reported to the engine, just as under OS2DASD.          */
+/*           Devices with more sectors than a 32 bit sector number   */
+/*           can address are reported as being that large, and the   */
+/*           rest of the device is not used.                         */
+/*                                                                   */
+/*********************************************************************/
+static BOOLEAN Initialize_Drive( DiskDriveData * Drive, CARDINAL32 * Error )
+{
+
+  struct stat          Device_Status;       /* Used to tell block devices from image files. */
+  struct hd_geometry   Device_Geometry;     /* The geometry reported by the block device driver. */
+  unsigned long long   Device_Size;         /* The size, in bytes, of the device. */
+  int                  Sector_Size;         /* The logical sector size of a block device. */
+  unsigned long long   Cylinders;           /* Used to clamp the cylinder count. */
+
+  Drive->DriveHandle = open( Drive->DeviceName, O_RDWR );
+  if ( Drive->DriveHandle < 0 )
+  {
+
+    if ( Logging_Enabled )
+    {
+
+      sprintf(Log_Buffer,"Unable to open %s, errno = %d", Drive->DeviceName, errno);
+      Write_Log_Buffer();
+
+    }
+
+    *Error = DISKIO_FAILED_TO_GET_HANDLE;
+    return FALSE;
+
+  }
+
+  if ( fstat( Drive->DriveHandle, &Device_Status ) != 0 )
+  {
+
+    *Error = DISKIO_UNEXPECTED_OS_ERROR;
+    close( Drive->DriveHandle );
+    Drive->DriveHandle = -1;
+    return FALSE;
+
+  }
+
+  Drive->Heads = DEFAULT_HEADS;
+  Drive->SectorsPerTrack = DEFAULT_SECTORS_PER_TRACK;
+  Drive->Is_PRM = FALSE;
+
+  if ( S_ISBLK(Device_Status.st_mode) )
+  {
+
+    Drive->Is_Block_Device = TRUE;
+
+    /* The engine assumes BYTES_PER_SECTOR sized sectors throughout. */
+    if ( ( ioctl( Drive->DriveHandle, BLKSSZGET, &Sector_Size ) != 0 ) ||
+         ( Sector_Size != BYTES_PER_SECTOR ) ||
+         ( ioctl( Drive->DriveHandle, BLKGETSIZE64, &Device_Size ) != 0 ) )
+    {
+
+      *Error = DISKIO_BAD_GEOMETRY;
+      close( Drive->DriveHandle );
+      Drive->DriveHandle = -1;
+      return FALSE;
+
+    }
+
+    /* Use the driver's idea of heads and sectors per track if it has one. */
+    if ( ( ioctl( Drive->DriveHandle, HDIO_GETGEO, &Device_Geometry ) == 0 ) &&
+         ( Device_Geometry.heads != 0 ) &&
+         ( Device_Geometry.sectors != 0 ) )
+    {
+
+      Drive->Heads = Device_Geometry.heads;
+      Drive->SectorsPerTrack = Device_Geometry.sectors;
+
+    }
+
+    Drive->Is_PRM = Device_Is_Removable( Drive->DriveHandle );
+
+  }
+  else if ( S_ISREG(Device_Status.st_mode) )
+  {
+
+    Drive->Is_Block_Device = FALSE;
+    Device_Size = (unsigned long long) Device_Status.st_size;
+
+  }
+  else
+  {
+
+    *Error = DISKIO_FAILED_TO_GET_HANDLE;
+    close( Drive->DriveHandle );
+    Drive->DriveHandle = -1;
+    return FALSE;
+
+  }
+
+  /* Don't let the sector count wrap on devices over 2 TB.  Only the part of the device that LVM can address is reported. */
+  if ( ( Device_Size / BYTES_PER_SECTOR ) > MAXIMUM_TOTAL_SECTORS )
+  {
+
+    if ( Logging_Enabled )
+    {
+
+      sprintf(Log_Buffer,"%s has %llu sectors.  Only the first %llu will be used.", Drive->DeviceName, Device_Size / BYTES_PER_SECTOR, MAXIMUM_TOTAL_SECTORS);
+      Write_Log_Buffer();
+
+    }
+
+    Device_Size = MAXIMUM_TOTAL_SECTORS * BYTES_PER_SECTOR;
+
+  }
+
+  Drive->TotalSectors = (LBA) ( Device_Size / BYTES_PER_SECTOR );
+
+  Cylinders = Drive->TotalSectors / ( (unsigned long long) Drive->Heads * Drive->SectorsPerTrack );
+  if ( Cylinders > MAXIMUM_CYLINDERS )
+    Cylinders = MAXIMUM_CYLINDERS;
+
+  if ( Cylinders == 0 )
+  {
+
+    /* The device is smaller than one cylinder. */
+    *Error = DISKIO_BAD_GEOMETRY;
+    close( Drive->DriveHandle );
+    Drive->DriveHandle = -1;
+    return FALSE;
+
+  }
+
+  Drive->Cylinders = (CARDINAL16) Cylinders;
+
+  /* There is no BIOS in the I/O path, so there is no 1024 cylinder limit. */
+  Drive->Cylinder_Limit_Applies = FALSE;
+
+  Drive->Initialized = TRUE;
+
+  *Error = DISKIO_NO_ERROR;
+
+  return TRUE;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Device_Is_Removable                              */
+/*                                                                   */
+/*   Descriptive Name: Determines whether a block device holds       */
+/*                     removable media.                              */
+/*                                                                   */
+/*   Input: int DriveHandle : An open file descriptor for the device.*/
+/*                                                                   */
+/*   Output: TRUE if sysfs reports the device as removable, FALSE    */
+/*           otherwise.                                              */
+/*                                                                   */
+/*   Error Handling: Any failure is treated as "not removable".      */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static BOOLEAN Device_Is_Removable( int DriveHandle )
+{
+
+  struct stat   Device_Status;       /* Used to get the device number. */
+  char          Attribute_Name[64];  /* The name of the sysfs removable attribute. */
+  FILE *        Attribute;           /* The sysfs removable attribute. */
+  int           Value;               /* The contents of the attribute. */
+
+  if ( fstat( DriveHandle, &Device_Status ) != 0 )
+    return FALSE;
+
+  sprintf( Attribute_Name, "/sys/dev/block/%u:%u/removable", major(Device_Status.st_rdev), minor(Device_Status.st_rdev) );
+
+  Attribute = fopen( Attribute_Name, "r" );
+  if ( Attribute == NULL )
+    return FALSE;
+
+  if ( fscanf( Attribute, "%d", &Value ) != 1 )
+    Value = 0;
+
+  fclose( Attribute );
+
+  return ( Value != 0 );
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Issue_Ring0_Feature_Command                      */
+/*                                                                   */
+/*   Descriptive Name: Issues a feature specific command to the      */
+/*                     Ring 0 portion of a feature.                  */
+/*                                                                   */
+/*   Input: CARDINAL32 Feature_ID - The numeric ID assigned to the   */
+/*                                  feature which is to receive the  */
+/*                                  command being issued.            */
+/*          char Drive_Letter - The drive letter of the volume whose */
+/*                              feature is to receive the command.   */
+/*          ADDRESS InputBuffer - A buffer containing the command.   */
+/*          CARDINAL32 * Error_Code - The address of a CARDINAL32 in */
+/*                                   in which to store an error code */
+/*                                   should an error occur.          */
+/*                                                                   */
+/*   Output: *Error_Code is always DISKIO_UNEXPECTED_OS_ERROR.       */
+/*                                                                   */
+/*   Error Handling: N/A                                             */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  There is no Ring 0 portion of any feature under Linux.  */
+/*                                                                   */
+/*********************************************************************/
+void Issue_Ring0_Feature_Command( CARDINAL32   Feature_ID,
+                                  char         Drive_Letter,
+                                  ADDRESS      Buffer,
+                                  CARDINAL32 * Error_Code )
+{
+
+  *Error_Code = DISKIO_UNEXPECTED_OS_ERROR;
+
+  return;
+
+}
@@ -61,9 +61,22 @@
  *            void        GoToEndOfList
  *            void        GoToSpecifiedItem
  *            void        SortList
+ *            void        SortListByKey
  *            void        ForEachItem
  *            void        PruneList
  *            void        AppendList
+ *            void        TransferItem
+ *            void        GetListPoolStatistics
+ *            void        CreateListIndex
+ *            void        DestroyListIndex
+ *            ADDRESS     FindByKey
+ *            void        ReindexItem
+ *            void        ShareList
+ *            void        LockList
+ *            void        UnlockList
+ *            void        BeginListRead
+ *            ADDRESS     ReadNextObject
+ *            void        EndListRead
  *
  * Description:  This module implements a simple, generic, doubly linked list.
  *               Data objects of any type can be placed into a linked list
@@ -76,6 +89,15 @@
 
 #include <stdlib.h>   /* free */
 #include <string.h>   /* memcpy */
+#include <stddef.h>   /* offsetof */
+
+#ifndef __linux__
+
+  #define INCL_DOSPROCESS
+  #include <os2.h>      /* DosEnterCritSec, DosExitCritSec */
+
+#endif
+
 #include "dlist.h"    /* Import dlist.h so that the compiler can check the
                          consistency of the declarations in dlist.h against
                          those in this module.                              */
@@ -85,6 +107,16 @@
 
 #endif
 
+#ifdef __linux__
+
+  #include <pthread.h>  /* pthread_mutex_t, pthread_mutex_init, pthread_mutex_lock, pthread_mutex_unlock, pthread_mutex_destroy */
+
+#else
+
+  #include "lock.h"     /* SEMAPHORE, CreateSemaphore, Lock, Unlock, DestroySemaphore */
+
+#endif
+
 #ifdef DEBUG
 
   #ifdef PARANOID
@@ -106,6 +138,39 @@
    the operation is aborted.                                                 */
 #define VerifyValue 39646966L
 
+#ifndef USE_POOLMAN
+
+/* LinkNodes are allocated from slabs belonging to the list which needed them.  Most lists are short, so the first slab for a list
+   is small.  Each slab after that is twice the size of the one before it, up to MAXIMUM_NODES_PER_SLAB.                            */
+#define INITIAL_NODES_PER_SLAB      8
+#define MAXIMUM_NODES_PER_SLAB    256
+
+#endif
+
+/* The index of a list starts out with INITIAL_INDEX_BUCKETS buckets.  The number of buckets is doubled whenever the number of
+   indexed items exceeds it, so the chain for each bucket stays short.  The number of buckets must always be a power of 2.    */
+#define INITIAL_INDEX_BUCKETS      16
+
+/* SortList sorts runs of up to SORT_RUN_LENGTH items with an insertion sort before it starts merging.  Short runs are cheaper
+   to sort in place than to merge, and starting the merge at a larger run size saves several passes over the array.            */
+#define SORT_RUN_LENGTH             8
+
+/* Items of up to INLINE_ITEM_SIZE bytes which are added to a list by InsertItem are copied into the LinkNode created for them,
+   rather than into a separate block of memory.  Kill_Sector_Data, Feature_Search_Data and LVM_Token all fit.                */
+#define INLINE_ITEM_SIZE           16
+
+/* A shared list may be read by up to MAXIMUM_LIST_READERS readers at the same time, counting the readers of all shared lists. */
+#define MAXIMUM_LIST_READERS       64
+
+/* Readers of a shared list walk it without taking any locks, so a writer must make sure that a new LinkNode, and the item it
+   points to, are completely filled in before the LinkNode is linked into the list.  The x86 processors this code was written
+   for do not reorder stores, so only the compiler needs to be held back there.                                                */
+#if defined(__GNUC__)
+  #define PUBLISH_BARRIER()   __sync_synchronize()
+#else
+  #define PUBLISH_BARRIER()
+#endif
+
 
 /*--------------------------------------------------
  * Private Type definitions
@@ -158,6 +223,8 @@ NOTES:  The ControlNode does the bookeeping for things which affect the
 
 */
 
+/* NOTE: The first six fields of a LinkNode, and the first three fields of a ControlNode, are described to users of this module
+         by DLIST_Item_View and DLIST_List_View in dlist.h.  Those fields must not be moved.                                    */
 struct LinkNodeRecord
 {
   ADDRESS                   DataLocation;        /* Where the data associated with this LinkNode is */
@@ -167,10 +234,102 @@ struct LinkNodeRecord
                                                     item.                                         */
   struct LinkNodeRecord *   NextLinkNode;        /* The LinkNode of the next item in the list. */
   struct LinkNodeRecord *   PreviousLinkNode;    /* The LinkNode of the item preceeding this one in the list. */
+#ifndef USE_POOLMAN
+  struct LinkNodeSlabRecord * Slab;              /* The slab this LinkNode was allocated from. */
+#endif
+  struct LinkNodeRecord *   NextIndexedNode;     /* The next LinkNode in the same bucket of the index of the list. */
+  CARDINAL32                KeyHash;             /* The hash of the key of the item at the time it was indexed. */
+  BOOLEAN                   Indexed;             /* TRUE if this LinkNode is in the index of the list containing it. */
+  BOOLEAN                   FreeData;            /* TRUE if the data of a retired LinkNode is to be freed along with it. */
+  union
+  {
+    char                    Bytes[INLINE_ITEM_SIZE];
+    ADDRESS                 Address_Alignment;
+    double                  Double_Alignment;
+  }                         InlineItem;          /* Holds an item small enough to be kept in the LinkNode. */
 };
 
 typedef struct LinkNodeRecord LinkNode;
 
+/* TRUE if the item belonging to a LinkNode is kept in the LinkNode itself. */
+#define ITEM_IS_INLINE( Node )   ( (Node)->DataLocation == (ADDRESS) (Node)->InlineItem.Bytes )
+
+#ifndef USE_POOLMAN
+
+/* Each list has a pool of LinkNodes, which is made up of one or more slabs.  A LinkNode stays in the slab it was allocated from
+   for its entire life, even if the item it belongs to is moved to another list by AppendList or TransferItem.  A LinkNode which
+   is no longer in use is returned to its slab, and a slab is freed once none of its LinkNodes are in use.  If a list is destroyed
+   while LinkNodes from its slabs are in use by other lists, those slabs are orphaned and are freed when their last LinkNode is
+   released.                                                                                                                        */
+struct LinkNodeSlabRecord
+{
+  struct MasterListRecord *   Owner;             /* The list whose pool this slab is part of, or NULL if the slab has been orphaned. */
+  struct LinkNodeSlabRecord * NextSlab;          /* The next slab in the pool. */
+  struct LinkNodeSlabRecord * PreviousSlab;      /* The previous slab in the pool. */
+  LinkNode *                  FreeNodes;         /* The unused LinkNodes in this slab, chained through their NextLinkNode fields. */
+  CARDINAL32                  NodeCount;         /* The number of LinkNodes in this slab. */
+  CARDINAL32                  NodesInUse;        /* The number of LinkNodes in this slab which are in use, by any list. */
+  LinkNode                    Nodes[1];          /* The LinkNodes.  The slab is allocated with room for NodeCount of them. */
+};
+
+typedef struct LinkNodeSlabRecord LinkNodeSlab;
+
+typedef struct _LinkNodePool
+{
+  LinkNodeSlab *        FirstSlab;               /* The slabs in the pool.  Slabs with unused LinkNodes are kept ahead of full slabs. */
+  LinkNodeSlab *        LastSlab;
+  CARDINAL32            NextSlabSize;            /* The number of LinkNodes to place in the next slab allocated. */
+  DLIST_Pool_Statistics Statistics;
+} LinkNodePool;
+
+#endif
+
+/* A list may have an index, which allows items to be found by key without walking the list.  The index is a hash table whose
+   chains run through the NextIndexedNode fields of the LinkNodes, so indexing an item does not require any memory beyond the
+   buckets themselves.  The key of an item is obtained from the key function supplied when the index was created.  Items for
+   which the key function returns FALSE are not indexed.                                                                        */
+typedef struct _ListIndex
+{
+  DLIST_Key_Function    GetKey;                  /* The function which returns the key of an item. */
+  LinkNode **           Buckets;                 /* The chains of indexed LinkNodes. */
+  CARDINAL32            BucketMask;              /* The number of buckets - 1. */
+  CARDINAL32            IndexedCount;            /* The number of LinkNodes in the index. */
+} ListIndex;
+
+#ifdef __linux__
+
+/* The locks used by shared lists.  On OS/2 these come from lock.h.  They are provided here for Linux so that this module does
+   not have to depend on anything but pthreads there.                                                                          */
+typedef pthread_mutex_t * SEMAPHORE;
+
+#endif
+
+/* A shared list is one which may be read by several threads while another thread changes it.  Writers serialize on Writer_Lock.
+   Readers take no locks at all, so a LinkNode which has been removed from a shared list can not be reused until every reader
+   which might still be looking at it has finished.  Such LinkNodes are retired instead of released.  A retired LinkNode keeps
+   its links and data, so a reader positioned on it can still move on to the rest of the list, and it is chained to the other
+   retired LinkNodes of the list through its NextIndexedNode field.  LinkNodes retired since the list was last unlocked are kept
+   on the Retiring chain.  When the list is unlocked, they are stamped with the current epoch, which is kept in their KeyHash
+   fields, and moved to the end of the Retired chain.  A retired LinkNode is released once every reader active at the time it
+   was stamped has finished.                                                                                                   */
+typedef struct _SharedList
+{
+  SEMAPHORE             Writer_Lock;             /* Held by the thread changing the list. */
+  LinkNode *            Retiring;                /* LinkNodes retired since the list was last unlocked. */
+  LinkNode *            OldestRetired;           /* Stamped LinkNodes waiting for readers to finish, oldest first. */
+  LinkNode *            NewestRetired;
+} SharedList;
+
+/* SortListByKey sorts an array of the following records, so that the key of each item is only obtained once. */
+typedef struct _SortKeyRecord
+{
+  CARDINAL32            Key;                     /* The sort key returned for the item. */
+  LinkNode *            Node;                    /* The LinkNode of the item. */
+} SortKeyRecord;
+
+/* The comparison function passed to SortList. */
+typedef INTEGER32 (* _System Compare_Function) (ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag, CARDINAL32 * Error);
+
 struct MasterListRecord
 {
   CARDINAL32      ItemCount;             /* The number of items in the list. */
@@ -179,12 +338,31 @@ struct MasterListRecord
   LinkNode *      CurrentItem;           /* The address of the LinkNode of the current item in the list. */
 #ifdef USE_POOLMAN
   POOL            NodePool;              /* The pool of LinkNodes for this DLIST. */
+#else
+  LinkNodePool    NodePool;              /* The pool of LinkNodes for this DLIST. */
 #endif
+  ListIndex *     Index;                 /* The index for this DLIST, or NULL if the DLIST is not indexed. */
+  SharedList *    Shared;                /* The reader tracking for this DLIST, or NULL if the DLIST is not shared. */
   CARDINAL32      Verify;                /* A field to contain the VerifyValue which marks this as a list created by this module. */
 };
 
 typedef struct MasterListRecord ControlNode;
 
+/* The DLIST_FOREACH macros in dlist.h walk lists using DLIST_Item_View and DLIST_List_View, which must match the leading fields
+   of LinkNode and ControlNode.  If they ever get out of step, the array sizes below become negative and this module will not
+   compile.                                                                                                                     */
+typedef char DLIST_Item_View_Matches_LinkNode[ ( ( offsetof(LinkNode, DataLocation) == offsetof(DLIST_Item_View, Object) ) &&
+                                                 ( offsetof(LinkNode, DataSize) == offsetof(DLIST_Item_View, ObjectSize) ) &&
+                                                 ( offsetof(LinkNode, DataTag) == offsetof(DLIST_Item_View, ObjectTag) ) &&
+                                                 ( offsetof(LinkNode, NextLinkNode) == offsetof(DLIST_Item_View, Next) ) &&
+                                                 ( offsetof(LinkNode, PreviousLinkNode) == offsetof(DLIST_Item_View, Previous) )
+                                               ) ? 1 : -1 ];
+
+typedef char DLIST_List_View_Matches_ControlNode[ ( ( offsetof(ControlNode, ItemCount) == offsetof(DLIST_List_View, ItemCount) ) &&
+                                                    ( offsetof(ControlNode, StartOfList) == offsetof(DLIST_List_View, First) ) &&
+                                                    ( offsetof(ControlNode, EndOfList) == offsetof(DLIST_List_View, Last) )
+                                                  ) ? 1 : -1 ];
+
 
 /*--------------------------------------------------
  Private global variables.
@@ -195,10 +373,75 @@ BOOLEAN  ErrorsFound = FALSE; /* Used to track whether or not errors have
                                  an error is detected so that the type of
                                  error can be seen.                              */
 
+/* Readers of shared lists.  Each reader occupies a slot in Reader_Epochs, which holds the epoch in which the reader began, or 0
+   if the slot is free.  Current_Epoch is advanced each time a shared list is unlocked, and never takes the value 0.  Both are
+   protected by Reader_Lock.  On OS/2, Reader_Lock is created when the first list is shared.                                  */
+#ifdef __linux__
+
+static pthread_mutex_t Reader_Mutex = PTHREAD_MUTEX_INITIALIZER;
+static SEMAPHORE   Reader_Lock = &Reader_Mutex;
+
+#else
+
+static SEMAPHORE   Reader_Lock = NULL;
+
+#endif
+static CARDINAL32  Current_Epoch = 1;
+static CARDINAL32  Reader_Epochs[MAXIMUM_LIST_READERS];
+
+/* Retired LinkNodes claim to belong to this ControlNode, so that a handle to an item which has been removed from a shared list
+   is rejected, and so that the slab code does not mistake them for unused LinkNodes.                                         */
+static ControlNode Retired_Owner;
+
 
 /*--------------------------------------------------
- There are no private functions.
+ Private functions.
 --------------------------------------------------*/
+#ifndef USE_POOLMAN
+
+static void       Add_Slab( LinkNodePool * Pool, LinkNodeSlab * Slab, BOOLEAN AtFront );
+static void       Remove_Slab( LinkNodePool * Pool, LinkNodeSlab * Slab );
+static LinkNode * Allocate_LinkNode( ControlNode * ListData );
+static void       Release_LinkNode( LinkNode * Node );
+static void       Reclaim_Slabs( ControlNode * ListData );
+
+#endif
+
+static CARDINAL32 Hash_Key( ADDRESS Key, CARDINAL32 KeySize );
+static void       Index_LinkNode( ListIndex * Index, LinkNode * Node );
+static void       Unindex_LinkNode( ListIndex * Index, LinkNode * Node );
+static void       Clear_Index( ListIndex * Index );
+static void       Destroy_Index( ListIndex * Index );
+
+static void       Merge_Sort_LinkNodes( ControlNode * ListData, Compare_Function Compare, DLIST_Sort_Key_Function GetSortKey, CARDINAL32 * Error );
+static LinkNode ** Sort_LinkNode_Array( LinkNode ** Nodes, LinkNode ** Work, CARDINAL32 Count, Compare_Function Compare, CARDINAL32 * Error );
+static void       Relink_LinkNodes( ControlNode * ListData, LinkNode ** Nodes );
+
+#ifdef __linux__
+
+static SEMAPHORE  CreateSemaphore( void );
+static void       Lock( SEMAPHORE Semaphore );
+static void       Unlock( SEMAPHORE Semaphore );
+static void       DestroySemaphore( SEMAPHORE Semaphore );
+
+#endif
+
+static ADDRESS    Insert_LinkNode( DLIST ListToAddTo, CARDINAL32 ItemSize, ADDRESS ItemLocation, TAG ItemTag, ADDRESS TargetHandle,
+                                   Insertion_Modes Insert_Mode, BOOLEAN MakeCurrent, BOOLEAN CopyItem, CARDINAL32 * Error );
+static void       Free_Item( LinkNode * Node );
+static ADDRESS    Take_Item( LinkNode * Node );
+
+static void       Retire_LinkNode( ControlNode * ListData, LinkNode * Node, BOOLEAN FreeData );
+
+#ifdef USE_POOLMAN
+
+static void       Free_Retired_LinkNodes( POOL NodePool, LinkNode * Chain );
+
+#else
+
+static void       Free_Retired_LinkNodes( LinkNode * Chain );
+
+#endif
 
 
 
@@ -291,6 +534,8 @@ DLIST _System CreateList(CARDINAL32 InitialPoolSize,
   ListData->StartOfList = NULL;    /* Since the list is empty, there is no first item */
   ListData->EndOfList = NULL;      /* Since the list is empty, there is no last item */
   ListData->CurrentItem = NULL;    /* Since the list is empty, there is no current item */
+  ListData->Index = NULL;          /* Lists are not indexed until CreateListIndex is called. */
+  ListData->Shared = NULL;         /* Lists are not shared until ShareList is called. */
 
   /* Create the pool of link nodes for this list. */
   ListData->NodePool = CreatePool(sizeof(LinkNode),InitialPoolSize, MaximumPoolSize, PoolIncrement,FALSE);
@@ -378,6 +623,12 @@ DLIST _System CreateList( void )
   ListData->StartOfList = NULL;    /* Since the list is empty, there is no first item */
   ListData->EndOfList = NULL;      /* Since the list is empty, there is no last item */
   ListData->CurrentItem = NULL;    /* Since the list is empty, there is no current item */
+  ListData->Index = NULL;          /* Lists are not indexed until CreateListIndex is called. */
+  ListData->Shared = NULL;         /* Lists are not shared until ShareList is called. */
+
+  /* The pool of LinkNodes starts out empty.  The first slab is allocated when the first item is added to the list. */
+  memset(&(ListData->NodePool), 0, sizeof(LinkNodePool));
+  ListData->NodePool.NextSlabSize = INITIAL_NODES_PER_SLAB;
 
   #ifdef DEBUG
 
@@ -458,6 +709,11 @@ DLIST _System CreateList( void )
 /*           DLISTs.  However, a pointer to a local variable         */
 /*           should not be appended to the DLIST.                    */
 /*                                                                   */
+/*           Items of up to 16 bytes are copied into the record the  */
+/*           list keeps for the item instead of into a block of      */
+/*           memory of their own.  The address of such an item is    */
+/*           only valid while the item is in the list.               */
+/*                                                                   */
 /*           It is assumed that TargetHandle is valid, or is at least*/
 /*           the address of an accessible block of storage.  If      */
 /*           TargetHandle is invalid, or is not the address of an    */
@@ -501,6 +757,10 @@ ADDRESS _System InsertItem ( DLIST           ListToAddTo,
 
   }
 
+  /* A small item is copied into its LinkNode, which saves allocating memory for it separately. */
+  if ( ItemSize <= INLINE_ITEM_SIZE )
+    return Insert_LinkNode(ListToAddTo, ItemSize, ItemLocation, ItemTag, TargetHandle, Insert_Mode, MakeCurrent, TRUE, Error);
+
   /* Allocate memory to hold the item being added to the list. */
 #ifdef USE_POOLMAN
   Buffer = SmartMalloc(ItemSize);
@@ -626,51 +886,113 @@ ADDRESS _System InsertObject ( DLIST           ListToAddTo,
                                CARDINAL32 *    Error)
 {
 
-  /* Since ListToAddTo is of type DLIST, we can not use it without having
-     to type cast it each time.  To avoid all of the type casting, we
-     will declare a local variable of type ControlNode * and then
-     initialize it once using ListToAddTo.  This way we just do the
-     cast once.                                                            */
-
-  ControlNode *      ListData;
+  /* The item is stored at the address given by the caller. */
+  return Insert_LinkNode(ListToAddTo, ItemSize, ItemLocation, ItemTag, TargetHandle, Insert_Mode, MakeCurrent, FALSE, Error);
 
-  LinkNode *         NewNode;         /* Used to create the LinkNode for the new item. */
-  LinkNode *         CurrentNode;     /* Used to hold the reference point for the insertion. */
-  LinkNode *         PreviousNode;    /* Used to point to the item prior to CurrentNode in the list while
-                                         the new item is being inserted. */
-  LinkNode *         NextNode;        /* Used to point to the item after CurrentNode in the list while
-                                         the new item is being inserted.                                   */
+}
 
 
-  /* We will assume that ListToAppendTo points to a valid list.  Given this,
-     we will initialize ListData to point to the ControlNode of this
-     list.                                                              */
-  ListData = (ControlNode *) ListToAddTo;
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  DeleteItem                                      */
+/*                                                                   */
+/*   Descriptive Name:  This function removes the specified item from*/
+/*                      the list and optionally frees the memory     */
+/*                      associated with it.                          */
+/*                                                                   */
+/*   Input:  DLIST       ListToDeleteFrom : The list whose current   */
+/*                                         item is to be deleted.    */
+/*           BOOLEAN    FreeMemory : If TRUE, then the memory        */
+/*                                   associated with the current     */
+/*                                   item will be freed.  If FALSE   */
+/*                                   then the current item will be   */
+/*                                   removed from the list but its   */
+/*                                   memory will not be freed.       */
+/*           ADDRESS Handle : The handle of the item to get.  This   */
+/*                            handle must be of an item which resides*/
+/*                            in ListToDeleteFrom, or NULL.  If      */
+/*                            NULL is used, then the current item    */
+/*                            in ListToDeleteFrom will be deleted.   */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                 the error return code.            */
+/*                                                                   */
+/*   Output:  If the operation is successful, then *Error will be    */
+/*            set to 0.  If the operation fails, then *Error will    */
+/*            contain an error code.                                 */
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToDeleteFrom is  */
+/*                   not a valid list, or if ListToDeleteFrom is     */
+/*                   empty, or if Handle is invalid.                 */
+/*                   If this routine fails, an error code is returned*/
+/*                   in *Error.                                      */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  Items in a list can be accessed in two ways:  A copy of */
+/*           the item can be obtained using GetItem and its related  */
+/*           calls, or a pointer to the item can be obtained using   */
+/*           GetObject and its related calls.  If you have a copy of */
+/*           the data and wish to remove the item from the list, set */
+/*           FreeMemory to TRUE.  This will remove the item from the */
+/*           list and deallocate the memory used to hold it.  If you */
+/*           have a pointer to the item in the list (from one of the */
+/*           GetObject style functions) and wish to remove the item  */
+/*           from the list, set FreeMemory to FALSE.  This removes   */
+/*           the item from the list without freeing its memory, so   */
+/*           that the pointer obtained with the GetObject style      */
+/*           functions is still useable.                             */
+/*                                                                   */
+/*           It is assumed that Error contains a valid address. If   */
+/*           this assumption is violated, an exception or trap       */
+/*           may occur.                                              */
+/*                                                                   */
+/*           It is assumed that Handle is valid, or is at least the  */
+/*           address of an accessible block of storage.  If Handle   */
+/*           is invalid, or is not the address of an accessible block*/
+/*           of storage, then a trap or exception may occur.         */
+/*                                                                   */
+/*           This function does not alter which item is the current  */
+/*           item in the list, unless the handle specified belongs   */
+/*           to the current item in the list, in which case this     */
+/*           function behaves the same as DeleteItem.                */
+/*                                                                   */
+/*********************************************************************/
+void _System DeleteItem (DLIST        ListToDeleteFrom,
+                         BOOLEAN      FreeMemory,
+                         ADDRESS      Handle,
+                         CARDINAL32 * Error)
+{
+  /* Since ListToDeleteFrom is of type DLIST, we can not use it without
+     having to type cast it each time.  To avoid all of the type casting,
+     we will declare a local variable of type ControlNode * and then
+     initialize it once using ListToDeleteFrom.  This way we just do the
+     cast once.                                                            */
 
-  /* Has the user specified a specific item in the list as a reference point for this insertion? */
-  if ( TargetHandle != NULL )
-  {
+  ControlNode *      ListData;
 
-    /* Since the user has specified a reference point for this insertion, set up to use it. */
-    CurrentNode = (LinkNode *) TargetHandle;
+  LinkNode *         CurrentLinkNode;    /* Used to point to the item being deleted. */
+  LinkNode *         NextLinkNode;       /* Used to point to the item immediately after
+                                            the one being deleted so that its fields can
+                                            be updated.                                  */
+  LinkNode *         PreviousLinkNode;   /* Used to point to the item immediately before
+                                            the one being deleted so that its fields can
+                                            be updated.                                  */
 
-  }
-  else
-  {
 
-    /* The user did not specify a reference point, so use the current item in the list as the reference point. */
-    CurrentNode = ListData->CurrentItem;
+  /* We will assume that ListToDeleteFrom points to a valid list.  Given this,
+     we will initialize ListData to point to the ControlNode of this
+     list.                                                                     */
+  ListData = (ControlNode *) ListToDeleteFrom;
 
-  }
 
 #ifdef DEBUG
 
   #ifdef PARANOID
 
-  if ( !CheckListIntegrity(ListToAddTo) )
+  if ( !CheckListIntegrity(ListToDeleteFrom) )
   {
     *Error = DLIST_CORRUPTED;
-    return NULL;
+    return;
   }
 
   #else
@@ -680,242 +1002,159 @@ ADDRESS _System InsertObject ( DLIST           ListToAddTo,
   if ((ListData == NULL) || (ListData->Verify != VerifyValue))
   {
     *Error = DLIST_NOT_INITIALIZED;
-    return NULL;
+    return;
   }
 
   #endif
 
-  /* Since the list is valid, we must now see if the TargetHandle is valid.  We
-     will assume that, if the TargetHandle is not NULL, it points to a LinkNode.
-     If the ControlNodeLocation field of the LinkNode points to the
-     ControlNode for the list we are working with, then the LinkNode is in
-     the list and can therefore be used safely.
+#endif
 
-      At this point, CurrentNode has been set equal to TargetHandle if TargetHandle
-      is not NULL.  If TargetHandle is NULL, then CurrentNode was set to the current
-      item in the list.                                                              .*/
-  if ( TargetHandle != NULL  )
+  /* Check to see if the DLIST is empty. */
+  if (ListData->ItemCount == 0)
   {
+    *Error = DLIST_EMPTY;
+    return;
+  }
 
-    /* Is CurrentNode part of this list? */
-    if ( CurrentNode->ControlNodeLocation != ListData )
-    {
+  /* We must find the link node that corresponds to the handle, if the handle is valid. */
+  CurrentLinkNode = (LinkNode *) Handle;
 
-      /* The handle either did not point to a ControlNode or it pointed to the wrong ControlNode! */
-      *Error = DLIST_BAD_HANDLE;
-      return NULL;
+  /* We will assume that, if the Handle is not NULL, it points to a LinkNode.
+     If the ControlNodeLocation field of the LinkNode points to the
+     ControlNode for ListToDeleteFrom, then the LinkNode is in ListToDeleteFrom
+     and we can proceed to delete the item.                                        */
+  if ( CurrentLinkNode != NULL )
+  {
 
+    /* Does the LinkNode corresponding to the handle point to the ControlNode for this list? */
+    if (CurrentLinkNode->ControlNodeLocation != ListData)
+    {
+      /* The handle did not point to a LinkNode or the LinkNode it pointed to was not
+         in ListToDeleteFrom. */
+      *Error = DLIST_BAD_HANDLE;
+      return;
     }
 
   }
-
-  /* We must check the insertion mode. */
-  if ( Insert_Mode > AppendToList )
+  else
   {
 
-    *Error = DLIST_INVALID_INSERTION_MODE;
-    return NULL;
+    /* Since Handle was NULL, we will use the current item in the list. */
+    CurrentLinkNode = ListData->CurrentItem;
 
   }
 
-  /* Lets check the item being added to the DLIST. */
-  if (ItemLocation == NULL)
-  {
-    *Error = DLIST_BAD_ITEM_POINTER;
-    return NULL;
-  }
+  /* Find the next and previous list nodes in the source list. */
+  PreviousLinkNode = CurrentLinkNode->PreviousLinkNode;
+  NextLinkNode = CurrentLinkNode->NextLinkNode;
 
-  if ( ItemSize == 0)
+  /* Take the current node out of the source list. */
+  if (PreviousLinkNode != NULL)
   {
-    *Error = DLIST_ITEM_SIZE_ZERO;
-    return NULL;
-  }
-
-#endif
+    /* The current item was not the first item in the list. */
 
-  /* Since both the list and item are valid, lets make a LinkNode. */
-#ifdef USE_POOLMAN
-  NewNode = (LinkNode *) AllocateFromPool(ListData->NodePool);
-#else
-  NewNode = (LinkNode *) malloc( sizeof(LinkNode) );
-#endif
+    /* Remove the current item from the list. */
+    PreviousLinkNode->NextLinkNode = NextLinkNode;
 
-  /* Did we get the memory? */
-  if (NewNode == NULL)
-  {
-    *Error = DLIST_OUT_OF_MEMORY;
-    return NULL;
   }
 
-  /* Now that all memory has been allocated, lets finish initializing the LinkNode. */
-  NewNode->DataSize = ItemSize;
-  NewNode->DataLocation = ItemLocation;
-  NewNode->DataTag = ItemTag;
-  NewNode->NextLinkNode = NULL;
-  NewNode->PreviousLinkNode = NULL;
-  NewNode->ControlNodeLocation = ListData;     /* Initialize the link to the control node
-                                                  of the list containing this link node.   */
-
-  /* Now we can add the node to the list. */
-
-  /* Is the list empty?  If so, then the Insertion_Mode does not matter! */
-  if (ListData->CurrentItem == NULL)
-  {
-    /* The List is empty.  This will be the first (and only) item in the list.
-       Also, since this will be the only item in the list, it automatically
-       becomes the current item.                                               */
-    ListData->EndOfList = NewNode;
-    ListData->StartOfList = NewNode;
-    ListData->CurrentItem = NewNode;
-  }
-  else
+  if ( NextLinkNode != NULL )
   {
-    /* The list was not empty.  */
-
-    /* Now lets insert the item according to the specified Insert_Mode. */
-    switch ( Insert_Mode )
-    {
-
-      case InsertAtStart: /* Get the first item in the list. */
-                          CurrentNode = ListData->StartOfList;
-
-                          /* Now insert NewNode before CurrentNode. */
-                          NewNode->NextLinkNode = CurrentNode;
-                          CurrentNode->PreviousLinkNode = NewNode;
-
-                          /* Now update the ControlNode. */
-                          ListData->StartOfList = NewNode;
-
-                          break;
-      case InsertBefore:  /* CurrentNode already points to the Item we are to insert NewNode before. */
-
-                          /* Is CurrentNode the first item in the list? */
-                          if ( ListData->StartOfList != CurrentNode )
-                          {
-
-                            /* Since CurrentNode is not the first item in the list, we need the node prior to CurrentNode
-                               so we can adjust its link fields.                                                           */
-                            PreviousNode = CurrentNode->PreviousLinkNode;
-
-                            /* Now make PreviousLinkNode point to NewNode and vice versa. */
-                            PreviousNode->NextLinkNode = NewNode;
-                            NewNode->PreviousLinkNode = PreviousNode;
-
-                          }
-                          else
-                          {
-
-                            /* Since CurrentNode is the first item in the list, that means that NewNode will be
-                               the first item in the list after it is inserted.  Update the ControlNode for this
-                               list to reflect that NewNode will be the first item in the list.                     */
-                            ListData->StartOfList = NewNode;
-
-                          }
 
-                          /* Now make NewNode point to CurrentNode and vice versa. */
-                          NewNode->NextLinkNode = CurrentNode;
-                          CurrentNode->PreviousLinkNode = NewNode;
-
-                          break;
-      case InsertAfter:   /* CurrentNode already points to the Item we are to insert NewNode after. */
-
-                          /* Is CurrentNode the last item in the list? */
-                          if ( ListData->EndOfList != CurrentNode )
-                          {
-
-                            /* Since CurrentNode is not the last item in the list, we need the node after to CurrentNode
-                               so we can adjust its link fields.                                                           */
-                            NextNode = CurrentNode->NextLinkNode;
+    /* The current item was not the last item in the list. */
+    NextLinkNode->PreviousLinkNode = PreviousLinkNode;
 
-                            /* Now make NextLinkNode point to NewNode and vice versa. */
-                            NextNode->PreviousLinkNode = NewNode;
-                            NewNode->NextLinkNode = NextNode;
+  }
 
-                          }
-                          else
-                          {
+  /* Was the current link node the first item in the list? */
+  if ( ListData->StartOfList == CurrentLinkNode )
+    ListData->StartOfList = NextLinkNode;
 
-                            /* Since CurrentNode is the last item in the list, that means that NewNode will be
-                               the last item in the list after it is inserted.  Update the ControlNode for this
-                               list to reflect that NewNode will be the last item in the list.                     */
-                            ListData->EndOfList = NewNode;
+  /* Was the current link node the last item in the list?*/
+  if ( ListData->EndOfList == CurrentLinkNode )
+    ListData->EndOfList = PreviousLinkNode;
 
-                          }
+  /* Was the node being extracted the current item in the list? */
+  if ( ListData->CurrentItem == CurrentLinkNode )
+  {
 
-                          /* Now make NewNode point to CurrentNode and vice versa. */
-                          CurrentNode->NextLinkNode = NewNode;
-                          NewNode->PreviousLinkNode = CurrentNode;
+    /* The current item in the list will be the item which follows the
+       item we are extracting.  If the item being extracted is the last
+       item in the list, then the current item becomes the item immediately
+       before the item being extracted.  If there are no items before or
+       after the item being extracted, then the list is empty!                */
+    if ( NextLinkNode != NULL )
+      ListData->CurrentItem = NextLinkNode;
+    else
+      if ( PreviousLinkNode != NULL )
+      ListData->CurrentItem = PreviousLinkNode;
+    else
+      ListData->CurrentItem = NULL;
 
-                          break;
-      case AppendToList:  /* Get the last item in the list. */
-                          CurrentNode = ListData->EndOfList;
+  }
 
-                          /* Now insert NewNode after CurrentNode. */
-                          CurrentNode->NextLinkNode = NewNode;
-                          NewNode->PreviousLinkNode = CurrentNode;
+  /* Adjust the count of items in the list. */
+  ListData->ItemCount = ListData->ItemCount - 1;
 
-                          /* Now update the ControlNode. */
-                          ListData->EndOfList = NewNode;
+  if ( CurrentLinkNode->Indexed )
+    Unindex_LinkNode(ListData->Index, CurrentLinkNode);
 
-                          break;
-      default :
-                NewNode->ControlNodeLocation = NULL;
-                free(NewNode->DataLocation);
-                free(NewNode);
-                *Error = DLIST_INVALID_INSERTION_MODE;
-                return NULL;
+  /* If the list is shared, readers may still be looking at the current node, so it can not be freed yet. */
+  if ( ListData->Shared != NULL )
+  {
 
-    }
+    Retire_LinkNode(ListData, CurrentLinkNode, FreeMemory);
 
   }
-
-  /* Adjust the count of the number of items in the list. */
-  ListData->ItemCount++;
-
-  /* Should the new node become the current item in the list? */
-  if ( MakeCurrent )
+  else
   {
 
-    /* Adjust the control node so that NewNode becomes the current item in the list. */
-    ListData->CurrentItem = NewNode;
+    /* Now we must free the memory associated with the current node. */
+    if ( FreeMemory )
+    {
+      /* Free the memory associated with the actual item stored in the list. */
+      Free_Item(CurrentLinkNode);
+    }
+
+    /* Free the memory associated with the control structures used to manage items in the list. */
+    CurrentLinkNode->ControlNodeLocation = NULL;
+#ifdef USE_POOLMAN
+    DeallocateToPool(ListData->NodePool,CurrentLinkNode);    /* Return LinkNode to the Node Pool. */
+#else
+    Release_LinkNode(CurrentLinkNode);
+#endif
 
   }
 
 #ifdef PARANOID
 
-  assert (CheckListIntegrity( ListToAddTo ) );
+  assert (CheckListIntegrity( ListToDeleteFrom ) );
 
 #endif
 
-  /* All done.  Signal successful operation. */
-  *Error = DLIST_SUCCESS;
 
-  return NewNode;
+  /* Signal success. */
+  *Error = DLIST_SUCCESS;
 
 }
 
 
 /*********************************************************************/
 /*                                                                   */
-/*   Function Name:  DeleteItem                                      */
+/*   Function Name:  DeleteAllItems                                  */
 /*                                                                   */
-/*   Descriptive Name:  This function removes the specified item from*/
-/*                      the list and optionally frees the memory     */
-/*                      associated with it.                          */
+/*   Descriptive Name:  This function deletes all of the items in the*/
+/*                      specified list and optionally frees the      */
+/*                      memory associated with each item deleted.    */
 /*                                                                   */
-/*   Input:  DLIST       ListToDeleteFrom : The list whose current   */
-/*                                         item is to be deleted.    */
+/*   Input:  DLIST       ListToDeleteFrom : The list whose items     */
+/*                                          are to be deleted.       */
 /*           BOOLEAN    FreeMemory : If TRUE, then the memory        */
-/*                                   associated with the current     */
-/*                                   item will be freed.  If FALSE   */
-/*                                   then the current item will be   */
+/*                                   associated with each item in the*/
+/*                                   list will be freed.  If FALSE   */
+/*                                   then the each item will be      */
 /*                                   removed from the list but its   */
 /*                                   memory will not be freed.       */
-/*           ADDRESS Handle : The handle of the item to get.  This   */
-/*                            handle must be of an item which resides*/
-/*                            in ListToDeleteFrom, or NULL.  If      */
-/*                            NULL is used, then the current item    */
-/*                            in ListToDeleteFrom will be deleted.   */
 /*           CARDINAL32 * Error : The address of a variable to hold  */
 /*                                 the error return code.            */
 /*                                                                   */
@@ -925,7 +1164,7 @@ ADDRESS _System InsertObject ( DLIST           ListToAddTo,
 /*                                                                   */
 /*   Error Handling: This function will fail if ListToDeleteFrom is  */
 /*                   not a valid list, or if ListToDeleteFrom is     */
-/*                   empty, or if Handle is invalid.                 */
+/*                   empty.                                          */
 /*                   If this routine fails, an error code is returned*/
 /*                   in *Error.                                      */
 /*                                                                   */
@@ -949,43 +1188,28 @@ ADDRESS _System InsertObject ( DLIST           ListToAddTo,
 /*           this assumption is violated, an exception or trap       */
 /*           may occur.                                              */
 /*                                                                   */
-/*           It is assumed that Handle is valid, or is at least the  */
-/*           address of an accessible block of storage.  If Handle   */
-/*           is invalid, or is not the address of an accessible block*/
-/*           of storage, then a trap or exception may occur.         */
-/*                                                                   */
-/*           This function does not alter which item is the current  */
-/*           item in the list, unless the handle specified belongs   */
-/*           to the current item in the list, in which case this     */
-/*           function behaves the same as DeleteItem.                */
-/*                                                                   */
 /*********************************************************************/
-void _System DeleteItem (DLIST        ListToDeleteFrom,
-                         BOOLEAN      FreeMemory,
-                         ADDRESS      Handle,
-                         CARDINAL32 * Error)
+void _System DeleteAllItems (DLIST        ListToDeleteFrom,
+                             BOOLEAN      FreeMemory,
+                             CARDINAL32 * Error)
 {
+
   /* Since ListToDeleteFrom is of type DLIST, we can not use it without
      having to type cast it each time.  To avoid all of the type casting,
      we will declare a local variable of type ControlNode * and then
      initialize it once using ListToDeleteFrom.  This way we just do the
      cast once.                                                            */
-
   ControlNode *      ListData;
 
-  LinkNode *         CurrentLinkNode;    /* Used to point to the item being deleted. */
-  LinkNode *         NextLinkNode;       /* Used to point to the item immediately after
-                                            the one being deleted so that its fields can
-                                            be updated.                                  */
-  LinkNode *         PreviousLinkNode;   /* Used to point to the item immediately before
-                                            the one being deleted so that its fields can
-                                            be updated.                                  */
+
+  LinkNode *         CurrentLinkNode;  /* This is used to walk through the
+                                          linked list of LinkNodes.        */
 
 
   /* We will assume that ListToDeleteFrom points to a valid list.  Given this,
      we will initialize ListData to point to the ControlNode of this
-     list.                                                                     */
-  ListData = (ControlNode *) ListToDeleteFrom;
+     list.                                                                 */
+  ListData = (ControlNode *) (ListToDeleteFrom);
 
 
 #ifdef DEBUG
@@ -1012,243 +1236,35 @@ void _System DeleteItem (DLIST        ListToDeleteFrom,
 
 #endif
 
-  /* Check to see if the DLIST is empty. */
-  if (ListData->ItemCount == 0)
-  {
-    *Error = DLIST_EMPTY;
-    return;
-  }
-
-  /* We must find the link node that corresponds to the handle, if the handle is valid. */
-  CurrentLinkNode = (LinkNode *) Handle;
+  /*--------------------------------------------------
+     To empty a DLIST, we must traverse the linked
+     list of LinkNodes and dispose of each LinkNode,
+     as well as the data item associated with each
+     LinkNode.
+  --------------------------------------------------*/
 
-  /* We will assume that, if the Handle is not NULL, it points to a LinkNode.
-     If the ControlNodeLocation field of the LinkNode points to the
-     ControlNode for ListToDeleteFrom, then the LinkNode is in ListToDeleteFrom
-     and we can proceed to delete the item.                                        */
-  if ( CurrentLinkNode != NULL )
+  /* Loop to dispose of the Listnodes. */
+  while (ListData->ItemCount > 0)
   {
+    CurrentLinkNode = ListData->StartOfList;                /* Get the first DLIST node. */
+    ListData->StartOfList = CurrentLinkNode->NextLinkNode;  /* Remove that DLIST node from the DLIST. */
+    ListData->ItemCount--;                                  /* Decrement the number of items in the list or we will never leave the loop! */
 
-    /* Does the LinkNode corresponding to the handle point to the ControlNode for this list? */
-    if (CurrentLinkNode->ControlNodeLocation != ListData)
+    /* If the list is shared, readers may still be looking at this node, so it can not be freed yet. */
+    if ( ListData->Shared != NULL )
     {
-      /* The handle did not point to a LinkNode or the LinkNode it pointed to was not
-         in ListToDeleteFrom. */
-      *Error = DLIST_BAD_HANDLE;
-      return;
-    }
-
-  }
-  else
-  {
-
-    /* Since Handle was NULL, we will use the current item in the list. */
-    CurrentLinkNode = ListData->CurrentItem;
-
-  }
-
-  /* Find the next and previous list nodes in the source list. */
-  PreviousLinkNode = CurrentLinkNode->PreviousLinkNode;
-  NextLinkNode = CurrentLinkNode->NextLinkNode;
-
-  /* Take the current node out of the source list. */
-  if (PreviousLinkNode != NULL)
-  {
-    /* The current item was not the first item in the list. */
-
-    /* Remove the current item from the list. */
-    PreviousLinkNode->NextLinkNode = NextLinkNode;
-
-  }
-
-  if ( NextLinkNode != NULL )
-  {
-
-    /* The current item was not the last item in the list. */
-    NextLinkNode->PreviousLinkNode = PreviousLinkNode;
-
-  }
-
-  /* Was the current link node the first item in the list? */
-  if ( ListData->StartOfList == CurrentLinkNode )
-    ListData->StartOfList = NextLinkNode;
-
-  /* Was the current link node the last item in the list?*/
-  if ( ListData->EndOfList == CurrentLinkNode )
-    ListData->EndOfList = PreviousLinkNode;
-
-  /* Was the node being extracted the current item in the list? */
-  if ( ListData->CurrentItem == CurrentLinkNode )
-  {
-
-    /* The current item in the list will be the item which follows the
-       item we are extracting.  If the item being extracted is the last
-       item in the list, then the current item becomes the item immediately
-       before the item being extracted.  If there are no items before or
-       after the item being extracted, then the list is empty!                */
-    if ( NextLinkNode != NULL )
-      ListData->CurrentItem = NextLinkNode;
-    else
-      if ( PreviousLinkNode != NULL )
-      ListData->CurrentItem = PreviousLinkNode;
-    else
-      ListData->CurrentItem = NULL;
-
-  }
-
-  /* Adjust the count of items in the list. */
-  ListData->ItemCount = ListData->ItemCount - 1;
-
-  /* Now we must free the memory associated with the current node. */
-  if ( FreeMemory )
-  {
-    /* Free the memory associated with the actual item stored in the list. */
-#ifdef USE_POOLMAN
-    SmartFree(CurrentLinkNode->DataLocation);
-#else
-    free(CurrentLinkNode->DataLocation);
-#endif
-  }
-
-  /* Free the memory associated with the control structures used to manage items in the list. */
-  CurrentLinkNode->ControlNodeLocation = NULL;
-#ifdef USE_POOLMAN
-  DeallocateToPool(ListData->NodePool,CurrentLinkNode);    /* Return LinkNode to the Node Pool. */
-#else
-  free(CurrentLinkNode);
-#endif
-
-#ifdef PARANOID
-
-  assert (CheckListIntegrity( ListToDeleteFrom ) );
-
-#endif
-
-
-  /* Signal success. */
-  *Error = DLIST_SUCCESS;
-
-}
-
-
-/*********************************************************************/
-/*                                                                   */
-/*   Function Name:  DeleteAllItems                                  */
-/*                                                                   */
-/*   Descriptive Name:  This function deletes all of the items in the*/
-/*                      specified list and optionally frees the      */
-/*                      memory associated with each item deleted.    */
-/*                                                                   */
-/*   Input:  DLIST       ListToDeleteFrom : The list whose items     */
-/*                                          are to be deleted.       */
-/*           BOOLEAN    FreeMemory : If TRUE, then the memory        */
-/*                                   associated with each item in the*/
-/*                                   list will be freed.  If FALSE   */
-/*                                   then the each item will be      */
-/*                                   removed from the list but its   */
-/*                                   memory will not be freed.       */
-/*           CARDINAL32 * Error : The address of a variable to hold  */
-/*                                 the error return code.            */
-/*                                                                   */
-/*   Output:  If the operation is successful, then *Error will be    */
-/*            set to 0.  If the operation fails, then *Error will    */
-/*            contain an error code.                                 */
-/*                                                                   */
-/*   Error Handling: This function will fail if ListToDeleteFrom is  */
-/*                   not a valid list, or if ListToDeleteFrom is     */
-/*                   empty.                                          */
-/*                   If this routine fails, an error code is returned*/
-/*                   in *Error.                                      */
-/*                                                                   */
-/*   Side Effects:  None.                                            */
-/*                                                                   */
-/*   Notes:  Items in a list can be accessed in two ways:  A copy of */
-/*           the item can be obtained using GetItem and its related  */
-/*           calls, or a pointer to the item can be obtained using   */
-/*           GetObject and its related calls.  If you have a copy of */
-/*           the data and wish to remove the item from the list, set */
-/*           FreeMemory to TRUE.  This will remove the item from the */
-/*           list and deallocate the memory used to hold it.  If you */
-/*           have a pointer to the item in the list (from one of the */
-/*           GetObject style functions) and wish to remove the item  */
-/*           from the list, set FreeMemory to FALSE.  This removes   */
-/*           the item from the list without freeing its memory, so   */
-/*           that the pointer obtained with the GetObject style      */
-/*           functions is still useable.                             */
-/*                                                                   */
-/*           It is assumed that Error contains a valid address. If   */
-/*           this assumption is violated, an exception or trap       */
-/*           may occur.                                              */
-/*                                                                   */
-/*********************************************************************/
-void _System DeleteAllItems (DLIST        ListToDeleteFrom,
-                             BOOLEAN      FreeMemory,
-                             CARDINAL32 * Error)
-{
-
-  /* Since ListToDeleteFrom is of type DLIST, we can not use it without
-     having to type cast it each time.  To avoid all of the type casting,
-     we will declare a local variable of type ControlNode * and then
-     initialize it once using ListToDeleteFrom.  This way we just do the
-     cast once.                                                            */
-  ControlNode *      ListData;
-
-
-  LinkNode *         CurrentLinkNode;  /* This is used to walk through the
-                                          linked list of LinkNodes.        */
-
-
-  /* We will assume that ListToDeleteFrom points to a valid list.  Given this,
-     we will initialize ListData to point to the ControlNode of this
-     list.                                                                 */
-  ListData = (ControlNode *) (ListToDeleteFrom);
-
-
-#ifdef DEBUG
-
-  #ifdef PARANOID
-
-  if ( !CheckListIntegrity(ListToDeleteFrom) )
-  {
-    *Error = DLIST_CORRUPTED;
-    return;
-  }
-
-  #else
-
-  /* We must now validate the list before we attempt to use it.  We will
-     do this by checking the Verify field in the ControlNode.               */
-  if ((ListData == NULL) || (ListData->Verify != VerifyValue))
-  {
-    *Error = DLIST_NOT_INITIALIZED;
-    return;
-  }
-
-  #endif
 
-#endif
+      /* The index, if any, is emptied below. */
+      CurrentLinkNode->Indexed = FALSE;
+      Retire_LinkNode(ListData, CurrentLinkNode, (BOOLEAN) ( (CurrentLinkNode->DataLocation != NULL) && FreeMemory ) );
+      continue;
 
-  /*--------------------------------------------------
-     To empty a DLIST, we must traverse the linked
-     list of LinkNodes and dispose of each LinkNode,
-     as well as the data item associated with each
-     LinkNode.
-  --------------------------------------------------*/
+    }
 
-  /* Loop to dispose of the Listnodes. */
-  while (ListData->ItemCount > 0)
-  {
-    CurrentLinkNode = ListData->StartOfList;                /* Get the first DLIST node. */
-    ListData->StartOfList = CurrentLinkNode->NextLinkNode;  /* Remove that DLIST node from the DLIST. */
-    ListData->ItemCount--;                                  /* Decrement the number of items in the list or we will never leave the loop! */
     if ( (CurrentLinkNode->DataLocation != NULL) && FreeMemory )
     {
 
-#ifdef USE_POOLMAN
-      SmartFree(CurrentLinkNode->DataLocation);                /* Free the heap memory used to store the data for the DLIST node. */
-#else
-      free(CurrentLinkNode->DataLocation);
-#endif
+      Free_Item(CurrentLinkNode);                             /* Free the heap memory used to store the data for the DLIST node. */
 
     }
 
@@ -1257,7 +1273,12 @@ void _System DeleteAllItems (DLIST        ListToDeleteFrom,
 #ifdef USE_POOLMAN
     DeallocateToPool(ListData->NodePool,CurrentLinkNode);   /* Return LinkNode to the Node Pool. */
 #else
-    free(CurrentLinkNode);
+    /* LinkNodes from the slabs of this list are returned to their slabs all at once by Reclaim_Slabs.  Any others came from the
+       pool of another list and must be released individually.                                                                     */
+    if ( CurrentLinkNode->Slab->Owner == ListData )
+      CurrentLinkNode->Slab->NodesInUse--;
+    else
+      Release_LinkNode(CurrentLinkNode);
 #endif
   }
 
@@ -1265,6 +1286,17 @@ void _System DeleteAllItems (DLIST        ListToDeleteFrom,
   ListData->CurrentItem = NULL;
   ListData->EndOfList = NULL;
 
+  /* Empty the index, if there is one.  The index itself remains in place for the items which will be added next. */
+  if ( ListData->Index != NULL )
+    Clear_Index(ListData->Index);
+
+#ifndef USE_POOLMAN
+
+  /* Rebuild the pool, keeping one empty slab for the items which will be added next. */
+  Reclaim_Slabs(ListData);
+
+#endif
+
 #ifdef PARANOID
 
   assert (CheckListIntegrity( ListToDeleteFrom ) );
@@ -2602,20 +2634,31 @@ void _System ExtractItem( DLIST          ListToGetItemFrom,
   /* Adjust the count of items in the list. */
   ListData->ItemCount = ListData->ItemCount - 1;
 
-  /* Now we must free the memory associated with the current node. */
-#ifdef USE_POOLMAN
-  SmartFree(CurrentLinkNode->DataLocation);
-#else
-  free(CurrentLinkNode->DataLocation);
-#endif
+  if ( CurrentLinkNode->Indexed )
+    Unindex_LinkNode(ListData->Index, CurrentLinkNode);
+
+  /* If the list is shared, readers may still be looking at the current node, so it can not be freed yet. */
+  if ( ListData->Shared != NULL )
+  {
 
-  CurrentLinkNode->ControlNodeLocation = NULL;
+    Retire_LinkNode(ListData, CurrentLinkNode, TRUE);
+
+  }
+  else
+  {
+
+    /* Now we must free the memory associated with the current node. */
+    Free_Item(CurrentLinkNode);
+
+    CurrentLinkNode->ControlNodeLocation = NULL;
 #ifdef USE_POOLMAN
-  DeallocateToPool(ListData->NodePool,CurrentLinkNode);    /* Return LinkNode to the Node Pool. */
+    DeallocateToPool(ListData->NodePool,CurrentLinkNode);    /* Return LinkNode to the Node Pool. */
 #else
-  free(CurrentLinkNode);
+    Release_LinkNode(CurrentLinkNode);
 #endif
 
+  }
+
 #ifdef PARANOID
 
   assert (CheckListIntegrity( ListToGetItemFrom ) );
@@ -2807,8 +2850,14 @@ ADDRESS _System ExtractObject( DLIST          ListToGetItemFrom,
     return NULL;
   }
 
-  /* Since everything checks out, lets store the address of the data so that we can return it later. */
-  DataLocation = CurrentLinkNode->DataLocation;
+  /* Since everything checks out, lets store the address of the data so that we can return it later.  An item kept in the
+     LinkNode itself goes away with the LinkNode, so the caller gets a copy of it instead.                                   */
+  DataLocation = Take_Item(CurrentLinkNode);
+  if ( DataLocation == NULL )
+  {
+    *Error = DLIST_OUT_OF_MEMORY;
+    return NULL;
+  }
 
   /* Now we must remove the current item from the DLIST. */
 
@@ -2865,13 +2914,29 @@ ADDRESS _System ExtractObject( DLIST          ListToGetItemFrom,
   ListData->ItemCount = ListData->ItemCount - 1;
 
   /* Now we must free the memory associated with the current node. */
-  CurrentLinkNode->ControlNodeLocation = NULL;
+  if ( CurrentLinkNode->Indexed )
+    Unindex_LinkNode(ListData->Index, CurrentLinkNode);
+
+  /* If the list is shared, readers may still be looking at the current node, so it can not be freed yet.  The item itself now
+     belongs to the caller.                                                                                                    */
+  if ( ListData->Shared != NULL )
+  {
+
+    Retire_LinkNode(ListData, CurrentLinkNode, FALSE);
+
+  }
+  else
+  {
+
+    CurrentLinkNode->ControlNodeLocation = NULL;
 #ifdef USE_POOLMAN
-  DeallocateToPool(ListData->NodePool,CurrentLinkNode);    /* Return LinkNode to the Node Pool. */
+    DeallocateToPool(ListData->NodePool,CurrentLinkNode);    /* Return LinkNode to the Node Pool. */
 #else
-  free(CurrentLinkNode);
+    Release_LinkNode(CurrentLinkNode);
 #endif
 
+  }
+
 
 #ifdef PARANOID
 
@@ -3020,6 +3085,13 @@ void _System ReplaceItem( DLIST         ListToReplaceItemIn,
 
 #endif
 
+  /* Readers of a shared list could see the address, size and tag of the item change one after another. */
+  if ( ListData->Shared != NULL )
+  {
+    *Error = DLIST_LIST_IS_SHARED;
+    return;
+  }
+
   /* Check to see if the DLIST is empty. */
   if (ListData->ItemCount == 0)
   {
@@ -3048,8 +3120,18 @@ void _System ReplaceItem( DLIST         ListToReplaceItemIn,
   else
     CurrentLinkNode = ListData->CurrentItem;    /* Handle was NULL, so use the current item in the list. */
 
-  /* Since our replacement checks out, we can allocate memory to hold it. */
-  if (ItemSize != CurrentLinkNode->DataSize)
+  /* Since our replacement checks out, we can find a home for it.  If the old item is the same size, its memory is reused so that
+     addresses returned by GetObject stay valid.  Otherwise, a small replacement for an item kept in the LinkNode itself is kept
+     there too.                                                                                                                 */
+  if ( ( ItemSize == CurrentLinkNode->DataSize ) && !ITEM_IS_INLINE(CurrentLinkNode) )
+    NewData = CurrentLinkNode->DataLocation;
+  else
+    if ( ( ItemSize <= INLINE_ITEM_SIZE ) && ITEM_IS_INLINE(CurrentLinkNode) )
+      NewData = CurrentLinkNode->InlineItem.Bytes;
+    else
+      NewData = NULL;
+
+  if ( NewData == NULL )
   {
 #ifdef USE_POOLMAN
     NewData = SmartMalloc(ItemSize);
@@ -3062,21 +3144,15 @@ void _System ReplaceItem( DLIST         ListToReplaceItemIn,
       return;
     }
   }
-  else
-    NewData = CurrentLinkNode->DataLocation;
 
-  /* Now we must copy the replacement data to its new home on the heap. */
+  /* Now we must copy the replacement data to its new home. */
   NotNeeded = (void *) memcpy(NewData,ItemLocation,ItemSize);
 
   /* Now, if we are not reusing the memory occupied by the old item, we can
      dispose of the old item. */
   if (CurrentLinkNode->DataLocation != NewData)
   {
-#ifdef USE_POOLMAN
-    SmartFree(CurrentLinkNode->DataLocation);
-#else
-    free(CurrentLinkNode->DataLocation);
-#endif
+    Free_Item(CurrentLinkNode);
   }
 
   /* Now lets put our replacement into the list. */
@@ -3084,11 +3160,22 @@ void _System ReplaceItem( DLIST         ListToReplaceItemIn,
   CurrentLinkNode->DataTag = ItemTag;
   CurrentLinkNode->DataLocation = NewData;
 
-  /* Did the user want this item to become the current item in the list? */
-  if ( MakeCurrent )
+  /* The key of the item may have changed, so the item must be indexed again. */
+  if ( ListData->Index != NULL )
   {
 
-    /* Make this item the current item in the list. */
+    if ( CurrentLinkNode->Indexed )
+      Unindex_LinkNode(ListData->Index, CurrentLinkNode);
+
+    Index_LinkNode(ListData->Index, CurrentLinkNode);
+
+  }
+
+  /* Did the user want this item to become the current item in the list? */
+  if ( MakeCurrent )
+  {
+
+    /* Make this item the current item in the list. */
     ListData->CurrentItem = CurrentLinkNode;
 
   }
@@ -3248,6 +3335,13 @@ ADDRESS _System ReplaceObject( DLIST         ListToReplaceItemIn,
 
 #endif
 
+  /* Readers of a shared list could see the address, size and tag of the item change one after another. */
+  if ( ListData->Shared != NULL )
+  {
+    *Error = DLIST_LIST_IS_SHARED;
+    return NULL;
+  }
+
   /* Check to see if the DLIST is empty. */
   if (ListData->ItemCount == 0)
   {
@@ -3285,13 +3379,29 @@ ADDRESS _System ReplaceObject( DLIST         ListToReplaceItemIn,
      the caller.                                                              */
   OldItemSize = CurrentLinkNode->DataSize;
   OldItemTag = CurrentLinkNode->DataTag;
-  OldItemLocation = CurrentLinkNode->DataLocation;
+  OldItemLocation = Take_Item(CurrentLinkNode);
+  if ( OldItemLocation == NULL )
+  {
+    *Error = DLIST_OUT_OF_MEMORY;
+    return NULL;
+  }
 
   /* Now lets put our replacement into the list. */
   CurrentLinkNode->DataSize = *ItemSize;
   CurrentLinkNode->DataTag = *ItemTag;
   CurrentLinkNode->DataLocation = ItemLocation;
 
+  /* The key of the item may have changed, so the item must be indexed again. */
+  if ( ListData->Index != NULL )
+  {
+
+    if ( CurrentLinkNode->Indexed )
+      Unindex_LinkNode(ListData->Index, CurrentLinkNode);
+
+    Index_LinkNode(ListData->Index, CurrentLinkNode);
+
+  }
+
   /* Setup return values for user. */
   *ItemSize = OldItemSize;
   *ItemTag = OldItemTag;
@@ -3958,6 +4068,13 @@ void _System DestroyList( DLIST *  ListToDestroy, BOOLEAN FreeItemMemory, CARDIN
   LinkNode *         CurrentLinkNode;  /* This is used to walk through the
                                           linked list of LinkNodes.        */
 
+#ifndef USE_POOLMAN
+
+  LinkNodeSlab *     Slab;             /* Used to walk the slabs in the pool of the list. */
+  LinkNodeSlab *     NextSlab;
+
+#endif
+
 
   /* We will assume that ListToDestroy points to a valid list.  Given this,
      we will initialize ListData to point to the ControlNode of this
@@ -3998,6 +4115,28 @@ void _System DestroyList( DLIST *  ListToDestroy, BOOLEAN FreeItemMemory, CARDIN
      ControlNode.
   --------------------------------------------------*/
 
+  /* A shared list can not have any readers left when it is destroyed, so the LinkNodes it has retired can be freed now. */
+  if ( ListData->Shared != NULL )
+  {
+
+#ifdef USE_POOLMAN
+    Free_Retired_LinkNodes(ListData->NodePool, ListData->Shared->Retiring);
+    Free_Retired_LinkNodes(ListData->NodePool, ListData->Shared->OldestRetired);
+#else
+    Free_Retired_LinkNodes(ListData->Shared->Retiring);
+    Free_Retired_LinkNodes(ListData->Shared->OldestRetired);
+#endif
+    DestroySemaphore(ListData->Shared->Writer_Lock);
+
+#ifdef USE_POOLMAN
+    SmartFree(ListData->Shared);
+#else
+    free(ListData->Shared);
+#endif
+    ListData->Shared = NULL;
+
+  }
+
   /* Loop to dispose of the Listnodes. */
   while (ListData->ItemCount > 0)
   {
@@ -4006,25 +4145,55 @@ void _System DestroyList( DLIST *  ListToDestroy, BOOLEAN FreeItemMemory, CARDIN
     ListData->ItemCount--;                                  /* Decrement the number of items in the list or we will never leave the loop! */
     if ( (CurrentLinkNode->DataLocation != NULL) && FreeItemMemory )
     {
-#ifdef USE_POOLMAN
-      SmartFree(CurrentLinkNode->DataLocation);                /* Free the heap memory used to store the data for the DLIST node. */
-#else
-      free(CurrentLinkNode->DataLocation);
-#endif
+      Free_Item(CurrentLinkNode);                             /* Free the heap memory used to store the data for the DLIST node. */
     }
     CurrentLinkNode->ControlNodeLocation = NULL;
 #ifdef USE_POOLMAN
     DeallocateToPool(ListData->NodePool,CurrentLinkNode);   /* Return LinkNode to the Node Pool. */
 #else
-    free(CurrentLinkNode);
+    /* LinkNodes from the slabs of this list are freed along with their slabs below.  Any others came from the pool of another
+       list and must be released individually.                                                                                  */
+    if ( CurrentLinkNode->Slab->Owner == ListData )
+      CurrentLinkNode->Slab->NodesInUse--;
+    else
+      Release_LinkNode(CurrentLinkNode);
 #endif
   }
 
+  /* Free the index, if there is one. */
+  if ( ListData->Index != NULL )
+    Destroy_Index(ListData->Index);
+
 #ifdef USE_POOLMAN
 
   /* Release the memory associated with the NodePool for list being destroyed. */
   DestroyPool(ListData->NodePool);
 
+#else
+
+  /* Free the slabs in the pool of the list being destroyed.  A slab with LinkNodes still in use by other lists is orphaned
+     instead.  Release_LinkNode will free it when the last of those LinkNodes is released.                                    */
+  Slab = ListData->NodePool.FirstSlab;
+  while ( Slab != NULL )
+  {
+
+    NextSlab = Slab->NextSlab;
+
+    if ( Slab->NodesInUse == 0 )
+      free(Slab);
+    else
+    {
+
+      Slab->Owner = NULL;
+      Slab->NextSlab = NULL;
+      Slab->PreviousSlab = NULL;
+
+    }
+
+    Slab = NextSlab;
+
+  }
+
 #endif
 
 #ifdef DEBUG
@@ -4572,9 +4741,9 @@ void _System GoToSpecifiedItem( DLIST ListToReposition, ADDRESS Handle, CARDINAL
 /*   Function Name:  SortList                                        */
 /*                                                                   */
 /*   Descriptive Name:  This function sorts the contents of a list.  */
-/*                      The sorting algorithm used is a stable sort  */
-/*                      whose performance is not dependent upon the  */
-/*                      initial order of the items in the list.      */
+/*                      The sorting algorithm used is a stable sort. */
+/*                      Lists which are already in order, or nearly  */
+/*                      so, are sorted with very few comparisons.    */
 /*                                                                   */
 /*   Input: DLIST ListToSort : The DLIST that is to be sorted.       */
 /*                                                                   */
@@ -4626,12 +4795,15 @@ void _System GoToSpecifiedItem( DLIST ListToReposition, ADDRESS Handle, CARDINAL
 /*           this assumption is violated, an exception or trap       */
 /*           may occur.                                              */
 /*                                                                   */
-/*           This function works by breaking the list into sublists  */
-/*           and merging the sublists back into one list.  The size  */
-/*           of the sublists starts at 1, and with each pass, the    */
-/*           of the sublists is doubled.  The sort ends when the size*/
-/*           of a sublist is greater than the size of the original   */
-/*           list.                                                   */
+/*           The addresses of the LinkNodes in the list are copied   */
+/*           into an array, which is then sorted with a merge sort.  */
+/*           Runs of SORT_RUN_LENGTH items are sorted with an        */
+/*           insertion sort first, and two runs which are already    */
+/*           in order are not merged at all.  Once the array has     */
+/*           been sorted, the list is relinked in a single pass.     */
+/*           If there is not enough memory for the array, the list   */
+/*           is sorted in place by merging sublists of LinkNodes     */
+/*           instead.                                                */
 /*                                                                   */
 /*********************************************************************/
 void _System SortList(DLIST ListToSort,
@@ -4640,18 +4812,11 @@ void _System SortList(DLIST ListToSort,
 {
   ControlNode *   ListData;
 
-  LinkNode *      NodeToMove;
-
-  LinkNode *      MergeList1;
-  CARDINAL32      MergeList1Size;
-
-  LinkNode *      MergeList2;
-  CARDINAL32      MergeList2Size;
-
-  CARDINAL32      MergeListMaxSize;
-  CARDINAL32      ListSize;
+  LinkNode **     Nodes;         /* The array of LinkNode addresses to sort, followed by the work area used by the merge sort. */
+  LinkNode **     SortedNodes;   /* The part of Nodes holding the sorted LinkNode addresses. */
 
-  INTEGER32       CompareResult;
+  LinkNode *      CurrentLinkNode;
+  CARDINAL32      Index;
 
   /* We will assume that ListToSort points to a valid list.  Given this,
      we will initialize ListData to point to the ControlNode of this
@@ -4683,6 +4848,13 @@ void _System SortList(DLIST ListToSort,
 
 #endif
 
+  /* Readers of a shared list could miss items, or go around in circles, while the items are relinked. */
+  if ( ListData->Shared != NULL )
+  {
+    *Error = DLIST_LIST_IS_SHARED;
+    return;
+  }
+
   /* We will assume success until proven otherwise. */
   *Error = DLIST_SUCCESS;
 
@@ -4690,172 +4862,282 @@ void _System SortList(DLIST ListToSort,
   if ( ListData->ItemCount > 1)
   {
 
-    /* The original list will be repeatedly broken into sublists, which are then
-       merged back into one list.  This process is done two sublists at a time.
-       The two sublists are MergeList1 and MergeList2.  Both sublists are the
-       same size.  The only exception occurs when there are not enough items
-       remaining to create a MergeList2 of the same size as the MergeList1.
-       The size of MergeList1 and MergeList2 starts out at 1, and will be doubled
-       with each iteration of the outer "do" loop below.                            */
-    MergeListMaxSize = 1;
+    /* Allocate room for the addresses of the LinkNodes in the list, plus a work area of the same size for the merge sort. */
+#ifdef USE_POOLMAN
+    Nodes = (LinkNode **) SmartMalloc( 2 * ListData->ItemCount * sizeof(LinkNode *) );
+#else
+    Nodes = (LinkNode **) malloc( 2 * ListData->ItemCount * sizeof(LinkNode *) );
+#endif
 
-    /* This is the outer "do" loop which controls the size of the sublists being
-       merged.  The sublists are merged two at a time, with MergeList1 and
-       MergeList2 representing the two sublists being merged.                     */
-    do
+    if ( Nodes == NULL )
     {
 
-      /* The first sublist will always start with the first element of the
-         list being sorted.                                                  */
-      MergeList1 = ListData->StartOfList;
+      /* Sort the list in place.  This is slower, but needs no memory. */
+      Merge_Sort_LinkNodes(ListData, Compare, NULL, Error);
+
+    }
+    else
+    {
 
-      /* This loop controls the merging of sublists back into one list. */
-      do
+      /* Gather the addresses of the LinkNodes. */
+      Index = 0;
+      for ( CurrentLinkNode = ListData->StartOfList; CurrentLinkNode != NULL; CurrentLinkNode = CurrentLinkNode->NextLinkNode )
       {
 
-        /* The maximum number of items in each of the sublists to be merged
-           is MergeListMaxSize.  As items are merged, they are removed from
-           the sublist they were in and placed in the single list which results
-           from the merging process.                                             */
-        MergeList1Size = MergeListMaxSize;
-        MergeList2Size = MergeListMaxSize;
-
-        /* Find the start of the second list for merging. */
-        ListSize = MergeList1Size;
-        MergeList2 = MergeList1;
-        while ( ( MergeList2 != NULL  ) && (ListSize > 0) )
-        {
+        Nodes[Index] = CurrentLinkNode;
+        Index++;
 
-          MergeList2 = MergeList2->NextLinkNode;
-          ListSize--;
+      }
 
-        }
+      SortedNodes = Sort_LinkNode_Array(Nodes, Nodes + ListData->ItemCount, ListData->ItemCount, Compare, Error);
 
-        /* Now merge the two lists */
-        while ( (MergeList1 != NULL) && (MergeList2 != NULL) &&
-                (MergeList1Size > 0) && (MergeList2Size > 0) )
-        {
+      /* The list itself has not been changed yet, so it is only relinked if the sort succeeded. */
+      if ( *Error == DLIST_SUCCESS )
+        Relink_LinkNodes(ListData, SortedNodes);
 
-          /* Compare the first item in MergeList1 with the first item in MergeList2. */
-          CompareResult = (*Compare)(MergeList1->DataLocation,MergeList1->DataTag,MergeList2->DataLocation,MergeList2->DataTag,Error);
+#ifdef USE_POOLMAN
+      SmartFree(Nodes);
+#else
+      free(Nodes);
+#endif
 
-          /* If there was an error during the comparision, bail out! */
-          if ( *Error != DLIST_SUCCESS )
-          {
+    }
 
-            return;
+  }
 
-          }
+#ifdef PARANOID
 
-          /* See who gets moved. */
-          if ( CompareResult > 0 )
-          {
-            /* Object1 is greater than Object2. */
+  assert (CheckListIntegrity( ListToSort ) );
 
-            /* Object2 must be placed before Object 1. */
-            NodeToMove = MergeList2;
+#endif
 
-            /* Make MergeList2 point to the new start of the second list. */
-            MergeList2 = MergeList2->NextLinkNode;
+}
 
-            /* If NodeToMove was the last item in the list, we must update EndOfList since
-               NodeToMove will no longer be the last item in the list!                           */
-            if ( NodeToMove == ListData->EndOfList )
-            {
-              ListData->EndOfList = NodeToMove->PreviousLinkNode;
-            }
 
-            /* Remove NodeToMove from the list. */
-            if ( NodeToMove->PreviousLinkNode != NULL)
-            {
-              NodeToMove->PreviousLinkNode->NextLinkNode = MergeList2;
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  SortListByKey                                   */
+/*                                                                   */
+/*   Descriptive Name:  This function sorts the contents of a list   */
+/*                      into ascending order by an integer key.      */
+/*                      The sort is stable, so items with the same   */
+/*                      key keep their order relative to each other. */
+/*                                                                   */
+/*   Input: DLIST ListToSort : The DLIST that is to be sorted.       */
+/*          DLIST_Sort_Key_Function GetSortKey : The function which  */
+/*                                  returns the sort key of an item. */
+/*                                  It is normally called once for   */
+/*                                  each item in the list.  If it    */
+/*                                  sets its Error parameter to a    */
+/*                                  non-zero value, the sort is      */
+/*                                  abandoned and that error code is */
+/*                                  returned.                        */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return value.             */
+/*                                                                   */
+/*   Output:  If successful, this function will set *Error to        */
+/*               DLIST_SUCCESS and ListToSort will have been sorted. */
+/*            If unsuccessful, *Error will contain an error code.    */
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToSort is        */
+/*                   invalid or if GetSortKey reports an error.  If  */
+/*                   GetSortKey reports an error, the items in       */
+/*                   ListToSort are normally left in their original  */
+/*                   order.                                          */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  It is assumed that Error contains a valid address. If   */
+/*           this assumption is violated, an exception or trap       */
+/*           may occur.                                              */
+/*                                                                   */
+/*           The keys are sorted with a radix sort, one byte at a    */
+/*           time, so no comparison function is needed.  Passes for  */
+/*           bytes which are the same in every key are skipped, and  */
+/*           a list whose keys are already in order is left alone.   */
+/*           If there is not enough memory to hold the keys, the     */
+/*           list is sorted in place and the keys are obtained again */
+/*           for each comparison.                                    */
+/*                                                                   */
+/*********************************************************************/
+void _System SortListByKey( DLIST                     ListToSort,
+                            DLIST_Sort_Key_Function   GetSortKey,
+                            CARDINAL32 *              Error )
+{
+  ControlNode *   ListData;
 
-              if (MergeList2 != NULL)
-              {
-                MergeList2->PreviousLinkNode = NodeToMove->PreviousLinkNode;
-              }
+  SortKeyRecord * Records;       /* The keys and LinkNode addresses to sort, followed by the work area used by the radix sort. */
+  SortKeyRecord * Source;        /* The records being distributed by the current pass of the radix sort. */
+  SortKeyRecord * Target;        /* The records produced by the current pass of the radix sort. */
+  SortKeyRecord * Swap;
+  LinkNode **     SortedNodes;
 
-            }
+  CARDINAL32      Counts[4][256];  /* The number of keys with each value of each byte of the key. */
+  CARDINAL32      Offsets[256];
+  CARDINAL32      Total;
+  CARDINAL32      Digit;
+  CARDINAL32      Pass;
+  CARDINAL32      Index;
+  BOOLEAN         InOrder;
 
-            /* NodeToMove must go in front of the current item in the first list.  The
-              current item in the first list is given by MergeList1.                          */
-            if (MergeList1->PreviousLinkNode != NULL)
-            {
-              /* Make the item before MergeList1 point to NodeToMove. */
-              MergeList1->PreviousLinkNode->NextLinkNode = NodeToMove;
-            }
+  LinkNode *      CurrentLinkNode;
 
-            /* Make NodeToMove->PreviousLinkNode point to the item before MergeList1. */
-            NodeToMove->PreviousLinkNode = MergeList1->PreviousLinkNode;
+  /* We will assume that ListToSort points to a valid list.  Given this,
+     we will initialize ListData to point to the ControlNode of this
+     list.                                                                 */
+  ListData = (ControlNode *) ListToSort;
 
-            /* Make NodeToMove->NextLinkNode point to MergeList1. */
-            NodeToMove->NextLinkNode = MergeList1;
 
-            /* Complete the process by making MergeList1->PreviousLinkNode point to NodeToMove. */
-            MergeList1->PreviousLinkNode = NodeToMove;
+#ifdef DEBUG
 
-            /* If MergeList1 was the first item in the list, we must update StartOfList since
-              MergeList1 is nolonger the first item in the list!                             */
-            if ( MergeList1 == ListData->StartOfList )
-            {
-              ListData->StartOfList = NodeToMove;
-            }
+  #ifdef PARANOID
 
-            MergeList2Size--;
-          }
-          else
-          {
-            /* Object1 is less than or equal to Object2. */
+  if ( !CheckListIntegrity(ListToSort) )
+  {
+    *Error = DLIST_CORRUPTED;
+    return;
+  }
 
-            /* Remove Object1 from the first list.  To do this, we just need to
-               advance the MergeList1 pointer, since it always points to the
-               first item in the first of the lists which are being merged.      */
-            MergeList1 = MergeList1->NextLinkNode;
-            MergeList1Size--;
-          }
+  #else
 
-        }
+  /* We must now validate the list before we attempt to use it.  We will
+     do this by checking the Verify field in the ControlNode.               */
+  if ((ListData == NULL) || (ListData->Verify != VerifyValue))
+  {
+    *Error = DLIST_NOT_INITIALIZED;
+    return;
+  }
 
-        /* We have left the while loop.  All of the items in one of the merge lists
-           must have been used.  We must now setup MergeList1 to point to the first
-           of the next two lists to be merged.                                      */
-        if ( (MergeList2Size == 0) || (MergeList2 == NULL) )
-        {
+  #endif
 
-          /* MergeList2 is empty.  Either MergeList2 now points to the first
-             item in the next list to be merged, or MergeList2 is NULL.  Thus,
-             MergeList2 points to what MergeList1 should point to.  So make
-             MergeList1 equal to MergeList2.  When we reach the top of the
-             "do" loop, MergeList2 will be set to point to the proper location. */
-          MergeList1 = MergeList2;
+#endif
 
-        }
-        else
-        {
+  /* Readers of a shared list could miss items, or go around in circles, while the items are relinked. */
+  if ( ListData->Shared != NULL )
+  {
+    *Error = DLIST_LIST_IS_SHARED;
+    return;
+  }
 
-          /* The first of the next two lists to be merged starts after the end of the
-             list pointed to by MergeList2.  Thus, we must start MergeList1 at
-             MergeList2 and advance it past the remaining items in MergeList2.        */
-          ListSize = MergeList2Size;
-          MergeList1 = MergeList2;
-          while ( ( MergeList1 != NULL  ) && (ListSize > 0) )
-          {
+  /* We will assume success until proven otherwise. */
+  *Error = DLIST_SUCCESS;
+
+  /* Is the list big enough to sort? */
+  if ( ListData->ItemCount <= 1 )
+    return;
+
+  /* Allocate room for the keys, plus a work area of the same size for the radix sort. */
+#ifdef USE_POOLMAN
+  Records = (SortKeyRecord *) SmartMalloc( 2 * ListData->ItemCount * sizeof(SortKeyRecord) );
+#else
+  Records = (SortKeyRecord *) malloc( 2 * ListData->ItemCount * sizeof(SortKeyRecord) );
+#endif
 
-            MergeList1 = MergeList1->NextLinkNode;
-            ListSize--;
+  if ( Records == NULL )
+  {
 
-          }
+    /* Sort the list in place.  This is slower, but needs no memory. */
+    Merge_Sort_LinkNodes(ListData, NULL, GetSortKey, Error);
 
-        }
+#ifdef PARANOID
+
+    assert (CheckListIntegrity( ListToSort ) );
+
+#endif
+
+    return;
+
+  }
+
+  memset(Counts, 0, sizeof(Counts) );
+
+  /* Get the key of each item, counting the values of each byte of the keys as we go. */
+  InOrder = TRUE;
+  Index = 0;
+  for ( CurrentLinkNode = ListData->StartOfList; CurrentLinkNode != NULL; CurrentLinkNode = CurrentLinkNode->NextLinkNode )
+  {
+
+    Records[Index].Key = (*GetSortKey)(CurrentLinkNode->DataLocation, CurrentLinkNode->DataTag, CurrentLinkNode->DataSize, Error);
+    if ( *Error != DLIST_SUCCESS )
+    {
+
+#ifdef USE_POOLMAN
+      SmartFree(Records);
+#else
+      free(Records);
+#endif
+      return;
+
+    }
+
+    Records[Index].Node = CurrentLinkNode;
+
+    if ( ( Index > 0 ) && ( Records[Index].Key < Records[Index - 1].Key ) )
+      InOrder = FALSE;
+
+    Counts[0][Records[Index].Key & 0xFF]++;
+    Counts[1][( Records[Index].Key >> 8 ) & 0xFF]++;
+    Counts[2][( Records[Index].Key >> 16 ) & 0xFF]++;
+    Counts[3][( Records[Index].Key >> 24 ) & 0xFF]++;
+
+    Index++;
+
+  }
+
+  if ( !InOrder )
+  {
+
+    /* Distribute the records by each byte of the key in turn, starting with the least significant.  Each pass is stable, so
+       the result is ordered by the whole key, and items with equal keys keep their original order.                          */
+    Source = Records;
+    Target = Records + ListData->ItemCount;
+    for ( Pass = 0; Pass < 4; Pass++ )
+    {
+
+      /* If every key has the same value for this byte, this pass would not change anything. */
+      if ( Counts[Pass][( Source[0].Key >> ( Pass * 8 ) ) & 0xFF] == ListData->ItemCount )
+        continue;
 
-      } while (MergeList1 != NULL);
+      Total = 0;
+      for ( Digit = 0; Digit < 256; Digit++ )
+      {
+
+        Offsets[Digit] = Total;
+        Total += Counts[Pass][Digit];
+
+      }
+
+      for ( Index = 0; Index < ListData->ItemCount; Index++ )
+      {
+
+        Digit = ( Source[Index].Key >> ( Pass * 8 ) ) & 0xFF;
+        Target[Offsets[Digit]] = Source[Index];
+        Offsets[Digit]++;
+
+      }
+
+      Swap = Source;
+      Source = Target;
+      Target = Swap;
+
+    }
 
-      MergeListMaxSize = MergeListMaxSize * 2;
+    /* Source holds the sorted records.  The other half of Records is free, and is large enough to hold the addresses of the
+       LinkNodes in their new order.                                                                                          */
+    SortedNodes = (LinkNode **) Target;
+    for ( Index = 0; Index < ListData->ItemCount; Index++ )
+      SortedNodes[Index] = Source[Index].Node;
 
-    } while ( ListData->ItemCount > MergeListMaxSize);
+    Relink_LinkNodes(ListData, SortedNodes);
 
   }
 
+#ifdef USE_POOLMAN
+  SmartFree(Records);
+#else
+  free(Records);
+#endif
+
 #ifdef PARANOID
 
   assert (CheckListIntegrity( ListToSort ) );
@@ -5325,25 +5607,36 @@ void _System PruneList(DLIST        ListToProcess,
       /* Adjust the count of items in the list. */
       ListData->ItemCount = ListData->ItemCount - 1;
 
-      /* Now we must free the memory associated with the current node. */
-      if ( FreeMemory )
+      if ( CurrentLinkNode->Indexed )
+        Unindex_LinkNode(ListData->Index, CurrentLinkNode);
+
+      /* If the list is shared, readers may still be looking at the current node, so it can not be freed yet. */
+      if ( ListData->Shared != NULL )
       {
-        /* Free the memory associated with the actual item stored in the list. */
-#ifdef USE_POOLMAN
-        SmartFree(CurrentLinkNode->DataLocation);
-#else
-        free(CurrentLinkNode->DataLocation);
-#endif
+
+        Retire_LinkNode(ListData, CurrentLinkNode, FreeMemory);
+
       }
+      else
+      {
 
-      /* Free the memory associated with the control structures used to manage items in the list. */
-      CurrentLinkNode->ControlNodeLocation = NULL;
+        /* Now we must free the memory associated with the current node. */
+        if ( FreeMemory )
+        {
+          /* Free the memory associated with the actual item stored in the list. */
+          Free_Item(CurrentLinkNode);
+        }
+
+        /* Free the memory associated with the control structures used to manage items in the list. */
+        CurrentLinkNode->ControlNodeLocation = NULL;
 #ifdef USE_POOLMAN
-      DeallocateToPool(ListData->NodePool,CurrentLinkNode);    /* Return LinkNode to the Node Pool. */
+        DeallocateToPool(ListData->NodePool,CurrentLinkNode);    /* Return LinkNode to the Node Pool. */
 #else
-      free(CurrentLinkNode);
+        Release_LinkNode(CurrentLinkNode);
 #endif
 
+      }
+
       /* Resume our traversal of the tree. */
 
       /* Are we at the start of the list?  If so, then PreviousLinkNode will be
@@ -5461,11 +5754,6 @@ void _System AppendList(DLIST         TargetList,
      cast once.                                                            */
   ControlNode *      SourceListData;
 
-  ControlNode        TempListData;    /* Used to hold the control node for
-                                         list when the control nodes for
-                                         TargetList and SourceList are being
-                                         swapped.                             */
-
   LinkNode *         CurrentLinkNode; /* Used to point to the LinkNode of the
                                          current item  in TargetList while we
                                          access its data.  This limits the
@@ -5517,6 +5805,13 @@ void _System AppendList(DLIST         TargetList,
 
 #endif
 
+  /* Readers of a shared list could follow the items being moved into the other list. */
+  if ( ( TargetListData->Shared != NULL ) || ( SourceListData->Shared != NULL ) )
+  {
+    *Error = DLIST_LIST_IS_SHARED;
+    return;
+  }
+
   /* Assume success. */
   *Error = DLIST_SUCCESS;
 
@@ -5529,15 +5824,25 @@ void _System AppendList(DLIST         TargetList,
 
   }
 
+  /* Get the first item in the source list. */
+  SourceLinkNode = SourceListData->StartOfList;
+
   /* Is the target list currently empty? */
   if (TargetListData->ItemCount == 0)
   {
 
-    /* Since the target list is empty but the source list is not, we will just swap the
-       control record from the source list with the control record of the target list.    */
-    TempListData = *TargetListData;
-    *TargetListData = *SourceListData;
-    *SourceListData = TempListData;
+    /* Since the target list is empty but the source list is not, we will just move the
+       items from the source list to the target list.  The control records themselves are
+       not swapped, since each one holds the pool of LinkNodes for its own list.          */
+    TargetListData->StartOfList = SourceListData->StartOfList;
+    TargetListData->EndOfList = SourceListData->EndOfList;
+    TargetListData->CurrentItem = SourceListData->CurrentItem;
+    TargetListData->ItemCount = SourceListData->ItemCount;
+
+    SourceListData->StartOfList = NULL;
+    SourceListData->EndOfList = NULL;
+    SourceListData->CurrentItem = NULL;
+    SourceListData->ItemCount = 0;
 
     /* Get the first item in the target list. */
     CurrentLinkNode = TargetListData->StartOfList;
@@ -5555,9 +5860,6 @@ void _System AppendList(DLIST         TargetList,
     /* Get the last item in the target list. */
     CurrentLinkNode = TargetListData->EndOfList;
 
-    /* Get the first item in the source list. */
-    SourceLinkNode = SourceListData->StartOfList;
-
     /* Attach the items from the Source List to the end of those from the Target List. */
     CurrentLinkNode->NextLinkNode = SourceLinkNode;
     SourceLinkNode->PreviousLinkNode = CurrentLinkNode;
@@ -5581,13 +5883,32 @@ void _System AppendList(DLIST         TargetList,
     CurrentLinkNode->ControlNodeLocation = TargetListData;
   }
 
+  /* The items moved can no longer be found through the index of the Source List.  If the Target List has an index, add them to it. */
+  if ( SourceListData->Index != NULL )
+    Clear_Index(SourceListData->Index);
 
-#ifdef PARANOID
+  if ( ( SourceListData->Index != NULL ) || ( TargetListData->Index != NULL ) )
+  {
 
-  assert (CheckListIntegrity( SourceList ) );
-  assert (CheckListIntegrity( TargetList ) );
+    for ( CurrentLinkNode = SourceLinkNode; CurrentLinkNode != NULL; CurrentLinkNode = CurrentLinkNode->NextLinkNode )
+    {
 
-#endif
+      if ( TargetListData->Index != NULL )
+        Index_LinkNode(TargetListData->Index, CurrentLinkNode);
+      else
+        CurrentLinkNode->Indexed = FALSE;
+
+    }
+
+  }
+
+
+#ifdef PARANOID
+
+  assert (CheckListIntegrity( SourceList ) );
+  assert (CheckListIntegrity( TargetList ) );
+
+#endif
 
 
   /* All done! */
@@ -5932,6 +6253,13 @@ void _System TransferItem(DLIST             SourceList,
 
 #endif
 
+  /* Readers of a shared list could follow the item being moved into the other list. */
+  if ( ( TargetListData->Shared != NULL ) || ( SourceListData->Shared != NULL ) )
+  {
+    *Error = DLIST_LIST_IS_SHARED;
+    return;
+  }
+
   /* We must check the transfer mode. */
   if ( TransferMode > AppendToList )
   {
@@ -6005,7 +6333,10 @@ void _System TransferItem(DLIST             SourceList,
 
   }
 
-  /* Remove SourceLinkNode from the SourceList. */
+  /* Remove SourceLinkNode from the SourceList, and from its index if it has one. */
+  if ( SourceLinkNode->Indexed )
+    Unindex_LinkNode(SourceListData->Index, SourceLinkNode);
+
   PreviousNode = SourceLinkNode->PreviousLinkNode;
   NextNode = SourceLinkNode->NextLinkNode;
   if ( PreviousNode != NULL )
@@ -6021,7 +6352,7 @@ void _System TransferItem(DLIST             SourceList,
     SourceListData->StartOfList = NextNode;
 
   if ( SourceListData->EndOfList == SourceLinkNode )
-    SourceListData->EndOfList == PreviousNode;
+    SourceListData->EndOfList = PreviousNode;
 
   if ( SourceListData->CurrentItem == SourceLinkNode )
   {
@@ -6162,6 +6493,10 @@ void _System TransferItem(DLIST             SourceList,
   /* Adjust the ControlNodeLocation of SourceLinkNode so that it thinks it is now a member of TargetList. */
   SourceLinkNode->ControlNodeLocation = TargetListData;
 
+  /* If TargetList has an index, add the transferred item to it. */
+  if ( TargetListData->Index != NULL )
+    Index_LinkNode(TargetListData->Index, SourceLinkNode);
+
   /* Should the transferred item become the current item in TargetList? */
   if ( MakeCurrent )
   {
@@ -6186,3 +6521,2846 @@ void _System TransferItem(DLIST             SourceList,
 }
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  CreateListIndex                                 */
+/*                                                                   */
+/*   Descriptive Name: Attaches an index to a DLIST so that items    */
+/*                     can be found by key using FindByKey.          */
+/*                                                                   */
+/*   Input:  DLIST ListToIndex : The list to create an index for.    */
+/*           DLIST_Key_Function GetKey : The function which returns  */
+/*                               the key of an item in the list.     */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, *Error will be set to DLIST_SUCCESS.     */
+/*           If unsuccessful, *Error will be set to a non-zero value.*/
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToIndex is not a */
+/*                   valid list, if GetKey is NULL, or if there is   */
+/*                   not enough memory for the index.  If it fails,  */
+/*                   the list is left as it was.                     */
+/*                                                                   */
+/*   Side Effects: Any items already in the list are indexed.  If    */
+/*                 the list already has an index, it is replaced.    */
+/*                                                                   */
+/*   Notes: It is assumed that Error contains a valid address.       */
+/*                                                                   */
+/*********************************************************************/
+void _System CreateListIndex( DLIST                ListToIndex,
+                              DLIST_Key_Function   GetKey,
+                              CARDINAL32 *         Error )
+{
+
+  ControlNode *      ListData;
+  ListIndex *        NewIndex;
+  LinkNode *         CurrentLinkNode;
+  CARDINAL32         BucketCount;
+
+
+  ListData = (ControlNode *) ListToIndex;
+
+#ifdef DEBUG
+
+  #ifdef PARANOID
+
+  if ( !CheckListIntegrity(ListToIndex) )
+  {
+    *Error = DLIST_CORRUPTED;
+    return;
+  }
+
+  #else
+
+  /* We must now validate the list before we attempt to use it.  We will
+     do this by checking the Verify field in the ControlNode.               */
+  if ((ListData == NULL) || (ListData->Verify != VerifyValue))
+  {
+    *Error = DLIST_NOT_INITIALIZED;
+    return;
+  }
+
+  #endif
+
+#endif
+
+  if ( GetKey == NULL )
+  {
+
+    *Error = DLIST_BAD_ITEM_POINTER;
+    return;
+
+  }
+
+  /* Size the index so that the items already in the list do not cause it to grow right away. */
+  BucketCount = INITIAL_INDEX_BUCKETS;
+  while ( BucketCount < ListData->ItemCount )
+    BucketCount = BucketCount * 2;
+
+#ifdef USE_POOLMAN
+  NewIndex = (ListIndex *) SmartMalloc( sizeof(ListIndex) );
+#else
+  NewIndex = (ListIndex *) malloc( sizeof(ListIndex) );
+#endif
+  if ( NewIndex == NULL )
+  {
+
+    *Error = DLIST_OUT_OF_MEMORY;
+    return;
+
+  }
+
+#ifdef USE_POOLMAN
+  NewIndex->Buckets = (LinkNode **) SmartMalloc( BucketCount * sizeof(LinkNode *) );
+#else
+  NewIndex->Buckets = (LinkNode **) malloc( BucketCount * sizeof(LinkNode *) );
+#endif
+  if ( NewIndex->Buckets == NULL )
+  {
+
+#ifdef USE_POOLMAN
+    SmartFree(NewIndex);
+#else
+    free(NewIndex);
+#endif
+    *Error = DLIST_OUT_OF_MEMORY;
+    return;
+
+  }
+
+  memset(NewIndex->Buckets, 0, BucketCount * sizeof(LinkNode *) );
+  NewIndex->GetKey = GetKey;
+  NewIndex->BucketMask = BucketCount - 1;
+  NewIndex->IndexedCount = 0;
+
+  /* Replace any existing index. */
+  if ( ListData->Index != NULL )
+    Destroy_Index(ListData->Index);
+
+  ListData->Index = NewIndex;
+
+  /* Index the items already in the list. */
+  for ( CurrentLinkNode = ListData->StartOfList; CurrentLinkNode != NULL; CurrentLinkNode = CurrentLinkNode->NextLinkNode )
+    Index_LinkNode(NewIndex, CurrentLinkNode);
+
+  /* Signal success. */
+  *Error = DLIST_SUCCESS;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  DestroyListIndex                                */
+/*                                                                   */
+/*   Descriptive Name: Removes the index from a DLIST.               */
+/*                                                                   */
+/*   Input:  DLIST ListToChange : The list whose index is to be      */
+/*                                removed.                           */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, *Error will be set to DLIST_SUCCESS.     */
+/*           If unsuccessful, *Error will be set to a non-zero value.*/
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToChange is not  */
+/*                   a valid list or if it has no index.             */
+/*                                                                   */
+/*   Side Effects: The memory used by the index is freed.            */
+/*                                                                   */
+/*   Notes: It is assumed that Error contains a valid address.       */
+/*                                                                   */
+/*********************************************************************/
+void _System DestroyListIndex( DLIST ListToChange, CARDINAL32 * Error )
+{
+
+  ControlNode *      ListData;
+  LinkNode *         CurrentLinkNode;
+
+
+  ListData = (ControlNode *) ListToChange;
+
+#ifdef DEBUG
+
+  #ifdef PARANOID
+
+  if ( !CheckListIntegrity(ListToChange) )
+  {
+    *Error = DLIST_CORRUPTED;
+    return;
+  }
+
+  #else
+
+  /* We must now validate the list before we attempt to use it.  We will
+     do this by checking the Verify field in the ControlNode.               */
+  if ((ListData == NULL) || (ListData->Verify != VerifyValue))
+  {
+    *Error = DLIST_NOT_INITIALIZED;
+    return;
+  }
+
+  #endif
+
+#endif
+
+  if ( ListData->Index == NULL )
+  {
+
+    *Error = DLIST_NO_INDEX;
+    return;
+
+  }
+
+  Destroy_Index(ListData->Index);
+  ListData->Index = NULL;
+
+  for ( CurrentLinkNode = ListData->StartOfList; CurrentLinkNode != NULL; CurrentLinkNode = CurrentLinkNode->NextLinkNode )
+    CurrentLinkNode->Indexed = FALSE;
+
+  /* Signal success. */
+  *Error = DLIST_SUCCESS;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  FindByKey                                       */
+/*                                                                   */
+/*   Descriptive Name: Uses the index of a DLIST to find the item    */
+/*                     with the specified key.                       */
+/*                                                                   */
+/*   Input:  DLIST ListToSearch : The list to search.                */
+/*           ADDRESS Key : The address of the key to search for.     */
+/*           CARDINAL32 KeySize : The size of the key, in bytes.     */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If an item with the key is found, the function return   */
+/*              value will be the handle of the item and *Error will */
+/*              be set to DLIST_SUCCESS.                             */
+/*           If no item has the key, the function return value will  */
+/*              be NULL and *Error will be set to DLIST_SUCCESS.     */
+/*           If unsuccessful, the function return value will be NULL */
+/*              and *Error will be set to a non-zero value.          */
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToSearch is not  */
+/*                   a valid list, or with DLIST_NO_INDEX if the     */
+/*                   list has no index.                              */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: The key of each candidate item is obtained again from    */
+/*          the key function and compared byte for byte, so items    */
+/*          whose keys hash to the same value are never confused.    */
+/*                                                                   */
+/*********************************************************************/
+ADDRESS _System FindByKey( DLIST          ListToSearch,
+                           ADDRESS        Key,
+                           CARDINAL32     KeySize,
+                           CARDINAL32 *   Error )
+{
+
+  ControlNode *      ListData;
+  ListIndex *        Index;
+  LinkNode *         CurrentLinkNode;
+  CARDINAL32         KeyHash;
+  ADDRESS            ItemKey;
+  CARDINAL32         ItemKeySize;
+
+
+  ListData = (ControlNode *) ListToSearch;
+
+#ifdef DEBUG
+
+  #ifdef PARANOID
+
+  if ( !CheckListIntegrity(ListToSearch) )
+  {
+    *Error = DLIST_CORRUPTED;
+    return NULL;
+  }
+
+  #else
+
+  /* We must now validate the list before we attempt to use it.  We will
+     do this by checking the Verify field in the ControlNode.               */
+  if ((ListData == NULL) || (ListData->Verify != VerifyValue))
+  {
+    *Error = DLIST_NOT_INITIALIZED;
+    return NULL;
+  }
+
+  #endif
+
+#endif
+
+  Index = ListData->Index;
+  if ( Index == NULL )
+  {
+
+    *Error = DLIST_NO_INDEX;
+    return NULL;
+
+  }
+
+  if ( ( Key == NULL ) || ( KeySize == 0 ) )
+  {
+
+    *Error = DLIST_BAD_ITEM_POINTER;
+    return NULL;
+
+  }
+
+  /* Assume success. */
+  *Error = DLIST_SUCCESS;
+
+  KeyHash = Hash_Key(Key, KeySize);
+
+  for ( CurrentLinkNode = Index->Buckets[KeyHash & Index->BucketMask]; CurrentLinkNode != NULL; CurrentLinkNode = CurrentLinkNode->NextIndexedNode )
+  {
+
+    if ( ( CurrentLinkNode->KeyHash == KeyHash ) &&
+         Index->GetKey(CurrentLinkNode->DataLocation, CurrentLinkNode->DataTag, CurrentLinkNode->DataSize, &ItemKey, &ItemKeySize) &&
+         ( ItemKeySize == KeySize ) &&
+         ( memcmp(ItemKey, Key, KeySize) == 0 )
+       )
+      return (ADDRESS) CurrentLinkNode;
+
+  }
+
+  return NULL;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  ReindexItem                                     */
+/*                                                                   */
+/*   Descriptive Name: Updates the index of a DLIST after the key of */
+/*                     one of its items has been changed in place.   */
+/*                                                                   */
+/*   Input:  DLIST ListToChange : The list containing the item.      */
+/*           ADDRESS Handle : The handle of the item whose key has   */
+/*                            changed.  If NULL, the current item in */
+/*                            the list is used.                      */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, *Error will be set to DLIST_SUCCESS.     */
+/*           If unsuccessful, *Error will be set to a non-zero value.*/
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToChange is not  */
+/*                   a valid list, if it is empty, if Handle does    */
+/*                   not belong to it, or with DLIST_NO_INDEX if the */
+/*                   list has no index.                              */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: It is assumed that Error contains a valid address.       */
+/*                                                                   */
+/*********************************************************************/
+void _System ReindexItem( DLIST          ListToChange,
+                          ADDRESS        Handle,
+                          CARDINAL32 *   Error )
+{
+
+  ControlNode *      ListData;
+  LinkNode *         CurrentLinkNode;
+
+
+  ListData = (ControlNode *) ListToChange;
+
+#ifdef DEBUG
+
+  #ifdef PARANOID
+
+  if ( !CheckListIntegrity(ListToChange) )
+  {
+    *Error = DLIST_CORRUPTED;
+    return;
+  }
+
+  #else
+
+  /* We must now validate the list before we attempt to use it.  We will
+     do this by checking the Verify field in the ControlNode.               */
+  if ((ListData == NULL) || (ListData->Verify != VerifyValue))
+  {
+    *Error = DLIST_NOT_INITIALIZED;
+    return;
+  }
+
+  #endif
+
+#endif
+
+  if ( ListData->Index == NULL )
+  {
+
+    *Error = DLIST_NO_INDEX;
+    return;
+
+  }
+
+  if ( ListData->ItemCount == 0 )
+  {
+
+    *Error = DLIST_EMPTY;
+    return;
+
+  }
+
+  /* Were we given a handle? */
+  if ( Handle != NULL )
+  {
+
+    CurrentLinkNode = (LinkNode *) Handle;
+
+    /* Is the handle valid? */
+    if ( CurrentLinkNode->ControlNodeLocation != ListData )
+    {
+
+      /* The handle is not valid!  Abort! */
+      *Error = DLIST_BAD_HANDLE;
+      return;
+
+    }
+
+  }
+  else
+    CurrentLinkNode = ListData->CurrentItem;
+
+  if ( CurrentLinkNode->Indexed )
+    Unindex_LinkNode(ListData->Index, CurrentLinkNode);
+
+  Index_LinkNode(ListData->Index, CurrentLinkNode);
+
+  /* Signal success. */
+  *Error = DLIST_SUCCESS;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  ShareList                                       */
+/*                                                                   */
+/*   Descriptive Name: Prepares a DLIST to be read by several threads*/
+/*                     while another thread changes it.              */
+/*                                                                   */
+/*   Input:  DLIST ListToShare : The list to be shared.              */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, *Error will be set to DLIST_SUCCESS.     */
+/*           If unsuccessful, *Error will be set to a non-zero value.*/
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToShare is not a */
+/*                   valid list, or with DLIST_OUT_OF_MEMORY if the  */
+/*                   locks for the list can not be created.          */
+/*                                                                   */
+/*   Side Effects: From now on, LinkNodes removed from the list are  */
+/*                 not reused until every reader which might still   */
+/*                 be looking at them has finished.                  */
+/*                                                                   */
+/*   Notes: It is assumed that Error contains a valid address.       */
+/*                                                                   */
+/*          Sharing a list which is already shared does nothing.     */
+/*          This function must not be called while other threads     */
+/*          are using the list.                                      */
+/*                                                                   */
+/*          See the notes for LockList and BeginListRead.            */
+/*                                                                   */
+/*********************************************************************/
+void _System ShareList( DLIST ListToShare, CARDINAL32 * Error )
+{
+
+  ControlNode *      ListData;
+  SharedList *       NewShared;
+
+#ifndef __linux__
+
+  SEMAPHORE          NewReaderLock;
+
+#endif
+
+  ListData = (ControlNode *) ListToShare;
+
+#ifdef DEBUG
+
+  #ifdef PARANOID
+
+  if ( !CheckListIntegrity(ListToShare) )
+  {
+    *Error = DLIST_CORRUPTED;
+    return;
+  }
+
+  #else
+
+  /* We must now validate the list before we attempt to use it.  We will
+     do this by checking the Verify field in the ControlNode.               */
+  if ((ListData == NULL) || (ListData->Verify != VerifyValue))
+  {
+    *Error = DLIST_NOT_INITIALIZED;
+    return;
+  }
+
+  #endif
+
+#endif
+
+  /* Is the list already shared? */
+  if ( ListData->Shared != NULL )
+  {
+
+    *Error = DLIST_SUCCESS;
+    return;
+
+  }
+
+#ifndef __linux__
+
+  /* The readers of all shared lists are tracked together.  Create the lock which protects them if this is the first list shared.
+     Two threads may get here at the same time, so the new lock is only kept if no other thread has stored one in the meantime.
+     The lock is created outside of the critical section, as other threads may be holding the heap when it is entered.         */
+  if ( Reader_Lock == NULL )
+  {
+
+    NewReaderLock = CreateSemaphore();
+    if ( NewReaderLock == NULL )
+    {
+
+      *Error = DLIST_OUT_OF_MEMORY;
+      return;
+
+    }
+
+    DosEnterCritSec();
+
+    if ( Reader_Lock == NULL )
+    {
+
+      Reader_Lock = NewReaderLock;
+      NewReaderLock = NULL;
+
+    }
+
+    DosExitCritSec();
+
+    if ( NewReaderLock != NULL )
+      DestroySemaphore(NewReaderLock);
+
+  }
+
+#endif
+
+#ifdef USE_POOLMAN
+  NewShared = (SharedList *) SmartMalloc( sizeof(SharedList) );
+#else
+  NewShared = (SharedList *) malloc( sizeof(SharedList) );
+#endif
+
+  if ( NewShared == NULL )
+  {
+
+    *Error = DLIST_OUT_OF_MEMORY;
+    return;
+
+  }
+
+  NewShared->Writer_Lock = CreateSemaphore();
+  if ( NewShared->Writer_Lock == NULL )
+  {
+
+#ifdef USE_POOLMAN
+    SmartFree(NewShared);
+#else
+    free(NewShared);
+#endif
+    *Error = DLIST_OUT_OF_MEMORY;
+    return;
+
+  }
+
+  NewShared->Retiring = NULL;
+  NewShared->OldestRetired = NULL;
+  NewShared->NewestRetired = NULL;
+
+  ListData->Shared = NewShared;
+
+  /* Signal success. */
+  *Error = DLIST_SUCCESS;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  LockList                                        */
+/*                                                                   */
+/*   Descriptive Name: Gives the calling thread the right to change a*/
+/*                     shared DLIST.                                 */
+/*                                                                   */
+/*   Input:  DLIST ListToLock : The list to be changed.              */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, *Error will be set to DLIST_SUCCESS.     */
+/*           If unsuccessful, *Error will be set to a non-zero value.*/
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToLock is not a  */
+/*                   valid list, or with DLIST_NOT_SHARED if         */
+/*                   ShareList has not been called for it.           */
+/*                                                                   */
+/*   Side Effects: The calling thread waits until no other thread    */
+/*                 holds the lock on the list.                       */
+/*                                                                   */
+/*   Notes: It is assumed that Error contains a valid address.       */
+/*                                                                   */
+/*          Only one thread at a time may change a shared list, and  */
+/*          it must call LockList before making any changes, and     */
+/*          UnlockList when it is done.  Any of the functions in     */
+/*          this module may be used on the list in between.  The     */
+/*          list must not be changed without holding the lock, even  */
+/*          if only one thread is changing it, as UnlockList is      */
+/*          where LinkNodes removed from the list are freed.         */
+/*                                                                   */
+/*          Readers of a shared list do not take the lock.  A reader */
+/*          will see each item as it was either before or after each */
+/*          change, with the following exceptions:  SortList,        */
+/*          SortListByKey, AppendList and TransferItem move items    */
+/*          from place to place, so a reader active at the time may  */
+/*          see some items twice or miss some items altogether.      */
+/*          ReplaceItem and ReplaceObject change the address, size   */
+/*          and tag of an item one after another, so a reader may    */
+/*          see a mix of the old and new values.                     */
+/*                                                                   */
+/*          An item must not be moved from a shared list to a list   */
+/*          which is not shared while there may be readers, and an   */
+/*          item taken out of a shared list by ExtractObject or      */
+/*          ReplaceObject must not be freed until every reader       */
+/*          active at the time has finished.  Items should not be    */
+/*          moved between lists which belong to different threads.   */
+/*                                                                   */
+/*********************************************************************/
+void _System LockList( DLIST ListToLock, CARDINAL32 * Error )
+{
+
+  ControlNode *      ListData;
+
+
+  ListData = (ControlNode *) ListToLock;
+
+#ifdef DEBUG
+
+  /* The list is not checked with CheckListIntegrity here, as another thread may be changing it. */
+  if ((ListData == NULL) || (ListData->Verify != VerifyValue))
+  {
+    *Error = DLIST_NOT_INITIALIZED;
+    return;
+  }
+
+#endif
+
+  if ( ListData->Shared == NULL )
+  {
+
+    *Error = DLIST_NOT_SHARED;
+    return;
+
+  }
+
+  Lock(ListData->Shared->Writer_Lock);
+
+  /* Signal success. */
+  *Error = DLIST_SUCCESS;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  UnlockList                                      */
+/*                                                                   */
+/*   Descriptive Name: Ends a set of changes to a shared DLIST and   */
+/*                     frees those LinkNodes removed from the list   */
+/*                     which are no longer in use by any reader.     */
+/*                                                                   */
+/*   Input:  DLIST ListToUnlock : The list which was changed.        */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, *Error will be set to DLIST_SUCCESS.     */
+/*           If unsuccessful, *Error will be set to a non-zero value.*/
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToUnlock is not  */
+/*                   a valid list, or with DLIST_NOT_SHARED if it is */
+/*                   not a shared list.                              */
+/*                                                                   */
+/*   Side Effects: The current epoch is advanced if any LinkNodes    */
+/*                 were removed from the list since it was locked.   */
+/*                 Items removed from the list by DeleteItem,        */
+/*                 DeleteAllItems, PruneList, ExtractItem and        */
+/*                 ReplaceItem are freed along with their LinkNodes. */
+/*                                                                   */
+/*   Notes: It is assumed that Error contains a valid address, and   */
+/*          that the calling thread holds the lock on the list.      */
+/*                                                                   */
+/*          A LinkNode removed while a reader was active is kept     */
+/*          until a later call to UnlockList finds that reader has   */
+/*          finished, so readers should not remain active for long.  */
+/*                                                                   */
+/*********************************************************************/
+void _System UnlockList( DLIST ListToUnlock, CARDINAL32 * Error )
+{
+
+  ControlNode *      ListData;
+  SharedList *       Shared;
+  LinkNode *         CurrentLinkNode;
+  LinkNode *         FreeChain;        /* The retired LinkNodes which can now be freed. */
+  LinkNode *         LastToFree;
+  CARDINAL32         Oldest_Reader;    /* The epoch of the oldest active reader, or the current epoch if there are none. */
+  CARDINAL32         Slot;
+
+
+  ListData = (ControlNode *) ListToUnlock;
+
+#ifdef DEBUG
+
+  #ifdef PARANOID
+
+  if ( !CheckListIntegrity(ListToUnlock) )
+  {
+    *Error = DLIST_CORRUPTED;
+    return;
+  }
+
+  #else
+
+  /* We must now validate the list before we attempt to use it.  We will
+     do this by checking the Verify field in the ControlNode.               */
+  if ((ListData == NULL) || (ListData->Verify != VerifyValue))
+  {
+    *Error = DLIST_NOT_INITIALIZED;
+    return;
+  }
+
+  #endif
+
+#endif
+
+  Shared = ListData->Shared;
+  if ( Shared == NULL )
+  {
+
+    *Error = DLIST_NOT_SHARED;
+    return;
+
+  }
+
+  Lock(Reader_Lock);
+
+  /* Stamp the LinkNodes retired since the list was locked with the current epoch, and move them to the end of the Retired chain.
+     Any reader which begins from now on can not reach them.                                                                      */
+  if ( Shared->Retiring != NULL )
+  {
+
+    CurrentLinkNode = Shared->Retiring;
+    for (;;)
+    {
+
+      CurrentLinkNode->KeyHash = Current_Epoch;
+      if ( CurrentLinkNode->NextIndexedNode == NULL )
+        break;
+
+      CurrentLinkNode = CurrentLinkNode->NextIndexedNode;
+
+    }
+
+    if ( Shared->NewestRetired != NULL )
+      Shared->NewestRetired->NextIndexedNode = Shared->Retiring;
+    else
+      Shared->OldestRetired = Shared->Retiring;
+
+    Shared->NewestRetired = CurrentLinkNode;
+    Shared->Retiring = NULL;
+
+    /* Advance the epoch, skipping 0, which marks an unused reader slot. */
+    Current_Epoch++;
+    if ( Current_Epoch == 0 )
+      Current_Epoch = 1;
+
+  }
+
+  /* Find the oldest active reader.  Epochs are compared by their difference so that the comparison still works after the epoch wraps. */
+  Oldest_Reader = Current_Epoch;
+  for ( Slot = 0; Slot < MAXIMUM_LIST_READERS; Slot++ )
+  {
+
+    if ( ( Reader_Epochs[Slot] != 0 ) && ( (INTEGER32) ( Reader_Epochs[Slot] - Oldest_Reader ) < 0 ) )
+      Oldest_Reader = Reader_Epochs[Slot];
+
+  }
+
+  Unlock(Reader_Lock);
+
+  /* A LinkNode stamped with an epoch older than that of the oldest active reader was retired before any active reader began, so
+     no reader can reach it.  The Retired chain is in the order the LinkNodes were stamped, so they are all at its start.         */
+  FreeChain = Shared->OldestRetired;
+  LastToFree = NULL;
+  for ( CurrentLinkNode = Shared->OldestRetired;
+        ( CurrentLinkNode != NULL ) && ( (INTEGER32) ( CurrentLinkNode->KeyHash - Oldest_Reader ) < 0 );
+        CurrentLinkNode = CurrentLinkNode->NextIndexedNode )
+    LastToFree = CurrentLinkNode;
+
+  if ( LastToFree != NULL )
+  {
+
+    Shared->OldestRetired = LastToFree->NextIndexedNode;
+    if ( Shared->OldestRetired == NULL )
+      Shared->NewestRetired = NULL;
+
+    LastToFree->NextIndexedNode = NULL;
+#ifdef USE_POOLMAN
+    Free_Retired_LinkNodes(ListData->NodePool, FreeChain);
+#else
+    Free_Retired_LinkNodes(FreeChain);
+#endif
+
+  }
+
+  Unlock(Shared->Writer_Lock);
+
+  /* Signal success. */
+  *Error = DLIST_SUCCESS;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  BeginListRead                                   */
+/*                                                                   */
+/*   Descriptive Name: Starts a walk through a shared DLIST by a     */
+/*                     thread which does not hold the lock on it.    */
+/*                                                                   */
+/*   Input:  DLIST ListToRead : The list to be read.                 */
+/*           DLIST_Reader * Reader : The cursor to use for the walk. */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, *Reader will be set up to return the     */
+/*           first item in the list, and *Error will be set to       */
+/*           DLIST_SUCCESS.                                          */
+/*           If unsuccessful, *Error will be set to a non-zero value.*/
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToRead is not a  */
+/*                   valid list, with DLIST_NOT_SHARED if it is not  */
+/*                   a shared list, or with DLIST_TOO_MANY_READERS if*/
+/*                   64 readers are already active.                  */
+/*                                                                   */
+/*   Side Effects: LinkNodes removed from any shared list from now   */
+/*                 on will not be freed until EndListRead is called  */
+/*                 for Reader.                                       */
+/*                                                                   */
+/*   Notes: It is assumed that Error and Reader contain valid        */
+/*          addresses.                                               */
+/*                                                                   */
+/*          Each thread uses its own DLIST_Reader, and any number of */
+/*          threads may read the same list at once.  Readers never   */
+/*          change the list, and do not use or change its current    */
+/*          item.  The items returned by ReadNextObject remain valid */
+/*          until EndListRead is called, even if they are removed    */
+/*          from the list in the meantime.                           */
+/*                                                                   */
+/*********************************************************************/
+void _System BeginListRead( DLIST ListToRead, DLIST_Reader * Reader, CARDINAL32 * Error )
+{
+
+  ControlNode *      ListData;
+  CARDINAL32         Slot;
+
+
+  ListData = (ControlNode *) ListToRead;
+
+#ifdef DEBUG
+
+  /* The list is not checked with CheckListIntegrity here, as another thread may be changing it. */
+  if ((ListData == NULL) || (ListData->Verify != VerifyValue))
+  {
+    *Error = DLIST_NOT_INITIALIZED;
+    return;
+  }
+
+#endif
+
+  if ( ListData->Shared == NULL )
+  {
+
+    *Error = DLIST_NOT_SHARED;
+    return;
+
+  }
+
+  /* Claim a slot for this reader, and record the epoch in which it began. */
+  Lock(Reader_Lock);
+
+  for ( Slot = 0; Slot < MAXIMUM_LIST_READERS; Slot++ )
+  {
+
+    if ( Reader_Epochs[Slot] == 0 )
+    {
+
+      Reader_Epochs[Slot] = Current_Epoch;
+      break;
+
+    }
+
+  }
+
+  Unlock(Reader_Lock);
+
+  if ( Slot == MAXIMUM_LIST_READERS )
+  {
+
+    *Error = DLIST_TOO_MANY_READERS;
+    return;
+
+  }
+
+  Reader->List = ListToRead;
+  Reader->Position = NULL;
+  Reader->Slot = Slot;
+
+  /* Signal success. */
+  *Error = DLIST_SUCCESS;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  ReadNextObject                                  */
+/*                                                                   */
+/*   Descriptive Name: Returns the next item in a shared DLIST to a  */
+/*                     reader.                                       */
+/*                                                                   */
+/*   Input:  DLIST_Reader * Reader : The cursor set up by            */
+/*                                   BeginListRead.                  */
+/*           CARDINAL32 * ObjectSize : The address of a variable to  */
+/*                                     hold the size of the item.    */
+/*           TAG * ObjectTag : The address of a variable to hold the */
+/*                             tag of the item.                      */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, the function return value will be the    */
+/*           address of the item, *ObjectSize and *ObjectTag will be */
+/*           set to its size and tag, and *Error will be set to      */
+/*           DLIST_SUCCESS.                                          */
+/*           If there are no more items in the list, the function    */
+/*           return value will be NULL, and *Error will be set to    */
+/*           DLIST_END_OF_LIST.                                      */
+/*                                                                   */
+/*   Error Handling: This function will fail if the list being read  */
+/*                   is not a valid list.                            */
+/*                                                                   */
+/*   Side Effects: Reader is advanced to the item returned.          */
+/*                                                                   */
+/*   Notes: It is assumed that Error, ObjectSize and ObjectTag       */
+/*          contain valid addresses.                                 */
+/*                                                                   */
+/*          The first call after BeginListRead returns the first item*/
+/*          in the list.  Once the end of the list has been reached, */
+/*          further calls return any items added to the end of the   */
+/*          list since.  If the item Reader is positioned on is      */
+/*          removed from the list, the walk continues with the item  */
+/*          which followed it at the time.                           */
+/*                                                                   */
+/*********************************************************************/
+ADDRESS _System ReadNextObject( DLIST_Reader *  Reader,
+                                CARDINAL32 *    ObjectSize,
+                                TAG *           ObjectTag,
+                                CARDINAL32 *    Error )
+{
+
+  ControlNode *      ListData;
+  LinkNode *         NextLinkNode;
+
+
+  ListData = (ControlNode *) Reader->List;
+
+#ifdef DEBUG
+
+  if ((ListData == NULL) || (ListData->Verify != VerifyValue))
+  {
+    *Error = DLIST_NOT_INITIALIZED;
+    return NULL;
+  }
+
+#endif
+
+  /* The links are read through volatile pointers so that the compiler fetches them again on every call.  A writer fills in a
+     LinkNode completely before linking it into the list, so any LinkNode found this way is ready to use.                     */
+  if ( Reader->Position == NULL )
+    NextLinkNode = *( (LinkNode * volatile *) &(ListData->StartOfList) );
+  else
+    NextLinkNode = *( (LinkNode * volatile *) &( ( (LinkNode *) Reader->Position )->NextLinkNode ) );
+
+  if ( NextLinkNode == NULL )
+  {
+
+    *Error = DLIST_END_OF_LIST;
+    return NULL;
+
+  }
+
+  Reader->Position = NextLinkNode;
+
+  *ObjectSize = NextLinkNode->DataSize;
+  *ObjectTag = NextLinkNode->DataTag;
+
+  /* Signal success. */
+  *Error = DLIST_SUCCESS;
+
+  return NextLinkNode->DataLocation;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  EndListRead                                     */
+/*                                                                   */
+/*   Descriptive Name: Ends a walk through a shared DLIST.           */
+/*                                                                   */
+/*   Input:  DLIST_Reader * Reader : The cursor set up by            */
+/*                                   BeginListRead.                  */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, *Error will be set to DLIST_SUCCESS.     */
+/*           If unsuccessful, *Error will be set to a non-zero value.*/
+/*                                                                   */
+/*   Error Handling: This function will fail if Reader was not set up*/
+/*                   by BeginListRead.                               */
+/*                                                                   */
+/*   Side Effects: The items returned to Reader may be freed once the*/
+/*                 writer of the list calls UnlockList.              */
+/*                                                                   */
+/*   Notes: It is assumed that Error and Reader contain valid        */
+/*          addresses.                                               */
+/*                                                                   */
+/*********************************************************************/
+void _System EndListRead( DLIST_Reader * Reader, CARDINAL32 * Error )
+{
+
+  if ( ( Reader->List == NULL ) || ( Reader->Slot >= MAXIMUM_LIST_READERS ) )
+  {
+
+    *Error = DLIST_BAD;
+    return;
+
+  }
+
+  Lock(Reader_Lock);
+  Reader_Epochs[Reader->Slot] = 0;
+  Unlock(Reader_Lock);
+
+  /* Make sure that Reader is not used again by mistake. */
+  Reader->List = NULL;
+  Reader->Position = NULL;
+
+  /* Signal success. */
+  *Error = DLIST_SUCCESS;
+
+}
+
+
+
+#ifndef USE_POOLMAN
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  GetListPoolStatistics                           */
+/*                                                                   */
+/*   Descriptive Name: Returns the counters kept for the pool of     */
+/*                     link nodes belonging to a DLIST.              */
+/*                                                                   */
+/*   Input:  DLIST ListToCheck : The list whose pool is to be        */
+/*                               reported on.                        */
+/*           DLIST_Pool_Statistics * Statistics : The location of a  */
+/*                               buffer to hold the counters.        */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: If successful, *Statistics will be filled in and *Error */
+/*              will be set to DLIST_SUCCESS.                        */
+/*           If unsuccessful, *Error will be set to a non-zero value.*/
+/*                                                                   */
+/*   Error Handling: This function will fail if ListToCheck is not a */
+/*                   valid list or if Statistics is NULL.            */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: It is assumed that Error contains a valid address.       */
+/*                                                                   */
+/*********************************************************************/
+void _System GetListPoolStatistics( DLIST                    ListToCheck,
+                                    DLIST_Pool_Statistics *  Statistics,
+                                    CARDINAL32 *             Error )
+{
+
+  ControlNode *      ListData;
+
+
+  ListData = (ControlNode *) ListToCheck;
+
+#ifdef DEBUG
+
+  #ifdef PARANOID
+
+  if ( !CheckListIntegrity(ListToCheck) )
+  {
+    *Error = DLIST_CORRUPTED;
+    return;
+  }
+
+  #else
+
+  /* We must now validate the list before we attempt to use it.  We will
+     do this by checking the Verify field in the ControlNode.               */
+  if ((ListData == NULL) || (ListData->Verify != VerifyValue))
+  {
+    *Error = DLIST_NOT_INITIALIZED;
+    return;
+  }
+
+  #endif
+
+#endif
+
+  if ( Statistics == NULL )
+  {
+
+    *Error = DLIST_BAD_ITEM_POINTER;
+    return;
+
+  }
+
+  *Statistics = ListData->NodePool.Statistics;
+
+  /* Signal success. */
+  *Error = DLIST_SUCCESS;
+
+}
+
+
+
+/*--------------------------------------------------
+ * Private Functions Available
+ --------------------------------------------------*/
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  Add_Slab                                        */
+/*                                                                   */
+/*   Descriptive Name: Places a slab at the front or the back of a   */
+/*                     pool.                                         */
+/*                                                                   */
+/*   Input:  LinkNodePool * Pool : The pool to add the slab to.      */
+/*           LinkNodeSlab * Slab : The slab to add.                  */
+/*           BOOLEAN AtFront : TRUE to put the slab at the front of  */
+/*                             the pool, FALSE to put it at the back.*/
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: Slab must not already be in a pool.                      */
+/*                                                                   */
+/*********************************************************************/
+static void Add_Slab( LinkNodePool * Pool, LinkNodeSlab * Slab, BOOLEAN AtFront )
+{
+
+  if ( AtFront )
+  {
+
+    Slab->PreviousSlab = NULL;
+    Slab->NextSlab = Pool->FirstSlab;
+
+    if ( Pool->FirstSlab != NULL )
+      Pool->FirstSlab->PreviousSlab = Slab;
+    else
+      Pool->LastSlab = Slab;
+
+    Pool->FirstSlab = Slab;
+
+  }
+  else
+  {
+
+    Slab->NextSlab = NULL;
+    Slab->PreviousSlab = Pool->LastSlab;
+
+    if ( Pool->LastSlab != NULL )
+      Pool->LastSlab->NextSlab = Slab;
+    else
+      Pool->FirstSlab = Slab;
+
+    Pool->LastSlab = Slab;
+
+  }
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  Remove_Slab                                     */
+/*                                                                   */
+/*   Descriptive Name: Removes a slab from a pool.                   */
+/*                                                                   */
+/*   Input:  LinkNodePool * Pool : The pool containing the slab.     */
+/*           LinkNodeSlab * Slab : The slab to remove.               */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: The slab is not freed.                                   */
+/*                                                                   */
+/*********************************************************************/
+static void Remove_Slab( LinkNodePool * Pool, LinkNodeSlab * Slab )
+{
+
+  if ( Slab->PreviousSlab != NULL )
+    Slab->PreviousSlab->NextSlab = Slab->NextSlab;
+  else
+    Pool->FirstSlab = Slab->NextSlab;
+
+  if ( Slab->NextSlab != NULL )
+    Slab->NextSlab->PreviousSlab = Slab->PreviousSlab;
+  else
+    Pool->LastSlab = Slab->PreviousSlab;
+
+  Slab->NextSlab = NULL;
+  Slab->PreviousSlab = NULL;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  Allocate_LinkNode                               */
+/*                                                                   */
+/*   Descriptive Name: Takes an unused LinkNode from the pool of a   */
+/*                     list, adding a slab to the pool if needed.    */
+/*                                                                   */
+/*   Input:  ControlNode * ListData : The list which needs the       */
+/*                                    LinkNode.                      */
+/*                                                                   */
+/*   Output: The LinkNode, or NULL if there was not enough memory.   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: Memory may be allocated for a new slab.           */
+/*                                                                   */
+/*   Notes: Only the Slab field of the LinkNode is initialized.      */
+/*                                                                   */
+/*********************************************************************/
+static LinkNode * Allocate_LinkNode( ControlNode * ListData )
+{
+
+  LinkNodePool *  Pool = &(ListData->NodePool);
+  LinkNodeSlab *  Slab;
+  LinkNode *      Nodes;                /* Used to access the LinkNodes in a new slab. */
+  LinkNode *      Node;
+  CARDINAL32      Index;
+
+  /* Slabs with unused LinkNodes are kept at the front of the pool, so if the first slab is full, they all are. */
+  Slab = Pool->FirstSlab;
+  if ( ( Slab == NULL ) || ( Slab->FreeNodes == NULL ) )
+  {
+
+    Slab = (LinkNodeSlab *) malloc( sizeof(LinkNodeSlab) + ( Pool->NextSlabSize - 1 ) * sizeof(LinkNode) );
+    if ( Slab == NULL )
+      return NULL;
+
+    Slab->Owner = ListData;
+    Slab->NodeCount = Pool->NextSlabSize;
+    Slab->NodesInUse = 0;
+
+    /* Chain the LinkNodes of the new slab together. */
+    Nodes = Slab->Nodes;
+    for ( Index = 0; Index < Slab->NodeCount; Index++ )
+    {
+
+      Nodes[Index].Slab = Slab;
+      Nodes[Index].ControlNodeLocation = NULL;
+      Nodes[Index].NextLinkNode = &(Nodes[Index + 1]);
+
+    }
+
+    Nodes[Slab->NodeCount - 1].NextLinkNode = NULL;
+    Slab->FreeNodes = Nodes;
+
+    Add_Slab(Pool, Slab, TRUE);
+
+    Pool->Statistics.Slab_Count++;
+    Pool->Statistics.Node_Count += Slab->NodeCount;
+    Pool->Statistics.Slabs_Allocated++;
+
+    if ( Pool->NextSlabSize < MAXIMUM_NODES_PER_SLAB )
+      Pool->NextSlabSize = Pool->NextSlabSize * 2;
+
+  }
+
+  Node = Slab->FreeNodes;
+  Slab->FreeNodes = Node->NextLinkNode;
+  Slab->NodesInUse++;
+
+  Pool->Statistics.Nodes_In_Use++;
+  Pool->Statistics.Node_Allocations++;
+  if ( Pool->Statistics.Nodes_In_Use > Pool->Statistics.Peak_Nodes_In_Use )
+    Pool->Statistics.Peak_Nodes_In_Use = Pool->Statistics.Nodes_In_Use;
+
+  /* If the slab is now full, move it behind the slabs which still have unused LinkNodes. */
+  if ( ( Slab->FreeNodes == NULL ) && ( Slab != Pool->LastSlab ) )
+  {
+
+    Remove_Slab(Pool, Slab);
+    Add_Slab(Pool, Slab, FALSE);
+
+  }
+
+  return Node;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  Release_LinkNode                                */
+/*                                                                   */
+/*   Descriptive Name: Returns a LinkNode to the slab it was         */
+/*                     allocated from.                               */
+/*                                                                   */
+/*   Input:  LinkNode * Node : The LinkNode to release.              */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: The slab is freed if none of its LinkNodes are in */
+/*                 use, unless it is the first slab in its pool.     */
+/*                                                                   */
+/*   Notes: The slab may belong to the pool of a list other than the */
+/*          one Node was last in, or to no pool at all.              */
+/*                                                                   */
+/*********************************************************************/
+static void Release_LinkNode( LinkNode * Node )
+{
+
+  LinkNodeSlab *  Slab = Node->Slab;
+  LinkNodePool *  Pool;
+
+  Node->ControlNodeLocation = NULL;
+  Slab->NodesInUse--;
+
+  /* An orphaned slab is not part of any pool.  It is freed once all of its LinkNodes have been released. */
+  if ( Slab->Owner == NULL )
+  {
+
+    if ( Slab->NodesInUse == 0 )
+      free(Slab);
+
+    return;
+
+  }
+
+  Pool = &(Slab->Owner->NodePool);
+  Pool->Statistics.Nodes_In_Use--;
+
+  /* Free the slab if it is empty, unless it is the first slab in the pool.  Keeping the first slab avoids freeing and allocating
+     a slab over and over when a list repeatedly grows and shrinks across the end of a slab.                                       */
+  if ( ( Slab->NodesInUse == 0 ) && ( Slab != Pool->FirstSlab ) )
+  {
+
+    Remove_Slab(Pool, Slab);
+
+    Pool->Statistics.Slab_Count--;
+    Pool->Statistics.Node_Count -= Slab->NodeCount;
+    Pool->Statistics.Slabs_Freed++;
+
+    free(Slab);
+
+    return;
+
+  }
+
+  /* If the slab was full, move it to the front of the pool so that its LinkNodes will be used again. */
+  if ( ( Slab->FreeNodes == NULL ) && ( Slab != Pool->FirstSlab ) )
+  {
+
+    Remove_Slab(Pool, Slab);
+    Add_Slab(Pool, Slab, TRUE);
+
+  }
+
+  Node->NextLinkNode = Slab->FreeNodes;
+  Slab->FreeNodes = Node;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  Reclaim_Slabs                                   */
+/*                                                                   */
+/*   Descriptive Name: Rebuilds the pool of a list after all of the  */
+/*                     items in the list have been removed.          */
+/*                                                                   */
+/*   Input:  ControlNode * ListData : The list whose pool is to be   */
+/*                                    rebuilt.                       */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: All empty slabs except one are freed.             */
+/*                                                                   */
+/*   Notes: The LinkNodes which were in the list must have had their */
+/*          ControlNodeLocation set to NULL and been counted out of  */
+/*          NodesInUse for their slabs, but must not have been placed*/
+/*          back on the FreeNodes chains of their slabs.  The chains */
+/*          are rebuilt here.  A LinkNode is unused if it does not   */
+/*          belong to a list.                                        */
+/*                                                                   */
+/*********************************************************************/
+static void Reclaim_Slabs( ControlNode * ListData )
+{
+
+  LinkNodePool *  Pool = &(ListData->NodePool);
+  LinkNodeSlab *  Slab;
+  LinkNodeSlab *  NextSlab;
+  LinkNode *      Nodes;
+  CARDINAL32      Index;
+  BOOLEAN         Empty_Slab_Kept = FALSE;
+
+  Slab = Pool->FirstSlab;
+  Pool->FirstSlab = NULL;
+  Pool->LastSlab = NULL;
+  Pool->Statistics.Nodes_In_Use = 0;
+
+  while ( Slab != NULL )
+  {
+
+    NextSlab = Slab->NextSlab;
+
+    if ( ( Slab->NodesInUse == 0 ) && Empty_Slab_Kept )
+    {
+
+      Pool->Statistics.Slab_Count--;
+      Pool->Statistics.Node_Count -= Slab->NodeCount;
+      Pool->Statistics.Slabs_Freed++;
+
+      free(Slab);
+
+    }
+    else
+    {
+
+      if ( Slab->NodesInUse == 0 )
+        Empty_Slab_Kept = TRUE;
+
+      /* Rebuild the chain of unused LinkNodes, in address order. */
+      Slab->FreeNodes = NULL;
+      Nodes = Slab->Nodes;
+      for ( Index = Slab->NodeCount; Index > 0; Index-- )
+      {
+
+        if ( Nodes[Index - 1].ControlNodeLocation == NULL )
+        {
+
+          Nodes[Index - 1].NextLinkNode = Slab->FreeNodes;
+          Slab->FreeNodes = &(Nodes[Index - 1]);
+
+        }
+
+      }
+
+      Pool->Statistics.Nodes_In_Use += Slab->NodesInUse;
+
+      Add_Slab(Pool, Slab, ( Slab->FreeNodes != NULL ) );
+
+    }
+
+    Slab = NextSlab;
+
+  }
+
+}
+
+#endif
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Hash_Key                                         */
+/*                                                                   */
+/*   Descriptive Name: Computes the hash of a key for the index of a */
+/*                     DLIST.                                        */
+/*                                                                   */
+/*   Input:  ADDRESS Key : The key to hash.                          */
+/*           CARDINAL32 KeySize : The size of the key, in bytes.     */
+/*                                                                   */
+/*   Output: The function return value is the hash of the key.       */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: This is the 32 bit FNV-1a hash.                          */
+/*                                                                   */
+/*********************************************************************/
+static CARDINAL32 Hash_Key( ADDRESS Key, CARDINAL32 KeySize )
+{
+
+  BYTE *      Current_Byte = (BYTE *) Key;
+  CARDINAL32  Hash = 2166136261UL;
+
+  while ( KeySize > 0 )
+  {
+
+    Hash = ( Hash ^ *Current_Byte ) * 16777619UL;
+    Hash &= 0xFFFFFFFFUL;
+    Current_Byte++;
+    KeySize--;
+
+  }
+
+  return Hash;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Index_LinkNode                                   */
+/*                                                                   */
+/*   Descriptive Name: Adds a LinkNode to the index of a DLIST.      */
+/*                                                                   */
+/*   Input:  ListIndex * Index : The index to add the LinkNode to.   */
+/*           LinkNode * Node : The LinkNode to add.                  */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: If the key function says the item has no key,   */
+/*                   the LinkNode is not indexed.                    */
+/*                                                                   */
+/*   Side Effects: The index may be grown.  If the memory for a      */
+/*                 larger index can not be allocated, the current    */
+/*                 index is kept and its chains just get longer.     */
+/*                                                                   */
+/*   Notes: Node must not already be in an index.                    */
+/*                                                                   */
+/*********************************************************************/
+static void Index_LinkNode( ListIndex * Index, LinkNode * Node )
+{
+
+  ADDRESS       Key;
+  CARDINAL32    KeySize;
+  CARDINAL32    BucketCount;
+  CARDINAL32    Bucket;
+  LinkNode **   NewBuckets;
+  LinkNode *    CurrentNode;
+  LinkNode *    NextNode;
+
+
+  if ( ! Index->GetKey(Node->DataLocation, Node->DataTag, Node->DataSize, &Key, &KeySize) || ( KeySize == 0 ) )
+  {
+
+    Node->Indexed = FALSE;
+    return;
+
+  }
+
+  Node->KeyHash = Hash_Key(Key, KeySize);
+  Node->NextIndexedNode = Index->Buckets[Node->KeyHash & Index->BucketMask];
+  Index->Buckets[Node->KeyHash & Index->BucketMask] = Node;
+  Node->Indexed = TRUE;
+  Index->IndexedCount++;
+
+  /* Is it time to grow the index? */
+  BucketCount = Index->BucketMask + 1;
+  if ( Index->IndexedCount <= BucketCount )
+    return;
+
+#ifdef USE_POOLMAN
+  NewBuckets = (LinkNode **) SmartMalloc( 2 * BucketCount * sizeof(LinkNode *) );
+#else
+  NewBuckets = (LinkNode **) malloc( 2 * BucketCount * sizeof(LinkNode *) );
+#endif
+  if ( NewBuckets == NULL )
+    return;
+
+  memset(NewBuckets, 0, 2 * BucketCount * sizeof(LinkNode *) );
+
+  /* Move the LinkNodes to the new buckets.  The hash of each key was saved when it was indexed, so the key function is not needed. */
+  for ( Bucket = 0; Bucket < BucketCount; Bucket++ )
+  {
+
+    for ( CurrentNode = Index->Buckets[Bucket]; CurrentNode != NULL; CurrentNode = NextNode )
+    {
+
+      NextNode = CurrentNode->NextIndexedNode;
+      CurrentNode->NextIndexedNode = NewBuckets[CurrentNode->KeyHash & ( 2 * BucketCount - 1 )];
+      NewBuckets[CurrentNode->KeyHash & ( 2 * BucketCount - 1 )] = CurrentNode;
+
+    }
+
+  }
+
+#ifdef USE_POOLMAN
+  SmartFree(Index->Buckets);
+#else
+  free(Index->Buckets);
+#endif
+
+  Index->Buckets = NewBuckets;
+  Index->BucketMask = 2 * BucketCount - 1;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Unindex_LinkNode                                 */
+/*                                                                   */
+/*   Descriptive Name: Removes a LinkNode from the index of a DLIST. */
+/*                                                                   */
+/*   Input:  ListIndex * Index : The index to remove the LinkNode    */
+/*                               from.                               */
+/*           LinkNode * Node : The LinkNode to remove.               */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: The hash saved in the LinkNode is used to find its chain,*/
+/*          so this works even if the key of the item has already    */
+/*          been changed.                                            */
+/*                                                                   */
+/*********************************************************************/
+static void Unindex_LinkNode( ListIndex * Index, LinkNode * Node )
+{
+
+  LinkNode **   Link;
+
+  Link = &(Index->Buckets[Node->KeyHash & Index->BucketMask]);
+  while ( ( *Link != NULL ) && ( *Link != Node ) )
+    Link = &( (*Link)->NextIndexedNode );
+
+#ifdef DEBUG
+
+  #ifdef PARANOID
+
+  assert( *Link == Node );
+
+  #endif
+
+#endif
+
+  if ( *Link == Node )
+  {
+
+    *Link = Node->NextIndexedNode;
+    Index->IndexedCount--;
+
+  }
+
+  Node->NextIndexedNode = NULL;
+  Node->Indexed = FALSE;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Clear_Index                                      */
+/*                                                                   */
+/*   Descriptive Name: Removes all LinkNodes from the index of a     */
+/*                     DLIST.                                        */
+/*                                                                   */
+/*   Input:  ListIndex * Index : The index to empty.                 */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: The Indexed fields of the LinkNodes are not changed.     */
+/*          The caller must either release the LinkNodes or clear    */
+/*          their Indexed fields itself.                             */
+/*                                                                   */
+/*********************************************************************/
+static void Clear_Index( ListIndex * Index )
+{
+
+  memset(Index->Buckets, 0, ( Index->BucketMask + 1 ) * sizeof(LinkNode *) );
+  Index->IndexedCount = 0;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Destroy_Index                                    */
+/*                                                                   */
+/*   Descriptive Name: Frees the memory used by the index of a DLIST.*/
+/*                                                                   */
+/*   Input:  ListIndex * Index : The index to free.                  */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: See the notes for Clear_Index.                           */
+/*                                                                   */
+/*********************************************************************/
+static void Destroy_Index( ListIndex * Index )
+{
+
+#ifdef USE_POOLMAN
+  SmartFree(Index->Buckets);
+  SmartFree(Index);
+#else
+  free(Index->Buckets);
+  free(Index);
+#endif
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Merge_Sort_LinkNodes                             */
+/*                                                                   */
+/*   Descriptive Name: Sorts a list in place by merging sublists of  */
+/*                     its LinkNodes.                                */
+/*                                                                   */
+/*   Input:  ControlNode * ListData : The list to sort.  It must     */
+/*                                    have more than one item.       */
+/*           Compare_Function Compare : The function used to compare */
+/*                                      two items, or NULL to sort   */
+/*                                      by key.                      */
+/*           DLIST_Sort_Key_Function GetSortKey : The function which */
+/*                                      returns the sort key of an   */
+/*                                      item.  Only used if Compare  */
+/*                                      is NULL.                     */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: *Error will be DLIST_SUCCESS if the list was sorted, or */
+/*           the error code returned by Compare or GetSortKey        */
+/*           otherwise.                                              */
+/*                                                                   */
+/*   Error Handling: If Compare or GetSortKey reports an error, the  */
+/*                   sort stops and the list is left in a valid but  */
+/*                   partially sorted order.                         */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: Used by SortList and SortListByKey when there is not     */
+/*          enough memory for an array.  The size of the sublists    */
+/*          starts at 1, and is doubled with each pass.  The sort    */
+/*          ends when the size of a sublist is greater than the size */
+/*          of the list.                                             */
+/*                                                                   */
+/*********************************************************************/
+static void Merge_Sort_LinkNodes( ControlNode * ListData, Compare_Function Compare, DLIST_Sort_Key_Function GetSortKey, CARDINAL32 * Error )
+{
+
+  LinkNode *      NodeToMove;
+
+  LinkNode *      MergeList1;
+  CARDINAL32      MergeList1Size;
+
+  LinkNode *      MergeList2;
+  CARDINAL32      MergeList2Size;
+
+  CARDINAL32      MergeListMaxSize;
+  CARDINAL32      ListSize;
+
+  CARDINAL32      Key1 = 0;
+  CARDINAL32      Key2 = 0;
+  INTEGER32       CompareResult;
+
+  /* The original list will be repeatedly broken into sublists, which are then
+     merged back into one list.  This process is done two sublists at a time.
+     The two sublists are MergeList1 and MergeList2.  Both sublists are the
+     same size.  The only exception occurs when there are not enough items
+     remaining to create a MergeList2 of the same size as the MergeList1.
+     The size of MergeList1 and MergeList2 starts out at 1, and will be doubled
+     with each iteration of the outer "do" loop below.                            */
+  MergeListMaxSize = 1;
+
+  /* This is the outer "do" loop which controls the size of the sublists being
+     merged.  The sublists are merged two at a time, with MergeList1 and
+     MergeList2 representing the two sublists being merged.                     */
+  do
+  {
+
+    /* The first sublist will always start with the first element of the
+       list being sorted.                                                  */
+    MergeList1 = ListData->StartOfList;
+
+    /* This loop controls the merging of sublists back into one list. */
+    do
+    {
+
+      /* The maximum number of items in each of the sublists to be merged
+         is MergeListMaxSize.  As items are merged, they are removed from
+         the sublist they were in and placed in the single list which results
+         from the merging process.                                             */
+      MergeList1Size = MergeListMaxSize;
+      MergeList2Size = MergeListMaxSize;
+
+      /* Find the start of the second list for merging. */
+      ListSize = MergeList1Size;
+      MergeList2 = MergeList1;
+      while ( ( MergeList2 != NULL  ) && (ListSize > 0) )
+      {
+
+        MergeList2 = MergeList2->NextLinkNode;
+        ListSize--;
+
+      }
+
+      /* Now merge the two lists */
+      while ( (MergeList1 != NULL) && (MergeList2 != NULL) &&
+              (MergeList1Size > 0) && (MergeList2Size > 0) )
+      {
+
+        /* Compare the first item in MergeList1 with the first item in MergeList2. */
+        if ( Compare != NULL )
+        {
+
+          CompareResult = (*Compare)(MergeList1->DataLocation,MergeList1->DataTag,MergeList2->DataLocation,MergeList2->DataTag,Error);
+
+        }
+        else
+        {
+
+          /* We are sorting by key.  Without memory to hold the keys, they must be obtained again for each comparison. */
+          Key1 = (*GetSortKey)(MergeList1->DataLocation,MergeList1->DataTag,MergeList1->DataSize,Error);
+          if ( *Error == DLIST_SUCCESS )
+            Key2 = (*GetSortKey)(MergeList2->DataLocation,MergeList2->DataTag,MergeList2->DataSize,Error);
+
+          CompareResult = ( Key1 > Key2 ) ? 1 : 0;
+
+        }
+
+        /* If there was an error during the comparision, bail out! */
+        if ( *Error != DLIST_SUCCESS )
+        {
+
+          return;
+
+        }
+
+        /* See who gets moved. */
+        if ( CompareResult > 0 )
+        {
+          /* Object1 is greater than Object2. */
+
+          /* Object2 must be placed before Object 1. */
+          NodeToMove = MergeList2;
+
+          /* Make MergeList2 point to the new start of the second list. */
+          MergeList2 = MergeList2->NextLinkNode;
+
+          /* If NodeToMove was the last item in the list, we must update EndOfList since
+             NodeToMove will no longer be the last item in the list!                           */
+          if ( NodeToMove == ListData->EndOfList )
+          {
+            ListData->EndOfList = NodeToMove->PreviousLinkNode;
+          }
+
+          /* Remove NodeToMove from the list. */
+          if ( NodeToMove->PreviousLinkNode != NULL)
+          {
+            NodeToMove->PreviousLinkNode->NextLinkNode = MergeList2;
+
+            if (MergeList2 != NULL)
+            {
+              MergeList2->PreviousLinkNode = NodeToMove->PreviousLinkNode;
+            }
+
+          }
+
+          /* NodeToMove must go in front of the current item in the first list.  The
+            current item in the first list is given by MergeList1.                          */
+          if (MergeList1->PreviousLinkNode != NULL)
+          {
+            /* Make the item before MergeList1 point to NodeToMove. */
+            MergeList1->PreviousLinkNode->NextLinkNode = NodeToMove;
+          }
+
+          /* Make NodeToMove->PreviousLinkNode point to the item before MergeList1. */
+          NodeToMove->PreviousLinkNode = MergeList1->PreviousLinkNode;
+
+          /* Make NodeToMove->NextLinkNode point to MergeList1. */
+          NodeToMove->NextLinkNode = MergeList1;
+
+          /* Complete the process by making MergeList1->PreviousLinkNode point to NodeToMove. */
+          MergeList1->PreviousLinkNode = NodeToMove;
+
+          /* If MergeList1 was the first item in the list, we must update StartOfList since
+            MergeList1 is nolonger the first item in the list!                             */
+          if ( MergeList1 == ListData->StartOfList )
+          {
+            ListData->StartOfList = NodeToMove;
+          }
+
+          MergeList2Size--;
+        }
+        else
+        {
+          /* Object1 is less than or equal to Object2. */
+
+          /* Remove Object1 from the first list.  To do this, we just need to
+             advance the MergeList1 pointer, since it always points to the
+             first item in the first of the lists which are being merged.      */
+          MergeList1 = MergeList1->NextLinkNode;
+          MergeList1Size--;
+        }
+
+      }
+
+      /* We have left the while loop.  All of the items in one of the merge lists
+         must have been used.  We must now setup MergeList1 to point to the first
+         of the next two lists to be merged.                                      */
+      if ( (MergeList2Size == 0) || (MergeList2 == NULL) )
+      {
+
+        /* MergeList2 is empty.  Either MergeList2 now points to the first
+           item in the next list to be merged, or MergeList2 is NULL.  Thus,
+           MergeList2 points to what MergeList1 should point to.  So make
+           MergeList1 equal to MergeList2.  When we reach the top of the
+           "do" loop, MergeList2 will be set to point to the proper location. */
+        MergeList1 = MergeList2;
+
+      }
+      else
+      {
+
+        /* The first of the next two lists to be merged starts after the end of the
+           list pointed to by MergeList2.  Thus, we must start MergeList1 at
+           MergeList2 and advance it past the remaining items in MergeList2.        */
+        ListSize = MergeList2Size;
+        MergeList1 = MergeList2;
+        while ( ( MergeList1 != NULL  ) && (ListSize > 0) )
+        {
+
+          MergeList1 = MergeList1->NextLinkNode;
+          ListSize--;
+
+        }
+
+      }
+
+    } while (MergeList1 != NULL);
+
+    MergeListMaxSize = MergeListMaxSize * 2;
+
+  } while ( ListData->ItemCount > MergeListMaxSize);
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Sort_LinkNode_Array                              */
+/*                                                                   */
+/*   Descriptive Name: Sorts an array of LinkNode addresses by the   */
+/*                     items they hold.                              */
+/*                                                                   */
+/*   Input:  LinkNode ** Nodes : The array to sort.                  */
+/*           LinkNode ** Work : A work area with room for Count      */
+/*                              LinkNode addresses.                  */
+/*           CARDINAL32 Count : The number of entries in Nodes.      */
+/*           Compare_Function Compare : The function used to compare */
+/*                                      two items.                   */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: The address of the sorted array, which will be either   */
+/*           Nodes or Work.  *Error will be DLIST_SUCCESS if the     */
+/*           array was sorted, or the error code returned by Compare */
+/*           otherwise.                                              */
+/*                                                                   */
+/*   Error Handling: If Compare reports an error, the sort stops and */
+/*                   NULL is returned.                               */
+/*                                                                   */
+/*   Side Effects: None.  The LinkNodes themselves are not changed.  */
+/*                                                                   */
+/*   Notes: This is a bottom up merge sort.  Runs of SORT_RUN_LENGTH */
+/*          entries are sorted with an insertion sort, and then the  */
+/*          runs are merged in pairs, back and forth between Nodes   */
+/*          and Work, until only one run remains.  If the last entry */
+/*          of one run is not greater than the first entry of the    */
+/*          next, the two runs are copied rather than merged.        */
+/*                                                                   */
+/*          To keep the sort stable, an entry from the second run of */
+/*          a pair is only taken ahead of an entry from the first    */
+/*          when Compare says it is smaller.                         */
+/*                                                                   */
+/*********************************************************************/
+static LinkNode ** Sort_LinkNode_Array( LinkNode ** Nodes, LinkNode ** Work, CARDINAL32 Count, Compare_Function Compare, CARDINAL32 * Error )
+{
+
+  LinkNode **     Source = Nodes;
+  LinkNode **     Target = Work;
+  LinkNode **     Swap;
+  LinkNode *      NodeToPlace;
+
+  CARDINAL32      RunLength;
+  CARDINAL32      RunStart;
+  CARDINAL32      RunMiddle;
+  CARDINAL32      RunEnd;
+  CARDINAL32      Left;
+  CARDINAL32      Right;
+  CARDINAL32      Output;
+  CARDINAL32      Index;
+  CARDINAL32      Position;
+
+  INTEGER32       CompareResult;
+
+  *Error = DLIST_SUCCESS;
+
+  /* Sort each run of SORT_RUN_LENGTH entries with an insertion sort. */
+  for ( RunStart = 0; RunStart < Count; RunStart += SORT_RUN_LENGTH )
+  {
+
+    RunEnd = RunStart + SORT_RUN_LENGTH;
+    if ( RunEnd > Count )
+      RunEnd = Count;
+
+    for ( Index = RunStart + 1; Index < RunEnd; Index++ )
+    {
+
+      NodeToPlace = Nodes[Index];
+      Position = Index;
+      while ( Position > RunStart )
+      {
+
+        CompareResult = (*Compare)(Nodes[Position - 1]->DataLocation, Nodes[Position - 1]->DataTag, NodeToPlace->DataLocation, NodeToPlace->DataTag, Error);
+        if ( *Error != DLIST_SUCCESS )
+          return NULL;
+
+        if ( CompareResult <= 0 )
+          break;
+
+        Nodes[Position] = Nodes[Position - 1];
+        Position--;
+
+      }
+
+      Nodes[Position] = NodeToPlace;
+
+    }
+
+  }
+
+  /* Merge pairs of runs, doubling the length of the runs with each pass. */
+  for ( RunLength = SORT_RUN_LENGTH; RunLength < Count; RunLength = RunLength * 2 )
+  {
+
+    for ( RunStart = 0; RunStart < Count; RunStart += 2 * RunLength )
+    {
+
+      RunMiddle = RunStart + RunLength;
+      if ( RunMiddle > Count )
+        RunMiddle = Count;
+
+      RunEnd = RunMiddle + RunLength;
+      if ( RunEnd > Count )
+        RunEnd = Count;
+
+      /* If there is no second run, or the two runs are already in order, just copy them. */
+      if ( RunMiddle < RunEnd )
+      {
+
+        CompareResult = (*Compare)(Source[RunMiddle - 1]->DataLocation, Source[RunMiddle - 1]->DataTag, Source[RunMiddle]->DataLocation, Source[RunMiddle]->DataTag, Error);
+        if ( *Error != DLIST_SUCCESS )
+          return NULL;
+
+      }
+      else
+        CompareResult = 0;
+
+      if ( CompareResult <= 0 )
+      {
+
+        memcpy(Target + RunStart, Source + RunStart, ( RunEnd - RunStart ) * sizeof(LinkNode *) );
+        continue;
+
+      }
+
+      Left = RunStart;
+      Right = RunMiddle;
+      Output = RunStart;
+      while ( ( Left < RunMiddle ) && ( Right < RunEnd ) )
+      {
+
+        CompareResult = (*Compare)(Source[Left]->DataLocation, Source[Left]->DataTag, Source[Right]->DataLocation, Source[Right]->DataTag, Error);
+        if ( *Error != DLIST_SUCCESS )
+          return NULL;
+
+        if ( CompareResult > 0 )
+        {
+
+          Target[Output] = Source[Right];
+          Right++;
+
+        }
+        else
+        {
+
+          Target[Output] = Source[Left];
+          Left++;
+
+        }
+
+        Output++;
+
+      }
+
+      /* Only one of the runs has entries left, and they are already in order. */
+      if ( Left < RunMiddle )
+        memcpy(Target + Output, Source + Left, ( RunMiddle - Left ) * sizeof(LinkNode *) );
+      else
+        memcpy(Target + Output, Source + Right, ( RunEnd - Right ) * sizeof(LinkNode *) );
+
+    }
+
+    Swap = Source;
+    Source = Target;
+    Target = Swap;
+
+  }
+
+  return Source;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Relink_LinkNodes                                 */
+/*                                                                   */
+/*   Descriptive Name: Rebuilds the links of a list so that its      */
+/*                     items are in the order given by an array.     */
+/*                                                                   */
+/*   Input:  ControlNode * ListData : The list to relink.            */
+/*           LinkNode ** Nodes : The addresses of all of the         */
+/*                               LinkNodes in the list, in their new */
+/*                               order.                              */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: The current item of the list and the index of the list,  */
+/*          if any, refer to LinkNodes rather than positions, so     */
+/*          neither needs to be changed.                             */
+/*                                                                   */
+/*********************************************************************/
+static void Relink_LinkNodes( ControlNode * ListData, LinkNode ** Nodes )
+{
+
+  CARDINAL32      Index;
+
+  Nodes[0]->PreviousLinkNode = NULL;
+  for ( Index = 1; Index < ListData->ItemCount; Index++ )
+  {
+
+    Nodes[Index - 1]->NextLinkNode = Nodes[Index];
+    Nodes[Index]->PreviousLinkNode = Nodes[Index - 1];
+
+  }
+
+  Nodes[ListData->ItemCount - 1]->NextLinkNode = NULL;
+
+  ListData->StartOfList = Nodes[0];
+  ListData->EndOfList = Nodes[ListData->ItemCount - 1];
+
+}
+
+
+#ifdef __linux__
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: CreateSemaphore                                  */
+/*                                                                   */
+/*   Descriptive Name: Creates a lock for use by shared lists.       */
+/*                                                                   */
+/*   Input:  None.                                                   */
+/*                                                                   */
+/*   Output: The lock, or NULL if there was not enough memory.       */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: The lock functions here match those lock.h provides on   */
+/*          OS/2.                                                    */
+/*                                                                   */
+/*********************************************************************/
+static SEMAPHORE CreateSemaphore( void )
+{
+
+  SEMAPHORE   Semaphore;
+
+  Semaphore = (SEMAPHORE) malloc( sizeof(pthread_mutex_t) );
+  if ( Semaphore == NULL )
+    return NULL;
+
+  if ( pthread_mutex_init(Semaphore, NULL) != 0 )
+  {
+
+    free(Semaphore);
+    return NULL;
+
+  }
+
+  return Semaphore;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Lock                                             */
+/*                                                                   */
+/*   Descriptive Name: Waits for, and then takes, a lock.            */
+/*                                                                   */
+/*   Input:  SEMAPHORE Semaphore : The lock to take.                 */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: None.                                                    */
+/*                                                                   */
+/*********************************************************************/
+static void Lock( SEMAPHORE Semaphore )
+{
+
+  pthread_mutex_lock(Semaphore);
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Unlock                                           */
+/*                                                                   */
+/*   Descriptive Name: Releases a lock.                              */
+/*                                                                   */
+/*   Input:  SEMAPHORE Semaphore : The lock to release.              */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: None.                                                    */
+/*                                                                   */
+/*********************************************************************/
+static void Unlock( SEMAPHORE Semaphore )
+{
+
+  pthread_mutex_unlock(Semaphore);
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: DestroySemaphore                                 */
+/*                                                                   */
+/*   Descriptive Name: Frees a lock created by CreateSemaphore.      */
+/*                                                                   */
+/*   Input:  SEMAPHORE Semaphore : The lock to free.                 */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: The lock must not be held.                               */
+/*                                                                   */
+/*********************************************************************/
+static void DestroySemaphore( SEMAPHORE Semaphore )
+{
+
+  pthread_mutex_destroy(Semaphore);
+  free(Semaphore);
+
+}
+
+#endif
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Retire_LinkNode                                  */
+/*                                                                   */
+/*   Descriptive Name: Sets aside a LinkNode removed from a shared   */
+/*                     list until no reader can be looking at it.    */
+/*                                                                   */
+/*   Input:  ControlNode * ListData : The shared list the LinkNode   */
+/*                                    was removed from.              */
+/*           LinkNode * Node : The LinkNode to retire.  It must not  */
+/*                             be in the index of the list.          */
+/*           BOOLEAN FreeData : TRUE if the item belonging to Node   */
+/*                              is to be freed along with it.        */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: The links and data of Node are left alone, so that a     */
+/*          reader positioned on Node can still continue its walk    */
+/*          through the list.  Node is freed by UnlockList or        */
+/*          DestroyList.                                             */
+/*                                                                   */
+/*********************************************************************/
+static void Retire_LinkNode( ControlNode * ListData, LinkNode * Node, BOOLEAN FreeData )
+{
+
+  Node->ControlNodeLocation = &Retired_Owner;
+  Node->FreeData = FreeData;
+  Node->NextIndexedNode = ListData->Shared->Retiring;
+  ListData->Shared->Retiring = Node;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Free_Retired_LinkNodes                           */
+/*                                                                   */
+/*   Descriptive Name: Frees a chain of retired LinkNodes.           */
+/*                                                                   */
+/*   Input:  POOL NodePool : The pool of LinkNodes belonging to the  */
+/*                           shared list the LinkNodes were retired  */
+/*                           from.  Only present if USE_POOLMAN is   */
+/*                           defined.                                */
+/*           LinkNode * Chain : The first LinkNode in the chain.  The*/
+/*                              LinkNodes are chained through their  */
+/*                              NextIndexedNode fields.              */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: The items belonging to the LinkNodes are freed if */
+/*                 they were retired with FreeData set to TRUE.      */
+/*                                                                   */
+/*   Notes: None.                                                    */
+/*                                                                   */
+/*********************************************************************/
+#ifdef USE_POOLMAN
+static void Free_Retired_LinkNodes( POOL NodePool, LinkNode * Chain )
+#else
+static void Free_Retired_LinkNodes( LinkNode * Chain )
+#endif
+{
+
+  LinkNode *  Node;
+
+  while ( Chain != NULL )
+  {
+
+    Node = Chain;
+    Chain = Node->NextIndexedNode;
+
+    if ( Node->FreeData )
+    {
+
+      Free_Item(Node);
+
+    }
+
+    Node->NextIndexedNode = NULL;
+    Node->ControlNodeLocation = NULL;
+#ifdef USE_POOLMAN
+    DeallocateToPool(NodePool,Node);    /* Return LinkNode to the Node Pool. */
+#else
+    Release_LinkNode(Node);
+#endif
+
+  }
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Insert_LinkNode                                  */
+/*                                                                   */
+/*   Descriptive Name: Adds an item to a list.  This does the work   */
+/*                     for InsertItem and InsertObject.              */
+/*                                                                   */
+/*   Input:  DLIST ListToAddTo : The list to which the item is to be */
+/*                               added.                              */
+/*           CARDINAL32 ItemSize : The size of the item.             */
+/*           ADDRESS ItemLocation : The address of the item.         */
+/*           TAG ItemTag : The item tag to associate with the item.  */
+/*           ADDRESS TargetHandle : The item used as the reference   */
+/*                                  point for the insertion, or NULL */
+/*                                  to use the current item.         */
+/*           Insertion_Modes Insert_Mode : Where, relative to the    */
+/*                                         reference point, the item */
+/*                                         is to be placed.          */
+/*           BOOLEAN MakeCurrent : If TRUE, the item becomes the     */
+/*                                 current item in ListToAddTo.      */
+/*           BOOLEAN CopyItem : If TRUE, the item is copied into the */
+/*                              LinkNode created for it.  ItemSize   */
+/*                              must not be more than                */
+/*                              INLINE_ITEM_SIZE.  If FALSE, the     */
+/*                              address of the item is stored in the */
+/*                              list.                                */
+/*           CARDINAL32 * Error : The address of a variable to hold  */
+/*                                the error return code.             */
+/*                                                                   */
+/*   Output: The handle of the new item, or NULL if it could not be  */
+/*           added.  *Error will be set to DLIST_SUCCESS if the item */
+/*           was added, or to an error code otherwise.               */
+/*                                                                   */
+/*   Error Handling: See InsertObject.                               */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: None.                                                    */
+/*                                                                   */
+/*********************************************************************/
+static ADDRESS Insert_LinkNode( DLIST           ListToAddTo,
+                                CARDINAL32      ItemSize,
+                                ADDRESS         ItemLocation,
+                                TAG             ItemTag,
+                                ADDRESS         TargetHandle,
+                                Insertion_Modes Insert_Mode,
+                                BOOLEAN         MakeCurrent,
+                                BOOLEAN         CopyItem,
+                                CARDINAL32 *    Error)
+{
+
+  /* Since ListToAddTo is of type DLIST, we can not use it without having
+     to type cast it each time.  To avoid all of the type casting, we
+     will declare a local variable of type ControlNode * and then
+     initialize it once using ListToAddTo.  This way we just do the
+     cast once.                                                            */
+
+  ControlNode *      ListData;
+
+  LinkNode *         NewNode;         /* Used to create the LinkNode for the new item. */
+  LinkNode *         CurrentNode;     /* Used to hold the reference point for the insertion. */
+  LinkNode *         PreviousNode;    /* Used to point to the item prior to CurrentNode in the list while
+                                         the new item is being inserted. */
+  LinkNode *         NextNode;        /* Used to point to the item after CurrentNode in the list while
+                                         the new item is being inserted.                                   */
+
+
+  /* We will assume that ListToAppendTo points to a valid list.  Given this,
+     we will initialize ListData to point to the ControlNode of this
+     list.                                                              */
+  ListData = (ControlNode *) ListToAddTo;
+
+  /* Has the user specified a specific item in the list as a reference point for this insertion? */
+  if ( TargetHandle != NULL )
+  {
+
+    /* Since the user has specified a reference point for this insertion, set up to use it. */
+    CurrentNode = (LinkNode *) TargetHandle;
+
+  }
+  else
+  {
+
+    /* The user did not specify a reference point, so use the current item in the list as the reference point. */
+    CurrentNode = ListData->CurrentItem;
+
+  }
+
+#ifdef DEBUG
+
+  #ifdef PARANOID
+
+  if ( !CheckListIntegrity(ListToAddTo) )
+  {
+    *Error = DLIST_CORRUPTED;
+    return NULL;
+  }
+
+  #else
+
+  /* We must now validate the list before we attempt to use it.  We will
+     do this by checking the Verify field in the ControlNode.               */
+  if ((ListData == NULL) || (ListData->Verify != VerifyValue))
+  {
+    *Error = DLIST_NOT_INITIALIZED;
+    return NULL;
+  }
+
+  #endif
+
+  /* Since the list is valid, we must now see if the TargetHandle is valid.  We
+     will assume that, if the TargetHandle is not NULL, it points to a LinkNode.
+     If the ControlNodeLocation field of the LinkNode points to the
+     ControlNode for the list we are working with, then the LinkNode is in
+     the list and can therefore be used safely.
+
+      At this point, CurrentNode has been set equal to TargetHandle if TargetHandle
+      is not NULL.  If TargetHandle is NULL, then CurrentNode was set to the current
+      item in the list.                                                              .*/
+  if ( TargetHandle != NULL  )
+  {
+
+    /* Is CurrentNode part of this list? */
+    if ( CurrentNode->ControlNodeLocation != ListData )
+    {
+
+      /* The handle either did not point to a ControlNode or it pointed to the wrong ControlNode! */
+      *Error = DLIST_BAD_HANDLE;
+      return NULL;
+
+    }
+
+  }
+
+  /* We must check the insertion mode. */
+  if ( Insert_Mode > AppendToList )
+  {
+
+    *Error = DLIST_INVALID_INSERTION_MODE;
+    return NULL;
+
+  }
+
+  /* Lets check the item being added to the DLIST. */
+  if (ItemLocation == NULL)
+  {
+    *Error = DLIST_BAD_ITEM_POINTER;
+    return NULL;
+  }
+
+  if ( ItemSize == 0)
+  {
+    *Error = DLIST_ITEM_SIZE_ZERO;
+    return NULL;
+  }
+
+#endif
+
+  /* Since both the list and item are valid, lets make a LinkNode. */
+#ifdef USE_POOLMAN
+  NewNode = (LinkNode *) AllocateFromPool(ListData->NodePool);
+#else
+  NewNode = Allocate_LinkNode(ListData);
+#endif
+
+  /* Did we get the memory? */
+  if (NewNode == NULL)
+  {
+    *Error = DLIST_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  /* Now that all memory has been allocated, lets finish initializing the LinkNode. */
+  NewNode->DataSize = ItemSize;
+  if ( CopyItem )
+  {
+
+    /* The item is small enough to be kept in the LinkNode itself. */
+    memcpy(NewNode->InlineItem.Bytes, ItemLocation, ItemSize);
+    NewNode->DataLocation = NewNode->InlineItem.Bytes;
+
+  }
+  else
+    NewNode->DataLocation = ItemLocation;
+  NewNode->DataTag = ItemTag;
+  NewNode->NextLinkNode = NULL;
+  NewNode->PreviousLinkNode = NULL;
+  NewNode->ControlNodeLocation = ListData;     /* Initialize the link to the control node
+                                                  of the list containing this link node.   */
+  NewNode->NextIndexedNode = NULL;
+  NewNode->Indexed = FALSE;
+
+  /* Readers of a shared list follow the NextLinkNode fields without taking any locks, so NewNode must be completely filled in
+     before anything in the list points to it.  NewNode must also point to the rest of the list before it is linked in.       */
+  if ( ListData->Shared != NULL )
+    PUBLISH_BARRIER();
+
+  /* Now we can add the node to the list. */
+
+  /* Is the list empty?  If so, then the Insertion_Mode does not matter! */
+  if (ListData->CurrentItem == NULL)
+  {
+    /* The List is empty.  This will be the first (and only) item in the list.
+       Also, since this will be the only item in the list, it automatically
+       becomes the current item.                                               */
+    ListData->EndOfList = NewNode;
+    ListData->StartOfList = NewNode;
+    ListData->CurrentItem = NewNode;
+  }
+  else
+  {
+    /* The list was not empty.  */
+
+    /* Now lets insert the item according to the specified Insert_Mode. */
+    switch ( Insert_Mode )
+    {
+
+      case InsertAtStart: /* Get the first item in the list. */
+                          CurrentNode = ListData->StartOfList;
+
+                          /* Now insert NewNode before CurrentNode. */
+                          NewNode->NextLinkNode = CurrentNode;
+                          if ( ListData->Shared != NULL )
+                            PUBLISH_BARRIER();
+
+                          CurrentNode->PreviousLinkNode = NewNode;
+
+                          /* Now update the ControlNode. */
+                          ListData->StartOfList = NewNode;
+
+                          break;
+      case InsertBefore:  /* CurrentNode already points to the Item we are to insert NewNode before. */
+
+                          /* Make NewNode point to CurrentNode first, so that NewNode is never in the list without it. */
+                          NewNode->NextLinkNode = CurrentNode;
+                          if ( ListData->Shared != NULL )
+                            PUBLISH_BARRIER();
+
+                          /* Is CurrentNode the first item in the list? */
+                          if ( ListData->StartOfList != CurrentNode )
+                          {
+
+                            /* Since CurrentNode is not the first item in the list, we need the node prior to CurrentNode
+                               so we can adjust its link fields.                                                           */
+                            PreviousNode = CurrentNode->PreviousLinkNode;
+
+                            /* Now make PreviousLinkNode point to NewNode and vice versa. */
+                            NewNode->PreviousLinkNode = PreviousNode;
+                            PreviousNode->NextLinkNode = NewNode;
+
+                          }
+                          else
+                          {
+
+                            /* Since CurrentNode is the first item in the list, that means that NewNode will be
+                               the first item in the list after it is inserted.  Update the ControlNode for this
+                               list to reflect that NewNode will be the first item in the list.                     */
+                            ListData->StartOfList = NewNode;
+
+                          }
+
+                          /* Now make CurrentNode point back to NewNode. */
+                          CurrentNode->PreviousLinkNode = NewNode;
+
+                          break;
+      case InsertAfter:   /* CurrentNode already points to the Item we are to insert NewNode after. */
+
+                          /* Is CurrentNode the last item in the list? */
+                          if ( ListData->EndOfList != CurrentNode )
+                          {
+
+                            /* Since CurrentNode is not the last item in the list, we need the node after to CurrentNode
+                               so we can adjust its link fields.                                                           */
+                            NextNode = CurrentNode->NextLinkNode;
+
+                            /* Now make NextLinkNode point to NewNode and vice versa. */
+                            NextNode->PreviousLinkNode = NewNode;
+                            NewNode->NextLinkNode = NextNode;
+
+                            if ( ListData->Shared != NULL )
+                              PUBLISH_BARRIER();
+
+                          }
+                          else
+                          {
+
+                            /* Since CurrentNode is the last item in the list, that means that NewNode will be
+                               the last item in the list after it is inserted.  Update the ControlNode for this
+                               list to reflect that NewNode will be the last item in the list.                     */
+                            ListData->EndOfList = NewNode;
+
+                          }
+
+                          /* Now make NewNode point to CurrentNode and vice versa. */
+                          CurrentNode->NextLinkNode = NewNode;
+                          NewNode->PreviousLinkNode = CurrentNode;
+
+                          break;
+      case AppendToList:  /* Get the last item in the list. */
+                          CurrentNode = ListData->EndOfList;
+
+                          /* Now insert NewNode after CurrentNode. */
+                          CurrentNode->NextLinkNode = NewNode;
+                          NewNode->PreviousLinkNode = CurrentNode;
+
+                          /* Now update the ControlNode. */
+                          ListData->EndOfList = NewNode;
+
+                          break;
+      default :
+                NewNode->ControlNodeLocation = NULL;
+                Free_Item(NewNode);
+#ifdef USE_POOLMAN
+                DeallocateToPool(ListData->NodePool,NewNode);
+#else
+                Release_LinkNode(NewNode);
+#endif
+                *Error = DLIST_INVALID_INSERTION_MODE;
+                return NULL;
+
+    }
+
+  }
+
+  /* Adjust the count of the number of items in the list. */
+  ListData->ItemCount++;
+
+  /* If the list is indexed, add the new item to the index. */
+  if ( ListData->Index != NULL )
+    Index_LinkNode(ListData->Index, NewNode);
+
+  /* Should the new node become the current item in the list? */
+  if ( MakeCurrent )
+  {
+
+    /* Adjust the control node so that NewNode becomes the current item in the list. */
+    ListData->CurrentItem = NewNode;
+
+  }
+
+#ifdef PARANOID
+
+  assert (CheckListIntegrity( ListToAddTo ) );
+
+#endif
+
+  /* All done.  Signal successful operation. */
+  *Error = DLIST_SUCCESS;
+
+  return NewNode;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Free_Item                                        */
+/*                                                                   */
+/*   Descriptive Name: Frees the memory holding the item belonging to*/
+/*                     a LinkNode.                                   */
+/*                                                                   */
+/*   Input:  LinkNode * Node : The LinkNode whose item is to be      */
+/*                             freed.                                */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: An item kept in the LinkNode itself is not freed, as it  */
+/*          goes away with the LinkNode.                             */
+/*                                                                   */
+/*********************************************************************/
+static void Free_Item( LinkNode * Node )
+{
+
+  if ( ITEM_IS_INLINE(Node) )
+    return;
+
+#ifdef USE_POOLMAN
+  SmartFree(Node->DataLocation);
+#else
+  free(Node->DataLocation);
+#endif
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Take_Item                                        */
+/*                                                                   */
+/*   Descriptive Name: Returns the address of the item belonging to a*/
+/*                     LinkNode in a form which can outlive the      */
+/*                     LinkNode.                                     */
+/*                                                                   */
+/*   Input:  LinkNode * Node : The LinkNode whose item is wanted.    */
+/*                                                                   */
+/*   Output: The address of the item, or NULL if the item had to be  */
+/*           copied and there was not enough memory to do so.        */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: An item kept in the LinkNode itself is copied to  */
+/*                 the heap.  The copy belongs to the caller.        */
+/*                                                                   */
+/*   Notes: Used by ExtractObject and ReplaceObject, which hand the  */
+/*          item over to their caller.  Node is not changed.         */
+/*                                                                   */
+/*********************************************************************/
+static ADDRESS Take_Item( LinkNode * Node )
+{
+
+  ADDRESS   Item;
+
+  if ( !ITEM_IS_INLINE(Node) )
+    return Node->DataLocation;
+
+#ifdef USE_POOLMAN
+  Item = SmartMalloc(Node->DataSize);
+#else
+  Item = malloc(Node->DataSize);
+#endif
+
+  if ( Item != NULL )
+    memcpy(Item, Node->DataLocation, Node->DataSize);
+
+  return Item;
+
+}
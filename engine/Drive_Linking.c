@@ -111,6 +111,7 @@
 #define PARTITION_NAME_EXPECTED "Error!  A partition name is expected here!"
 #define PARTITION_NAME_TOO_LONG "Error!  The partition name specified is too long!"
 #define MISSING_AGGREGATE_NAME  "Error!  An aggregate name is expected after this comma!"
+#define DL_TRANSFER_BATCH  16   /* The most parts of a request that DL_Transfer hands to Transfer_Segments at once. */
 #define OLD_DRIVE_LINKING_MAJOR_VERSION  1
 #define OLD_DRIVE_LINKING_MINOR_VERSION  0
 #define  OLD_CURRENT_LVM_MAJOR_VERSION_NUMBER   1        /* Define as appropriate. */
@@ -127,6 +128,7 @@ typedef struct _Extended_Drive_Link {
 typedef struct _Drive_Link_Array {
                                    CARDINAL32           Links_In_Use;
                                    Extended_Drive_Link  LinkArray[MAXIMUM_LINKS];
+                                   LBA                  Link_Start[MAXIMUM_LINKS + 1];   /* Link_Start[Index] is the LSN of the first sector of LinkArray[Index].  Link_Start[Links_In_Use] is the size of the aggregate.  Maintained by Build_Link_Map. */
                                    CARDINAL32           Sequence_Number;
                                    BOOLEAN              ChangesMade;
                                    CARDINAL32           Aggregate_Serial_Number;
@@ -155,7 +157,7 @@ typedef struct _LSN_Translation_Record {
                                          Partition_Data  *  Aggregate;
                                          CARDINAL32         Sector_LSN;
                                          Partition_Data  *  PartitionRecord;     /* The PartitionRecord for the partition containing the specified sector. */
-                                         CARDINAL32         Sector_PSN;          /* The sector's address relative to the partition containing it. */
+                                         CARDINAL32         Sector_PSN;          /* The sector's address on the drive containing it, as expected by the Read and Write functions of the next layer. */
                                        } LSN_Translation_Record;
 
 typedef struct _Partition_Deletion_Record {
@@ -257,6 +259,9 @@ static LVM_Token *      GetToken(DLIST Token_List, BOOLEAN CurrentToken, CARDINA
 static LVM_Token *      LookAhead(DLIST Token_List, CARDINAL32  Count, CARDINAL32 * Error_Code);
 static void     _System Find_Partition_By_Name( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize,  ADDRESS ObjectHandle, ADDRESS Parameters,  CARDINAL32 * Error_Code);
 static void     _System Find_Duplicate_ANames( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize,  ADDRESS ObjectHandle, ADDRESS Parameters,  CARDINAL32 * Error_Code);
+static void             Build_Link_Map( Drive_Link_Array * LinkTable );
+static void             Translate_LSNs( Drive_Link_Array * LinkTable, LSN_Translation_Record * Translations, CARDINAL32 Count );
+static void             DL_Transfer( Partition_Data * Aggregate, LBA Starting_Sector, CARDINAL32 Sector_Count, ADDRESS Buffer, BOOLEAN Write, CARDINAL32 * Error_Code );
 
 
 void _System VIO_Help_Panel (CARDINAL32 Help_Index, CARDINAL32 * Error_Code);
@@ -1957,11 +1962,6 @@ static void _System DL_Write( ADDRESS PData, LBA Starting_Sector, CARDINAL32 Sec
 {
 
   Partition_Data *           Aggregate = (Partition_Data *) PData;
-  Plugin_Function_Table_V1 * Old_Function_Table;
-  Drive_Link_Array *         LinkTable;
-  Partition_Data *           PartitionRecord;
-  CARDINAL32                 Sector_PSN;
-  CARDINAL32                 Index;
 
   FEATURE_FUNCTION_ENTRY("DL_Write")
 
@@ -2000,94 +2000,8 @@ static void _System DL_Write( ADDRESS PData, LBA Starting_Sector, CARDINAL32 Sec
 
   }
 
-  /* We must find out where Sector really is. */
-  LinkTable = (Drive_Link_Array *) Aggregate->Feature_Data->Data;
-
-  for (Index = 0; Index < LinkTable->Links_In_Use; Index++)
-  {
-
-    /* Get the partition for this link in the array. */
-    PartitionRecord = LinkTable->LinkArray[Index].PartitionRecord;
-    /* Does the requested sector lie in this partition? */
-    if ( Starting_Sector < PartitionRecord->Usable_Size )
-    {
-
-      /* The requested sector does lie on this partition!  Translate the requested sector to a partition sector number. */
-      Sector_PSN = Starting_Sector + PartitionRecord->Starting_Sector;
-      break;
-
-    }
-    else
-      Starting_Sector -= PartitionRecord->Usable_Size;
-
-  }
-
-  if ( Index >= LinkTable->Links_In_Use )
-  {
-
-    if ( LVM_Common_Services->Logging_Enabled )
-    {
-
-      sprintf(LVM_Common_Services->Log_Buffer,"DL_Write failed to find the partition record for the\n     partition where Sector resides!");
-
-      LVM_Common_Services->Write_Log_Buffer();
-
-    }
-
-    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
-
-    FEATURE_FUNCTION_EXIT("DL_Write")
-
-    return;
-
-  }
-
-  /* Is the feature data for the specified partition available? */
-  if ( PartitionRecord->Feature_Data == NULL )
-  {
-
-    if ( LVM_Common_Services->Logging_Enabled )
-    {
-
-      sprintf(LVM_Common_Services->Log_Buffer,"DL_Write has encountered a partition with bad feature data!");
-      LVM_Common_Services->Write_Log_Buffer();
-
-    }
-
-    *Error_Code = LVM_ENGINE_BAD_PARTITION;
-
-    FEATURE_FUNCTION_EXIT("DL_Write")
-
-    return;
-
-  }
-
-
-  /* Now call the Write function of the PartitionRecord to complete the write operation. */
-  Old_Function_Table = PartitionRecord->Feature_Data->Function_Table;
-
-  /* Is the function table for the next layer available? */
-  if ( Old_Function_Table == NULL )
-  {
-
-    if ( LVM_Common_Services->Logging_Enabled )
-    {
-
-      sprintf(LVM_Common_Services->Log_Buffer,"DL_Write has encountered a partition with bad feature data!");
-      LVM_Common_Services->Write_Log_Buffer();
-
-    }
-
-    *Error_Code = LVM_ENGINE_BAD_PARTITION;
-
-    FEATURE_FUNCTION_EXIT("DL_Write")
-
-    return;
-
-  }
-
-  /* Call the write function of the next layer. */
-  Old_Function_Table->Write(PartitionRecord, Sector_PSN, Sectors_To_Write, Buffer, Error_Code );
+  /* Send the request to the partitions it lies on. */
+  DL_Transfer( Aggregate, Starting_Sector, Sectors_To_Write, Buffer, TRUE, Error_Code );
 
   FEATURE_FUNCTION_EXIT("DL_Write")
 
@@ -2099,11 +2013,6 @@ static void _System DL_Read( ADDRESS PData, LBA Starting_Sector, CARDINAL32 Sect
 {
 
   Partition_Data *           Aggregate = (Partition_Data *) PData;
-  Plugin_Function_Table_V1 * Old_Function_Table;
-  Drive_Link_Array *         LinkTable;
-  Partition_Data *           PartitionRecord;
-  CARDINAL32                 Sector_PSN;
-  CARDINAL32                 Index;
 
   FEATURE_FUNCTION_ENTRY("DL_Read")
 
@@ -2142,91 +2051,8 @@ static void _System DL_Read( ADDRESS PData, LBA Starting_Sector, CARDINAL32 Sect
 
   }
 
-  /* We must find out where Sector really is. */
-  LinkTable = (Drive_Link_Array *) Aggregate->Feature_Data->Data;
-
-  for (Index = 0; Index < LinkTable->Links_In_Use; Index++)
-  {
-
-    /* Get the partition for this link in the array. */
-    PartitionRecord = LinkTable->LinkArray[Index].PartitionRecord;
-    /* Does the requested sector lie in this partition? */
-    if ( Starting_Sector < PartitionRecord->Usable_Size )
-    {
-
-      /* The requested sector does lie on this partition!  Translate the requested sector to a partition sector number. */
-      Sector_PSN = Starting_Sector + PartitionRecord->Starting_Sector;
-      break;
-
-    }
-    else
-      Starting_Sector -= PartitionRecord->Usable_Size;
-
-  }
-
-  if ( Index >= LinkTable->Links_In_Use )
-  {
-
-    if ( LVM_Common_Services->Logging_Enabled )
-    {
-
-      sprintf(LVM_Common_Services->Log_Buffer,"DL_Read failed to find the partition record for the\n     partition where Sector resides!");
-
-      LVM_Common_Services->Write_Log_Buffer();
-
-    }
-
-    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
-
-    FEATURE_FUNCTION_EXIT("DL_Read")
-
-    return;
-
-  }
-
-  /* Is the feature data for the next layer available? */
-  if ( PartitionRecord->Feature_Data == NULL )
-  {
-
-    if ( LVM_Common_Services->Logging_Enabled )
-    {
-
-      sprintf(LVM_Common_Services->Log_Buffer,"DL_Read has encountered a partition with bad feature data!");
-      LVM_Common_Services->Write_Log_Buffer();
-
-    }
-
-    *Error_Code = LVM_ENGINE_BAD_PARTITION;
-
-    FEATURE_FUNCTION_EXIT("DL_Read")
-
-    return;
-
-  }
-
-  /* Is the function table for the next layer on the partition available? */
-  Old_Function_Table =  PartitionRecord->Feature_Data->Function_Table;
-  if ( Old_Function_Table == NULL )
-  {
-
-    if ( LVM_Common_Services->Logging_Enabled )
-    {
-
-      sprintf(LVM_Common_Services->Log_Buffer,"DL_Read has encountered a partition with bad feature data!");
-      LVM_Common_Services->Write_Log_Buffer();
-
-    }
-
-    *Error_Code = LVM_ENGINE_BAD_PARTITION;
-
-    FEATURE_FUNCTION_EXIT("DL_Read")
-
-    return;
-
-  }
-
-  /* Now call the Read function of the PartitionRecord to complete the read operation. */
-  Old_Function_Table->Read(PartitionRecord, Sector_PSN, Sectors_To_Read, Buffer, Error_Code );
+  /* Send the request to the partitions it lies on. */
+  DL_Transfer( Aggregate, Starting_Sector, Sectors_To_Read, Buffer, FALSE, Error_Code );
 
   FEATURE_FUNCTION_EXIT("DL_Read")
 
@@ -3398,6 +3224,9 @@ static BOOLEAN  _System Eliminate_Bad_Aggregates( ADDRESS Object, TAG ObjectTag,
 
   }
 
+  /* All of the partitions in the LinkArray have been found, so we can build the map used to translate LSNs. */
+  Build_Link_Map( LinkTable );
+
   /* Lets calculate the size of the Aggregate. */
   LVM_Common_Services->ForEachItem(Aggregate->Feature_Data->Partitions, &Calculate_Aggregate_Size, &(Aggregate->Partition_Size), TRUE, Error_Code);
 
@@ -4100,14 +3929,8 @@ static BOOLEAN _System Load_Feature_Data(Partition_Data * PartitionRecord, Drive
 static BOOLEAN Feature_Data_Is_Valid( BOOLEAN Primary )
 {
 
-  CARDINAL32                       Sector_Count;
   LVM_Link_Table_First_Sector *    First_Sector;
-  LVM_Link_Table_Sector *          Next_Sector;
   ADDRESS                          Buffer;
-  CARDINAL32                       Offset;
-  CARDINAL32                       Old_CRC;
-  CARDINAL32                       Calculated_CRC;
-  CARDINAL32                       Sequence_Count;
 
   FEATURE_FUNCTION_ENTRY("Feature_Data_Is_Valid")
 
@@ -4117,118 +3940,37 @@ static BOOLEAN Feature_Data_Is_Valid( BOOLEAN Primary )
   else
     Buffer = &Feature_Data_Buffer2;
 
-  /* Validate each sector of data contained in the buffer. */
-  for ( Sector_Count = 1; Sector_Count < DRIVE_LINKING_RESERVED_SECTOR_COUNT; Sector_Count++)
+  /* Check the signature, CRC, and sequence number of every sector in the link table at once.  The last reserved sector is not part
+     of the link table.                                                                                                           */
+  if ( LVM_Common_Services->Validate_Feature_Sectors( Buffer,
+                                                      DRIVE_LINKING_RESERVED_SECTOR_COUNT - 1,
+                                                      LINK_TABLE_MASTER_SIGNATURE,
+                                                      LINK_TABLE_SIGNATURE,
+                                                      NULL ) != DRIVE_LINKING_RESERVED_SECTOR_COUNT - 1 )
   {
 
-    /* The first sector is different than the ones that follow it.  Handle it separately. */
-    if ( Sector_Count == 1)
-    {
-
-      /* Find the location of the first sector in the buffer. */
-      First_Sector = (LVM_Link_Table_First_Sector *) Buffer;
-
-      /* Check the signature. */
-      if ( First_Sector->Link_Table_Signature != LINK_TABLE_MASTER_SIGNATURE )
-      {
-
-        LOG_FEATURE_ERROR("The link table master signature is invalid!  The feature data is not valid!")
-
-        FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
+    LOG_FEATURE_ERROR("The link table signature, CRC, or sequence count is invalid!  The feature data is not valid!")
 
-        /* The data in the buffer is not valid! */
-        return FALSE;
-
-      }
-
-      /* Check the Links_In_Use field.  It must be smaller than the maximum number of links allowed. */
-      if ( First_Sector->Links_In_Use >= MAXIMUM_LINKS )
-      {
+    FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
 
-        LOG_FEATURE_ERROR("The links in use count is invalid!  The feature data is not valid!")
-
-        FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
-
-        /* The data in the buffer is not valid! */
-        return FALSE;
-
-      }
-
-      /* Check the CRC. */
-      Old_CRC = First_Sector->Link_Table_CRC;
-      First_Sector->Link_Table_CRC = 0;
-
-      Calculated_CRC = LVM_Common_Services->CalculateCRC( LVM_Common_Services->Initial_CRC, First_Sector, BYTES_PER_SECTOR);
-
-      if ( Calculated_CRC != Old_CRC )
-      {
-
-        LOG_FEATURE_ERROR("The CRC of the feature data is invalid!  The feature data is not valid!")
-
-        FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
-
-        /* The data in the buffer is not valid! */
-        return FALSE;
-
-      }
-
-      /* Save the Sequence_Count.  All of the remaining sectors must have the same sequence count! */
-      Sequence_Count = First_Sector->Sequence_Number;
-
-    }
-    else
-    {
-
-      /* Locate the next sector within the buffer. */
-      Offset = BYTES_PER_SECTOR * ( Sector_Count - 1 );
-      Next_Sector = (LVM_Link_Table_Sector *) Buffer;
-      Next_Sector = (LVM_Link_Table_Sector *) ( (CARDINAL32) Next_Sector + Offset );
-
-      /* Check the signature. */
-      if ( Next_Sector->Link_Table_Signature != LINK_TABLE_SIGNATURE )
-      {
-
-        LOG_FEATURE_ERROR("The link table signature is invalid!  The feature data is not valid!")
-
-        FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
-
-        /* The data in the buffer is not valid! */
-        return FALSE;
-
-      }
-
-      /* Check the CRC. */
-      Old_CRC = Next_Sector->Link_Table_CRC;
-      Next_Sector->Link_Table_CRC = 0;
-
-      Calculated_CRC = LVM_Common_Services->CalculateCRC( LVM_Common_Services->Initial_CRC, Next_Sector, BYTES_PER_SECTOR);
-
-      if ( Calculated_CRC != Old_CRC )
-      {
-
-        LOG_FEATURE_ERROR("The link table CRC is invalid!  The feature data is not valid!")
-
-        FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
-
-        /* The data in the buffer is not valid! */
-        return FALSE;
-
-      }
+    /* The data in the buffer is not valid! */
+    return FALSE;
 
-      /* Check the Sequence Number. */
-      if ( Next_Sector->Sequence_Number != Sequence_Count )
-      {
+  }
 
-        LOG_FEATURE_ERROR("The link table sequence count is invalid!  The feature data is not valid!")
+  /* Find the location of the first sector in the buffer. */
+  First_Sector = (LVM_Link_Table_First_Sector *) Buffer;
 
-        FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
+  /* Check the Links_In_Use field.  It must be smaller than the maximum number of links allowed. */
+  if ( First_Sector->Links_In_Use >= MAXIMUM_LINKS )
+  {
 
-        /* The data in the buffer is not valid! */
-        return FALSE;
+    LOG_FEATURE_ERROR("The links in use count is invalid!  The feature data is not valid!")
 
-      }
+    FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
 
-    }
+    /* The data in the buffer is not valid! */
+    return FALSE;
 
   }
 
@@ -4664,6 +4406,9 @@ static void _System Initialize_DL_Partitions(ADDRESS Object, TAG ObjectTag, CARD
   LinkTable->Links_In_Use++;
   LinkTable->ChangesMade = TRUE;
 
+  /* The aggregate has grown, so update the map used to translate LSNs. */
+  Build_Link_Map( LinkTable );
+
   /* Indicate success and return. */
   *Error_Code = DLIST_SUCCESS;
 
@@ -6241,6 +5986,9 @@ static void _System Add_Partitions_To_Aggregate( ADDRESS Object, TAG ObjectTag,
   LinkTable->LinkArray[LinkTable->Links_In_Use].Link_Data.Partition_Serial_Number = New_Partition->DLA_Table_Entry.Partition_Serial_Number;
   LinkTable->Links_In_Use += 1;
 
+  /* The aggregate has grown, so update the map used to translate LSNs. */
+  Build_Link_Map( LinkTable );
+
   /* Indicate that changes were made. */
   LinkTable->ChangesMade = TRUE;
 
@@ -7583,3 +7331,204 @@ static void _System Find_Duplicate_ANames( ADDRESS Object, TAG ObjectTag, CARDIN
 
 }
 
+
+static void Build_Link_Map( Drive_Link_Array * LinkTable )
+{
+
+  Partition_Data *  PartitionRecord;
+  CARDINAL32        Index;
+
+  /* Each link starts where the one before it ends.  A link whose partition has not been found yet takes up no space. */
+  LinkTable->Link_Start[0] = 0;
+  for ( Index = 0; Index < LinkTable->Links_In_Use; Index++ )
+  {
+
+    PartitionRecord = LinkTable->LinkArray[Index].PartitionRecord;
+
+    if ( PartitionRecord != NULL )
+      LinkTable->Link_Start[Index + 1] = LinkTable->Link_Start[Index] + PartitionRecord->Usable_Size;
+    else
+      LinkTable->Link_Start[Index + 1] = LinkTable->Link_Start[Index];
+
+  }
+
+  return;
+
+}
+
+
+static void Translate_LSNs( Drive_Link_Array * LinkTable, LSN_Translation_Record * Translations, CARDINAL32 Count )
+{
+
+  CARDINAL32  Index;
+  CARDINAL32  Link = 0;
+  CARDINAL32  Low;
+  CARDINAL32  High;
+  CARDINAL32  Middle;
+  LBA         Sector_LSN;
+
+  for ( Index = 0; Index < Count; Index++ )
+  {
+
+    Sector_LSN = Translations[Index].Sector_LSN;
+
+    /* Is the sector beyond the end of the aggregate? */
+    if ( Sector_LSN >= LinkTable->Link_Start[LinkTable->Links_In_Use] )
+    {
+
+      Translations[Index].PartitionRecord = NULL;
+      Translations[Index].Sector_PSN = 0;
+      continue;
+
+    }
+
+    /* Sectors near each other usually lie in the same partition, so try the link used for the last sector before searching. */
+    if ( ( Sector_LSN < LinkTable->Link_Start[Link] ) || ( Sector_LSN >= LinkTable->Link_Start[Link + 1] ) )
+    {
+
+      /* Find the last link which starts at or before the sector.  Since a link which takes up no space starts where the next
+         link starts, this is always the link containing the sector.                                                           */
+      Low = 0;
+      High = LinkTable->Links_In_Use - 1;
+      while ( Low < High )
+      {
+
+        Middle = ( Low + High + 1 ) / 2;
+
+        if ( LinkTable->Link_Start[Middle] <= Sector_LSN )
+          Low = Middle;
+        else
+          High = Middle - 1;
+
+      }
+
+      Link = Low;
+
+    }
+
+    /* Translate the sector to its address on the drive containing the partition for this link. */
+    Translations[Index].PartitionRecord = LinkTable->LinkArray[Link].PartitionRecord;
+    Translations[Index].Sector_PSN = ( Sector_LSN - LinkTable->Link_Start[Link] ) + Translations[Index].PartitionRecord->Starting_Sector;
+
+  }
+
+  return;
+
+}
+
+
+static void DL_Transfer( Partition_Data * Aggregate, LBA Starting_Sector, CARDINAL32 Sector_Count, ADDRESS Buffer, BOOLEAN Write, CARDINAL32 * Error_Code )
+{
+
+  Drive_Link_Array *         LinkTable = (Drive_Link_Array *) Aggregate->Feature_Data->Data;
+  Partition_Data *           PartitionRecord;
+  LSN_Translation_Record     Translation;
+  Segment_Transfer           Segments[DL_TRANSFER_BATCH];    /* The parts of the request which lie on different partitions. */
+  CARDINAL32                 Segment_Count = 0;
+  CARDINAL32                 Segment_Size;
+  CARDINAL32                 Segment_Error;
+  CARDINAL32                 Translation_Error = LVM_ENGINE_NO_ERROR;
+  BYTE *                     Segment_Buffer = (BYTE *) Buffer;
+
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  Translation.Aggregate = Aggregate;
+  Translation.Sector_LSN = Starting_Sector;
+
+  /* The request may span more than one partition, so send each partition the part of the request which lies on it.  The parts
+     are handed to Transfer_Segments together so that partitions on different drives are read or written at the same time.    */
+  do
+  {
+
+    /* We must find out where the current sector really is. */
+    Translate_LSNs( LinkTable, &Translation, 1 );
+
+    PartitionRecord = Translation.PartitionRecord;
+    if ( PartitionRecord == NULL )
+    {
+
+      if ( LVM_Common_Services->Logging_Enabled )
+      {
+
+        sprintf(LVM_Common_Services->Log_Buffer,"%s failed to find the partition record for the\n     partition where Sector %X (hex) resides!", ( Write ? "DL_Write" : "DL_Read" ), Translation.Sector_LSN);
+        LVM_Common_Services->Write_Log_Buffer();
+
+      }
+
+      Translation_Error = LVM_ENGINE_INTERNAL_ERROR;
+
+      break;
+
+    }
+
+    /* Is the feature data and function table for the next layer on the partition available? */
+    if ( ( PartitionRecord->Feature_Data == NULL ) || ( PartitionRecord->Feature_Data->Function_Table == NULL ) )
+    {
+
+      if ( LVM_Common_Services->Logging_Enabled )
+      {
+
+        sprintf(LVM_Common_Services->Log_Buffer,"%s has encountered a partition with bad feature data!", ( Write ? "DL_Write" : "DL_Read" ) );
+        LVM_Common_Services->Write_Log_Buffer();
+
+      }
+
+      Translation_Error = LVM_ENGINE_BAD_PARTITION;
+
+      break;
+
+    }
+
+    /* How much of what is left of the request lies on this partition? */
+    Segment_Size = PartitionRecord->Usable_Size - ( Translation.Sector_PSN - PartitionRecord->Starting_Sector );
+    if ( Segment_Size > Sector_Count )
+      Segment_Size = Sector_Count;
+
+    if ( ( Segment_Size < Sector_Count ) && LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"The request crosses the end of the partition with handle %X (hex).\n     Sending the first %d (decimal) sectors to that partition.", PartitionRecord->External_Handle, Segment_Size);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    Segments[Segment_Count].PartitionRecord = PartitionRecord;
+    Segments[Segment_Count].Starting_Sector = Translation.Sector_PSN;
+    Segments[Segment_Count].Sector_Count = Segment_Size;
+    Segments[Segment_Count].Buffer = Segment_Buffer;
+    Segment_Count++;
+
+    Translation.Sector_LSN += Segment_Size;
+    Segment_Buffer += Segment_Size * BYTES_PER_SECTOR;
+    Sector_Count -= Segment_Size;
+
+    /* Send the parts found so far to the next layer if there is no room for more, or if this was the last part. */
+    if ( ( Segment_Count == DL_TRANSFER_BATCH ) || ( Sector_Count == 0 ) )
+    {
+
+      LVM_Common_Services->Transfer_Segments( Segments, Segment_Count, Write, &Segment_Error );
+
+      /* Report the first error, but keep going so that as much of the request as possible is done. */
+      if ( ( Segment_Error != LVM_ENGINE_NO_ERROR ) && ( *Error_Code == LVM_ENGINE_NO_ERROR ) )
+        *Error_Code = Segment_Error;
+
+      Segment_Count = 0;
+
+    }
+
+  } while ( Sector_Count > 0 );
+
+  /* If part of the request could not be translated, still do the parts found before it, then report the error. */
+  if ( Translation_Error != LVM_ENGINE_NO_ERROR )
+  {
+
+    if ( Segment_Count > 0 )
+      LVM_Common_Services->Transfer_Segments( Segments, Segment_Count, Write, &Segment_Error );
+
+    *Error_Code = Translation_Error;
+
+  }
+
+  return;
+
+}
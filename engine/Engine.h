@@ -143,6 +143,35 @@ typedef struct {
 void _System Find_Feature_Given_ID(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Find_Feature_By_ID                               */
+/*                                                                   */
+/*   Descriptive Name: Finds the function table of the feature with  */
+/*                     a given feature ID.                           */
+/*                                                                   */
+/*   Input: Find_Feature_Data_Record * Search_Data - The Feature_ID  */
+/*                                     field holds the feature ID to */
+/*                                     look for.                     */
+/*          CARDINAL32 * Error - The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: Search_Data->Function_Table is set to the function      */
+/*           table of the feature, or to NULL if there is no feature */
+/*           with the specified ID.  *Error is set to DLIST_SUCCESS  */
+/*           unless a DLIST error occurred.                          */
+/*                                                                   */
+/*   Error Handling: If a DLIST error occurs, *Error will be set to  */
+/*                   the DLIST error code.                           */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  Uses the index of the Available_Features list.          */
+/*                                                                   */
+/*********************************************************************/
+void Find_Feature_By_ID( Find_Feature_Data_Record * Search_Data, CARDINAL32 * Error );
+
+
 /*********************************************************************/
 /*                                                                   */
 /*   Function Name: Create_Serial_Number                             */
@@ -255,6 +284,98 @@ char * _System Adjust_Name( char * Name );
 BOOLEAN _System Valid_Signature_Sector(Partition_Data * PartitionRecord, LVM_Signature_Sector * Signature_Sector);
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Validate_Feature_Sectors                         */
+/*                                                                   */
+/*   Descriptive Name: Checks the signature, CRC and sequence number */
+/*                     of each sector in a multi-sector table of     */
+/*                     feature data, such as a BBR table or a Drive  */
+/*                     Linking link table.                           */
+/*                                                                   */
+/*   Input: ADDRESS Buffer : The sectors to check.                   */
+/*          CARDINAL32 Sector_Count : The number of sectors in       */
+/*                                    Buffer.                        */
+/*          CARDINAL32 First_Signature : The signature expected in   */
+/*                                       the first sector.           */
+/*          CARDINAL32 Signature : The signature expected in all     */
+/*                                 other sectors.                    */
+/*          BYTE * Valid_Sectors : If not NULL, a bitmap with at     */
+/*                                 least ( Sector_Count + 7 ) / 8    */
+/*                                 bytes.  Bit ( n % 8 ) of byte     */
+/*                                 ( n / 8 ) is set if sector n is   */
+/*                                 valid, and cleared otherwise.     */
+/*                                                                   */
+/*   Output: The number of valid sectors.  The table is valid if     */
+/*           this is equal to Sector_Count.                          */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects:  None.  Unlike the checks this replaces, the CRC  */
+/*                  field of each sector is left untouched.          */
+/*                                                                   */
+/*   Notes:  Each sector must begin with a 32 bit signature, a 32    */
+/*           bit CRC and a 32 bit sequence number, in that order.    */
+/*           The CRC of a sector is calculated with its CRC field set*/
+/*           to 0.  A sector is valid if its signature and CRC are   */
+/*           correct and its sequence number matches that of the     */
+/*           first sector.                                           */
+/*                                                                   */
+/*********************************************************************/
+CARDINAL32 _System Validate_Feature_Sectors( ADDRESS     Buffer,
+                                             CARDINAL32  Sector_Count,
+                                             CARDINAL32  First_Signature,
+                                             CARDINAL32  Signature,
+                                             BYTE *      Valid_Sectors );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Transfer_Segments                                */
+/*                                                                   */
+/*   Descriptive Name: Reads or writes a set of pieces of a request, */
+/*                     each on a partition of an aggregate, with the */
+/*                     pieces on different drives in progress at the */
+/*                     same time.                                    */
+/*                                                                   */
+/*   Input: Segment_Transfer * Segments : The pieces to transfer.    */
+/*          CARDINAL32 Segment_Count : The number of entries in      */
+/*                                     Segments.                     */
+/*          BOOLEAN Write : TRUE to write the pieces, FALSE to read  */
+/*                          them.                                    */
+/*          CARDINAL32 * Error_Code : The address of a CARDINAL32 in */
+/*                                    which to store an error code   */
+/*                                    should an error occur.         */
+/*                                                                   */
+/*   Output: The Error_Code field of each entry in Segments holds the*/
+/*           result for that piece.  *Error_Code is                  */
+/*           LVM_ENGINE_NO_ERROR if every piece was transferred, and */
+/*           the error of the first piece which failed otherwise.    */
+/*                                                                   */
+/*   Error Handling: A failure of one piece does not stop the others.*/
+/*                                                                   */
+/*   Side Effects:  Data may be read from or written to disk.        */
+/*                                                                   */
+/*   Notes:  A piece is started without waiting for it when the      */
+/*           layer below it on its partition is Pass Thru, or BBR    */
+/*           with none of the sectors in the piece relocated.  All   */
+/*           other pieces are sent to the Read or Write function of  */
+/*           their partition while the started pieces are in         */
+/*           progress.  A started piece which fails is done again    */
+/*           with the Read or Write function of its partition so     */
+/*           that the error is reported the usual way.               */
+/*                                                                   */
+/*           Each piece must be on a different partition, or on a   */
+/*           different part of the same partition, from all of the   */
+/*           others.                                                 */
+/*                                                                   */
+/*********************************************************************/
+void _System Transfer_Segments( Segment_Transfer *  Segments,
+                                CARDINAL32          Segment_Count,
+                                BOOLEAN             Write,
+                                CARDINAL32 *        Error_Code );
+
+
 /*********************************************************************/
 /*                                                                   */
 /*   Function Name:                                                  */
@@ -297,22 +418,30 @@ void _System Load_Feature_Information_Array2(ADDRESS Object, TAG ObjectTag, CARD
 
 /*********************************************************************/
 /*                                                                   */
-/*   Function Name:                                                  */
+/*   Function Name: Feature_Sequence_Number_Key                      */
 /*                                                                   */
-/*   Descriptive Name:                                               */
+/*   Descriptive Name: Returns the sequence number of a feature as a */
+/*                     sort key for SortListByKey.                   */
 /*                                                                   */
-/*   Input:                                                          */
+/*   Input: ADDRESS Object : The Feature_Application_Data of the     */
+/*                           feature.                                */
+/*          TAG ObjectTag : Should be FEATURE_APPLICATION_DATA_TAG.  */
+/*          CARDINAL32 ObjectSize : Not used.                        */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
 /*                                                                   */
-/*   Output:                                                         */
+/*   Output: The Feature_Sequence_Number of the feature.             */
 /*                                                                   */
-/*   Error Handling:                                                 */
+/*   Error Handling: *Error is set to DLIST_CORRUPTED if ObjectTag   */
+/*                   is not what it should be.                       */
 /*                                                                   */
 /*   Side Effects:  None.                                            */
 /*                                                                   */
-/*   Notes:  None.                                                   */
+/*   Notes:  Used to put a features list in the order in which the   */
+/*           features should be applied.                             */
 /*                                                                   */
 /*********************************************************************/
-INTEGER32 _System Sort_By_Feature_Sequence_Number( ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag, CARDINAL32 * Error);
+CARDINAL32 _System Feature_Sequence_Number_Key( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, CARDINAL32 * Error);
 
 
 /*********************************************************************/
@@ -440,6 +569,7 @@ CARDINAL32                 Boot_Drive_Serial_Number = 0;              /* The ser
 ADDRESS                    Boot_Manager_Handle = NULL;                /* Set to the External_Handle of the Partition containing Boot Manager. */
 BOOLEAN                    Boot_Manager_Active = FALSE;               /* Set to TRUE if an active copy of Boot Manager is found. */
 CARDINAL32                 Min_Free_Space_Size = 2048;                /* A block of free space must be at least this big in order for the engine to report it. */
+CARDINAL32                 Partition_Alignment = 2048;                /* Partitions created with the Aligned allocation algorithm start and end on a multiple of this many sectors. */
 BOOLEAN                    Merlin_Mode = FALSE;                       /* Used to track whether or not we are running under a release of OS/2 prior to Aurora (i.e. Merlin). */
 CARDINAL32                 Reserved_Drive_Letters = 0;                /* Used to track the drive letters assigned to non-lvm devices. */
 ADDRESS                    Common_Services;                           /* Used to hold the list of services provided by the LVM Engine to LVM Plug-in modules. */
@@ -475,6 +605,7 @@ extern CARDINAL32                 Boot_Drive_Serial_Number;  /* The serial numbe
 extern ADDRESS                    Boot_Manager_Handle;       /* Set to the External_Handle of the Partition containing Boot Manager. */
 extern BOOLEAN                    Boot_Manager_Active;       /* Set to TRUE if an active copy of Boot Manager is found. */
 extern CARDINAL32                 Min_Free_Space_Size;       /* A block of free space must be at least this big in order for the engine to report it. */
+extern CARDINAL32                 Partition_Alignment;       /* Partitions created with the Aligned allocation algorithm start and end on a multiple of this many sectors. */
 extern BOOLEAN                    Merlin_Mode;               /* Used to track whether or not we are running under a release of OS/2 prior to Aurora (i.e. Merlin). */
 extern CARDINAL32                 Reserved_Drive_Letters;    /* Used to track the drive letters assigned to non-lvm devices. */
 extern ADDRESS                    Common_Services;           /* Used to hold the list of services provided by the LVM Engine to LVM Plug-in modules. */
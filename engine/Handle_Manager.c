@@ -34,13 +34,20 @@
  * Description: This module provides a uniform way for creating a handle
  *              and associating it with something.
  *
- * Notes: This module makes use of DLIST.
+ * Notes: Handles are kept in a table of slots.  A handle holds the
+ *        index of its slot in its low order bits and the generation
+ *        of that slot in its high order bits, masked with HANDLE_MASK.
+ *        The generation of a slot is changed every time the slot is
+ *        freed, so a handle which has been destroyed no longer matches
+ *        its slot even after the slot has been reused.  This allows
+ *        Translate_Handle to reject a stale or bogus handle with a
+ *        bounds check and a compare instead of following it.
  *
  */
 
-#include <stdlib.h>           /* NULL */
+#include <stdlib.h>           /* NULL, realloc */
 #include "gbltypes.h"         /* ADDRESS, CARDINAL32 */
-#include "dlist.h"            /* TAG, InsertObject, GetObject, GetTag, GoToSpecifiedItem, GoToEndOfList, CreateList, GetHandle, DeleteItem */
+#include "dlist.h"            /* TAG */
 #include "Handle_Manager.h"   /* Included to ensure that Handle_Manager.C and Handle_Manager.H are consistent. */
 
 #ifdef DEBUG
@@ -58,23 +65,45 @@
  --------------------------------------------------*/
  #define HANDLE_MASK  0xFC257107
 
+/* A handle is ( Generation << HANDLE_INDEX_BITS ) | Index, masked with HANDLE_MASK. */
+#define HANDLE_INDEX_BITS        16
+#define HANDLE_INDEX_MASK        0x0000FFFF
+#define HANDLE_GENERATION_MASK   0x0000FFFF
+
+#define MAXIMUM_HANDLE_SLOTS     0x00010000     /* The number of slots which can be addressed by HANDLE_INDEX_BITS. */
+#define INITIAL_HANDLE_SLOTS     64             /* The number of slots allocated by Initialize_Handle_Manager.  The table doubles in size as needed. */
+#define NO_FREE_SLOT             0xFFFFFFFF     /* Marks the end of the chain of free slots. */
+
 
 
 /*--------------------------------------------------
- * There are no private Type definitions
+ * Private Type definitions
  --------------------------------------------------*/
+typedef struct _Handle_Slot {
+                               ADDRESS     Object;        /* The object associated with the handle using this slot. */
+                               TAG         ObjectTag;     /* The TAG of Object. */
+                               CARDINAL32  ObjectSize;    /* The size of Object. */
+                               CARDINAL32  Generation;    /* Changed each time the slot is freed so that old handles for this slot no longer match. */
+                               CARDINAL32  Next_Free;     /* If the slot is not in use, the index of the next free slot. */
+                               BOOLEAN     In_Use;        /* TRUE if a handle is currently using this slot. */
+                             } Handle_Slot;
 
 
 
 /*--------------------------------------------------
  * Private Global Variables.
  --------------------------------------------------*/
-DLIST  Handles = (DLIST) NULL;           /* Used to create, track, translate, and destroy handles. */
+static Handle_Slot *  Handle_Table = NULL;               /* Used to create, track, translate, and destroy handles. */
+static CARDINAL32     Handle_Table_Size = 0;             /* The number of slots in Handle_Table. */
+static CARDINAL32     First_Free_Slot = NO_FREE_SLOT;    /* The index of the first slot in the chain of free slots. */
 
 
 /*--------------------------------------------------
- * There are no private functions.
+ * Private functions.
  --------------------------------------------------*/
+static BOOLEAN       Grow_Handle_Table( void );
+static Handle_Slot * Find_Handle_Slot( ADDRESS Handle );
+static void          Free_Handle_Slot( CARDINAL32 Index );
 
 
 /*--------------------------------------------------
@@ -113,7 +142,7 @@ BOOLEAN Initialize_Handle_Manager(void)
 {
 
   /* Has the Handle Manager already been initialized? */
-  if ( Handles != NULL )
+  if ( Handle_Table != NULL )
   {
 
     /* The Handle Manager has already been initialized!  Nothing to do. */
@@ -121,24 +150,8 @@ BOOLEAN Initialize_Handle_Manager(void)
 
   }
 
-  /* Create the Handles list. */
-  Handles = CreateList();
-
-  /* Did we succeed? */
-  if ( Handles == NULL )
-  {
-
-    /* We could not create the Handles list.  We are probably out of memory! */
-
-    /* Report the error. */
-    return FALSE;
-
-  }
-
-  /* The Handle Manager has been initialized. */
-
-  /* Indicate success. */
-  return TRUE;
+  /* Create the Handle_Table.  If we fail, we are probably out of memory! */
+  return Grow_Handle_Table();
 
 }
 
@@ -171,64 +184,55 @@ BOOLEAN Initialize_Handle_Manager(void)
 /*                                                                   */
 /*   Side Effects: A new handle may be created.                      */
 /*                                                                   */
-/*   Notes:  None.                                                   */
+/*   Notes:  HANDLE_MANAGER_OUT_OF_MEMORY is also returned if        */
+/*           MAXIMUM_HANDLE_SLOTS handles are already in use.        */
 /*                                                                   */
 /*********************************************************************/
 ADDRESS _System Create_Handle( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, CARDINAL32 * Error_Code )
 {
 
-  ADDRESS ReturnValue = NULL;    /* Used to hold the Handle that will be returned by this function. */
+  CARDINAL32     Index;         /* The index of the slot used for the new handle. */
+  Handle_Slot *  Slot;          /* The slot used for the new handle. */
 
-  /* Has the Handles list been created yet? */
-  if ( Handles == NULL )
+  /* Has the Handle_Table been created yet? */
+  if ( Handle_Table == NULL )
   {
 
-    /* There is no handle list, which means that this module has not been initialized yet! */
+    /* There is no Handle_Table, which means that this module has not been initialized yet! */
     *Error_Code = HANDLE_MANAGER_NOT_INITIALIZED;
 
     return NULL;
 
   }
 
-  /* Since the Handles list exists, lets add the object and get a handle for it. */
-  ReturnValue = InsertObject(Handles,ObjectSize,Object,ObjectTag,NULL, AppendToList, FALSE, Error_Code);
-
-  /* Was the item successfully added? */
-  if ( *Error_Code != DLIST_SUCCESS )
+  /* Are there any free slots left?  If not, make room for more. */
+  if ( ( First_Free_Slot == NO_FREE_SLOT ) && ( ! Grow_Handle_Table() ) )
   {
 
-    /* Set *Error_Code to a value defined for the Handle Manager. */
-    if ( *Error_Code != DLIST_OUT_OF_MEMORY )
-    {
-
-#ifdef DEBUG
-
-#ifdef PARANOID
-
-      assert(0);
-
-#endif
+    *Error_Code = HANDLE_MANAGER_OUT_OF_MEMORY;
 
-#endif
-
-      *Error_Code = HANDLE_MANAGER_INTERNAL_ERROR;
-
-    }
-    else
-    {
+    return NULL;
 
-      *Error_Code = HANDLE_MANAGER_OUT_OF_MEMORY;
+  }
 
-    }
+  /* Take the first slot off of the free chain. */
+  Index = First_Free_Slot;
+  Slot = &(Handle_Table[Index]);
+  First_Free_Slot = Slot->Next_Free;
 
-    return NULL;
+  /* A handle of 0 is never returned.  If this generation of the slot would produce one, skip to the next generation. */
+  if ( ( ( Slot->Generation << HANDLE_INDEX_BITS ) | Index ) == ( CARDINAL32 ) HANDLE_MASK )
+    Slot->Generation = ( Slot->Generation + 1 ) & HANDLE_GENERATION_MASK;
 
-  }
+  Slot->Object = Object;
+  Slot->ObjectTag = ObjectTag;
+  Slot->ObjectSize = ObjectSize;
+  Slot->In_Use = TRUE;
 
   /* Indicate success and return! */
   *Error_Code = HANDLE_MANAGER_NO_ERROR;
 
-  return ( ADDRESS ) ( ( CARDINAL32 ) ReturnValue ^ ( CARDINAL32 ) HANDLE_MASK );
+  return ( ADDRESS ) ( ( ( Slot->Generation << HANDLE_INDEX_BITS ) | Index ) ^ ( CARDINAL32 ) HANDLE_MASK );
 
 }
 
@@ -261,47 +265,46 @@ ADDRESS _System Create_Handle( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectS
 void _System Destroy_Handle( ADDRESS Handle, CARDINAL32 * Error_Code )
 {
 
-  /* Has the Handles list been created yet? */
-  if ( Handles == NULL )
+  Handle_Slot *  Slot;          /* The slot used by Handle. */
+
+  /* Has the Handle_Table been created yet? */
+  if ( Handle_Table == NULL )
   {
 
-    /* There is no handle list, which means that this module has not been initialized yet! */
+    /* There is no Handle_Table, which means that this module has not been initialized yet! */
     *Error_Code = HANDLE_MANAGER_NOT_INITIALIZED;
 
     return;
 
   }
 
-
-  /* Unmask Handle. */
-  Handle = ( ADDRESS ) ( ( CARDINAL32 ) Handle ^ ( CARDINAL32 ) HANDLE_MASK);
-
-  /* Each handle represents an item in the Handles list.  */
-
-  /* Delete this item from the list, and its handle will no longer be valid. */
-  DeleteItem(Handles,FALSE,Handle,Error_Code);
+  /* Each handle represents a slot in the Handle_Table.  */
+  Slot = Find_Handle_Slot( Handle );
 
 #ifdef DEBUG
 
 #ifdef PARANOID
 
-  assert(*Error_Code == DLIST_SUCCESS);
+  assert( Slot != NULL );
 
-#else
+#endif
 
-  /* Was there an error. */
-  if ( *Error_Code != DLIST_SUCCESS )
+#endif
+
+  /* Was Handle valid? */
+  if ( Slot == NULL )
   {
 
-      *Error_Code = HANDLE_MANAGER_INTERNAL_ERROR;
+    *Error_Code = HANDLE_MANAGER_BAD_HANDLE;
 
     return;
 
   }
 
-#endif
+  /* Free the slot, and its handle will no longer be valid. */
+  Free_Handle_Slot( Slot - Handle_Table );
 
-#endif
+  *Error_Code = HANDLE_MANAGER_NO_ERROR;
 
   return;
 
@@ -329,51 +332,49 @@ void _System Destroy_Handle( ADDRESS Handle, CARDINAL32 * Error_Code )
 /*                                                                   */
 /*   Side Effects: All handles may be eliminated.                    */
 /*                                                                   */
-/*   Notes:  None.                                                   */
+/*   Notes:  The Handle_Table keeps its size so that it does not     */
+/*           have to grow again when the engine is next opened.      */
 /*                                                                   */
 /*********************************************************************/
 void Destroy_All_Handles( CARDINAL32 * Error_Code )
 {
 
-  /* Has the Handles list been created yet? */
-  if ( Handles == NULL )
+  CARDINAL32  Index;        /* Used to walk the Handle_Table. */
+
+  /* Has the Handle_Table been created yet? */
+  if ( Handle_Table == NULL )
   {
 
-    /* There is no handle list, which means that this module has not been initialized yet! */
+    /* There is no Handle_Table, which means that this module has not been initialized yet! */
     *Error_Code = HANDLE_MANAGER_NOT_INITIALIZED;
 
     return;
 
   }
 
-  /* Now delete all entries in the Handle list. */
-  DeleteAllItems( Handles, FALSE, Error_Code );
-
-  /* Did we succeed? */
-  if ( *Error_Code != DLIST_SUCCESS )
+  /* Free every slot which is in use, and rebuild the free chain so that the lowest slots are used first. */
+  First_Free_Slot = NO_FREE_SLOT;
+  for ( Index = Handle_Table_Size; Index > 0; Index-- )
   {
 
-#ifdef DEBUG
-
-#ifdef PARANOID
+    if ( Handle_Table[Index - 1].In_Use )
+    {
 
-    assert(0);
+      Free_Handle_Slot( Index - 1 );
 
-#endif
+    }
+    else
+    {
 
-#endif
+      Handle_Table[Index - 1].Next_Free = First_Free_Slot;
+      First_Free_Slot = Index - 1;
 
-    /* We have an internal error! */
-    *Error_Code = HANDLE_MANAGER_INTERNAL_ERROR;
+    }
 
   }
-  else
-  {
-
-    /* Indicate success. */
-    *Error_Code = HANDLE_MANAGER_NO_ERROR;
 
-  }
+  /* Indicate success. */
+  *Error_Code = HANDLE_MANAGER_NO_ERROR;
 
   return;
 
@@ -407,102 +408,203 @@ void Destroy_All_Handles( CARDINAL32 * Error_Code )
 /*           If there is a failure, *Error will contain a non-zero   */
 /*              error code.                                          */
 /*                                                                   */
-/*   Error Handling: *Error_Code will be non-zero if a recoverable   */
-/*                   error occurs.  If Handle is invalid, then a     */
-/*                   trap or exception may occur.                    */
+/*   Error Handling: *Error_Code will be HANDLE_MANAGER_BAD_HANDLE   */
+/*                   if Handle was never created or has already been */
+/*                   destroyed.                                      */
 /*                                                                   */
-/*   Side Effects: If Handle is invalid, a trap or exception may     */
-/*                 occur.                                            */
+/*   Side Effects: None.                                             */
 /*                                                                   */
-/*   Notes:  None.                                                   */
+/*   Notes:  The Handle Manager is not changed by this function, so  */
+/*           a translation can be done while another is in progress. */
 /*                                                                   */
 /*********************************************************************/
 void _System Translate_Handle( ADDRESS Handle, ADDRESS * Object, TAG * ObjectTag, CARDINAL32 * Error_Code )
 {
 
-  CARDINAL32   ItemSize;      /* Used with the GetTag function. */
+  Handle_Slot *  Slot;          /* The slot used by Handle. */
 
+  /* Has the Handle_Table been created yet? */
+  if ( Handle_Table == NULL )
+  {
 
-  /* To translate a handle, we need to get the object associated with the handle from the Handles list.  To do that, we need to :
+    /* There is no Handle_Table, which means that this module has not been initialized yet! */
+    *Error_Code = HANDLE_MANAGER_NOT_INITIALIZED;
 
-      1.  Make the item associated with Handle the current item in the Handles list.
-      2.  Get the ItemSize and TAG
-      3.  Get the Item itself.
+    return;
 
-  */
+  }
 
+  /* Find the slot used by Handle. */
+  Slot = Find_Handle_Slot( Handle );
 
-  /* Has the Handles list been created yet? */
-  if ( Handles == NULL )
+  /* Was Handle valid? */
+  if ( Slot == NULL )
   {
 
-    /* There is no handle list, which means that this module has not been initialized yet! */
-    *Error_Code = HANDLE_MANAGER_NOT_INITIALIZED;
+    *Error_Code = HANDLE_MANAGER_BAD_HANDLE;
 
     return;
 
   }
 
-  /* Unmask Handle. */
-  Handle = ( ADDRESS ) ( ( CARDINAL32 ) Handle ^ ( CARDINAL32 ) HANDLE_MASK);
+  *Object = Slot->Object;
+  *ObjectTag = Slot->ObjectTag;
+
+  /* Signal success. */
+  *Error_Code = HANDLE_MANAGER_NO_ERROR;
 
-  /* Before we can get the item, we must get its size and TAG. */
-  *ObjectTag = GetTag(Handles, Handle, &ItemSize, Error_Code);
+  return;
 
-#ifdef DEBUG
+}
 
-#ifdef PARANOID
 
-  assert(*Error_Code == DLIST_SUCCESS);
+/*--------------------------------------------------
+ * Private Functions Available
+ --------------------------------------------------*/
 
-#else
 
-  /* Was there an error? */
-  if ( *Error_Code != DLIST_SUCCESS )
-  {
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Grow_Handle_Table                                */
+/*                                                                   */
+/*   Descriptive Name: Creates the Handle_Table, or doubles its size */
+/*                     if it already exists.                         */
+/*                                                                   */
+/*   Input: None.                                                    */
+/*                                                                   */
+/*   Output: The function return value will be TRUE if the new       */
+/*           slots were added to the free chain, FALSE otherwise.    */
+/*                                                                   */
+/*   Error Handling: If memory can not be allocated, or the          */
+/*                   Handle_Table already has MAXIMUM_HANDLE_SLOTS   */
+/*                   slots, the Handle_Table is not changed.         */
+/*                                                                   */
+/*   Side Effects: The Handle_Table may be moved.                    */
+/*                                                                   */
+/*   Notes:  This is only called when there are no free slots.       */
+/*                                                                   */
+/*********************************************************************/
+static BOOLEAN Grow_Handle_Table( void )
+{
 
-    /* We have some kind of internal error here as this should not have failed! */
-    *Error_Code = HANDLE_MANAGER_INTERNAL_ERROR;
+  Handle_Slot *  New_Table;     /* The new Handle_Table. */
+  CARDINAL32     New_Size;      /* The number of slots in New_Table. */
+  CARDINAL32     Index;         /* Used to initialize the new slots. */
 
-    return;
+  /* Can the Handle_Table grow any further? */
+  if ( Handle_Table_Size >= MAXIMUM_HANDLE_SLOTS )
+    return FALSE;
 
-  }
+  if ( Handle_Table_Size == 0 )
+    New_Size = INITIAL_HANDLE_SLOTS;
+  else
+    New_Size = Handle_Table_Size * 2;
 
-#endif
+  if ( New_Size > MAXIMUM_HANDLE_SLOTS )
+    New_Size = MAXIMUM_HANDLE_SLOTS;
 
-#endif
+  New_Table = (Handle_Slot *) realloc( Handle_Table, New_Size * sizeof(Handle_Slot) );
+  if ( New_Table == NULL )
+    return FALSE;
 
-  /* Now we can use the TAG and ItemSize we just got to retrieve the current item. */
-  *Object = GetObject(Handles, ItemSize, *ObjectTag, Handle, FALSE, Error_Code);
+  /* Chain the new slots together, lowest index first, and put them on the free chain. */
+  for ( Index = Handle_Table_Size; Index < New_Size; Index++ )
+  {
 
-#ifdef DEBUG
+    New_Table[Index].Object = NULL;
+    New_Table[Index].ObjectTag = 0;
+    New_Table[Index].ObjectSize = 0;
+    New_Table[Index].Generation = 0;
+    New_Table[Index].Next_Free = Index + 1;
+    New_Table[Index].In_Use = FALSE;
 
-#ifdef PARANOID
+  }
 
-  assert(*Error_Code == DLIST_SUCCESS);
+  New_Table[New_Size - 1].Next_Free = First_Free_Slot;
+  First_Free_Slot = Handle_Table_Size;
 
-#else
+  Handle_Table = New_Table;
+  Handle_Table_Size = New_Size;
 
-  /* Was there an error? */
-  if ( *Error_Code != DLIST_SUCCESS )
-  {
+  return TRUE;
 
-    /* We have some kind of internal error here as this should not have failed! */
-    *Error_Code = HANDLE_MANAGER_INTERNAL_ERROR;
+}
 
-    return;
 
-  }
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Find_Handle_Slot                                 */
+/*                                                                   */
+/*   Descriptive Name: Finds the slot in the Handle_Table used by a  */
+/*                     handle.                                       */
+/*                                                                   */
+/*   Input: ADDRESS Handle : The handle whose slot is to be found.   */
+/*                                                                   */
+/*   Output: The address of the slot used by Handle, or NULL if      */
+/*           Handle is not currently valid.                          */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  A handle is only valid if its index is within the       */
+/*           Handle_Table, its slot is in use, and its generation    */
+/*           matches the generation of its slot.                     */
+/*                                                                   */
+/*********************************************************************/
+static Handle_Slot * Find_Handle_Slot( ADDRESS Handle )
+{
 
-#endif
+  CARDINAL32     Handle_Value;  /* Handle with HANDLE_MASK removed. */
+  CARDINAL32     Index;         /* The index of the slot used by Handle. */
 
-#endif
+  /* Unmask Handle. */
+  Handle_Value = ( CARDINAL32 ) Handle ^ ( CARDINAL32 ) HANDLE_MASK;
 
-  /* Signal success. */
-  *Error_Code = HANDLE_MANAGER_NO_ERROR;
+  Index = Handle_Value & HANDLE_INDEX_MASK;
 
-  return;
+  if ( ( Index >= Handle_Table_Size ) ||
+       ( ! Handle_Table[Index].In_Use ) ||
+       ( Handle_Table[Index].Generation != ( ( Handle_Value >> HANDLE_INDEX_BITS ) & HANDLE_GENERATION_MASK ) )
+     )
+    return NULL;
+
+  return &(Handle_Table[Index]);
 
 }
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Free_Handle_Slot                                 */
+/*                                                                   */
+/*   Descriptive Name: Returns a slot to the free chain.             */
+/*                                                                   */
+/*   Input: CARDINAL32 Index : The index of the slot to free.        */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: Any handle using the slot is no longer valid.     */
+/*                                                                   */
+/*   Notes:  The generation of the slot wraps after 65536 handles    */
+/*           have used it, at which point a very old handle for the  */
+/*           slot could match again.                                 */
+/*                                                                   */
+/*********************************************************************/
+static void Free_Handle_Slot( CARDINAL32 Index )
+{
+
+  Handle_Slot *  Slot = &(Handle_Table[Index]);
+
+  Slot->Object = NULL;
+  Slot->ObjectTag = 0;
+  Slot->ObjectSize = 0;
+  Slot->Generation = ( Slot->Generation + 1 ) & HANDLE_GENERATION_MASK;
+  Slot->In_Use = FALSE;
+
+  Slot->Next_Free = First_Free_Slot;
+  First_Free_Slot = Index;
+
+}
@@ -35,7 +35,8 @@
  * Description: This module provides a uniform way for creating a handle
  *              and associating it with something.
  *
- * Notes: This module makes use of DLIST.
+ * Notes: Handles are generation checked, so a handle which has been
+ *        destroyed is rejected by Translate_Handle.
  *
  */
 
@@ -0,0 +1,4739 @@
+/*
+ *
+ *   Copyright (c) International Business Machines  Corp., 2000
+ *
+ *   This program is free software;  you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY;  without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ *   the GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program;  if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Module: Mirroring.c
+ */
+
+/*
+ * Change History:
+ *
+ */
+
+/*
+ * Description: This module implements the mirroring feature, an aggregate
+ *              class feature which combines two or more partitions into
+ *              a single aggregate.  Each partition holds a complete copy
+ *              of the data in the aggregate.  Writes are sent to every
+ *              copy, while each read is sent to only one copy, so the
+ *              aggregate survives the loss of all but one of its
+ *              partitions, and reads may be spread across all of them.
+ *
+ * Notes: Each partition in a mirrored aggregate is called a member.  The
+ *        members of an aggregate all contribute the same number of sectors
+ *        (Member_Size) to the aggregate, so the smallest partition given to
+ *        Create_Mirror_Volume determines the size of the aggregate.  The
+ *        mirror table is followed by one bitmap sector for each member, and
+ *        two copies of the table and bitmaps are kept on each member, just
+ *        as Drive Linking does with its link table.
+ *
+ *        A member which misses a write, either because the write failed or
+ *        because the member is missing, has the regions covered by the
+ *        write marked as stale in its bitmap.  Stale regions are never
+ *        read, and are copied from an up to date member when the changes
+ *        to the aggregate are committed.  Only the stale regions are copied,
+ *        so a member which missed a few writes is brought up to date
+ *        quickly.
+ *
+ */
+
+#include <stdlib.h>   /* malloc, free, atol */
+#include <stdio.h>    /* sprintf */
+#include <string.h>   /* strlen */
+
+#include "engine.h"   /* Included for access to the global types and variables. */
+#include "diskio.h"   /*  */
+
+#define NEED_BYTE_DEFINED
+#include "gbltypes.h" /* CARDINAL32, BYTE, BOOLEAN, ADDRESS */
+
+#include "LVM_Data.h"
+
+#include "LVM_Interface.h"
+
+#include "LVM_Constants.h"   /* PARTITION_NAME_SIZE, VOLUME_NAME_SIZE, DISK_NAME_SIZE, BYTES_PER_SECTOR */
+
+#include "LVM_PLUG.h"
+
+#include "Mirroring_Feature.h"
+
+#include "Mirroring.h"
+
+
+#ifdef DEBUG
+
+#ifdef PARANOID
+
+#include <assert.h>   /* assert */
+
+#endif
+
+#endif
+
+
+/*--------------------------------------------------
+ * Private Constants
+ --------------------------------------------------*/
+#define UNEXPECTED_END_OF_INPUT "Unexpected end of input!  Expecting ')'."
+#define CLOSE_PAREN_EXPECTED "Error!  Mirroring does not accept any options.  A ')' is expected here!"
+
+#define MIRROR_RESYNC_SECTORS  128       /* The largest transfer used when copying a stale region from one member to another. */
+#define MIRROR_MINIMUM_SPLIT   128       /* The smallest part of a read that is given to a member of its own. */
+
+/*--------------------------------------------------
+ * Private Type definitions
+ --------------------------------------------------*/
+typedef struct _Extended_Mirror_Member {
+                                         Mirror_Member    Member_Data;
+                                         Partition_Data * PartitionRecord;
+                                         LBA              Next_Sector;          /* The sector following the last one transferred to or from this member.  Used to balance reads. */
+                                       } Extended_Mirror_Member;
+
+typedef struct _Mirror_Array {
+                               CARDINAL32               Members_In_Use;
+                               Extended_Mirror_Member   MemberArray[MAXIMUM_MIRROR_MEMBERS];
+                               CARDINAL32               Member_Size;          /* The number of sectors on each member, which is also the size of the aggregate. */
+                               CARDINAL32               Region_Size;          /* The number of sectors covered by each bit in Stale_Regions. */
+                               BYTE                     Stale_Regions[MAXIMUM_MIRROR_MEMBERS][MIRROR_BITMAP_SIZE];
+                               CARDINAL32               Last_Member_Read;     /* Used to break ties when balancing reads. */
+                               CARDINAL32               Sequence_Number;
+                               BOOLEAN                  ChangesMade;
+                               CARDINAL32               Aggregate_Serial_Number;
+                               LVM_Classes              Actual_Class;
+                               CARDINAL32               Feature_Sequence_Number;
+                               BOOLEAN                  Top_Of_Class;
+                               CARDINAL32               Fake_EBR_Size;
+                               ADDRESS                  Fake_EBR_Buffer;
+                             } Mirror_Array;
+
+typedef struct _Aggregate_Search_Record {
+                                          Partition_Data *   PartitionRecord;
+                                          Mirror_Array *     MirrorTable;
+                                          BOOLEAN            Aggregate_Found;
+                                        } Aggregate_Search_Record;
+
+typedef struct _Aggregate_Validation_Record {
+                                              DLIST        Partition_List;
+                                              BOOLEAN      Volume_Created;
+                                              CARDINAL32 * Error_Code;
+                                            } Aggregate_Validation_Record;
+
+typedef struct _Partition_Deletion_Record {
+                                            CARDINAL32      LVM_Error;
+                                            BOOLEAN         Kill_Partitions;
+                                          } Partition_Deletion_Record;
+
+typedef struct _Commit_Changes_Record {
+
+                                        BOOLEAN  Commit_Mirroring_Changes;      /* If TRUE, then the mirror table was changed and needs to be written to disk. */
+                                        ADDRESS  VData;                         /* The address of the volume data.  This will be passed through to the next layer needing to do a commit. */
+                                      } Commit_Changes_Record;
+
+typedef struct _PassThru_Data_Record {
+                                       CARDINAL32   Feature_ID;
+                                       ADDRESS      Aggregate;
+                                       ADDRESS      InputBuffer;
+                                       CARDINAL32   InputSize;
+                                       ADDRESS *    OutputBuffer;
+                                       CARDINAL32 * OutputSize;
+                                       CARDINAL32 * Error_Code;
+                                     } PassThru_Data_Record;
+
+typedef struct _Drive_Check_Record {
+                                     CARDINAL32   Drive_Serial_Numbers[MAXIMUM_MIRROR_MEMBERS];
+                                     CARDINAL32   Drives_Seen;
+                                     BOOLEAN      Drive_Shared;
+                                   } Drive_Check_Record;
+
+/*--------------------------------------------------
+ * Private Global Variables.
+ --------------------------------------------------*/
+static BYTE                       Feature_Data_Buffer1[BYTES_PER_SECTOR * MIRRORING_RESERVED_SECTOR_COUNT ];
+static BYTE                       Feature_Data_Buffer2[BYTES_PER_SECTOR * MIRRORING_RESERVED_SECTOR_COUNT ];
+static BYTE                       Fake_EBR_Buffer[BYTES_PER_SECTOR];
+static DLIST                      Aggregate_List = NULL;
+static Plugin_Function_Table_V1   Function_Table;
+static LVM_Common_Services_V1  *  LVM_Common_Services;
+static Feature_ID_Data            Feature_ID_Record;
+
+
+/*--------------------------------------------------
+ * Private functions.
+ --------------------------------------------------*/
+static void     _System Create_Aggregates( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters,  CARDINAL32 * Error_Code);
+static BOOLEAN  _System Eliminate_Bad_Aggregates( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize,  ADDRESS ObjectHandle, ADDRESS Parameters, BOOLEAN * FreeMemory, CARDINAL32 * Error_Code);
+static void     _System Remove_Features_From_Aggregate_Partitions( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize,  ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error_Code);
+static BOOLEAN  _System Delete_Partitions( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize,  ADDRESS ObjectHandle, ADDRESS Parameters, BOOLEAN * FreeMemory, CARDINAL32 * Error_Code);
+static void     _System Find_Existing_Aggregate(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize,  ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error_Code);
+static void     _System Write_Feature_Data(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize,  ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error_Code);
+static BOOLEAN          Feature_Data_Is_Valid( ADDRESS Buffer );
+static CARDINAL32       Member_Drive_Serial_Number( Partition_Data * PartitionRecord );
+static void     _System Find_Smallest_Member(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize,  ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error_Code);
+static void     _System Find_Shared_Drives(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize,  ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error_Code);
+static void     _System Initialize_Mirror_Partitions(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize,  ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error_Code);
+static void     _System Set_Spanned_Volume_Flag(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize,  ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
+static void             Discard_Aggregate( Partition_Data * Aggregate );
+static void     _System Discover_Mirrors( DLIST  Partition_List, CARDINAL32 * Error_Code );
+static void     _System Create_Mirror_Volume( DLIST Partition_List,
+                                              ADDRESS VData,
+                                              ADDRESS Init_Data,
+                                              void (* _System Create_and_Configure) ( CARDINAL32 ID, ADDRESS InputBuffer, CARDINAL32 InputBufferSize, ADDRESS * OutputBuffer, CARDINAL32 * OutputBufferSize, CARDINAL32 * Error_Code),
+                                              LVM_Classes  Actual_Class,
+                                              BOOLEAN      Top_Of_Class,
+                                              CARDINAL32   Sequence_Number,
+                                              CARDINAL32 * Error_Code );
+static void     _System Open_Feature( CARDINAL32 * Error_Code );
+static void     _System Close_Feature( void );
+static BOOLEAN  _System Can_Expand_Mirror_Volume( ADDRESS AData, CARDINAL32 * Feature_ID, CARDINAL32 * Error_Code );
+static void     _System Add_Mirror_Partition ( ADDRESS AData, DLIST New_Partitions, CARDINAL32 * Error_Code );
+static void     _System Delete_Mirror_Partition( ADDRESS AData, BOOLEAN Kill_Partitions, CARDINAL32 * Error_Code);
+static void     _System Commit_Mirroring_Changes( ADDRESS VData, ADDRESS PData, CARDINAL32 * Error_Code );
+static void     _System Mirror_Write( ADDRESS PData, LBA Starting_Sector, CARDINAL32 Sectors_To_Write, ADDRESS Buffer, CARDINAL32 * Error_Code);
+static void     _System Mirror_Read( ADDRESS PData, LBA Starting_Sector, CARDINAL32 Sectors_To_Read, ADDRESS Buffer, CARDINAL32 * Error_Code);
+static void     _System Remove_Features(ADDRESS Aggregate, CARDINAL32 * Error_Code);
+static void     _System ReturnCurrentClass( ADDRESS PartitionRecord, LVM_Classes * Actual_Class, BOOLEAN * Top_Of_Class, CARDINAL32 * Sequence_Number );
+static void     _System PassThru( CARDINAL32 Feature_ID, ADDRESS Aggregate, ADDRESS InputBuffer, CARDINAL32 InputSize, ADDRESS * OutputBuffer, CARDINAL32 * OutputSize, CARDINAL32 * Error_Code );
+static BOOLEAN  _System Load_Feature_Data(Partition_Data * PartitionRecord, Mirror_Array * MirrorTable, CARDINAL32 * Error_Code);
+static void     _System Continue_PassThru(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize,  ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error_Code);
+static void     _System Continue_Changes_Pending(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize,  ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error_Code);
+static BOOLEAN  _System Claim_Aggregate_Partitions( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize,  ADDRESS ObjectHandle, ADDRESS Parameters, BOOLEAN * FreeMemory, CARDINAL32 * Error_Code);
+static BOOLEAN  _System Mirror_ChangesPending(Partition_Data * PartitionRecord, CARDINAL32 * Error_Code);
+static void     _System Mirror_ParseCommandLineArguments(DLIST Token_List, LVM_Classes * Actual_Class, ADDRESS * Init_Data, char ** Error_Message, CARDINAL32 * Error_Code );
+static LVM_Token *      GetToken(DLIST Token_List, BOOLEAN CurrentToken, CARDINAL32 * Error_Code);
+static BOOLEAN          Member_Is_Available( Mirror_Array * MirrorTable, CARDINAL32 Member );
+static BOOLEAN          Region_Is_Stale( Mirror_Array * MirrorTable, CARDINAL32 Member, CARDINAL32 Region );
+static BOOLEAN          Member_Is_Current( Mirror_Array * MirrorTable, CARDINAL32 Member, LBA Starting_Sector, CARDINAL32 Sector_Count );
+static void             Mark_Stale_Regions( Mirror_Array * MirrorTable, CARDINAL32 Member, LBA Starting_Sector, CARDINAL32 Sector_Count );
+static void             Resync_Stale_Regions( Mirror_Array * MirrorTable, CARDINAL32 * Error_Code );
+static void             Read_Mirror_Members( Partition_Data * Aggregate, LBA Starting_Sector, CARDINAL32 Sector_Count, ADDRESS Buffer, CARDINAL32 * Error_Code );
+static void             Write_Mirror_Members( Partition_Data * Aggregate, LBA Starting_Sector, CARDINAL32 Sector_Count, ADDRESS Buffer, CARDINAL32 * Error_Code );
+
+
+
+/*--------------------------------------------------
+ * There are no additional public global variables
+ * beyond those declared in "engine.h".
+ --------------------------------------------------*/
+
+
+
+/*--------------------------------------------------
+ * Public Functions Available
+ --------------------------------------------------*/
+
+static void _System Discover_Mirrors( DLIST  Partition_List, CARDINAL32 * Error_Code )
+{
+
+  CARDINAL32                    Dlist_Error;
+  Aggregate_Validation_Record   Validation_Record;
+  BOOLEAN                       Aggregates_Created = FALSE;
+
+  FEATURE_FUNCTION_ENTRY("Discover_Mirrors")
+
+  /* Is logging active? */
+  if ( LVM_Common_Services->Logging_Enabled )
+  {
+
+    if ( ( Partition_List == NULL ) || ( Error_Code == NULL) )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Discover_Mirrors has been invoked with one or more NULL pointers!\n     Partition_List is %X (hex)\n     Error_Code is %X (hex)", Partition_List, Error_Code);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+  }
+
+  /* Assume success. */
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  /* We must look at each item in the partitions list.  This includes reading in and validating the feature data. */
+  LVM_Common_Services->ForEachItem( Partition_List, &Create_Aggregates, Error_Code, TRUE, &Dlist_Error);
+
+  /* Did we succeed? */
+  if ( *Error_Code != LVM_ENGINE_NO_ERROR )
+  {
+
+    if ( LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"PruneList failed while creating aggregates.\n     LVM error code %d (decimal)", *Error_Code);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    FEATURE_FUNCTION_EXIT("Discover_Mirrors")
+
+    return;
+
+  }
+
+  if ( Dlist_Error != DLIST_SUCCESS )
+  {
+
+    if ( LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"PruneList failed while creating aggregates.\n     DLIST error code %d (decimal)", Dlist_Error);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    if ( Dlist_Error != DLIST_OUT_OF_MEMORY )
+      *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+    else
+      *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    FEATURE_FUNCTION_EXIT("Discover_Mirrors")
+
+    return;
+
+  }
+
+  /* Now we must eliminate any incomplete Aggregates. */
+  Validation_Record.Partition_List = Partition_List;
+  Validation_Record.Volume_Created = FALSE;
+  Validation_Record.Error_Code = Error_Code;
+
+  /* Find and eliminate incomplete aggregates. */
+  LVM_Common_Services->PruneList( Aggregate_List, &Eliminate_Bad_Aggregates, &Validation_Record, &Dlist_Error);
+
+  /* Did we succeed? */
+  if ( ( *Error_Code != LVM_ENGINE_NO_ERROR ) && ( *Error_Code != LVM_ENGINE_PLUGIN_OPERATION_INCOMPLETE ) )
+  {
+
+    if ( LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"PruneList failed while eliminating bad aggregates.\n     LVM error code %d (decimal)", *Error_Code);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    FEATURE_FUNCTION_EXIT("Discover_Mirrors")
+
+    return;
+
+  }
+
+
+  if ( Dlist_Error != DLIST_SUCCESS )
+  {
+
+    if ( LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"PruneList failed while eliminating bad aggregates.\n     DLIST error code %d (decimal)", Dlist_Error);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    if ( Dlist_Error != DLIST_OUT_OF_MEMORY )
+      *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+    else
+      *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    FEATURE_FUNCTION_EXIT("Discover_Mirrors")
+
+    return;
+
+  }
+
+  /* Are there any complete aggregates in the Aggregate_List? */
+  if ( LVM_Common_Services->GetListSize(Aggregate_List, &Dlist_Error) == 0 )
+  {
+
+    if ( Dlist_Error != DLIST_SUCCESS )
+    {
+
+      *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+      FEATURE_FUNCTION_EXIT("Discover_Mirrors")
+
+      return;
+
+    }
+
+  }
+  else
+    Aggregates_Created = TRUE;
+
+  /* Now we must add the list of Aggregates to the List of Partitions. */
+  LVM_Common_Services->AppendList(Partition_List, Aggregate_List, &Dlist_Error);
+
+  /* Did we succeed? */
+  if ( Dlist_Error != DLIST_SUCCESS )
+  {
+
+    if ( LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"AppendList failed with DLIST error code %d (decimal)", Dlist_Error);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    if ( Dlist_Error != DLIST_OUT_OF_MEMORY )
+      *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+    else
+      *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    FEATURE_FUNCTION_EXIT("Discover_Mirrors")
+
+    return;
+
+  }
+
+  /* Indicate success and return. */
+
+  /* Were any aggregates created? */
+  if ( Aggregates_Created )
+    *Error_Code = LVM_ENGINE_NO_ERROR;                    /* At least 1 aggregate was created! */
+  else
+    *Error_Code = LVM_ENGINE_PLUGIN_OPERATION_INCOMPLETE; /* No aggregates could be created! */
+
+  FEATURE_FUNCTION_EXIT("Discover_Mirrors")
+
+  return;
+
+}
+
+
+static void _System Open_Feature( CARDINAL32 * Error_Code )
+{
+
+  FEATURE_FUNCTION_ENTRY("Open_Feature")
+
+  /* Is logging active? */
+  if ( LVM_Common_Services->Logging_Enabled )
+  {
+
+    if ( Aggregate_List != NULL )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Open_Feature has been invoked on mirroring, \n     but mirroring is already open!");
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    if ( Error_Code == NULL )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Open_Feature for mirroring has been invoked with a NULL pointer!\n     Error_Code is %X (hex)", Error_Code);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+  }
+
+  if ( Aggregate_List == NULL )
+  {
+
+    /* Initialize the Aggregate_List. */
+    Aggregate_List = LVM_Common_Services->CreateList();
+
+    if ( Aggregate_List == NULL )
+    {
+
+      if ( LVM_Common_Services->Logging_Enabled )
+      {
+
+        sprintf(LVM_Common_Services->Log_Buffer,"Unable to create the Aggregate_List.  Out of memory!");
+        LVM_Common_Services->Write_Log_Buffer();
+
+      }
+
+      *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    }
+    else
+      *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  }
+  else
+    *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  FEATURE_FUNCTION_EXIT("Open_Feature")
+
+  return;
+
+}
+
+
+static void _System Close_Feature( void )
+{
+
+  CARDINAL32  LocalError;
+
+  FEATURE_FUNCTION_ENTRY("Close_Feature")
+
+  /* Free up the memory associated with the global variable Aggregate_List. */
+  if ( Aggregate_List != NULL )
+    LVM_Common_Services->DestroyList(&Aggregate_List,TRUE, &LocalError);
+
+  FEATURE_FUNCTION_EXIT("Close_Feature")
+
+  return;
+
+}
+
+
+static BOOLEAN _System Can_Expand_Mirror_Volume( ADDRESS AData, CARDINAL32 * Feature_ID, CARDINAL32 * Error_Code )
+{
+
+  Partition_Data *   Aggregate = (Partition_Data *) AData;
+
+  FEATURE_FUNCTION_ENTRY("Can_Expand_Mirror_Volume")
+
+  /* Is logging active? */
+  if ( LVM_Common_Services->Logging_Enabled )
+  {
+
+    if ( ( AData == NULL ) || ( Error_Code == NULL) )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Can_Expand_Mirror_Volume has been invoked with one or more NULL pointers!\n     AData is %X (hex)\n     Error_Code is %X (hex)", AData, Error_Code);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+    else
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,
+              "Can_Expand_Mirror_Volume has been invoked with the following parameters.\n     The partition specified has handle %X (hex)\n      Error_Code is at address %X (hex)",
+              Aggregate->External_Handle,
+              Error_Code);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+  }
+
+  /* Set the Feature_ID. */
+  *Feature_ID = MIRRORING_FEATURE_ID;
+
+  /* Every member of a mirrored aggregate holds all of the data in the aggregate, so adding a member would not make the aggregate
+     any larger.  Mirrored aggregates can therefore not be expanded.                                                              */
+  LOG_FEATURE_EVENT("The volume can NOT be expanded!")
+
+  /* Indicate success and return. */
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  FEATURE_FUNCTION_EXIT("Can_Expand_Mirror_Volume")
+
+  return FALSE;
+
+}
+
+
+static void _System Add_Mirror_Partition ( ADDRESS AData, DLIST New_Partitions, CARDINAL32 * Error_Code )
+{
+
+  FEATURE_FUNCTION_ENTRY("Add_Mirror_Partition")
+
+  /* Since Can_Expand_Mirror_Volume always returns FALSE, we should never be asked to add partitions to a mirrored aggregate. */
+  LOG_FEATURE_ERROR("Add_Mirror_Partition was called, but mirrored aggregates can not be expanded!")
+
+  *Error_Code = LVM_ENGINE_OPERATION_NOT_ALLOWED;
+
+  FEATURE_FUNCTION_EXIT("Add_Mirror_Partition")
+
+  return;
+
+}
+
+
+static void _System Delete_Mirror_Partition( ADDRESS AData, BOOLEAN Kill_Partitions, CARDINAL32 * Error_Code)
+{
+
+  Partition_Data *           Aggregate = (Partition_Data *) AData;
+  CARDINAL32                 Dlist_Error;
+  Partition_Deletion_Record  Deletion_Data;
+  Mirror_Array *             MirrorTable;
+
+  FEATURE_FUNCTION_ENTRY("Delete_Mirror_Partition")
+
+  /* Is logging active? */
+  if ( LVM_Common_Services->Logging_Enabled )
+  {
+
+    if ( ( AData == NULL ) || ( Error_Code == NULL) )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Delete_Mirror_Partition has been invoked with one or more NULL pointers!\n     AData is %X (hex)\n     Error_Code is %X (hex)", AData, Error_Code);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+    else
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,
+              "Delete_Mirror_Partition has been invoked with the following parameters.\n     The Volume specified has handle %X (hex)\n     Kill_Partitions is %X (hex)\n     Error_Code is at address %X (hex)",
+              Aggregate->Volume_Handle,
+              Kill_Partitions,
+              Error_Code);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+  }
+
+  /* Does this partition have an LVM Signature Sector? */
+  if ( Aggregate->Signature_Sector != NULL )
+  {
+
+    if ( LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Killing the LVM Signature Sector of the Aggregate.");
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    /* Now free the memory. */
+    memset(Aggregate->Signature_Sector,0, BYTES_PER_SECTOR);
+    LVM_Common_Services->Deallocate(Aggregate->Signature_Sector);
+
+  }
+
+  /* Remove the Aggregate from the list of Aggregates. */
+  LVM_Common_Services->DeleteItem(LVM_Common_Services->Aggregates, FALSE, Aggregate->Drive_Partition_Handle, &Dlist_Error);
+  if ( Dlist_Error != DLIST_SUCCESS )
+  {
+
+    if ( LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"DeleteItem failed while removing an aggregate from the list of aggregates.\n     The DLIST Error code is %d (decimal)", Dlist_Error);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+    FEATURE_FUNCTION_EXIT("Delete_Mirror_Partition")
+
+    return;
+
+  }
+
+  /* Since this is an aggregate, we must walk the Partitions list and delete each of the Partitions which comprise this aggregate. */
+  Deletion_Data.LVM_Error = LVM_ENGINE_NO_ERROR;
+  Deletion_Data.Kill_Partitions = Kill_Partitions;
+
+  if ( LVM_Common_Services->Logging_Enabled )
+  {
+
+    sprintf(LVM_Common_Services->Log_Buffer,"Deleting the partitions which formed the Aggregate.");
+    LVM_Common_Services->Write_Log_Buffer();
+
+  }
+
+  LVM_Common_Services->PruneList(Aggregate->Feature_Data->Partitions, &Delete_Partitions, &Deletion_Data, &Dlist_Error);
+
+  if ( ( Dlist_Error != DLIST_SUCCESS ) && ( Deletion_Data.LVM_Error != LVM_ENGINE_NO_ERROR ) )
+  {
+
+    if ( LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"PruneList failed while deleting partitions.\n     The LVM Error code is %d (decimal)\n     The DLIST Error code is %d (decimal)", *Error_Code, Dlist_Error);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+    FEATURE_FUNCTION_EXIT("Delete_Mirror_Partition")
+
+    return;
+
+  }
+
+  /* Now free the memory. */
+  LVM_Common_Services->DestroyList(&(Aggregate->Feature_Data->Partitions), FALSE, &Dlist_Error);
+  if ( Dlist_Error != DLIST_SUCCESS )
+  {
+
+    if ( LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"DestroyList failed with DLIST error %d (decimal)", Dlist_Error);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+    FEATURE_FUNCTION_EXIT("Delete_Mirror_Partition")
+
+    return;
+
+  }
+
+  /* We must see if there is anything in the mirror table to delete. */
+
+  /* Get the mirror table. */
+  MirrorTable = Aggregate->Feature_Data->Data;
+
+  /* Is there a Fake EBR associated with this aggregate? */
+  if ( MirrorTable->Fake_EBR_Buffer != NULL )
+  {
+
+    /* Free the fake EBR. */
+    LVM_Common_Services->Deallocate(MirrorTable->Fake_EBR_Buffer);
+
+  }
+
+  /* Now free the mirror table. */
+  LVM_Common_Services->Deallocate(Aggregate->Feature_Data->Data);
+
+  /* Now free the feature data. */
+  LVM_Common_Services->Deallocate(Aggregate->Feature_Data);
+
+  /* Free the aggregate's external handle. */
+  LVM_Common_Services->Destroy_Handle(Aggregate->External_Handle, Error_Code);
+  if ( *Error_Code != HANDLE_MANAGER_NO_ERROR )
+  {
+
+    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+    FEATURE_FUNCTION_EXIT("Delete_Mirror_Partition")
+
+    return;
+
+  }
+
+  /* Now we can free the aggregate. */
+  LVM_Common_Services->Deallocate(Aggregate);
+
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  FEATURE_FUNCTION_EXIT("Delete_Mirror_Partition")
+
+  return;
+
+}
+
+
+
+static void _System Create_Mirror_Volume( DLIST Partition_List,
+                                          ADDRESS VData,
+                                          ADDRESS Init_Data,
+                                          void (* _System Create_and_Configure) ( CARDINAL32 ID, ADDRESS InputBuffer, CARDINAL32 InputBufferSize, ADDRESS * OutputBuffer, CARDINAL32 * OutputBufferSize, CARDINAL32 * Error_Code),
+                                          LVM_Classes  Actual_Class,  /* Tells the feature what class it is being used in on this volume.  Useful for features that can be in multiple classes. */
+                                          BOOLEAN      Top_Of_Class,  /* TRUE if this feature is the topmost feature in its class.  The topmost aggregator must only turn out 1 aggregate! */
+                                          CARDINAL32   Sequence_Number,
+                                          CARDINAL32 * Error_Code )
+{
+
+  Partition_Data *              Aggregate;
+  Volume_Data *                 VolumeRecord = (Volume_Data*) VData;
+  LVM_Signature_Sector *        Signature_Sector;
+  Mirror_Array *                MirrorTable;
+  CARDINAL32                    Ignore_Error;
+  CARDINAL32                    Partition_Count;
+  CARDINAL32                    Smallest_Member = 0xFFFFFFFFL;
+  CARDINAL32                    Member_Size;
+  Drive_Check_Record            Drive_Check;
+
+
+  FEATURE_FUNCTION_ENTRY("Create_Mirror_Volume")
+
+  /* Is logging active? */
+  if ( LVM_Common_Services->Logging_Enabled )
+  {
+
+    if ( ( Partition_List == NULL ) || ( VData == NULL ) || ( Error_Code == NULL) )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Create_Mirror_Volume has been invoked with one or more NULL pointers!\n     Partition_List is %X (hex)\n     VData is %X (hex)\n     Error_Code is %X (hex)", Partition_List, VData, Error_Code);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    if ( Actual_Class != Aggregate_Class )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Create_Mirror_Volume has been invoked with an invalid class!");
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+  }
+
+  if ( Actual_Class != Aggregate_Class )
+  {
+
+    LOG_FEATURE_ERROR("The wrong LVM Class was specified for this feature!")
+
+    *Error_Code = LVM_ENGINE_WRONG_CLASS_FOR_FEATURE;
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+  /* How many partitions are in the Partition_List? */
+  Partition_Count = LVM_Common_Services->GetListSize(Partition_List, Error_Code);
+  if ( *Error_Code != LVM_ENGINE_NO_ERROR )
+  {
+
+    LOG_FEATURE_ERROR("Unable to get the size of the Partition_List!")
+
+    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+  /* Mirroring needs at least two members, and the mirror table has room for only MAXIMUM_MIRROR_MEMBERS. */
+  if ( Partition_Count < 2 )
+  {
+
+    LOG_FEATURE_ERROR("A mirrored aggregate requires at least two partitions!")
+
+    *Error_Code = LVM_ENGINE_OPERATION_NOT_ALLOWED;
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+  if ( Partition_Count > MAXIMUM_MIRROR_MEMBERS )
+  {
+
+    LOG_FEATURE_ERROR("Too many partitions were specified for a mirrored aggregate!")
+
+    *Error_Code = LVM_ENGINE_TOO_MANY_PARTITIONS_SPECIFIED;
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+  /* A mirror only protects against the loss of a drive if its members are on different drives. */
+  Drive_Check.Drives_Seen = 0;
+  Drive_Check.Drive_Shared = FALSE;
+  LVM_Common_Services->ForEachItem(Partition_List, &Find_Shared_Drives, &Drive_Check, TRUE, Error_Code);
+  if ( *Error_Code != DLIST_SUCCESS )
+  {
+
+    LOG_FEATURE_EVENT1("ForEachItem failed while checking the drives of the partitions!", "DLIST Error", *Error_Code)
+
+    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+  if ( Drive_Check.Drive_Shared )
+  {
+
+    LOG_FEATURE_ERROR("The members of a mirrored aggregate must be on different drives!")
+
+    *Error_Code = LVM_ENGINE_OPERATION_NOT_ALLOWED;
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+  /* Every member holds a copy of the whole aggregate, so the smallest partition sets the size of the aggregate.  Find it before
+     anything is changed so that we can fail cleanly if the partitions are too small.                                              */
+  LVM_Common_Services->ForEachItem(Partition_List, &Find_Smallest_Member, &Smallest_Member, TRUE, Error_Code);
+  if ( *Error_Code != DLIST_SUCCESS )
+  {
+
+    LOG_FEATURE_EVENT1("ForEachItem failed while sizing the partitions!", "DLIST Error", *Error_Code)
+
+    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+  /* Each member loses two copies of the mirror table and bitmaps. */
+  if ( Smallest_Member > 2 * MIRRORING_RESERVED_SECTOR_COUNT )
+    Member_Size = Smallest_Member - 2 * MIRRORING_RESERVED_SECTOR_COUNT;
+  else
+    Member_Size = 0;
+
+  /* The aggregate must also have room for its own LVM Signature Sector and, if we are the topmost aggregator, the fake EBR track. */
+  if ( Member_Size <= 1 + SYNTHETIC_SECTORS_PER_TRACK )
+  {
+
+    LOG_FEATURE_EVENT1("The partitions are too small to be mirrored!", "Smallest partition", Smallest_Member)
+
+    *Error_Code = LVM_ENGINE_PARTITION_TOO_SMALL;
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+  /* Allocate memory for the new Aggregate. */
+  Aggregate = (Partition_Data *) LVM_Common_Services->Allocate( sizeof(Partition_Data) );
+  if ( Aggregate == NULL )
+  {
+
+    LOG_FEATURE_ERROR("Unable to allocate memory for a new Aggregate!")
+
+    *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+  memset(Aggregate,0,sizeof(Partition_Data));
+
+  /* Allocate memory for Feature_Data. */
+  Aggregate->Feature_Data = ( Feature_Context_Data * ) LVM_Common_Services->Allocate ( sizeof( Feature_Context_Data ) );
+  if ( Aggregate->Feature_Data == NULL )
+  {
+
+    LOG_FEATURE_ERROR("Unable to allocate memory for the feature data of the new Aggregate!")
+
+    LVM_Common_Services->Deallocate(Aggregate);
+
+    *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+  /* Initialize the Feature_Data. */
+  memset( Aggregate->Feature_Data, 0, sizeof (Feature_Context_Data) );
+  Aggregate->Feature_Data->Feature_ID = &Feature_ID_Record;
+  Aggregate->Feature_Data->Function_Table = &Function_Table;
+  Aggregate->Feature_Data->Data = NULL;
+  Aggregate->Feature_Data->Partitions = NULL;
+  Aggregate->Feature_Data->Old_Context = NULL;
+
+  /* Allocate the Mirror Array for the Aggregate. */
+  Aggregate->Feature_Data->Data = LVM_Common_Services->Allocate( sizeof( Mirror_Array ) );
+  if ( Aggregate->Feature_Data->Data == NULL )
+  {
+
+    LOG_FEATURE_ERROR("Unable to allocate memory for a new mirror array!")
+
+    LVM_Common_Services->Deallocate(Aggregate->Feature_Data);
+    LVM_Common_Services->Deallocate(Aggregate);
+
+    *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+  memset( Aggregate->Feature_Data->Data, 0, sizeof( Mirror_Array ) );
+  MirrorTable = Aggregate->Feature_Data->Data;
+
+  /* Allocate the Partitions list which is part of the Feature Data. */
+  Aggregate->Feature_Data->Partitions = LVM_Common_Services->CreateList();
+  if ( Aggregate->Feature_Data->Partitions == NULL )
+  {
+
+    LOG_FEATURE_ERROR("Unable to allocate memory for a new partition list!")
+
+    LVM_Common_Services->Deallocate(Aggregate->Feature_Data->Data);
+    LVM_Common_Services->Deallocate(Aggregate->Feature_Data);
+    LVM_Common_Services->Deallocate(Aggregate);
+
+    *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+  /* We must allocate an LVM Signature Sector for the Aggregate. */
+  Aggregate->Signature_Sector = ( LVM_Signature_Sector * ) LVM_Common_Services->Allocate( BYTES_PER_SECTOR );
+  if ( Aggregate->Signature_Sector == NULL )
+  {
+
+    LOG_FEATURE_ERROR("Insufficient memory to create an LVM Signature Sector!")
+
+    LVM_Common_Services->DestroyList(&(Aggregate->Feature_Data->Partitions),FALSE, &Ignore_Error );
+    LVM_Common_Services->Deallocate(Aggregate->Feature_Data->Data);
+    LVM_Common_Services->Deallocate(Aggregate->Feature_Data);
+    LVM_Common_Services->Deallocate(Aggregate);
+
+    *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+  /* Initialize the LVM Signature Sector to all 0's. */
+  memset( Aggregate->Signature_Sector, 0, BYTES_PER_SECTOR );
+  Signature_Sector = Aggregate->Signature_Sector;
+
+  /* Move all of the Partitions in the Partition_List to Aggregate->Feature_Data->Partitions. */
+  LVM_Common_Services->AppendList( Aggregate->Feature_Data->Partitions, Partition_List, Error_Code);
+  if ( *Error_Code != DLIST_SUCCESS )
+  {
+
+    if ( *Error_Code == DLIST_OUT_OF_MEMORY )
+    {
+
+      LOG_FEATURE_ERROR("Insufficient memory to process the Partition_List!")
+
+      *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    }
+    else
+    {
+
+      LOG_FEATURE_EVENT1("AppendList failed!", "DLIST error", *Error_Code)
+
+      *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+    }
+
+    LVM_Common_Services->DestroyList(&(Aggregate->Feature_Data->Partitions),FALSE, &Ignore_Error );
+    LVM_Common_Services->Deallocate(Aggregate->Signature_Sector);
+    LVM_Common_Services->Deallocate(Aggregate->Feature_Data->Data);
+    LVM_Common_Services->Deallocate(Aggregate->Feature_Data);
+    LVM_Common_Services->Deallocate(Aggregate);
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+  /* We now have all of the memory we need, and all of the partitions have been moved out of the Partition_List.  Now we
+     can initialize our Aggregate and each of the Partitions that are a part of it.                                         */
+  Aggregate->Partition_Type = Partition;
+  Aggregate->New_Partition = TRUE;
+  Aggregate->Drive_Index = 0xFFFFFFFFL;/* We don't need the drive index as this is not a real partition. */
+  Aggregate->External_Volume_Handle = VolumeRecord->External_Handle;
+  Aggregate->Volume_Handle = VolumeRecord->Volume_Handle;
+  Aggregate->Starting_Sector = 0;
+  Aggregate->Spanned_Volume = TRUE;
+  Aggregate->DLA_Table_Entry.On_Boot_Manager_Menu = FALSE;
+  Aggregate->DLA_Table_Entry.Installable = FALSE;
+  Aggregate->DLA_Table_Entry.Partition_Serial_Number = LVM_Common_Services->Create_Serial_Number();
+  Aggregate->DLA_Table_Entry.Partition_Start = 0;
+  Aggregate->DLA_Table_Entry.Partition_Size = 0;
+  Aggregate->DLA_Table_Entry.Volume_Serial_Number = VolumeRecord->Volume_Serial_Number;
+  Aggregate->DLA_Table_Entry.Drive_Letter = VolumeRecord->Drive_Letter_Preference;
+  strncpy(Aggregate->DLA_Table_Entry.Volume_Name, VolumeRecord->Volume_Name, VOLUME_NAME_SIZE);
+
+  /* Save the serial number of the aggregate and the size of its members in the feature data.  The bitmaps start out clear, as
+     there is nothing on the members yet which could be out of date.                                                             */
+  MirrorTable->Aggregate_Serial_Number = Aggregate->DLA_Table_Entry.Partition_Serial_Number;
+  MirrorTable->Actual_Class = Actual_Class;
+  MirrorTable->Feature_Sequence_Number = Sequence_Number;
+  MirrorTable->Top_Of_Class = Top_Of_Class;
+  MirrorTable->Member_Size = Member_Size;
+  MirrorTable->Region_Size = ( Member_Size + MIRROR_REGION_COUNT - 1 ) / MIRROR_REGION_COUNT;
+
+  LOG_FEATURE_EVENT("Initializing the new partitions.")
+
+  LVM_Common_Services->ForEachItem(Aggregate->Feature_Data->Partitions, &Initialize_Mirror_Partitions, Aggregate, TRUE, Error_Code);
+
+#ifdef DEBUG
+
+#ifdef PARANOID
+
+  assert( ( *Error_Code == DLIST_SUCCESS ) || ( *Error_Code == DLIST_OUT_OF_MEMORY ) );
+
+#else
+
+  if ( ( *Error_Code != DLIST_SUCCESS ) && ( *Error_Code != DLIST_OUT_OF_MEMORY ) )
+  {
+
+    LOG_FEATURE_EVENT1("ForEachItem failed while initializing the new partitions!", "DLIST Error", *Error_Code)
+
+    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+#endif
+
+#endif
+
+  if ( *Error_Code == DLIST_OUT_OF_MEMORY )
+  {
+
+    LOG_FEATURE_ERROR("Insufficient memory to initialize the new partitions!")
+
+    /* Now free everything we can. */
+    LVM_Common_Services->DestroyList(&(Aggregate->Feature_Data->Partitions),FALSE, &Ignore_Error );
+    LVM_Common_Services->Deallocate(Aggregate->Feature_Data->Data);
+    LVM_Common_Services->Deallocate(Aggregate->Feature_Data);
+    LVM_Common_Services->Deallocate(Aggregate->Signature_Sector);
+    LVM_Common_Services->Deallocate(Aggregate);
+
+    *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+  /* Every member holds a copy of the aggregate. */
+  Aggregate->Partition_Size = Member_Size;
+
+  /* Since this is an aggregate, it can not be a primary partition. */
+  Aggregate->Primary_Partition = FALSE;
+
+  /* Initialize the LVM Signature Sector for this aggregate. */
+  Signature_Sector->LVM_Signature1 = LVM_PRIMARY_SIGNATURE;
+  Signature_Sector->LVM_Signature2 = LVM_SECONDARY_SIGNATURE;
+  Signature_Sector->Signature_Sector_CRC = 0;
+  Signature_Sector->Partition_Serial_Number = Aggregate->DLA_Table_Entry.Partition_Serial_Number;
+  Signature_Sector->Partition_Start = 0;
+  Signature_Sector->Partition_End = Aggregate->Partition_Size - 1;
+  Signature_Sector->Partition_Sector_Count = Aggregate->Partition_Size;
+  Signature_Sector->Partition_Size_To_Report_To_User = Aggregate->Partition_Size - 1;                 /* One sector reserved for LVM Signature Sector. */
+  Signature_Sector->LVM_Reserved_Sector_Count = 1;
+  Signature_Sector->Fake_EBR_Location = 0;
+  Signature_Sector->Fake_EBR_Allocated = FALSE;
+  Signature_Sector->Boot_Disk_Serial_Number = *(LVM_Common_Services->Boot_Drive_Serial_Number);
+  Signature_Sector->Volume_Serial_Number = VolumeRecord->Volume_Serial_Number;
+  Signature_Sector->LVM_Major_Version_Number = CURRENT_LVM_MAJOR_VERSION_NUMBER;
+  Signature_Sector->LVM_Minor_Version_Number = CURRENT_LVM_MINOR_VERSION_NUMBER;
+  strncpy(Signature_Sector->Partition_Name, Aggregate->Partition_Name, PARTITION_NAME_SIZE);
+  Signature_Sector->Drive_Letter = VolumeRecord->Drive_Letter_Preference;
+  strncpy(Signature_Sector->Volume_Name, VolumeRecord->Volume_Name, VOLUME_NAME_SIZE);
+
+  /* If mirroring is the topmost aggregator, then it is responsible for allocating the "fake" EBR track. */
+  if ( Top_Of_Class )
+  {
+
+    /* Allocate the "fake" EBR.  This reserves the fake EBR track at the end of the aggregate. */
+    LVM_Common_Services->Create_Fake_EBR( (Extended_Boot_Record **) &(MirrorTable->Fake_EBR_Buffer), &(MirrorTable->Fake_EBR_Size), Signature_Sector, Error_Code);
+    if ( *Error_Code != LVM_ENGINE_NO_ERROR )
+    {
+
+      if ( *Error_Code == LVM_ENGINE_OUT_OF_MEMORY )
+      {
+
+        LOG_FEATURE_ERROR("Insufficient memory to create the fake EBR!")
+
+      }
+      else
+      {
+
+        LOG_FEATURE_ERROR("Internal Error attempting to allocate the fake EBR!")
+
+        *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+      }
+
+      /* Now free everything we can. */
+      LVM_Common_Services->DestroyList(&(Aggregate->Feature_Data->Partitions),FALSE, &Ignore_Error );
+      if ( MirrorTable->Fake_EBR_Buffer != NULL )
+        LVM_Common_Services->Deallocate(MirrorTable->Fake_EBR_Buffer);
+      LVM_Common_Services->Deallocate(Aggregate->Feature_Data->Data);
+      LVM_Common_Services->Deallocate(Aggregate->Feature_Data);
+      LVM_Common_Services->Deallocate(Aggregate->Signature_Sector);
+      LVM_Common_Services->Deallocate(Aggregate);
+
+      FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+      return;
+
+    }
+
+  }
+  else
+  {
+
+    /* Since there is no fake EBR required here, initialize the fake EBR fields in the MirrorTable to NULL. */
+    MirrorTable->Fake_EBR_Size = 0;
+    MirrorTable->Fake_EBR_Buffer = NULL;
+
+  }
+
+  /* Set the usable size of the aggregate. */
+  Aggregate->Usable_Size = Signature_Sector->Partition_Sector_Count - Signature_Sector->LVM_Reserved_Sector_Count;
+
+  /* Create a fake partition record for the aggregate now that we know how much of it the user can have. */
+  if ( Top_Of_Class )
+    LVM_Common_Services->Create_Fake_Partition_Table_Entry( &(Aggregate->Partition_Table_Entry), Aggregate->Usable_Size);
+
+  /* We must add the aggregate to the list of Aggregates maintained by the LVM Engine. */
+  Aggregate->Drive_Partition_Handle = LVM_Common_Services->InsertObject(LVM_Common_Services->Aggregates, sizeof(Partition_Data), Aggregate, PARTITION_DATA_TAG, NULL, AppendToList, FALSE, Error_Code);
+  if ( *Error_Code != DLIST_SUCCESS )
+  {
+
+    if ( *Error_Code == DLIST_OUT_OF_MEMORY )
+    {
+
+      LOG_FEATURE_ERROR("Insufficient memory to add the aggregate to the list of Aggregates!")
+
+      *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    }
+    else
+    {
+
+      LOG_FEATURE_ERROR("Internal Error attempting to add an aggregate to the list of Aggregates!")
+
+      *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+    }
+
+    /* Now free everything we can. */
+    LVM_Common_Services->DestroyList(&(Aggregate->Feature_Data->Partitions),FALSE, &Ignore_Error );
+    if ( MirrorTable->Fake_EBR_Buffer != NULL )
+      LVM_Common_Services->Deallocate(MirrorTable->Fake_EBR_Buffer);
+    LVM_Common_Services->Deallocate(Aggregate->Feature_Data->Data);
+    LVM_Common_Services->Deallocate(Aggregate->Feature_Data);
+    LVM_Common_Services->Deallocate(Aggregate->Signature_Sector);
+    LVM_Common_Services->Deallocate(Aggregate);
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+  /* We must get an external handle for this aggregate. */
+  Aggregate->External_Handle = LVM_Common_Services->Create_Handle( Aggregate, PARTITION_DATA_TAG, sizeof(Partition_Data), Error_Code );
+  if ( *Error_Code != HANDLE_MANAGER_NO_ERROR )
+  {
+
+    if ( *Error_Code == HANDLE_MANAGER_OUT_OF_MEMORY )
+    {
+
+      LOG_FEATURE_ERROR("Insufficient memory to get a handle for the aggregate!")
+
+      *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    }
+    else
+    {
+
+      LOG_FEATURE_ERROR("Internal Error attempting to get a handle from the handle manager!")
+
+      *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+    }
+
+    /* Now free everything we can. */
+    LVM_Common_Services->DestroyList(&(Aggregate->Feature_Data->Partitions),FALSE, &Ignore_Error );
+    LVM_Common_Services->DeleteItem(LVM_Common_Services->Aggregates, FALSE, Aggregate->Drive_Partition_Handle, &Ignore_Error);
+    if ( MirrorTable->Fake_EBR_Buffer != NULL )
+      LVM_Common_Services->Deallocate(MirrorTable->Fake_EBR_Buffer);
+    LVM_Common_Services->Deallocate(Aggregate->Feature_Data->Data);
+    LVM_Common_Services->Deallocate(Aggregate->Feature_Data);
+    LVM_Common_Services->Deallocate(Aggregate->Signature_Sector);
+    LVM_Common_Services->Deallocate(Aggregate);
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+  LOG_FEATURE_EVENT("Aggregate is complete!  Adding it to the Partitions_List list.")
+
+  /* Now put the Aggregate back into the Partitions List so that our caller will find it. */
+  LVM_Common_Services->InsertObject(Partition_List, sizeof(Partition_Data), Aggregate, PARTITION_DATA_TAG, NULL, AppendToList, FALSE, Error_Code);
+  if ( *Error_Code != DLIST_SUCCESS )
+  {
+
+    if ( *Error_Code == DLIST_OUT_OF_MEMORY )
+    {
+
+      LOG_FEATURE_ERROR("InsertObject failed due to lack of memory!")
+
+      *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    }
+    else
+    {
+
+      LOG_FEATURE_ERROR("InsertObject failed while returning the aggregate!")
+
+      *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+    }
+
+    /* Now free everything we can. */
+    LVM_Common_Services->DestroyList(&(Aggregate->Feature_Data->Partitions),FALSE, &Ignore_Error );
+    LVM_Common_Services->DeleteItem(LVM_Common_Services->Aggregates, FALSE, Aggregate->Drive_Partition_Handle, &Ignore_Error);
+    LVM_Common_Services->Destroy_Handle(Aggregate->External_Handle, &Ignore_Error);
+    if ( MirrorTable->Fake_EBR_Buffer != NULL )
+      LVM_Common_Services->Deallocate(MirrorTable->Fake_EBR_Buffer);
+    LVM_Common_Services->Deallocate(Aggregate->Feature_Data->Data);
+    LVM_Common_Services->Deallocate(Aggregate->Feature_Data);
+    LVM_Common_Services->Deallocate(Aggregate->Signature_Sector);
+    LVM_Common_Services->Deallocate(Aggregate);
+
+    FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+    return;
+
+  }
+
+  /* Indicate success and return. */
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  FEATURE_FUNCTION_EXIT("Create_Mirror_Volume")
+
+  return;
+
+}
+
+
+static void _System Mirror_Write( ADDRESS PData, LBA Starting_Sector, CARDINAL32 Sectors_To_Write, ADDRESS Buffer, CARDINAL32 * Error_Code)
+{
+
+  Partition_Data *           Aggregate = (Partition_Data *) PData;
+
+  FEATURE_FUNCTION_ENTRY("Mirror_Write")
+
+  /* Is logging active? */
+  if ( LVM_Common_Services->Logging_Enabled )
+  {
+
+    if ( ( PData == NULL ) || ( Buffer == NULL ) || ( Error_Code == NULL) )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Mirror_Write has been invoked with one or more NULL pointers!\n     PData is %X (hex)\n     Buffer is %X (hex)\n     Error_Code is %X (hex)", PData, Buffer, Error_Code);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+    else
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,
+              "Mirror_Write has been invoked with the following parameters.\n     The partition specified has handle %X (hex)\n     The LBA of the sector to read is %X (hex)\n     The number of sectors to write is %d (decimal)\n     The location of the buffer to read into is %X (hex)\n      Error_Code is at address %X (hex)",
+              Aggregate->External_Handle,
+              Starting_Sector,
+              Sectors_To_Write,
+              Buffer,
+              Error_Code);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+  }
+
+  if ( LVM_Common_Services->Logging_Enabled )
+  {
+
+    sprintf(LVM_Common_Services->Log_Buffer,"Translating Sectors.");
+    LVM_Common_Services->Write_Log_Buffer();
+
+  }
+
+  /* Send the request to every member. */
+  Write_Mirror_Members( Aggregate, Starting_Sector, Sectors_To_Write, Buffer, Error_Code );
+
+  FEATURE_FUNCTION_EXIT("Mirror_Write")
+
+  return;
+
+}
+
+
+static void _System Mirror_Read( ADDRESS PData, LBA Starting_Sector, CARDINAL32 Sectors_To_Read, ADDRESS Buffer, CARDINAL32 * Error_Code)
+{
+
+  Partition_Data *           Aggregate = (Partition_Data *) PData;
+
+  FEATURE_FUNCTION_ENTRY("Mirror_Read")
+
+  /* Is logging active? */
+  if ( LVM_Common_Services->Logging_Enabled )
+  {
+
+    if ( ( PData == NULL ) || ( Buffer == NULL ) || ( Error_Code == NULL) )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Mirror_Read has been invoked with one or more NULL pointers!\n     PData is %X (hex)\n     Buffer is %X (hex)\n     Error_Code is %X (hex)", PData, Buffer, Error_Code);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+    else
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,
+              "Mirror_Read has been invoked with the following parameters.\n     The partition specified has handle %X (hex)\n     The LBA of the sector to read is %X (hex)\n     The number of sectors to read is %d (decimal)\n     The location of the buffer to read into is %X (hex)\n      Error_Code is at address %X (hex)",
+              Aggregate->External_Handle,
+              Starting_Sector,
+              Sectors_To_Read,
+              Buffer,
+              Error_Code);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+  }
+
+  if ( LVM_Common_Services->Logging_Enabled )
+  {
+
+    sprintf(LVM_Common_Services->Log_Buffer,"Translating Sectors.");
+    LVM_Common_Services->Write_Log_Buffer();
+
+  }
+
+  /* Send the request to whichever up to date member is best placed to handle it. */
+  Read_Mirror_Members( Aggregate, Starting_Sector, Sectors_To_Read, Buffer, Error_Code );
+
+  FEATURE_FUNCTION_EXIT("Mirror_Read")
+
+  return;
+
+}
+
+
+
+
+static void _System Commit_Mirroring_Changes( ADDRESS VData, ADDRESS PData, CARDINAL32 * Error_Code )
+{
+
+  Partition_Data *                 PartitionRecord = (Partition_Data *) PData;
+  Volume_Data *                    VolumeRecord = (Volume_Data *) VData;
+  CARDINAL32                       MemberIndex;
+  LVM_Mirror_Table_Sector *        Table_Sector;
+  LVM_Mirror_Bitmap_Sector *       Bitmap_Sector;
+  Mirror_Array *                   MirrorTable;
+  Commit_Changes_Record            Commit_Data;
+  LVM_Signature_Sector *           Signature_Sector;
+  Extended_Boot_Record *           Fake_EBR;
+
+
+  FEATURE_FUNCTION_ENTRY("Commit_Mirroring_Changes")
+
+  /* Get the mirror table. */
+  MirrorTable = (Mirror_Array *) PartitionRecord->Feature_Data->Data;
+
+  /* Is logging active? */
+  if ( LVM_Common_Services->Logging_Enabled )
+  {
+
+    if ( ( PData == NULL ) || ( VData == NULL ) || ( Error_Code == NULL) )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Commit_Mirroring_Changes has been invoked with one or more NULL pointers!\n     VData is %X (hex)\n     PData is %X (hex)\n     Error_Code is %X (hex)", VData, PData, Error_Code);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+    else
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,
+              "Commit_Mirroring_Changes has been invoked with the following parameters.\n     The Volume specified has handle %X (hex)\n     The partition specified has handle %X (hex)\n     Error_Code is at address %X (hex)",
+              VolumeRecord->External_Handle,
+              PartitionRecord->External_Handle,
+              Error_Code);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+  }
+
+  /* Bring the members which missed writes up to date first, so that the bitmaps written out below match the members. */
+  Resync_Stale_Regions( MirrorTable, Error_Code );
+  if ( *Error_Code != LVM_ENGINE_NO_ERROR )
+  {
+
+    FEATURE_FUNCTION_EXIT("Commit_Mirroring_Changes")
+
+    return;
+
+  }
+
+  /* We must write out the LVM Signature Sector for the Aggregate.  Since we can not tell when it has been modified,
+     we must always write it out.                                                                                      */
+
+  /* Is there a signature sector? */
+  if ( PartitionRecord->Signature_Sector != NULL )
+  {
+
+    /* We will use Feature_Data_Buffer1 to write out the Signature Sector.  Clear the buffer. */
+    memset(Feature_Data_Buffer1, 0, BYTES_PER_SECTOR );
+
+    /* Set Signature_Sector to point to Feature_Data_Buffer1 so that we can copy the LVM Signature Sector data into the buffer. */
+    Signature_Sector = (LVM_Signature_Sector *) &Feature_Data_Buffer1;
+
+    /* Copy the LVM Signature Sector into the buffer. */
+    *Signature_Sector = *(PartitionRecord->Signature_Sector);
+
+    /* Calculate the CRC of the LVM Signature Sector. */
+    Signature_Sector->Signature_Sector_CRC = 0;
+    Signature_Sector->Signature_Sector_CRC = LVM_Common_Services->CalculateCRC( LVM_Common_Services->Initial_CRC, Signature_Sector, BYTES_PER_SECTOR);
+
+    /* Now write the Signature Sector to disk. */
+    Mirror_Write(PartitionRecord, PartitionRecord->Starting_Sector + PartitionRecord->Partition_Size - 1, 1, Feature_Data_Buffer1, Error_Code);
+    if ( ( *Error_Code != LVM_ENGINE_NO_ERROR ) &&
+         ( *Error_Code != LVM_ENGINE_IO_ERROR )
+       )
+    {
+
+      FEATURE_FUNCTION_EXIT("Commit_Mirroring_Changes")
+
+      /* There was an unexpected error!  Abort! */
+      return;
+
+    }
+
+    /* Is there a fake EBR that needs to be written out? */
+    if ( MirrorTable->Fake_EBR_Buffer != NULL )
+    {
+
+      /* Update the sector count based upon what will be reported through the GetDevParms IOCTLs.  An aggregate will only
+         have a fake EBR if it is the topmost aggregate, which means that the size of the aggregate is the size of Volume.  */
+      Fake_EBR = ( Extended_Boot_Record * ) MirrorTable->Fake_EBR_Buffer;
+      Fake_EBR->Partition_Table[0].Sector_Count = LVM_Common_Services->Compute_Reported_Volume_Size( Signature_Sector->Partition_Size_To_Report_To_User );
+      PartitionRecord->Partition_Table_Entry.Sector_Count = Fake_EBR->Partition_Table[0].Sector_Count;
+
+      /* We have a fake EBR.  Let's write it to disk. */
+      Mirror_Write(PartitionRecord, Signature_Sector->Fake_EBR_Location, MirrorTable->Fake_EBR_Size, MirrorTable->Fake_EBR_Buffer, Error_Code);
+      if ( ( *Error_Code != LVM_ENGINE_NO_ERROR ) &&
+           ( *Error_Code != LVM_ENGINE_IO_ERROR )
+         )
+      {
+
+        FEATURE_FUNCTION_EXIT("Commit_Mirroring_Changes")
+
+        /* There was an unexpected error!  Abort! */
+        return;
+
+      }
+
+    }
+
+  }
+
+  /* Was the mirror table changed? */
+  if ( MirrorTable->ChangesMade )
+  {
+
+    LOG_FEATURE_EVENT("The mirror table was changed.  Building disk image.")
+
+    /* Clear the buffer. */
+    memset(Feature_Data_Buffer1, 0, BYTES_PER_SECTOR * MIRRORING_RESERVED_SECTOR_COUNT );
+
+    /* The mirror table is in the first sector, and is followed by the bitmaps. */
+    Table_Sector = (LVM_Mirror_Table_Sector *) &Feature_Data_Buffer1;
+
+    Table_Sector->Mirror_Table_Signature = MIRROR_TABLE_SIGNATURE;
+    Table_Sector->Sequence_Number = MirrorTable->Sequence_Number + 1;
+    Table_Sector->Members_In_Use = MirrorTable->Members_In_Use;
+    Table_Sector->Member_Size = MirrorTable->Member_Size;
+    Table_Sector->Region_Size = MirrorTable->Region_Size;
+    Table_Sector->Aggregate_Serial_Number = MirrorTable->Aggregate_Serial_Number;
+    Table_Sector->Actual_Class = MirrorTable->Actual_Class;
+    Table_Sector->Top_Of_Class = MirrorTable->Top_Of_Class;
+    Table_Sector->Feature_Sequence_Number = MirrorTable->Feature_Sequence_Number;
+
+    for ( MemberIndex = 0; MemberIndex < MAXIMUM_MIRROR_MEMBERS; MemberIndex++ )
+      Table_Sector->Member_Table[MemberIndex] = MirrorTable->MemberArray[MemberIndex].Member_Data;
+
+    /* Calculate the CRC. */
+    Table_Sector->Mirror_Table_CRC = LVM_Common_Services->CalculateCRC( LVM_Common_Services->Initial_CRC, Table_Sector, BYTES_PER_SECTOR);
+
+    /* Now build the bitmap sector for each member. */
+    for ( MemberIndex = 0; MemberIndex < MAXIMUM_MIRROR_MEMBERS; MemberIndex++ )
+    {
+
+      Bitmap_Sector = (LVM_Mirror_Bitmap_Sector *) ( Feature_Data_Buffer1 + ( MemberIndex + 1 ) * BYTES_PER_SECTOR );
+
+      Bitmap_Sector->Mirror_Bitmap_Signature = MIRROR_BITMAP_SIGNATURE;
+      Bitmap_Sector->Sequence_Number = Table_Sector->Sequence_Number;
+      memcpy(Bitmap_Sector->Stale_Regions, MirrorTable->Stale_Regions[MemberIndex], MIRROR_BITMAP_SIZE);
+      Bitmap_Sector->Mirror_Bitmap_CRC = LVM_Common_Services->CalculateCRC( LVM_Common_Services->Initial_CRC, Bitmap_Sector, BYTES_PER_SECTOR);
+
+    }
+
+    LOG_FEATURE_EVENT("Disk Image completed.")
+
+  }
+
+  /* Set up the Commit_Data.  This structure is used to tell Write_Feature_Data whether or not to write the mirror table back
+     to disk, and to give Write_Feature_Data the address of the volume record (VData) so that it can pass it to the next feature
+     on each of the partitions in the volume we are processing.                                                                  */
+  Commit_Data.Commit_Mirroring_Changes = MirrorTable->ChangesMade;
+  Commit_Data.VData = VData;
+
+  LOG_FEATURE_EVENT("Attempting to write the disk image to each partition in the Aggregate.")
+
+  /* Now that we have created the Feature Data, we need to write it to disk. */
+  LVM_Common_Services->ForEachItem(PartitionRecord->Feature_Data->Partitions, &Write_Feature_Data, &Commit_Data, TRUE, Error_Code);
+
+  if ( *Error_Code != DLIST_SUCCESS )
+  {
+
+    LOG_FEATURE_EVENT1("ForEachItem failed!", "DLIST error", *Error_Code)
+
+    /* This should not happen because I/O errors are not reported back.  The disk array entry for the failed drive is marked instead. */
+    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+    FEATURE_FUNCTION_EXIT("Commit_Mirroring_Changes")
+
+    return;
+
+  }
+
+  /* The copies on disk now carry the next sequence number, so the next commit must go beyond it. */
+  if ( MirrorTable->ChangesMade )
+  {
+
+    MirrorTable->Sequence_Number += 1;
+    MirrorTable->ChangesMade = FALSE;
+
+  }
+
+  /* Indicate success. */
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  FEATURE_FUNCTION_EXIT("Commit_Mirroring_Changes")
+
+  return;
+
+}
+
+
+/*--------------------------------------------------
+ * Private functions available
+ --------------------------------------------------*/
+
+static void _System Create_Aggregates( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error_Code)
+{
+
+  /* Declare a local variable to walk the LVM Signature Sector Feature Array. */
+  CARDINAL32   FeatureIndex;
+
+  /* Declare a local variable so that we can access our parameters without having to typecast each time. */
+  CARDINAL32 *    LVM_Error = ( CARDINAL32 *) Parameters;
+
+  /* Declare a local variable so that we can access the Partition_Data without having to typecast each time. */
+  Partition_Data * PartitionRecord = (Partition_Data *) Object;
+
+  /* Declare a local variable so that we can access the LVM Signature Sector without having to use a double indirection each time. */
+  LVM_Signature_Sector * Signature_Sector;
+
+  /* We may need to create a new Partition Record.  Declare a local variable we can use to point to it. */
+  Partition_Data * New_PartitionRecord = NULL;
+
+  /* Declare an Aggregate Search Record.  We will need it to search the Aggregate List looking for an aggregate that this PartitionRecord may belong to. */
+  Aggregate_Search_Record  Search_Record;
+
+  /* We will have to manipulate a Mirror Array at some point, so declare a variable to let us do so. */
+  Mirror_Array  *  MirrorArray;
+
+  /* Declare a variable for use on error paths. */
+  CARDINAL32  Ignore_Error;
+
+  FEATURE_FUNCTION_ENTRY("Create_Aggregates")
+
+#ifdef DEBUG
+
+  /* Is Object what we think it should be? */
+  if ( ( ObjectTag != PARTITION_DATA_TAG ) || ( ObjectSize != sizeof(Partition_Data) ) )
+  {
+
+
+#ifdef PARANOID
+
+    assert(0);
+
+#endif
+
+
+    /* Object's TAG is not what we expected!  Abort! */
+    *LVM_Error = LVM_ENGINE_INTERNAL_ERROR;
+    *Error_Code = DLIST_CORRUPTED;
+
+    FEATURE_FUNCTION_EXIT("Create_Aggregates")
+
+    return;
+
+  }
+
+#endif
+
+  /* Well, Object has the correct TAG so we will assume that it points to an item of type Partition_Data. */
+
+#ifdef DEBUG
+
+  /* Does this partition record represent a partition? */
+  if ( PartitionRecord->Partition_Type != Partition )
+  {
+
+    /* We have a corrupt list!  This function should only be used with the Partitions list for a volume.  The
+       partitions list for a volume only contains entries which are for partitions, so if we get anything else,
+       then the list has been corrupted!                                                                        */
+
+
+#ifdef PARANOID
+
+    assert(0);
+
+#endif
+
+      *LVM_Error = LVM_ENGINE_INTERNAL_ERROR;
+      *Error_Code = DLIST_CORRUPTED;
+
+      FEATURE_FUNCTION_EXIT("Create_Aggregates")
+
+      return;
+
+  }
+
+#endif
+
+  /* Assume success. */
+  *Error_Code = DLIST_SUCCESS;
+  *LVM_Error = LVM_ENGINE_NO_ERROR;
+
+  /* Is this partition of interest to us?  It must have an LVM Signature Sector for us to be interested. */
+  if ( PartitionRecord->Signature_Sector == NULL )
+  {
+
+    FEATURE_FUNCTION_EXIT("Create_Aggregates")
+
+    /* This partition is not part of any mirrored aggregate.  */
+    return;
+
+  }
+
+  /* Get the signature sector. */
+  Signature_Sector = PartitionRecord->Signature_Sector;
+
+  /* Is Mirroring listed in the LVM Signature Sector? */
+  for ( FeatureIndex = 0; FeatureIndex < MAX_FEATURES_PER_VOLUME; FeatureIndex++)
+  {
+
+    if ( Signature_Sector->LVM_Feature_Array[FeatureIndex].Feature_ID == MIRRORING_FEATURE_ID )
+    {
+
+      /* Mirroring is on this partition. */
+
+      /* Create a Mirror Array to hold the Mirroring data for this partition. */
+      MirrorArray = (Mirror_Array *) LVM_Common_Services->Allocate( sizeof(Mirror_Array) );
+      if ( MirrorArray == NULL )
+      {
+
+        *Error_Code = DLIST_OUT_OF_MEMORY;
+        *LVM_Error = LVM_ENGINE_OUT_OF_MEMORY;
+
+        FEATURE_FUNCTION_EXIT("Create_Aggregates")
+
+        return;
+
+      }
+
+      /* Initialize the Mirror Array. */
+      memset(MirrorArray,0, sizeof(Mirror_Array) );
+
+      /* Load the mirroring feature data for this partition. */
+      if ( !Load_Feature_Data( PartitionRecord, MirrorArray, LVM_Error) )
+      {
+
+        switch ( *LVM_Error )
+        {
+
+          case LVM_ENGINE_NO_ERROR :
+                                     *Error_Code = DLIST_SUCCESS;
+                                     break;
+          case LVM_ENGINE_OUT_OF_MEMORY :
+                                          *Error_Code = DLIST_OUT_OF_MEMORY;
+                                          break;
+          default : *Error_Code = DLIST_CORRUPTED;
+                    break;
+        }
+
+        LVM_Common_Services->Deallocate(MirrorArray);
+
+        FEATURE_FUNCTION_EXIT("Create_Aggregates")
+
+        return;
+
+      }
+
+      /* Is this partition part of an aggregate, or do we need to create a new one for it? */
+
+      /* Set up to search the Aggreate List. */
+      Search_Record.Aggregate_Found = FALSE;
+      Search_Record.PartitionRecord = PartitionRecord;
+      Search_Record.MirrorTable = MirrorArray;
+
+      /* Do the search. */
+      LVM_Common_Services->ForEachItem(Aggregate_List, &Find_Existing_Aggregate, &Search_Record, TRUE, Error_Code );
+
+#ifdef DEBUG
+
+      /* Was there an error? */
+      if ( *Error_Code != DLIST_SUCCESS )
+      {
+
+#ifdef PARANOID
+
+        assert(0);
+
+#else
+
+        *LVM_Error = LVM_ENGINE_INTERNAL_ERROR;
+        *Error_Code = DLIST_CORRUPTED;
+
+        LVM_Common_Services->Deallocate(MirrorArray);
+
+        FEATURE_FUNCTION_EXIT("Create_Aggregates")
+
+        return;
+
+#endif
+
+      }
+
+#endif
+
+      /* Was a matching Aggregate found? If it was, then the Partition was added to the aggregate.  If not, then we must create a new Aggregate. */
+      if ( ! Search_Record.Aggregate_Found )
+      {
+
+        /* Since there was no existing Aggregate that this partition was a part of, create one. */
+        New_PartitionRecord = (Partition_Data *) LVM_Common_Services->Allocate ( sizeof( Partition_Data ) );
+        if ( New_PartitionRecord == NULL )
+        {
+
+          *Error_Code = DLIST_OUT_OF_MEMORY;
+          *LVM_Error = LVM_ENGINE_OUT_OF_MEMORY;
+
+          LVM_Common_Services->Deallocate(MirrorArray);
+
+          FEATURE_FUNCTION_EXIT("Create_Aggregates")
+
+          return;
+
+        }
+
+        /* Initialize those fields in the new PartitionRecord which we may need. */
+        memset(New_PartitionRecord, 0, sizeof(Partition_Data) );
+        New_PartitionRecord->External_Handle = NULL;
+        New_PartitionRecord->Drive_Index = 0xFFFFFFFFL;/* We don't need the drive index as this is not a real partition. */
+        New_PartitionRecord->Drive_Partition_Handle = NULL; /* This is not in the Partitions list of any entry in the DriveArray. */
+        New_PartitionRecord->External_Volume_Handle = NULL;
+        New_PartitionRecord->Volume_Handle = NULL;
+        New_PartitionRecord->DLA_Table_Entry.Volume_Serial_Number = PartitionRecord->DLA_Table_Entry.Volume_Serial_Number;
+        New_PartitionRecord->DLA_Table_Entry.Partition_Serial_Number = MirrorArray->Aggregate_Serial_Number;
+        New_PartitionRecord->DLA_Table_Entry.Drive_Letter = PartitionRecord->DLA_Table_Entry.Drive_Letter;
+        strncpy(New_PartitionRecord->DLA_Table_Entry.Volume_Name, PartitionRecord->DLA_Table_Entry.Volume_Name, VOLUME_NAME_SIZE);
+        New_PartitionRecord->Partition_Type = Partition;
+
+        /* Allocate memory for an LVM Signature Sector. */
+        New_PartitionRecord->Signature_Sector = ( LVM_Signature_Sector * ) LVM_Common_Services->Allocate( BYTES_PER_SECTOR );
+        if ( New_PartitionRecord->Signature_Sector == NULL )
+        {
+
+          *Error_Code = DLIST_OUT_OF_MEMORY;
+          *LVM_Error = LVM_ENGINE_OUT_OF_MEMORY;
+
+          LVM_Common_Services->Deallocate(MirrorArray);
+          LVM_Common_Services->Deallocate(New_PartitionRecord);
+
+          FEATURE_FUNCTION_EXIT("Create_Aggregates")
+
+          return;
+
+        }
+
+        /* Initialize the Aggregate's LVM Signature Sector. */
+        *(New_PartitionRecord->Signature_Sector) = *Signature_Sector;
+        New_PartitionRecord->Signature_Sector->Partition_Serial_Number = MirrorArray->Aggregate_Serial_Number;
+        New_PartitionRecord->Signature_Sector->Partition_Start = 0;
+        New_PartitionRecord->Signature_Sector->Partition_End = 0;
+        New_PartitionRecord->Signature_Sector->Partition_Sector_Count = 0;
+        New_PartitionRecord->Signature_Sector->LVM_Reserved_Sector_Count = 0;
+        New_PartitionRecord->Signature_Sector->Partition_Size_To_Report_To_User = 0;
+        New_PartitionRecord->Signature_Sector->Partition_Name[0] = 0x00;
+
+        /* Allocate memory to hold the Feature Data for this Aggregate. */
+        New_PartitionRecord->Feature_Data = ( Feature_Context_Data *) LVM_Common_Services->Allocate ( sizeof (Feature_Context_Data) );
+        if ( New_PartitionRecord->Feature_Data == NULL )
+        {
+
+          *Error_Code = DLIST_OUT_OF_MEMORY;
+          *LVM_Error = LVM_ENGINE_OUT_OF_MEMORY;
+
+          LVM_Common_Services->Deallocate(MirrorArray);
+          LVM_Common_Services->Deallocate(New_PartitionRecord->Signature_Sector);
+          LVM_Common_Services->Deallocate(New_PartitionRecord);
+
+          FEATURE_FUNCTION_EXIT("Create_Aggregates")
+
+          return;
+
+        }
+
+        /* Initialize the Aggregate's Feature Data. */
+        memset( New_PartitionRecord->Feature_Data, 0, sizeof (Feature_Context_Data) );
+        New_PartitionRecord->Feature_Data->Feature_ID = &Feature_ID_Record;
+        New_PartitionRecord->Feature_Data->Function_Table = &Function_Table;
+        New_PartitionRecord->Feature_Data->Data = NULL;
+        New_PartitionRecord->Feature_Data->Partitions = NULL;
+        New_PartitionRecord->Feature_Data->Old_Context = NULL;
+
+
+        New_PartitionRecord->Feature_Data->Partitions = LVM_Common_Services->CreateList();
+        if ( New_PartitionRecord->Feature_Data->Partitions == NULL )
+        {
+
+          *Error_Code = DLIST_OUT_OF_MEMORY;
+          *LVM_Error = LVM_ENGINE_OUT_OF_MEMORY;
+
+          LVM_Common_Services->Deallocate(MirrorArray);
+          LVM_Common_Services->Deallocate(New_PartitionRecord->Feature_Data);
+          LVM_Common_Services->Deallocate(New_PartitionRecord->Signature_Sector);
+          LVM_Common_Services->Deallocate(New_PartitionRecord);
+
+          FEATURE_FUNCTION_EXIT("Create_Aggregates")
+
+          return;
+
+        }
+
+        /* Use the MirrorArray of the partition as the MirrorArray of the Aggregate. */
+        New_PartitionRecord->Feature_Data->Data = (ADDRESS) MirrorArray;
+
+        /* Add the current partition to the partitions list of the aggregate. */
+        LVM_Common_Services->InsertObject(New_PartitionRecord->Feature_Data->Partitions, sizeof(Partition_Data), PartitionRecord, PARTITION_DATA_TAG, NULL, AppendToList, FALSE, Error_Code);
+
+        if ( *Error_Code != DLIST_SUCCESS )
+        {
+
+          if (*Error_Code == DLIST_OUT_OF_MEMORY)
+            *LVM_Error = LVM_ENGINE_OUT_OF_MEMORY;
+          else
+            *LVM_Error = LVM_ENGINE_INTERNAL_ERROR;
+
+          LVM_Common_Services->Deallocate(New_PartitionRecord->Feature_Data->Data);
+          LVM_Common_Services->DestroyList(&(New_PartitionRecord->Feature_Data->Partitions), FALSE, &Ignore_Error);
+          LVM_Common_Services->Deallocate(New_PartitionRecord->Feature_Data);
+          LVM_Common_Services->Deallocate(New_PartitionRecord->Signature_Sector);
+          LVM_Common_Services->Deallocate(New_PartitionRecord);
+
+          FEATURE_FUNCTION_EXIT("Create_Aggregates")
+
+          return;
+
+        }
+
+        /* We must get an external handle for the aggregate. */
+        New_PartitionRecord->External_Handle = LVM_Common_Services->Create_Handle(New_PartitionRecord, PARTITION_DATA_TAG, sizeof(Partition_Data), Error_Code);
+        if ( *Error_Code != HANDLE_MANAGER_NO_ERROR )
+        {
+
+          if (*Error_Code == HANDLE_MANAGER_OUT_OF_MEMORY)
+          {
+
+            *LVM_Error = LVM_ENGINE_OUT_OF_MEMORY;
+            *Error_Code = DLIST_OUT_OF_MEMORY;
+
+          }
+          else
+          {
+
+            *LVM_Error = LVM_ENGINE_INTERNAL_ERROR;
+            *Error_Code = DLIST_CORRUPTED;
+
+          }
+
+          LVM_Common_Services->Deallocate(New_PartitionRecord->Feature_Data->Data);
+          LVM_Common_Services->DestroyList(&(New_PartitionRecord->Feature_Data->Partitions), FALSE, &Ignore_Error);
+          LVM_Common_Services->Deallocate(New_PartitionRecord->Feature_Data);
+          LVM_Common_Services->Deallocate(New_PartitionRecord->Signature_Sector);
+          LVM_Common_Services->Deallocate(New_PartitionRecord);
+
+          FEATURE_FUNCTION_EXIT("Create_Aggregates")
+
+          return;
+
+        }
+
+        /* Add the Aggregate to the list of Aggregates. */
+        LVM_Common_Services->InsertObject(Aggregate_List, sizeof(Partition_Data), New_PartitionRecord, PARTITION_DATA_TAG, NULL, AppendToList, FALSE, Error_Code);
+
+        if ( *Error_Code != DLIST_SUCCESS )
+        {
+
+          if (*Error_Code == DLIST_OUT_OF_MEMORY)
+            *LVM_Error = LVM_ENGINE_OUT_OF_MEMORY;
+          else
+            *LVM_Error = LVM_ENGINE_INTERNAL_ERROR;
+
+          LVM_Common_Services->Destroy_Handle(New_PartitionRecord->External_Handle, &Ignore_Error);
+          LVM_Common_Services->Deallocate(New_PartitionRecord->Feature_Data->Data);
+          LVM_Common_Services->DestroyList(&(New_PartitionRecord->Feature_Data->Partitions), FALSE, &Ignore_Error);
+          LVM_Common_Services->Deallocate(New_PartitionRecord->Feature_Data);
+          LVM_Common_Services->Deallocate(New_PartitionRecord->Signature_Sector);
+          LVM_Common_Services->Deallocate(New_PartitionRecord);
+
+          FEATURE_FUNCTION_EXIT("Create_Aggregates")
+
+          return;
+
+        }
+
+      }
+
+      else
+      {
+
+        /* The partition was added to an existing aggregate, which has its own copy of the mirror table, so this one is no
+           longer needed.                                                                                                    */
+        LVM_Common_Services->Deallocate(MirrorArray);
+
+      }
+
+      /* Leave the FOR loop as we found what we were looking for. */
+      break;
+
+    }
+
+  }
+
+  /* Indicate success and leave. */
+  *Error_Code = DLIST_SUCCESS;
+
+  FEATURE_FUNCTION_EXIT("Create_Aggregates")
+
+  return;
+
+}
+
+
+static void _System Find_Existing_Aggregate(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error_Code)
+{
+
+  /* Declare a local variable so that we can access our parameters without having to typecast each time. */
+   Aggregate_Search_Record *  Search_Record = ( Aggregate_Search_Record *) Parameters;
+
+  /* Declare a local variable so that we can access the Partition_Data without having to typecast each time. */
+  Partition_Data * Aggregate = (Partition_Data *) Object;
+
+  /* Declare a local variable to access the PartitionRecord we are trying to match. */
+  Partition_Data * PartitionRecord = Search_Record->PartitionRecord;
+
+  /* We will have to manipulate a Mirror Array at some point, so declare a variable to let us do so. */
+  Mirror_Array  *  MirrorArray;
+
+  /* We will need to compare some of the fields in the LVM Signature Sector of the Aggregate with those in the PartitionRecord we are seeking to match. */
+  LVM_Signature_Sector * Signature_Sector_A, * Signature_Sector_P;
+
+  /* Declare a variable to walk the MirrorArray when we are comparing the feature data of the partition against that of the aggregate. */
+  CARDINAL32  Index;
+
+  FEATURE_FUNCTION_ENTRY("Find_Existing_Aggregate")
+
+#ifdef DEBUG
+
+  /* Is Object what we think it should be? */
+  if ( ( ObjectTag != PARTITION_DATA_TAG ) || ( ObjectSize != sizeof(Partition_Data) ) )
+  {
+
+
+#ifdef PARANOID
+
+    assert(0);
+
+#endif
+
+
+    /* Object's TAG is not what we expected!  Abort! */
+    *Error_Code = DLIST_CORRUPTED;
+
+    FEATURE_FUNCTION_EXIT("Find_Existing_Aggregate")
+
+    return ;
+
+  }
+
+#endif
+
+  /* Well, Object has the correct TAG so we will assume that it points to an item of type Partition_Data. */
+
+#ifdef DEBUG
+
+  /* Does this partition record represent a partition? */
+  if ( Aggregate->Partition_Type != Partition )
+  {
+
+    /* We have a corrupt list!  This function should only be used with the Partitions list for a volume.  The
+       partitions list for a volume only contains entries which are for partitions, so if we get anything else,
+       then the list has been corrupted!                                                                        */
+
+
+#ifdef PARANOID
+
+    assert(0);
+
+#endif
+
+      *Error_Code = DLIST_CORRUPTED;
+
+      FEATURE_FUNCTION_EXIT("Find_Existing_Aggregate")
+
+      return ;
+
+  }
+
+#endif
+
+  /* Does the Volume Serial Number of the Aggregate match the Volume Serial Number of the PartitionRecord we have been given? */
+  if ( PartitionRecord->DLA_Table_Entry.Volume_Serial_Number == Aggregate->DLA_Table_Entry.Volume_Serial_Number )
+  {
+
+    /* Do the drive preferences match? */
+    if ( PartitionRecord->DLA_Table_Entry.Drive_Letter == Aggregate->DLA_Table_Entry.Drive_Letter )
+    {
+
+      /* Get the LVM Signature Sectors for the Aggregate and the Partition. */
+      Signature_Sector_A = Aggregate->Signature_Sector;
+      Signature_Sector_P = PartitionRecord->Signature_Sector;
+
+      /* Do the appropriate fields in the Signature Sectors match? */
+      if ( Signature_Sector_A->Boot_Disk_Serial_Number == Signature_Sector_P->Boot_Disk_Serial_Number )
+      {
+
+        /* Get the Mirroring Feature Data for the aggregate and compare it against that for the partition. */
+        MirrorArray = (Mirror_Array * ) Aggregate->Feature_Data->Data;
+
+        /* Does the mirror table for the partition match the MirrorArray for the Aggregate?  The sequence numbers are not compared,
+           as a member which was missing when the aggregate was last committed will have an older mirror table.                    */
+        if ( ( MirrorArray->Members_In_Use != Search_Record->MirrorTable->Members_In_Use ) ||
+             ( MirrorArray->Aggregate_Serial_Number != Search_Record->MirrorTable->Aggregate_Serial_Number ) ||
+             ( MirrorArray->Member_Size != Search_Record->MirrorTable->Member_Size ) ||
+             ( MirrorArray->Region_Size != Search_Record->MirrorTable->Region_Size )
+           )
+        {
+
+          FEATURE_FUNCTION_EXIT("Find_Existing_Aggregate")
+
+          /* This partition does not belong to this aggregate. */
+          return;
+
+        }
+
+        /* Compare the members of the mirror. */
+        for ( Index = 0; Index < MAXIMUM_MIRROR_MEMBERS; Index++ )
+        {
+
+          if ( ( MirrorArray->MemberArray[Index].Member_Data.Drive_Serial_Number != Search_Record->MirrorTable->MemberArray[Index].Member_Data.Drive_Serial_Number ) ||
+               ( MirrorArray->MemberArray[Index].Member_Data.Partition_Serial_Number != Search_Record->MirrorTable->MemberArray[Index].Member_Data.Partition_Serial_Number )
+             )
+          {
+
+            FEATURE_FUNCTION_EXIT("Find_Existing_Aggregate")
+
+            /* This partition does not belong to this aggregate. */
+            return;
+
+          }
+
+        }
+
+        /* It looks like this PartitionRecord belongs to this Aggregate. */
+
+        /* Add this PartitionRecord to the Aggregrate. */
+        LVM_Common_Services->InsertObject(Aggregate->Feature_Data->Partitions, sizeof(Partition_Data), PartitionRecord, PARTITION_DATA_TAG, NULL, AppendToList, FALSE, Error_Code );
+
+        /* Did we succeed? */
+        if ( *Error_Code != DLIST_SUCCESS )
+        {
+
+          FEATURE_FUNCTION_EXIT("Find_Existing_Aggregate")
+
+          return;
+
+        }
+
+        /* Find the partition in the mirror data for the aggregate and set a pointer to it. */
+        for ( Index = 0; Index < MAXIMUM_MIRROR_MEMBERS; Index++ )
+        {
+
+          /* The only entry in the mirror table of the partition record that will have a pointer to a partition record is
+             the entry that points to itself.  We need to find that entry and update the corresponding entry in the
+             MirrorArray of the Aggregate.                                                                                 */
+          if ( Search_Record->MirrorTable->MemberArray[Index].PartitionRecord != NULL )
+          {
+
+            MirrorArray->MemberArray[Index].PartitionRecord = Search_Record->MirrorTable->MemberArray[Index].PartitionRecord;
+
+          }
+
+        }
+
+        /* The newest mirror table records which regions of each member are stale, including those of any member which was
+           missing when it was written, so it is the one we must use.  The members with older tables must then be updated.   */
+        if ( Search_Record->MirrorTable->Sequence_Number != MirrorArray->Sequence_Number )
+        {
+
+          LOG_FEATURE_EVENT("The partition has a different version of the mirror table than the aggregate.  Using the newest.")
+
+          if ( Search_Record->MirrorTable->Sequence_Number > MirrorArray->Sequence_Number )
+          {
+
+            MirrorArray->Sequence_Number = Search_Record->MirrorTable->Sequence_Number;
+            memcpy(MirrorArray->Stale_Regions, Search_Record->MirrorTable->Stale_Regions, sizeof(MirrorArray->Stale_Regions) );
+
+          }
+
+          MirrorArray->ChangesMade = TRUE;
+
+        }
+
+        /* If this partition only had one good copy of the mirror table, both copies must be rewritten on the next commit. */
+        if ( Search_Record->MirrorTable->ChangesMade )
+          MirrorArray->ChangesMade = TRUE;
+
+        /* Now indicate that a match was found. */
+        Search_Record->Aggregate_Found = TRUE;
+
+        /* Indicate that we found what we were looking for and return. */
+        *Error_Code = DLIST_SEARCH_COMPLETE;
+
+        FEATURE_FUNCTION_EXIT("Find_Existing_Aggregate")
+
+        return;
+
+      }
+
+    }
+
+  }
+
+  /* Indicate success and return. */
+  *Error_Code = DLIST_SUCCESS;
+
+  FEATURE_FUNCTION_EXIT("Find_Existing_Aggregate")
+
+  return;
+
+}
+
+
+static BOOLEAN  _System Eliminate_Bad_Aggregates( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, BOOLEAN * FreeMemory, CARDINAL32 * Error_Code)
+{
+
+  Partition_Data *               Aggregate = (Partition_Data *) Object;
+  Partition_Data *               NextPartitionRecord;
+  Aggregate_Validation_Record *  Validation_Record = ( Aggregate_Validation_Record *) Parameters;
+  Partition_Data *               PartitionRecord;
+  Mirror_Array *                 MirrorTable;
+  Extended_Boot_Record *         Fake_EBR  = (Extended_Boot_Record *) &Fake_EBR_Buffer;
+  CARDINAL32                     Index;
+  CARDINAL32                     Members_Found = 0;
+  CARDINAL32                     First_Member;
+  BOOLEAN                        Aggregate_Complete = TRUE;
+
+
+  FEATURE_FUNCTION_ENTRY("Eliminate_Bad_Aggregates")
+
+  /* Unlike the other aggregators, a mirror can be used with members missing, as every member holds a full copy of the data.
+     So long as at least one member was found, the aggregate is kept.  Any member which was found must be large enough to
+     hold a copy of the aggregate, however, or something is seriously wrong.  If no members are usable, we must put the
+     partitions associated with the aggregate back into the master list of partitions so that we may retry this operation
+     later, at which time we hope that the pieces will be available.                                                         */
+  MirrorTable = (Mirror_Array *) Aggregate->Feature_Data->Data;
+  for ( Index = 0; Aggregate_Complete && ( Index < MirrorTable->Members_In_Use ); Index++ )
+  {
+
+    if ( MirrorTable->MemberArray[Index].PartitionRecord != NULL )
+    {
+
+      if ( MirrorTable->MemberArray[Index].PartitionRecord->Usable_Size < MirrorTable->Member_Size )
+        Aggregate_Complete = FALSE;
+      else
+        Members_Found++;
+
+    }
+
+  }
+
+  if ( Members_Found == 0 )
+    Aggregate_Complete = FALSE;
+
+  if ( ! Aggregate_Complete )
+  {
+
+    /* Free any memory held by the Aggregate. */
+    Discard_Aggregate( Aggregate );
+
+    /* If we have not already created a volume, then set *(Validation_Record.Error_Code) to LVM_ENGINE_PLUGIN_OPERATION_INCOMPLETE. */
+    if ( ! Validation_Record->Volume_Created )
+      *(Validation_Record->Error_Code) = LVM_ENGINE_PLUGIN_OPERATION_INCOMPLETE;
+
+    /* Returning TRUE will cause Aggregate to be removed from the Aggregate_List. */
+    *Error_Code = DLIST_SUCCESS;
+
+    FEATURE_FUNCTION_EXIT("Eliminate_Bad_Aggregates")
+
+    return TRUE;
+
+  }
+
+  /* We will be keeping this Aggregate. */
+
+  /* We must build the partitions list for the aggregate with the partitions in the list appearing in mirror table order, just
+     as Drive Linking does.  We will do this by first deleting all items in the partition list for the aggregate, and then
+     adding the partitions back in the order they appear in the mirror table.  At the same time, we will remove the partitions
+     from the partitions list.                                                                                                   */
+  LVM_Common_Services->DeleteAllItems( Aggregate->Feature_Data->Partitions, FALSE, Error_Code);
+
+  /* Did we succeed? */
+  if ( *Error_Code != DLIST_SUCCESS )
+  {
+
+    /* We have an internal error!  We have used this list before without error, so this function should not have failed! */
+    *(Validation_Record->Error_Code) = LVM_ENGINE_INTERNAL_ERROR;
+
+    FEATURE_FUNCTION_EXIT("Eliminate_Bad_Aggregates")
+
+    return TRUE;
+
+  }
+
+  /* Now walk the MemberArray and put the partitions back into the Partitions list of the aggregate. */
+  for ( Index = 0; Index < MirrorTable->Members_In_Use; Index++)
+  {
+
+    /* Is this member missing?  If so, every region on it is stale.  Once it returns, it will be brought up to date on the
+       first commit after it is found.                                                                                      */
+    if ( MirrorTable->MemberArray[Index].PartitionRecord == NULL )
+    {
+
+      LOG_FEATURE_EVENT1("A member of the mirror is missing.  The mirror will be used without it.", "Member", Index)
+
+      memset( MirrorTable->Stale_Regions[Index], 0xFF, MIRROR_BITMAP_SIZE);
+      MirrorTable->ChangesMade = TRUE;
+
+      continue;
+
+    }
+
+    /* Insert the current partition into the Partitions list of the aggregate. */
+    LVM_Common_Services->InsertObject(Aggregate->Feature_Data->Partitions, sizeof(Partition_Data), MirrorTable->MemberArray[Index].PartitionRecord, PARTITION_DATA_TAG, NULL, AppendToList, FALSE, Error_Code);
+    if ( *Error_Code != DLIST_SUCCESS )
+    {
+
+      if ( *Error_Code == DLIST_OUT_OF_MEMORY )
+      {
+
+        /* Free any memory held by the Aggregate. */
+        Discard_Aggregate( Aggregate );
+
+      }
+
+      /* If we have not already created a volume, then set *(Validation_Record.Error_Code) to LVM_ENGINE_PLUGIN_OPERATION_INCOMPLETE. */
+      if ( ! Validation_Record->Volume_Created )
+        *(Validation_Record->Error_Code) = LVM_ENGINE_PLUGIN_OPERATION_INCOMPLETE;
+
+      FEATURE_FUNCTION_EXIT("Eliminate_Bad_Aggregates")
+
+      /* Returning TRUE will cause Aggregate to be removed from the Aggregate_List. */
+      return TRUE;
+
+    }
+
+    /* We need to find this partition in the partitions list and delete it. */
+    LVM_Common_Services->PruneList(Validation_Record->Partition_List, &Claim_Aggregate_Partitions, MirrorTable->MemberArray[Index].PartitionRecord, Error_Code);
+    if ( *Error_Code != DLIST_SUCCESS )
+    {
+
+      /* If we have not already created a volume, then set *(Validation_Record.Error_Code) to LVM_ENGINE_PLUGIN_OPERATION_INCOMPLETE. */
+      if ( ! Validation_Record->Volume_Created )
+        *(Validation_Record->Error_Code) = LVM_ENGINE_PLUGIN_OPERATION_INCOMPLETE;
+
+      FEATURE_FUNCTION_EXIT("Eliminate_Bad_Aggregates")
+
+      /* Returning TRUE will cause Aggregate to be removed from the Aggregate_List. */
+      return TRUE;
+
+    }
+
+  }
+
+  /* Every member holds a complete copy of the aggregate. */
+  Aggregate->Partition_Size = MirrorTable->Member_Size;
+
+  /* Since this is a new aggregate, set its usable size to the partition size. */
+  Aggregate->Usable_Size = Aggregate->Partition_Size;
+
+  /* A mirrored volume always spans its partitions.  Set the Spanned_Volume flag on all of the partitions which are a part of this aggregate. */
+  Aggregate->Spanned_Volume = TRUE;
+  LVM_Common_Services->ForEachItem(Aggregate->Feature_Data->Partitions, &Set_Spanned_Volume_Flag, NULL, TRUE, Error_Code);
+
+  /* Did we succeed? */
+  if ( *Error_Code != DLIST_SUCCESS )
+  {
+
+    /* We have an internal error!  We have already successfully walked this list before, so it should not fail now! */
+    *(Validation_Record->Error_Code) = LVM_ENGINE_INTERNAL_ERROR;
+
+    FEATURE_FUNCTION_EXIT("Eliminate_Bad_Aggregates")
+
+    return FALSE;
+
+  }
+
+  /* Since this aggregate is good, lets read in its LVM signature sector from the end of the aggregate.  Any LVM Features which
+     come after us will be expecting this.                                                                                      */
+  Mirror_Read(Aggregate, Aggregate->Partition_Size - 1, 1, Aggregate->Signature_Sector, Error_Code);
+
+  /* Did we succeed? */
+  if ( *Error_Code != LVM_ENGINE_NO_ERROR )
+  {
+
+    if ( *Error_Code != LVM_ENGINE_IO_ERROR )
+    {
+
+      *Error_Code = DLIST_CORRUPTED;
+
+      FEATURE_FUNCTION_EXIT("Eliminate_Bad_Aggregates")
+
+      return FALSE;
+
+    }
+
+    /* Free any memory held by the Aggregate. */
+    Discard_Aggregate( Aggregate );
+
+    /* If we have not already created a volume, then set *(Validation_Record.Error_Code) to LVM_ENGINE_PLUGIN_OPERATION_INCOMPLETE. */
+    if ( ! Validation_Record->Volume_Created )
+      *(Validation_Record->Error_Code) = LVM_ENGINE_PLUGIN_OPERATION_INCOMPLETE;
+
+    /* Returning TRUE will cause Aggregate to be removed from the Aggregate_List. */
+    *Error_Code = DLIST_SUCCESS;
+
+    FEATURE_FUNCTION_EXIT("Eliminate_Bad_Aggregates")
+
+    return TRUE;
+
+  }
+
+  /* Since we were able to read the sector, lets validate it. */
+  if ( ! LVM_Common_Services->Valid_Signature_Sector( Aggregate, Aggregate->Signature_Sector) )
+  {
+
+    /* Free any memory held by the Aggregate. */
+    Discard_Aggregate( Aggregate );
+
+    /* If we have not already created a volume, then set *(Validation_Record.Error_Code) to LVM_ENGINE_PLUGIN_OPERATION_INCOMPLETE. */
+    if ( ! Validation_Record->Volume_Created )
+      *(Validation_Record->Error_Code) = LVM_ENGINE_PLUGIN_OPERATION_INCOMPLETE;
+
+    /* Returning TRUE will cause Aggregate to be removed from the Aggregate_List. */
+    *Error_Code = DLIST_SUCCESS;
+
+    FEATURE_FUNCTION_EXIT("Eliminate_Bad_Aggregates")
+
+    return TRUE;
+
+  }
+
+  /* Update the Usable Size based upon the number of reserved sectors in the LVM Signature Sector. */
+  Aggregate->Usable_Size = Aggregate->Signature_Sector->Partition_Size_To_Report_To_User;
+
+  /* Save the name of the aggregate, if there is one. */
+  strncpy(Aggregate->Partition_Name, Aggregate->Signature_Sector->Partition_Name, PARTITION_NAME_SIZE);
+
+  /* Is there a fake EBR associated with this aggregate? */
+  if ( Aggregate->Signature_Sector->Fake_EBR_Allocated )
+  {
+
+    /* We must read in the fake EBR and extract the format indicator for the volume.  */
+    Mirror_Read(Aggregate, Aggregate->Signature_Sector->Fake_EBR_Location, 1, &Fake_EBR_Buffer, Error_Code);
+
+    /* Did we succeed? */
+    if ( *Error_Code != LVM_ENGINE_NO_ERROR )
+    {
+
+      if ( *Error_Code != LVM_ENGINE_IO_ERROR )
+      {
+
+        *Error_Code = DLIST_CORRUPTED;
+
+        FEATURE_FUNCTION_EXIT("Eliminate_Bad_Aggregates")
+
+        return FALSE;
+
+      }
+
+      /* Since we could not read the Fake EBR, we will create a new partition table entry for this aggregate.  The only
+         data in the partition table entry that may not be correct is the Format_Indicator.  The new partition table entry
+         will have a format indicator of 7.  This will work with FAT, HPFS, and JFS.  Other filesystems may not like it, though. */
+      LVM_Common_Services->Create_Fake_Partition_Table_Entry( &(Aggregate->Partition_Table_Entry), Aggregate->Usable_Size );
+
+    }
+    else
+    {
+
+      /* We must extract the partition table entry for this aggregate from the "fake" EBR. */
+      Aggregate->Partition_Table_Entry = Fake_EBR->Partition_Table[0];
+
+    }
+
+  }
+
+  /* We need to get the filesystem name for the aggregate.  Every member holds a copy of the boot sector of the volume, so
+     it can come from the first member which was found.                                                                   */
+  for ( First_Member = 0; MirrorTable->MemberArray[First_Member].PartitionRecord == NULL; First_Member++ );
+
+  PartitionRecord = MirrorTable->MemberArray[First_Member].PartitionRecord;
+
+  /* Copy the filesystem name. */
+  strncpy(Aggregate->File_System_Name, PartitionRecord->File_System_Name, FILESYSTEM_NAME_SIZE);
+
+  /* We must set the filesystem name for each of the other members which were found. */
+  for ( Index = First_Member + 1; Index < MirrorTable->Members_In_Use; Index++ )
+  {
+
+    /* Get the partition record of this member. */
+    NextPartitionRecord = MirrorTable->MemberArray[Index].PartitionRecord;
+    if ( NextPartitionRecord == NULL )
+      continue;
+
+    /* Copy the filesystem name. */
+    strncpy(NextPartitionRecord->File_System_Name, PartitionRecord->File_System_Name, FILESYSTEM_NAME_SIZE);
+
+    /* Increment the Feature_Index to indicate that we have completed the current feature on this partition. */
+    NextPartitionRecord->Feature_Index += 1;
+
+  }
+
+  /* Add the aggregate to the list of aggregates. */
+  Aggregate->Drive_Partition_Handle = LVM_Common_Services->InsertObject(LVM_Common_Services->Aggregates, sizeof(Partition_Data), Aggregate, PARTITION_DATA_TAG, NULL, AppendToList, FALSE, Error_Code);
+  if ( *Error_Code != DLIST_SUCCESS )
+  {
+
+    FEATURE_FUNCTION_EXIT("Eliminate_Bad_Aggregates")
+
+    /* We may be out of memory, or worse! */
+    return FALSE;
+
+  }
+
+
+  /* Since we got here, we will be keeping this Aggregate.  */
+  Validation_Record->Volume_Created = TRUE;
+  *(Validation_Record->Error_Code) = LVM_ENGINE_NO_ERROR;
+
+  FEATURE_FUNCTION_EXIT("Eliminate_Bad_Aggregates")
+
+  return FALSE;
+
+}
+
+
+static void Discard_Aggregate( Partition_Data * Aggregate )
+{
+
+  CARDINAL32   Ignore_Error;
+
+  /* Free any memory held by the Aggregate.  The Aggregate itself is freed by PruneList. */
+  LVM_Common_Services->Destroy_Handle(Aggregate->External_Handle,&Ignore_Error);
+  LVM_Common_Services->Deallocate(Aggregate->Feature_Data->Data);
+  LVM_Common_Services->Deallocate(Aggregate->Signature_Sector);
+  LVM_Common_Services->DestroyList( &(Aggregate->Feature_Data->Partitions), FALSE, &Ignore_Error);
+  LVM_Common_Services->Deallocate(Aggregate->Feature_Data);
+
+  return;
+
+}
+
+
+static BOOLEAN _System Load_Feature_Data(Partition_Data * PartitionRecord, Mirror_Array * MirrorTable, CARDINAL32 * Error_Code)
+{
+
+  CARDINAL32                       TargetSector;
+  CARDINAL32                       FeatureIndex;
+  CARDINAL32                       MemberIndex;
+  LVM_Signature_Sector *           Signature_Sector;
+  LVM_Mirror_Table_Sector *        First_Copy = (LVM_Mirror_Table_Sector *) &Feature_Data_Buffer1;
+  LVM_Mirror_Table_Sector *        Second_Copy = (LVM_Mirror_Table_Sector *) &Feature_Data_Buffer2;
+  LVM_Mirror_Table_Sector *        Table_Sector;
+  LVM_Mirror_Bitmap_Sector *       Bitmap_Sector;
+  Plugin_Function_Table_V1 *       Old_Function_Table;
+  BOOLEAN                          Primary_Copy_Valid;
+  BOOLEAN                          Secondary_Copy_Valid;
+
+  FEATURE_FUNCTION_ENTRY("Load_Feature_Data")
+
+  /* Get the signature sector. */
+  Signature_Sector = PartitionRecord->Signature_Sector;
+
+  /* Find the Mirroring entry in the LVM Signature Sector. */
+  for ( FeatureIndex = 0; FeatureIndex < MAX_FEATURES_PER_VOLUME; FeatureIndex++)
+  {
+
+    if ( Signature_Sector->LVM_Feature_Array[FeatureIndex].Feature_ID == MIRRORING_FEATURE_ID )
+      break;
+
+  }
+
+  if ( FeatureIndex >= MAX_FEATURES_PER_VOLUME )
+  {
+
+    LOG_FEATURE_ERROR("Mirroring is not listed in the LVM Signature Sector of the partition!")
+
+    *Error_Code = LVM_ENGINE_NO_ERROR;
+
+    FEATURE_FUNCTION_EXIT("Load_Feature_Data")
+
+    return FALSE;
+
+  }
+
+  /* Find the location of the feature data for Mirroring from the LVM_Signature_Sector. */
+  TargetSector = Signature_Sector->LVM_Feature_Array[FeatureIndex].Location_Of_Primary_Feature_Data;
+
+  /* Read in the feature data for mirroring. */
+  Old_Function_Table = (Plugin_Function_Table_V1 *) PartitionRecord->Feature_Data->Function_Table;
+  Old_Function_Table->Read(PartitionRecord, TargetSector, MIRRORING_RESERVED_SECTOR_COUNT, &Feature_Data_Buffer1, Error_Code);
+
+  /* Did we succeed? */
+  if ( *Error_Code != LVM_ENGINE_NO_ERROR )
+  {
+
+    LOG_FEATURE_EVENT1("Error reading the primary copy of the feature data!", "Error code", *Error_Code)
+
+    if ( *Error_Code != LVM_ENGINE_IO_ERROR )
+    {
+
+      FEATURE_FUNCTION_EXIT("Load_Feature_Data")
+
+      return FALSE;
+
+    }
+
+    Primary_Copy_Valid = FALSE;
+
+  }
+  else
+    Primary_Copy_Valid = Feature_Data_Is_Valid( &Feature_Data_Buffer1 );
+
+  /* Now read in the second copy of the Feature Data. */
+  TargetSector = Signature_Sector->LVM_Feature_Array[FeatureIndex].Location_Of_Secondary_Feature_Data;
+
+  Old_Function_Table->Read(PartitionRecord, TargetSector, MIRRORING_RESERVED_SECTOR_COUNT, &Feature_Data_Buffer2, Error_Code);
+
+  /* Did we succeed? */
+  if ( *Error_Code != LVM_ENGINE_NO_ERROR )
+  {
+
+    LOG_FEATURE_EVENT1("Error reading the secondary copy of the feature data!","Error code", *Error_Code)
+
+    if ( *Error_Code != LVM_ENGINE_IO_ERROR )
+    {
+
+      FEATURE_FUNCTION_EXIT("Load_Feature_Data")
+
+      return FALSE;
+
+    }
+
+    Secondary_Copy_Valid = FALSE;
+
+  }
+  else
+    Secondary_Copy_Valid = Feature_Data_Is_Valid( &Feature_Data_Buffer2 );
+
+  /* Decide which copy to use. */
+  if ( Primary_Copy_Valid && Secondary_Copy_Valid )
+  {
+
+    /* Since both copies are valid, do they agree? */
+    if ( memcmp(&Feature_Data_Buffer1, &Feature_Data_Buffer2, BYTES_PER_SECTOR * MIRRORING_RESERVED_SECTOR_COUNT) != 0 )
+    {
+
+      LOG_FEATURE_EVENT("Both copies of the feature data appear to be valid, but they do not match!")
+
+      /* They do not agree!  We will use the one with the higher Sequence Count. */
+      if ( First_Copy->Sequence_Number > Second_Copy->Sequence_Number )
+      {
+
+        LOG_FEATURE_EVENT("Using the first copy of the feature data (higher sequence number).")
+
+        Table_Sector = First_Copy;
+
+      }
+      else
+      {
+
+        if ( First_Copy->Sequence_Number < Second_Copy->Sequence_Number )
+        {
+
+          LOG_FEATURE_EVENT("Using the second copy of the feature data (higher sequence number).")
+
+          Table_Sector = Second_Copy;
+
+        }
+        else
+        {
+
+          LOG_FEATURE_ERROR("The sequence numbers match!  Unable to choose which copy of the feature data to use!")
+
+          *Error_Code = LVM_ENGINE_NO_ERROR;
+
+          FEATURE_FUNCTION_EXIT("Load_Feature_Data")
+
+          return FALSE;
+
+        }
+
+      }
+
+      /* Mark the mirror table as having had changes made so that the two copies of the data will be synchronized if
+         a commit operation is done.                                                                                     */
+      MirrorTable->ChangesMade = TRUE;
+
+    }
+    else
+      Table_Sector = First_Copy;
+
+  }
+  else
+  {
+
+    if ( Primary_Copy_Valid )
+    {
+
+      LOG_FEATURE_EVENT("Using the primary copy of the feature data.")
+
+      Table_Sector = First_Copy;
+
+    }
+    else
+    {
+
+      if ( ! Secondary_Copy_Valid )
+      {
+
+        LOG_FEATURE_ERROR("No valid feature data found!")
+
+        /* There is no valid copy of the feature data for this partition! */
+        *Error_Code = LVM_ENGINE_NO_ERROR;
+
+        FEATURE_FUNCTION_EXIT("Load_Feature_Data")
+
+        return FALSE;
+
+      }
+
+      LOG_FEATURE_EVENT("Using the secondary copy of the feature data.")
+
+      Table_Sector = Second_Copy;
+
+    }
+
+    LOG_FEATURE_EVENT("The mirror table has been marked dirty so that both copies of the feature data may be synchronized.")
+
+    /* Mark the mirror table as having had changes made so that the two copies of the data will be synchronized if
+       a commit operation is done.                                                                                     */
+    MirrorTable->ChangesMade = TRUE;
+
+  }
+
+  /* Copy the mirror table into the MirrorTable. */
+  MirrorTable->Members_In_Use = Table_Sector->Members_In_Use;
+  MirrorTable->Member_Size = Table_Sector->Member_Size;
+  MirrorTable->Region_Size = Table_Sector->Region_Size;
+  MirrorTable->Sequence_Number = Table_Sector->Sequence_Number;
+  MirrorTable->Aggregate_Serial_Number = Table_Sector->Aggregate_Serial_Number;
+  MirrorTable->Actual_Class = Table_Sector->Actual_Class;
+  MirrorTable->Top_Of_Class = Table_Sector->Top_Of_Class;
+  MirrorTable->Feature_Sequence_Number = Table_Sector->Feature_Sequence_Number;
+
+  for ( MemberIndex = 0; MemberIndex < MAXIMUM_MIRROR_MEMBERS; MemberIndex++ )
+  {
+
+    MirrorTable->MemberArray[MemberIndex].Member_Data = Table_Sector->Member_Table[MemberIndex];
+    MirrorTable->MemberArray[MemberIndex].PartitionRecord = NULL;
+    MirrorTable->MemberArray[MemberIndex].Next_Sector = 0;
+
+    /* The bitmap for each member follows the mirror table. */
+    Bitmap_Sector = (LVM_Mirror_Bitmap_Sector *) ( (BYTE *) Table_Sector + ( MemberIndex + 1 ) * BYTES_PER_SECTOR );
+    memcpy(MirrorTable->Stale_Regions[MemberIndex], Bitmap_Sector->Stale_Regions, MIRROR_BITMAP_SIZE);
+
+  }
+
+  /* We must find this Partition Record in the mirror table and place a pointer to it there. */
+  for ( MemberIndex = 0; MemberIndex < MirrorTable->Members_In_Use; MemberIndex++)
+  {
+
+    if ( ( MirrorTable->MemberArray[MemberIndex].Member_Data.Drive_Serial_Number == Member_Drive_Serial_Number( PartitionRecord ) ) &&
+         ( MirrorTable->MemberArray[MemberIndex].Member_Data.Partition_Serial_Number == PartitionRecord->DLA_Table_Entry.Partition_Serial_Number )
+       )
+    {
+
+      /* We have found our position in the mirror table.  Place a pointer to the PartitionRecord in the mirror table. */
+      MirrorTable->MemberArray[MemberIndex].PartitionRecord = PartitionRecord;
+
+      /* We found what we were looking for.  Stop the search. */
+      break;
+
+    }
+
+  }
+
+  if ( MemberIndex >= MirrorTable->Members_In_Use )
+  {
+
+    LOG_FEATURE_ERROR("A partition claimed to be part of a mirrored aggregate, but was not found in the mirror table!")
+
+    /* This partition claims to be part of this aggregate, but it does not appear in the mirror table for this aggregate! */
+    *Error_Code = LVM_ENGINE_NO_ERROR;
+
+    FEATURE_FUNCTION_EXIT("Load_Feature_Data")
+
+    return FALSE;
+
+  }
+
+  /* Indicate success and return. */
+  *Error_Code = DLIST_SUCCESS;
+
+  FEATURE_FUNCTION_EXIT("Load_Feature_Data")
+
+  return TRUE;
+
+}
+
+
+static BOOLEAN Feature_Data_Is_Valid( ADDRESS Buffer )
+{
+
+  LVM_Mirror_Table_Sector *    Table_Sector = (LVM_Mirror_Table_Sector *) Buffer;
+
+  FEATURE_FUNCTION_ENTRY("Feature_Data_Is_Valid")
+
+  /* Check the signatures and CRCs of the mirror table and the bitmaps which follow it.  The bitmaps must have been written
+     along with the mirror table, so their sequence numbers must match that of the mirror table.                            */
+  if ( LVM_Common_Services->Validate_Feature_Sectors( Buffer,
+                                                      MIRRORING_RESERVED_SECTOR_COUNT,
+                                                      MIRROR_TABLE_SIGNATURE,
+                                                      MIRROR_BITMAP_SIGNATURE,
+                                                      NULL ) != MIRRORING_RESERVED_SECTOR_COUNT )
+  {
+
+    LOG_FEATURE_ERROR("The mirror table or one of its bitmaps is invalid!  The feature data is not valid!")
+
+    FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
+
+    /* The data in the buffer is not valid! */
+    return FALSE;
+
+  }
+
+  /* Check the mirror geometry.  The bitmaps must be able to cover every sector of a member. */
+  if ( ( Table_Sector->Members_In_Use < 2 ) ||
+       ( Table_Sector->Members_In_Use > MAXIMUM_MIRROR_MEMBERS ) ||
+       ( Table_Sector->Member_Size == 0 ) ||
+       ( Table_Sector->Region_Size == 0 ) ||
+       ( ( Table_Sector->Member_Size + Table_Sector->Region_Size - 1 ) / Table_Sector->Region_Size > MIRROR_REGION_COUNT )
+     )
+  {
+
+    LOG_FEATURE_ERROR("The mirror geometry is invalid!  The feature data is not valid!")
+
+    FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
+
+    /* The data in the buffer is not valid! */
+    return FALSE;
+
+  }
+
+  FEATURE_FUNCTION_EXIT("Feature_Data_Is_Valid")
+
+  return TRUE;
+
+}
+
+
+static CARDINAL32 Member_Drive_Serial_Number( Partition_Data * PartitionRecord )
+{
+
+  /* A partition which is itself an aggregate is not on any one drive. */
+  if ( ( PartitionRecord->Drive_Index == 0xFFFFFFFFL ) ||
+       ( PartitionRecord->Drive_Index >= LVM_Common_Services->DriveCount )
+     )
+    return 0;
+
+  return LVM_Common_Services->DriveArray[PartitionRecord->Drive_Index].Drive_Serial_Number;
+
+}
+
+
+static void _System Find_Smallest_Member(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error_Code)
+{
+
+  Partition_Data *       PartitionRecord = (Partition_Data *) Object;
+  CARDINAL32 *           Smallest_Member = (CARDINAL32 *) Parameters;
+  CARDINAL32             Available_Sectors;
+
+  FEATURE_FUNCTION_ENTRY("Find_Smallest_Member")
+
+#ifdef DEBUG
+
+#ifdef PARANOID
+
+  assert( ObjectTag == PARTITION_DATA_TAG );
+  assert( ObjectSize == sizeof(Partition_Data) );
+
+#else
+
+  if ( ( ObjectTag != PARTITION_DATA_TAG ) ||
+       ( ObjectSize != sizeof(Partition_Data) )
+     )
+  {
+
+    *Error_Code = DLIST_CORRUPTED;
+
+    FEATURE_FUNCTION_EXIT("Find_Smallest_Member")
+
+    return;
+
+  }
+
+#endif
+
+#endif
+
+  /* How many sectors will be left for us?  A partition without an LVM Signature Sector will be given one by
+     Initialize_Mirror_Partitions, so allow for it.                                                          */
+  if ( PartitionRecord->Signature_Sector != NULL )
+    Available_Sectors = PartitionRecord->Signature_Sector->Partition_Size_To_Report_To_User;
+  else
+    Available_Sectors = PartitionRecord->DLA_Table_Entry.Partition_Size - 1;
+
+  if ( Available_Sectors < *Smallest_Member )
+    *Smallest_Member = Available_Sectors;
+
+  *Error_Code = DLIST_SUCCESS;
+
+  FEATURE_FUNCTION_EXIT("Find_Smallest_Member")
+
+  return;
+
+}
+
+
+static void _System Find_Shared_Drives(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error_Code)
+{
+
+  Partition_Data *       PartitionRecord = (Partition_Data *) Object;
+  Drive_Check_Record *   Drive_Check = (Drive_Check_Record *) Parameters;
+  CARDINAL32             Drive_Serial_Number;
+  CARDINAL32             Index;
+
+  FEATURE_FUNCTION_ENTRY("Find_Shared_Drives")
+
+#ifdef DEBUG
+
+#ifdef PARANOID
+
+  assert( ObjectTag == PARTITION_DATA_TAG );
+  assert( ObjectSize == sizeof(Partition_Data) );
+
+#else
+
+  if ( ( ObjectTag != PARTITION_DATA_TAG ) ||
+       ( ObjectSize != sizeof(Partition_Data) )
+     )
+  {
+
+    *Error_Code = DLIST_CORRUPTED;
+
+    FEATURE_FUNCTION_EXIT("Find_Shared_Drives")
+
+    return;
+
+  }
+
+#endif
+
+#endif
+
+  *Error_Code = DLIST_SUCCESS;
+
+  /* A partition which is itself an aggregate is not on any one drive, so there is nothing to check. */
+  Drive_Serial_Number = Member_Drive_Serial_Number( PartitionRecord );
+  if ( Drive_Serial_Number == 0 )
+  {
+
+    FEATURE_FUNCTION_EXIT("Find_Shared_Drives")
+
+    return;
+
+  }
+
+  /* Have we already seen a partition on this drive? */
+  for ( Index = 0; Index < Drive_Check->Drives_Seen; Index++ )
+  {
+
+    if ( Drive_Check->Drive_Serial_Numbers[Index] == Drive_Serial_Number )
+    {
+
+      Drive_Check->Drive_Shared = TRUE;
+
+      FEATURE_FUNCTION_EXIT("Find_Shared_Drives")
+
+      return;
+
+    }
+
+  }
+
+  if ( Drive_Check->Drives_Seen < MAXIMUM_MIRROR_MEMBERS )
+  {
+
+    Drive_Check->Drive_Serial_Numbers[Drive_Check->Drives_Seen] = Drive_Serial_Number;
+    Drive_Check->Drives_Seen++;
+
+  }
+
+  FEATURE_FUNCTION_EXIT("Find_Shared_Drives")
+
+  return;
+
+}
+
+
+static void _System Initialize_Mirror_Partitions(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error_Code)
+{
+
+  Partition_Data *       Aggregate = (Partition_Data *) Parameters;
+  Partition_Data *       PartitionRecord = (Partition_Data *) Object;
+  LVM_Signature_Sector * Signature_Sector;
+  CARDINAL32             FeatureIndex;
+  Mirror_Array *         MirrorTable;
+
+  FEATURE_FUNCTION_ENTRY("Initialize_Mirror_Partitions")
+
+#ifdef DEBUG
+
+#ifdef PARANOID
+
+  assert( ObjectTag == PARTITION_DATA_TAG );
+  assert( ObjectSize == sizeof(Partition_Data) );
+
+#else
+
+  if ( ( ObjectTag != PARTITION_DATA_TAG ) ||
+       ( ObjectSize != sizeof(Partition_Data) )
+     )
+  {
+
+    *Error_Code = DLIST_CORRUPTED;
+
+    FEATURE_FUNCTION_EXIT("Initialize_Mirror_Partitions")
+
+    return;
+
+  }
+
+#endif
+
+#endif
+
+  /* Get the mirror table for this aggregate. */
+  MirrorTable = ( Mirror_Array *) Aggregate->Feature_Data->Data;
+
+  /* Update the Partition Record. */
+
+  /* Does the Partition Record have an LVM Signature Sector? */
+  if ( PartitionRecord->Signature_Sector == NULL )
+  {
+
+    /* Since the Create_Volume code always provides a Signature Sector on the partitions it passes it,
+       we must have an aggregate here.                                                                  */
+
+    /* Allocate an LVM Signature Sector for this partition. */
+    PartitionRecord->Signature_Sector = (LVM_Signature_Sector *) LVM_Common_Services->Allocate( BYTES_PER_SECTOR );
+
+    if (PartitionRecord->Signature_Sector == NULL)
+    {
+
+      *Error_Code = DLIST_OUT_OF_MEMORY;
+
+      FEATURE_FUNCTION_EXIT("Initialize_Mirror_Partitions")
+
+      return;
+
+    }
+
+    /* Initialize the LVM Signature Sector. */
+    Signature_Sector = PartitionRecord->Signature_Sector;
+    memset(Signature_Sector,0, BYTES_PER_SECTOR);
+    Signature_Sector->LVM_Signature1 = LVM_PRIMARY_SIGNATURE;
+    Signature_Sector->LVM_Signature2 = LVM_SECONDARY_SIGNATURE;
+    Signature_Sector->Signature_Sector_CRC = 0;
+    Signature_Sector->Partition_Serial_Number = PartitionRecord->DLA_Table_Entry.Partition_Serial_Number;
+    Signature_Sector->Partition_Start = PartitionRecord->DLA_Table_Entry.Partition_Start;
+    Signature_Sector->Partition_End = PartitionRecord->DLA_Table_Entry.Partition_Start + PartitionRecord->DLA_Table_Entry.Partition_Size - 1;
+    Signature_Sector->Partition_Sector_Count = PartitionRecord->DLA_Table_Entry.Partition_Size;
+    Signature_Sector->Partition_Size_To_Report_To_User = PartitionRecord->DLA_Table_Entry.Partition_Size - 1;      /* One sector reserved for LVM Signature Sector. */
+    Signature_Sector->LVM_Reserved_Sector_Count = 1;
+    Signature_Sector->Boot_Disk_Serial_Number = *(LVM_Common_Services->Boot_Drive_Serial_Number);
+    Signature_Sector->Volume_Serial_Number = 0;
+    Signature_Sector->LVM_Major_Version_Number = CURRENT_LVM_MAJOR_VERSION_NUMBER;
+    Signature_Sector->LVM_Minor_Version_Number = CURRENT_LVM_MINOR_VERSION_NUMBER;
+    strncpy(Signature_Sector->Partition_Name, PartitionRecord->Partition_Name, PARTITION_NAME_SIZE);
+    strncpy(Signature_Sector->Volume_Name, PartitionRecord->DLA_Table_Entry.Volume_Name, VOLUME_NAME_SIZE);
+    PartitionRecord->Usable_Size = Signature_Sector->Partition_Sector_Count - Signature_Sector->LVM_Reserved_Sector_Count;
+
+  }
+  else
+  {
+
+    /* Establish access to the partitions LVM Signature Sector. */
+    Signature_Sector = PartitionRecord->Signature_Sector;
+
+  }
+
+
+  /* Now add mirroring to the LVM Signature sector. */
+  for ( FeatureIndex = 0; FeatureIndex < MAX_FEATURES_PER_VOLUME ; FeatureIndex++)
+  {
+
+    if ( Signature_Sector->LVM_Feature_Array[FeatureIndex].Feature_ID == 0)
+    {
+
+      /* We have found an open entry!  Lets fill it in. */
+      Signature_Sector->LVM_Feature_Array[FeatureIndex].Feature_ID = MIRRORING_FEATURE_ID;
+      Signature_Sector->LVM_Feature_Array[FeatureIndex].Feature_Active = TRUE;
+      Signature_Sector->LVM_Feature_Array[FeatureIndex].Feature_Data_Size = MIRRORING_RESERVED_SECTOR_COUNT;
+      Signature_Sector->LVM_Feature_Array[FeatureIndex].Feature_Major_Version_Number = MIRRORING_MAJOR_VERSION;
+      Signature_Sector->LVM_Feature_Array[FeatureIndex].Feature_Minor_Version_Number = MIRRORING_MINOR_VERSION;
+      Signature_Sector->LVM_Reserved_Sector_Count += MIRRORING_RESERVED_SECTOR_COUNT;
+      Signature_Sector->LVM_Feature_Array[FeatureIndex].Location_Of_Primary_Feature_Data = ( Signature_Sector->Partition_End - Signature_Sector->LVM_Reserved_Sector_Count) + 1;
+      Signature_Sector->LVM_Reserved_Sector_Count += MIRRORING_RESERVED_SECTOR_COUNT;
+      Signature_Sector->LVM_Feature_Array[FeatureIndex].Location_Of_Secondary_Feature_Data = ( Signature_Sector->Partition_End - Signature_Sector->LVM_Reserved_Sector_Count) + 1;
+      Signature_Sector->Partition_Size_To_Report_To_User = Signature_Sector->Partition_Sector_Count - Signature_Sector->LVM_Reserved_Sector_Count;
+      PartitionRecord->Usable_Size = Signature_Sector->Partition_Size_To_Report_To_User;
+
+      /* Exit the loop. */
+      break;
+    }
+
+  }
+
+  /* Add the partition to the mirror table.  Members are placed in the mirror table in the order in which they were given
+     to us.  The size of the aggregate is set by Create_Mirror_Volume once all of the members are in place.               */
+  MirrorTable->MemberArray[MirrorTable->Members_In_Use].Member_Data.Drive_Serial_Number = Member_Drive_Serial_Number( PartitionRecord );
+  MirrorTable->MemberArray[MirrorTable->Members_In_Use].Member_Data.Partition_Serial_Number = PartitionRecord->DLA_Table_Entry.Partition_Serial_Number;
+  MirrorTable->MemberArray[MirrorTable->Members_In_Use].PartitionRecord = PartitionRecord;
+  MirrorTable->MemberArray[MirrorTable->Members_In_Use].Next_Sector = 0;
+  MirrorTable->Members_In_Use++;
+  MirrorTable->ChangesMade = TRUE;
+
+  /* Indicate success and return. */
+  *Error_Code = DLIST_SUCCESS;
+
+  FEATURE_FUNCTION_EXIT("Initialize_Mirror_Partitions")
+
+  return;
+
+}
+
+
+static void _System Remove_Features_From_Aggregate_Partitions( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error_Code)
+{
+
+  /* Declare a local variable to walk the LVM Signature Sector Feature Array. */
+  CARDINAL32                 FeatureIndex;
+
+  /* Declare a local variable so that we can access the LVM Signature Sector without having to use a double indirection each time. */
+  LVM_Signature_Sector *     Signature_Sector;
+
+  Partition_Data *           PartitionRecord = (Partition_Data *) Object;
+  Plugin_Function_Table_V1 * Old_Function_Table;
+
+  FEATURE_FUNCTION_ENTRY("Remove_Features_From_Aggregate_Partitions")
+
+#ifdef DEBUG
+
+  /* Is Object what we think it should be? */
+  if ( ( ObjectTag != PARTITION_DATA_TAG ) || ( ObjectSize != sizeof(Partition_Data) ) )
+  {
+
+
+#ifdef PARANOID
+
+    assert(0);
+
+#endif
+
+
+    /* Object's TAG is not what we expected!  Abort! */
+    *Error_Code = DLIST_CORRUPTED;
+
+    FEATURE_FUNCTION_EXIT("Remove_Features_From_Aggregate_Partitions")
+
+    return;
+
+  }
+
+#endif
+
+  /* Remove Mirroring from the Feature Table in the LVM Signature Sector. */
+  if ( PartitionRecord->Signature_Sector != NULL )
+  {
+
+    /* Get the signature sector. */
+    Signature_Sector = PartitionRecord->Signature_Sector;
+
+    /* Is Mirroring listed in the LVM Signature Sector? */
+    for ( FeatureIndex = 0; FeatureIndex < MAX_FEATURES_PER_VOLUME; FeatureIndex++)
+    {
+
+      if ( Signature_Sector->LVM_Feature_Array[FeatureIndex].Feature_ID == MIRRORING_FEATURE_ID )
+      {
+
+        /* We have found the entry for Mirroring.  Nuke it. */
+        memset(&(Signature_Sector->LVM_Feature_Array[FeatureIndex].Feature_ID), 0, sizeof(LVM_Feature_Data) );
+
+      }
+
+    }
+
+  }
+
+  /* Remove the partition from whatever features may have hooked it before us. */
+  Old_Function_Table = PartitionRecord->Feature_Data->Function_Table;
+  Old_Function_Table->Remove_Features( PartitionRecord, Error_Code);
+
+  FEATURE_FUNCTION_EXIT("Remove_Features_From_Aggregate_Partitions")
+
+  return;
+
+}
+
+
+static BOOLEAN  _System Delete_Partitions( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, BOOLEAN * FreeMemory, CARDINAL32 * Error_Code)
+{
+
+  Partition_Data *            PartitionRecord = (Partition_Data *) Object;
+  Partition_Deletion_Record * Deletion_Data = (Partition_Deletion_Record *) Parameters;
+  Plugin_Function_Table_V1 *  Old_Function_Table;
+
+
+  FEATURE_FUNCTION_ENTRY("Delete_Partitions")
+
+  /* We don't want the partition record deleted by PruneList again, so set FreeMemory to false. */
+  *FreeMemory = FALSE;
+
+#ifdef DEBUG
+
+#ifdef PARANOID
+
+   assert(Object != NULL);
+   assert(ObjectSize == sizeof(Partition_Data) );
+   assert(Parameters != NULL);
+   assert(PartitionRecord->Feature_Data != NULL );
+
+#else
+
+   if ( ( Object == NULL ) ||
+        ( ObjectSize != sizeof( Partition_Data ) ) ||
+        ( Parameters == NULL ) ||
+        ( PartitionRecord->Feature_Data == NULL )
+      )
+   {
+
+     *Error_Code = DLIST_CORRUPTED;
+
+     FEATURE_FUNCTION_EXIT("Delete_Partitions")
+
+     return FALSE;
+
+   }
+
+#endif
+
+#endif
+
+   /* Call the delete function for this partition. */
+   Old_Function_Table = PartitionRecord->Feature_Data->Function_Table;
+   Old_Function_Table->Delete( PartitionRecord, Deletion_Data->Kill_Partitions, &(Deletion_Data->LVM_Error) );
+
+   if ( Deletion_Data->LVM_Error != LVM_ENGINE_NO_ERROR )
+     *Error_Code = DLIST_CORRUPTED;
+   else
+     *Error_Code = DLIST_SUCCESS;
+
+
+   FEATURE_FUNCTION_EXIT("Delete_Partitions")
+
+   return TRUE;
+
+}
+
+
+
+
+static void _System Write_Feature_Data(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error_Code)
+{
+
+  Partition_Data *           PartitionRecord = (Partition_Data *) Object;
+  LVM_Signature_Sector *     Signature_Sector;
+  LVM_Feature_Data     *     Feature_Data;
+  CARDINAL32                 FeatureIndex;
+  BOOLEAN                    Feature_Found = FALSE;
+  Commit_Changes_Record *    Commit_Data = (Commit_Changes_Record *) Parameters;
+  Plugin_Function_Table_V1 * Old_Function_Table;
+
+
+  FEATURE_FUNCTION_ENTRY("Write_Feature_Data")
+
+#ifdef DEBUG
+
+#ifdef PARANOID
+
+  assert( ObjectTag == PARTITION_DATA_TAG );
+  assert( ObjectSize == sizeof(Partition_Data) );
+
+#else
+
+  if ( ( ObjectTag != PARTITION_DATA_TAG ) ||
+       ( ObjectSize != sizeof(Partition_Data) )
+     )
+  {
+
+    *Error_Code = DLIST_CORRUPTED;
+
+    FEATURE_FUNCTION_EXIT("Write_Feature_Data")
+
+    return;
+
+  }
+
+#endif
+
+#endif
+
+  /* Get the function table for the feature below mirroring on this partition. */
+  Old_Function_Table = PartitionRecord->Feature_Data->Function_Table;
+
+  /* Assume success in case there is nothing for us to write. */
+  *Error_Code = DLIST_SUCCESS;
+
+  /* Do we need to write mirroring data to disk? */
+  if ( Commit_Data->Commit_Mirroring_Changes )
+  {
+
+    /* Get the LVM Signature Sector. */
+    Signature_Sector = PartitionRecord->Signature_Sector;
+
+    /* Find where Mirroring feature data is stored on this partition. */
+    for ( FeatureIndex = 0; FeatureIndex < MAX_FEATURES_PER_VOLUME ; FeatureIndex++)
+    {
+
+      if ( Signature_Sector->LVM_Feature_Array[FeatureIndex].Feature_ID == MIRRORING_FEATURE_ID )
+      {
+
+        /* We have found the entry for Mirroring.  */
+        Feature_Found = TRUE;
+        Feature_Data = &(Signature_Sector->LVM_Feature_Array[FeatureIndex]);
+
+        /* Now write the data to the specified locations. */
+        Old_Function_Table->Write( PartitionRecord, Feature_Data->Location_Of_Primary_Feature_Data, MIRRORING_RESERVED_SECTOR_COUNT, &Feature_Data_Buffer1, Error_Code);
+        if ( *Error_Code != LVM_ENGINE_NO_ERROR)
+        {
+
+          if (*Error_Code != LVM_ENGINE_IO_ERROR)
+          {
+
+            *Error_Code = DLIST_CORRUPTED;
+
+            FEATURE_FUNCTION_EXIT("Write_Feature_Data")
+
+            return;
+
+          }
+
+        }
+
+        Old_Function_Table->Write( PartitionRecord, Feature_Data->Location_Of_Secondary_Feature_Data, MIRRORING_RESERVED_SECTOR_COUNT, &Feature_Data_Buffer1, Error_Code);
+        if ( *Error_Code != LVM_ENGINE_NO_ERROR)
+        {
+
+          if (*Error_Code != LVM_ENGINE_IO_ERROR)
+          {
+
+            *Error_Code = DLIST_CORRUPTED;
+
+            FEATURE_FUNCTION_EXIT("Write_Feature_Data")
+
+            return;
+
+          }
+
+        }
+
+        /* Exit the loop. */
+        break;
+
+      }
+
+    }
+
+    /* Did we find the entry for mirroring? */
+    if ( ! Feature_Found )
+      *Error_Code = DLIST_CORRUPTED;
+    else
+      *Error_Code = DLIST_SUCCESS;
+
+  }
+
+  /* Were there errors, or can we continue? */
+  if ( *Error_Code == DLIST_SUCCESS )
+  {
+
+    /* We need to call the commit function for any other features which may be in effect on this partition.
+       If there are no other features on this partition, then the commit function will go to the Pass Thru layer. */
+    Old_Function_Table->Commit( Commit_Data->VData ,PartitionRecord, Error_Code);
+
+    switch ( *Error_Code )
+    {
+      case LVM_ENGINE_NO_ERROR : *Error_Code = DLIST_SUCCESS;
+                                 break;
+      case LVM_ENGINE_OUT_OF_MEMORY : *Error_Code = DLIST_OUT_OF_MEMORY;
+                                      break;
+      default : *Error_Code = DLIST_CORRUPTED;
+                break;
+    }
+
+  }
+
+  FEATURE_FUNCTION_EXIT("Write_Feature_Data")
+
+  return;
+
+}
+
+
+static void _System Set_Spanned_Volume_Flag(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error)
+{
+
+  /* Declare a local variable so that we can access the Partition_Data without having to typecast each time. */
+  Partition_Data * PartitionRecord = (Partition_Data *) Object;
+
+  FEATURE_FUNCTION_ENTRY("Set_Spanned_Volume_Flag")
+
+#ifdef DEBUG
+
+  /* Is Object what we think it should be? */
+  if ( ( ObjectTag != PARTITION_DATA_TAG ) || ( ObjectSize != sizeof(Partition_Data) ) )
+  {
+
+
+#ifdef PARANOID
+
+    assert(0);
+
+#endif
+
+
+    /* Object's TAG is not what we expected!  Abort! */
+    *Error = LVM_ENGINE_INTERNAL_ERROR;
+
+    FEATURE_FUNCTION_EXIT("Set_Spanned_Volume_Flag")
+
+    return;
+
+  }
+
+#endif
+
+  /* Well, Object has the correct TAG so we will assume that it points to an item of type Partition_Data. */
+
+  /* Does this partition record represent a partition? */
+  if ( PartitionRecord->Partition_Type == Partition )
+  {
+
+    /* Set the Spanned_Volume flag. */
+    PartitionRecord->Spanned_Volume = TRUE;
+
+  }
+
+  /* Indicate success and leave. */
+  *Error = DLIST_SUCCESS;
+
+  FEATURE_FUNCTION_EXIT("Set_Spanned_Volume_Flag")
+
+  return;
+
+}
+
+
+static void _System Remove_Features(ADDRESS Aggregate, CARDINAL32 * Error_Code)
+{
+
+  Partition_Data *           PartitionRecord = (Partition_Data *) Aggregate;
+  CARDINAL32                 Ignore_Error;
+
+  FEATURE_FUNCTION_ENTRY("Remove_Features")
+
+  /* Do we have a partition or an aggregate?  If we have an aggregate, then there should be Mirroring Feature Data.
+     If we have a partition, then Mirroring may be listed in its LVM Signature Sector, but there will NOT be any
+     Mirroring Feature Data.                                                                                         */
+  if ( PartitionRecord->Signature_Sector == NULL )
+  {
+
+    /* There is no LVM Signature Sector!  This is not correct! */
+    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+    FEATURE_FUNCTION_EXIT("Remove_Features")
+
+    return;
+
+  }
+
+  if ( ( PartitionRecord->Feature_Data == NULL ) ||
+       ( PartitionRecord->Feature_Data->Feature_ID->ID != MIRRORING_FEATURE_ID )
+     )
+  {
+
+    /* We just need to make sure that mirroring is removed from the LVM Signature Sector. */
+    Remove_Features_From_Aggregate_Partitions(PartitionRecord, PARTITION_DATA_TAG, sizeof(Partition_Data), NULL, NULL, Error_Code);
+
+    if ( *Error_Code != DLIST_SUCCESS )
+      *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+  }
+  else
+  {
+
+    /* We have an aggregate here.  We need to delete the Aggregate and then process the partitions belonging to the aggregate. */
+
+    /* Process the partitions belonging to the aggregate first. */
+    LVM_Common_Services->ForEachItem(PartitionRecord->Feature_Data->Partitions, &Remove_Features_From_Aggregate_Partitions, NULL, TRUE, Error_Code);
+    if ( *Error_Code != DLIST_SUCCESS )
+    {
+
+      *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+      FEATURE_FUNCTION_EXIT("Remove_Features")
+
+      return;
+
+    }
+
+    /* Free any memory held by the Aggregate. */
+    LVM_Common_Services->Deallocate(PartitionRecord->Feature_Data->Data);
+    LVM_Common_Services->Deallocate(PartitionRecord->Signature_Sector);
+    LVM_Common_Services->DestroyList( &(PartitionRecord->Feature_Data->Partitions), FALSE, &Ignore_Error);
+    LVM_Common_Services->Deallocate(PartitionRecord->Feature_Data);
+
+    /* Remove the Aggregate from the list of Aggregates. */
+    LVM_Common_Services->DeleteItem(LVM_Common_Services->Aggregates, FALSE, PartitionRecord->Drive_Partition_Handle, &Ignore_Error);
+
+    /* Now delete the aggregate. */
+    LVM_Common_Services->Deallocate(Aggregate);
+
+  }
+
+  FEATURE_FUNCTION_EXIT("Remove_Features")
+
+  /* All done. */
+  return;
+
+}
+
+
+static void _System PassThru( CARDINAL32 Feature_ID, ADDRESS Aggregate, ADDRESS InputBuffer, CARDINAL32 InputSize, ADDRESS * OutputBuffer, CARDINAL32 * OutputSize, CARDINAL32 * Error_Code )
+{
+
+  Partition_Data *           PartitionRecord = (Partition_Data *) Aggregate;
+  PassThru_Data_Record       PassThru_Data;
+  CARDINAL32                 LocalError;
+
+  FEATURE_FUNCTION_ENTRY("PassThru")
+
+  /* Save the PassThru parameters.  We will need to pass them to the first feature on each of the partitions in the Aggregate. */
+  PassThru_Data.Feature_ID = Feature_ID;
+  PassThru_Data.Aggregate = Aggregate;
+  PassThru_Data.InputBuffer = InputBuffer;
+  PassThru_Data.InputSize = InputSize;
+  PassThru_Data.OutputBuffer = OutputBuffer;
+  PassThru_Data.OutputSize = OutputSize;
+  PassThru_Data.Error_Code = Error_Code;
+
+  /* Mirroring has no PassThru commands that it accepts, so this call should not be directed to Mirroring. */
+  if ( Feature_ID == MIRRORING_FEATURE_ID )
+  {
+
+    *Error_Code = LVM_ENGINE_BAD_FEATURE_ID;
+
+    FEATURE_FUNCTION_EXIT("PassThru")
+
+    return;
+
+  }
+
+  /* Since this is not for us or our aggregate, we must pass it to the next feature on each of the partitions in the Aggregate. */
+  LVM_Common_Services->ForEachItem(PartitionRecord->Feature_Data->Partitions,&Continue_PassThru, &PassThru_Data,TRUE,&LocalError);
+
+  if ( LocalError != DLIST_SUCCESS )
+  {
+
+    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+  }
+
+  FEATURE_FUNCTION_EXIT("PassThru")
+
+  /* *Error_Code was set by the call to PassThru, so leave it alone. */
+  return;
+
+}
+
+
+static void _System Continue_PassThru(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error_Code)
+{
+
+  /* Declare a local variable so that we can access the Partition_Data without having to typecast each time. */
+  Partition_Data *           PartitionRecord = (Partition_Data *) Object;
+  PassThru_Data_Record   *   PassThru_Data = (PassThru_Data_Record *) Parameters;
+
+  Plugin_Function_Table_V1 * Old_Function_Table;
+
+  FEATURE_FUNCTION_ENTRY("Continue_PassThru")
+
+#ifdef DEBUG
+
+  /* Is Object what we think it should be? */
+  if ( ( ObjectTag != PARTITION_DATA_TAG ) || ( ObjectSize != sizeof(Partition_Data) ) )
+  {
+
+
+#ifdef PARANOID
+
+    assert(0);
+
+#endif
+
+
+    /* Object's TAG is not what we expected!  Abort! */
+    *Error_Code = DLIST_CORRUPTED;
+
+    FEATURE_FUNCTION_EXIT("Continue_PassThru")
+
+    return;
+
+  }
+
+#endif
+
+  /* Is the feature data for this partition available? */
+  if ( PartitionRecord->Feature_Data == NULL )
+  {
+
+    if ( LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Mirror PassThru has encountered a partition with bad feature data!");
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    *(PassThru_Data->Error_Code) = LVM_ENGINE_BAD_PARTITION;
+    *Error_Code = DLIST_SEARCH_COMPLETE;
+
+    FEATURE_FUNCTION_EXIT("Continue_PassThru")
+
+    return;
+
+  }
+
+
+  /* Get the function table for the first feature on this partition. */
+  Old_Function_Table = (Plugin_Function_Table_V1 *) PartitionRecord->Feature_Data->Function_Table;
+
+  /* Is the function table for the next feature on this partition available? */
+  if ( Old_Function_Table == NULL )
+  {
+
+    if ( LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Mirror PassThru has encountered a partition with bad feature data!");
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    *(PassThru_Data->Error_Code) = LVM_ENGINE_BAD_PARTITION;
+    *Error_Code = DLIST_SEARCH_COMPLETE;
+
+    FEATURE_FUNCTION_EXIT("Continue_PassThru")
+
+    return;
+
+  }
+
+  /* Now call the PassThru function for this feature and partition. */
+  Old_Function_Table->PassThru(PassThru_Data->Feature_ID,
+                               PartitionRecord,
+                               PassThru_Data->InputBuffer,
+                               PassThru_Data->InputSize,
+                               PassThru_Data->OutputBuffer,
+                               PassThru_Data->OutputSize,
+                               PassThru_Data->Error_Code);
+
+  /* Since we successfully called the PassThru function of the first feature on the partition, indicate success and return. */
+  *Error_Code = DLIST_SUCCESS;
+
+  FEATURE_FUNCTION_EXIT("Continue_PassThru")
+
+  return;
+
+}
+
+
+static void _System Continue_Changes_Pending(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize,  ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error_Code)
+{
+
+  /* Declare a local variable so that we can access the Partition_Data without having to typecast each time. */
+  Partition_Data *           PartitionRecord = (Partition_Data *) Object;
+
+  /* Declare a local variable so that we can access our parameters without having to typecast each time. */
+  BOOLEAN *                  ChangesArePending = ( BOOLEAN * ) Parameters;
+
+  Plugin_Function_Table_V1 * Old_Function_Table;
+
+  FEATURE_FUNCTION_ENTRY("Continue_Changes_Pending")
+
+#ifdef DEBUG
+
+  /* Is Object what we think it should be? */
+  if ( ( ObjectTag != PARTITION_DATA_TAG ) || ( ObjectSize != sizeof(Partition_Data) ) )
+  {
+
+
+#ifdef PARANOID
+
+    assert(0);
+
+#endif
+
+
+    /* Object's TAG is not what we expected!  Abort! */
+    *Error_Code = DLIST_CORRUPTED;
+
+    FEATURE_FUNCTION_EXIT("Continue_Changes_Pending")
+
+    return;
+
+  }
+
+#endif
+
+  /* Is the feature data for this partition available? */
+  if ( PartitionRecord->Feature_Data == NULL )
+  {
+
+    if ( LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Mirror ChangesPending has encountered a partition with bad feature data!");
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    *Error_Code = DLIST_SEARCH_COMPLETE;
+
+    FEATURE_FUNCTION_EXIT("Continue_Changes_Pending")
+
+    return;
+
+  }
+
+
+  /* Get the function table for the first feature on this partition. */
+  Old_Function_Table = (Plugin_Function_Table_V1 *) PartitionRecord->Feature_Data->Function_Table;
+
+  /* Is the function table for the next feature on this partition available? */
+  if ( Old_Function_Table == NULL )
+  {
+
+    if ( LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Mirror ChangesPending has encountered a partition with bad feature data!");
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    *Error_Code = DLIST_SEARCH_COMPLETE;
+
+    FEATURE_FUNCTION_EXIT("Continue_Changes_Pending")
+
+    return;
+
+  }
+
+  /* Now call the ChangesPending function for this feature and partition. */
+  *ChangesArePending = Old_Function_Table->ChangesPending(PartitionRecord, Error_Code);
+
+  /* If changes are pending on one partition, we don't need to ask any of the others. */
+  if ( *ChangesArePending )
+    *Error_Code = DLIST_SEARCH_COMPLETE;
+  else
+    *Error_Code = DLIST_SUCCESS;
+
+  FEATURE_FUNCTION_EXIT("Continue_Changes_Pending")
+
+  return;
+
+}
+
+
+static void _System ReturnCurrentClass( ADDRESS PartitionRecord, LVM_Classes * Actual_Class, BOOLEAN * Top_Of_Class, CARDINAL32 * Sequence_Number )
+{
+
+  Partition_Data *     Partition_Record = (Partition_Data *) PartitionRecord;
+  Mirror_Array *       Mirror_Table;
+
+  FEATURE_FUNCTION_ENTRY("ReturnCurrentClass")
+
+  /* This function should only be called for LVM Volumes. */
+
+  /* Get the mirror table for the aggregate. */
+  Mirror_Table = (Mirror_Array *) Partition_Record->Feature_Data->Data;
+
+  /* Return the requested values. */
+  *Actual_Class = Mirror_Table->Actual_Class;
+  *Top_Of_Class = Mirror_Table->Top_Of_Class;
+  *Sequence_Number = Mirror_Table->Feature_Sequence_Number;
+
+  FEATURE_FUNCTION_EXIT("ReturnCurrentClass")
+
+  return;
+
+}
+
+
+void _System Get_Required_LVM_Version( CARDINAL32 * Major_Version_Number, CARDINAL32 * Minor_Version_Number)
+{
+
+  *Major_Version_Number = CURRENT_LVM_MAJOR_VERSION_NUMBER;
+  *Minor_Version_Number = CURRENT_LVM_MINOR_VERSION_NUMBER;
+
+  return;
+
+}
+
+
+
+ADDRESS _System Exchange_Function_Tables( ADDRESS Common_Services )
+{
+
+  /* Initialize the Feature_ID_Record. */
+  strcpy(Feature_ID_Record.Name, "IBM Mirroring");
+  strcpy(Feature_ID_Record.Short_Name, "IBM_MIRROR");
+  strcpy(Feature_ID_Record.OEM_Info, "International Business Machines");
+  Feature_ID_Record.ID = MIRRORING_FEATURE_ID;
+  Feature_ID_Record.Major_Version_Number = MIRRORING_MAJOR_VERSION;
+  Feature_ID_Record.Minor_Version_Number = MIRRORING_MINOR_VERSION;
+  Feature_ID_Record.LVM_Major_Version_Number = CURRENT_LVM_MAJOR_VERSION_NUMBER;
+  Feature_ID_Record.LVM_Minor_Version_Number = CURRENT_LVM_MINOR_VERSION_NUMBER;
+  Feature_ID_Record.Preferred_Class = Aggregate_Class;
+  Feature_ID_Record.ClassData[Partition_Class].ClassMember = FALSE;
+  Feature_ID_Record.ClassData[Partition_Class].GlobalExclusive = FALSE;
+  Feature_ID_Record.ClassData[Partition_Class].TopExclusive = FALSE;
+  Feature_ID_Record.ClassData[Partition_Class].BottomExclusive = FALSE;
+  Feature_ID_Record.ClassData[Partition_Class].ClassExclusive = FALSE;
+  Feature_ID_Record.ClassData[Partition_Class].Weight_Factor = 1;
+  Feature_ID_Record.ClassData[Aggregate_Class].ClassMember = TRUE;
+  Feature_ID_Record.ClassData[Aggregate_Class].GlobalExclusive = FALSE;
+  Feature_ID_Record.ClassData[Aggregate_Class].TopExclusive = FALSE;
+  Feature_ID_Record.ClassData[Aggregate_Class].BottomExclusive = FALSE;
+  Feature_ID_Record.ClassData[Aggregate_Class].ClassExclusive = FALSE;
+  Feature_ID_Record.ClassData[Aggregate_Class].Weight_Factor = 85;
+  Feature_ID_Record.ClassData[Volume_Class].ClassMember = FALSE;
+  Feature_ID_Record.ClassData[Volume_Class].GlobalExclusive = FALSE;
+  Feature_ID_Record.ClassData[Volume_Class].TopExclusive = FALSE;
+  Feature_ID_Record.ClassData[Volume_Class].BottomExclusive = FALSE;
+  Feature_ID_Record.ClassData[Volume_Class].ClassExclusive = FALSE;
+  Feature_ID_Record.ClassData[Volume_Class].Weight_Factor = 1;
+  Feature_ID_Record.Interface_Support[PM_Interface].VIO_PM_Calls.Create_and_Configure = NULL;
+  Feature_ID_Record.Interface_Support[PM_Interface].Interface_Supported = FALSE;
+  Feature_ID_Record.Interface_Support[VIO_Interface].VIO_PM_Calls.Create_and_Configure = NULL;
+  Feature_ID_Record.Interface_Support[VIO_Interface].Interface_Supported = TRUE;
+  Feature_ID_Record.Interface_Support[PM_Interface].VIO_PM_Calls.Display_Status = NULL;
+  Feature_ID_Record.Interface_Support[VIO_Interface].VIO_PM_Calls.Display_Status = NULL;
+  Feature_ID_Record.Interface_Support[PM_Interface].VIO_PM_Calls.Control_Panel = NULL;
+  Feature_ID_Record.Interface_Support[VIO_Interface].VIO_PM_Calls.Control_Panel = NULL;
+  Feature_ID_Record.Interface_Support[PM_Interface].VIO_PM_Calls.Help_Panel = NULL;
+  Feature_ID_Record.Interface_Support[VIO_Interface].VIO_PM_Calls.Help_Panel = NULL;
+  Feature_ID_Record.Interface_Support[Java_Interface].Java_Interface_Class = "";
+  Feature_ID_Record.Interface_Support[Java_Interface].Interface_Supported = FALSE;
+
+
+  /* Initialize the Function Table for this feature. */
+  Function_Table.Feature_ID = &Feature_ID_Record;
+  Function_Table.Open_Feature = &Open_Feature;
+  Function_Table.Close_Feature = &Close_Feature;
+  Function_Table.Can_Expand = &Can_Expand_Mirror_Volume;
+  Function_Table.Add_Partition = &Add_Mirror_Partition;
+  Function_Table.Delete = &Delete_Mirror_Partition;
+  Function_Table.Discover = &Discover_Mirrors;
+  Function_Table.Remove_Features = &Remove_Features;
+  Function_Table.Create = &Create_Mirror_Volume;
+  Function_Table.Commit = &Commit_Mirroring_Changes;
+  Function_Table.Write = &Mirror_Write;
+  Function_Table.Read = &Mirror_Read;
+  Function_Table.ReturnCurrentClass = &ReturnCurrentClass;
+  Function_Table.PassThru = &PassThru;
+  Function_Table.ChangesPending = &Mirror_ChangesPending;
+  Function_Table.ParseCommandLineArguments = &Mirror_ParseCommandLineArguments;
+
+  /* Save the common functions provided by LVM.DLL. */
+  LVM_Common_Services = ( LVM_Common_Services_V1 * ) Common_Services;
+
+  /* Return our table of functions to LVM.DLL. */
+  return (ADDRESS) &Function_Table;
+
+}
+
+
+static BOOLEAN _System Claim_Aggregate_Partitions( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, BOOLEAN * FreeMemory, CARDINAL32 * Error_Code)
+{
+
+  /* Declare a local variable so that we can access the Partition_Data without having to typecast each time. */
+  Partition_Data *           PartitionRecord = (Partition_Data *) Object;
+
+  /* Declare a local variable so that we can access the Partition_Data passed to us as a parameter without having to typecast each time. */
+  Partition_Data *           PartitionRecord_To_Find = ( Partition_Data * ) Parameters;
+
+
+  FEATURE_FUNCTION_ENTRY("Claim_Aggregate_Partitions")
+
+#ifdef DEBUG
+
+  /* Is Object what we think it should be? */
+  if ( ( ObjectTag != PARTITION_DATA_TAG ) || ( ObjectSize != sizeof(Partition_Data) ) )
+  {
+
+
+#ifdef PARANOID
+
+    assert(0);
+
+#endif
+
+
+    /* Object's TAG is not what we expected!  Abort! */
+    *Error_Code = DLIST_CORRUPTED;
+
+    FEATURE_FUNCTION_EXIT("Claim_Aggregate_Partitions")
+
+    return FALSE;
+
+  }
+
+#endif
+
+  /* Since the size and TAG of the object are correct, we will proceed. */
+
+  /* Since we don't want the actual Partition Data being deleted, set *FreeMemory to FALSE. */
+  *FreeMemory = FALSE;
+
+  /* Is the current partition the one we are looking for? */
+  if ( PartitionRecord->External_Handle == PartitionRecord_To_Find->External_Handle )
+  {
+
+    /* This is the partition we are looking for!  We will return TRUE so that it will be removed from the Partitions List. */
+
+    /* Stop further searching. */
+    *Error_Code = DLIST_SEARCH_COMPLETE;
+
+    FEATURE_FUNCTION_EXIT("Claim_Aggregate_Partitions")
+
+    return TRUE;
+
+  }
+
+  /* Indicate success.  Return FALSE so that the current item will not be removed from the Partitions list. */
+  *Error_Code = DLIST_SUCCESS;
+
+  FEATURE_FUNCTION_EXIT("Claim_Aggregate_Partitions")
+
+  return FALSE;
+
+}
+
+
+static BOOLEAN  _System Mirror_ChangesPending(Partition_Data * PartitionRecord, CARDINAL32 * Error_Code)
+{
+
+  Feature_Context_Data  *    CurrentFeature;
+  Mirror_Array *             MirrorTable;
+  BOOLEAN                    ReturnValue = FALSE;
+
+  FEATURE_FUNCTION_ENTRY("Mirror_ChangesPending")
+
+  /* Is our feature data available? */
+  if ( PartitionRecord->Feature_Data == NULL )
+  {
+
+    if ( LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Mirror ChangesPending has encountered a partition with bad feature data!");
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    *Error_Code = LVM_ENGINE_BAD_PARTITION;
+
+    FEATURE_FUNCTION_EXIT("Mirror_ChangesPending")
+
+    return FALSE;
+
+  }
+
+  /* Get our feature data. */
+  CurrentFeature = PartitionRecord->Feature_Data;
+
+  /* Does our mirror table exist? */
+  if ( CurrentFeature->Data == NULL )
+  {
+
+    if ( LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Mirror ChangesPending has encountered a partition with bad feature data!");
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    *Error_Code = LVM_ENGINE_BAD_PARTITION;
+
+    FEATURE_FUNCTION_EXIT("Mirror_ChangesPending")
+
+    return FALSE;
+
+  }
+
+  /* Get our mirror table. */
+  MirrorTable = (Mirror_Array *) CurrentFeature->Data;
+
+  /* Do we have any changes pending? */
+  if ( MirrorTable->ChangesMade )
+  {
+
+    *Error_Code = LVM_ENGINE_NO_ERROR;
+
+    FEATURE_FUNCTION_EXIT("Mirror_ChangesPending")
+
+    return TRUE;
+
+  }
+
+  /* Since we don't have any changes pending, we must find out if the next layer below us does.  This means traversing
+     our list of partitions for this aggregate and, for each partition in the list, calling the ChangesPending function. */
+  LVM_Common_Services->ForEachItem(CurrentFeature->Partitions,&Continue_Changes_Pending, &ReturnValue, TRUE, Error_Code);
+  if ( *Error_Code != DLIST_SUCCESS )
+  {
+
+    if ( LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"ForEachItem has failed in Mirror ChangesPending!");
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+    FEATURE_FUNCTION_EXIT("Mirror_ChangesPending")
+
+    return FALSE;
+
+  }
+
+
+  FEATURE_FUNCTION_EXIT("Mirror_ChangesPending")
+
+  /* *Error_Code was set by the call to ChangesPending, so leave it alone. */
+  return ReturnValue;
+
+}
+
+
+static void _System Mirror_ParseCommandLineArguments(DLIST Token_List, LVM_Classes * Actual_Class, ADDRESS * Init_Data, char ** Error_Message, CARDINAL32 * Error_Code )
+{
+
+  LVM_Token *            Token;                  /* Used to point to the token being parsed. */
+
+  FEATURE_FUNCTION_ENTRY("Mirror_ParseCommandLineArguments")
+
+  /* Set up default return values.  Mirroring has no options, so there is never any initialization data. */
+  *Init_Data = NULL;
+  *Error_Message = NULL;
+  *Actual_Class = Aggregate_Class;
+
+  /* Get the current token. */
+  Token = GetToken(Token_List, TRUE, Error_Code);
+  if ( *Error_Code != LVM_ENGINE_NO_ERROR )
+  {
+
+    if ( *Error_Code == LVM_ENGINE_PARSING_ERROR )
+      *Error_Message = UNEXPECTED_END_OF_INPUT;
+
+    FEATURE_FUNCTION_EXIT("Mirror_ParseCommandLineArguments")
+
+    return;
+
+  }
+
+  /* The only thing we accept is the end of the feature specific commands. */
+  if ( Token->TokenType != LVM_Close_Paren )
+  {
+
+    *Error_Message = CLOSE_PAREN_EXPECTED;
+    *Error_Code = LVM_ENGINE_PARSING_ERROR;
+
+    FEATURE_FUNCTION_EXIT("Mirror_ParseCommandLineArguments")
+
+    return;
+
+  }
+
+  /* The ')' is left as the current token for our caller. */
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  FEATURE_FUNCTION_EXIT("Mirror_ParseCommandLineArguments")
+
+  return;
+
+}
+
+
+static LVM_Token * GetToken(DLIST Token_List, BOOLEAN CurrentToken, CARDINAL32 * Error_Code)
+{
+
+  LVM_Token *  Token;
+
+  FEATURE_FUNCTION_ENTRY("GetToken")
+
+  /* Does the user want to start with the current token or the next token? */
+  if ( CurrentToken )
+  {
+
+    /* Get the current token. */
+    Token = (LVM_Token *) LVM_Common_Services->GetObject(Token_List, sizeof(LVM_Token), LVM_TOKEN_TAG, NULL, FALSE, Error_Code);
+    if ( *Error_Code != DLIST_SUCCESS )
+    {
+
+      if ( *Error_Code == DLIST_END_OF_LIST )
+        *Error_Code = LVM_ENGINE_PARSING_ERROR;
+      else
+        *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+      FEATURE_FUNCTION_EXIT("GetToken")
+
+      return NULL;
+
+    }
+
+  }
+  else
+  {
+
+    /* Get the next token. */
+    Token = (LVM_Token *) LVM_Common_Services->GetNextObject(Token_List, sizeof(LVM_Token), LVM_TOKEN_TAG, Error_Code);
+    if ( *Error_Code != DLIST_SUCCESS )
+    {
+
+      if ( *Error_Code == DLIST_END_OF_LIST )
+        *Error_Code = LVM_ENGINE_PARSING_ERROR;
+      else
+        *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+      FEATURE_FUNCTION_EXIT("GetToken")
+
+      return NULL;
+
+    }
+
+  }
+
+  /* Reject whitespace. */
+  while ( ( *Error_Code == DLIST_SUCCESS ) &&
+          ( ( Token->TokenType == LVM_Tab ) ||
+            ( Token->TokenType == LVM_MultiTab ) ||
+            ( Token->TokenType == LVM_MultiSpace) ||
+            ( Token->TokenType == LVM_Space )
+          )
+        )
+  {
+
+    /* Get the next token. */
+    Token = (LVM_Token *) LVM_Common_Services->GetNextObject(Token_List, sizeof(LVM_Token), LVM_TOKEN_TAG, Error_Code);
+
+  }
+
+  /* Did we leave the while loop because of an error? */
+  if ( *Error_Code != DLIST_SUCCESS )
+  {
+
+    if ( *Error_Code == DLIST_END_OF_LIST )
+      *Error_Code = LVM_ENGINE_PARSING_ERROR;
+    else
+      *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+  }
+  else
+    *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  FEATURE_FUNCTION_EXIT("GetToken")
+
+  return Token;
+
+}
+
+
+static BOOLEAN Member_Is_Available( Mirror_Array * MirrorTable, CARDINAL32 Member )
+{
+
+  Partition_Data *  PartitionRecord = MirrorTable->MemberArray[Member].PartitionRecord;
+
+  /* A member which was not found during discovery, or which has lost the layers below us, can not be used. */
+  if ( ( PartitionRecord == NULL ) ||
+       ( PartitionRecord->Feature_Data == NULL ) ||
+       ( PartitionRecord->Feature_Data->Function_Table == NULL )
+     )
+    return FALSE;
+
+  return TRUE;
+
+}
+
+
+static BOOLEAN Region_Is_Stale( Mirror_Array * MirrorTable, CARDINAL32 Member, CARDINAL32 Region )
+{
+
+  return ( ( MirrorTable->Stale_Regions[Member][Region / 8] & ( 1 << ( Region % 8 ) ) ) != 0 );
+
+}
+
+
+static BOOLEAN Member_Is_Current( Mirror_Array * MirrorTable, CARDINAL32 Member, LBA Starting_Sector, CARDINAL32 Sector_Count )
+{
+
+  CARDINAL32  Region;
+  CARDINAL32  Last_Region = ( Starting_Sector + Sector_Count - 1 ) / MirrorTable->Region_Size;
+
+  for ( Region = Starting_Sector / MirrorTable->Region_Size; Region <= Last_Region; Region++ )
+  {
+
+    if ( Region_Is_Stale( MirrorTable, Member, Region ) )
+      return FALSE;
+
+  }
+
+  return TRUE;
+
+}
+
+
+static void Mark_Stale_Regions( Mirror_Array * MirrorTable, CARDINAL32 Member, LBA Starting_Sector, CARDINAL32 Sector_Count )
+{
+
+  CARDINAL32  Region;
+  CARDINAL32  Last_Region = ( Starting_Sector + Sector_Count - 1 ) / MirrorTable->Region_Size;
+
+  for ( Region = Starting_Sector / MirrorTable->Region_Size; Region <= Last_Region; Region++ )
+    MirrorTable->Stale_Regions[Member][Region / 8] |= (BYTE) ( 1 << ( Region % 8 ) );
+
+  /* The bitmaps on disk must be updated so that the member is not trusted for these regions after a reboot. */
+  MirrorTable->ChangesMade = TRUE;
+
+  return;
+
+}
+
+
+static void Resync_Stale_Regions( Mirror_Array * MirrorTable, CARDINAL32 * Error_Code )
+{
+
+  Plugin_Function_Table_V1 * Source_Function_Table;
+  Plugin_Function_Table_V1 * Target_Function_Table;
+  Partition_Data *           Source_Record;
+  Partition_Data *           Target_Record;
+  CARDINAL32                 Region_Count = ( MirrorTable->Member_Size + MirrorTable->Region_Size - 1 ) / MirrorTable->Region_Size;
+  CARDINAL32                 Region;
+  CARDINAL32                 Member;
+  CARDINAL32                 Source;
+  CARDINAL32                 Transfer_Size;
+  CARDINAL32                 Transfer_Error;
+  LBA                        Current_Sector;
+  LBA                        Region_End;
+  BYTE *                     Resync_Buffer = NULL;
+
+  FEATURE_FUNCTION_ENTRY("Resync_Stale_Regions")
+
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  /* Bring each stale region of each member which is present up to date by copying it from a member which is current for
+     that region.  Only the regions which missed writes are copied, so a member which was briefly unavailable does not
+     require the whole mirror to be rebuilt.  A member which is missing is left alone until it returns.                  */
+  for ( Member = 0; Member < MirrorTable->Members_In_Use; Member++ )
+  {
+
+    if ( ! Member_Is_Available( MirrorTable, Member ) )
+      continue;
+
+    Target_Record = MirrorTable->MemberArray[Member].PartitionRecord;
+    Target_Function_Table = (Plugin_Function_Table_V1 *) Target_Record->Feature_Data->Function_Table;
+
+    for ( Region = 0; Region < Region_Count; Region++ )
+    {
+
+      if ( ! Region_Is_Stale( MirrorTable, Member, Region ) )
+        continue;
+
+      /* Find a member which holds a current copy of this region. */
+      for ( Source = 0; Source < MirrorTable->Members_In_Use; Source++ )
+      {
+
+        if ( ( Source != Member ) &&
+             Member_Is_Available( MirrorTable, Source ) &&
+             ( ! Region_Is_Stale( MirrorTable, Source, Region ) )
+           )
+          break;
+
+      }
+
+      if ( Source >= MirrorTable->Members_In_Use )
+      {
+
+        LOG_FEATURE_EVENT1("No member of the mirror has a current copy of a stale region!", "Region", Region)
+
+        continue;
+
+      }
+
+      /* We only need a buffer if there is something to copy. */
+      if ( Resync_Buffer == NULL )
+      {
+
+        Resync_Buffer = (BYTE *) LVM_Common_Services->Allocate( MIRROR_RESYNC_SECTORS * BYTES_PER_SECTOR );
+        if ( Resync_Buffer == NULL )
+        {
+
+          LOG_FEATURE_ERROR("Unable to allocate a buffer to resynchronize the mirror!")
+
+          *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+          FEATURE_FUNCTION_EXIT("Resync_Stale_Regions")
+
+          return;
+
+        }
+
+      }
+
+      Source_Record = MirrorTable->MemberArray[Source].PartitionRecord;
+      Source_Function_Table = (Plugin_Function_Table_V1 *) Source_Record->Feature_Data->Function_Table;
+
+      Current_Sector = Region * MirrorTable->Region_Size;
+      Region_End = Current_Sector + MirrorTable->Region_Size;
+      if ( Region_End > MirrorTable->Member_Size )
+        Region_End = MirrorTable->Member_Size;
+
+      Transfer_Error = LVM_ENGINE_NO_ERROR;
+
+      while ( Current_Sector < Region_End )
+      {
+
+        Transfer_Size = Region_End - Current_Sector;
+        if ( Transfer_Size > MIRROR_RESYNC_SECTORS )
+          Transfer_Size = MIRROR_RESYNC_SECTORS;
+
+        Source_Function_Table->Read(Source_Record, Source_Record->Starting_Sector + Current_Sector, Transfer_Size, Resync_Buffer, &Transfer_Error);
+        if ( Transfer_Error != LVM_ENGINE_NO_ERROR )
+          break;
+
+        Target_Function_Table->Write(Target_Record, Target_Record->Starting_Sector + Current_Sector, Transfer_Size, Resync_Buffer, &Transfer_Error);
+        if ( Transfer_Error != LVM_ENGINE_NO_ERROR )
+          break;
+
+        Current_Sector += Transfer_Size;
+
+      }
+
+      MirrorTable->MemberArray[Source].Next_Sector = Current_Sector;
+      MirrorTable->MemberArray[Member].Next_Sector = Current_Sector;
+
+      if ( Transfer_Error != LVM_ENGINE_NO_ERROR )
+      {
+
+        LOG_FEATURE_EVENT1("Unable to resynchronize a stale region of the mirror!", "Region", Region)
+
+        /* I/O errors leave the region stale so that it will be tried again on the next commit.  Anything else is serious. */
+        if ( Transfer_Error != LVM_ENGINE_IO_ERROR )
+        {
+
+          LVM_Common_Services->Deallocate( Resync_Buffer );
+
+          *Error_Code = Transfer_Error;
+
+          FEATURE_FUNCTION_EXIT("Resync_Stale_Regions")
+
+          return;
+
+        }
+
+        continue;
+
+      }
+
+      /* This region of the member is now current. */
+      MirrorTable->Stale_Regions[Member][Region / 8] &= (BYTE) ~( 1 << ( Region % 8 ) );
+      MirrorTable->ChangesMade = TRUE;
+
+    }
+
+  }
+
+  if ( Resync_Buffer != NULL )
+    LVM_Common_Services->Deallocate( Resync_Buffer );
+
+  FEATURE_FUNCTION_EXIT("Resync_Stale_Regions")
+
+  return;
+
+}
+
+
+static void Read_Mirror_Members( Partition_Data * Aggregate, LBA Starting_Sector, CARDINAL32 Sector_Count, ADDRESS Buffer, CARDINAL32 * Error_Code )
+{
+
+  Mirror_Array *             MirrorTable = (Mirror_Array *) Aggregate->Feature_Data->Data;
+  Segment_Transfer           Segments[MAXIMUM_MIRROR_MEMBERS];         /* The parts of the current piece, one per member used. */
+  CARDINAL32                 Segment_Members[MAXIMUM_MIRROR_MEMBERS];  /* The member each part is read from. */
+  CARDINAL32                 Segment_Count;
+  CARDINAL32                 Part_Size;
+  CARDINAL32                 Members = MirrorTable->Members_In_Use;
+  CARDINAL32                 Member;
+  CARDINAL32                 Candidate;
+  CARDINAL32                 Index;
+  CARDINAL32                 Distance;
+  CARDINAL32                 Best_Distance;
+  CARDINAL32                 Region;
+  CARDINAL32                 Run_Size;
+  CARDINAL32                 Member_Error;
+  CARDINAL32                 Last_Error = LVM_ENGINE_IO_ERROR;
+  BOOLEAN                    Tried[MAXIMUM_MIRROR_MEMBERS];
+  BOOLEAN                    Part_Failed;
+  LBA                        Run_End;
+  BYTE *                     Request_Position = (BYTE *) Buffer;
+
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  if ( Sector_Count == 0 )
+    return;
+
+  /* Is the request within the aggregate? */
+  if ( ( Starting_Sector >= MirrorTable->Member_Size ) ||
+       ( Sector_Count > MirrorTable->Member_Size - Starting_Sector )
+     )
+  {
+
+    if ( LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Mirror_Read was asked for %d (decimal) sectors starting at Sector %X (hex), which is beyond the end of the aggregate!", Sector_Count, Starting_Sector);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+    return;
+
+  }
+
+  memset( Tried, 0, sizeof(Tried) );
+
+  /* Each piece of the request is given to one member.  The member chosen is the one which is current for the piece and
+     whose last request ended closest to where the piece starts, so that sequential reads stay on one member while
+     scattered reads are spread across the members.  Ties are broken round robin, starting after the member used
+     last.  A large piece is split between the chosen member and the other members which are current for all of it, and
+     the parts are read at the same time.                                                                                */
+  while ( Sector_Count > 0 )
+  {
+
+    Region = Starting_Sector / MirrorTable->Region_Size;
+    Member = Members;
+    Best_Distance = 0xFFFFFFFFL;
+
+    for ( Index = 1; Index <= Members; Index++ )
+    {
+
+      Candidate = ( MirrorTable->Last_Member_Read + Index ) % Members;
+
+      if ( Tried[Candidate] ||
+           ( ! Member_Is_Available( MirrorTable, Candidate ) ) ||
+           Region_Is_Stale( MirrorTable, Candidate, Region )
+         )
+        continue;
+
+      if ( Starting_Sector >= MirrorTable->MemberArray[Candidate].Next_Sector )
+        Distance = Starting_Sector - MirrorTable->MemberArray[Candidate].Next_Sector;
+      else
+        Distance = MirrorTable->MemberArray[Candidate].Next_Sector - Starting_Sector;
+
+      if ( Distance < Best_Distance )
+      {
+
+        Member = Candidate;
+        Best_Distance = Distance;
+
+      }
+
+    }
+
+    /* Is there anyone left to read from? */
+    if ( Member >= Members )
+    {
+
+      if ( LVM_Common_Services->Logging_Enabled )
+      {
+
+        sprintf(LVM_Common_Services->Log_Buffer,"Mirror_Read could not read Sector %X (hex) from any member of the mirror!", Starting_Sector);
+        LVM_Common_Services->Write_Log_Buffer();
+
+      }
+
+      *Error_Code = Last_Error;
+
+      return;
+
+    }
+
+    /* The piece runs for as long as the member stays current. */
+    Run_End = ( Region + 1 ) * MirrorTable->Region_Size;
+    while ( ( Run_End < Starting_Sector + Sector_Count ) && ( ! Region_Is_Stale( MirrorTable, Member, Run_End / MirrorTable->Region_Size ) ) )
+      Run_End += MirrorTable->Region_Size;
+
+    if ( Run_End > Starting_Sector + Sector_Count )
+      Run_End = Starting_Sector + Sector_Count;
+
+    Run_Size = Run_End - Starting_Sector;
+
+    /* The chosen member reads the first part of the piece, and any other member which can help reads a later part. */
+    Segment_Members[0] = Member;
+    Segment_Count = 1;
+    for ( Index = 1; ( Index < Members ) && ( Run_Size / ( Segment_Count + 1 ) >= MIRROR_MINIMUM_SPLIT ); Index++ )
+    {
+
+      Candidate = ( Member + Index ) % Members;
+
+      if ( Tried[Candidate] ||
+           ( ! Member_Is_Available( MirrorTable, Candidate ) ) ||
+           ( ! Member_Is_Current( MirrorTable, Candidate, Starting_Sector, Run_Size ) )
+         )
+        continue;
+
+      Segment_Members[Segment_Count] = Candidate;
+      Segment_Count++;
+
+    }
+
+    Part_Size = Run_Size / Segment_Count;
+    for ( Index = 0; Index < Segment_Count; Index++ )
+    {
+
+      Segments[Index].PartitionRecord = MirrorTable->MemberArray[Segment_Members[Index]].PartitionRecord;
+      Segments[Index].Starting_Sector = Segments[Index].PartitionRecord->Starting_Sector + Starting_Sector + Index * Part_Size;
+      Segments[Index].Sector_Count = ( Index == Segment_Count - 1 ) ? ( Run_Size - Index * Part_Size ) : Part_Size;
+      Segments[Index].Buffer = Request_Position + Index * Part_Size * BYTES_PER_SECTOR;
+
+    }
+
+    LVM_Common_Services->Transfer_Segments( Segments, Segment_Count, FALSE, &Member_Error );
+
+    Part_Failed = FALSE;
+    for ( Index = 0; Index < Segment_Count; Index++ )
+    {
+
+      if ( Segments[Index].Error_Code != LVM_ENGINE_NO_ERROR )
+      {
+
+        LOG_FEATURE_EVENT1("A member of the mirror failed a read.  Trying another member.", "Member", Segment_Members[Index])
+
+        Tried[Segment_Members[Index]] = TRUE;
+        Last_Error = Segments[Index].Error_Code;
+        Part_Failed = TRUE;
+
+      }
+
+    }
+
+    /* Try the same piece again without the members which failed. */
+    if ( Part_Failed )
+      continue;
+
+    for ( Index = 0; Index < Segment_Count; Index++ )
+      MirrorTable->MemberArray[Segment_Members[Index]].Next_Sector = Segments[Index].Starting_Sector - Segments[Index].PartitionRecord->Starting_Sector + Segments[Index].Sector_Count;
+
+    MirrorTable->Last_Member_Read = Member;
+
+    /* Move on to the next piece.  Every member is a candidate again. */
+    Starting_Sector = Run_End;
+    Sector_Count -= Run_Size;
+    Request_Position += Run_Size * BYTES_PER_SECTOR;
+    memset( Tried, 0, sizeof(Tried) );
+
+  }
+
+  return;
+
+}
+
+
+static void Write_Mirror_Members( Partition_Data * Aggregate, LBA Starting_Sector, CARDINAL32 Sector_Count, ADDRESS Buffer, CARDINAL32 * Error_Code )
+{
+
+  Mirror_Array *             MirrorTable = (Mirror_Array *) Aggregate->Feature_Data->Data;
+  Segment_Transfer           Segments[MAXIMUM_MIRROR_MEMBERS];         /* The copy of the data for each member being written. */
+  CARDINAL32                 Segment_Members[MAXIMUM_MIRROR_MEMBERS];  /* The member each copy is written to. */
+  CARDINAL32                 Segment_Count = 0;
+  CARDINAL32                 Index;
+  CARDINAL32                 Member;
+  CARDINAL32                 Member_Error;
+  CARDINAL32                 Last_Error = LVM_ENGINE_IO_ERROR;
+  BOOLEAN                    Current_Copy_Written = FALSE;
+
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  if ( Sector_Count == 0 )
+    return;
+
+  /* Is the request within the aggregate? */
+  if ( ( Starting_Sector >= MirrorTable->Member_Size ) ||
+       ( Sector_Count > MirrorTable->Member_Size - Starting_Sector )
+     )
+  {
+
+    if ( LVM_Common_Services->Logging_Enabled )
+    {
+
+      sprintf(LVM_Common_Services->Log_Buffer,"Mirror_Write was asked for %d (decimal) sectors starting at Sector %X (hex), which is beyond the end of the aggregate!", Sector_Count, Starting_Sector);
+      LVM_Common_Services->Write_Log_Buffer();
+
+    }
+
+    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+    return;
+
+  }
+
+  /* Every member gets a copy of the data, and the copies are written at the same time.  A member which can not be written
+     has the regions covered by the request marked stale, so that it will not be read from there until it has been
+     brought up to date.                                                                                                 */
+  for ( Member = 0; Member < MirrorTable->Members_In_Use; Member++ )
+  {
+
+    if ( ! Member_Is_Available( MirrorTable, Member ) )
+    {
+
+      Mark_Stale_Regions( MirrorTable, Member, Starting_Sector, Sector_Count );
+
+      continue;
+
+    }
+
+    Segments[Segment_Count].PartitionRecord = MirrorTable->MemberArray[Member].PartitionRecord;
+    Segments[Segment_Count].Starting_Sector = Segments[Segment_Count].PartitionRecord->Starting_Sector + Starting_Sector;
+    Segments[Segment_Count].Sector_Count = Sector_Count;
+    Segments[Segment_Count].Buffer = Buffer;
+    Segment_Members[Segment_Count] = Member;
+    Segment_Count++;
+
+  }
+
+  if ( Segment_Count > 0 )
+    LVM_Common_Services->Transfer_Segments( Segments, Segment_Count, TRUE, &Member_Error );
+
+  for ( Index = 0; Index < Segment_Count; Index++ )
+  {
+
+    Member = Segment_Members[Index];
+
+    if ( Segments[Index].Error_Code != LVM_ENGINE_NO_ERROR )
+    {
+
+      LOG_FEATURE_EVENT1("A member of the mirror failed a write.  Its copy of the data is now stale.", "Member", Member)
+
+      Mark_Stale_Regions( MirrorTable, Member, Starting_Sector, Sector_Count );
+      Last_Error = Segments[Index].Error_Code;
+
+      continue;
+
+    }
+
+    MirrorTable->MemberArray[Member].Next_Sector = Starting_Sector + Sector_Count;
+
+    /* A write to a member which is stale for part of the request does not leave a copy of the data which can be read back. */
+    if ( Member_Is_Current( MirrorTable, Member, Starting_Sector, Sector_Count ) )
+      Current_Copy_Written = TRUE;
+
+  }
+
+  /* The write succeeds so long as the data can be read back from at least one member. */
+  if ( ! Current_Copy_Written )
+    *Error_Code = Last_Error;
+
+  return;
+
+}
+
+
@@ -64,9 +64,9 @@
  * Necessary include files
  --------------------------------------------------*/
 
-#include <stdlib.h>   /* malloc, free */
+#include <stdlib.h>   /* malloc, realloc, free, qsort */
 #include <stdio.h>    /* sprintf */
-#include <string.h>   /* strlen */
+#include <string.h>   /* strlen, memmove */
 
 #define NEED_BYTE_DEFINED
 #include "engine.h"   /* Included for access to the global types and variables. */
@@ -107,6 +107,16 @@
 #define NEW_MBR_NAME          "I13X"
 #define NEW_MBR_NAME_OFFSET   0xd5
 #define PARTITION_ACTIVE_FLAG 0X80
+#define FREE_SPACE_INDEX_MINIMUM_SLOTS  16
+#define METADATA_TABLE_MINIMUM_SLOTS    16
+
+/* The following flags record which parts of a metadata sector differ from what is on disk. */
+#define BOOT_CODE_CHANGED               0x00000001    /* The part of an MBR/EBR before the partition table, which includes the Boot Manager Alias of an EBR. */
+#define PARTITION_TABLE_CHANGED         0x00000002    /* The partition table of an MBR/EBR. */
+#define MBR_EBR_SIGNATURE_CHANGED       0x00000004    /* The signature of an MBR/EBR. */
+#define DLA_TABLE_HEADER_CHANGED        0x00000008    /* The part of a DLA Table before the DLA_Array, other than its CRC. */
+#define DLA_TABLE_ENTRIES_CHANGED       0x00000010    /* The DLA_Array of a DLA Table. */
+#define SECTOR_CONTENTS_UNKNOWN         0x80000000    /* What is on disk is not known, so the whole sector is assumed to have changed. */
 
 
 /*--------------------------------------------------
@@ -124,17 +134,77 @@ typedef struct _MBR_EBR_Build_Data {
                                      BOOLEAN    New_MBR_Needed;
                                    } MBR_EBR_Build_Data;
 
-typedef struct _Partition_Search_Record {
-                                          CARDINAL32   Serial_Number;   /* input - The serial number to search for. */
-                                          ADDRESS      Handle;          /* output - The handle of the matching partition. */
-                                        } Partition_Search_Record;
-
 typedef struct _Primary_Partition_Status {
                                            BOOLEAN    Active_Boot_Manager_Found;
                                            BOOLEAN    Non_Hidden_Primary_Found;
                                            BOOLEAN    Active_Primary_Found;
                                          } Primary_Partition_Status;
 
+/* The following structure holds the track containing an MBR/EBR, read from a drive by Read_Partition_Tables.  The MBR/EBR is the
+   first sector of the track and its DLA Table is the last, so both arrive with one read.  Each entry has its own track buffer, which
+   immediately follows the structure in memory, so that the reads for all of the drives in the system can be outstanding at once.   */
+typedef struct _Partition_Table_Sectors {
+                                           LBA                                MBR_EBR_LBA;                      /* The LBA of the MBR/EBR. */
+                                           Sector_IO_Request                  Track_Request;                    /* Used to read the track. */
+                                           BOOLEAN                            Track_Read;                       /* TRUE once Track_Request has been reaped without error. */
+                                           BOOLEAN                            In_Flight;                        /* TRUE from submission until Track_Request is reaped. */
+                                           struct _Partition_Table_Sectors *  Next;                             /* The next MBR/EBR in the chain on this drive. */
+                                           BYTE *                             Track;                            /* The track buffer. */
+                                         } Partition_Table_Sectors;
+
+/* The following structure is the free space index for a drive.  It holds the blocks of free space in the Partitions list for the
+   drive in two sorted arrays so that the allocation algorithms used by Create_Partition can find a block of free space with a binary
+   search instead of walking the Partitions list.  Since By_Size is ordered by size, the blocks of free space large enough to hold a
+   partition are always at the end of By_Size.  Lowest_Start and Highest_Start record, for each position in By_Size, the lowest and
+   highest starting sector found from that position to the end of By_Size.  These give the first and last blocks of free space on the
+   drive that are large enough to hold a partition without examining the blocks of free space that are too small.  Lookups are binary
+   searches, but adding or removing a block of free space is linear in the number of blocks of free space on the drive, since the
+   arrays must be shifted and Lowest_Start and Highest_Start recalculated back to the start of By_Size.  A drive only has a handful
+   of blocks of free space, so this is still far cheaper than walking the Partitions list.                                          */
+typedef struct _Free_Space_Index {
+                                    CARDINAL32          Count;            /* The number of blocks of free space in the index. */
+                                    CARDINAL32          Slots;            /* The number of entries that each of the arrays below has room for. */
+                                    Partition_Data **   By_Start;         /* The blocks of free space in order by starting sector. */
+                                    Partition_Data **   By_Size;          /* The blocks of free space in order by size, and then by starting sector. */
+                                    LBA *               Lowest_Start;     /* Lowest_Start[i] is the lowest starting sector in By_Size[i] through By_Size[Count - 1]. */
+                                    LBA *               Highest_Start;    /* Highest_Start[i] is the highest starting sector in By_Size[i] through By_Size[Count - 1]. */
+                                  } Free_Space_Index;
+
+/* The following structure is used by Select_Free_Space to track the search for a block of free space. */
+typedef struct _Free_Space_Search_Record {
+                                            CARDINAL32   Size;                    /* The size of the partition being created. */
+                                            CARDINAL32   Minimum_Size;            /* The smallest block of free space that may be used.  0 if the allocation algorithm is All. */
+                                            BOOLEAN      Bootable;                /* TRUE if the partition must lie below the 1024 cylinder limit. */
+                                            BOOLEAN      Primary_Partition;       /* TRUE if the partition being created is a primary partition. */
+                                            BOOLEAN      Allocate_From_Start;     /* TRUE if the partition is allocated from the beginning of the block of free space. */
+                                            BOOLEAN      Aligned;                 /* TRUE if the partition must start on a multiple of Partition_Alignment. */
+                                            BOOLEAN      Free_Space_Available;    /* Set to TRUE if a block of free space large enough to hold the partition was found. */
+                                            BOOLEAN      Above_Cylinder_Limit;    /* Set to TRUE if a block of free space was rejected due to the 1024 cylinder limit. */
+                                            BOOLEAN      Wrong_Partition_Type;    /* Set to TRUE if a block of free space could not hold the type of partition requested. */
+                                          } Free_Space_Search_Record;
+
+/* The following structure holds a copy of a metadata sector - an MBR/EBR, a DLA Table, or an LVM Signature Sector - as it is on disk,
+   along with the new contents of the sector if Commit_Partition_Changes has a write pending for it.  The copy is taken when the
+   sector is read during discovery, and is updated each time the sector is written, so that a sector is only written when its new
+   contents differ from what is already on disk.                                                                                      */
+typedef struct _Metadata_Sector {
+                                   LBA          Sector;                          /* The LBA of the sector. */
+                                   BOOLEAN      Contents_Known;                  /* TRUE if On_Disk holds what is on disk at Sector. */
+                                   BOOLEAN      Write_Needed;                    /* TRUE if New_Contents must be written to disk at Sector. */
+                                   BOOLEAN      In_Use;                          /* Used by Commit_Partition_Changes to find sectors which no longer hold metadata. */
+                                   CARDINAL32   Changed_Fields;                  /* The parts of New_Contents which differ from On_Disk. */
+                                   BYTE         On_Disk[BYTES_PER_SECTOR];       /* The sector as it is on disk. */
+                                   BYTE         New_Contents[BYTES_PER_SECTOR];  /* The sector as it is to be written. */
+                                 } Metadata_Sector;
+
+/* The following structure is the metadata table for a drive.  It holds the metadata sectors known for the drive in order by LBA so
+   that they can be found with a binary search, and so that Commit_Partition_Changes can write them in ascending order.            */
+typedef struct _Metadata_Table {
+                                  CARDINAL32          Count;      /* The number of sectors in the table. */
+                                  CARDINAL32          Slots;      /* The number of entries that Sectors has room for. */
+                                  Metadata_Sector **  Sectors;    /* The sectors, in order by LBA. */
+                                } Metadata_Table;
+
 /*--------------------------------------------------
  * Private Global Variables.
  --------------------------------------------------*/
@@ -150,6 +220,8 @@ static char                   OEM_Name[] = "IBM 20";                  /* The OEM
 static char                   OEM_Name2[] = "IBM 4.50";               /* The OEM Name used by Aurora for boot sectors. */
 static BOOLEAN                Partition_Manager_Initialized = FALSE;  /* Used to track whether or not the Partition_Manager has been initialized. */
 static BOOLEAN                Avoid_CHS = FALSE;                      /* If TRUE, then all CHS vs. (size,offset) checking will be bypassed. */
+static Partition_Table_Sectors ** Partition_Tables_Read = NULL;       /* One chain per drive of the MBR/EBRs read by Read_Partition_Tables. */
+static CARDINAL32             Alignment_Waste = 0;                    /* The sectors skipped to align the last partition created with the Aligned allocation algorithm. */
 
 #ifdef WIPE_BOOT_SECTOR
 
@@ -193,7 +265,7 @@ static BOOLEAN DLA_Table_Is_Valid( CARDINAL32 DriveArrayIndex, BOOLEAN Processin
 
 static BOOLEAN Partition_Table_Entry_In_Use ( Partition_Record * Partition_Table_Entry );
 
-static void _System Find_Partition(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
+static BOOLEAN _System Partition_Serial_Number_Key(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS * Key, CARDINAL32 * KeySize);
 
 static void _System Count_Eligible_Partitions(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
 
@@ -219,6 +291,48 @@ static void _System Find_Active_Primary( ADDRESS Object, TAG ObjectTag, CARDINAL
 
 static void _System Build_Features_List(Partition_Data * PartitionRecord, DLIST Features_List, CARDINAL32 * Error);
 
+static BOOLEAN Queue_Partition_Table_Read( CARDINAL32 DriveArrayIndex, LBA MBR_EBR_LBA, Partition_Table_Sectors * Previous );
+
+static void Read_Partition_Tables( void );
+
+static void Get_Partition_Table_Sector( CARDINAL32 DriveArrayIndex, LBA MBR_EBR_LBA, BOOLEAN DLA_Table, ADDRESS Buffer, CARDINAL32 * Error_Code);
+
+static void Free_Partition_Tables( void );
+
+static Free_Space_Index * Get_Free_Space_Index( CARDINAL32 DriveArrayIndex, CARDINAL32 * Error_Code );
+
+static void Discard_Free_Space_Index( CARDINAL32 DriveArrayIndex );
+
+static void Add_Free_Space_To_Index( Partition_Data * Free_Space );
+
+static void Remove_Free_Space_From_Index( Partition_Data * Free_Space );
+
+static CARDINAL32 Find_Free_Space_By_Start( Free_Space_Index * Space_Index, LBA Starting_Sector );
+
+static CARDINAL32 Find_Free_Space_By_Size( Free_Space_Index * Space_Index, CARDINAL32 Size, LBA Starting_Sector );
+
+static void Update_Start_Bounds( Free_Space_Index * Space_Index, CARDINAL32 Position );
+
+static int Compare_Free_Space_Size( const void * First, const void * Second );
+
+static BOOLEAN Free_Space_Is_Acceptable( Partition_Data * Free_Space, Free_Space_Search_Record * Search );
+
+static Partition_Data * Select_Free_Space( CARDINAL32 DriveArrayIndex, CARDINAL32 Size, Allocation_Algorithm algorithm, BOOLEAN Bootable, BOOLEAN Primary_Partition, BOOLEAN Allocate_From_Start, CARDINAL32 * Error_Code );
+
+static ADDRESS Select_Best_Fit_Drive( CARDINAL32 Size, BOOLEAN Bootable, BOOLEAN Primary_Partition, BOOLEAN Allocate_From_Start, CARDINAL32 * Error_Code );
+
+static CARDINAL32 Round_Partition_Size( CARDINAL32 DriveArrayIndex, CARDINAL32 Size, BOOLEAN Primary_Partition );
+
+static CARDINAL32 Align_Partition( Partition_Data * Free_Space, CARDINAL32 Size, BOOLEAN Primary_Partition, BOOLEAN Allocate_From_Start, LBA * Starting_Sector, CARDINAL32 * Skipped_Sectors );
+
+static Metadata_Sector * Find_Metadata_Sector( CARDINAL32 DriveArrayIndex, LBA Sector, BOOLEAN Add );
+
+static void Queue_Metadata_Write( CARDINAL32 DriveArrayIndex, LBA Sector, ADDRESS Buffer, BOOLEAN DLA_Table );
+
+static void Write_Metadata_Sectors( CARDINAL32 DriveArrayIndex, CARDINAL32 * Error_Code );
+
+static void Discard_Metadata_Table( CARDINAL32 DriveArrayIndex );
+
 
 
 /*--------------------------------------------------
@@ -348,6 +462,22 @@ void Initialize_Partition_Manager( BOOLEAN Ignore_CHS, CARDINAL32 * Error_Code )
 
 #endif
 
+    /* Index the Partitions list for this drive by partition serial number so that Get_Partition_Handle does not have to walk it. */
+    CreateListIndex( DriveArray[Index].Partitions, &Partition_Serial_Number_Key, Error_Code );
+    if ( *Error_Code != DLIST_SUCCESS )
+    {
+
+      *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+      /* We must undo what we have thus far done to the DriveArray.  Calling Close_Partition_Manager will accomplish this. */
+      Close_Partition_Manager();
+
+      FUNCTION_EXIT("Initialize_Partition_Manager")
+
+      return;
+
+    }
+
     /* Allocate memory for a Partition_Data structure. */
     Data = ( Partition_Data * ) malloc( sizeof( Partition_Data ) );
 
@@ -520,8 +650,22 @@ void Close_Partition_Manager( void )
 
 #endif
 
+    /* The blocks of free space in the free space index for this entry in the DriveArray are gone, so discard the index too. */
+    if ( DriveArray[Index].Record_Initialized )
+    {
+
+      Discard_Free_Space_Index( Index );
+
+      /* What we know of the metadata sectors on the drive may be out of date by the time the Partition Manager is opened again. */
+      Discard_Metadata_Table( Index );
+
+    }
+
   }
 
+  /* Discard any partition tables left over from an aborted call to Discover_Partitions. */
+  Free_Partition_Tables();
+
   /* Indicate that the Partition Manager is closed. */
   Partition_Manager_Initialized = FALSE;
 
@@ -658,6 +802,18 @@ void Discover_Partitions( CARDINAL32 * Error_Code )
 
 #endif
 
+  /* Start by reading the MBR/EBR chains and DLA Tables of all of the drives at once.  The reads for different drives are done in
+     parallel by the DiskIO module, so the time this takes depends upon the longest chain rather than upon the number of drives.
+     Each MBR/EBR and its DLA Table are read together as one track, and the read of the next EBR in a chain is started as soon as
+     its location is known.
+     The sectors read are kept by drive, and the loop below consumes them in DriveArray order, so the Partitions lists built are
+     the same as they would be if each sector were read as it was needed.
+     The metadata table for each drive is rebuilt from the sectors read, so throw away the old one first.                          */
+  for ( Index = 0; Index < DriveCount; Index++ )
+    Discard_Metadata_Table( Index );
+
+  Read_Partition_Tables();
+
   /* This is where the fun begin.  We will walk the DriveArray.  For each entry in the DriveArray, we will read in the MBR.  We will
      add each partition in the MBR to the Partitions list for this entry in the DriveArray.  If there is an EBR, we will follow the
      EBR chain adding any partitions found there to the Partitions list for this entry in the DriveArray.                             */
@@ -701,12 +857,12 @@ void Discover_Partitions( CARDINAL32 * Error_Code )
 
       }
 
-      /* Read the MBR/EBR and process it. */
-      ReadSectors(Index + 1,    /* OS/2's drive numbers are 1 based whereas our DriveArray is 0 based.  Add 1 to Index to translate. */
-                  MBR_EBR_LBA,
-                  1,            /* We only want the MBR/EBR. */
-                  &MBR,         /* The Buffer to use. */
-                  Error_Code);
+      /* Get the MBR/EBR and process it. */
+      Get_Partition_Table_Sector(Index,
+                                 MBR_EBR_LBA,
+                                 FALSE,        /* We want the MBR/EBR. */
+                                 &MBR,         /* The Buffer to use. */
+                                 Error_Code);
 
       /* Was the read successful? */
       if ( *Error_Code != DISKIO_NO_ERROR )
@@ -838,12 +994,12 @@ void Discover_Partitions( CARDINAL32 * Error_Code )
       }
 
 
-      /* Read in the corresponding DLA Table. */
-      ReadSectors(Index + 1,    /* OS/2's drive numbers are 1 based whereas our DriveArray is 0 based.  Add 1 to Index to translate. */
-                  MBR_EBR_LBA + DriveArray[Index].Geometry.Sectors - 1,
-                  1,            /* We only want the DLA Table. */
-                  &DLA_Sector,         /* The Buffer to use. */
-                  Error_Code);
+      /* Get the corresponding DLA Table. */
+      Get_Partition_Table_Sector(Index,
+                                 MBR_EBR_LBA,
+                                 TRUE,         /* We want the DLA Table. */
+                                 &DLA_Sector,  /* The Buffer to use. */
+                                 Error_Code);
 
       /* Was the read successful? */
       if ( *Error_Code != DISKIO_NO_ERROR )
@@ -2401,6 +2557,9 @@ void Discover_Partitions( CARDINAL32 * Error_Code )
 
   } /* End of for loop. */
 
+  /* We are done with the sectors read by Read_Partition_Tables. */
+  Free_Partition_Tables();
+
   /* Were any of the drives usable? */
   if ( IO_Error_Count >= DriveCount )
   {
@@ -2454,7 +2613,9 @@ void Discover_Partitions( CARDINAL32 * Error_Code )
 /*                 for the partition experiencing the error will be  */
 /*                 set to TRUE.                                      */
 /*                                                                   */
-/*   Notes:  None.                                                   */
+/*   Notes:  Only those MBR, EBR, and DLA Table sectors which differ */
+/*           from what is on disk are written.  They are written in  */
+/*           ascending order by LBA, with one request per drive.     */
 /*                                                                   */
 /*********************************************************************/
 void Commit_Partition_Changes( CARDINAL32 * Error_Code )
@@ -2467,6 +2628,9 @@ void Commit_Partition_Changes( CARDINAL32 * Error_Code )
   DLA_Table_Sector *   EBR_DLA;                   /* Used to access the DLA table corresponding to an EBR. */
   DLA_Table_Sector *   MBR_DLA;                   /* Used to access the DLA tabel associated with the MBR. */
   Master_Boot_Record * Clean_MBR;                 /* Used to access the MBR and clear its partition table. */
+  Metadata_Table *     Metadata;                  /* The metadata table for the drive being processed. */
+  Metadata_Sector *    Old_MBR;                   /* The MBR as it is on disk, if known. */
+  CARDINAL32           Sector_Index;              /* Used to walk the metadata table for a drive. */
 
 
   FUNCTION_ENTRY("Commit_Partition_Changes")
@@ -2624,14 +2788,32 @@ void Commit_Partition_Changes( CARDINAL32 * Error_Code )
       else
       {
 
-        LOG_EVENT("Reading in the existing MBR for the drive.")
+        /* If we already know what is in the old MBR, then there is no need to read it again. */
+        Old_MBR = Find_Metadata_Sector( Index, 0, FALSE );
+        if ( ( Old_MBR != NULL ) && Old_MBR->Contents_Known )
+        {
+
+          memcpy(&MBR, Old_MBR->On_Disk, BYTES_PER_SECTOR);
+
+          *Error_Code = DISKIO_NO_ERROR;
+
+        }
+        else
+        {
+
+          LOG_EVENT("Reading in the existing MBR for the drive.")
+
+          /* Read in the old MBR. */
+          ReadSectors(Index + 1,    /* OS/2's drive numbers are 1 based whereas our DriveArray is 0 based.  Add 1 to Index to translate. */
+                      0,            /* MBR is always at LBA 0. */
+                      1,            /* We only want the MBR/EBR. */
+                      &MBR,         /* The Buffer to use. */
+                      Error_Code);
+
+          if ( *Error_Code == DISKIO_NO_ERROR )
+            Remember_Metadata_Sector( Index, 0, &MBR );
 
-        /* Read in the old MBR. */
-        ReadSectors(Index + 1,    /* OS/2's drive numbers are 1 based whereas our DriveArray is 0 based.  Add 1 to Index to translate. */
-                    0,            /* MBR is always at LBA 0. */
-                    1,            /* We only want the MBR/EBR. */
-                    &MBR,         /* The Buffer to use. */
-                    Error_Code);
+        }
 
         /* Was the read successful? */
         if ( *Error_Code != DISKIO_NO_ERROR )
@@ -2725,7 +2907,18 @@ void Commit_Partition_Changes( CARDINAL32 * Error_Code )
       memset(MBR_DLA->DLA_Array, 0, 4 * sizeof(DLA_Entry) );
       memset(EBR_DLA->DLA_Array, 0, 4 * sizeof(DLA_Entry) );
 
-      /* Now traverse the Partitions list and write all of the EBRs to disk. */
+      /* Every sector in the metadata table for this drive must be claimed again by Write_Changes or by the MBR below.  Those which are
+         not claimed no longer hold metadata, and will be dropped from the table once the changes have been written.                      */
+      Metadata = (Metadata_Table *) DriveArray[Index].Metadata_Table;
+      if ( Metadata != NULL )
+      {
+
+        for ( Sector_Index = 0; Sector_Index < Metadata->Count; Sector_Index++ )
+          Metadata->Sectors[Sector_Index]->In_Use = FALSE;
+
+      }
+
+      /* Now traverse the Partitions list and build all of the EBRs. */
 
       /* Process the partitions list in reverse. */
       ForEachItem( DriveArray[Index].Partitions, &Write_Changes, NULL, FALSE, Error_Code );
@@ -2753,7 +2946,7 @@ void Commit_Partition_Changes( CARDINAL32 * Error_Code )
 
 #endif
 
-      /* Now that all of the EBRs have been written to disk, we can finish the MBR and write it to disk. */
+      /* Now that all of the EBRs have been built, we can finish the MBR. */
 
       if ( Build_Data.Extended_Partition_Start != 0 )
       {
@@ -2777,53 +2970,28 @@ void Commit_Partition_Changes( CARDINAL32 * Error_Code )
 
       }
 
-      /* Now that the MBR is complete, write it to disk. */
-
-      LOG_EVENT("Writing the MBR to disk.")
-
-      /* Write the MBR. */
-      WriteSectors(Index + 1,   /* OS/2's drive numbers are 1 based whereas our DriveArray is 0 based.  Add 1 to Index to translate. */
-                  0,            /* MBR is always at LBA 0. */
-                  1,            /* We only want the MBR/EBR. */
-                  &MBR,         /* The Buffer to use. */
-                  Error_Code);
-
-      /* Was the write successful? */
-      if ( *Error_Code != DISKIO_NO_ERROR )
-      {
-
-        LOG_ERROR2("WriteSectors failed while writing the MBR to disk!","Drive Number",Index + 1,"Error code", *Error_Code)
-
-        /* If this write fails, the drive may be unusable! Log the error against the drive. */
-        DriveArray[Index].IO_Error = TRUE;
-
-        /* Remember that an I/O error occured. */
-        IO_Error_Detected = TRUE;
-
-      }
-
-      /* Now we must calculate the CRC for the MBR's corresponding DLA Table and then write that DLA Table to disk. */
+      /* Now that the MBR is complete, we must calculate the CRC for the MBR's corresponding DLA Table. */
 
       MBR_DLA->DLA_CRC = 0;
 
       MBR_DLA->DLA_CRC = CalculateCRC( INITIAL_CRC, &MBR_DLA_Sector, BYTES_PER_SECTOR);
 
-      LOG_EVENT("Writing the DLA table for the MBR to disk.")
+      /* The MBR is always at LBA 0, and its DLA Table is always at LBA 0 + Sectors_Per_Track - 1. */
+      Queue_Metadata_Write( Index, 0, &MBR, FALSE );
+      Queue_Metadata_Write( Index, DriveArray[Index].Geometry.Sectors - 1, &MBR_DLA_Sector, TRUE );
 
-      /* Now write the DLA table to disk. */
-      WriteSectors(Index + 1,                                    /* OS/2's drive numbers are 1 based whereas our DriveArray is 0 based.  Add 1 to Index to translate. */
-                  DriveArray[Index].Geometry.Sectors - 1,        /* The MBR DLA is always at LBA 0 + Sectors_Per_Track - 1. */
-                  1,                                             /* We only want the DLA Table. */
-                  &MBR_DLA_Sector,                               /* The Buffer to use. */
-                  Error_Code);
+      LOG_EVENT("Writing the changed MBR, EBR, and DLA Table sectors to disk.")
+
+      /* Write every MBR, EBR, and DLA Table sector which differs from what is on disk, in ascending order, with one request. */
+      Write_Metadata_Sectors( Index, Error_Code );
 
       /* Was the write successful? */
       if ( *Error_Code != DISKIO_NO_ERROR )
       {
 
-        LOG_ERROR2("WriteSectors failed while writing the DLA to disk!", "Disk Number", Index + 1, "Error code", *Error_Code)
+        LOG_ERROR2("WriteSectorsV failed while writing the MBR, EBR, and DLA Table sectors to disk!","Drive Number",Index + 1,"Error code", *Error_Code)
 
-        /* Log the error against the drive. */
+        /* If this write fails, the drive may be unusable! Log the error against the drive. */
         DriveArray[Index].IO_Error = TRUE;
 
         /* Remember that an I/O error occured. */
@@ -3113,6 +3281,251 @@ Partition_Information_Record  Get_Partition_Information( ADDRESS Partition_Handl
 }
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Get_Partition_Information_Array                  */
+/*                                                                   */
+/*   Descriptive Name: Returns the Partition_Information_Records for */
+/*                     a group of partitions in a single array.      */
+/*                                                                   */
+/*   Input: ADDRESS Partition_Handles[] - The handles of the         */
+/*                                        partitions whose           */
+/*                                        Partition_Information_     */
+/*                                        Records are desired.  If   */
+/*                                        this is NULL, then the     */
+/*                                        records for all of the     */
+/*                                        partitions and blocks of   */
+/*                                        free space on all of the   */
+/*                                        drives are returned.       */
+/*          CARDINAL32 Count - The number of entries in              */
+/*                             Partition_Handles.  This is ignored   */
+/*                             if Partition_Handles is NULL.         */
+/*          CARDINAL32 * Error_Code - The address of a CARDINAL32 in */
+/*                                    in which to store an error code*/
+/*                                    should an error occur.         */
+/*                                                                   */
+/*   Output: A Partition_Information_Array is returned.  If there is */
+/*           no error, then the Nth entry of Partition_Array will be */
+/*           the record for the Nth entry of Partition_Handles, and  */
+/*           *Error_Code will be 0.  If an error occurs, *Error_Code */
+/*           will be non-zero.                                       */
+/*                                                                   */
+/*   Error Handling: If any entry of Partition_Handles is not the    */
+/*                   handle of a partition, *Error_Code will be      */
+/*                   LVM_ENGINE_BAD_HANDLE.  Any memory allocated for*/
+/*                   the return value will be freed, and the         */
+/*                   Partition_Information_Array returned will have a*/
+/*                   NULL Partition_Array and a Count of 0.          */
+/*                                                                   */
+/*   Side Effects:  Memory will be allocated to hold the array       */
+/*                  returned by this function.                       */
+/*                                                                   */
+/*   Notes:  This does the work of calling Get_Partition_Information */
+/*           for each handle, but with one entry into the engine and */
+/*           one allocation.  When Partition_Handles is NULL, the    */
+/*           records are in drive order, and the records for each    */
+/*           drive are in the order that Get_Partitions returns them.*/
+/*                                                                   */
+/*           The caller becomes responsible for the memory allocated */
+/*           for Partition_Array, and should free it with            */
+/*           Free_Engine_Memory when they are done using it.         */
+/*                                                                   */
+/*********************************************************************/
+Partition_Information_Array Get_Partition_Information_Array( ADDRESS Partition_Handles[], CARDINAL32 Count, CARDINAL32 * Error_Code )
+{
+
+  Partition_Information_Array      ReturnValue;                   /* The structure to be returned to the caller. */
+  CARDINAL32                       Eligible_Partition_Count = 0;  /* Used to count how many partitions are to be returned to the caller. */
+  CARDINAL32                       Index;                         /* Used to walk Partition_Handles or the DriveArray. */
+
+  ADDRESS                          Object;                        /* Used when translating a handle into a Partition_Data structure. */
+  TAG                              ObjectTag;                     /* Used when translating a handle into a Partition_Data structure. */
+
+
+  API_ENTRY("Get_Partition_Information_Array")
+
+  /* Initialize ReturnValue assuming a failure. */
+  ReturnValue.Count = 0;
+  ReturnValue.Partition_Array = NULL;
+
+  /* Has the Engine been opened yet? */
+  if ( DriveArray == NULL )
+  {
+
+    /* The Engine has not been opened yet!  Nothing has been initialized yet, so we can not perform the function asked of us.  Abort. */
+    *Error_Code = LVM_ENGINE_NOT_OPEN;
+
+    API_EXIT("Get_Partition_Information_Array")
+
+    return ReturnValue;
+
+  }
+
+  /* How many records will we be returning? */
+  if ( Partition_Handles != NULL )
+  {
+
+    Eligible_Partition_Count = Count;
+
+  }
+  else
+  {
+
+    /* We only count free space and partitions, not entries for MBRs or EBRs. */
+    for ( Index = 0; Index < DriveCount; Index++ )
+    {
+
+      ForEachItem(DriveArray[Index].Partitions,&Count_Eligible_Partitions,&Eligible_Partition_Count,TRUE,Error_Code);
+
+#ifdef DEBUG
+
+#ifdef PARANOID
+
+      assert( *Error_Code == DLIST_SUCCESS );
+
+#else
+
+      /* Was there an error? */
+      if ( *Error_Code != DLIST_SUCCESS )
+      {
+
+        /* This should never happen here.  We have an internal error! */
+        *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+        API_EXIT("Get_Partition_Information_Array")
+
+        return ReturnValue;
+
+      }
+
+#endif
+
+#endif
+
+    }
+
+  }
+
+  /* If there is nothing to return, then we are done. */
+  if ( Eligible_Partition_Count == 0 )
+  {
+
+    *Error_Code = LVM_ENGINE_NO_ERROR;
+
+    API_EXIT("Get_Partition_Information_Array")
+
+    return ReturnValue;
+
+  }
+
+  /* Allocate memory for the array being returned to the caller. */
+  ReturnValue.Partition_Array = (Partition_Information_Record *) malloc(Eligible_Partition_Count * sizeof(Partition_Information_Record) );
+
+  if ( ReturnValue.Partition_Array == NULL )
+  {
+
+    /* We are out of memory! */
+    *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    API_EXIT("Get_Partition_Information_Array")
+
+    return ReturnValue;
+
+  }
+
+  /* ReturnValue.Count is currently 0.  We will use it to index the Partition_Array as we fill it in. */
+
+  if ( Partition_Handles != NULL )
+  {
+
+    for ( Index = 0; Index < Count; Index++ )
+    {
+
+      /* Determine what kind of a handle we really have. */
+      Translate_Handle( Partition_Handles[Index], &Object, &ObjectTag, Error_Code );
+
+      /* Was the handle valid, and is the object what we want? */
+      if ( ( *Error_Code != HANDLE_MANAGER_NO_ERROR ) || ( ObjectTag != PARTITION_DATA_TAG ) )
+      {
+
+        LOG_ERROR1("Bad partition handle!", "Index", Index)
+
+        /* We have a bad handle.  Clean up ReturnValue. */
+        *Error_Code = LVM_ENGINE_BAD_HANDLE;
+
+        free(ReturnValue.Partition_Array);
+        ReturnValue.Partition_Array = NULL;
+        ReturnValue.Count = 0;
+
+        API_EXIT("Get_Partition_Information_Array")
+
+        return ReturnValue;
+
+      }
+
+      Set_Partition_Information_Record( &( ReturnValue.Partition_Array[ReturnValue.Count] ), (Partition_Data *) Object);
+
+      ReturnValue.Count++;
+
+    }
+
+  }
+  else
+  {
+
+    /* Now traverse the partition list of each drive and transfer the information from the list to the array. */
+    for ( Index = 0; Index < DriveCount; Index++ )
+    {
+
+      ForEachItem(DriveArray[Index].Partitions,&Transfer_Partition_Data,&ReturnValue,TRUE,Error_Code);
+
+#ifdef DEBUG
+
+#ifdef PARANOID
+
+      assert( *Error_Code == DLIST_SUCCESS );
+
+#else
+
+      /* Was there an error? */
+      if ( *Error_Code != DLIST_SUCCESS )
+      {
+
+        /* This should not be possible here.  We must have an internal error. */
+        *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+        /* Clean up ReturnValue. */
+        ReturnValue.Count = 0;
+        free(ReturnValue.Partition_Array);
+        ReturnValue.Partition_Array = NULL;
+
+        API_EXIT("Get_Partition_Information_Array")
+
+        return ReturnValue;
+
+      }
+
+#endif
+
+#endif
+
+    }
+
+  }
+
+  /* All done. */
+
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  LOG_EVENT1("Returning data for X partitions.","X",ReturnValue.Count)
+
+  API_EXIT("Get_Partition_Information_Array")
+
+  return ReturnValue;
+
+}
+
+
 /*********************************************************************/
 /*                                                                   */
 /*   Function Name: Create_Partition                                 */
@@ -3120,7 +3533,12 @@ Partition_Information_Record  Get_Partition_Information( ADDRESS Partition_Handl
 /*   Descriptive Name: Creates a partition on a disk drive.          */
 /*                                                                   */
 /*   Input: ADDRESS         Handle - The handle of a disk drive or   */
-/*                                   a block of free space.          */
+/*                                   a block of free space.  If      */
+/*                                   Handle is NULL, then the engine */
+/*                                   will use the block of free      */
+/*                                   space, on any drive, which is   */
+/*                                   closest in size to the          */
+/*                                   partition.                      */
 /*          CARDINAL32      Size - The size, in sectors, of the      */
 /*                                 partition to create.              */
 /*          char            Name[] - The name to give to the newly   */
@@ -3133,6 +3551,10 @@ Partition_Information_Record  Get_Partition_Information( ADDRESS Partition_Handl
 /*                                           tells the engine which  */
 /*                                           memory management       */
 /*                                           algorithm to use.       */
+/*                                           If Handle is NULL,      */
+/*                                           then this must be       */
+/*                                           Automatic or            */
+/*                                           Best_Fit.               */
 /*          BOOLEAN         Bootable - If TRUE, then the engine will */
 /*                                     only create the partition if  */
 /*                                     it can be booted from.  If    */
@@ -3205,6 +3627,8 @@ ADDRESS Create_Partition( ADDRESS               Handle,
   CARDINAL32                         Index;                         /* Used to access the drive array. */
   LBA                                Starting_Sector;               /* Used to calculate the LBA of the starting sector for the partition. */
   CARDINAL32                         Adjustment;                    /* Used when calculating adjustments to the size and/or starting sector of a partition. */
+  CARDINAL32                         Aligned_Size;                  /* Used to hold the size of the partition when the allocation algorithm is Aligned. */
+  CARDINAL32                         Skipped_Sectors = 0;           /* Used to hold the number of sectors skipped to align the partition. */
   Partition_Data   *                 Selected_Free_Space = NULL;    /* Used to point to the block of free space selected for creating the partition in. */
   ADDRESS                            New_Partition_Handle = NULL;   /* Used to hold the external handle for the new partition being created. */
   Duplicate_Check_Parameter_Record   Name_Check_Parameters;         /* Used to check for duplicate partition names. */
@@ -3214,9 +3638,6 @@ ADDRESS Create_Partition( ADDRESS               Handle,
   Primary_Partition_Status           Primary_Status_Record;         /* Used when determining the types of primary partitions which exist on a drive. */
   BOOLEAN                            Need_MBR = FALSE;              /* Set to TRUE for drives which have no MBR.  Reminds us to allocate an MBR for these drives. */
   BOOLEAN                            Free_Space_Selected = FALSE;   /* Used to control the do-while loop.  */
-  BOOLEAN                            Still_Looking;                 /* Used to control the search for a suitable block of free space when Handle refers to a drive instead of a block of free space. */
-  BOOLEAN                            FreeSpaceAvailable = FALSE;    /* Used to decide which error message to return when no acceptable block of free space is found. */
-  BOOLEAN                            Wrong_Partition_Type = FALSE;  /* Used to decide which error message to return when no acceptable block of free space is found. */
 
 
   API_ENTRY("Create_Partition")
@@ -3234,6 +3655,9 @@ ADDRESS Create_Partition( ADDRESS               Handle,
 
   }
 
+  /* Nothing has been skipped to align a partition yet. */
+  Alignment_Waste = 0;
+
   /* Zero out the Partition_Table_Entry and the DLA_Table_Entry. */
   memset(&Partition_Table_Entry,0,sizeof(Partition_Record) );
   memset(&DLA_Table_Entry,0,sizeof(DLA_Entry) );
@@ -3243,24 +3667,69 @@ ADDRESS Create_Partition( ADDRESS               Handle,
      ensure correct translation, set the Boot_Sector variable to all 0xf6.                                                          */
   memset(Boot_Sector, 0xf6, BYTES_PER_SECTOR);
 
-  /* Determine what kind of a handle we really have. */
-  Translate_Handle( Handle, &Object, &ObjectTag, Error_Code );
-
-  /* Was the handle valid? */
-  if ( *Error_Code != HANDLE_MANAGER_NO_ERROR )
+  /* If we were not given a handle, then we must find the drive with the block of free space which is closest in size to the partition. */
+  if ( Handle == NULL )
   {
 
-    *Error_Code = LVM_ENGINE_BAD_HANDLE;
+    /* Only a best fit makes sense when the search covers every drive. */
+    if ( ( algorithm != Automatic ) && ( algorithm != Best_Fit ) )
+    {
 
-    API_EXIT("Create_Partition")
+      *Error_Code = LVM_ENGINE_BAD_ALLOCATION_ALGORITHM;
 
-    return NULL;
+      API_EXIT("Create_Partition")
 
-  }
+      return NULL;
 
-  /* D201136 - The LVM VIO interface can't handle having the engine remove trailing spaces from the
-               strings it passes in, so the engine was modified to copy the Name string passed in and
-               operate on the copy.
+    }
+
+    /* A size of 0 is only allowed with the All allocation algorithm. */
+    if ( Size == 0 )
+    {
+
+      *Error_Code = LVM_ENGINE_REQUESTED_SIZE_TOO_SMALL;
+
+      API_EXIT("Create_Partition")
+
+      return NULL;
+
+    }
+
+    Handle = Select_Best_Fit_Drive( Size, Bootable, Primary_Partition, Allocate_From_Start, Error_Code );
+
+    /* Did we find a drive?  If not, *Error_Code has already been set by Select_Best_Fit_Drive. */
+    if ( Handle == NULL )
+    {
+
+      API_EXIT("Create_Partition")
+
+      return NULL;
+
+    }
+
+    /* Now create the partition on the drive we found, using the same block of free space. */
+    algorithm = Best_Fit;
+
+  }
+
+  /* Determine what kind of a handle we really have. */
+  Translate_Handle( Handle, &Object, &ObjectTag, Error_Code );
+
+  /* Was the handle valid? */
+  if ( *Error_Code != HANDLE_MANAGER_NO_ERROR )
+  {
+
+    *Error_Code = LVM_ENGINE_BAD_HANDLE;
+
+    API_EXIT("Create_Partition")
+
+    return NULL;
+
+  }
+
+  /* D201136 - The LVM VIO interface can't handle having the engine remove trailing spaces from the
+               strings it passes in, so the engine was modified to copy the Name string passed in and
+               operate on the copy.
 
      BEGIN                                                                                          BMR */
 
@@ -3504,56 +3973,56 @@ ADDRESS Create_Partition( ADDRESS               Handle,
 
 #endif
 
-                                /* Adjust the requested size of the partition so that it is a multiple of Sectors_Per_Cylinder.
-                                   Always round up!                                                                               */
-                                if ( Size % DriveArray[Index].Sectors_Per_Cylinder )
+                                /* Is the partition to be aligned for 4K sector disks, SSDs, or RAID arrays? */
+                                if ( algorithm == Aligned )
                                 {
 
-                                  /* Convert size from sectors to cylinders. */
-                                  Size = Size / DriveArray[Index].Sectors_Per_Cylinder;
+                                  /* Find the aligned starting sector and size of the partition. */
+                                  Aligned_Size = Align_Partition( PartitionRecord, Size, Primary_Partition, Allocate_From_Start, &Starting_Sector, &Skipped_Sectors );
 
-                                  /* Round up. */
-                                  Size++;
+                                  /* Is there room in the block of free space for an aligned partition? */
+                                  if ( Aligned_Size == 0 )
+                                  {
 
-                                  /* Now turn size back into sectors. */
-                                  Size = Size * DriveArray[Index].Sectors_Per_Cylinder;
+                                    /* The block of free space does not contain a whole multiple of Partition_Alignment sectors.  Abort. */
+                                    *Error_Code = LVM_ENGINE_PARTITION_ALIGNMENT_ERROR;
 
-                                }
+                                    /* Free the copy of Name. */
+                                    free(Name);
 
-                                /* Calculate the starting LBA for the partition. */
-                                if ( Allocate_From_Start )
-                                {
+                                    API_EXIT("Create_Partition")
 
-                                  /* The starting LBA of the partition is the same as the starting LBA of the block of free space. */
-                                  Starting_Sector = PartitionRecord->Starting_Sector;
+                                    return NULL;
 
-                                  if ( Need_MBR )
+                                  }
+
+                                  /* Align_Partition only returns less than Size if the block of free space is too small.  As when allocating a
+                                     partition from the end of a block of free space, the partition may be made smaller if it is within 5% of the
+                                     size requested.                                                                                                */
+                                  if ( ( Aligned_Size < Size ) && ( ( Size - (Size / 20) ) > Aligned_Size ) )
                                   {
 
-#ifdef DEBUG
+                                    /* The block of free space is too small to hold the requested partition.  Indicate an error and abort. */
+                                    *Error_Code = LVM_ENGINE_REQUESTED_SIZE_TOO_BIG;
 
-                                    assert(Starting_Sector == 0);
+                                    /* Free the copy of Name. */
+                                    free(Name);
 
-#endif
+                                    API_EXIT("Create_Partition")
 
-                                    /* Primary partitions must be track aligned.  Non-primary partitions must be cylinder aligned. */
-                                    if ( Primary_Partition )
-                                    {
+                                    return NULL;
 
-                                      /* Since we have a primary partition, and since we need an MBR, the partition can start no sooner than
-                                         the first sector of the track following the track containing the MBR.  Adjust Starting_Sector accordingly. */
-                                      Starting_Sector = DriveArray[Index].Geometry.Sectors;
+                                  }
 
-                                    }
-                                    else
-                                    {
+                                  Size = Aligned_Size;
 
-                                      /* Non-primary partitions must be cylinder aligned.  The first sector of the cylinder they start on
-                                         will hold their EBR.  Since the MBR takes up a sector on the first track of the first cylinder,
-                                         a non-primary partition can not start until the second cylinder.  Adjust Starting_Sector accordingly. */
-                                      Starting_Sector = DriveArray[Index].Sectors_Per_Cylinder;
+                                  /* A logical drive is preceded by the track containing its EBR.  Align_Partition left room for this track, so
+                                     include it in Starting_Sector and Size, as that is where the code below expects to allocate the EBR from.      */
+                                  if ( ! Primary_Partition )
+                                  {
 
-                                    }
+                                    Starting_Sector -= DriveArray[Index].Geometry.Sectors;
+                                    Size += DriveArray[Index].Geometry.Sectors;
 
                                   }
 
@@ -3561,49 +4030,37 @@ ADDRESS Create_Partition( ADDRESS               Handle,
                                 else
                                 {
 
-                                  /* The partition will start somewhere within the block of free space.  Calculate the starting point. */
-
-                                  /* Is the block of free space large enough to hold the partition? */
-                                  if ( Size > PartitionRecord->Partition_Size )
+                                  /* Adjust the requested size of the partition so that it is a multiple of Sectors_Per_Cylinder.
+                                     Always round up!                                                                               */
+                                  if ( Size % DriveArray[Index].Sectors_Per_Cylinder )
                                   {
 
-                                    /* Is the size of the block of free space within 5% of the size of the requested partition? */
-                                    if ( ( Size - (Size / 20) ) <= PartitionRecord->Partition_Size )
-                                    {
-
-                                      /* The size of the requested partition is close enough.  We will "round" the requested size of the partition
-                                         to match the size of the block of free space.                                                              */
-                                      Size = PartitionRecord->Partition_Size;
-
-                                    }
-                                    else
-                                    {
+                                    /* Convert size from sectors to cylinders. */
+                                    Size = Size / DriveArray[Index].Sectors_Per_Cylinder;
 
-                                      /* The block of free space is too small to hold the requested partition.  Indicate an error and abort. */
-                                      *Error_Code = LVM_ENGINE_REQUESTED_SIZE_TOO_BIG;
+                                    /* Round up. */
+                                    Size++;
 
-                                      /* Free the copy of Name. */
-                                      free(Name);
+                                    /* Now turn size back into sectors. */
+                                    Size = Size * DriveArray[Index].Sectors_Per_Cylinder;
 
-                                      API_EXIT("Create_Partition")
+                                  }
 
-                                      return NULL;
+                                  /* Calculate the starting LBA for the partition. */
+                                  if ( Allocate_From_Start )
+                                  {
 
-                                    }
+                                    /* The starting LBA of the partition is the same as the starting LBA of the block of free space. */
+                                    Starting_Sector = PartitionRecord->Starting_Sector;
 
-                                  }
+                                    if ( Need_MBR )
+                                    {
 
-                                  /* The block of free space is large enough to hold the partition, so calculate the starting point for the partition. */
-                                  Starting_Sector = PartitionRecord->Starting_Sector + ( PartitionRecord->Partition_Size - Size );
+#ifdef DEBUG
 
-                                  if ( Need_MBR )
-                                  {
+                                      assert(Starting_Sector == 0);
 
-                                    /* Primary partitions must be track aligned.  Non-primary partitions must be cylinder aligned.
-                                       Since the first sector of the first track is in use for the MBR, a partition can not start
-                                       until the second track.                                                                       */
-                                    if ( Starting_Sector < DriveArray[Index].Geometry.Sectors )
-                                    {
+#endif
 
                                       /* Primary partitions must be track aligned.  Non-primary partitions must be cylinder aligned. */
                                       if ( Primary_Partition )
@@ -3627,62 +4084,108 @@ ADDRESS Create_Partition( ADDRESS               Handle,
                                     }
 
                                   }
+                                  else
+                                  {
 
-                                }
+                                    /* The partition will start somewhere within the block of free space.  Calculate the starting point. */
 
-                                /* Is the starting location for the partition correctly aligned? */
-                                if ( Primary_Partition && ( Starting_Sector % DriveArray[Index].Geometry.Sectors ) )
-                                {
+                                    /* Is the block of free space large enough to hold the partition? */
+                                    if ( Size > PartitionRecord->Partition_Size )
+                                    {
 
-                                  /* Primary partitions must be track aligned.  Make the starting point for the partition track aligned. */
-                                  Starting_Sector += DriveArray[Index].Geometry.Sectors - ( Starting_Sector % DriveArray[Index].Geometry.Sectors ) ;
+                                      /* Is the size of the block of free space within 5% of the size of the requested partition? */
+                                      if ( ( Size - (Size / 20) ) <= PartitionRecord->Partition_Size )
+                                      {
 
-                                }
-                                else
-                                {
+                                        /* The size of the requested partition is close enough.  We will "round" the requested size of the partition
+                                           to match the size of the block of free space.                                                              */
+                                        Size = PartitionRecord->Partition_Size;
 
-                                  /* Non-primary partitions must be cylinder aligned. */
-                                  if ( (! Primary_Partition ) && ( Starting_Sector % DriveArray[Index].Sectors_Per_Cylinder ) )
-                                  {
+                                      }
+                                      else
+                                      {
 
-                                    /* Non-primary partitions must be cylinder aligned. */
-                                    Starting_Sector += DriveArray[Index].Sectors_Per_Cylinder - ( Starting_Sector % DriveArray[Index].Sectors_Per_Cylinder );
+                                        /* The block of free space is too small to hold the requested partition.  Indicate an error and abort. */
+                                        *Error_Code = LVM_ENGINE_REQUESTED_SIZE_TOO_BIG;
 
-                                  }
+                                        /* Free the copy of Name. */
+                                        free(Name);
 
-                                }
+                                        API_EXIT("Create_Partition")
 
-                                /* Is the calculated starting sector of the partition still within the block of free space? */
-                                if ( Starting_Sector >= ( PartitionRecord->Starting_Sector + PartitionRecord->Partition_Size ) )
-                                {
+                                        return NULL;
 
-                                  /* We can not create the partition in this block of free space.  This block of free space is too small
-                                     and its odd alignement prevent us from creating an OS/2 acceptable partition.  Disks partitioned
-                                     using Unix don't have the same rules for partitions as OS/2, Windows, Windows9x, and Windows NT do,
-                                     and they may actually be able to use this small block of free space.  However, we can't.  Abort.     */
-                                  *Error_Code = LVM_ENGINE_PARTITION_ALIGNMENT_ERROR;
+                                      }
 
-                                  /* Free the copy of Name. */
-                                  free(Name);
+                                    }
 
-                                  API_EXIT("Create_Partition")
+                                    /* The block of free space is large enough to hold the partition, so calculate the starting point for the partition. */
+                                    Starting_Sector = PartitionRecord->Starting_Sector + ( PartitionRecord->Partition_Size - Size );
 
-                                  return NULL;
+                                    if ( Need_MBR )
+                                    {
 
-                                }
+                                      /* Primary partitions must be track aligned.  Non-primary partitions must be cylinder aligned.
+                                         Since the first sector of the first track is in use for the MBR, a partition can not start
+                                         until the second track.                                                                       */
+                                      if ( Starting_Sector < DriveArray[Index].Geometry.Sectors )
+                                      {
 
-                                /* Does the size of the partition have to shrink due to alignment? */
-                                if ( ( Starting_Sector + Size ) > ( PartitionRecord->Starting_Sector + PartitionRecord->Partition_Size ) )
-                                {
+                                        /* Primary partitions must be track aligned.  Non-primary partitions must be cylinder aligned. */
+                                        if ( Primary_Partition )
+                                        {
+
+                                          /* Since we have a primary partition, and since we need an MBR, the partition can start no sooner than
+                                             the first sector of the track following the track containing the MBR.  Adjust Starting_Sector accordingly. */
+                                          Starting_Sector = DriveArray[Index].Geometry.Sectors;
+
+                                        }
+                                        else
+                                        {
+
+                                          /* Non-primary partitions must be cylinder aligned.  The first sector of the cylinder they start on
+                                             will hold their EBR.  Since the MBR takes up a sector on the first track of the first cylinder,
+                                             a non-primary partition can not start until the second cylinder.  Adjust Starting_Sector accordingly. */
+                                          Starting_Sector = DriveArray[Index].Sectors_Per_Cylinder;
+
+                                        }
+
+                                      }
+
+                                    }
+
+                                  }
+
+                                  /* Is the starting location for the partition correctly aligned? */
+                                  if ( Primary_Partition && ( Starting_Sector % DriveArray[Index].Geometry.Sectors ) )
+                                  {
+
+                                    /* Primary partitions must be track aligned.  Make the starting point for the partition track aligned. */
+                                    Starting_Sector += DriveArray[Index].Geometry.Sectors - ( Starting_Sector % DriveArray[Index].Geometry.Sectors ) ;
 
-                                  /* Fix the size of the partition. */
-                                  Adjustment = ( Starting_Sector + Size ) - ( PartitionRecord->Starting_Sector + PartitionRecord->Partition_Size );
+                                  }
+                                  else
+                                  {
+
+                                    /* Non-primary partitions must be cylinder aligned. */
+                                    if ( (! Primary_Partition ) && ( Starting_Sector % DriveArray[Index].Sectors_Per_Cylinder ) )
+                                    {
+
+                                      /* Non-primary partitions must be cylinder aligned. */
+                                      Starting_Sector += DriveArray[Index].Sectors_Per_Cylinder - ( Starting_Sector % DriveArray[Index].Sectors_Per_Cylinder );
+
+                                    }
+
+                                  }
 
-                                  /* If the adjustment causes the partition's size to drop below ( one cylinder - 1 track), then we have a problem.  */
-                                  if ( ( Adjustment > Size ) || ( ( Size - Adjustment ) < ( DriveArray[Index].Sectors_Per_Cylinder - DriveArray[Index].Geometry.Sectors ) ) )
+                                  /* Is the calculated starting sector of the partition still within the block of free space? */
+                                  if ( Starting_Sector >= ( PartitionRecord->Starting_Sector + PartitionRecord->Partition_Size ) )
                                   {
 
-                                    /* The size of the resulting partition is too small to be used. */
+                                    /* We can not create the partition in this block of free space.  This block of free space is too small
+                                       and its odd alignement prevent us from creating an OS/2 acceptable partition.  Disks partitioned
+                                       using Unix don't have the same rules for partitions as OS/2, Windows, Windows9x, and Windows NT do,
+                                       and they may actually be able to use this small block of free space.  However, we can't.  Abort.     */
                                     *Error_Code = LVM_ENGINE_PARTITION_ALIGNMENT_ERROR;
 
                                     /* Free the copy of Name. */
@@ -3694,36 +4197,61 @@ ADDRESS Create_Partition( ADDRESS               Handle,
 
                                   }
 
-                                  /* Since the size of the resulting partition is still usable, make the change. */
-                                  Size -= Adjustment;
+                                  /* Does the size of the partition have to shrink due to alignment? */
+                                  if ( ( Starting_Sector + Size ) > ( PartitionRecord->Starting_Sector + PartitionRecord->Partition_Size ) )
+                                  {
 
-                                }
+                                    /* Fix the size of the partition. */
+                                    Adjustment = ( Starting_Sector + Size ) - ( PartitionRecord->Starting_Sector + PartitionRecord->Partition_Size );
 
-                                /* Does the partition end on a cylinder boundary?  If not, make it so! */
-                                Adjustment = ( Starting_Sector + Size ) % DriveArray[Index].Sectors_Per_Cylinder;
-                                if ( Adjustment )
-                                {
+                                    /* If the adjustment causes the partition's size to drop below ( one cylinder - 1 track), then we have a problem.  */
+                                    if ( ( Adjustment > Size ) || ( ( Size - Adjustment ) < ( DriveArray[Index].Sectors_Per_Cylinder - DriveArray[Index].Geometry.Sectors ) ) )
+                                    {
 
-                                  /* Does the adjustment make the partition too small to create? */
-                                  if ( ( Adjustment < Size ) && ( ( Size - Adjustment ) >= ( DriveArray[Index].Sectors_Per_Cylinder - DriveArray[Index].Geometry.Sectors ) ) )
-                                  {
+                                      /* The size of the resulting partition is too small to be used. */
+                                      *Error_Code = LVM_ENGINE_PARTITION_ALIGNMENT_ERROR;
 
-                                    /* Since the resulting size of the partition is acceptable, do it. */
+                                      /* Free the copy of Name. */
+                                      free(Name);
+
+                                      API_EXIT("Create_Partition")
+
+                                      return NULL;
+
+                                    }
+
+                                    /* Since the size of the resulting partition is still usable, make the change. */
                                     Size -= Adjustment;
 
                                   }
-                                  else
+
+                                  /* Does the partition end on a cylinder boundary?  If not, make it so! */
+                                  Adjustment = ( Starting_Sector + Size ) % DriveArray[Index].Sectors_Per_Cylinder;
+                                  if ( Adjustment )
                                   {
 
-                                    /* The resulting size of the partition is too small.  Abort. */
-                                    *Error_Code = LVM_ENGINE_PARTITION_ALIGNMENT_ERROR;
+                                    /* Does the adjustment make the partition too small to create? */
+                                    if ( ( Adjustment < Size ) && ( ( Size - Adjustment ) >= ( DriveArray[Index].Sectors_Per_Cylinder - DriveArray[Index].Geometry.Sectors ) ) )
+                                    {
 
-                                    /* Free the copy of Name. */
-                                    free(Name);
+                                      /* Since the resulting size of the partition is acceptable, do it. */
+                                      Size -= Adjustment;
 
-                                    API_EXIT("Create_Partition")
+                                    }
+                                    else
+                                    {
 
-                                    return NULL;
+                                      /* The resulting size of the partition is too small.  Abort. */
+                                      *Error_Code = LVM_ENGINE_PARTITION_ALIGNMENT_ERROR;
+
+                                      /* Free the copy of Name. */
+                                      free(Name);
+
+                                      API_EXIT("Create_Partition")
+
+                                      return NULL;
+
+                                    }
 
                                   }
 
@@ -4245,472 +4773,165 @@ ADDRESS Create_Partition( ADDRESS               Handle,
 
                                  }
 
-                                 /* Adjust the requested size of the partition so that it is a multiple of Sectors_Per_Cylinder.
-                                    Always round up!                                                                               */
-                                 if ( Size % DriveArray[Index].Sectors_Per_Cylinder )
-                                 {
-
-                                   /* Convert size from sectors to cylinders. */
-                                   Size = Size / DriveArray[Index].Sectors_Per_Cylinder;
-
-                                   /* Round up. */
-                                   Size++;
-
-                                   /* Now turn size back into sectors. */
-                                   Size = Size * DriveArray[Index].Sectors_Per_Cylinder;
-
-                                   /* If we are making a primary partition, we can be 1 track less than a multiple of Sectors_Per_Cylinder.
-                                      This will allow us to start a primary partition on the first track after the track containing the MBR.
-                                      Without this adjustment, we can get into situations where we have almost an entire cylinder that we
-                                      will never allow a partition to be created in.  As an example, if we have a drive where the drive contains
-                                      a single extended partition of maximum size, there will be almost a cylinder of free space at the beginning
-                                      of the drive.  This is because an extended partition must start on a cylinder boundary and, because of the
-                                      MBR, the extended partition can't start until cylinder 1 on the disk.  This leave almost all of cylinder 0
-                                      free for use.  A primary partition can start on a track boundary, so a primary partition can be placed
-                                      in cylinder 0.  Such a primary partition could be used for Boot Manager, for instance.  Either way, a
-                                      primary partition can be either a multiple of the cylinder size, or 1 track less than a multiple of the
-                                      cylinder size.                                                                                                   */
-                                   if ( Primary_Partition )
-                                     Size -= DriveArray[Index].Geometry.Sectors;
-
-                                 }
-
+                                 /* Adjust the requested size of the partition so that it is a multiple of Sectors_Per_Cylinder, or, if the partition
+                                    is to be aligned, a multiple of Partition_Alignment.                                                                */
+                                 if ( algorithm == Aligned )
+                                   Size = ( ( Size + Partition_Alignment - 1 ) / Partition_Alignment ) * Partition_Alignment;
+                                 else
+                                   Size = Round_Partition_Size( Index, Size, Primary_Partition );
 
                                  /* We must select a block of free space on the drive for use in creating the partition specified.  */
+                                 Selected_Free_Space = Select_Free_Space( Index, Size, algorithm, Bootable, Primary_Partition, Allocate_From_Start, Error_Code );
 
-                                 Still_Looking = TRUE;
-
-                                 GoToStartOfList(DriveArray[Index].Partitions, Error_Code);
-
-#ifdef DEBUG
-
-#ifdef PARANOID
-
-                                    assert( *Error_Code == DLIST_SUCCESS );
-
-#else
-
-                                    /* Were there any errors? */
-                                    if ( *Error_Code != DLIST_SUCCESS )
-                                    {
-
-                                      /* There was an error during a DLIST manipulation function.  This should not happen!  Abort. */
-                                      *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
-
-                                      /* Free the copy of Name. */
-                                      free(Name);
-
-                                      API_EXIT("Create_Partition")
-
-                                      return NULL;
+                                 /* Do we have an acceptable block of free space?  If not, *Error_Code has already been set by Select_Free_Space. */
+                                 if ( Selected_Free_Space == NULL )
+                                 {
 
-                                    }
+                                   /* Free the copy of Name. */
+                                   free(Name);
 
-#endif
+                                   API_EXIT("Create_Partition")
 
-#endif
+                                   return NULL;
 
-                                 PartitionRecord = (Partition_Data *) GetObject(DriveArray[Index].Partitions,sizeof(Partition_Data),PARTITION_DATA_TAG, NULL, FALSE, Error_Code);
+                                 }
 
-                                 while ( ( *Error_Code == DLIST_SUCCESS ) && Still_Looking )
+                                 /* Are we to turn the entire disk into a single partition? */
+                                 if ( algorithm == All )
                                  {
 
-                                   /* Do we have a block of free space? */
-                                   if ( PartitionRecord->Partition_Type == FreeSpace )
+                                   /* How many items are in the Partitions list?  If only 1, then the drive has never been partitioned and
+                                      we can make the entire drive into a single partition.  If only 2, then the first entry must be the MBR
+                                      and the second entry must be free space - the very entry we selected.  So here too, we can make the
+                                      entire drive into a single partition.  If there are more than 2, then we can not make the drive
+                                      into a single partition and we must abort with an error.                                              */
+                                   if ( ( GetListSize( DriveArray[Index].Partitions, Error_Code ) < 3 ) && ( *Error_Code == DLIST_SUCCESS ) )
                                    {
 
-                                     /* Is this block of free space large enough to hold the partition, or is the allocation algorithm "All". */
-                                     if ( ( PartitionRecord->Partition_Size < Size ) && ( algorithm != All ) )
-                                     {
-
-                                       /* This block of free space is not acceptable. */
-                                       PartitionRecord = NULL;
+                                     /* We can turn the drive into a single partition!  Lets do it. */
+                                     Size = Selected_Free_Space->Partition_Size;
 
-                                     }
-                                     else
-                                     {
-
-                                       /* Since we have a block of free space large enough to satisfy the request, set the FreeSpaceAvailable flag. */
-                                       FreeSpaceAvailable = TRUE;
-
-                                       /* If we are trying to make a bootable partition, then the block of free space must be able to hold the partition
-                                          below the 1024 cylinder limit, if the 1024 cylinder limit applies.                                              */
-                                       if ( Bootable  && DriveArray[Index].Cylinder_Limit_Applies )
-                                       {
-
-                                         /* See if the partition will end below the 1024 cylinder limit. */
-                                         if ( Allocate_From_Start )
-                                         {
+                                   }
+                                   else
+                                   {
 
-                                           /* Calculate the end point of the partition if the partition starts at the beginning of the block of free space. */
-                                           if ( ( PartitionRecord->Starting_Sector + Size ) > DriveArray[Index].Cylinder_Limit )
-                                           {
+                                     /* We can not turn the drive into a single partition, as requested.  Abort. */
+                                     *Error_Code = LVM_ENGINE_BAD_ALLOCATION_ALGORITHM;
 
-                                             /* It did not end below the 1024 cylinder limit.  This block of free space is not acceptable. */
-                                             PartitionRecord = NULL;
+                                     /* Free the copy of Name. */
+                                     free(Name);
 
-                                             /* Since the Partitions list is an ordered list, the next block of free space we find will place our partition
-                                                even further over the 1024 cylinder limit, so there is no need to search the partitions list further.        */
-                                             Still_Looking = FALSE;
+                                     API_EXIT("Create_Partition")
 
-                                           }
+                                     return NULL;
 
-                                         }
-                                         else
-                                         {
+                                   }
 
-                                           /* Since the partition is allocated from the end of the block of free space, the block of free space must
-                                              end below the 1024 cylinder limit in order for the block of free space to be acceptable.                  */
-                                           if ( ( PartitionRecord->Starting_Sector + PartitionRecord->Partition_Size ) > DriveArray[Index].Cylinder_Limit )
-                                           {
+                                 }
 
-                                             /* The block of free space ended above the 1024 cylinder limit. */
-                                             PartitionRecord = NULL;
+                                 /* Set Object to point to the block of free space we have chosen. */
+                                 Object = (ADDRESS) Selected_Free_Space;
 
-                                             /* There is no point in looking further as all of the remaining blocks of free space in the partitions
-                                                list (if there are any) will end further and further above the 1024 cylinder limit since the
-                                                Partitions list is an ordered list based upon the starting sector of each item in the list.         */
-                                             Still_Looking = FALSE;
+                                 /* Set ObjectTag to indicate that Object now points to a Partition_Data structure. */
+                                 ObjectTag = PARTITION_DATA_TAG;
 
-                                           }
+                                 /* Now set Free_Space_Selected so that we will return to the top of the do-while loop and create the
+                                    partition from the block of free space that we have selected.                                      */
+                                 Free_Space_Selected = TRUE;
 
-                                         }
+                                 break;
 
-                                       }
+      case VOLUME_DATA_TAG :
+                             *Error_Code = LVM_ENGINE_OPERATION_NOT_ALLOWED;
 
-                                     }
+                             /* Free the copy of Name. */
+                             free(Name);
 
-                                     /* Do we have an acceptable block of free space to work with? */
-                                     if ( PartitionRecord != NULL )
-                                     {
-                                       /* Can we create the desired type of partition from the block of free space? */
-                                       if ( Primary_Partition )
-                                       {
+                             API_EXIT("Create_Partition")
 
-                                         if ( ! Can_Be_Primary( PartitionRecord, Error_Code) )
-                                         {
+                             return NULL;
 
-                                           /* This block of free space can not be made into a primary partition! */
-                                           PartitionRecord = NULL;
-                                           Wrong_Partition_Type = TRUE;
+      default: /* Internal Error! */
 
-                                           /* Clear the error code and continue looking for an appropriate block of free space. */
-                                           *Error_Code = LVM_ENGINE_NO_ERROR;
+#ifdef DEBUG
 
-                                         }
+#ifdef PARANOID
 
-                                       }
-                                       else
-                                       {
+               assert(0);
 
-                                         if ( ! Can_Be_Non_Primary( PartitionRecord, Error_Code ) )
-                                         {
+#endif
 
-                                           /* This block of free space can not be made into a non-primary partition! */
-                                           PartitionRecord = NULL;
-                                           Wrong_Partition_Type = TRUE;
+#endif
 
-                                           /* Clear the error code and continue looking for an appropriate block of free space. */
-                                           *Error_Code = LVM_ENGINE_NO_ERROR;
+               *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
 
-                                         }
+               /* Free the copy of Name. */
+               free(Name);
 
-                                       }
+               API_EXIT("Create_Partition")
 
-                                     }
+               return NULL;
 
-                                     /* Do we have an acceptable block of free space to work with? */
-                                     if ( PartitionRecord != NULL )
-                                     {
+    }
 
-                                       /* Which memory management algorithm are we using? */
-                                       switch ( algorithm )
-                                       {
-                                         case Automatic :
-                                         case First_Fit : /* Use the first block of free space to meet the requirements. */
-                                                          Selected_Free_Space = PartitionRecord;
+  } while ( Free_Space_Selected );
 
-                                                          /* Stop looking.  We have found the first block of free space which meets our requirements. */
-                                                          Still_Looking = FALSE;
 
-                                                          break;
+  /* Free the copy of Name. */
+  free(Name);
 
-                                         case Best_Fit : /* Use the block of free space which is closest in size to the partition we are creating. */
-                                                         if ( ( Selected_Free_Space == NULL) ||
-                                                              ( ( PartitionRecord->Partition_Size - Size ) < (Selected_Free_Space->Partition_Size - Size) )
-                                                            )
-                                                         {
+  /* Save the number of sectors skipped to align the partition for Get_Alignment_Waste. */
+  Alignment_Waste = Skipped_Sectors;
 
-                                                           Selected_Free_Space = PartitionRecord;
+  if ( Logging_Enabled && ( algorithm == Aligned ) )
+  {
 
-                                                         }
+    sprintf(Log_Buffer,"%d (decimal) sectors were left unused to align the new partition.", Skipped_Sectors);
+    Write_Log_Buffer();
 
-                                                         break;
+  }
 
-                                         case Last_Fit : /* Use the last block of free space to meet the requirements. */
-                                                         Selected_Free_Space = PartitionRecord;
+  /* Indicate success. */
+  *Error_Code = LVM_ENGINE_NO_ERROR;
 
-                                                         break;
+  API_EXIT("Create_Partition")
 
-                                         case From_Largest : /* Allocate this partition from the largest block of free space on the disk. */
-                                                             if ( (Selected_Free_Space == NULL) ||
-                                                                  ( PartitionRecord->Partition_Size > Selected_Free_Space->Partition_Size )
-                                                                )
-                                                             {
+  return New_Partition_Handle;
 
-                                                               /* PartitionRecord pointed to a larger block of free space, so it becomes our current selection. */
-                                                               Selected_Free_Space = PartitionRecord;
+}
 
-                                                             }
 
-                                                             break;
-
-                                         case From_Smallest : /* Allocate this partition from the smallest block of free space on the disk. */
-                                                              if ( (Selected_Free_Space == NULL) ||
-                                                                   ( PartitionRecord->Partition_Size < Selected_Free_Space->Partition_Size )
-                                                                 )
-                                                              {
-
-                                                                /* PartitionRecord pointed to a larger block of free space, so it becomes our current selection. */
-                                                                Selected_Free_Space = PartitionRecord;
-
-                                                              }
-
-                                                              break;
-
-                                         case All : /* Allocate the entire disk as a single partition. */
-
-                                                    /* How many items are in the Partitions list?  If only 1, then the drive has never been partitioned and
-                                                       we can make the entire drive into a single partition.  If only 2, then the first entry must be the MBR
-                                                       and the second entry must be free space - the very entry we are processing now.  So here too, we can
-                                                       make the entire drive into a single partition.  If there are more than 2, then we can not make the drive
-                                                       into a single partition and we must abort with an error.                                                  */
-
-                                                    if ( ( GetListSize( DriveArray[Index].Partitions, Error_Code ) < 3 ) && ( *Error_Code == DLIST_SUCCESS ) )
-                                                    {
-
-                                                      /* We can turn the drive into a single partition!  Lets do it. */
-                                                      Selected_Free_Space = PartitionRecord;
-                                                      Size = PartitionRecord->Partition_Size;
-
-                                                      /* No need to look further. */
-                                                      Still_Looking = FALSE;
-
-                                                    }
-                                                    else
-                                                    {
-
-                                                      /* We can not turn the drive into a single partition, as requested.  Abort. */
-                                                      *Error_Code = LVM_ENGINE_BAD_ALLOCATION_ALGORITHM;
-
-                                                      /* Free the copy of Name. */
-                                                      free(Name);
-
-                                                      API_EXIT("Create_Partition")
-
-                                                      return NULL;
-
-                                                    }
-
-                                                    break;
-                                         default: /* Bad algorith! */
-                                                  *Error_Code = LVM_ENGINE_BAD_ALLOCATION_ALGORITHM;
-
-                                                  /* Free the copy of Name. */
-                                                  free(Name);
-
-                                                  API_EXIT("Create_Partition")
-
-                                                  return NULL;
-
-                                       }
-
-                                     }
-
-                                   }
-
-                                   if ( Still_Looking )
-                                   {
-
-                                     /* Move on to the next item in the list. */
-                                     PartitionRecord = (Partition_Data *) GetNextObject(DriveArray[Index].Partitions, sizeof(Partition_Data), PARTITION_DATA_TAG, Error_Code );
-
-                                   }
-
-                                 }
-
-                                 if ( *Error_Code != DLIST_SUCCESS )
-                                 {
-
-                                   if ( *Error_Code == DLIST_END_OF_LIST )
-                                   {
-
-                                     /* Has a block of free space been chosen yet?  If not, then there are no acceptable blocks of free space. */
-                                     if ( Selected_Free_Space == NULL )
-                                     {
-
-                                       /* No block of free space was chosen!  Abort. */
-
-                                       /* Were there blocks of free space large enough to satisfy the request?  If so, then they must have been rejected
-                                          due to the 1024 cylinder limit.                                                                                 */
-                                       if ( FreeSpaceAvailable )
-                                       {
-
-                                         /* Was there a block of free space available below the 1024 cylinder limit but which could not be turned into the proper partition type? */
-                                         if ( Wrong_Partition_Type )
-                                         {
-
-                                           /* What type of partition were we trying to create? */
-                                           if ( Primary_Partition )
-                                             *Error_Code = LVM_ENGINE_CAN_NOT_MAKE_PRIMARY_PARTITION;
-                                           else
-                                             *Error_Code = LVM_ENGINE_CAN_NOT_MAKE_LOGICAL_DRIVE;
-
-                                         }
-                                         else
-                                           *Error_Code = LVM_ENGINE_1024_CYLINDER_LIMIT;
-
-                                       }
-                                       else
-                                         *Error_Code = LVM_ENGINE_NOT_ENOUGH_FREE_SPACE;
-
-                                       /* Free the copy of Name. */
-                                       free(Name);
-
-                                       API_EXIT("Create_Partition")
-
-                                       return NULL;
-
-                                     }
-                                     else
-                                     {
-
-                                       /* We found an acceptable block of free space.  Lets prepare to use it. */
-                                       *Error_Code = LVM_ENGINE_NO_ERROR;
-
-                                     }
-
-                                   }
-                                   else
-                                   {
-
-#ifdef DEBUG
-
-#ifdef PARANOID
-
-                                     assert( 0 );
-
-#endif
-
-#endif
-
-                                     /* We have an unexpected error!  Abort. */
-                                     *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
-
-                                     /* Free the copy of Name. */
-                                     free(Name);
-
-                                     API_EXIT("Create_Partition")
-
-                                     return NULL;
-
-                                   }
-
-                                 }
-
-                                 /* Do we have an acceptable block of free space? */
-                                 if ( Selected_Free_Space == NULL )
-                                 {
-
-                                   /* Were there blocks of free space large enough to satisfy the request?  If so, then they must have been rejected
-                                      due to the 1024 cylinder limit.                                                                                 */
-                                   if ( FreeSpaceAvailable )
-                                   {
-
-                                     /* Was there a block of free space available below the 1024 cylinder limit but which could not be turned into the proper partition type? */
-                                     if ( Wrong_Partition_Type )
-                                     {
-
-                                       /* What type of partition were we trying to create? */
-                                       if ( Primary_Partition )
-                                         *Error_Code = LVM_ENGINE_CAN_NOT_MAKE_PRIMARY_PARTITION;
-                                       else
-                                         *Error_Code = LVM_ENGINE_CAN_NOT_MAKE_LOGICAL_DRIVE;
-
-                                     }
-                                     else
-                                       *Error_Code = LVM_ENGINE_1024_CYLINDER_LIMIT;
-
-                                   }
-                                   else
-                                     *Error_Code = LVM_ENGINE_NOT_ENOUGH_FREE_SPACE;
-
-                                   /* Free the copy of Name. */
-                                   free(Name);
-
-                                   API_EXIT("Create_Partition")
-
-                                   return NULL;
-
-                                 }
-
-                                 /* Set Object to point to the block of free space we have chosen. */
-                                 Object = (ADDRESS) Selected_Free_Space;
-
-                                 /* Set ObjectTag to indicate that Object now points to a Partition_Data structure. */
-                                 ObjectTag = PARTITION_DATA_TAG;
-
-                                 /* Now set Free_Space_Selected so that we will return to the top of the do-while loop and create the
-                                    partition from the block of free space that we have selected.                                      */
-                                 Free_Space_Selected = TRUE;
-
-                                 break;
-
-      case VOLUME_DATA_TAG :
-                             *Error_Code = LVM_ENGINE_OPERATION_NOT_ALLOWED;
-
-                             /* Free the copy of Name. */
-                             free(Name);
-
-                             API_EXIT("Create_Partition")
-
-                             return NULL;
-
-      default: /* Internal Error! */
-
-#ifdef DEBUG
-
-#ifdef PARANOID
-
-               assert(0);
-
-#endif
-
-#endif
-
-               *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
-
-               /* Free the copy of Name. */
-               free(Name);
-
-               API_EXIT("Create_Partition")
-
-               return NULL;
-
-    }
-
-  } while ( Free_Space_Selected );
-
-
-  /* Free the copy of Name. */
-  free(Name);
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Get_Alignment_Waste                              */
+/*                                                                   */
+/*   Descriptive Name: Returns the number of sectors that were left  */
+/*                     unused by the last partition created with the */
+/*                     Aligned allocation algorithm.                 */
+/*                                                                   */
+/*   Input: None.                                                    */
+/*                                                                   */
+/*   Output: The number of sectors skipped, between the edge of the  */
+/*           block of free space that the partition was allocated    */
+/*           from and the partition itself, to align the partition.  */
+/*           This is 0 if the last call to Create_Partition failed or*/
+/*           did not use the Aligned allocation algorithm.           */
+/*                                                                   */
+/*   Error Handling: None required.                                  */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: None.                                                    */
+/*                                                                   */
+/*********************************************************************/
+CARDINAL32 Get_Alignment_Waste( void )
+{
 
-  /* Indicate success. */
-  *Error_Code = LVM_ENGINE_NO_ERROR;
+  API_ENTRY("Get_Alignment_Waste")
 
-  API_EXIT("Create_Partition")
+  API_EXIT("Get_Alignment_Waste")
 
-  return New_Partition_Handle;
+  return Alignment_Waste;
 
 }
 
@@ -4986,27 +5207,31 @@ void Delete_Partition( ADDRESS Partition_Handle, CARDINAL32 * Error_Code )
 /*                                                                   */
 /*   Side Effects:  None.                                            */
 /*                                                                   */
-/*   Notes:  None.                                                   */
+/*   Notes:  The Partitions list of each drive is indexed by serial  */
+/*           number.  Serial numbers and partition types are changed */
+/*           in place in many parts of the LVM Engine, so the index  */
+/*           may be out of date.  If the index does not find the     */
+/*           partition, the Partitions lists are searched, and the   */
+/*           partition found, if any, is indexed again.              */
 /*                                                                   */
 /*********************************************************************/
 ADDRESS Get_Partition_Handle( CARDINAL32 Serial_Number, CARDINAL32 * Error_Code )
 {
 
   CARDINAL32                Index;         /* Used to walk the DriveArray. */
-  Partition_Search_Record   Search_Record; /* Used when searching the partitions list of a drive. */
+  ADDRESS                   List_Handle;   /* The handle of a partition in the Partitions list of a drive. */
+  Partition_Data *          PartitionRecord;
+  DoubleWord                Key;           /* Serial_Number in the form in which it appears in a DLA Table entry. */
+  CARDINAL32                Ignore_Error;
 
   FUNCTION_ENTRY("Get_Partition_Handle")
 
-  /* Set up the Search_Record. */
-  Search_Record.Serial_Number = Serial_Number;
-  Search_Record.Handle = NULL;
-
-  /* We must examine each partition record on each drive until we find one with
-     a serial number that matches Serial_Number.                                 */
+  /* Try the index of each drive first. */
+  Key = Serial_Number;
   for ( Index = 0; Index < DriveCount; Index++ )
   {
 
-    ForEachItem(DriveArray[Index].Partitions,&Find_Partition, &Search_Record, TRUE, Error_Code);
+    List_Handle = FindByKey(DriveArray[Index].Partitions, &Key, sizeof(DoubleWord), Error_Code);
     if ( *Error_Code != DLIST_SUCCESS )
     {
 
@@ -5018,11 +5243,20 @@ ADDRESS Get_Partition_Handle( CARDINAL32 Serial_Number, CARDINAL32 * Error_Code
 
     }
 
-    /* Did we find a match? */
-    if ( Search_Record.Handle != NULL )
+    if ( List_Handle != NULL )
     {
 
-      /* We have a match! */
+      PartitionRecord = (Partition_Data *) GetObject(DriveArray[Index].Partitions, sizeof(Partition_Data), PARTITION_DATA_TAG, List_Handle, FALSE, Error_Code);
+      if ( *Error_Code != DLIST_SUCCESS )
+      {
+
+        *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+        FUNCTION_EXIT("Get_Partition_Handle")
+
+        return NULL;
+
+      }
 
       /* Indicate success. */
       *Error_Code = LVM_ENGINE_NO_ERROR;
@@ -5030,7 +5264,60 @@ ADDRESS Get_Partition_Handle( CARDINAL32 Serial_Number, CARDINAL32 * Error_Code
       FUNCTION_EXIT("Get_Partition_Handle")
 
       /* Return the handle. */
-      return Search_Record.Handle;
+      return PartitionRecord->External_Handle;
+
+    }
+
+  }
+
+  /* The index did not have the partition, but it may be out of date.  We must examine each partition record on each
+     drive until we find one with a serial number that matches Serial_Number.                                          */
+  for ( Index = 0; Index < DriveCount; Index++ )
+  {
+
+    DLIST_FOREACH( DriveArray[Index].Partitions, List_Handle )
+    {
+
+      /* Is this item what we think it should be? */
+      if ( ( DLIST_HANDLE_TAG( List_Handle ) != PARTITION_DATA_TAG ) || ( DLIST_HANDLE_SIZE( List_Handle ) != sizeof(Partition_Data) ) )
+      {
+
+#ifdef DEBUG
+
+#ifdef PARANOID
+
+        assert(0);
+
+#endif
+
+#endif
+
+        *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+        FUNCTION_EXIT("Get_Partition_Handle")
+
+        return NULL;
+
+      }
+
+      PartitionRecord = (Partition_Data *) DLIST_HANDLE_OBJECT( List_Handle );
+
+      /* Is this a partition with a matching serial number? */
+      if ( ( PartitionRecord->Partition_Type == Partition ) && ( PartitionRecord->DLA_Table_Entry.Partition_Serial_Number == Serial_Number ) )
+      {
+
+        /* We have a match!  Update the index so that the partition will be found there next time. */
+        ReindexItem(DriveArray[Index].Partitions, List_Handle, &Ignore_Error);
+
+        /* Indicate success. */
+        *Error_Code = LVM_ENGINE_NO_ERROR;
+
+        FUNCTION_EXIT("Get_Partition_Handle")
+
+        /* Return the handle. */
+        return PartitionRecord->External_Handle;
+
+      }
 
     }
 
@@ -6419,7 +6706,7 @@ Feature_Information_Array _System Get_Partition_Features( Partition_Data * Parti
 
   /* Now that we have the features on the partition, sort them by their Feature Sequence Number.  This will ensure that
      they will be applied to any new partitions in the correct order.                                                   */
-  SortList(Features_List, &Sort_By_Feature_Sequence_Number, Error_Code);
+  SortListByKey(Features_List, &Feature_Sequence_Number_Key, Error_Code);
   if ( *Error_Code != DLIST_SUCCESS )
   {
 
@@ -6531,69 +6818,227 @@ Feature_Information_Array _System Get_Partition_Features( Partition_Data * Parti
 }
 
 
-
-
-/*--------------------------------------------------
- * Private functions available.
- --------------------------------------------------*/
-
-
-
 /*********************************************************************/
 /*                                                                   */
-/*   Function Name:                                                  */
+/*   Function Name: Remember_Metadata_Sector                         */
 /*                                                                   */
-/*   Descriptive Name:                                               */
+/*   Descriptive Name: Records the contents of a metadata sector as  */
+/*                     it is on disk, so that                        */
+/*                     Commit_Partition_Changes and the features do  */
+/*                     not write the sector again unless it changes. */
 /*                                                                   */
-/*   Input:                                                          */
+/*   Input: CARDINAL32 DriveArrayIndex - The index in the DriveArray */
+/*                                       of the drive containing the */
+/*                                       sector.                     */
+/*          LBA Sector - The LBA of the sector.                      */
+/*          ADDRESS Buffer - The contents of the sector, as just read*/
+/*                           from or written to disk.                */
 /*                                                                   */
-/*   Output:                                                         */
+/*   Output: None.                                                   */
 /*                                                                   */
-/*   Error Handling:                                                 */
+/*   Error Handling: If there is not enough memory to add the sector */
+/*                   to the metadata table for the drive, then the   */
+/*                   sector is not recorded and will be written the  */
+/*                   next time it is committed.                      */
 /*                                                                   */
-/*   Side Effects:  None.                                            */
+/*   Side Effects: The metadata table for the drive may be created or*/
+/*                 grown.                                            */
 /*                                                                   */
-/*   Notes:  None.                                                   */
+/*   Notes: This should only be used for MBR/EBRs, DLA Tables, and   */
+/*          LVM Signature Sectors, as these are the only sectors     */
+/*          which Commit_Partition_Changes keeps track of.           */
 /*                                                                   */
 /*********************************************************************/
-static ADDRESS Find_And_Allocate_Partition( CARDINAL32         DriveArrayIndex, /* The index in the Drive Array to use. */
-                                            LBA                StartingSector,  /* The LBA at which the partition starts. */
-                                            CARDINAL32         Size,            /* The size of the partition in sectors. */
-                                            Partition_Types    Partition_Type,  /* The type of the partition - Partition, or MBR_EBR */
-                                            BOOLEAN            Primary_Partition,
-                                            Partition_Record * Partition_Table_Entry,
-                                            CARDINAL16         Partition_Table_Index,
-                                            DLA_Entry  *       DLA_Table_Entry,
-                                            BOOLEAN            Prior_Existing_Partition,
-                                            BOOLEAN            Migration_Needed,
-                                            CARDINAL32 *       Error_Code)
+void Remember_Metadata_Sector( CARDINAL32 DriveArrayIndex, LBA Sector, ADDRESS Buffer )
 {
 
-  Partition_Data *  Free_Space;
-
-  FUNCTION_ENTRY("Find_And_Allocate_Partition")
-
-  /* We must find the block of free space which contains the specified LBA. */
-
-  GoToStartOfList(DriveArray[DriveArrayIndex].Partitions,Error_Code);
+  Metadata_Sector *  Sector_Data;   /* The entry for Sector in the metadata table for the drive. */
 
-#ifdef DEBUG
+  FUNCTION_ENTRY("Remember_Metadata_Sector")
 
-#ifdef PARANOID
+  Sector_Data = Find_Metadata_Sector( DriveArrayIndex, Sector, TRUE );
+  if ( Sector_Data != NULL )
+  {
 
-  assert( *Error_Code == DLIST_SUCCESS );
+    memcpy(Sector_Data->On_Disk, Buffer, BYTES_PER_SECTOR);
+    Sector_Data->Contents_Known = TRUE;
 
-#else
+  }
 
-  if ( *Error_Code != DLIST_SUCCESS )
-  {
+  FUNCTION_EXIT("Remember_Metadata_Sector")
 
-    /* This should never happen!  We have an internal error. */
-    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+  return;
 
-    FUNCTION_EXIT("Find_And_Allocate_Partition")
+}
 
-    return NULL;
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Metadata_Sector_Unchanged                        */
+/*                                                                   */
+/*   Descriptive Name: Determines whether or not a metadata sector   */
+/*                     already has the contents given.               */
+/*                                                                   */
+/*   Input: CARDINAL32 DriveArrayIndex - The index in the DriveArray */
+/*                                       of the drive containing the */
+/*                                       sector.                     */
+/*          LBA Sector - The LBA of the sector.                      */
+/*          ADDRESS Buffer - The contents that the sector should     */
+/*                           have.                                   */
+/*                                                                   */
+/*   Output: TRUE if the sector is known to have the contents in     */
+/*           Buffer on disk, FALSE otherwise.                        */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: A sector which has not been recorded with                */
+/*          Remember_Metadata_Sector, or which has since been        */
+/*          forgotten, is never unchanged.                           */
+/*                                                                   */
+/*********************************************************************/
+BOOLEAN Metadata_Sector_Unchanged( CARDINAL32 DriveArrayIndex, LBA Sector, ADDRESS Buffer )
+{
+
+  Metadata_Sector *  Sector_Data;   /* The entry for Sector in the metadata table for the drive. */
+
+  Sector_Data = Find_Metadata_Sector( DriveArrayIndex, Sector, FALSE );
+
+  return ( ( Sector_Data != NULL ) && Sector_Data->Contents_Known && ( memcmp(Sector_Data->On_Disk, Buffer, BYTES_PER_SECTOR) == 0 ) );
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Forget_Metadata_Sectors                          */
+/*                                                                   */
+/*   Descriptive Name: Marks any metadata sectors in a range of      */
+/*                     sectors as having unknown contents.           */
+/*                                                                   */
+/*   Input: CARDINAL32 DriveArrayIndex - The index in the DriveArray */
+/*                                       of the drive containing the */
+/*                                       sectors.                    */
+/*          LBA Starting_Sector - The first sector in the range.     */
+/*          CARDINAL32 Sector_Count - The number of sectors in the   */
+/*                                    range.                         */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: If DriveArrayIndex is not a valid index in the  */
+/*                   DriveArray, nothing is done.                    */
+/*                                                                   */
+/*   Side Effects: Any metadata sectors in the range will be written */
+/*                 the next time they are committed.                 */
+/*                                                                   */
+/*   Notes: This must be used whenever sectors are written other than*/
+/*          through Commit_Partition_Changes or                      */
+/*          Remember_Metadata_Sector, as the metadata table for the  */
+/*          drive would otherwise be out of date.                    */
+/*                                                                   */
+/*********************************************************************/
+void Forget_Metadata_Sectors( CARDINAL32 DriveArrayIndex, LBA Starting_Sector, CARDINAL32 Sector_Count )
+{
+
+  Metadata_Table *   Metadata;      /* The metadata table for the drive. */
+  CARDINAL32         Low;           /* Used for the binary search of the metadata table. */
+  CARDINAL32         High;          /* Used for the binary search of the metadata table. */
+  CARDINAL32         Middle;        /* Used for the binary search of the metadata table. */
+
+  if ( ( DriveArray == NULL ) || ( DriveArrayIndex >= DriveCount ) )
+    return;
+
+  Metadata = (Metadata_Table *) DriveArray[DriveArrayIndex].Metadata_Table;
+  if ( Metadata == NULL )
+    return;
+
+  /* Find the first sector in the table at or after Starting_Sector. */
+  Low = 0;
+  High = Metadata->Count;
+  while ( Low < High )
+  {
+
+    Middle = ( Low + High ) / 2;
+
+    if ( Metadata->Sectors[Middle]->Sector < Starting_Sector )
+      Low = Middle + 1;
+    else
+      High = Middle;
+
+  }
+
+  for ( ; ( Low < Metadata->Count ) && ( Metadata->Sectors[Low]->Sector - Starting_Sector < Sector_Count ); Low++ )
+    Metadata->Sectors[Low]->Contents_Known = FALSE;
+
+  return;
+
+}
+
+
+
+
+/*--------------------------------------------------
+ * Private functions available.
+ --------------------------------------------------*/
+
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:                                                  */
+/*                                                                   */
+/*   Descriptive Name:                                               */
+/*                                                                   */
+/*   Input:                                                          */
+/*                                                                   */
+/*   Output:                                                         */
+/*                                                                   */
+/*   Error Handling:                                                 */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static ADDRESS Find_And_Allocate_Partition( CARDINAL32         DriveArrayIndex, /* The index in the Drive Array to use. */
+                                            LBA                StartingSector,  /* The LBA at which the partition starts. */
+                                            CARDINAL32         Size,            /* The size of the partition in sectors. */
+                                            Partition_Types    Partition_Type,  /* The type of the partition - Partition, or MBR_EBR */
+                                            BOOLEAN            Primary_Partition,
+                                            Partition_Record * Partition_Table_Entry,
+                                            CARDINAL16         Partition_Table_Index,
+                                            DLA_Entry  *       DLA_Table_Entry,
+                                            BOOLEAN            Prior_Existing_Partition,
+                                            BOOLEAN            Migration_Needed,
+                                            CARDINAL32 *       Error_Code)
+{
+
+  Partition_Data *  Free_Space;
+
+  FUNCTION_ENTRY("Find_And_Allocate_Partition")
+
+  /* We must find the block of free space which contains the specified LBA. */
+
+  GoToStartOfList(DriveArray[DriveArrayIndex].Partitions,Error_Code);
+
+#ifdef DEBUG
+
+#ifdef PARANOID
+
+  assert( *Error_Code == DLIST_SUCCESS );
+
+#else
+
+  if ( *Error_Code != DLIST_SUCCESS )
+  {
+
+    /* This should never happen!  We have an internal error. */
+    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+    FUNCTION_EXIT("Find_And_Allocate_Partition")
+
+    return NULL;
 
   }
 
@@ -7510,6 +7955,9 @@ static void Coalesce_Free_Space( Partition_Data * Free_Space, CARDINAL32 * Error
   if ( PreviousRecord->Partition_Type == FreeSpace )
   {
 
+    /* PreviousRecord is going away, so take it out of the free space index for the drive. */
+    Remove_Free_Space_From_Index( PreviousRecord );
+
     /* Is the free space described by PreviousRecord contiguous with the free space described by Free_Space? */
     if ( ( PreviousRecord->Starting_Sector + PreviousRecord->Partition_Size ) == Free_Space->Starting_Sector )
     {
@@ -7638,6 +8086,9 @@ static void Coalesce_Free_Space( Partition_Data * Free_Space, CARDINAL32 * Error
   if ( ( *Error_Code == DLIST_SUCCESS ) && ( NextRecord->Partition_Type == FreeSpace ) )
   {
 
+    /* NextRecord is going away, so take it out of the free space index for the drive. */
+    Remove_Free_Space_From_Index( NextRecord );
+
     /* Is the free space described by NextRecord contiguous with the free space described by Free_Space? */
     if ( ( Free_Space->Starting_Sector + Free_Space->Partition_Size ) == NextRecord->Starting_Sector )
     {
@@ -7712,6 +8163,9 @@ static void Coalesce_Free_Space( Partition_Data * Free_Space, CARDINAL32 * Error
 
   }
 
+  /* Free_Space now describes all of the free space around it, so it can go into the free space index for the drive. */
+  Add_Free_Space_To_Index( Free_Space );
+
   /* All done.  Indicate success and return. */
   *Error_Code = LVM_ENGINE_NO_ERROR;
 
@@ -8070,10 +8524,12 @@ static ADDRESS Allocate_Partition_From_Free_Space( CARDINAL32         DriveArray
 
       }
 
-      /* Now lets correct Free_Space's starting point and size. */
+      /* Now lets correct Free_Space's starting point and size.  Its place in the free space index depends on both, so take it out of the index while they change. */
+      Remove_Free_Space_From_Index( Free_Space );
       Free_Space->Partition_Size -= Size;
       Free_Space->Usable_Size = Free_Space->Partition_Size;
       Free_Space->Starting_Sector = New_Partition->Starting_Sector + Size;
+      Add_Free_Space_To_Index( Free_Space );
 
       /* Now lets insert New_Partition into the Partitions List before Free_Space as this will maintain the ordering of the Partitions list.
          Free_Space is the current item in the list. */
@@ -8181,9 +8637,11 @@ static ADDRESS Allocate_Partition_From_Free_Space( CARDINAL32         DriveArray
         /* Initialize the new Partition_Data record. */
         *New_Partition = *Free_Space;
 
-        /* Adjust the size of Free_Space. */
+        /* Adjust the size of Free_Space.  Its place in the free space index depends on its size, so take it out of the index while it changes. */
+        Remove_Free_Space_From_Index( Free_Space );
         Free_Space->Partition_Size -= Size;
         Free_Space->Usable_Size = Free_Space->Partition_Size;
+        Add_Free_Space_To_Index( Free_Space );
 
         /* Now alter New_Partition so that it describes our partition instead of a block of free space. */
         New_Partition->Starting_Sector = Free_Space->Starting_Sector + Free_Space->Partition_Size;
@@ -8342,6 +8800,9 @@ static ADDRESS Allocate_Partition_From_Free_Space( CARDINAL32         DriveArray
         New_Partition->Partition_Size = StartingSector - New_Partition->Starting_Sector;
         New_Partition->Usable_Size = New_Partition->Partition_Size;
 
+        /* Free_Space will become the partition, so it no longer belongs in the free space index for the drive. */
+        Remove_Free_Space_From_Index( Free_Space );
+
         /* Adjust the size and starting position of Free_Space. */
         Free_Space->Partition_Size -= New_Partition->Partition_Size;
         Free_Space->Usable_Size = Free_Space->Partition_Size;
@@ -8418,6 +8879,9 @@ static ADDRESS Allocate_Partition_From_Free_Space( CARDINAL32         DriveArray
 
         }
 
+        /* New_Partition is the block of free space before the partition, so add it to the free space index for the drive. */
+        Add_Free_Space_To_Index( New_Partition );
+
         /* Make Free_Space the current item in the list again. */
         NextItem(DriveArray[DriveArrayIndex].Partitions,Error_Code);
 
@@ -8543,6 +9007,8 @@ static ADDRESS Allocate_Partition_From_Free_Space( CARDINAL32         DriveArray
 
         }
 
+        /* New_Partition is the block of free space after the partition, so add it to the free space index for the drive. */
+        Add_Free_Space_To_Index( New_Partition );
 
         /* Now lets finish turning Free_Space into a partition. */
         Free_Space->Partition_Type = Partition_Type;
@@ -8643,6 +9109,8 @@ static ADDRESS Allocate_Partition_From_Free_Space( CARDINAL32         DriveArray
 
     /* This is the easy case!  The block of free space is the same size as the new partition.  We just need to convert the Partition_Data for
        the block of free space into that required by the new partition.                                                                       */
+    Remove_Free_Space_From_Index( Free_Space );
+
     Free_Space->Partition_Type = Partition_Type;
     Free_Space->New_Partition = Prior_Existing_Partition ? FALSE : TRUE;
     Free_Space->Primary_Partition = Primary_Partition;
@@ -9391,6 +9859,9 @@ static void _System Write_Changes( ADDRESS Object, TAG ObjectTag, CARDINAL32 Obj
   /* Establish access to the Boot Manager Alias in the EBR. */
   AliasTableEntry *      BootManagerAlias = (AliasTableEntry *) ( (CARDINAL32) &EBR + ALIAS_TABLE_OFFSET);
 
+  /* Used to find the LVM Signature Sector of a partition in the metadata table for the drive. */
+  Metadata_Sector *     Signature_Sector;
+
   FUNCTION_ENTRY("Write_Changes")
 
   /* Assume that we will succeed. */
@@ -9440,25 +9911,6 @@ static void _System Write_Changes( ADDRESS Object, TAG ObjectTag, CARDINAL32 Obj
                         copy it to the EBR Partition Table entry 1 and then write the EBR to disk.                                         */
                      EBR.Partition_Table[1] = PartitionRecord->Partition_Table_Entry;
 
-                     LOG_EVENT2("Writing EBR to disk.","Drive Number", Index + 1,"Starting Sector",PartitionRecord->Starting_Sector)
-
-                     /* Now write the EBR to disk. */
-                     WriteSectors(Index + 1, PartitionRecord->Starting_Sector, 1, &EBR, Error );
-
-                     /* Did the write succeed? */
-                     if ( *Error != DISKIO_NO_ERROR )
-                     {
-
-                       /* Mark the I/O error in the drive array. */
-                       DriveArray[Index].IO_Error = TRUE;
-
-                       LOG_EVENT1("WriteSectors failed!","Error code", *Error)
-
-                     }
-
-                     /* Now zero out the partition table of the EBR. */
-                     memset( EBR.Partition_Table, 0, 4 * sizeof(Partition_Record) );
-
                      /* The DLA Table that corresponds to this EBR is in DLA_Sector.  Since an EBR Link Entry has no DLA Table entry,
                         we just need to calculate the CRC for this table and write this table to disk.  It is written to the last
                         sector of the track containing the EBR.                                                                         */
@@ -9468,21 +9920,14 @@ static void _System Write_Changes( ADDRESS Object, TAG ObjectTag, CARDINAL32 Obj
 
                      DLA_Table->DLA_CRC = CalculateCRC(INITIAL_CRC, &DLA_Sector, BYTES_PER_SECTOR);
 
-                     LOG_EVENT2("Writing the DLA Table for the EBR to disk.","Drive Number", Index + 1,"Starting Sector",PartitionRecord->Starting_Sector + DriveArray[Index].Geometry.Sectors - 1 )
-
-                     /* Write the DLA Table to disk. */
-                     WriteSectors(Index + 1, PartitionRecord->Starting_Sector + DriveArray[Index].Geometry.Sectors - 1,1,&DLA_Sector, Error);
-
-                     /* Did the write succeed? */
-                     if ( *Error != DISKIO_NO_ERROR )
-                     {
-
-                       /* Mark the I/O error in the drive array. */
-                       DriveArray[Index].IO_Error = TRUE;
+                     LOG_EVENT2("Queueing EBR and its DLA Table to be written to disk.","Drive Number", Index + 1,"Starting Sector",PartitionRecord->Starting_Sector)
 
-                       LOG_EVENT1("WriteSectors failed!", "Error code", *Error)
+                     /* Now queue the EBR and the DLA Table.  Commit_Partition_Changes writes them, if they have changed, along with the MBR. */
+                     Queue_Metadata_Write( Index, PartitionRecord->Starting_Sector, &EBR, FALSE );
+                     Queue_Metadata_Write( Index, PartitionRecord->Starting_Sector + DriveArray[Index].Geometry.Sectors - 1, &DLA_Sector, TRUE );
 
-                     }
+                     /* Now zero out the partition table of the EBR. */
+                     memset( EBR.Partition_Table, 0, 4 * sizeof(Partition_Record) );
 
                      /* Now zero out the table entries in the DLA table. */
                      memset( &(DLA_Table->DLA_Array), 0, 4 * sizeof( DLA_Entry ) );
@@ -9493,6 +9938,11 @@ static void _System Write_Changes( ADDRESS Object, TAG ObjectTag, CARDINAL32 Obj
 
     case Partition : /* We have a partition. */
 
+                     /* If this partition has an LVM Signature Sector, it is still in use. */
+                     Signature_Sector = Find_Metadata_Sector( Index, PartitionRecord->Starting_Sector + PartitionRecord->Partition_Size - 1, FALSE );
+                     if ( Signature_Sector != NULL )
+                       Signature_Sector->In_Use = TRUE;
+
                      /* Is this a primary partition? */
                      if ( PartitionRecord->Primary_Partition )
                      {
@@ -10769,81 +11219,41 @@ void _System Update_Partitions_Volume_Data(ADDRESS Object, TAG ObjectTag, CARDIN
 
 /*********************************************************************/
 /*                                                                   */
-/*   Function Name:                                                  */
+/*   Function Name: Partition_Serial_Number_Key                      */
 /*                                                                   */
-/*   Descriptive Name:                                               */
+/*   Descriptive Name: Used by the index of the Partitions list of   */
+/*                     each drive to get the key of a Partition_Data */
+/*                     record.                                       */
 /*                                                                   */
-/*   Input:                                                          */
+/*   Input: ADDRESS Object - The Partition_Data record.              */
+/*          TAG ObjectTag - The tag of the record.                   */
+/*          CARDINAL32 ObjectSize - The size of the record.          */
+/*          ADDRESS * Key - Set to the address of the key.           */
+/*          CARDINAL32 * KeySize - Set to the size of the key.       */
 /*                                                                   */
-/*   Output:                                                         */
+/*   Output: TRUE if the record is for a partition, in which case    */
+/*           its key is its partition serial number.  FALSE for free */
+/*           space and MBR/EBR records, which are not indexed.       */
 /*                                                                   */
-/*   Error Handling:                                                 */
+/*   Error Handling: Records of the wrong type are not indexed.      */
 /*                                                                   */
 /*   Side Effects:  None.                                            */
 /*                                                                   */
-/*   Notes:  None.                                                   */
+/*   Notes:  This matches the records Get_Partition_Handle looks for.*/
 /*                                                                   */
 /*********************************************************************/
-void _System Find_Partition(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error)
+static BOOLEAN _System Partition_Serial_Number_Key(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS * Key, CARDINAL32 * KeySize)
 {
 
-  /* Declare a local variable so that we can access our parameters without having to typecast each time. */
-  Partition_Search_Record * Search_Record = ( Partition_Search_Record * ) Parameters;
-
-  /* Declare a local variable so that we can access the Partition_Data without having to typecast each time. */
   Partition_Data *  PartitionRecord = (Partition_Data *) Object;
 
+  if ( ( ObjectTag != PARTITION_DATA_TAG ) || ( ObjectSize != sizeof(Partition_Data) ) || ( PartitionRecord->Partition_Type != Partition ) )
+    return FALSE;
 
-  FUNCTION_ENTRY("Find_Partition")
-
-  /* Is Object what we think it should be? */
-  if ( ( ObjectTag != PARTITION_DATA_TAG ) || ( ObjectSize != sizeof(Partition_Data) ) )
-  {
-
-#ifdef DEBUG
-
-#ifdef PARANOID
-
-    assert(0);
-
-#endif
-
-#endif
-
-    /* Object's TAG is not what we expected!  Abort! */
-    *Error = LVM_ENGINE_INTERNAL_ERROR;
-
-    FUNCTION_EXIT("Find_Partition")
-
-    return;
-
-}
-
-  /* Well, Object has the correct TAG so we will assume that it points to an item of type Partition_Data. */
-
-  /* Assume success. */
-  *Error = DLIST_SUCCESS;
-
-  /* Does this partition record represent a partition? */
-  if ( PartitionRecord->Partition_Type == Partition )
-  {
-
-    /* Does the serial number of this partition match the one we are looking for? */
-    if ( PartitionRecord->DLA_Table_Entry.Partition_Serial_Number == Search_Record->Serial_Number )
-    {
-
-      Search_Record->Handle = PartitionRecord->External_Handle;
-
-      /* Indicate that we found what we were looking for. */
-      *Error = DLIST_SEARCH_COMPLETE;
-
-    }
-
-  }
-
-  FUNCTION_EXIT("Find_Partition")
+  *Key = &(PartitionRecord->DLA_Table_Entry.Partition_Serial_Number);
+  *KeySize = sizeof(DoubleWord);
 
-  return;
+  return TRUE;
 
 }
 
@@ -11244,3 +11654,2180 @@ void _System Update_Partitions_Parent_Data(ADDRESS Object, TAG ObjectTag, CARDIN
 
 }
 
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Queue_Partition_Table_Read                       */
+/*                                                                   */
+/*   Descriptive Name: Starts the read of the track containing an    */
+/*                     MBR/EBR and its DLA Table and adds it to the  */
+/*                     chain for a drive.                            */
+/*                                                                   */
+/*   Input: CARDINAL32 DriveArrayIndex - The index in the DriveArray */
+/*                                       of the drive to read from.  */
+/*          LBA MBR_EBR_LBA - The LBA of the MBR/EBR to read.        */
+/*          Partition_Table_Sectors * Previous - The last entry in   */
+/*                                  the chain for this drive, or NULL*/
+/*                                  if the chain is empty.           */
+/*                                                                   */
+/*   Output: TRUE if the read was started, FALSE otherwise.          */
+/*                                                                   */
+/*   Error Handling: If the read could not be started, the MBR/EBR   */
+/*                   and its DLA Table are left for                  */
+/*                   Get_Partition_Table_Sector to read itself.      */
+/*                                                                   */
+/*   Side Effects:  Memory is allocated for the new chain entry.     */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static BOOLEAN Queue_Partition_Table_Read( CARDINAL32 DriveArrayIndex, LBA MBR_EBR_LBA, Partition_Table_Sectors * Previous )
+{
+
+  Partition_Table_Sectors *  New_Entry;                                                 /* The chain entry for the MBR/EBR being read. */
+  CARDINAL32                 Track_Size = DriveArray[DriveArrayIndex].Geometry.Sectors;  /* The number of sectors in a track. */
+  CARDINAL32                 Error;                                                     /* Used to hold the error return code from SubmitSectorIO. */
+
+  FUNCTION_ENTRY("Queue_Partition_Table_Read")
+
+  if ( Track_Size == 0 )
+  {
+
+    FUNCTION_EXIT("Queue_Partition_Table_Read")
+
+    return FALSE;
+
+  }
+
+  New_Entry = (Partition_Table_Sectors *) malloc( sizeof(Partition_Table_Sectors) + Track_Size * BYTES_PER_SECTOR );
+
+  if ( New_Entry == NULL )
+  {
+
+    FUNCTION_EXIT("Queue_Partition_Table_Read")
+
+    return FALSE;
+
+  }
+
+  memset(New_Entry, 0, sizeof(Partition_Table_Sectors) );
+  New_Entry->MBR_EBR_LBA = MBR_EBR_LBA;
+  New_Entry->Track = (BYTE *) ( New_Entry + 1 );
+
+  /* Add the new entry to the end of the chain for this drive. */
+  if ( Previous == NULL )
+    Partition_Tables_Read[DriveArrayIndex] = New_Entry;
+  else
+    Previous->Next = New_Entry;
+
+  /* Read the whole track.  The MBR/EBR is its first sector and the DLA Table is its last. */
+  New_Entry->Track_Request.Drive_Number = DriveArrayIndex + 1;   /* OS/2's drive numbers are 1 based whereas our DriveArray is 0 based.  Add 1 to translate. */
+  New_Entry->Track_Request.Starting_Sector = MBR_EBR_LBA;
+  New_Entry->Track_Request.Sector_Count = Track_Size;
+  New_Entry->Track_Request.Buffer = New_Entry->Track;
+  New_Entry->Track_Request.User_Data = New_Entry;
+  New_Entry->Track_Request.Write = FALSE;
+
+  SubmitSectorIO( &(New_Entry->Track_Request), &Error);
+
+  /* A request which SubmitSectorIO rejected will never be returned by ReapSectorIO. */
+  New_Entry->In_Flight = ( Error == DISKIO_NO_ERROR );
+
+  FUNCTION_EXIT("Queue_Partition_Table_Read")
+
+  return New_Entry->In_Flight;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Find_Partition_Table_Read                        */
+/*                                                                   */
+/*   Descriptive Name: Finds the chain entry which a request returned*/
+/*                     by ReapSectorIO belongs to.                   */
+/*                                                                   */
+/*   Input: Sector_IO_Request * Request - The request returned by    */
+/*                                        ReapSectorIO.              */
+/*                                                                   */
+/*   Output: The chain entry whose Track_Request is Request, if that */
+/*           read is still outstanding.  NULL otherwise.             */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  ReapSectorIO returns completed requests from every      */
+/*           caller, so Request->User_Data can not be trusted until  */
+/*           the request is known to be one of ours.                 */
+/*                                                                   */
+/*********************************************************************/
+static Partition_Table_Sectors * Find_Partition_Table_Read( Sector_IO_Request * Request )
+{
+
+  Partition_Table_Sectors *  Current;   /* Used to walk the chain for the drive. */
+
+  FUNCTION_ENTRY("Find_Partition_Table_Read")
+
+  if ( ( Request->Drive_Number == 0 ) || ( Request->Drive_Number > DriveCount ) )
+  {
+
+    FUNCTION_EXIT("Find_Partition_Table_Read")
+
+    return NULL;
+
+  }
+
+  for ( Current = Partition_Tables_Read[Request->Drive_Number - 1]; Current != NULL; Current = Current->Next )
+  {
+
+    if ( ( &(Current->Track_Request) == Request ) && Current->In_Flight )
+      break;
+
+  }
+
+  FUNCTION_EXIT("Find_Partition_Table_Read")
+
+  return Current;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Read_Partition_Tables                            */
+/*                                                                   */
+/*   Descriptive Name: Reads the MBR/EBR chain and DLA Tables of     */
+/*                     every drive in the DriveArray, with the reads */
+/*                     for different drives in progress at the same  */
+/*                     time.                                         */
+/*                                                                   */
+/*   Input: None.                                                    */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: This function does not fail.  Sectors which it  */
+/*                   does not read, for whatever reason, are read by */
+/*                   Get_Partition_Table_Sector when they are needed.*/
+/*                   This includes the MBR/EBR and DLA Table of any  */
+/*                   track which could not be read.                  */
+/*                                                                   */
+/*   Side Effects:  Partition_Tables_Read is filled in.              */
+/*                                                                   */
+/*   Notes:  Only the signature and the EBR entries of each MBR/EBR  */
+/*           are examined here, just enough to find the next EBR in  */
+/*           the chain.  All validation is left to                   */
+/*           Discover_Partitions.  Since each drive has at most one  */
+/*           track being read at any time, the number of reads       */
+/*           outstanding is never more than the number of drives.    */
+/*           Every read which was started is reaped before this      */
+/*           function returns, so no track buffer is still in use    */
+/*           when Free_Partition_Tables releases it.                 */
+/*                                                                   */
+/*********************************************************************/
+static void Read_Partition_Tables( void )
+{
+
+  Partition_Table_Sectors *  Current;                   /* The chain entry whose read has just completed. */
+  Master_Boot_Record *       Table;                     /* Used to examine the MBR/EBR just read. */
+  Sector_IO_Request *        Request;                   /* The request returned by ReapSectorIO. */
+  LBA *                      Extended_Partition_LBA;    /* The start of the extended partition on each drive, once known. */
+  LBA                        Next_EBR_LBA;              /* The LBA of the next EBR in the chain. */
+  CARDINAL32                 Index;                     /* Used to walk the DriveArray. */
+  CARDINAL32                 Partition_Index;           /* Used to walk partition tables. */
+  CARDINAL32                 Outstanding = 0;           /* The number of reads which have been submitted but not reaped. */
+  CARDINAL32                 Error;                     /* Used to hold the error return code from ReapSectorIO. */
+
+  FUNCTION_ENTRY("Read_Partition_Tables")
+
+  /* Throw away anything left over from a previous discovery. */
+  Free_Partition_Tables();
+
+  Partition_Tables_Read = (Partition_Table_Sectors **) malloc( DriveCount * sizeof(Partition_Table_Sectors *) );
+  Extended_Partition_LBA = (LBA *) malloc( DriveCount * sizeof(LBA) );
+
+  if ( ( Partition_Tables_Read == NULL ) || ( Extended_Partition_LBA == NULL ) )
+  {
+
+    /* Discover_Partitions will just read everything itself. */
+    free(Partition_Tables_Read);
+    free(Extended_Partition_LBA);
+    Partition_Tables_Read = NULL;
+
+    FUNCTION_EXIT("Read_Partition_Tables")
+
+    return;
+
+  }
+
+  /* Start with the MBR of every drive. */
+  for ( Index = 0; Index < DriveCount; Index++ )
+  {
+
+    Partition_Tables_Read[Index] = NULL;
+    Extended_Partition_LBA[Index] = 0;
+
+    if ( Queue_Partition_Table_Read(Index, 0, NULL) )
+      Outstanding++;
+
+  }
+
+  /* As each MBR/EBR arrives, find the next EBR in its chain and start reading it. */
+  while ( Outstanding > 0 )
+  {
+
+    Request = ReapSectorIO(TRUE, &Error);
+
+    if ( Request == NULL )
+    {
+
+      /* ReapSectorIO only comes back empty handed while waiting if it has nothing in progress for anyone, in which case none of
+         our reads can still be using their track buffers.  Anything else is a transient failure, so keep waiting for our reads. */
+      if ( ( Error == DISKIO_NO_IO_OUTSTANDING ) || ( Error == DISKIO_DRIVES_NOT_OPEN ) )
+      {
+
+        if ( Logging_Enabled )
+        {
+
+          sprintf(Log_Buffer,"Read_Partition_Tables: %u reads were lost by ReapSectorIO (error %u).", Outstanding, Error);
+          Write_Log_Buffer();
+
+        }
+
+        break;
+
+      }
+
+      continue;
+
+    }
+
+    /* Only use requests that we submitted.  Anything else belongs to someone else and its User_Data means nothing to us. */
+    Current = Find_Partition_Table_Read(Request);
+
+    if ( Current == NULL )
+    {
+
+      if ( Logging_Enabled )
+      {
+
+        sprintf(Log_Buffer,"Read_Partition_Tables: Ignoring a request for drive %u, sector %u which was not submitted here.", Request->Drive_Number, Request->Starting_Sector);
+        Write_Log_Buffer();
+
+      }
+
+      continue;
+
+    }
+
+    Current->In_Flight = FALSE;
+    Outstanding--;
+
+    /* If the track could not be read, Get_Partition_Table_Sector will read the MBR/EBR and DLA Table separately so that a bad DLA
+       Table does not cost us the MBR/EBR.  We can't follow the chain any further from here though.                               */
+    if ( Request->Error != DISKIO_NO_ERROR )
+      continue;
+
+    Current->Track_Read = TRUE;
+
+    Table = (Master_Boot_Record *) Current->Track;
+
+    /* If this is not an MBR/EBR, then this is the end of the chain. */
+    if ( Table->Signature != MBR_EBR_SIGNATURE )
+      continue;
+
+    Index = Request->Drive_Number - 1;
+    Next_EBR_LBA = 0;
+
+    for ( Partition_Index = 0; Partition_Index < 4; Partition_Index++ )
+    {
+
+      if ( ( Table->Partition_Table[Partition_Index].Format_Indicator == EBR_INDICATOR ) ||
+           ( Table->Partition_Table[Partition_Index].Format_Indicator == WINDOZE_EBR_INDICATOR )
+         )
+      {
+
+        /* The first EBR is relative to the start of the drive.  All others are relative to the start of the extended partition. */
+        if ( Current->MBR_EBR_LBA == 0 )
+        {
+
+          Extended_Partition_LBA[Index] = Table->Partition_Table[Partition_Index].Sector_Offset;
+          Next_EBR_LBA = Extended_Partition_LBA[Index];
+
+        }
+        else
+          Next_EBR_LBA = Extended_Partition_LBA[Index] + Table->Partition_Table[Partition_Index].Sector_Offset;
+
+        break;
+
+      }
+
+    }
+
+    /* Start reading the next EBR right away, while Discover_Partitions has yet to look at this one.  An EBR chain always moves
+       towards the end of the drive.  Anything else is corrupt, and is left for Discover_Partitions to deal with.                   */
+    if ( ( Next_EBR_LBA > Current->MBR_EBR_LBA ) && Queue_Partition_Table_Read(Index, Next_EBR_LBA, Current) )
+      Outstanding++;
+
+  }
+
+  free(Extended_Partition_LBA);
+
+  FUNCTION_EXIT("Read_Partition_Tables")
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Get_Partition_Table_Sector                       */
+/*                                                                   */
+/*   Descriptive Name: Gets an MBR/EBR, or the DLA Table that goes   */
+/*                     with it, for Discover_Partitions.             */
+/*                                                                   */
+/*   Input: CARDINAL32 DriveArrayIndex - The index in the DriveArray */
+/*                                       of the drive to use.        */
+/*          LBA MBR_EBR_LBA - The LBA of the MBR/EBR.                */
+/*          BOOLEAN DLA_Table - If TRUE, the DLA Table is wanted.    */
+/*                              If FALSE, the MBR/EBR is wanted.     */
+/*          ADDRESS Buffer - Where to put the sector.                */
+/*          CARDINAL32 * Error_Code - The address of a CARDINAL32 in */
+/*                                    in which to store an error code*/
+/*                                    should an error occur.         */
+/*                                                                   */
+/*   Output: *Error_Code will be DISKIO_NO_ERROR if the sector was   */
+/*           placed in Buffer.  Otherwise it will hold the DISKIO    */
+/*           error code from the read.                               */
+/*                                                                   */
+/*   Error Handling: The errors reported are those ReadSectors would */
+/*                   have reported.                                  */
+/*                                                                   */
+/*   Side Effects:  The sector may be read from disk.  The sector is */
+/*                  recorded in the metadata table for the drive.    */
+/*                                                                   */
+/*   Notes:  Sectors read by Read_Partition_Tables are used if they  */
+/*           are available.                                          */
+/*                                                                   */
+/*********************************************************************/
+static void Get_Partition_Table_Sector( CARDINAL32 DriveArrayIndex, LBA MBR_EBR_LBA, BOOLEAN DLA_Table, ADDRESS Buffer, CARDINAL32 * Error_Code)
+{
+
+  Partition_Table_Sectors *  Current;   /* Used to walk the chain for the drive. */
+
+  FUNCTION_ENTRY("Get_Partition_Table_Sector")
+
+  if ( Partition_Tables_Read != NULL )
+  {
+
+    for ( Current = Partition_Tables_Read[DriveArrayIndex]; Current != NULL; Current = Current->Next )
+    {
+
+      if ( Current->MBR_EBR_LBA != MBR_EBR_LBA )
+        continue;
+
+      if ( Current->Track_Read )
+      {
+
+        /* The MBR/EBR is the first sector of the track, and the DLA Table is the last. */
+        if ( DLA_Table )
+          memcpy(Buffer, Current->Track + ( Current->Track_Request.Sector_Count - 1 ) * BYTES_PER_SECTOR, BYTES_PER_SECTOR);
+        else
+          memcpy(Buffer, Current->Track, BYTES_PER_SECTOR);
+
+        /* Remember what is on disk so that Commit_Partition_Changes does not rewrite the sector unless it changes. */
+        Remember_Metadata_Sector( DriveArrayIndex, ( DLA_Table ? MBR_EBR_LBA + Current->Track_Request.Sector_Count - 1 : MBR_EBR_LBA ), Buffer );
+
+        *Error_Code = DISKIO_NO_ERROR;
+
+        FUNCTION_EXIT("Get_Partition_Table_Sector")
+
+        return;
+
+      }
+
+      break;
+
+    }
+
+  }
+
+  /* We don't have the sector, so read it now. */
+  ReadSectors(DriveArrayIndex + 1,    /* OS/2's drive numbers are 1 based whereas our DriveArray is 0 based.  Add 1 to translate. */
+              ( DLA_Table ? MBR_EBR_LBA + DriveArray[DriveArrayIndex].Geometry.Sectors - 1 : MBR_EBR_LBA ),
+              1,
+              Buffer,
+              Error_Code);
+
+  if ( *Error_Code == DISKIO_NO_ERROR )
+    Remember_Metadata_Sector( DriveArrayIndex, ( DLA_Table ? MBR_EBR_LBA + DriveArray[DriveArrayIndex].Geometry.Sectors - 1 : MBR_EBR_LBA ), Buffer );
+
+  FUNCTION_EXIT("Get_Partition_Table_Sector")
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Free_Partition_Tables                            */
+/*                                                                   */
+/*   Descriptive Name: Frees the sectors read by                     */
+/*                     Read_Partition_Tables.                        */
+/*                                                                   */
+/*   Input: None.                                                    */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects:  Partition_Tables_Read is set to NULL.            */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static void Free_Partition_Tables( void )
+{
+
+  Partition_Table_Sectors *  Current;   /* Used to walk the chain for a drive. */
+  Partition_Table_Sectors *  Next;      /* The entry after Current. */
+  CARDINAL32                 Index;     /* Used to walk Partition_Tables_Read. */
+
+  FUNCTION_ENTRY("Free_Partition_Tables")
+
+  if ( Partition_Tables_Read != NULL )
+  {
+
+    for ( Index = 0; Index < DriveCount; Index++ )
+    {
+
+      for ( Current = Partition_Tables_Read[Index]; Current != NULL; Current = Next )
+      {
+
+        Next = Current->Next;
+        free(Current);
+
+      }
+
+    }
+
+    free(Partition_Tables_Read);
+    Partition_Tables_Read = NULL;
+
+  }
+
+  FUNCTION_EXIT("Free_Partition_Tables")
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Get_Free_Space_Index                             */
+/*                                                                   */
+/*   Descriptive Name: Returns the free space index for a drive,     */
+/*                     building it from the Partitions list for the  */
+/*                     drive if the drive does not have one yet.     */
+/*                                                                   */
+/*   Input: CARDINAL32 DriveArrayIndex - The index in the DriveArray */
+/*                                       of the drive.               */
+/*          CARDINAL32 * Error_Code - The address of a CARDINAL32 in */
+/*                                    which to store an error code   */
+/*                                    should an error occur.         */
+/*                                                                   */
+/*   Output: The function return value will be the free space index  */
+/*           for the drive, and *Error_Code will be                  */
+/*           LVM_ENGINE_NO_ERROR.  If the index could not be built,  */
+/*           then NULL will be returned and *Error_Code will be > 0. */
+/*                                                                   */
+/*   Error Handling: If there is not enough memory to build the      */
+/*                   index, then *Error_Code will be                 */
+/*                   LVM_ENGINE_OUT_OF_MEMORY.                       */
+/*                                                                   */
+/*   Side Effects: The free space index for the drive may be built.  */
+/*                                                                   */
+/*   Notes: The Partitions list is in order by starting sector, so   */
+/*          By_Start is filled in as the list is walked.  By_Size is */
+/*          sorted once all of the blocks of free space have been    */
+/*          found.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static Free_Space_Index * Get_Free_Space_Index( CARDINAL32 DriveArrayIndex, CARDINAL32 * Error_Code )
+{
+
+  Free_Space_Index *  Space_Index;       /* The free space index for the drive. */
+  Partition_Data *    PartitionRecord;   /* Used to examine the items in the Partitions list for the drive. */
+  ADDRESS             List_Handle;       /* Used to walk the Partitions list for the drive. */
+  CARDINAL32          Count = 0;         /* The number of blocks of free space on the drive. */
+  CARDINAL32          Slots;             /* The number of entries to allocate for each array in the index. */
+
+  FUNCTION_ENTRY("Get_Free_Space_Index")
+
+  /* If the drive already has an index, then it is up to date. */
+  Space_Index = (Free_Space_Index *) DriveArray[DriveArrayIndex].Free_Space_Index;
+  if ( Space_Index != NULL )
+  {
+
+    *Error_Code = LVM_ENGINE_NO_ERROR;
+
+    FUNCTION_EXIT("Get_Free_Space_Index")
+
+    return Space_Index;
+
+  }
+
+  /* Count the blocks of free space on the drive so that we know how large to make the index. */
+  DLIST_FOREACH( DriveArray[DriveArrayIndex].Partitions, List_Handle )
+  {
+
+    /* Is this item what we think it should be? */
+    if ( ( DLIST_HANDLE_TAG( List_Handle ) != PARTITION_DATA_TAG ) || ( DLIST_HANDLE_SIZE( List_Handle ) != sizeof(Partition_Data) ) )
+    {
+
+#ifdef DEBUG
+
+#ifdef PARANOID
+
+      assert(0);
+
+#endif
+
+#endif
+
+      *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+      FUNCTION_EXIT("Get_Free_Space_Index")
+
+      return NULL;
+
+    }
+
+    PartitionRecord = (Partition_Data *) DLIST_HANDLE_OBJECT( List_Handle );
+
+    if ( PartitionRecord->Partition_Type == FreeSpace )
+      Count++;
+
+  }
+
+  Slots = FREE_SPACE_INDEX_MINIMUM_SLOTS;
+  while ( Slots < Count )
+    Slots = Slots * 2;
+
+  /* Allocate the index. */
+  Space_Index = (Free_Space_Index *) malloc( sizeof(Free_Space_Index) );
+  if ( Space_Index == NULL )
+  {
+
+    *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    FUNCTION_EXIT("Get_Free_Space_Index")
+
+    return NULL;
+
+  }
+
+  Space_Index->Count = 0;
+  Space_Index->Slots = Slots;
+  Space_Index->By_Start = (Partition_Data **) malloc( Slots * sizeof(Partition_Data *) );
+  Space_Index->By_Size = (Partition_Data **) malloc( Slots * sizeof(Partition_Data *) );
+  Space_Index->Lowest_Start = (LBA *) malloc( Slots * sizeof(LBA) );
+  Space_Index->Highest_Start = (LBA *) malloc( Slots * sizeof(LBA) );
+
+  /* Did we get all of the memory we need? */
+  if ( ( Space_Index->By_Start == NULL ) ||
+       ( Space_Index->By_Size == NULL ) ||
+       ( Space_Index->Lowest_Start == NULL ) ||
+       ( Space_Index->Highest_Start == NULL )
+     )
+  {
+
+    free(Space_Index->By_Start);
+    free(Space_Index->By_Size);
+    free(Space_Index->Lowest_Start);
+    free(Space_Index->Highest_Start);
+    free(Space_Index);
+
+    *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    FUNCTION_EXIT("Get_Free_Space_Index")
+
+    return NULL;
+
+  }
+
+  /* Place each block of free space on the drive into the index. */
+  DLIST_FOREACH( DriveArray[DriveArrayIndex].Partitions, List_Handle )
+  {
+
+    PartitionRecord = (Partition_Data *) DLIST_HANDLE_OBJECT( List_Handle );
+
+    if ( PartitionRecord->Partition_Type == FreeSpace )
+    {
+
+      Space_Index->By_Start[Space_Index->Count] = PartitionRecord;
+      Space_Index->By_Size[Space_Index->Count] = PartitionRecord;
+      Space_Index->Count++;
+
+    }
+
+  }
+
+  if ( Space_Index->Count > 0 )
+  {
+
+    /* Put By_Size in order and calculate Lowest_Start and Highest_Start to match. */
+    qsort( Space_Index->By_Size, Space_Index->Count, sizeof(Partition_Data *), &Compare_Free_Space_Size );
+
+    Update_Start_Bounds( Space_Index, Space_Index->Count - 1 );
+
+  }
+
+  /* Attach the index to the drive. */
+  DriveArray[DriveArrayIndex].Free_Space_Index = (ADDRESS) Space_Index;
+
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  FUNCTION_EXIT("Get_Free_Space_Index")
+
+  return Space_Index;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Discard_Free_Space_Index                         */
+/*                                                                   */
+/*   Descriptive Name: Frees the free space index for a drive.       */
+/*                                                                   */
+/*   Input: CARDINAL32 DriveArrayIndex - The index in the DriveArray */
+/*                                       of the drive.               */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: The Free_Space_Index field of the DriveArray entry*/
+/*                 for the drive is set to NULL.                     */
+/*                                                                   */
+/*   Notes: The index will be rebuilt from the Partitions list for   */
+/*          the drive the next time that it is needed.               */
+/*                                                                   */
+/*********************************************************************/
+static void Discard_Free_Space_Index( CARDINAL32 DriveArrayIndex )
+{
+
+  Free_Space_Index *  Space_Index = (Free_Space_Index *) DriveArray[DriveArrayIndex].Free_Space_Index;
+
+  FUNCTION_ENTRY("Discard_Free_Space_Index")
+
+  if ( Space_Index != NULL )
+  {
+
+    free(Space_Index->By_Start);
+    free(Space_Index->By_Size);
+    free(Space_Index->Lowest_Start);
+    free(Space_Index->Highest_Start);
+    free(Space_Index);
+
+    DriveArray[DriveArrayIndex].Free_Space_Index = NULL;
+
+  }
+
+  FUNCTION_EXIT("Discard_Free_Space_Index")
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Add_Free_Space_To_Index                          */
+/*                                                                   */
+/*   Descriptive Name: Adds a block of free space to the free space  */
+/*                     index for the drive containing it.            */
+/*                                                                   */
+/*   Input: Partition_Data * Free_Space - The block of free space to */
+/*                                        add.                       */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: If the index must grow and there is not enough  */
+/*                   memory, then the index is discarded.            */
+/*                                                                   */
+/*   Side Effects: The free space index for the drive is updated.    */
+/*                                                                   */
+/*   Notes: If the drive does not have an index yet, then nothing is */
+/*          done, since Free_Space will be found when the index is   */
+/*          built.                                                   */
+/*                                                                   */
+/*          Free_Space must not already be in the index.             */
+/*                                                                   */
+/*          This is O(n) in the number of blocks of free space in    */
+/*          the index.  Finding where Free_Space goes is a binary    */
+/*          search, but the arrays must be shifted to make room for  */
+/*          it, and Update_Start_Bounds must recalculate every entry */
+/*          in Lowest_Start and Highest_Start before it in By_Size.  */
+/*                                                                   */
+/*********************************************************************/
+static void Add_Free_Space_To_Index( Partition_Data * Free_Space )
+{
+
+  Free_Space_Index *  Space_Index = (Free_Space_Index *) DriveArray[Free_Space->Drive_Index].Free_Space_Index;
+  Partition_Data **   New_By_Start;       /* Used when growing By_Start. */
+  Partition_Data **   New_By_Size;        /* Used when growing By_Size. */
+  LBA *               New_Lowest_Start;   /* Used when growing Lowest_Start. */
+  LBA *               New_Highest_Start;  /* Used when growing Highest_Start. */
+  CARDINAL32          Slots;              /* The new number of entries for each array in the index. */
+  CARDINAL32          Position;           /* The position of Free_Space in an array in the index. */
+
+  FUNCTION_ENTRY("Add_Free_Space_To_Index")
+
+  if ( Space_Index == NULL )
+  {
+
+    FUNCTION_EXIT("Add_Free_Space_To_Index")
+
+    return;
+
+  }
+
+  /* Is there room for another block of free space in the index? */
+  if ( Space_Index->Count == Space_Index->Slots )
+  {
+
+    Slots = Space_Index->Slots * 2;
+
+    New_By_Start = (Partition_Data **) realloc( Space_Index->By_Start, Slots * sizeof(Partition_Data *) );
+    if ( New_By_Start != NULL )
+      Space_Index->By_Start = New_By_Start;
+
+    New_By_Size = (Partition_Data **) realloc( Space_Index->By_Size, Slots * sizeof(Partition_Data *) );
+    if ( New_By_Size != NULL )
+      Space_Index->By_Size = New_By_Size;
+
+    New_Lowest_Start = (LBA *) realloc( Space_Index->Lowest_Start, Slots * sizeof(LBA) );
+    if ( New_Lowest_Start != NULL )
+      Space_Index->Lowest_Start = New_Lowest_Start;
+
+    New_Highest_Start = (LBA *) realloc( Space_Index->Highest_Start, Slots * sizeof(LBA) );
+    if ( New_Highest_Start != NULL )
+      Space_Index->Highest_Start = New_Highest_Start;
+
+    if ( ( New_By_Start == NULL ) || ( New_By_Size == NULL ) || ( New_Lowest_Start == NULL ) || ( New_Highest_Start == NULL ) )
+    {
+
+      /* An index which is missing a block of free space is worse than no index at all, so get rid of it.  It will be rebuilt
+         from the Partitions list for the drive when it is needed again.                                                       */
+      Discard_Free_Space_Index( Free_Space->Drive_Index );
+
+      FUNCTION_EXIT("Add_Free_Space_To_Index")
+
+      return;
+
+    }
+
+    Space_Index->Slots = Slots;
+
+  }
+
+  /* Insert Free_Space into By_Start. */
+  Position = Find_Free_Space_By_Start( Space_Index, Free_Space->Starting_Sector );
+  memmove( &(Space_Index->By_Start[Position + 1]), &(Space_Index->By_Start[Position]), ( Space_Index->Count - Position ) * sizeof(Partition_Data *) );
+  Space_Index->By_Start[Position] = Free_Space;
+
+  /* Insert Free_Space into By_Size.  The entries in Lowest_Start and Highest_Start after Free_Space are not affected by it, so
+     they just move along with their entries in By_Size.                                                                          */
+  Position = Find_Free_Space_By_Size( Space_Index, Free_Space->Partition_Size, Free_Space->Starting_Sector );
+  memmove( &(Space_Index->By_Size[Position + 1]), &(Space_Index->By_Size[Position]), ( Space_Index->Count - Position ) * sizeof(Partition_Data *) );
+  memmove( &(Space_Index->Lowest_Start[Position + 1]), &(Space_Index->Lowest_Start[Position]), ( Space_Index->Count - Position ) * sizeof(LBA) );
+  memmove( &(Space_Index->Highest_Start[Position + 1]), &(Space_Index->Highest_Start[Position]), ( Space_Index->Count - Position ) * sizeof(LBA) );
+  Space_Index->By_Size[Position] = Free_Space;
+
+  Space_Index->Count++;
+
+  Update_Start_Bounds( Space_Index, Position );
+
+  FUNCTION_EXIT("Add_Free_Space_To_Index")
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Remove_Free_Space_From_Index                     */
+/*                                                                   */
+/*   Descriptive Name: Removes a block of free space from the free   */
+/*                     space index for the drive containing it.      */
+/*                                                                   */
+/*   Input: Partition_Data * Free_Space - The block of free space to */
+/*                                        remove.                    */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: If Free_Space is not in the index, then nothing */
+/*                   is done.                                        */
+/*                                                                   */
+/*   Side Effects: The free space index for the drive is updated.    */
+/*                                                                   */
+/*   Notes: Free_Space is found using its starting sector and size,  */
+/*          so it must be removed from the index before either of    */
+/*          them is changed.                                         */
+/*                                                                   */
+/*          Like Add_Free_Space_To_Index, this is O(n) in the number */
+/*          of blocks of free space in the index.                    */
+/*                                                                   */
+/*********************************************************************/
+static void Remove_Free_Space_From_Index( Partition_Data * Free_Space )
+{
+
+  Free_Space_Index *  Space_Index = (Free_Space_Index *) DriveArray[Free_Space->Drive_Index].Free_Space_Index;
+  CARDINAL32          Position;           /* The position of Free_Space in an array in the index. */
+
+  FUNCTION_ENTRY("Remove_Free_Space_From_Index")
+
+  if ( Space_Index == NULL )
+  {
+
+    FUNCTION_EXIT("Remove_Free_Space_From_Index")
+
+    return;
+
+  }
+
+  /* Is Free_Space in the index? */
+  Position = Find_Free_Space_By_Start( Space_Index, Free_Space->Starting_Sector );
+  if ( ( Position == Space_Index->Count ) || ( Space_Index->By_Start[Position] != Free_Space ) )
+  {
+
+    FUNCTION_EXIT("Remove_Free_Space_From_Index")
+
+    return;
+
+  }
+
+  /* Remove Free_Space from By_Start. */
+  memmove( &(Space_Index->By_Start[Position]), &(Space_Index->By_Start[Position + 1]), ( Space_Index->Count - Position - 1 ) * sizeof(Partition_Data *) );
+
+  /* Remove Free_Space from By_Size. */
+  Position = Find_Free_Space_By_Size( Space_Index, Free_Space->Partition_Size, Free_Space->Starting_Sector );
+
+#ifdef DEBUG
+
+#ifdef PARANOID
+
+  assert( ( Position < Space_Index->Count ) && ( Space_Index->By_Size[Position] == Free_Space ) );
+
+#else
+
+  if ( ( Position == Space_Index->Count ) || ( Space_Index->By_Size[Position] != Free_Space ) )
+  {
+
+    /* By_Start and By_Size disagree!  Throw the index away so that it will be rebuilt from the Partitions list. */
+    Discard_Free_Space_Index( Free_Space->Drive_Index );
+
+    FUNCTION_EXIT("Remove_Free_Space_From_Index")
+
+    return;
+
+  }
+
+#endif
+
+#endif
+
+  memmove( &(Space_Index->By_Size[Position]), &(Space_Index->By_Size[Position + 1]), ( Space_Index->Count - Position - 1 ) * sizeof(Partition_Data *) );
+  memmove( &(Space_Index->Lowest_Start[Position]), &(Space_Index->Lowest_Start[Position + 1]), ( Space_Index->Count - Position - 1 ) * sizeof(LBA) );
+  memmove( &(Space_Index->Highest_Start[Position]), &(Space_Index->Highest_Start[Position + 1]), ( Space_Index->Count - Position - 1 ) * sizeof(LBA) );
+
+  Space_Index->Count--;
+
+  /* Only the entries in Lowest_Start and Highest_Start before Free_Space could have depended upon it. */
+  if ( Position > 0 )
+    Update_Start_Bounds( Space_Index, Position - 1 );
+
+  FUNCTION_EXIT("Remove_Free_Space_From_Index")
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Find_Free_Space_By_Start                         */
+/*                                                                   */
+/*   Descriptive Name: Finds the first block of free space in        */
+/*                     By_Start which does not start before a given  */
+/*                     sector.                                       */
+/*                                                                   */
+/*   Input: Free_Space_Index * Space_Index - The free space index to */
+/*                                           search.                 */
+/*          LBA Starting_Sector - The sector to search for.          */
+/*                                                                   */
+/*   Output: The position in By_Start of the first block of free     */
+/*           space which starts at or after Starting_Sector.  If     */
+/*           there is no such block of free space, then              */
+/*           Space_Index->Count is returned.                         */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: This is a binary search.                                 */
+/*                                                                   */
+/*********************************************************************/
+static CARDINAL32 Find_Free_Space_By_Start( Free_Space_Index * Space_Index, LBA Starting_Sector )
+{
+
+  CARDINAL32  Low = 0;
+  CARDINAL32  High = Space_Index->Count;
+  CARDINAL32  Middle;
+
+  while ( Low < High )
+  {
+
+    Middle = Low + ( High - Low ) / 2;
+
+    if ( Space_Index->By_Start[Middle]->Starting_Sector < Starting_Sector )
+      Low = Middle + 1;
+    else
+      High = Middle;
+
+  }
+
+  return Low;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Find_Free_Space_By_Size                          */
+/*                                                                   */
+/*   Descriptive Name: Finds the first block of free space in        */
+/*                     By_Size which is not smaller than a given     */
+/*                     size.                                         */
+/*                                                                   */
+/*   Input: Free_Space_Index * Space_Index - The free space index to */
+/*                                           search.                 */
+/*          CARDINAL32 Size - The size to search for.                */
+/*          LBA Starting_Sector - Among blocks of free space of the  */
+/*                                size given, the sector to search   */
+/*                                for.                               */
+/*                                                                   */
+/*   Output: The position in By_Size of the first block of free space*/
+/*           which is larger than Size, or which is Size sectors long*/
+/*           and starts at or after Starting_Sector.  If there is no */
+/*           such block of free space, then Space_Index->Count is    */
+/*           returned.                                               */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: This is a binary search.  A Starting_Sector of 0 finds   */
+/*          the first block of free space which is at least Size     */
+/*          sectors long.                                            */
+/*                                                                   */
+/*********************************************************************/
+static CARDINAL32 Find_Free_Space_By_Size( Free_Space_Index * Space_Index, CARDINAL32 Size, LBA Starting_Sector )
+{
+
+  CARDINAL32        Low = 0;
+  CARDINAL32        High = Space_Index->Count;
+  CARDINAL32        Middle;
+  Partition_Data *  Free_Space;
+
+  while ( Low < High )
+  {
+
+    Middle = Low + ( High - Low ) / 2;
+    Free_Space = Space_Index->By_Size[Middle];
+
+    if ( ( Free_Space->Partition_Size < Size ) ||
+         ( ( Free_Space->Partition_Size == Size ) && ( Free_Space->Starting_Sector < Starting_Sector ) )
+       )
+      Low = Middle + 1;
+    else
+      High = Middle;
+
+  }
+
+  return Low;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Update_Start_Bounds                              */
+/*                                                                   */
+/*   Descriptive Name: Recalculates the entries in Lowest_Start and  */
+/*                     Highest_Start from a given position back to   */
+/*                     the start of By_Size.                         */
+/*                                                                   */
+/*   Input: Free_Space_Index * Space_Index - The free space index to */
+/*                                           update.                 */
+/*          CARDINAL32 Position - The last position in By_Size whose */
+/*                                entries in Lowest_Start and        */
+/*                                Highest_Start must be recalculated.*/
+/*                                This must be less than             */
+/*                                Space_Index->Count.                */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: Lowest_Start and Highest_Start are updated.       */
+/*                                                                   */
+/*   Notes: The entries after Position must already be correct.      */
+/*                                                                   */
+/*          Every entry from Position back to 0 is recalculated, so  */
+/*          this is O(Position).                                     */
+/*                                                                   */
+/*********************************************************************/
+static void Update_Start_Bounds( Free_Space_Index * Space_Index, CARDINAL32 Position )
+{
+
+  LBA         Lowest;
+  LBA         Highest;
+
+  /* The entry for the last position in By_Size covers only that position. */
+  if ( Position == Space_Index->Count - 1 )
+  {
+
+    Lowest = Space_Index->By_Size[Position]->Starting_Sector;
+    Highest = Lowest;
+
+  }
+  else
+  {
+
+    Lowest = Space_Index->Lowest_Start[Position + 1];
+    Highest = Space_Index->Highest_Start[Position + 1];
+
+  }
+
+  /* Work back towards the start of By_Size. */
+  do
+  {
+
+    if ( Space_Index->By_Size[Position]->Starting_Sector < Lowest )
+      Lowest = Space_Index->By_Size[Position]->Starting_Sector;
+
+    if ( Space_Index->By_Size[Position]->Starting_Sector > Highest )
+      Highest = Space_Index->By_Size[Position]->Starting_Sector;
+
+    Space_Index->Lowest_Start[Position] = Lowest;
+    Space_Index->Highest_Start[Position] = Highest;
+
+  } while ( Position-- > 0 );
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Compare_Free_Space_Size                          */
+/*                                                                   */
+/*   Descriptive Name: qsort comparison function which orders blocks */
+/*                     of free space by size and then by starting    */
+/*                     sector.                                       */
+/*                                                                   */
+/*   Input: const void * First : The address of a Partition_Data *.  */
+/*          const void * Second : The address of a Partition_Data *. */
+/*                                                                   */
+/*   Output: < 0, 0 or > 0 as First comes before, with or after      */
+/*           Second in By_Size.                                      */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static int Compare_Free_Space_Size( const void * First, const void * Second )
+{
+
+  Partition_Data *  First_Free_Space = *(Partition_Data * const *) First;
+  Partition_Data *  Second_Free_Space = *(Partition_Data * const *) Second;
+
+  if ( First_Free_Space->Partition_Size != Second_Free_Space->Partition_Size )
+    return ( First_Free_Space->Partition_Size < Second_Free_Space->Partition_Size ) ? -1 : 1;
+
+  if ( First_Free_Space->Starting_Sector != Second_Free_Space->Starting_Sector )
+    return ( First_Free_Space->Starting_Sector < Second_Free_Space->Starting_Sector ) ? -1 : 1;
+
+  return 0;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Free_Space_Is_Acceptable                         */
+/*                                                                   */
+/*   Descriptive Name: Determines whether or not a block of free     */
+/*                     space can hold the partition being created.   */
+/*                                                                   */
+/*   Input: Partition_Data * Free_Space - The block of free space to */
+/*                                        check.                     */
+/*          Free_Space_Search_Record * Search - The requirements for */
+/*                                              the partition.       */
+/*                                                                   */
+/*   Output: TRUE if the partition can be created from Free_Space,   */
+/*           FALSE otherwise.                                        */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: The Free_Space_Available, Above_Cylinder_Limit and*/
+/*                 Wrong_Partition_Type fields of *Search are set    */
+/*                 according to the checks made.  The current item in*/
+/*                 the Partitions list for the drive may change.     */
+/*                                                                   */
+/*   Notes: A block of free space which is too small is not checked  */
+/*          against the 1024 cylinder limit, and one which is above  */
+/*          the 1024 cylinder limit is not checked for the partition */
+/*          type, so that Select_Free_Space can report the first     */
+/*          reason that an acceptable block of free space was not    */
+/*          found.                                                   */
+/*          If Search->Aligned is TRUE, then a block of free space is*/
+/*          too small unless it can hold the partition after its     */
+/*          start and size have been aligned by Align_Partition.     */
+/*                                                                   */
+/*********************************************************************/
+static BOOLEAN Free_Space_Is_Acceptable( Partition_Data * Free_Space, Free_Space_Search_Record * Search )
+{
+
+  CARDINAL32  Index = Free_Space->Drive_Index;   /* The index in the DriveArray of the drive containing Free_Space. */
+  CARDINAL32  Error;                             /* Used with Can_Be_Primary and Can_Be_Non_Primary. */
+  LBA         Aligned_Start = 0;                 /* The starting sector of an aligned partition in Free_Space. */
+  CARDINAL32  Aligned_Size = 0;                  /* The size of an aligned partition in Free_Space. */
+  CARDINAL32  Skipped_Sectors;                   /* Used with Align_Partition. */
+
+  /* Is this block of free space large enough to hold the partition? */
+  if ( Free_Space->Partition_Size < Search->Minimum_Size )
+    return FALSE;
+
+  /* An aligned partition also needs room for the sectors skipped to align it, and for its MBR or EBR. */
+  if ( Search->Aligned )
+  {
+
+    Aligned_Size = Align_Partition( Free_Space, Search->Size, Search->Primary_Partition, Search->Allocate_From_Start, &Aligned_Start, &Skipped_Sectors );
+    if ( Aligned_Size < Search->Size )
+      return FALSE;
+
+  }
+
+  Search->Free_Space_Available = TRUE;
+
+  /* If we are trying to make a bootable partition, then the block of free space must be able to hold the partition
+     below the 1024 cylinder limit, if the 1024 cylinder limit applies.                                              */
+  if ( Search->Bootable && DriveArray[Index].Cylinder_Limit_Applies )
+  {
+
+    /* If the partition is aligned, then we know exactly where it will end.  If the partition is allocated from the start of
+       the block of free space, then the partition must end below the 1024 cylinder limit.  Otherwise, the block of free
+       space must end below the 1024 cylinder limit.                                                                           */
+    if ( ( Search->Aligned && ( ( Aligned_Start + Aligned_Size ) > DriveArray[Index].Cylinder_Limit ) ) ||
+         ( ( ! Search->Aligned ) && Search->Allocate_From_Start && ( ( Free_Space->Starting_Sector + Search->Size ) > DriveArray[Index].Cylinder_Limit ) ) ||
+         ( ( ! Search->Aligned ) && ( ! Search->Allocate_From_Start ) && ( ( Free_Space->Starting_Sector + Free_Space->Partition_Size ) > DriveArray[Index].Cylinder_Limit ) )
+       )
+    {
+
+      Search->Above_Cylinder_Limit = TRUE;
+
+      return FALSE;
+
+    }
+
+  }
+
+  /* Can we create the desired type of partition from the block of free space? */
+  if ( Search->Primary_Partition )
+  {
+
+    if ( ! Can_Be_Primary( Free_Space, &Error ) )
+    {
+
+      Search->Wrong_Partition_Type = TRUE;
+
+      return FALSE;
+
+    }
+
+  }
+  else
+  {
+
+    if ( ! Can_Be_Non_Primary( Free_Space, &Error ) )
+    {
+
+      Search->Wrong_Partition_Type = TRUE;
+
+      return FALSE;
+
+    }
+
+  }
+
+  return TRUE;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Select_Free_Space                                */
+/*                                                                   */
+/*   Descriptive Name: Chooses the block of free space on a drive    */
+/*                     from which to create a partition.             */
+/*                                                                   */
+/*   Input: CARDINAL32 DriveArrayIndex - The index in the DriveArray */
+/*                                       of the drive.               */
+/*          CARDINAL32 Size - The size, in sectors, of the partition.*/
+/*          Allocation_Algorithm algorithm - The memory management   */
+/*                                           algorithm to use.       */
+/*          BOOLEAN Bootable - TRUE if the partition must lie below  */
+/*                             the 1024 cylinder limit.              */
+/*          BOOLEAN Primary_Partition - TRUE for a primary partition,*/
+/*                                      FALSE for a logical drive.   */
+/*          BOOLEAN Allocate_From_Start - TRUE if the partition will */
+/*                                        be allocated from the start*/
+/*                                        of the block of free space.*/
+/*          CARDINAL32 * Error_Code - The address of a CARDINAL32 in */
+/*                                    which to store an error code   */
+/*                                    should an error occur.         */
+/*                                                                   */
+/*   Output: The block of free space chosen, with *Error_Code set to */
+/*           LVM_ENGINE_NO_ERROR.  If there is no acceptable block of*/
+/*           free space, then NULL is returned and *Error_Code is    */
+/*           > 0.                                                    */
+/*                                                                   */
+/*   Error Handling: If there is no acceptable block of free space,  */
+/*                   then *Error_Code tells why.                     */
+/*                                                                   */
+/*   Side Effects: The free space index for the drive may be built.  */
+/*                 The current item in the Partitions list for the   */
+/*                 drive may change.                                 */
+/*                                                                   */
+/*   Notes: The blocks of free space which are too small to hold the */
+/*          partition are skipped with a binary search of By_Size.   */
+/*          For First_Fit and Last_Fit, Lowest_Start and             */
+/*          Highest_Start give the first and last blocks of free     */
+/*          space which are large enough, and the search continues   */
+/*          through By_Start from there only if that block of free   */
+/*          space is rejected.                                       */
+/*          Best_Fit and From_Smallest both choose the smallest block*/
+/*          of free space which is large enough, and From_Largest the*/
+/*          largest, with ties going to the block of free space with */
+/*          the lowest starting sector.                              */
+/*          Aligned searches By_Start the same way as First_Fit.     */
+/*                                                                   */
+/*          A selection is O(log n) in the number of blocks of free  */
+/*          space on the drive when the first block of free space    */
+/*          examined is acceptable.  When blocks of free space are   */
+/*          rejected because of the 1024 cylinder limit, the         */
+/*          partition type or alignment, the search steps through    */
+/*          By_Start one block of free space at a time, so the worst */
+/*          case is O(n).                                            */
+/*                                                                   */
+/*********************************************************************/
+static Partition_Data * Select_Free_Space( CARDINAL32 DriveArrayIndex, CARDINAL32 Size, Allocation_Algorithm algorithm, BOOLEAN Bootable, BOOLEAN Primary_Partition, BOOLEAN Allocate_From_Start, CARDINAL32 * Error_Code )
+{
+
+  Free_Space_Index *          Space_Index;                  /* The free space index for the drive. */
+  Free_Space_Search_Record    Search;                       /* The requirements for the partition, and the results of the search. */
+  Partition_Data *            Selected_Free_Space = NULL;   /* The block of free space chosen. */
+  CARDINAL32                  Position;                     /* Used to walk the arrays in the free space index. */
+  CARDINAL32                  Group_Start;                  /* Used by From_Largest to find blocks of free space of the same size. */
+  CARDINAL32                  Group_End;                    /* Used by From_Largest to find blocks of free space of the same size. */
+
+  FUNCTION_ENTRY("Select_Free_Space")
+
+  Space_Index = Get_Free_Space_Index( DriveArrayIndex, Error_Code );
+  if ( Space_Index == NULL )
+  {
+
+    FUNCTION_EXIT("Select_Free_Space")
+
+    return NULL;
+
+  }
+
+  Search.Size = Size;
+  Search.Minimum_Size = ( algorithm == All ) ? 0 : Size;
+  Search.Bootable = Bootable;
+  Search.Primary_Partition = Primary_Partition;
+  Search.Allocate_From_Start = Allocate_From_Start;
+  Search.Aligned = ( algorithm == Aligned );
+  Search.Free_Space_Available = FALSE;
+  Search.Above_Cylinder_Limit = FALSE;
+  Search.Wrong_Partition_Type = FALSE;
+
+  /* Skip the blocks of free space which are too small.  Those that remain are at the end of By_Size. */
+  Position = Find_Free_Space_By_Size( Space_Index, Search.Minimum_Size, 0 );
+
+  /* Which memory management algorithm are we using? */
+  switch ( algorithm )
+  {
+    case Automatic :
+    case First_Fit : /* Use the first block of free space to meet the requirements. */
+    case Aligned :   /* Use the first block of free space which can hold the partition once it is aligned. */
+    case All :       /* Use the first block of free space.  The caller decides if it is the only one. */
+                     if ( Position < Space_Index->Count )
+                     {
+
+                       Position = Find_Free_Space_By_Start( Space_Index, Space_Index->Lowest_Start[Position] );
+
+                       /* Since By_Start is in order, once a block of free space has been rejected due to the 1024 cylinder limit, all of
+                          the blocks of free space after it will be rejected too, so there is no need to look further.                     */
+                       while ( ( Selected_Free_Space == NULL ) && ( Position < Space_Index->Count ) && ( ! Search.Above_Cylinder_Limit ) )
+                       {
+
+                         if ( Free_Space_Is_Acceptable( Space_Index->By_Start[Position], &Search ) )
+                           Selected_Free_Space = Space_Index->By_Start[Position];
+
+                         Position++;
+
+                       }
+
+                     }
+
+                     break;
+
+    case Last_Fit : /* Use the last block of free space to meet the requirements. */
+                    if ( Position < Space_Index->Count )
+                    {
+
+                      Position = Find_Free_Space_By_Start( Space_Index, Space_Index->Highest_Start[Position] ) + 1;
+
+                      while ( ( Selected_Free_Space == NULL ) && ( Position > 0 ) )
+                      {
+
+                        Position--;
+
+                        if ( Free_Space_Is_Acceptable( Space_Index->By_Start[Position], &Search ) )
+                          Selected_Free_Space = Space_Index->By_Start[Position];
+
+                      }
+
+                    }
+
+                    break;
+
+    case Best_Fit :      /* Use the block of free space which is closest in size to the partition we are creating. */
+    case From_Smallest : /* Allocate this partition from the smallest block of free space on the disk. */
+                         while ( ( Selected_Free_Space == NULL ) && ( Position < Space_Index->Count ) )
+                         {
+
+                           if ( Free_Space_Is_Acceptable( Space_Index->By_Size[Position], &Search ) )
+                             Selected_Free_Space = Space_Index->By_Size[Position];
+
+                           Position++;
+
+                         }
+
+                         break;
+
+    case From_Largest : /* Allocate this partition from the largest block of free space on the disk. */
+                        Group_End = Space_Index->Count;
+                        while ( ( Selected_Free_Space == NULL ) && ( Group_End > Position ) )
+                        {
+
+                          /* The blocks of free space which are the same size as By_Size[Group_End - 1] are in order by starting sector. */
+                          Group_Start = Find_Free_Space_By_Size( Space_Index, Space_Index->By_Size[Group_End - 1]->Partition_Size, 0 );
+
+                          for ( Position = Group_Start; ( Selected_Free_Space == NULL ) && ( Position < Group_End ); Position++ )
+                          {
+
+                            if ( Free_Space_Is_Acceptable( Space_Index->By_Size[Position], &Search ) )
+                              Selected_Free_Space = Space_Index->By_Size[Position];
+
+                          }
+
+                          Group_End = Group_Start;
+
+                        }
+
+                        break;
+
+    default: /* Bad algorithm! */
+             *Error_Code = LVM_ENGINE_BAD_ALLOCATION_ALGORITHM;
+
+             FUNCTION_EXIT("Select_Free_Space")
+
+             return NULL;
+
+  }
+
+  /* Did we find an acceptable block of free space? */
+  if ( Selected_Free_Space == NULL )
+  {
+
+    /* Were there blocks of free space large enough to satisfy the request?  If so, then they must have been rejected
+       due to the 1024 cylinder limit or the type of partition requested.                                              */
+    if ( Search.Free_Space_Available )
+    {
+
+      /* Was there a block of free space available below the 1024 cylinder limit but which could not be turned into the proper partition type? */
+      if ( Search.Wrong_Partition_Type )
+      {
+
+        /* What type of partition were we trying to create? */
+        if ( Primary_Partition )
+          *Error_Code = LVM_ENGINE_CAN_NOT_MAKE_PRIMARY_PARTITION;
+        else
+          *Error_Code = LVM_ENGINE_CAN_NOT_MAKE_LOGICAL_DRIVE;
+
+      }
+      else
+        *Error_Code = LVM_ENGINE_1024_CYLINDER_LIMIT;
+
+    }
+    else
+      *Error_Code = LVM_ENGINE_NOT_ENOUGH_FREE_SPACE;
+
+    FUNCTION_EXIT("Select_Free_Space")
+
+    return NULL;
+
+  }
+
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  FUNCTION_EXIT("Select_Free_Space")
+
+  return Selected_Free_Space;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Select_Best_Fit_Drive                            */
+/*                                                                   */
+/*   Descriptive Name: Finds the drive with the block of free space  */
+/*                     which is closest in size to a partition.      */
+/*                                                                   */
+/*   Input: CARDINAL32 Size - The size, in sectors, of the partition.*/
+/*          BOOLEAN Bootable - TRUE if the partition must lie below  */
+/*                             the 1024 cylinder limit.              */
+/*          BOOLEAN Primary_Partition - TRUE for a primary partition,*/
+/*                                      FALSE for a logical drive.   */
+/*          BOOLEAN Allocate_From_Start - TRUE if the partition will */
+/*                                        be allocated from the start*/
+/*                                        of the block of free space.*/
+/*          CARDINAL32 * Error_Code - The address of a CARDINAL32 in */
+/*                                    which to store an error code   */
+/*                                    should an error occur.         */
+/*                                                                   */
+/*   Output: The external handle of the drive, with *Error_Code set  */
+/*           to LVM_ENGINE_NO_ERROR.  If no drive has an acceptable  */
+/*           block of free space, then NULL is returned and          */
+/*           *Error_Code is > 0.                                     */
+/*                                                                   */
+/*   Error Handling: If every drive was rejected, then *Error_Code   */
+/*                   will be the reason given for the last drive     */
+/*                   that had a block of free space large enough to  */
+/*                   hold the partition, or                          */
+/*                   LVM_ENGINE_NOT_ENOUGH_FREE_SPACE if there was no*/
+/*                   such drive.                                     */
+/*                                                                   */
+/*   Side Effects: The free space index for each drive may be built. */
+/*                                                                   */
+/*   Notes: Size is rounded for each drive just as Create_Partition  */
+/*          rounds it, so the block of free space chosen is the one  */
+/*          which will have the least free space left over.  Ties go */
+/*          to the drive with the lowest index in the DriveArray.    */
+/*          Drives which are corrupt or unusable are skipped.        */
+/*                                                                   */
+/*********************************************************************/
+static ADDRESS Select_Best_Fit_Drive( CARDINAL32 Size, BOOLEAN Bootable, BOOLEAN Primary_Partition, BOOLEAN Allocate_From_Start, CARDINAL32 * Error_Code )
+{
+
+  Partition_Data *  Candidate;                    /* The best fit block of free space on the drive being examined. */
+  Partition_Data *  Selected_Free_Space = NULL;   /* The best fit block of free space found so far. */
+  CARDINAL32        Rounded_Size;                 /* Size, rounded for the drive being examined. */
+  CARDINAL32        Selected_Size = 0;            /* Size, rounded for the drive containing Selected_Free_Space. */
+  CARDINAL32        Index;                        /* Used to walk the DriveArray. */
+  CARDINAL32        Drive_Error;                  /* The error code returned by Select_Free_Space for a drive. */
+  CARDINAL32        Search_Error = LVM_ENGINE_NOT_ENOUGH_FREE_SPACE;   /* The error to report if no drive is acceptable. */
+
+  FUNCTION_ENTRY("Select_Best_Fit_Drive")
+
+  for ( Index = 0; Index < DriveCount; Index++ )
+  {
+
+    /* Can partitions be created on this drive? */
+    if ( DriveArray[Index].Corrupt || DriveArray[Index].Unusable )
+      continue;
+
+    Rounded_Size = Round_Partition_Size( Index, Size, Primary_Partition );
+
+    Candidate = Select_Free_Space( Index, Rounded_Size, Best_Fit, Bootable, Primary_Partition, Allocate_From_Start, &Drive_Error );
+    if ( Candidate == NULL )
+    {
+
+      /* If we are out of memory, then there is no point in looking at the other drives. */
+      if ( Drive_Error == LVM_ENGINE_OUT_OF_MEMORY )
+      {
+
+        *Error_Code = Drive_Error;
+
+        FUNCTION_EXIT("Select_Best_Fit_Drive")
+
+        return NULL;
+
+      }
+
+      /* Remember why a drive with enough free space was rejected. */
+      if ( Drive_Error != LVM_ENGINE_NOT_ENOUGH_FREE_SPACE )
+        Search_Error = Drive_Error;
+
+    }
+    else
+    {
+
+      /* Is Candidate a better fit than the best block of free space found so far? */
+      if ( ( Selected_Free_Space == NULL ) ||
+           ( ( Candidate->Partition_Size - Rounded_Size ) < ( Selected_Free_Space->Partition_Size - Selected_Size ) )
+         )
+      {
+
+        Selected_Free_Space = Candidate;
+        Selected_Size = Rounded_Size;
+
+      }
+
+    }
+
+  }
+
+  if ( Selected_Free_Space == NULL )
+  {
+
+    *Error_Code = Search_Error;
+
+    FUNCTION_EXIT("Select_Best_Fit_Drive")
+
+    return NULL;
+
+  }
+
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  FUNCTION_EXIT("Select_Best_Fit_Drive")
+
+  return DriveArray[Selected_Free_Space->Drive_Index].External_Handle;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Round_Partition_Size                             */
+/*                                                                   */
+/*   Descriptive Name: Rounds the size of a new partition up to the  */
+/*                     size that will actually be allocated for it.  */
+/*                                                                   */
+/*   Input: CARDINAL32 DriveArrayIndex - The index in the DriveArray */
+/*                                       of the drive the partition  */
+/*                                       will be created on.         */
+/*          CARDINAL32 Size - The size, in sectors, requested for the*/
+/*                            partition.                             */
+/*          BOOLEAN Primary_Partition - TRUE for a primary partition,*/
+/*                                      FALSE for a logical drive.   */
+/*                                                                   */
+/*   Output: The size, in sectors, to allocate for the partition.    */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: None.                                                    */
+/*                                                                   */
+/*********************************************************************/
+static CARDINAL32 Round_Partition_Size( CARDINAL32 DriveArrayIndex, CARDINAL32 Size, BOOLEAN Primary_Partition )
+{
+
+  /* Adjust the requested size of the partition so that it is a multiple of Sectors_Per_Cylinder.
+     Always round up!                                                                               */
+  if ( Size % DriveArray[DriveArrayIndex].Sectors_Per_Cylinder )
+  {
+
+    /* Convert size from sectors to cylinders. */
+    Size = Size / DriveArray[DriveArrayIndex].Sectors_Per_Cylinder;
+
+    /* Round up. */
+    Size++;
+
+    /* Now turn size back into sectors. */
+    Size = Size * DriveArray[DriveArrayIndex].Sectors_Per_Cylinder;
+
+    /* If we are making a primary partition, we can be 1 track less than a multiple of Sectors_Per_Cylinder.
+       This will allow us to start a primary partition on the first track after the track containing the MBR.
+       Without this adjustment, we can get into situations where we have almost an entire cylinder that we
+       will never allow a partition to be created in.  As an example, if we have a drive where the drive contains
+       a single extended partition of maximum size, there will be almost a cylinder of free space at the beginning
+       of the drive.  This is because an extended partition must start on a cylinder boundary and, because of the
+       MBR, the extended partition can't start until cylinder 1 on the disk.  This leave almost all of cylinder 0
+       free for use.  A primary partition can start on a track boundary, so a primary partition can be placed
+       in cylinder 0.  Such a primary partition could be used for Boot Manager, for instance.  Either way, a
+       primary partition can be either a multiple of the cylinder size, or 1 track less than a multiple of the
+       cylinder size.                                                                                                   */
+    if ( Primary_Partition )
+      Size -= DriveArray[DriveArrayIndex].Geometry.Sectors;
+
+  }
+
+  return Size;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Align_Partition                                  */
+/*                                                                   */
+/*   Descriptive Name: Finds where a partition allocated with the    */
+/*                     Aligned allocation algorithm would start in a */
+/*                     block of free space, and how large it would   */
+/*                     be.                                           */
+/*                                                                   */
+/*   Input: Partition_Data * Free_Space - The block of free space to */
+/*                                        allocate the partition     */
+/*                                        from.                      */
+/*          CARDINAL32 Size - The size, in sectors, of the partition.*/
+/*          BOOLEAN Primary_Partition - TRUE for a primary partition,*/
+/*                                      FALSE for a logical drive.   */
+/*          BOOLEAN Allocate_From_Start - TRUE if the partition is to*/
+/*                                        be allocated from the start*/
+/*                                        of the block of free space.*/
+/*          LBA * Starting_Sector - The address of a variable to hold*/
+/*                                  the starting sector of the       */
+/*                                  partition.                       */
+/*          CARDINAL32 * Skipped_Sectors - The address of a variable */
+/*                                         to hold the number of     */
+/*                                         sectors skipped to align  */
+/*                                         the partition.            */
+/*                                                                   */
+/*   Output: The size of the partition, rounded up to a multiple of  */
+/*           Partition_Alignment, or reduced to the largest multiple */
+/*           of Partition_Alignment that will fit.  If no aligned    */
+/*           partition will fit, then 0 is returned.                 */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: The track containing the MBR, if Free_Space starts at    */
+/*          sector 0, and the track for the EBR of a logical drive   */
+/*          are placed before the first aligned sector that the      */
+/*          partition can start on.  The EBR of a logical drive is   */
+/*          placed in the track immediately before the partition, so */
+/*          the sectors skipped lie between the start of Free_Space  */
+/*          and the EBR.                                             */
+/*          For a logical drive, *Starting_Sector is the start of the*/
+/*          data area of the logical drive, not its EBR.             */
+/*                                                                   */
+/*********************************************************************/
+static CARDINAL32 Align_Partition( Partition_Data * Free_Space, CARDINAL32 Size, BOOLEAN Primary_Partition, BOOLEAN Allocate_From_Start, LBA * Starting_Sector, CARDINAL32 * Skipped_Sectors )
+{
+
+  LBA         Earliest_Start;   /* The first sector in Free_Space which the partition could start on. */
+  LBA         Block_End;        /* The first sector after Free_Space. */
+  LBA         Aligned_Start;    /* The first aligned sector in Free_Space which the partition could start on. */
+  LBA         Aligned_End;      /* The last aligned sector in Free_Space which the partition could end before. */
+  CARDINAL32  Track_Size = DriveArray[Free_Space->Drive_Index].Geometry.Sectors;
+
+  Earliest_Start = Free_Space->Starting_Sector;
+  Block_End = Free_Space->Starting_Sector + Free_Space->Partition_Size;
+
+  /* Leave room for the MBR. */
+  if ( Earliest_Start == 0 )
+    Earliest_Start += Track_Size;
+
+  /* Leave room for the EBR. */
+  if ( ! Primary_Partition )
+    Earliest_Start += Track_Size;
+
+  Aligned_Start = ( ( Earliest_Start + Partition_Alignment - 1 ) / Partition_Alignment ) * Partition_Alignment;
+  Aligned_End = ( Block_End / Partition_Alignment ) * Partition_Alignment;
+
+  if ( Aligned_Start >= Aligned_End )
+    return 0;
+
+  /* Round the size of the partition up to a multiple of Partition_Alignment, but do not go beyond the aligned portion of Free_Space. */
+  Size = ( ( Size + Partition_Alignment - 1 ) / Partition_Alignment ) * Partition_Alignment;
+  if ( Size > Aligned_End - Aligned_Start )
+    Size = Aligned_End - Aligned_Start;
+
+  if ( Allocate_From_Start )
+  {
+
+    *Starting_Sector = Aligned_Start;
+    *Skipped_Sectors = Aligned_Start - Earliest_Start;
+
+  }
+  else
+  {
+
+    *Starting_Sector = Aligned_End - Size;
+    *Skipped_Sectors = Block_End - Aligned_End;
+
+  }
+
+  return Size;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Find_Metadata_Sector                             */
+/*                                                                   */
+/*   Descriptive Name: Finds the entry for a sector in the metadata  */
+/*                     table for a drive, adding one if requested.   */
+/*                                                                   */
+/*   Input: CARDINAL32 DriveArrayIndex - The index in the DriveArray */
+/*                                       of the drive.               */
+/*          LBA Sector - The LBA of the sector to find.              */
+/*          BOOLEAN Add - If TRUE, an entry will be added for Sector */
+/*                        if there is none.                          */
+/*                                                                   */
+/*   Output: The entry for Sector, or NULL if there is none.  An     */
+/*           entry which has just been added has Contents_Known set  */
+/*           to FALSE.                                               */
+/*                                                                   */
+/*   Error Handling: If there is not enough memory to add an entry,  */
+/*                   then NULL is returned.                          */
+/*                                                                   */
+/*   Side Effects: The metadata table for the drive may be created or*/
+/*                 grown.                                            */
+/*                                                                   */
+/*   Notes: The entries are kept in order by LBA, so a binary search */
+/*          is used to find Sector, and a new entry is inserted where*/
+/*          the search ended.                                        */
+/*                                                                   */
+/*********************************************************************/
+static Metadata_Sector * Find_Metadata_Sector( CARDINAL32 DriveArrayIndex, LBA Sector, BOOLEAN Add )
+{
+
+  Metadata_Table *     Metadata;      /* The metadata table for the drive. */
+  Metadata_Sector *    New_Entry;     /* The entry added for Sector. */
+  Metadata_Sector **   New_Sectors;   /* Used to grow the metadata table. */
+  CARDINAL32           Low;           /* Used for the binary search of the metadata table. */
+  CARDINAL32           High;          /* Used for the binary search of the metadata table. */
+  CARDINAL32           Middle;        /* Used for the binary search of the metadata table. */
+
+  Metadata = (Metadata_Table *) DriveArray[DriveArrayIndex].Metadata_Table;
+
+  if ( Metadata == NULL )
+  {
+
+    if ( ! Add )
+      return NULL;
+
+    Metadata = (Metadata_Table *) malloc( sizeof(Metadata_Table) );
+    if ( Metadata == NULL )
+      return NULL;
+
+    Metadata->Count = 0;
+    Metadata->Slots = 0;
+    Metadata->Sectors = NULL;
+
+    DriveArray[DriveArrayIndex].Metadata_Table = Metadata;
+
+  }
+
+  Low = 0;
+  High = Metadata->Count;
+  while ( Low < High )
+  {
+
+    Middle = ( Low + High ) / 2;
+
+    if ( Metadata->Sectors[Middle]->Sector < Sector )
+      Low = Middle + 1;
+    else
+      High = Middle;
+
+  }
+
+  if ( ( Low < Metadata->Count ) && ( Metadata->Sectors[Low]->Sector == Sector ) )
+    return Metadata->Sectors[Low];
+
+  if ( ! Add )
+    return NULL;
+
+  /* Make room for the new entry if there is none. */
+  if ( Metadata->Count == Metadata->Slots )
+  {
+
+    New_Sectors = (Metadata_Sector **) realloc( Metadata->Sectors, ( Metadata->Slots + METADATA_TABLE_MINIMUM_SLOTS ) * sizeof(Metadata_Sector *) );
+    if ( New_Sectors == NULL )
+      return NULL;
+
+    Metadata->Sectors = New_Sectors;
+    Metadata->Slots += METADATA_TABLE_MINIMUM_SLOTS;
+
+  }
+
+  New_Entry = (Metadata_Sector *) malloc( sizeof(Metadata_Sector) );
+  if ( New_Entry == NULL )
+    return NULL;
+
+  New_Entry->Sector = Sector;
+  New_Entry->Contents_Known = FALSE;
+  New_Entry->Write_Needed = FALSE;
+  New_Entry->In_Use = TRUE;
+  New_Entry->Changed_Fields = 0;
+
+  memmove( &(Metadata->Sectors[Low + 1]), &(Metadata->Sectors[Low]), ( Metadata->Count - Low ) * sizeof(Metadata_Sector *) );
+  Metadata->Sectors[Low] = New_Entry;
+  Metadata->Count++;
+
+  return New_Entry;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Queue_Metadata_Write                             */
+/*                                                                   */
+/*   Descriptive Name: Prepares an MBR/EBR or DLA Table sector to be */
+/*                     written to disk by Write_Metadata_Sectors, if */
+/*                     it differs from what is on disk.              */
+/*                                                                   */
+/*   Input: CARDINAL32 DriveArrayIndex - The index in the DriveArray */
+/*                                       of the drive containing the */
+/*                                       sector.                     */
+/*          LBA Sector - The LBA of the sector.                      */
+/*          ADDRESS Buffer - The new contents of the sector.         */
+/*          BOOLEAN DLA_Table - TRUE if the sector is a DLA Table,   */
+/*                              FALSE if it is an MBR/EBR.           */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: If there is not enough memory to add the sector */
+/*                   to the metadata table for the drive, then the   */
+/*                   sector is written immediately.  If that write   */
+/*                   fails, the IO_Error flag for the drive is set.  */
+/*                                                                   */
+/*   Side Effects: The entry for the sector in the metadata table for*/
+/*                 the drive is marked as in use.                    */
+/*                                                                   */
+/*   Notes: The parts of the sector which have changed are recorded  */
+/*          in Changed_Fields so that they can be logged when the    */
+/*          sector is written.                                       */
+/*                                                                   */
+/*********************************************************************/
+static void Queue_Metadata_Write( CARDINAL32 DriveArrayIndex, LBA Sector, ADDRESS Buffer, BOOLEAN DLA_Table )
+{
+
+  Metadata_Sector *     Sector_Data;                                     /* The entry for Sector in the metadata table for the drive. */
+  Master_Boot_Record *  Old_Table;                                       /* Used to compare the parts of an MBR/EBR. */
+  Master_Boot_Record *  New_Table;                                       /* Used to compare the parts of an MBR/EBR. */
+  DLA_Table_Sector *    Old_DLA;                                         /* Used to compare the parts of a DLA Table. */
+  DLA_Table_Sector *    New_DLA;                                         /* Used to compare the parts of a DLA Table. */
+  CARDINAL32            Header_Size = (CARDINAL32) &( ( (DLA_Table_Sector *) 0 )->DLA_Array );   /* The size of the part of a DLA Table before the DLA_Array. */
+  CARDINAL32            Old_CRC;                                         /* Used to leave the CRC out of the comparison of DLA Table headers. */
+  CARDINAL32            Error;                                           /* Used to hold the error return code from WriteSectors. */
+
+  FUNCTION_ENTRY("Queue_Metadata_Write")
+
+  Sector_Data = Find_Metadata_Sector( DriveArrayIndex, Sector, TRUE );
+
+  if ( Sector_Data == NULL )
+  {
+
+    /* We can't keep track of this sector, so write it now. */
+    WriteSectors(DriveArrayIndex + 1, Sector, 1, Buffer, &Error);
+
+    if ( Error != DISKIO_NO_ERROR )
+    {
+
+      DriveArray[DriveArrayIndex].IO_Error = TRUE;
+
+      LOG_EVENT1("WriteSectors failed!","Error code", Error)
+
+    }
+
+    FUNCTION_EXIT("Queue_Metadata_Write")
+
+    return;
+
+  }
+
+  Sector_Data->In_Use = TRUE;
+
+  /* If the sector is already on disk, there is nothing to write. */
+  if ( Sector_Data->Contents_Known && ( memcmp(Sector_Data->On_Disk, Buffer, BYTES_PER_SECTOR) == 0 ) )
+  {
+
+    Sector_Data->Write_Needed = FALSE;
+
+    FUNCTION_EXIT("Queue_Metadata_Write")
+
+    return;
+
+  }
+
+  memcpy(Sector_Data->New_Contents, Buffer, BYTES_PER_SECTOR);
+  Sector_Data->Write_Needed = TRUE;
+
+  /* Record what has changed. */
+  if ( ! Sector_Data->Contents_Known )
+    Sector_Data->Changed_Fields = SECTOR_CONTENTS_UNKNOWN;
+  else if ( DLA_Table )
+  {
+
+    Old_DLA = (DLA_Table_Sector *) Sector_Data->On_Disk;
+    New_DLA = (DLA_Table_Sector *) Sector_Data->New_Contents;
+
+    Sector_Data->Changed_Fields = 0;
+
+    /* The CRC changes whenever anything else does, so leave it out of the comparison. */
+    Old_CRC = Old_DLA->DLA_CRC;
+    Old_DLA->DLA_CRC = New_DLA->DLA_CRC;
+
+    if ( memcmp(Old_DLA, New_DLA, Header_Size) != 0 )
+      Sector_Data->Changed_Fields |= DLA_TABLE_HEADER_CHANGED;
+
+    Old_DLA->DLA_CRC = Old_CRC;
+
+    if ( memcmp(Old_DLA->DLA_Array, New_DLA->DLA_Array, 4 * sizeof(DLA_Entry) ) != 0 )
+      Sector_Data->Changed_Fields |= DLA_TABLE_ENTRIES_CHANGED;
+
+  }
+  else
+  {
+
+    Old_Table = (Master_Boot_Record *) Sector_Data->On_Disk;
+    New_Table = (Master_Boot_Record *) Sector_Data->New_Contents;
+
+    Sector_Data->Changed_Fields = 0;
+
+    if ( memcmp(Old_Table->Reserved, New_Table->Reserved, sizeof(Old_Table->Reserved) ) != 0 )
+      Sector_Data->Changed_Fields |= BOOT_CODE_CHANGED;
+
+    if ( memcmp(Old_Table->Partition_Table, New_Table->Partition_Table, 4 * sizeof(Partition_Record) ) != 0 )
+      Sector_Data->Changed_Fields |= PARTITION_TABLE_CHANGED;
+
+    if ( Old_Table->Signature != New_Table->Signature )
+      Sector_Data->Changed_Fields |= MBR_EBR_SIGNATURE_CHANGED;
+
+  }
+
+  FUNCTION_EXIT("Queue_Metadata_Write")
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Write_Metadata_Sectors                           */
+/*                                                                   */
+/*   Descriptive Name: Writes the metadata sectors queued by         */
+/*                     Queue_Metadata_Write for a drive, and drops   */
+/*                     the sectors which are no longer in use from   */
+/*                     the metadata table for the drive.             */
+/*                                                                   */
+/*   Input: CARDINAL32 DriveArrayIndex - The index in the DriveArray */
+/*                                       of the drive.               */
+/*          CARDINAL32 * Error_Code - The address of a CARDINAL32 in */
+/*                                    which to store an error code   */
+/*                                    should an error occur.         */
+/*                                                                   */
+/*   Output: *Error_Code will be DISKIO_NO_ERROR if all of the       */
+/*           sectors were written, or if there was nothing to write. */
+/*           Otherwise it will hold the DISKIO error code from the   */
+/*           write.                                                  */
+/*                                                                   */
+/*   Error Handling: If the write fails, the sectors which were to be*/
+/*                   written are marked as having unknown contents,  */
+/*                   so that they will be written again by the next  */
+/*                   commit.                                         */
+/*                                                                   */
+/*   Side Effects: The metadata sectors which differ from what is on */
+/*                 disk are written to disk.                         */
+/*                                                                   */
+/*   Notes: The sectors are written in ascending order by LBA, all   */
+/*          with one request, so the time taken depends upon the     */
+/*          number of sectors which have changed rather than upon the*/
+/*          number of partitions on the drive.  If there is not      */
+/*          enough memory for the request, then the sectors are      */
+/*          written one at a time, still in ascending order.         */
+/*                                                                   */
+/*********************************************************************/
+static void Write_Metadata_Sectors( CARDINAL32 DriveArrayIndex, CARDINAL32 * Error_Code )
+{
+
+  Metadata_Table *      Metadata;                /* The metadata table for the drive. */
+  Metadata_Sector *     Sector_Data;             /* Used to walk the metadata table. */
+  Sector_IO_Segment *   Segments;                /* The sectors to write. */
+  CARDINAL32            Segment_Count = 0;       /* The number of entries in Segments. */
+  CARDINAL32            Sector_Index;            /* Used to walk the metadata table. */
+  CARDINAL32            Kept = 0;                /* The number of entries kept in the metadata table. */
+  CARDINAL32            Error;                   /* Used to hold the error return code from WriteSectors. */
+
+  FUNCTION_ENTRY("Write_Metadata_Sectors")
+
+  *Error_Code = DISKIO_NO_ERROR;
+
+  Metadata = (Metadata_Table *) DriveArray[DriveArrayIndex].Metadata_Table;
+  if ( Metadata == NULL )
+  {
+
+    FUNCTION_EXIT("Write_Metadata_Sectors")
+
+    return;
+
+  }
+
+  Segments = (Sector_IO_Segment *) malloc( ( Metadata->Count + 1 ) * sizeof(Sector_IO_Segment) );
+
+  for ( Sector_Index = 0; Sector_Index < Metadata->Count; Sector_Index++ )
+  {
+
+    Sector_Data = Metadata->Sectors[Sector_Index];
+
+    if ( ! Sector_Data->Write_Needed )
+      continue;
+
+    LOG_EVENT3("Writing a changed metadata sector.","Drive Number", DriveArrayIndex + 1, "Sector", Sector_Data->Sector, "Changed fields", Sector_Data->Changed_Fields)
+
+    if ( Segments != NULL )
+    {
+
+      Segments[Segment_Count].Starting_Sector = Sector_Data->Sector;
+      Segments[Segment_Count].Sector_Count = 1;
+      Segments[Segment_Count].Buffer = Sector_Data->New_Contents;
+      Segment_Count++;
+
+    }
+    else
+    {
+
+      WriteSectors(DriveArrayIndex + 1, Sector_Data->Sector, 1, Sector_Data->New_Contents, &Error);
+
+      if ( Error != DISKIO_NO_ERROR )
+        *Error_Code = Error;
+
+    }
+
+  }
+
+  if ( Segment_Count > 0 )
+    WriteSectorsV(DriveArrayIndex + 1, Segments, Segment_Count, Error_Code);
+
+  free(Segments);
+
+  /* Now bring the metadata table up to date.  Since we don't know which sectors made it to disk if there was an error, forget
+     what is on disk for all of the sectors that were written.                                                                   */
+  for ( Sector_Index = 0; Sector_Index < Metadata->Count; Sector_Index++ )
+  {
+
+    Sector_Data = Metadata->Sectors[Sector_Index];
+
+    if ( Sector_Data->Write_Needed )
+    {
+
+      if ( *Error_Code == DISKIO_NO_ERROR )
+      {
+
+        memcpy(Sector_Data->On_Disk, Sector_Data->New_Contents, BYTES_PER_SECTOR);
+        Sector_Data->Contents_Known = TRUE;
+
+      }
+      else
+        Sector_Data->Contents_Known = FALSE;
+
+      Sector_Data->Write_Needed = FALSE;
+      Sector_Data->Changed_Fields = 0;
+
+    }
+
+    if ( Sector_Data->In_Use )
+    {
+
+      Metadata->Sectors[Kept] = Sector_Data;
+      Kept++;
+
+    }
+    else
+      free(Sector_Data);
+
+  }
+
+  Metadata->Count = Kept;
+
+  FUNCTION_EXIT("Write_Metadata_Sectors")
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Discard_Metadata_Table                           */
+/*                                                                   */
+/*   Descriptive Name: Frees the metadata table for a drive.         */
+/*                                                                   */
+/*   Input: CARDINAL32 DriveArrayIndex - The index in the DriveArray */
+/*                                       of the drive.               */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: The Metadata_Table field of the DriveArray entry  */
+/*                 for the drive is set to NULL.                     */
+/*                                                                   */
+/*   Notes: None.                                                    */
+/*                                                                   */
+/*********************************************************************/
+static void Discard_Metadata_Table( CARDINAL32 DriveArrayIndex )
+{
+
+  Metadata_Table *  Metadata;       /* The metadata table for the drive. */
+  CARDINAL32        Sector_Index;   /* Used to walk the metadata table. */
+
+  FUNCTION_ENTRY("Discard_Metadata_Table")
+
+  Metadata = (Metadata_Table *) DriveArray[DriveArrayIndex].Metadata_Table;
+  if ( Metadata != NULL )
+  {
+
+    for ( Sector_Index = 0; Sector_Index < Metadata->Count; Sector_Index++ )
+      free(Metadata->Sectors[Sector_Index]);
+
+    free(Metadata->Sectors);
+    free(Metadata);
+
+    DriveArray[DriveArrayIndex].Metadata_Table = NULL;
+
+  }
+
+  FUNCTION_EXIT("Discard_Metadata_Table")
+
+  return;
+
+}
@@ -211,7 +211,9 @@ void Discover_Partitions( CARDINAL32 * Error_Code );
 /*                 for the partition experiencing the error will be  */
 /*                 set to TRUE.                                      */
 /*                                                                   */
-/*   Notes:  None.                                                   */
+/*   Notes:  Only those MBR, EBR, and DLA Table sectors which differ */
+/*           from what is on disk are written.  They are written in  */
+/*           ascending order by LBA, with one request per drive.     */
 /*                                                                   */
 /*********************************************************************/
 void Commit_Partition_Changes( CARDINAL32 * Error_Code );
@@ -492,4 +494,98 @@ Feature_Information_Array _System Get_Partition_Features( Partition_Data * Parti
 void _System Update_Partitions_Parent_Data(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Remember_Metadata_Sector                         */
+/*                                                                   */
+/*   Descriptive Name: Records the contents of a metadata sector as  */
+/*                     it is on disk, so that                        */
+/*                     Commit_Partition_Changes and the features do  */
+/*                     not write the sector again unless it changes. */
+/*                                                                   */
+/*   Input: CARDINAL32 DriveArrayIndex - The index in the DriveArray */
+/*                                       of the drive containing the */
+/*                                       sector.                     */
+/*          LBA Sector - The LBA of the sector.                      */
+/*          ADDRESS Buffer - The contents of the sector, as just read*/
+/*                           from or written to disk.                */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: If there is not enough memory to add the sector */
+/*                   to the metadata table for the drive, then the   */
+/*                   sector is not recorded and will be written the  */
+/*                   next time it is committed.                      */
+/*                                                                   */
+/*   Side Effects: The metadata table for the drive may be created or*/
+/*                 grown.                                            */
+/*                                                                   */
+/*   Notes: This should only be used for MBR/EBRs, DLA Tables, and   */
+/*          LVM Signature Sectors, as these are the only sectors     */
+/*          which Commit_Partition_Changes keeps track of.           */
+/*                                                                   */
+/*********************************************************************/
+void Remember_Metadata_Sector( CARDINAL32 DriveArrayIndex, LBA Sector, ADDRESS Buffer );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Metadata_Sector_Unchanged                        */
+/*                                                                   */
+/*   Descriptive Name: Determines whether or not a metadata sector   */
+/*                     already has the contents given.               */
+/*                                                                   */
+/*   Input: CARDINAL32 DriveArrayIndex - The index in the DriveArray */
+/*                                       of the drive containing the */
+/*                                       sector.                     */
+/*          LBA Sector - The LBA of the sector.                      */
+/*          ADDRESS Buffer - The contents that the sector should     */
+/*                           have.                                   */
+/*                                                                   */
+/*   Output: TRUE if the sector is known to have the contents in     */
+/*           Buffer on disk, FALSE otherwise.                        */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: A sector which has not been recorded with                */
+/*          Remember_Metadata_Sector, or which has since been        */
+/*          forgotten, is never unchanged.                           */
+/*                                                                   */
+/*********************************************************************/
+BOOLEAN Metadata_Sector_Unchanged( CARDINAL32 DriveArrayIndex, LBA Sector, ADDRESS Buffer );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Forget_Metadata_Sectors                          */
+/*                                                                   */
+/*   Descriptive Name: Marks any metadata sectors in a range of      */
+/*                     sectors as having unknown contents.           */
+/*                                                                   */
+/*   Input: CARDINAL32 DriveArrayIndex - The index in the DriveArray */
+/*                                       of the drive containing the */
+/*                                       sectors.                    */
+/*          LBA Starting_Sector - The first sector in the range.     */
+/*          CARDINAL32 Sector_Count - The number of sectors in the   */
+/*                                    range.                         */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: If DriveArrayIndex is not a valid index in the  */
+/*                   DriveArray, nothing is done.                    */
+/*                                                                   */
+/*   Side Effects: Any metadata sectors in the range will be written */
+/*                 the next time they are committed.                 */
+/*                                                                   */
+/*   Notes: This must be used whenever sectors are written other than*/
+/*          through Commit_Partition_Changes or                      */
+/*          Remember_Metadata_Sector, as the metadata table for the  */
+/*          drive would otherwise be out of date.                    */
+/*                                                                   */
+/*********************************************************************/
+void Forget_Metadata_Sectors( CARDINAL32 DriveArrayIndex, LBA Starting_Sector, CARDINAL32 Sector_Count );
+
+
 #endif
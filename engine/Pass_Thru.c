@@ -80,6 +80,7 @@
 #include "CRC.H"               /* INITIAL_CRC, CalculateCRC */
 
 #include "Pass_Thru.h"
+#include "Partition_Manager.h"   /* Remember_Metadata_Sector, Metadata_Sector_Unchanged, Forget_Metadata_Sectors */
 
 #ifdef DEBUG
 
@@ -231,6 +232,31 @@ ADDRESS Pass_Thru_Exchange_Function_Tables( ADDRESS PT_Common_Services )
 }
 
 
+/* Starts a read or write on the partition without waiting for it, for Transfer_Segments.  The sectors in Request are the same as
+   those given to PT_Read and PT_Write.  Returns TRUE if the request was started, in which case it will be returned by ReapSectorIO.
+   Returns FALSE if it was not, in which case PT_Read or PT_Write must be used instead.                                            */
+BOOLEAN Pass_Thru_Start_Transfer( Partition_Data * PartitionRecord, Sector_IO_Request * Request )
+{
+
+  CARDINAL32  Error;   /* Used to hold the error return code from SubmitSectorIO. */
+
+  /* Translate the request from one for the partition to one for the drive. */
+  Request->Drive_Number = PartitionRecord->Drive_Index + 1;
+
+  SubmitSectorIO(Request, &Error);
+
+  if ( Error != DISKIO_NO_ERROR )
+    return FALSE;
+
+  /* As in PT_Write, the Partition Manager's copy of any metadata sector being overwritten is no longer what is on disk. */
+  if ( Request->Write )
+    Forget_Metadata_Sectors(PartitionRecord->Drive_Index, Request->Starting_Sector, Request->Sector_Count);
+
+  return TRUE;
+
+}
+
+
 /*--------------------------------------------------
  * Private Functions Available
  --------------------------------------------------*/
@@ -511,8 +537,21 @@ static void Commit_PT_Changes( ADDRESS VolumeRecord, ADDRESS PartitionRecord, CA
   /* Actually calculate the CRC. */
   Signature_Sector->Signature_Sector_CRC = CalculateCRC(INITIAL_CRC, Signature_Sector, BYTES_PER_SECTOR);
 
-  /* Now write the signature sector to disk. */
-  WriteSectors(PData->Drive_Index + 1, PData->Starting_Sector + PData->Partition_Size - 1, 1, Signature_Sector, Error_Code);
+  /* Now write the signature sector to disk, unless it is already there. */
+  if ( Metadata_Sector_Unchanged(PData->Drive_Index, PData->Starting_Sector + PData->Partition_Size - 1, Signature_Sector) )
+    *Error_Code = DISKIO_NO_ERROR;
+  else
+  {
+
+    WriteSectors(PData->Drive_Index + 1, PData->Starting_Sector + PData->Partition_Size - 1, 1, Signature_Sector, Error_Code);
+
+    /* Keep the Partition Manager's copy of the signature sector up to date. */
+    if ( *Error_Code == DISKIO_NO_ERROR )
+      Remember_Metadata_Sector(PData->Drive_Index, PData->Starting_Sector + PData->Partition_Size - 1, Signature_Sector);
+    else
+      Forget_Metadata_Sectors(PData->Drive_Index, PData->Starting_Sector + PData->Partition_Size - 1, 1);
+
+  }
 
   /* Was there an error? */
   if ( *Error_Code != DISKIO_NO_ERROR )
@@ -632,6 +671,9 @@ static void PT_Write( ADDRESS PData, LBA Starting_Sector, CARDINAL32 Sectors_To_
   /* Translate the call from PT_Write to WriteSectors. */
   WriteSectors(PartitionRecord->Drive_Index + 1, Starting_Sector, Sectors_To_Write, Buffer, Error_Code);
 
+  /* If a feature has written over the LVM Signature Sector, the Partition Manager's copy of it is no longer what is on disk. */
+  Forget_Metadata_Sectors(PartitionRecord->Drive_Index, Starting_Sector, Sectors_To_Write);
+
   /* Translate the error code to an LVM_ENGINE error code. */
   if ( *Error_Code != DISKIO_NO_ERROR)
   {
@@ -33,6 +33,7 @@
 #include "lvm_types.h"
 #include "dlist.h"
 #include "engine.h"
+#include "diskio.h"
 
 #define PASS_THRU_FEATURE_ID  0
 #define PASS_THRU_MAJOR_VERSION  1
@@ -42,6 +43,8 @@ void Pass_Thru_Get_Required_LVM_Version( CARDINAL32 * Major_Version_Number, CARD
 
 ADDRESS Pass_Thru_Exchange_Function_Tables( ADDRESS PT_Common_Services );
 
+BOOLEAN Pass_Thru_Start_Transfer( Partition_Data * PartitionRecord, Sector_IO_Request * Request );
+
 
 #endif
 
@@ -0,0 +1,1606 @@
+/*
+ *
+ *   Copyright (c) International Business Machines  Corp., 2000
+ *
+ *   This program is free software;  you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY;  without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ *   the GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program;  if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Module: Sector_Cache.c
+ */
+
+/*
+ * Change History:
+ *
+ */
+
+/*
+ * Functions: BOOLEAN  Create_Sector_Cache
+ *            void     Destroy_Sector_Cache
+ *            void     Cache_IO_Vector
+ *            void     Cache_Prepare_Range
+ *            void     FlushSectorCache
+ *            void     SetSectorCacheSize
+ *            void     GetSectorCacheStatistics
+ *
+ * Description: This module provides a per drive, write-back, least
+ *              recently used cache of sectors for the DiskIO modules.
+ *
+ * Notes: Each cached sector has its own entry.  The entries for a drive
+ *        are kept in a hash table, keyed by LBA, and on a list ordered
+ *        from most recently used to least recently used.
+ *
+ *        Transfers of more than MAXIMUM_CACHED_TRANSFER sectors are not
+ *        cached.  They go straight to disk, but they still see, and
+ *        update, any cached copies of the sectors they cover.
+ *
+ *        Reads never write to disk.  If every entry for a drive is dirty,
+ *        sectors read from that drive are simply not added to the cache.
+ *        Writes which find the cache full write out all of the dirty
+ *        sectors for the drive, in LBA order, and then reuse the least
+ *        recently used entry.
+ *
+ */
+
+#include <stdlib.h>          /* malloc, free, qsort */
+#include <string.h>          /* memcpy, memset */
+#include "gbltypes.h"        /* ADDRESS, BOOLEAN, BYTE, CARDINAL32 */
+#include "lvm_types.h"       /* LBA */
+#include "lvm_constants.h"   /* BYTES_PER_SECTOR */
+#include "diskio.h"          /* Sector_IO_Segment, Sector_Cache_Statistics, DISKIO error codes */
+#include "Sector_Cache.h"    /* Included to ensure that Sector_Cache.C and Sector_Cache.H are consistent. */
+
+#ifdef DEBUG
+
+#ifdef PARANOID
+
+#include <assert.h>
+
+#endif
+
+#endif
+
+/*--------------------------------------------------
+ * Private Constants
+ --------------------------------------------------*/
+#define DEFAULT_CACHE_SECTORS      1024       /* The number of sectors cached for each drive unless SetSectorCacheSize says otherwise. */
+#define MAXIMUM_CACHED_TRANSFER    64         /* Transfers larger than this bypass the cache. */
+#define MINIMUM_HASH_BUCKETS       64         /* The smallest hash table used for a drive.  Must be a power of 2. */
+
+
+/*--------------------------------------------------
+ * Private Type definitions
+ --------------------------------------------------*/
+typedef struct _Cache_Entry {
+                               LBA                    Sector;        /* The sector held by this entry. */
+                               BOOLEAN                Dirty;         /* TRUE if Data has not been written to disk yet. */
+                               struct _Cache_Entry *  Hash_Next;     /* The next entry in the same hash bucket. */
+                               struct _Cache_Entry *  Newer;         /* The entry used just after this one, or NULL if this is the newest. */
+                               struct _Cache_Entry *  Older;         /* The entry used just before this one, or NULL if this is the oldest. */
+                               BYTE                   Data[BYTES_PER_SECTOR];
+                             } Cache_Entry;
+
+typedef struct _Drive_Cache {
+                               Cache_Entry **  Hash_Table;           /* The hash buckets, indexed by Hash_Sector. */
+                               CARDINAL32      Hash_Mask;            /* The number of hash buckets - 1. */
+                               Cache_Entry *   Newest;               /* The most recently used entry. */
+                               Cache_Entry *   Oldest;               /* The least recently used entry. */
+                               CARDINAL32      Entry_Count;          /* The number of entries in the cache. */
+                               CARDINAL32      Dirty_Count;          /* The number of entries which are dirty. */
+                               CARDINAL32      Hits;                 /* Sectors read which were found in the cache. */
+                               CARDINAL32      Misses;               /* Sectors read which were not found in the cache. */
+                               CARDINAL32      Sectors_Written;      /* Dirty sectors written to disk by Flush_Drive. */
+                             } Drive_Cache;
+
+
+/*--------------------------------------------------
+ Private global variables.
+--------------------------------------------------*/
+static Drive_Cache *          Caches = NULL;                       /* One entry per drive. */
+static CARDINAL32             Cache_Drive_Count = 0;               /* The number of entries in Caches. */
+static CARDINAL32             Capacity = DEFAULT_CACHE_SECTORS;    /* The most entries allowed in a Drive_Cache. */
+static Cache_Check_Function   Check_Request = NULL;                /* Supplied by the DiskIO module. */
+static Cache_Vector_Function  Transfer = NULL;                     /* Supplied by the DiskIO module. */
+
+
+/*--------------------------------------------------
+ Private functions.
+--------------------------------------------------*/
+static CARDINAL32    Hash_Sector( Drive_Cache * Cache, LBA Sector );
+static Cache_Entry * Find_Entry( Drive_Cache * Cache, LBA Sector );
+static void          Make_Newest( Drive_Cache * Cache, Cache_Entry * Entry );
+static void          Unlink_Entry( Drive_Cache * Cache, Cache_Entry * Entry );
+static void          Remove_Entry( Drive_Cache * Cache, Cache_Entry * Entry );
+static Cache_Entry * Get_Entry( CARDINAL32 Drive_Number, BOOLEAN Allow_Flush, CARDINAL32 * Error );
+static BOOLEAN       Size_Hash_Table( Drive_Cache * Cache );
+static void          Flush_Drive( CARDINAL32 Drive_Number, CARDINAL32 * Error );
+static void          Trim_Drive( CARDINAL32 Drive_Number, CARDINAL32 * Error );
+static void          Read_Segments( CARDINAL32 Drive_Number, Sector_IO_Segment * Segments, CARDINAL32 Segment_Count, CARDINAL32 * Error );
+static void          Write_Segment( CARDINAL32 Drive_Number, Sector_IO_Segment * Segment, CARDINAL32 * Error );
+static void          Merge_Dirty_Sectors( Drive_Cache * Cache, Sector_IO_Segment * Segment );
+static void          Fill_Cache( CARDINAL32 Drive_Number, Sector_IO_Segment * Segment );
+static int           Compare_Entries( const void * First, const void * Second );
+
+
+/*--------------------------------------------------
+ There are no public global variables.
+--------------------------------------------------*/
+
+
+
+/*--------------------------------------------------
+ * Public Functions Available
+ --------------------------------------------------*/
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Create_Sector_Cache                              */
+/*                                                                   */
+/*   Descriptive Name: Prepares the sector cache for use with the    */
+/*                     drives just opened by OpenDrives.             */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Count : The number of drives to cache.  */
+/*          Cache_Check_Function Check_Function : Used to make sure  */
+/*                                  that a request refers to sectors */
+/*                                  which exist.                     */
+/*          Cache_Vector_Function Transfer_Function : Used to read or*/
+/*                                  write sectors on disk.           */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: TRUE if successful, with *Error set to 0.  Otherwise    */
+/*           FALSE, with *Error > 0.                                 */
+/*                                                                   */
+/*   Error Handling: If this function fails, no memory is held.      */
+/*                                                                   */
+/*   Side Effects: Memory is allocated for the per drive caches.     */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+BOOLEAN Create_Sector_Cache( CARDINAL32             Drive_Count,
+                             Cache_Check_Function   Check_Function,
+                             Cache_Vector_Function  Transfer_Function,
+                             CARDINAL32 *           Error )
+{
+
+  CARDINAL32    Index;      /* Used to walk the Caches array. */
+
+  if ( Caches != NULL )
+  {
+
+    *Error = DISKIO_DRIVES_ALREADY_OPEN;
+    return FALSE;
+
+  }
+
+  Caches = (Drive_Cache *) malloc( Drive_Count * sizeof(Drive_Cache) );
+  if ( Caches == NULL )
+  {
+
+    *Error = DISKIO_OUT_OF_MEMORY;
+    return FALSE;
+
+  }
+
+  memset( Caches, 0, Drive_Count * sizeof(Drive_Cache) );
+  Cache_Drive_Count = Drive_Count;
+  Check_Request = Check_Function;
+  Transfer = Transfer_Function;
+
+  for ( Index = 0; Index < Drive_Count; Index++ )
+  {
+
+    if ( ! Size_Hash_Table( &(Caches[Index]) ) )
+    {
+
+      /* Nothing has been cached yet, so there is nothing to write and no error to report. */
+      Destroy_Sector_Cache( Error );
+
+      *Error = DISKIO_OUT_OF_MEMORY;
+      return FALSE;
+
+    }
+
+  }
+
+  *Error = DISKIO_NO_ERROR;
+
+  return TRUE;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Destroy_Sector_Cache                             */
+/*                                                                   */
+/*   Descriptive Name: Writes any dirty sectors to disk and then     */
+/*                     frees all memory held by the sector cache.    */
+/*                                                                   */
+/*   Input: CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If every dirty sector was written, *Error will be 0.    */
+/*           Otherwise, *Error will be the error from the first      */
+/*           drive whose dirty sectors could not be written.         */
+/*                                                                   */
+/*   Error Handling: Dirty sectors which can not be written are      */
+/*                   discarded.  The memory held by the cache is     */
+/*                   freed either way.                               */
+/*                                                                   */
+/*   Side Effects: Data may be written to disk.                      */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+void Destroy_Sector_Cache( CARDINAL32 * Error )
+{
+
+  CARDINAL32    Index;         /* Used to walk the Caches array. */
+  CARDINAL32    Flush_Error;   /* Used to hold the error return code from Flush_Drive. */
+
+  *Error = DISKIO_NO_ERROR;
+
+  if ( Caches == NULL )
+    return;
+
+  for ( Index = 0; Index < Cache_Drive_Count; Index++ )
+  {
+
+    /* Keep going if a drive fails so that the other drives still get their dirty sectors written.  Report the first failure. */
+    if ( Caches[Index].Dirty_Count > 0 )
+    {
+
+      Flush_Drive( Index + 1, &Flush_Error );
+
+      if ( ( Flush_Error != DISKIO_NO_ERROR ) && ( *Error == DISKIO_NO_ERROR ) )
+        *Error = Flush_Error;
+
+    }
+
+    while ( Caches[Index].Oldest != NULL )
+      Remove_Entry( &(Caches[Index]), Caches[Index].Oldest );
+
+    free( Caches[Index].Hash_Table );
+
+  }
+
+  free( Caches );
+
+  Caches = NULL;
+  Cache_Drive_Count = 0;
+  Check_Request = NULL;
+  Transfer = NULL;
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Cache_IO_Vector                                  */
+/*                                                                   */
+/*   Descriptive Name: Reads or writes a list of segments on a drive,*/
+/*                     using the cache where possible.               */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the drive to use.*/
+/*          Sector_IO_Segment * Segments : The segments to transfer. */
+/*          CARDINAL32 Segment_Count : The number of entries in      */
+/*                                     Segments.                     */
+/*          BOOLEAN Write : TRUE for a write, FALSE for a read.      */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: *Error will be 0 if successful, > 0 otherwise.          */
+/*                                                                   */
+/*   Error Handling: Every segment is range checked before any I/O   */
+/*                   is done.  Writes stop at the first segment which*/
+/*                   fails.                                          */
+/*                                                                   */
+/*   Side Effects: Data may be read into the segment buffers, or     */
+/*                 written to the cache or to disk.                  */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+void Cache_IO_Vector( CARDINAL32          Drive_Number,
+                      Sector_IO_Segment * Segments,
+                      CARDINAL32          Segment_Count,
+                      BOOLEAN             Write,
+                      CARDINAL32 *        Error )
+{
+
+  CARDINAL32     Index;       /* Used to walk the Segments array. */
+
+  /* The cache exists whenever the drives are open. */
+  if ( Caches == NULL )
+  {
+
+    *Error = DISKIO_DRIVES_NOT_OPEN;
+    return;
+
+  }
+
+  /* If the cache has been turned off, let the DiskIO module do the whole thing. */
+  if ( Capacity == 0 )
+  {
+
+    Transfer( Drive_Number, Segments, Segment_Count, Write, Error );
+    return;
+
+  }
+
+  /* Make sure that every segment is on the drive before we do anything.  Once a segment is in the cache, nothing else will check it. */
+  *Error = DISKIO_NO_ERROR;
+  for ( Index = 0; Index < Segment_Count; Index++ )
+  {
+
+    if ( ! Check_Request( Drive_Number, Segments[Index].Starting_Sector, Segments[Index].Sector_Count, Error ) )
+      return;
+
+  }
+
+  if ( ! Write )
+  {
+
+    Read_Segments( Drive_Number, Segments, Segment_Count, Error );
+    return;
+
+  }
+
+  for ( Index = 0; ( Index < Segment_Count ) && ( *Error == DISKIO_NO_ERROR ); Index++ )
+    Write_Segment( Drive_Number, &(Segments[Index]), Error );
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Cache_Prepare_Range                              */
+/*                                                                   */
+/*   Descriptive Name: Makes the disk agree with the cache for a     */
+/*                     range of sectors which is about to be accessed*/
+/*                     without going through the cache.              */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the drive to use.*/
+/*          LBA Starting_Sector : The first sector of the range.     */
+/*          CARDINAL32 Sector_Count : The number of sectors in the   */
+/*                                    range.                         */
+/*          BOOLEAN Write : TRUE if the range is about to be written.*/
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: *Error will be 0 if successful, > 0 otherwise.          */
+/*                                                                   */
+/*   Error Handling: *Error is set if dirty sectors could not be     */
+/*                   written.                                        */
+/*                                                                   */
+/*   Side Effects: Dirty sectors may be written to disk, and cached  */
+/*                 sectors may be discarded.                         */
+/*                                                                   */
+/*   Notes:  The caller has already range checked the request.       */
+/*                                                                   */
+/*********************************************************************/
+void Cache_Prepare_Range( CARDINAL32    Drive_Number,
+                          LBA           Starting_Sector,
+                          CARDINAL32    Sector_Count,
+                          BOOLEAN       Write,
+                          CARDINAL32 *  Error )
+{
+
+  Drive_Cache *   Cache;          /* The cache for Drive_Number. */
+  Cache_Entry *   Current_Entry;  /* Used to walk the entries in the cache. */
+  Cache_Entry *   Next_Entry;     /* The entry after Current_Entry, saved in case Current_Entry is removed. */
+
+  *Error = DISKIO_NO_ERROR;
+
+  if ( ( Caches == NULL ) || ( Sector_Count == 0 ) )
+    return;
+
+  Cache = &(Caches[Drive_Number - 1]);
+
+  /* If any sector in the range is dirty, the disk must be brought up to date first.  Writing all of the dirty sectors keeps them in
+     LBA order and costs little more than writing just the ones in the range.                                                          */
+  for ( Current_Entry = Cache->Newest; ( Current_Entry != NULL ) && ( Cache->Dirty_Count > 0 ); Current_Entry = Current_Entry->Older )
+  {
+
+    if ( Current_Entry->Dirty &&
+         ( Current_Entry->Sector >= Starting_Sector ) &&
+         ( Current_Entry->Sector - Starting_Sector < Sector_Count ) )
+    {
+
+      Flush_Drive( Drive_Number, Error );
+      if ( *Error != DISKIO_NO_ERROR )
+        return;
+
+      break;
+
+    }
+
+  }
+
+  /* A write will make our copies of the sectors in the range out of date. */
+  if ( Write )
+  {
+
+    for ( Current_Entry = Cache->Newest; Current_Entry != NULL; Current_Entry = Next_Entry )
+    {
+
+      Next_Entry = Current_Entry->Older;
+
+      if ( ( Current_Entry->Sector >= Starting_Sector ) &&
+           ( Current_Entry->Sector - Starting_Sector < Sector_Count ) )
+        Remove_Entry( Cache, Current_Entry );
+
+    }
+
+  }
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: FlushSectorCache                                 */
+/*                                                                   */
+/*   Descriptive Name: This function writes any sectors which are    */
+/*                     held in the sector cache to disk.             */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the hard drive   */
+/*                                    whose cached sectors are to be */
+/*                                    written, or 0 for all drives.  */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If Successful, *Error will be 0.                        */
+/*           If Unsuccessful, then *Error will be > 0.               */
+/*                                                                   */
+/*   Error Handling: When flushing all drives, every drive is tried, */
+/*                   and the first error is returned.                */
+/*                                                                   */
+/*   Side Effects: Data may be written to disk.                      */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+void FlushSectorCache( CARDINAL32 Drive_Number, CARDINAL32 * Error )
+{
+
+  CARDINAL32    Index;          /* Used to walk the Caches array. */
+  CARDINAL32    Drive_Error;    /* The error return code from Flush_Drive for a single drive. */
+
+  if ( Caches == NULL )
+  {
+
+    *Error = DISKIO_DRIVES_NOT_OPEN;
+    return;
+
+  }
+
+  if ( Drive_Number > Cache_Drive_Count )
+  {
+
+    *Error = DISKIO_REQUEST_OUT_OF_RANGE;
+    return;
+
+  }
+
+  if ( Drive_Number != 0 )
+  {
+
+    Flush_Drive( Drive_Number, Error );
+    return;
+
+  }
+
+  *Error = DISKIO_NO_ERROR;
+
+  for ( Index = 0; Index < Cache_Drive_Count; Index++ )
+  {
+
+    Flush_Drive( Index + 1, &Drive_Error );
+
+    if ( ( Drive_Error != DISKIO_NO_ERROR ) && ( *Error == DISKIO_NO_ERROR ) )
+      *Error = Drive_Error;
+
+  }
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: SetSectorCacheSize                               */
+/*                                                                   */
+/*   Descriptive Name: This function sets the number of sectors which*/
+/*                     may be held in the sector cache for each      */
+/*                     drive.                                        */
+/*                                                                   */
+/*   Input: CARDINAL32 Sectors_Per_Drive : The number of sectors to  */
+/*                                         cache for each drive.  0  */
+/*                                         turns the cache off.      */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If Successful, *Error will be 0.                        */
+/*           If Unsuccessful, then *Error will be > 0.               */
+/*                                                                   */
+/*   Error Handling: The first error encountered is returned.  The   */
+/*                   new size is used regardless.                    */
+/*                                                                   */
+/*   Side Effects: Sectors may be removed from the cache, and data   */
+/*                 may be written to disk.                           */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+void SetSectorCacheSize( CARDINAL32 Sectors_Per_Drive, CARDINAL32 * Error )
+{
+
+  CARDINAL32    Index;          /* Used to walk the Caches array. */
+  CARDINAL32    Drive_Error;    /* The error return code for a single drive. */
+
+  Capacity = Sectors_Per_Drive;
+
+  *Error = DISKIO_NO_ERROR;
+
+  if ( Caches == NULL )
+    return;
+
+  for ( Index = 0; Index < Cache_Drive_Count; Index++ )
+  {
+
+    Trim_Drive( Index + 1, &Drive_Error );
+
+    if ( ( Drive_Error == DISKIO_NO_ERROR ) && ( ! Size_Hash_Table( &(Caches[Index]) ) ) )
+      Drive_Error = DISKIO_OUT_OF_MEMORY;
+
+    if ( ( Drive_Error != DISKIO_NO_ERROR ) && ( *Error == DISKIO_NO_ERROR ) )
+      *Error = Drive_Error;
+
+  }
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: GetSectorCacheStatistics                         */
+/*                                                                   */
+/*   Descriptive Name: This function returns the size and hit/miss   */
+/*                     counters of the sector cache.                 */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the hard drive to*/
+/*                                    report on, or 0 for the totals */
+/*                                    for all drives.                */
+/*          Sector_Cache_Statistics * Statistics : The location of a */
+/*                                    buffer to hold the counters.   */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If Successful, *Statistics will be filled in and *Error */
+/*              will be 0.                                           */
+/*           If Unsuccessful, then *Error will be > 0.               */
+/*                                                                   */
+/*   Error Handling: *Error will be > 0 if an error occurs.          */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+void GetSectorCacheStatistics( CARDINAL32 Drive_Number, Sector_Cache_Statistics * Statistics, CARDINAL32 * Error )
+{
+
+  CARDINAL32    Index;          /* Used to walk the Caches array. */
+
+  if ( Caches == NULL )
+  {
+
+    *Error = DISKIO_DRIVES_NOT_OPEN;
+    return;
+
+  }
+
+  if ( Drive_Number > Cache_Drive_Count )
+  {
+
+    *Error = DISKIO_REQUEST_OUT_OF_RANGE;
+    return;
+
+  }
+
+  memset( Statistics, 0, sizeof(Sector_Cache_Statistics) );
+  Statistics->Capacity = Capacity;
+
+  for ( Index = 0; Index < Cache_Drive_Count; Index++ )
+  {
+
+    if ( ( Drive_Number != 0 ) && ( Index != Drive_Number - 1 ) )
+      continue;
+
+    Statistics->Cached_Sectors += Caches[Index].Entry_Count;
+    Statistics->Dirty_Sectors += Caches[Index].Dirty_Count;
+    Statistics->Hits += Caches[Index].Hits;
+    Statistics->Misses += Caches[Index].Misses;
+    Statistics->Sectors_Written += Caches[Index].Sectors_Written;
+
+  }
+
+  *Error = DISKIO_NO_ERROR;
+
+  return;
+
+}
+
+
+
+/*--------------------------------------------------
+ * Private Functions Available
+ --------------------------------------------------*/
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Read_Segments                                    */
+/*                                                                   */
+/*   Descriptive Name: Reads a list of segments, taking what it can  */
+/*                     from the cache and reading the rest from disk */
+/*                     with a single call to Transfer.               */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the drive to use.*/
+/*          Sector_IO_Segment * Segments : The segments to read.     */
+/*          CARDINAL32 Segment_Count : The number of entries in      */
+/*                                     Segments.                     */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: *Error will be 0 if successful, > 0 otherwise.          */
+/*                                                                   */
+/*   Error Handling: If the read from disk fails, nothing is added to*/
+/*                   the cache.                                      */
+/*                                                                   */
+/*   Side Effects: Sectors read from disk are added to the cache.    */
+/*                                                                   */
+/*   Notes:  A segment is only taken from the cache if all of its    */
+/*           sectors are cached.  Otherwise the whole segment is read*/
+/*           from disk and any dirty cached sectors are copied over  */
+/*           what was read.                                          */
+/*                                                                   */
+/*********************************************************************/
+static void Read_Segments( CARDINAL32 Drive_Number, Sector_IO_Segment * Segments, CARDINAL32 Segment_Count, CARDINAL32 * Error )
+{
+
+  Drive_Cache *        Cache;            /* The cache for Drive_Number. */
+  Sector_IO_Segment *  Misses;           /* The segments which must be read from disk. */
+  Sector_IO_Segment    Single_Miss;      /* Used as Misses when there is only one segment, to save a call to malloc. */
+  CARDINAL32           Miss_Count;       /* The number of entries in Misses. */
+  CARDINAL32           Index;            /* Used to walk the Segments and Misses arrays. */
+  CARDINAL32           Offset;           /* Used to walk the sectors in a segment. */
+  Cache_Entry *        Entry;            /* The cache entry for the sector at Offset. */
+  BYTE *               Buffer;           /* The location in the segment buffer for the sector at Offset. */
+
+  Cache = &(Caches[Drive_Number - 1]);
+
+  if ( Segment_Count == 1 )
+    Misses = &Single_Miss;
+  else
+  {
+
+    Misses = (Sector_IO_Segment *) malloc( Segment_Count * sizeof(Sector_IO_Segment) );
+    if ( Misses == NULL )
+    {
+
+      *Error = DISKIO_OUT_OF_MEMORY;
+      return;
+
+    }
+
+  }
+
+  Miss_Count = 0;
+
+  for ( Index = 0; Index < Segment_Count; Index++ )
+  {
+
+    if ( Segments[Index].Sector_Count == 0 )
+      continue;
+
+    /* Is every sector in this segment in the cache? */
+    Offset = 0;
+    if ( Segments[Index].Sector_Count <= MAXIMUM_CACHED_TRANSFER )
+    {
+
+      while ( ( Offset < Segments[Index].Sector_Count ) && ( Find_Entry( Cache, Segments[Index].Starting_Sector + Offset ) != NULL ) )
+        Offset++;
+
+    }
+
+    if ( Offset < Segments[Index].Sector_Count )
+    {
+
+      Misses[Miss_Count] = Segments[Index];
+      Miss_Count++;
+      continue;
+
+    }
+
+    /* It is.  Copy it out of the cache. */
+    Buffer = (BYTE *) Segments[Index].Buffer;
+    for ( Offset = 0; Offset < Segments[Index].Sector_Count; Offset++, Buffer += BYTES_PER_SECTOR )
+    {
+
+      Entry = Find_Entry( Cache, Segments[Index].Starting_Sector + Offset );
+      memcpy( Buffer, Entry->Data, BYTES_PER_SECTOR );
+      Make_Newest( Cache, Entry );
+
+    }
+
+    Cache->Hits += Segments[Index].Sector_Count;
+
+  }
+
+  *Error = DISKIO_NO_ERROR;
+
+  if ( Miss_Count > 0 )
+  {
+
+    Transfer( Drive_Number, Misses, Miss_Count, FALSE, Error );
+
+    if ( *Error == DISKIO_NO_ERROR )
+    {
+
+      /* What is in the cache is newer than what is on disk.  Every segment must be brought up to date before any of them are added to
+         the cache, since adding sectors to the cache may cause others to be evicted.                                                   */
+      for ( Index = 0; Index < Miss_Count; Index++ )
+        Merge_Dirty_Sectors( Cache, &(Misses[Index]) );
+
+      for ( Index = 0; Index < Miss_Count; Index++ )
+        Fill_Cache( Drive_Number, &(Misses[Index]) );
+
+    }
+
+  }
+
+  if ( Misses != &Single_Miss )
+    free( Misses );
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Write_Segment                                    */
+/*                                                                   */
+/*   Descriptive Name: Writes one segment to the cache, or to disk if*/
+/*                     it is too large to be cached.                 */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the drive to use.*/
+/*          Sector_IO_Segment * Segment : The segment to write.      */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: *Error will be 0 if successful, > 0 otherwise.          */
+/*                                                                   */
+/*   Error Handling: If the cache is full and its dirty sectors can  */
+/*                   not be written to make room, *Error is set and  */
+/*                   the rest of the segment is not written.         */
+/*                                                                   */
+/*   Side Effects: The cache, or the disk, is updated.               */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static void Write_Segment( CARDINAL32 Drive_Number, Sector_IO_Segment * Segment, CARDINAL32 * Error )
+{
+
+  Drive_Cache *   Cache;          /* The cache for Drive_Number. */
+  Cache_Entry *   Entry;          /* The cache entry for the sector being written. */
+  Cache_Entry *   Next_Entry;     /* Used to walk the entries in the cache. */
+  CARDINAL32      Offset;         /* Used to walk the sectors in the segment. */
+  BYTE *          Buffer;         /* The data for the sector at Offset. */
+
+  Cache = &(Caches[Drive_Number - 1]);
+
+  *Error = DISKIO_NO_ERROR;
+
+  if ( Segment->Sector_Count == 0 )
+    return;
+
+  /* Large writes go straight to disk.  Any copies we have of the sectors written are updated to match. */
+  if ( ( Segment->Sector_Count > MAXIMUM_CACHED_TRANSFER ) || ( Segment->Sector_Count > Capacity ) )
+  {
+
+    Transfer( Drive_Number, Segment, 1, TRUE, Error );
+    if ( *Error != DISKIO_NO_ERROR )
+      return;
+
+    for ( Entry = Cache->Newest; Entry != NULL; Entry = Next_Entry )
+    {
+
+      Next_Entry = Entry->Older;
+
+      if ( ( Entry->Sector >= Segment->Starting_Sector ) &&
+           ( Entry->Sector - Segment->Starting_Sector < Segment->Sector_Count ) )
+      {
+
+        memcpy( Entry->Data, (BYTE *) Segment->Buffer + ( Entry->Sector - Segment->Starting_Sector ) * BYTES_PER_SECTOR, BYTES_PER_SECTOR );
+
+        if ( Entry->Dirty )
+        {
+
+          Entry->Dirty = FALSE;
+          Cache->Dirty_Count--;
+
+        }
+
+      }
+
+    }
+
+    return;
+
+  }
+
+  Buffer = (BYTE *) Segment->Buffer;
+  for ( Offset = 0; Offset < Segment->Sector_Count; Offset++, Buffer += BYTES_PER_SECTOR )
+  {
+
+    Entry = Find_Entry( Cache, Segment->Starting_Sector + Offset );
+    if ( Entry == NULL )
+    {
+
+      Entry = Get_Entry( Drive_Number, TRUE, Error );
+      if ( Entry == NULL )
+        return;
+
+      Entry->Sector = Segment->Starting_Sector + Offset;
+      Entry->Hash_Next = Cache->Hash_Table[Hash_Sector( Cache, Entry->Sector )];
+      Cache->Hash_Table[Hash_Sector( Cache, Entry->Sector )] = Entry;
+
+    }
+
+    memcpy( Entry->Data, Buffer, BYTES_PER_SECTOR );
+
+    if ( ! Entry->Dirty )
+    {
+
+      Entry->Dirty = TRUE;
+      Cache->Dirty_Count++;
+
+    }
+
+    Make_Newest( Cache, Entry );
+
+  }
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Merge_Dirty_Sectors                              */
+/*                                                                   */
+/*   Descriptive Name: Copies any dirty cached sectors which fall    */
+/*                     within a segment into the segment's buffer.   */
+/*                                                                   */
+/*   Input: Drive_Cache * Cache : The cache to use.                  */
+/*          Sector_IO_Segment * Segment : The segment just read.     */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: The segment's buffer may be changed.              */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static void Merge_Dirty_Sectors( Drive_Cache * Cache, Sector_IO_Segment * Segment )
+{
+
+  Cache_Entry *   Entry;          /* Used to walk the entries in the cache. */
+  CARDINAL32      Offset;         /* Used to walk the sectors in the segment. */
+
+  if ( Cache->Dirty_Count == 0 )
+    return;
+
+  /* Look up each sector if that is cheaper than looking at each entry. */
+  if ( Segment->Sector_Count <= Cache->Entry_Count )
+  {
+
+    for ( Offset = 0; Offset < Segment->Sector_Count; Offset++ )
+    {
+
+      Entry = Find_Entry( Cache, Segment->Starting_Sector + Offset );
+      if ( ( Entry != NULL ) && Entry->Dirty )
+        memcpy( (BYTE *) Segment->Buffer + Offset * BYTES_PER_SECTOR, Entry->Data, BYTES_PER_SECTOR );
+
+    }
+
+    return;
+
+  }
+
+  for ( Entry = Cache->Newest; Entry != NULL; Entry = Entry->Older )
+  {
+
+    if ( Entry->Dirty &&
+         ( Entry->Sector >= Segment->Starting_Sector ) &&
+         ( Entry->Sector - Segment->Starting_Sector < Segment->Sector_Count ) )
+      memcpy( (BYTE *) Segment->Buffer + ( Entry->Sector - Segment->Starting_Sector ) * BYTES_PER_SECTOR, Entry->Data, BYTES_PER_SECTOR );
+
+  }
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Fill_Cache                                       */
+/*                                                                   */
+/*   Descriptive Name: Adds the sectors of a segment just read from  */
+/*                     disk to the cache.                            */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the drive to use.*/
+/*          Sector_IO_Segment * Segment : The segment just read.     */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: If there is no room, the remaining sectors are  */
+/*                   not cached.                                     */
+/*                                                                   */
+/*   Side Effects: Clean entries may be evicted from the cache.      */
+/*                                                                   */
+/*   Notes:  Segments too large to cache are only counted as misses. */
+/*                                                                   */
+/*********************************************************************/
+static void Fill_Cache( CARDINAL32 Drive_Number, Sector_IO_Segment * Segment )
+{
+
+  Drive_Cache *   Cache;          /* The cache for Drive_Number. */
+  Cache_Entry *   Entry;          /* The cache entry for the sector at Offset. */
+  CARDINAL32      Offset;         /* Used to walk the sectors in the segment. */
+  CARDINAL32      Error;          /* Used with Get_Entry. */
+  BYTE *          Buffer;         /* The data for the sector at Offset. */
+
+  Cache = &(Caches[Drive_Number - 1]);
+
+  if ( ( Segment->Sector_Count > MAXIMUM_CACHED_TRANSFER ) || ( Segment->Sector_Count > Capacity ) )
+  {
+
+    Cache->Misses += Segment->Sector_Count;
+    return;
+
+  }
+
+  Buffer = (BYTE *) Segment->Buffer;
+  for ( Offset = 0; Offset < Segment->Sector_Count; Offset++, Buffer += BYTES_PER_SECTOR )
+  {
+
+    Entry = Find_Entry( Cache, Segment->Starting_Sector + Offset );
+    if ( Entry != NULL )
+    {
+
+      Cache->Hits++;
+      Make_Newest( Cache, Entry );
+      continue;
+
+    }
+
+    Cache->Misses++;
+
+    Entry = Get_Entry( Drive_Number, FALSE, &Error );
+    if ( Entry == NULL )
+      continue;
+
+    Entry->Sector = Segment->Starting_Sector + Offset;
+    Entry->Hash_Next = Cache->Hash_Table[Hash_Sector( Cache, Entry->Sector )];
+    Cache->Hash_Table[Hash_Sector( Cache, Entry->Sector )] = Entry;
+    memcpy( Entry->Data, Buffer, BYTES_PER_SECTOR );
+    Make_Newest( Cache, Entry );
+
+  }
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Get_Entry                                        */
+/*                                                                   */
+/*   Descriptive Name: Returns an unused, clean cache entry, evicting*/
+/*                     the least recently used entry if the cache is */
+/*                     full.                                         */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the drive.       */
+/*          BOOLEAN Allow_Flush : If TRUE, and every entry is dirty, */
+/*                                the dirty entries are written to   */
+/*                                disk to make room.                 */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: The entry, which is in neither the hash table nor the   */
+/*           LRU list, or NULL with *Error > 0.                      */
+/*                                                                   */
+/*   Error Handling: See Output.                                     */
+/*                                                                   */
+/*   Side Effects: Entries may be evicted, and dirty sectors written.*/
+/*                                                                   */
+/*   Notes:  The caller must fill in the entry and add it to the     */
+/*           hash table and the LRU list.                            */
+/*                                                                   */
+/*********************************************************************/
+static Cache_Entry * Get_Entry( CARDINAL32 Drive_Number, BOOLEAN Allow_Flush, CARDINAL32 * Error )
+{
+
+  Drive_Cache *   Cache;          /* The cache for Drive_Number. */
+  Cache_Entry *   Entry;          /* The entry being returned. */
+
+  Cache = &(Caches[Drive_Number - 1]);
+
+  *Error = DISKIO_NO_ERROR;
+
+  if ( Cache->Entry_Count < Capacity )
+  {
+
+    Entry = (Cache_Entry *) malloc( sizeof(Cache_Entry) );
+    if ( Entry == NULL )
+    {
+
+      *Error = DISKIO_OUT_OF_MEMORY;
+      return NULL;
+
+    }
+
+    Cache->Entry_Count++;
+
+    Entry->Dirty = FALSE;
+    Entry->Hash_Next = NULL;
+    Entry->Newer = NULL;
+    Entry->Older = NULL;
+
+    return Entry;
+
+  }
+
+  /* The cache is full.  Find the least recently used entry which is clean. */
+  for ( Entry = Cache->Oldest; ( Entry != NULL ) && Entry->Dirty; Entry = Entry->Newer )
+    ;
+
+  if ( Entry == NULL )
+  {
+
+    if ( ! Allow_Flush )
+    {
+
+      *Error = DISKIO_OUT_OF_MEMORY;
+      return NULL;
+
+    }
+
+    /* Every entry is dirty.  Write them all out, in LBA order, rather than one at a time as they are evicted. */
+    Flush_Drive( Drive_Number, Error );
+    if ( *Error != DISKIO_NO_ERROR )
+      return NULL;
+
+    Entry = Cache->Oldest;
+
+  }
+
+  /* Take the entry out of the cache, but keep it allocated for our caller. */
+  Unlink_Entry( Cache, Entry );
+
+  Entry->Hash_Next = NULL;
+
+  return Entry;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Flush_Drive                                      */
+/*                                                                   */
+/*   Descriptive Name: Writes all of the dirty entries for a drive to*/
+/*                     disk in ascending LBA order.                  */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the drive.       */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: *Error will be 0 if successful, > 0 otherwise.          */
+/*                                                                   */
+/*   Error Handling: If the write fails, the dirty entries are       */
+/*                   removed from the cache.                         */
+/*                                                                   */
+/*   Side Effects: Data is written to disk.                          */
+/*                                                                   */
+/*   Notes:  The Transfer function combines adjacent sectors into a  */
+/*           single transfer where it can.                           */
+/*                                                                   */
+/*********************************************************************/
+static void Flush_Drive( CARDINAL32 Drive_Number, CARDINAL32 * Error )
+{
+
+  Drive_Cache *        Cache;          /* The cache for Drive_Number. */
+  Cache_Entry **       Dirty_Entries;  /* The dirty entries, sorted by LBA. */
+  Sector_IO_Segment *  Segments;       /* One segment per dirty entry. */
+  Cache_Entry *        Entry;          /* Used to walk the entries in the cache. */
+  Cache_Entry *        Next_Entry;     /* The entry after Entry, saved in case Entry is removed. */
+  CARDINAL32           Dirty_Count;    /* The number of entries in Dirty_Entries. */
+  CARDINAL32           Index;          /* Used to walk the Dirty_Entries array. */
+
+  Cache = &(Caches[Drive_Number - 1]);
+
+  *Error = DISKIO_NO_ERROR;
+
+  if ( Cache->Dirty_Count == 0 )
+    return;
+
+  Dirty_Entries = (Cache_Entry **) malloc( Cache->Dirty_Count * sizeof(Cache_Entry *) );
+  Segments = (Sector_IO_Segment *) malloc( Cache->Dirty_Count * sizeof(Sector_IO_Segment) );
+  if ( ( Dirty_Entries == NULL ) || ( Segments == NULL ) )
+  {
+
+    free( Dirty_Entries );
+    free( Segments );
+
+    *Error = DISKIO_OUT_OF_MEMORY;
+    return;
+
+  }
+
+  Dirty_Count = 0;
+  for ( Entry = Cache->Newest; Entry != NULL; Entry = Entry->Older )
+  {
+
+    if ( Entry->Dirty )
+    {
+
+      Dirty_Entries[Dirty_Count] = Entry;
+      Dirty_Count++;
+
+    }
+
+  }
+
+#ifdef DEBUG
+
+#ifdef PARANOID
+
+  assert( Dirty_Count == Cache->Dirty_Count );
+
+#endif
+
+#endif
+
+  qsort( Dirty_Entries, Dirty_Count, sizeof(Cache_Entry *), &Compare_Entries );
+
+  for ( Index = 0; Index < Dirty_Count; Index++ )
+  {
+
+    Segments[Index].Starting_Sector = Dirty_Entries[Index]->Sector;
+    Segments[Index].Sector_Count = 1;
+    Segments[Index].Buffer = Dirty_Entries[Index]->Data;
+
+  }
+
+  Transfer( Drive_Number, Segments, Dirty_Count, TRUE, Error );
+
+  if ( *Error == DISKIO_NO_ERROR )
+  {
+
+    for ( Index = 0; Index < Dirty_Count; Index++ )
+      Dirty_Entries[Index]->Dirty = FALSE;
+
+    Cache->Dirty_Count = 0;
+    Cache->Sectors_Written += Dirty_Count;
+
+  }
+  else
+  {
+
+    /* We don't know which sectors made it to disk, so forget all of them.  Later reads will see what is really there. */
+    for ( Entry = Cache->Newest; Entry != NULL; Entry = Next_Entry )
+    {
+
+      Next_Entry = Entry->Older;
+
+      if ( Entry->Dirty )
+        Remove_Entry( Cache, Entry );
+
+    }
+
+  }
+
+  free( Dirty_Entries );
+  free( Segments );
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Trim_Drive                                       */
+/*                                                                   */
+/*   Descriptive Name: Evicts entries from the cache for a drive     */
+/*                     until it is no larger than Capacity.          */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the drive.       */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: *Error will be 0 if successful, > 0 otherwise.          */
+/*                                                                   */
+/*   Error Handling: The cache is trimmed even if the dirty entries  */
+/*                   could not be written.                           */
+/*                                                                   */
+/*   Side Effects: Data may be written to disk.                      */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static void Trim_Drive( CARDINAL32 Drive_Number, CARDINAL32 * Error )
+{
+
+  Drive_Cache *   Cache;          /* The cache for Drive_Number. */
+
+  Cache = &(Caches[Drive_Number - 1]);
+
+  *Error = DISKIO_NO_ERROR;
+
+  if ( Cache->Entry_Count <= Capacity )
+    return;
+
+  if ( Cache->Dirty_Count > 0 )
+    Flush_Drive( Drive_Number, Error );
+
+  while ( Cache->Entry_Count > Capacity )
+    Remove_Entry( Cache, Cache->Oldest );
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Size_Hash_Table                                  */
+/*                                                                   */
+/*   Descriptive Name: Makes the hash table for a drive suit the     */
+/*                     current Capacity, rehashing its entries.      */
+/*                                                                   */
+/*   Input: Drive_Cache * Cache : The cache to resize.               */
+/*                                                                   */
+/*   Output: TRUE if successful, FALSE if memory could not be        */
+/*           allocated.                                              */
+/*                                                                   */
+/*   Error Handling: If this function fails, the old hash table is   */
+/*                   kept.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  The table has one bucket per entry, rounded up to a     */
+/*           power of 2, so that Hash_Sector can use a mask.         */
+/*                                                                   */
+/*********************************************************************/
+static BOOLEAN Size_Hash_Table( Drive_Cache * Cache )
+{
+
+  Cache_Entry **   New_Table;      /* The new array of hash buckets. */
+  CARDINAL32       Bucket_Count;   /* The number of entries in New_Table. */
+  Cache_Entry *    Entry;          /* Used to walk the entries in the cache. */
+
+  Bucket_Count = MINIMUM_HASH_BUCKETS;
+  while ( ( Bucket_Count < Capacity ) && ( Bucket_Count < 0x80000000 ) )
+    Bucket_Count *= 2;
+
+  if ( ( Cache->Hash_Table != NULL ) && ( Cache->Hash_Mask == Bucket_Count - 1 ) )
+    return TRUE;
+
+  New_Table = (Cache_Entry **) malloc( Bucket_Count * sizeof(Cache_Entry *) );
+  if ( New_Table == NULL )
+    return FALSE;
+
+  memset( New_Table, 0, Bucket_Count * sizeof(Cache_Entry *) );
+
+  free( Cache->Hash_Table );
+  Cache->Hash_Table = New_Table;
+  Cache->Hash_Mask = Bucket_Count - 1;
+
+  for ( Entry = Cache->Newest; Entry != NULL; Entry = Entry->Older )
+  {
+
+    Entry->Hash_Next = Cache->Hash_Table[Hash_Sector( Cache, Entry->Sector )];
+    Cache->Hash_Table[Hash_Sector( Cache, Entry->Sector )] = Entry;
+
+  }
+
+  return TRUE;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Hash_Sector                                      */
+/*                                                                   */
+/*   Descriptive Name: Returns the hash bucket for an LBA.           */
+/*                                                                   */
+/*   Input: Drive_Cache * Cache : The cache to use.                  */
+/*          LBA Sector : The sector to hash.                         */
+/*                                                                   */
+/*   Output: An index into Cache->Hash_Table.                        */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  Metadata sectors tend to sit at the ends of tracks, so  */
+/*           the high bits are folded in to keep them from piling up */
+/*           in a few buckets.                                       */
+/*                                                                   */
+/*********************************************************************/
+static CARDINAL32 Hash_Sector( Drive_Cache * Cache, LBA Sector )
+{
+
+  return ( Sector ^ ( Sector >> 11 ) ^ ( Sector >> 21 ) ) & Cache->Hash_Mask;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Find_Entry                                       */
+/*                                                                   */
+/*   Descriptive Name: Looks up a sector in the cache.               */
+/*                                                                   */
+/*   Input: Drive_Cache * Cache : The cache to search.               */
+/*          LBA Sector : The sector to look for.                     */
+/*                                                                   */
+/*   Output: The entry for Sector, or NULL if it is not cached.      */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static Cache_Entry * Find_Entry( Drive_Cache * Cache, LBA Sector )
+{
+
+  Cache_Entry *   Entry;      /* Used to walk the hash chain. */
+
+  for ( Entry = Cache->Hash_Table[Hash_Sector( Cache, Sector )]; Entry != NULL; Entry = Entry->Hash_Next )
+  {
+
+    if ( Entry->Sector == Sector )
+      return Entry;
+
+  }
+
+  return NULL;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Make_Newest                                      */
+/*                                                                   */
+/*   Descriptive Name: Moves an entry to the most recently used end  */
+/*                     of the LRU list, adding it if necessary.      */
+/*                                                                   */
+/*   Input: Drive_Cache * Cache : The cache the entry belongs to.    */
+/*          Cache_Entry * Entry : The entry to move.                 */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  An entry which is on the list always has a non-NULL     */
+/*           Older or Newer field unless it is the only entry, in    */
+/*           which case it is Cache->Newest.                         */
+/*                                                                   */
+/*********************************************************************/
+static void Make_Newest( Drive_Cache * Cache, Cache_Entry * Entry )
+{
+
+  if ( Cache->Newest == Entry )
+    return;
+
+  /* Take the entry off the list if it is on it. */
+  if ( ( Entry->Newer != NULL ) || ( Entry->Older != NULL ) )
+  {
+
+    if ( Entry->Newer != NULL )
+      Entry->Newer->Older = Entry->Older;
+
+    if ( Entry->Older != NULL )
+      Entry->Older->Newer = Entry->Newer;
+    else
+      Cache->Oldest = Entry->Newer;
+
+  }
+
+  /* Put it at the front. */
+  Entry->Newer = NULL;
+  Entry->Older = Cache->Newest;
+
+  if ( Cache->Newest != NULL )
+    Cache->Newest->Newer = Entry;
+  else
+    Cache->Oldest = Entry;
+
+  Cache->Newest = Entry;
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Unlink_Entry                                     */
+/*                                                                   */
+/*   Descriptive Name: Takes an entry out of the hash table and the  */
+/*                     LRU list without freeing it.                  */
+/*                                                                   */
+/*   Input: Drive_Cache * Cache : The cache the entry belongs to.    */
+/*          Cache_Entry * Entry : The entry to unlink.               */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: Entry_Count is not changed.  Dirty_Count is       */
+/*                 reduced if the entry was dirty.                   */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static void Unlink_Entry( Drive_Cache * Cache, Cache_Entry * Entry )
+{
+
+  Cache_Entry **  Link;       /* Used to find the pointer to Entry in its hash chain. */
+
+  for ( Link = &(Cache->Hash_Table[Hash_Sector( Cache, Entry->Sector )]); *Link != NULL; Link = &((*Link)->Hash_Next) )
+  {
+
+    if ( *Link == Entry )
+    {
+
+      *Link = Entry->Hash_Next;
+      break;
+
+    }
+
+  }
+
+  if ( Entry->Newer != NULL )
+    Entry->Newer->Older = Entry->Older;
+  else
+    Cache->Newest = Entry->Older;
+
+  if ( Entry->Older != NULL )
+    Entry->Older->Newer = Entry->Newer;
+  else
+    Cache->Oldest = Entry->Newer;
+
+  Entry->Newer = NULL;
+  Entry->Older = NULL;
+
+  if ( Entry->Dirty )
+  {
+
+    Entry->Dirty = FALSE;
+    Cache->Dirty_Count--;
+
+  }
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Remove_Entry                                     */
+/*                                                                   */
+/*   Descriptive Name: Removes an entry from the cache and frees it. */
+/*                                                                   */
+/*   Input: Drive_Cache * Cache : The cache the entry belongs to.    */
+/*          Cache_Entry * Entry : The entry to remove.               */
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: Any dirty data in the entry is lost.              */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static void Remove_Entry( Drive_Cache * Cache, Cache_Entry * Entry )
+{
+
+  Unlink_Entry( Cache, Entry );
+
+  Cache->Entry_Count--;
+
+  free( Entry );
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Compare_Entries                                  */
+/*                                                                   */
+/*   Descriptive Name: qsort comparison function which orders cache  */
+/*                     entries by LBA.                               */
+/*                                                                   */
+/*   Input: const void * First : The address of a Cache_Entry *.     */
+/*          const void * Second : The address of a Cache_Entry *.    */
+/*                                                                   */
+/*   Output: < 0, 0 or > 0 as First is below, at or above Second.    */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static int Compare_Entries( const void * First, const void * Second )
+{
+
+  LBA    First_Sector = ( *(Cache_Entry * const *) First )->Sector;
+  LBA    Second_Sector = ( *(Cache_Entry * const *) Second )->Sector;
+
+  if ( First_Sector < Second_Sector )
+    return -1;
+
+  if ( First_Sector > Second_Sector )
+    return 1;
+
+  return 0;
+
+}
@@ -0,0 +1,191 @@
+/*
+ *
+ *   Copyright (c) International Business Machines  Corp., 2000
+ *
+ *   This program is free software;  you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY;  without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ *   the GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program;  if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * Module: Sector_Cache.h
+ */
+
+/*
+ * Change History:
+ *
+ */
+
+/*
+ * Functions: BOOLEAN  Create_Sector_Cache
+ *            void     Destroy_Sector_Cache
+ *            void     Cache_IO_Vector
+ *            void     Cache_Prepare_Range
+ *
+ * Description: This module provides a per drive, write-back, least
+ *              recently used cache of sectors for the DiskIO modules.
+ *              The DiskIO module supplies the functions which do the
+ *              actual transfers, and routes ReadSectors, WriteSectors,
+ *              ReadSectorsV and WriteSectorsV through Cache_IO_Vector.
+ *              FlushSectorCache, SetSectorCacheSize and
+ *              GetSectorCacheStatistics, which are declared in diskio.h,
+ *              are implemented here for both DiskIO modules.
+ *
+ * Notes: Each drive has its own cache, so different drives may be used
+ *        from different threads at the same time.  A given drive must
+ *        only be used by one thread at a time.
+ *
+ */
+
+#ifndef SECTOR_CACHE_H
+
+#define SECTOR_CACHE_H 1
+
+#include "gbltypes.h"        /* ADDRESS, BOOLEAN, CARDINAL32 */
+#include "lvm_types.h"       /* LBA */
+#include "diskio.h"          /* Sector_IO_Segment */
+
+/* The following types describe the functions that the DiskIO module must provide to the cache. */
+typedef BOOLEAN (* Cache_Check_Function)( CARDINAL32 Drive_Number, LBA Starting_Sector, CARDINAL32 Sector_Count, CARDINAL32 * Error );
+typedef void    (* Cache_Vector_Function)( CARDINAL32 Drive_Number, Sector_IO_Segment * Segments, CARDINAL32 Segment_Count, BOOLEAN Write, CARDINAL32 * Error );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Create_Sector_Cache                              */
+/*                                                                   */
+/*   Descriptive Name: Prepares the sector cache for use with the    */
+/*                     drives just opened by OpenDrives.             */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Count : The number of drives to cache.  */
+/*          Cache_Check_Function Check_Request : Used to make sure   */
+/*                                  that a request refers to sectors */
+/*                                  which exist.                     */
+/*          Cache_Vector_Function Transfer : Used to read or write   */
+/*                                  sectors on disk.                 */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: TRUE if successful, with *Error set to 0.  Otherwise    */
+/*           FALSE, with *Error > 0.                                 */
+/*                                                                   */
+/*   Error Handling: If this function fails, no memory is held.      */
+/*                                                                   */
+/*   Side Effects: Memory is allocated for the per drive caches.     */
+/*                                                                   */
+/*   Notes:  The capacity set by SetSectorCacheSize is kept across   */
+/*           calls to Destroy_Sector_Cache and Create_Sector_Cache.  */
+/*                                                                   */
+/*********************************************************************/
+BOOLEAN Create_Sector_Cache( CARDINAL32             Drive_Count,
+                             Cache_Check_Function   Check_Request,
+                             Cache_Vector_Function  Transfer,
+                             CARDINAL32 *           Error );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Destroy_Sector_Cache                             */
+/*                                                                   */
+/*   Descriptive Name: Writes any dirty sectors to disk and then     */
+/*                     frees all memory held by the sector cache.    */
+/*                                                                   */
+/*   Input: CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If every dirty sector was written, *Error will be 0.    */
+/*           Otherwise, *Error will be the error from the first      */
+/*           drive whose dirty sectors could not be written.         */
+/*                                                                   */
+/*   Error Handling: Dirty sectors which can not be written are      */
+/*                   discarded.  The memory held by the cache is     */
+/*                   freed either way.                               */
+/*                                                                   */
+/*   Side Effects: Data may be written to disk.                      */
+/*                                                                   */
+/*   Notes:  Must be called before the drive handles are closed.     */
+/*                                                                   */
+/*********************************************************************/
+void Destroy_Sector_Cache( CARDINAL32 * Error );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Cache_IO_Vector                                  */
+/*                                                                   */
+/*   Descriptive Name: Reads or writes a list of segments on a drive,*/
+/*                     using the cache where possible.               */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the drive to use.*/
+/*          Sector_IO_Segment * Segments : The segments to transfer. */
+/*          CARDINAL32 Segment_Count : The number of entries in      */
+/*                                     Segments.                     */
+/*          BOOLEAN Write : TRUE for a write, FALSE for a read.      */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: *Error will be 0 if successful, > 0 otherwise.          */
+/*                                                                   */
+/*   Error Handling: Every segment is range checked before any I/O   */
+/*                   is done.                                        */
+/*                                                                   */
+/*   Side Effects: Segments small enough to be cached are written    */
+/*                 only to the cache.  They reach the disk when the  */
+/*                 cache is flushed or when they are evicted.        */
+/*                                                                   */
+/*   Notes:  If the cache is not active, the segments are handed to  */
+/*           the Transfer function as is.                            */
+/*                                                                   */
+/*********************************************************************/
+void Cache_IO_Vector( CARDINAL32          Drive_Number,
+                      Sector_IO_Segment * Segments,
+                      CARDINAL32          Segment_Count,
+                      BOOLEAN             Write,
+                      CARDINAL32 *        Error );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Cache_Prepare_Range                              */
+/*                                                                   */
+/*   Descriptive Name: Makes the disk agree with the cache for a     */
+/*                     range of sectors which is about to be accessed*/
+/*                     without going through the cache.              */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the drive to use.*/
+/*          LBA Starting_Sector : The first sector of the range.     */
+/*          CARDINAL32 Sector_Count : The number of sectors in the   */
+/*                                    range.                         */
+/*          BOOLEAN Write : TRUE if the range is about to be written.*/
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: *Error will be 0 if successful, > 0 otherwise.          */
+/*                                                                   */
+/*   Error Handling: *Error is set if dirty sectors could not be     */
+/*                   written.                                        */
+/*                                                                   */
+/*   Side Effects: If any sector in the range is dirty, the dirty    */
+/*                 sectors for the drive are written to disk.  If    */
+/*                 Write is TRUE, cached copies of sectors in the    */
+/*                 range are discarded.                              */
+/*                                                                   */
+/*   Notes:  Used by SubmitSectorIO.                                 */
+/*                                                                   */
+/*********************************************************************/
+void Cache_Prepare_Range( CARDINAL32    Drive_Number,
+                          LBA           Starting_Sector,
+                          CARDINAL32    Sector_Count,
+                          BOOLEAN       Write,
+                          CARDINAL32 *  Error );
+
+
+#endif
@@ -63,6 +63,7 @@
 #include <stdio.h>    /* sprintf */
 #include <string.h>   /* strlen */
 #include <ctype.h>    /* toupper */
+#include <limits.h>   /* CHAR_MIN */
 
 #define NEED_BYTE_DEFINED
 #define INCL_DOS
@@ -215,8 +216,8 @@ static void          _System Create_Fake_Volumes_For_PRM(ADDRESS Object, TAG Obj
 static void          _System Add_Fake_Volumes_To_Deleted_Volumes_List(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
 static void          _System Find_Current_Drive_Letter_Conflicts(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
 static void          _System Find_Drive_Letter_Conflicts(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
-static INTEGER32     _System Sort_By_Drive_Letter_Preference( ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag, CARDINAL32 * Error);
-static INTEGER32     _System Sort_By_Current_Drive_Letter( ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag, CARDINAL32 * Error);
+static CARDINAL32    _System Drive_Letter_Preference_Key( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, CARDINAL32 * Error);
+static CARDINAL32    _System Current_Drive_Letter_Key( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, CARDINAL32 * Error);
 static Volume_Data * Create_Compatibility_Volume( Partition_Data * PartitionRecord, CARDINAL32 * Error );
 static BOOLEAN       Is_Volume_Bootable(Volume_Data * VolumeRecord, BOOLEAN Check_Eligibility_Only, CARDINAL32 * Error_Code);
 static Volume_Data * Create_Default_LVM_Volume( CARDINAL32 * Error_Code );
@@ -238,7 +239,7 @@ static void          _System Find_Reserved_Drive_Letters(ADDRESS Object, TAG Obj
 static void          _System Find_Existing_Potential_Volume(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
 static void          _System Process_Potential_Volumes(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
 static void          _System Set_Feature_Index(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
-static INTEGER32     _System Sort_Partition_List_By_Feature_ID( ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag, CARDINAL32 * Error);
+static CARDINAL32    _System Partition_Feature_ID_Key( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, CARDINAL32 * Error);
 static void          _System Discovery_Failed_Remove_Features_From_Partitions(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
 static BOOLEAN       Feature_List_Is_Bogus( CARDINAL32 Feature_Count, LVM_Feature_Specification_Record FeaturesToUse[], DLIST Features_List, BOOLEAN * Aggregator_Found, CARDINAL32 * Error_Code);
 static void          _System Apply_Features(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
@@ -254,6 +255,7 @@ static void          _System Find_Expandable_Volumes(ADDRESS Object, TAG ObjectT
 static void          _System Find_Expansion_DLL(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
 static void          _System Find_And_Convert_LVM_Volumes(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
 static void          _System Check_Feature_List_For_Conversion(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
+static void          Set_Volume_Information_Record( Volume_Information_Record * Volume_Information, Volume_Data * VolumeRecord, CARDINAL32 * Error_Code );
 
 /*--------------------------------------------------
  * There are no additional public global variables
@@ -856,7 +858,7 @@ void Discover_Volumes( CARDINAL32 * Error_Code )
      duplicate preferences will end up grouped together in the Volumes list.  We can then walk the
      volumes list and resolve who will actually get a drive letter for cases where multiple volumes
      want the same drive letter.                                                                     */
-  SortList(Volumes, &Sort_By_Drive_Letter_Preference, &Error);
+  SortListByKey(Volumes, &Drive_Letter_Preference_Key, &Error);
 
 #ifdef DEBUG
 
@@ -869,7 +871,7 @@ void Discover_Volumes( CARDINAL32 * Error_Code )
   if ( Error != DLIST_SUCCESS)
   {
 
-    LOG_ERROR1("SortList failed.","Error code", Error)
+    LOG_ERROR1("SortListByKey failed.","Error code", Error)
 
     *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
 
@@ -1861,7 +1863,7 @@ Volume_Control_Array Get_Volume_Control_Data( CARDINAL32 * Error_Code )
   }
 
   /* Sort the list of Volumes based upon their current drive letters. */
-  SortList(Volumes, &Sort_By_Current_Drive_Letter, Error_Code);
+  SortListByKey(Volumes, &Current_Drive_Letter_Key, Error_Code);
 
 #ifdef DEBUG
 
@@ -2039,7 +2041,6 @@ Volume_Information_Record Get_Volume_Information( ADDRESS Volume_Handle, CARDINA
   TAG                         ObjectTag;          /* Used when translating the Volume_Handle into a Volume_Data structure. */
 
   Volume_Information_Record   ReturnValue;        /* Used to hold the value we are going to return while we construct it. */
-  Volume_Data  *              Volume_Information; /* Used to access Object as a Volume_Information_Record. */
 
 
   API_ENTRY("Get_Volume_Information")
@@ -2090,48 +2091,224 @@ Volume_Information_Record Get_Volume_Information( ADDRESS Volume_Handle, CARDINA
 
   }
 
-  /* Establish access to Object as a Volume_Data structure. */
-  Volume_Information = (Volume_Data *) Object;
-
   /* Now lets initialize ReturnValue using the contents of Object (which we know is a Volume_Data structure). */
-  ReturnValue.Volume_Size = Volume_Information->Volume_Size;
-  ReturnValue.Compatibility_Volume = Volume_Information->Compatibility_Volume;
-  ReturnValue.Partition_Count = Volume_Information->Partition_Count;
-  ReturnValue.Drive_Letter_Conflict = Volume_Information->Drive_Letter_Conflict;
-  ReturnValue.Drive_Letter_Preference = Volume_Information->Drive_Letter_Preference;
-  ReturnValue.Current_Drive_Letter = Volume_Information->Current_Drive_Letter;
-  ReturnValue.Initial_Drive_Letter = Volume_Information->Initial_Drive_Letter;
-  strncpy(ReturnValue.Volume_Name, Volume_Information->Volume_Name,VOLUME_NAME_SIZE);
-  strncpy(ReturnValue.File_System_Name, Volume_Information->File_System_Name,FILESYSTEM_NAME_SIZE);
-  ReturnValue.Status = 0;
-  ReturnValue.Bootable = FALSE;
-  ReturnValue.New_Volume = Volume_Information->New_Volume;
+  Set_Volume_Information_Record( &ReturnValue, (Volume_Data *) Object, Error_Code );
 
-  /* If this volume represents a non-lvm device, then it is, by definition, not Bootable.  If it represents an LVM controlled
-     device, then it may be bootable and we will have to check.                                                                */
-  if ( ( Volume_Information->Device_Type == LVM_HARD_DRIVE ) || ( Volume_Information->Device_Type == LVM_PRM ) )
+  /* All done. */
+
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  API_EXIT("Get_Volume_Information")
+
+  return ReturnValue;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Get_Volume_Information_Array                     */
+/*                                                                   */
+/*   Descriptive Name:  Returns the Volume_Information_Records for a */
+/*                      group of volumes in a single array.          */
+/*                                                                   */
+/*   Input: ADDRESS Volume_Handles[] - The handles of the volumes    */
+/*                                     about which information is    */
+/*                                     desired.  If this is NULL,    */
+/*                                     then the records for all of   */
+/*                                     the volumes are returned.     */
+/*          CARDINAL32 Count - The number of entries in              */
+/*                             Volume_Handles.  This is ignored if   */
+/*                             Volume_Handles is NULL.               */
+/*          CARDINAL32 * Error_Code - The address of a CARDINAL32 in */
+/*                                    in which to store an error code*/
+/*                                    should an error occur.         */
+/*                                                                   */
+/*   Output: A Volume_Information_Array is returned.  If there is no */
+/*           error, then the Nth entry of Volume_Information_Data    */
+/*           will be the record for the Nth entry of Volume_Handles, */
+/*           and *Error_Code will be 0.  If an error occurs, then    */
+/*           *Error_Code will be > 0.                                */
+/*                                                                   */
+/*   Error Handling:  If any entry of Volume_Handles is not the      */
+/*                    handle of a volume, *Error_Code will be        */
+/*                    LVM_ENGINE_BAD_HANDLE.  Any memory allocated   */
+/*                    for the return value will be freed, and the    */
+/*                    Volume_Information_Array returned will have a  */
+/*                    NULL Volume_Information_Data and a Count of 0. */
+/*                                                                   */
+/*   Side Effects:  Memory for the returned array is allocated.  If  */
+/*                  Volume_Handles is NULL, the Volumes list is      */
+/*                  sorted as it is by Get_Volume_Control_Data.      */
+/*                                                                   */
+/*   Notes:  This does the work of calling Get_Volume_Information    */
+/*           for each handle, but with one entry into the engine and */
+/*           one allocation.  When Volume_Handles is NULL, the       */
+/*           records are in the same order as the records returned   */
+/*           by Get_Volume_Control_Data.                             */
+/*                                                                   */
+/*           The caller becomes responsible for the memory allocated */
+/*           for Volume_Information_Data, and should free it with    */
+/*           Free_Engine_Memory when they are done using it.         */
+/*                                                                   */
+/*********************************************************************/
+Volume_Information_Array Get_Volume_Information_Array( ADDRESS Volume_Handles[], CARDINAL32 Count, CARDINAL32 * Error_Code )
+{
+
+  Volume_Information_Array    ReturnValue;        /* The structure to be returned to the caller. */
+  CARDINAL32                  Index;              /* Used to walk Volume_Handles. */
+  ADDRESS                     Volume_Handle;      /* Used to walk the Volumes list. */
+
+  ADDRESS                     Object;             /* Used when translating a handle into a Volume_Data structure. */
+  TAG                         ObjectTag;          /* Used when translating a handle into a Volume_Data structure. */
+
+
+  API_ENTRY("Get_Volume_Information_Array")
+
+  /* Initialize ReturnValue assuming failure. */
+  ReturnValue.Count = 0;
+  ReturnValue.Volume_Information_Data = NULL;
+
+  /* Has the Volume Manager been opened yet? */
+  if ( Volumes == NULL )
   {
 
-    /* Is this volume marked installable and we are at install time? */
-    if ( ( Install_Volume_Handle == Volume_Information->Volume_Handle ) && ( Min_Install_Size > 0 ) )
-      ReturnValue.Status = 3;
-    else
-      if ( Is_Volume_Startable(Volume_Information,FALSE, Error_Code) )      /* Is this volume startable? */
-          ReturnValue.Status = 2;
-      else
-        if ( Is_Volume_Bootable(Volume_Information, FALSE, Error_Code) )    /* Is this volume bootable? */
-          ReturnValue.Status = 1;
+    /* The Engine has not been opened yet!  Nothing has been initialized yet, so we can not perform the function asked of us.  Abort. */
+    *Error_Code = LVM_ENGINE_NOT_OPEN;
 
-    /* Is the volume bootable? */
-    ReturnValue.Bootable = ( ReturnValue.Status != 0 );
+    API_EXIT("Get_Volume_Information_Array")
+
+    return ReturnValue;
 
   }
 
-  /* All done. */
+  /* If we are to return all of the volumes, put them in the order used by Get_Volume_Control_Data. */
+  if ( Volume_Handles == NULL )
+  {
+
+    Count = GetListSize( Volumes, Error_Code );
+
+    if ( *Error_Code == DLIST_SUCCESS )
+      SortListByKey(Volumes, &Current_Drive_Letter_Key, Error_Code);
+
+#ifdef DEBUG
+
+#ifdef PARANOID
+
+    assert( *Error_Code == DLIST_SUCCESS );
+
+#else
+
+    if ( *Error_Code != DLIST_SUCCESS )
+    {
+
+      *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+
+      API_EXIT("Get_Volume_Information_Array")
+
+      return ReturnValue;
+
+    }
+
+#endif
+
+#endif
+
+  }
+
+  /* If there is nothing to return, then we are done! */
+  if ( Count == 0 )
+  {
+
+    /* Indicate success. */
+    *Error_Code = LVM_ENGINE_NO_ERROR;
+
+    API_EXIT("Get_Volume_Information_Array")
+
+    return ReturnValue;
+
+  }
+
+  /* Allocate memory for the array of Volume_Information_Records being returned. */
+  ReturnValue.Volume_Information_Data = (Volume_Information_Record *) malloc(Count * sizeof(Volume_Information_Record) );
+
+  /* Did we get the memory? */
+  if ( ReturnValue.Volume_Information_Data == NULL )
+  {
+
+    /* We are out of memory!  Abort. */
+    *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    API_EXIT("Get_Volume_Information_Array")
+
+    return ReturnValue;
+
+  }
+
+  if ( Volume_Handles != NULL )
+  {
+
+    for ( Index = 0; Index < Count; Index++ )
+    {
+
+      /* Determine what kind of a handle we really have. */
+      Translate_Handle( Volume_Handles[Index], &Object, &ObjectTag, Error_Code );
+
+      /* Was the handle valid, and is the object what we want? */
+      if ( ( *Error_Code != HANDLE_MANAGER_NO_ERROR ) || ( ObjectTag != VOLUME_DATA_TAG ) )
+      {
+
+        LOG_ERROR1("Bad volume handle!", "Index", Index)
+
+        /* We have a bad handle.  Clean up ReturnValue. */
+        *Error_Code = LVM_ENGINE_BAD_HANDLE;
+
+        free(ReturnValue.Volume_Information_Data);
+        ReturnValue.Volume_Information_Data = NULL;
+        ReturnValue.Count = 0;
+
+        API_EXIT("Get_Volume_Information_Array")
+
+        return ReturnValue;
+
+      }
+
+      Set_Volume_Information_Record( &( ReturnValue.Volume_Information_Data[ReturnValue.Count] ), (Volume_Data *) Object, Error_Code );
+
+      ReturnValue.Count++;
+
+    }
+
+  }
+  else
+  {
+
+    /* Now copy the data for each volume in the Volumes list. */
+    DLIST_FOREACH( Volumes, Volume_Handle )
+    {
+
+#ifdef DEBUG
+
+#ifdef PARANOID
+
+      assert( DLIST_HANDLE_TAG( Volume_Handle ) == VOLUME_DATA_TAG );
+
+#endif
+
+#endif
+
+      Set_Volume_Information_Record( &( ReturnValue.Volume_Information_Data[ReturnValue.Count] ), (Volume_Data *) DLIST_HANDLE_OBJECT( Volume_Handle ), Error_Code );
+
+      ReturnValue.Count++;
+
+    }
 
+  }
+
+  /* All done!  Indicate success and return what we found. */
   *Error_Code = LVM_ENGINE_NO_ERROR;
 
-  API_EXIT("Get_Volume_Information")
+  API_EXIT("Get_Volume_Information_Array")
 
   return ReturnValue;
 
@@ -4316,7 +4493,7 @@ void Expand_Volume ( ADDRESS         Volume_Handle,
 
   /* Now that we have the features on the volume, sort them by their Feature Sequence Number.  This will ensure that
      they will be applied to the new partitions in the correct order.                                                 */
-  SortList(Features_List, &Sort_By_Feature_Sequence_Number, Error_Code);
+  SortListByKey(Features_List, &Feature_Sequence_Number_Key, Error_Code);
   if ( *Error_Code != DLIST_SUCCESS )
   {
 
@@ -7099,6 +7276,9 @@ static void _System Find_Potential_Volumes(ADDRESS Object, TAG ObjectTag, CARDIN
       /* Now save the LVM Signature Sector. */
       memcpy(PartitionRecord->Signature_Sector, &Buffer, BYTES_PER_SECTOR);
 
+      /* Let the Partition Manager know what is on disk so that an unchanged LVM Signature Sector is not written back. */
+      Remember_Metadata_Sector(PartitionRecord->Drive_Index, PartitionRecord->Starting_Sector + PartitionRecord->Partition_Size - 1, &Buffer);
+
       /* Establish access to the LVM Signature Sector. */
       Signature_Sector = PartitionRecord->Signature_Sector;
 
@@ -7352,34 +7532,41 @@ static void _System Destroy_Embedded_Lists(ADDRESS Object, TAG ObjectTag, CARDIN
 
 /*********************************************************************/
 /*                                                                   */
-/*   Function Name:                                                  */
+/*   Function Name: Drive_Letter_Preference_Key                      */
 /*                                                                   */
-/*   Descriptive Name:                                               */
+/*   Descriptive Name: Returns the drive letter preference of a      */
+/*                     volume as a sort key for SortListByKey.       */
 /*                                                                   */
-/*   Input:                                                          */
+/*   Input: ADDRESS Object : The Volume_Data of the volume.          */
+/*          TAG ObjectTag : Should be VOLUME_DATA_TAG.               */
+/*          CARDINAL32 ObjectSize : Not used.                        */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
 /*                                                                   */
-/*   Output:                                                         */
+/*   Output: The sort key.  Keys compare in the same order as        */
+/*           the drive letters they were made from.                  */
 /*                                                                   */
-/*   Error Handling:                                                 */
+/*   Error Handling: *Error is set to DLIST_CORRUPTED if ObjectTag   */
+/*                   is not what it should be.                       */
 /*                                                                   */
 /*   Side Effects:  None.                                            */
 /*                                                                   */
-/*   Notes:  None.                                                   */
+/*   Notes: Used to group volumes with the same drive letter         */
+/*          preference together in the Volumes list.                 */
 /*                                                                   */
 /*********************************************************************/
-static INTEGER32 _System Sort_By_Drive_Letter_Preference( ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag, CARDINAL32 * Error)
+static CARDINAL32 _System Drive_Letter_Preference_Key( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, CARDINAL32 * Error)
 {
 
-  /* Declare local variables so that we can access the Volume_Data objects without having to typecast each time. */
-  Volume_Data *    Volume1 = (Volume_Data *) Object1;
-  Volume_Data *    Volume2 = (Volume_Data *) Object2;
+  /* Declare a local variable so that we can access the Volume_Data object without having to typecast each time. */
+  Volume_Data *    VolumeRecord = (Volume_Data *) Object;
 
-  FUNCTION_ENTRY("Sort_By_Drive_Letter_Preference")
+  FUNCTION_ENTRY("Drive_Letter_Preference_Key")
 
 #ifdef DEBUG
 
-  /* Are Object1 and Object2 what we think it should be? */
-  if ( ( Object1Tag != VOLUME_DATA_TAG ) || ( Object2Tag != VOLUME_DATA_TAG ) )
+  /* Is Object what we think it should be? */
+  if ( ObjectTag != VOLUME_DATA_TAG )
   {
 
 
@@ -7393,7 +7580,7 @@ static INTEGER32 _System Sort_By_Drive_Letter_Preference( ADDRESS Object1, TAG O
     /* We have a TAG that is not what we expected!  Abort! */
     *Error = DLIST_CORRUPTED;
 
-    FUNCTION_EXIT("Sort_By_Drive_Letter_Preference")
+    FUNCTION_EXIT("Drive_Letter_Preference_Key")
 
     return 0;
 
@@ -7404,33 +7591,10 @@ static INTEGER32 _System Sort_By_Drive_Letter_Preference( ADDRESS Object1, TAG O
   /* Assume success. */
   *Error = DLIST_SUCCESS;
 
-  /* Well, the Object Tags look OK, so lets get to it. */
-
-  /* Is Volume1 < Volume2? */
-  if ( Volume1->Drive_Letter_Preference < Volume2->Drive_Letter_Preference )
-  {
-
-    FUNCTION_EXIT("Sort_By_Drive_Letter_Preference")
-
-    return -1;
-
-  }
-
-  /* Is Volume1 > Volume2? */
-  if ( Volume1->Drive_Letter_Preference > Volume2->Drive_Letter_Preference )
-  {
-
-    FUNCTION_EXIT("Sort_By_Drive_Letter_Preference")
+  FUNCTION_EXIT("Drive_Letter_Preference_Key")
 
-    return 1;
-
-  }
-
-  /* They must be equal! */
-
-  FUNCTION_EXIT("Sort_By_Drive_Letter_Preference")
-
-  return 0;
+  /* Offset the drive letter by CHAR_MIN so that the keys sort the same way the drive letters themselves do. */
+  return (CARDINAL32) ( (INTEGER32) VolumeRecord->Drive_Letter_Preference - CHAR_MIN );
 
 }
 
@@ -9807,40 +9971,45 @@ static void _System Extend_FS(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSi
 
 /*********************************************************************/
 /*                                                                   */
-/*   Function Name:                                                  */
+/*   Function Name: Current_Drive_Letter_Key                         */
 /*                                                                   */
-/*   Descriptive Name:                                               */
+/*   Descriptive Name: Returns the current drive letter of a volume  */
+/*                     as a sort key for SortListByKey.              */
 /*                                                                   */
-/*   Input:                                                          */
+/*   Input: ADDRESS Object : The Volume_Data of the volume.          */
+/*          TAG ObjectTag : Should be VOLUME_DATA_TAG.               */
+/*          CARDINAL32 ObjectSize : Not used.                        */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
 /*                                                                   */
-/*   Output:                                                         */
+/*   Output: The sort key.  Keys compare in the same order as        */
+/*           the drive letters they were made from.                  */
 /*                                                                   */
-/*   Error Handling:                                                 */
+/*   Error Handling: *Error is set to DLIST_CORRUPTED if ObjectTag   */
+/*                   is not what it should be.                       */
 /*                                                                   */
 /*   Side Effects:  None.                                            */
 /*                                                                   */
-/*   Notes:  None.                                                   */
+/*   Notes: Some volumes may not have a current drive letter         */
+/*          yet (i.e. they could be new volumes ), so their          */
+/*          drive letter preference is used instead.                 */
 /*                                                                   */
 /*********************************************************************/
-static INTEGER32 _System Sort_By_Current_Drive_Letter( ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag, CARDINAL32 * Error)
+static CARDINAL32 _System Current_Drive_Letter_Key( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, CARDINAL32 * Error)
 {
 
-  /* Declare local variables so that we can access the Volume_Data objects without having to typecast each time. */
-  Volume_Data *    Volume1 = (Volume_Data *) Object1;
-  Volume_Data *    Volume2 = (Volume_Data *) Object2;
+  /* Declare a local variable so that we can access the Volume_Data object without having to typecast each time. */
+  Volume_Data *    VolumeRecord = (Volume_Data *) Object;
 
-  /* Some volumes may not have a current drive letter yet (i.e. they could be new volumes ), so we must use
-     their drive letter preference here instead.  Declare local variables so that we can hold the drive
-     letters we actually intend to use for the comparisons.                                                   */
-  char             Drive_Letter1;
-  char             Drive_Letter2;
+  /* The drive letter we actually intend to use for the key. */
+  char             Drive_Letter;
 
-  FUNCTION_ENTRY("Sort_By_Current_Drive_Letter")
+  FUNCTION_ENTRY("Current_Drive_Letter_Key")
 
 #ifdef DEBUG
 
-  /* Are Object1 and Object2 what we think it should be? */
-  if ( ( Object1Tag != VOLUME_DATA_TAG ) || ( Object2Tag != VOLUME_DATA_TAG ) )
+  /* Is Object what we think it should be? */
+  if ( ObjectTag != VOLUME_DATA_TAG )
   {
 
 
@@ -9854,7 +10023,7 @@ static INTEGER32 _System Sort_By_Current_Drive_Letter( ADDRESS Object1, TAG Obje
     /* We have a TAG that is not what we expected!  Abort! */
     *Error = DLIST_CORRUPTED;
 
-    FUNCTION_EXIT("Sort_By_Current_Drive_Letter")
+    FUNCTION_EXIT("Current_Drive_Letter_Key")
 
     return 0;
 
@@ -9865,45 +10034,16 @@ static INTEGER32 _System Sort_By_Current_Drive_Letter( ADDRESS Object1, TAG Obje
   /* Assume success. */
   *Error = DLIST_SUCCESS;
 
-  /* Well, the Object Tags look OK, so lets get to it. */
-
-  /* Extract the drive letter used to represent Volume1. */
-  if ( Volume1->Current_Drive_Letter == 0 )
-    Drive_Letter1 = Volume1->Drive_Letter_Preference;
-  else
-    Drive_Letter1 = Volume1->Current_Drive_Letter;
-
-  /* Extract the drive letter used to represent Volume2. */
-  if ( Volume2->Current_Drive_Letter == 0 )
-    Drive_Letter2 = Volume2->Drive_Letter_Preference;
+  /* Extract the drive letter used to represent the volume. */
+  if ( VolumeRecord->Current_Drive_Letter == 0 )
+    Drive_Letter = VolumeRecord->Drive_Letter_Preference;
   else
-    Drive_Letter2 = Volume2->Current_Drive_Letter;
-
-  /* Is Volume1 < Volume2? */
-  if ( Drive_Letter1 < Drive_Letter2 )
-  {
+    Drive_Letter = VolumeRecord->Current_Drive_Letter;
 
-    FUNCTION_EXIT("Sort_By_Current_Drive_Letter")
+  FUNCTION_EXIT("Current_Drive_Letter_Key")
 
-    return -1;
-
-  }
-
-  /* Is Volume1 > Volume2? */
-  if ( Drive_Letter1 > Drive_Letter2 )
-  {
-
-    FUNCTION_EXIT("Sort_By_Current_Drive_Letter")
-
-    return 1;
-
-  }
-
-  /* They must be equal! */
-
-  FUNCTION_EXIT("Sort_By_Current_Drive_Letter")
-
-  return 0;
+  /* Offset the drive letter by CHAR_MIN so that the keys sort the same way the drive letters themselves do. */
+  return (CARDINAL32) ( (INTEGER32) Drive_Letter - CHAR_MIN );
 
 }
 
@@ -11640,36 +11780,41 @@ static void _System Set_Feature_Index(ADDRESS Object, TAG ObjectTag, CARDINAL32
 
 /*********************************************************************/
 /*                                                                   */
-/*   Function Name:                                                  */
+/*   Function Name: Partition_Feature_ID_Key                         */
 /*                                                                   */
-/*   Descriptive Name:                                               */
+/*   Descriptive Name: Returns the ID of the feature indicated by    */
+/*                     the Feature_Index of a partition as a sort    */
+/*                     key for SortListByKey.                        */
 /*                                                                   */
-/*   Input:                                                          */
+/*   Input: ADDRESS Object : The Partition_Data of the               */
+/*                           partition.                              */
+/*          TAG ObjectTag : Should be PARTITION_DATA_TAG.            */
+/*          CARDINAL32 ObjectSize : Not used.                        */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
 /*                                                                   */
-/*   Output:                                                         */
+/*   Output: The feature ID.                                         */
 /*                                                                   */
-/*   Error Handling:                                                 */
+/*   Error Handling: *Error is set to DLIST_CORRUPTED if ObjectTag   */
+/*                   is not what it should be.                       */
 /*                                                                   */
 /*   Side Effects:  None.                                            */
 /*                                                                   */
-/*   Notes:  None.                                                   */
+/*   Notes: None.                                                    */
 /*                                                                   */
 /*********************************************************************/
-static INTEGER32 _System Sort_Partition_List_By_Feature_ID( ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag, CARDINAL32 * Error)
+static CARDINAL32 _System Partition_Feature_ID_Key( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, CARDINAL32 * Error)
 {
 
-  /* Declare local variables so that we can access the Partition_Data objects without having to typecast each time. */
-  Partition_Data *    Partition1 = (Partition_Data *) Object1;
-  Partition_Data *    Partition2 = (Partition_Data *) Object2;
+  /* Declare a local variable so that we can access the Partition_Data object without having to typecast each time. */
+  Partition_Data *    PartitionRecord = (Partition_Data *) Object;
 
-  FUNCTION_ENTRY("Sort_Partition_List_By_Feature_ID")
+  FUNCTION_ENTRY("Partition_Feature_ID_Key")
 
 #ifdef DEBUG
 
-  /* Are Object1 and Object2 what we think they should be? */
-  if ( ( Object1Tag != PARTITION_DATA_TAG ) ||
-       ( Object2Tag != PARTITION_DATA_TAG )
-     )
+  /* Is Object what we think it should be? */
+  if ( ObjectTag != PARTITION_DATA_TAG )
   {
 
 
@@ -11683,7 +11828,7 @@ static INTEGER32 _System Sort_Partition_List_By_Feature_ID( ADDRESS Object1, TAG
     /* We have a TAG that is not what we expected!  Abort! */
     *Error = DLIST_CORRUPTED;
 
-    FUNCTION_EXIT("Sort_Partition_List_By_Feature_ID")
+    FUNCTION_EXIT("Partition_Feature_ID_Key")
 
     return 0;
 
@@ -11694,33 +11839,9 @@ static INTEGER32 _System Sort_Partition_List_By_Feature_ID( ADDRESS Object1, TAG
   /* Assume success. */
   *Error = DLIST_SUCCESS;
 
-  /* Well, the Object Tags look OK, so lets get to it. */
-
-  /* Is Partition1 < Partition2? */
-  if ( Partition1->Signature_Sector->LVM_Feature_Array[Partition1->Feature_Index].Feature_ID < Partition2->Signature_Sector->LVM_Feature_Array[Partition2->Feature_Index].Feature_ID )
-  {
-
-    FUNCTION_EXIT("Sort_Partition_List_By_Feature_ID")
-
-    return -1;
-
-  }
-
-  /* Is Partition1 > Partition2? */
-  if ( Partition1->Signature_Sector->LVM_Feature_Array[Partition1->Feature_Index].Feature_ID > Partition2->Signature_Sector->LVM_Feature_Array[Partition2->Feature_Index].Feature_ID )
-  {
-
-    FUNCTION_EXIT("Sort_Partition_List_By_Feature_ID")
-
-    return 1;
-
-  }
-
-  /* They must be equal! */
+  FUNCTION_EXIT("Partition_Feature_ID_Key")
 
-  FUNCTION_EXIT("Sort_Partition_List_By_Feature_ID")
-
-  return 0;
+  return PartitionRecord->Signature_Sector->LVM_Feature_Array[PartitionRecord->Feature_Index].Feature_ID;
 
 }
 
@@ -12030,7 +12151,7 @@ static void _System Process_Potential_Volumes(ADDRESS Object, TAG ObjectTag, CAR
     }
 
     /* Sort the Partition List using the feature ID indicated by Feature_Index. */
-    SortList(Potential_Volume->Partition_List, &Sort_Partition_List_By_Feature_ID, Error);
+    SortListByKey(Potential_Volume->Partition_List, &Partition_Feature_ID_Key, Error);
     if ( *Error != DLIST_SUCCESS )
     {
 
@@ -12116,7 +12237,7 @@ static void _System Process_Potential_Volumes(ADDRESS Object, TAG ObjectTag, CAR
 
         /* Get the function table associated with this feature. */
         Search_Data.Feature_ID = Current_Feature_ID;
-        ForEachItem(Available_Features, &Find_Feature_Given_ID, &Search_Data, TRUE, Error);
+        Find_Feature_By_ID(&Search_Data, Error);
         if ( *Error != DLIST_SUCCESS )
         {
 
@@ -12250,7 +12371,7 @@ static void _System Process_Potential_Volumes(ADDRESS Object, TAG ObjectTag, CAR
       {
 
         /* Sort the partition list by feature ID. */
-        SortList(Potential_Volume->Partition_List, &Sort_Partition_List_By_Feature_ID, Error);
+        SortListByKey(Potential_Volume->Partition_List, &Partition_Feature_ID_Key, Error);
         if ( *Error != DLIST_SUCCESS )
         {
 
@@ -12591,7 +12712,7 @@ static BOOLEAN Feature_List_Is_Bogus( CARDINAL32 Feature_Count, LVM_Feature_Spec
     /* We must find the Feature which has the specified Feature ID. */
     Find_Feature_Data.Feature_ID = FeaturesToUse[Current_Feature].Feature_ID;
     Find_Feature_Data.Function_Table = NULL;
-    ForEachItem(Available_Features, &Find_Feature_Given_ID,&Find_Feature_Data,TRUE, Error_Code);
+    Find_Feature_By_ID(&Find_Feature_Data, Error_Code);
     if ( *Error_Code != DLIST_SUCCESS )
     {
 
@@ -13263,7 +13384,7 @@ Feature_Information_Array _System Get_Volume_Features( Volume_Data * VolumeRecor
 
   /* Now that we have the features on the volume, sort them by their Feature Sequence Number.  This will ensure that
      they will be applied to the new partitions in the correct order.                                                 */
-  SortList(Features_List, &Sort_By_Feature_Sequence_Number, Error_Code);
+  SortListByKey(Features_List, &Feature_Sequence_Number_Key, Error_Code);
   if ( *Error_Code != DLIST_SUCCESS )
   {
 
@@ -14639,3 +14760,75 @@ static void _System Check_Feature_List_For_Conversion(ADDRESS Object, TAG Object
 
 }
 
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Set_Volume_Information_Record                    */
+/*                                                                   */
+/*   Descriptive Name: Fills in a Volume_Information_Record from the */
+/*                     Volume_Data for a volume.                     */
+/*                                                                   */
+/*   Input: Volume_Information_Record * Volume_Information - The     */
+/*                                   record to fill in.              */
+/*          Volume_Data * VolumeRecord - The volume whose information*/
+/*                                       is to be placed in          */
+/*                                       Volume_Information.         */
+/*          CARDINAL32 * Error_Code - The address of a CARDINAL32 in */
+/*                                    which to store an error code   */
+/*                                    should an error occur.         */
+/*                                                                   */
+/*   Output: *Volume_Information is filled in.                       */
+/*                                                                   */
+/*   Error Handling: None.  *Error_Code is used by the checks for a  */
+/*                   startable or bootable volume, and the result of */
+/*                   those checks is all that is kept.               */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  Used by Get_Volume_Information and                      */
+/*           Get_Volume_Information_Array.                           */
+/*                                                                   */
+/*********************************************************************/
+static void Set_Volume_Information_Record( Volume_Information_Record * Volume_Information, Volume_Data * VolumeRecord, CARDINAL32 * Error_Code )
+{
+
+  FUNCTION_ENTRY("Set_Volume_Information_Record")
+
+  Volume_Information->Volume_Size = VolumeRecord->Volume_Size;
+  Volume_Information->Compatibility_Volume = VolumeRecord->Compatibility_Volume;
+  Volume_Information->Partition_Count = VolumeRecord->Partition_Count;
+  Volume_Information->Drive_Letter_Conflict = VolumeRecord->Drive_Letter_Conflict;
+  Volume_Information->Drive_Letter_Preference = VolumeRecord->Drive_Letter_Preference;
+  Volume_Information->Current_Drive_Letter = VolumeRecord->Current_Drive_Letter;
+  Volume_Information->Initial_Drive_Letter = VolumeRecord->Initial_Drive_Letter;
+  strncpy(Volume_Information->Volume_Name, VolumeRecord->Volume_Name,VOLUME_NAME_SIZE);
+  strncpy(Volume_Information->File_System_Name, VolumeRecord->File_System_Name,FILESYSTEM_NAME_SIZE);
+  Volume_Information->Status = 0;
+  Volume_Information->Bootable = FALSE;
+  Volume_Information->New_Volume = VolumeRecord->New_Volume;
+
+  /* If this volume represents a non-lvm device, then it is, by definition, not Bootable.  If it represents an LVM controlled
+     device, then it may be bootable and we will have to check.                                                                */
+  if ( ( VolumeRecord->Device_Type == LVM_HARD_DRIVE ) || ( VolumeRecord->Device_Type == LVM_PRM ) )
+  {
+
+    /* Is this volume marked installable and we are at install time? */
+    if ( ( Install_Volume_Handle == VolumeRecord->Volume_Handle ) && ( Min_Install_Size > 0 ) )
+      Volume_Information->Status = 3;
+    else
+      if ( Is_Volume_Startable(VolumeRecord,FALSE, Error_Code) )      /* Is this volume startable? */
+          Volume_Information->Status = 2;
+      else
+        if ( Is_Volume_Bootable(VolumeRecord, FALSE, Error_Code) )    /* Is this volume bootable? */
+          Volume_Information->Status = 1;
+
+    /* Is the volume bootable? */
+    Volume_Information->Bootable = ( Volume_Information->Status != 0 );
+
+  }
+
+  FUNCTION_EXIT("Set_Volume_Information_Record")
+
+  return;
+
+}
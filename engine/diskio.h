@@ -31,11 +31,28 @@
  *            void       GetDriveGeometry
  *            void       ReadSectors
  *            void       WriteSectors
+ *            void       ReadSectorsV
+ *            void       WriteSectorsV
+ *            void       SubmitSectorIO
+ *            Sector_IO_Request * ReapSectorIO
+ *            void       FlushSectorCache
+ *            void       SetSectorCacheSize
+ *            void       GetSectorCacheStatistics
  *
  * Description: This module provides an LBA based means of reading and writing
  *              to the various disk drives in the system.
  *
- * Notes: This module is single threaded and is not reentrant.
+ * Notes: This module is single threaded and is not reentrant.  SubmitSectorIO
+ *        and ReapSectorIO allow more than one request to be outstanding at a
+ *        time, but they must be called from the same thread as the rest of
+ *        this module.
+ *
+ *        ReadSectors, WriteSectors, ReadSectorsV and WriteSectorsV go
+ *        through a write-back cache of sectors kept for each drive.
+ *        Writes are held in the cache until FlushSectorCache is called,
+ *        or until the cache needs the space, so callers must flush the
+ *        cache before depending upon data being on disk.  Rediscover
+ *        and CloseDrives flush the cache themselves.
  *
  */
 
@@ -90,6 +107,38 @@ typedef struct _DDI_Rediscover_data
 #define DISKIO_BAD_GEOMETRY         10
 #define DISKIO_UNEXPECTED_OS_ERROR  11
 #define DISKIO_INTERNAL_ERROR       12
+#define DISKIO_NO_IO_OUTSTANDING    13
+
+/* The following structure describes a request for SubmitSectorIO.  The caller owns the structure, and it must remain valid, along
+   with the buffer it points to, until ReapSectorIO has returned it.  While a request is outstanding, the DiskIO module uses the
+   Next field, and the caller must not alter any of the fields in the request.                                                      */
+typedef struct _Sector_IO_Request {
+                                     CARDINAL32                    Drive_Number;     /* The number of the drive to use.  Drives are numbered from 1 to n. */
+                                     LBA                           Starting_Sector;  /* The first sector to read from/write to. */
+                                     CARDINAL32                    Sector_Count;     /* The number of sectors to transfer. */
+                                     ADDRESS                       Buffer;           /* The location to get/put the data. */
+                                     ADDRESS                       User_Data;        /* For use by the caller.  Not used by the DiskIO module. */
+                                     CARDINAL32                    Error;            /* Set to a DISKIO error code when the request completes. */
+                                     BOOLEAN                       Write;            /* If TRUE, the request is a write.  If FALSE, it is a read. */
+                                     struct _Sector_IO_Request *   Next;             /* Reserved for use by the DiskIO module. */
+                                   } Sector_IO_Request;
+
+/* The following structure holds the counters returned by GetSectorCacheStatistics. */
+typedef struct _Sector_Cache_Statistics {
+                                           CARDINAL32   Capacity;           /* The most sectors which may be cached for each drive. */
+                                           CARDINAL32   Cached_Sectors;     /* The number of sectors currently in the cache. */
+                                           CARDINAL32   Dirty_Sectors;      /* The number of cached sectors which have not been written to disk. */
+                                           CARDINAL32   Hits;               /* The number of sectors read which were found in the cache. */
+                                           CARDINAL32   Misses;             /* The number of sectors read which had to be read from disk. */
+                                           CARDINAL32   Sectors_Written;    /* The number of dirty sectors written to disk by the cache. */
+                                         } Sector_Cache_Statistics;
+
+/* The following structure describes one piece of a request for ReadSectorsV or WriteSectorsV. */
+typedef struct _Sector_IO_Segment {
+                                     LBA          Starting_Sector;  /* The first sector to read from/write to. */
+                                     CARDINAL32   Sector_Count;     /* The number of sectors to transfer. */
+                                     ADDRESS      Buffer;           /* The location to get/put the data. */
+                                   } Sector_IO_Segment;
 
 
 /*********************************************************************/
@@ -134,7 +183,8 @@ BOOLEAN OpenDrives( CARDINAL32 * Error );
 /*                                                                   */
 /*   Output: None.                                                   */
 /*                                                                   */
-/*   Error Handling: N/A                                             */
+/*   Error Handling: If the sectors held in the sector cache can not */
+/*                   be written to disk, the failure is logged.      */
 /*                                                                   */
 /*   Side Effects: All drive handles opened by OpenDrives are closed.*/
 /*                 All memory allocated by OpenDrives is released.   */
@@ -366,6 +416,261 @@ void WriteSectors ( CARDINAL32   Drive_Number,
                     CARDINAL32 * Error);
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: ReadSectorsV                                     */
+/*                                                                   */
+/*   Descriptive Name: This function reads several groups of sectors */
+/*                     from the specified drive, placing each group  */
+/*                     in its own buffer.                            */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the hard drive to*/
+/*                                    read from.  The drives in the  */
+/*                                    system are numbered from 1 to  */
+/*                                    n, where n is the total number */
+/*                                    of hard drives in the system.  */
+/*          Sector_IO_Segment * Segments : An array of segments, each*/
+/*                                         giving the sectors to read*/
+/*                                         and where to put them.    */
+/*          CARDINAL32 Segment_Count : The number of entries in      */
+/*                                     Segments.                     */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If Successful, then the data for each segment will be   */
+/*              placed in that segment's buffer, and *Error will be  */
+/*              0.                                                   */
+/*           If Unsuccessful, then *Error will be > 0 and the        */
+/*              contents of the segment buffers are undefined.       */
+/*                                                                   */
+/*   Error Handling: If any segment is out of range, nothing is read.*/
+/*                   *Error will be > 0 if an error occurs.          */
+/*                                                                   */
+/*   Side Effects: Data may be read into the segment buffers.        */
+/*                                                                   */
+/*   Notes:  Segments are processed in the order given.  A segment   */
+/*           which starts where the previous one ended is combined   */
+/*           with it into a single transfer, so callers should list  */
+/*           segments in ascending LBA order where possible.         */
+/*                                                                   */
+/*********************************************************************/
+void ReadSectorsV ( CARDINAL32          Drive_Number,
+                    Sector_IO_Segment * Segments,
+                    CARDINAL32          Segment_Count,
+                    CARDINAL32 *        Error);
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: WriteSectorsV                                    */
+/*                                                                   */
+/*   Descriptive Name: This function writes several groups of sectors*/
+/*                     to the specified drive, taking the data for   */
+/*                     each group from its own buffer.               */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the hard drive to*/
+/*                                    write to.  The drives in the   */
+/*                                    system are numbered from 1 to  */
+/*                                    n, where n is the total number */
+/*                                    of hard drives in the system.  */
+/*          Sector_IO_Segment * Segments : An array of segments, each*/
+/*                                         giving the sectors to     */
+/*                                         write and where the data  */
+/*                                         for them is.              */
+/*          CARDINAL32 Segment_Count : The number of entries in      */
+/*                                     Segments.                     */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If Successful, then the data for every segment will have*/
+/*              been written to disk, and *Error will be 0.          */
+/*           If Unsuccessful, then *Error will be > 0.  Segments     */
+/*              before the one which failed have been written.  The  */
+/*              segment which failed, and those after it, are in an  */
+/*              undefined state.                                     */
+/*                                                                   */
+/*   Error Handling: If any segment is out of range, nothing is      */
+/*                   written.  *Error will be > 0 if an error occurs.*/
+/*                                                                   */
+/*   Side Effects: Data may be written to disk.                      */
+/*                                                                   */
+/*   Notes:  Segments are processed in the order given.  A segment   */
+/*           which starts where the previous one ended is combined   */
+/*           with it into a single transfer, so callers should list  */
+/*           segments in ascending LBA order where possible.         */
+/*                                                                   */
+/*********************************************************************/
+void WriteSectorsV ( CARDINAL32          Drive_Number,
+                     Sector_IO_Segment * Segments,
+                     CARDINAL32          Segment_Count,
+                     CARDINAL32 *        Error);
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: SubmitSectorIO                                   */
+/*                                                                   */
+/*   Descriptive Name: This function starts a read or write of one or*/
+/*                     more sectors and returns without waiting for  */
+/*                     the transfer to complete.                     */
+/*                                                                   */
+/*   Input: Sector_IO_Request * Request : The request to start.  All */
+/*                                        fields except User_Data,   */
+/*                                        Error and Next must be set.*/
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If the request was accepted, *Error will be 0 and the   */
+/*           request will be returned by a later call to             */
+/*           ReapSectorIO.  If the request was not accepted, *Error  */
+/*           will be > 0 and the request will never be returned by   */
+/*           ReapSectorIO.                                           */
+/*                                                                   */
+/*   Error Handling: Requests which are out of range are rejected    */
+/*                   here.  Errors which occur during the transfer   */
+/*                   are reported in the Error field of the request  */
+/*                   when it is reaped.                              */
+/*                                                                   */
+/*   Side Effects: Data may be read into memory starting at the      */
+/*                 request's Buffer, or data may be written from the */
+/*                 request's Buffer to disk.                         */
+/*                                                                   */
+/*   Notes:  Requests may complete in any order.  There is no        */
+/*           ordering between an outstanding request and a call to   */
+/*           ReadSectors or WriteSectors, or between two outstanding */
+/*           requests, which touch the same sectors.                 */
+/*                                                                   */
+/*********************************************************************/
+void SubmitSectorIO( Sector_IO_Request * Request, CARDINAL32 * Error );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: ReapSectorIO                                     */
+/*                                                                   */
+/*   Descriptive Name: This function returns a request started by    */
+/*                     SubmitSectorIO once it has completed.         */
+/*                                                                   */
+/*   Input: BOOLEAN Wait : If TRUE, and there are outstanding        */
+/*                         requests but none have completed, then    */
+/*                         this function will wait for one to        */
+/*                         complete.  If FALSE, this function will   */
+/*                         not wait.                                 */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If a request has completed, the function return value   */
+/*           is the address of that request, its Error field holds   */
+/*           the result of the transfer, and *Error will be 0.  If no*/
+/*           request has completed and Wait is FALSE, the function   */
+/*           return value is NULL and *Error will be 0.  If there are*/
+/*           no outstanding requests, the function return value is   */
+/*           NULL and *Error will be DISKIO_NO_IO_OUTSTANDING.       */
+/*                                                                   */
+/*   Error Handling: *Error will be > 0 if an error occurs.          */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  CloseDrives waits for all outstanding requests to       */
+/*           complete.  Requests which have not been reaped by then  */
+/*           are discarded.                                          */
+/*                                                                   */
+/*********************************************************************/
+Sector_IO_Request * ReapSectorIO( BOOLEAN Wait, CARDINAL32 * Error );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: FlushSectorCache                                 */
+/*                                                                   */
+/*   Descriptive Name: This function writes any sectors which are    */
+/*                     held in the sector cache to disk.             */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the hard drive   */
+/*                                    whose cached sectors are to be */
+/*                                    written, or 0 for all drives.  */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If Successful, *Error will be 0.                        */
+/*           If Unsuccessful, then *Error will be > 0.               */
+/*                                                                   */
+/*   Error Handling: If the cached sectors for a drive can not be    */
+/*                   written, they are discarded so that later reads */
+/*                   return what is actually on the disk.            */
+/*                                                                   */
+/*   Side Effects: Data may be written to disk.                      */
+/*                                                                   */
+/*   Notes:  The sectors for each drive are written in ascending LBA */
+/*           order, with adjacent sectors combined into a single     */
+/*           transfer where possible.                                */
+/*                                                                   */
+/*********************************************************************/
+void FlushSectorCache( CARDINAL32 Drive_Number, CARDINAL32 * Error );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: SetSectorCacheSize                               */
+/*                                                                   */
+/*   Descriptive Name: This function sets the number of sectors which*/
+/*                     may be held in the sector cache for each      */
+/*                     drive.                                        */
+/*                                                                   */
+/*   Input: CARDINAL32 Sectors_Per_Drive : The number of sectors to  */
+/*                                         cache for each drive.  0  */
+/*                                         turns the cache off.      */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If Successful, *Error will be 0.                        */
+/*           If Unsuccessful, then *Error will be > 0.               */
+/*                                                                   */
+/*   Error Handling: If cached sectors had to be written to disk to  */
+/*                   make the cache smaller, and the write failed,   */
+/*                   *Error will be > 0.  The new size is used       */
+/*                   regardless.                                     */
+/*                                                                   */
+/*   Side Effects: Sectors may be removed from the cache, and data   */
+/*                 may be written to disk.                           */
+/*                                                                   */
+/*   Notes:  This function may be called before OpenDrives.  The     */
+/*           size remains in effect until it is changed again.       */
+/*                                                                   */
+/*********************************************************************/
+void SetSectorCacheSize( CARDINAL32 Sectors_Per_Drive, CARDINAL32 * Error );
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: GetSectorCacheStatistics                         */
+/*                                                                   */
+/*   Descriptive Name: This function returns the size and hit/miss   */
+/*                     counters of the sector cache.                 */
+/*                                                                   */
+/*   Input: CARDINAL32 Drive_Number : The number of the hard drive to*/
+/*                                    report on, or 0 for the totals */
+/*                                    for all drives.                */
+/*          Sector_Cache_Statistics * Statistics : The location of a */
+/*                                    buffer to hold the counters.   */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: If Successful, *Statistics will be filled in and *Error */
+/*              will be 0.                                           */
+/*           If Unsuccessful, then *Error will be > 0.               */
+/*                                                                   */
+/*   Error Handling: *Error will be > 0 if an error occurs.          */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes:  The counters start from 0 each time OpenDrives is       */
+/*           called.                                                 */
+/*                                                                   */
+/*********************************************************************/
+void GetSectorCacheStatistics( CARDINAL32 Drive_Number, Sector_Cache_Statistics * Statistics, CARDINAL32 * Error );
+
+
 /*********************************************************************/
 /*                                                                   */
 /*   Function Name: Rediscover                                       */
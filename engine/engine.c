@@ -33,10 +33,12 @@
  *            void                     Close_LVM_Engine
  *            Drive_Control_Array      Get_Drive_Control_Data
  *            Drive_Information_Record Get_Drive_Status
+ *            Drive_Information_Array  Get_Drive_Status_Array
  *            void                     Set_Name
  *            CARDINAL32               Get_Valid_Options
  *            BOOLEAN                  Reboot_Required
  *            void                     Set_Min_Install_Size
+ *            void                     Set_Partition_Alignment
  *            void                     Start_Logging
  *            void                     Stop_Logging
  *            void                     Export_Configuration
@@ -79,6 +81,7 @@
 #define INCL_DOSMODULEMGR
 #include <os2.h>      /* DosError, FERR_DISABLEHARDERR */
 #include <stdlib.h>   /* malloc, free */
+#include <stddef.h>   /* offsetof */
 #include <string.h>   /* strncpy, strlen */
 #include <ctype.h>    /* toupper */
 #include <stdio.h>    /* sprintf */
@@ -88,7 +91,7 @@
 #include "engine.h"   /* Include engine.h to declare the global types and variables. */
 #include "gbltypes.h" /* CARDINAL32, BYTE, BOOLEAN, ADDRESS */
 #include "dlist.h"    /* CreateList, DestroyList, ForEachItem */
-#include "diskio.h"   /* OpenDrives, CloseDrives, GetDriveCount, GetDriveGeometry */
+#include "diskio.h"   /* OpenDrives, CloseDrives, GetDriveCount, GetDriveGeometry, FlushSectorCache */
 
 
 #include "LVM_Constants.h"   /* PARTITION_NAME_SIZE, VOLUME_NAME_SIZE, DISK_NAME_SIZE, BYTES_PER_SECTOR */
@@ -96,13 +99,13 @@
 #include "LVM_Interface.h"   /* Open_LVM_Engine, Close_LVM_Engine, Commit_Changes, Get_Drive_Control_Data,
                                 Export_Configuration, Get_Drive_Status, Get_Reboot_Flag, Get_Valid_Options,
                                 Reboot_Required, Set_Min_Install_Size, Set_Name, Set_Reboot_Flag, Start_Logging,
-                                Stop_Logging */
+                                Stop_Logging, Set_Partition_Alignment */
 
 #include "Handle_Manager.H" /* Initialize_Handle_Manager, Create_Handle, Destroy_Handle, Translate_Handle */
-#include "Partition_Manager.h" /* Initialize_Partition_Manager, Close_Partition_Manager, Discover_Partitions, Commit_Partition_Changes */
+#include "Partition_Manager.h" /* Initialize_Partition_Manager, Close_Partition_Manager, Discover_Partitions, Commit_Partition_Changes, Forget_Metadata_Sectors */
 #include "Volume_Manager.h"    /* Initialize_Volume_Manger, Close_Volume_Manager, Discover_Volumes, Commit_Volume_Changes */
 #include "BootManager.h"       /* Discover_Boot_Manager */
-#include "CRC.H"               /* Build_CRC_Table, CalculateCRC, INITIAL_CRC */
+#include "CRC.H"               /* Build_CRC_Table, CalculateCRC, PatchCRC, INITIAL_CRC */
 #include "logging.h"           /* Log_Current_Configuration, Write_Log_Buffer, Logging_Enabled */
 #include "lvm_plug.h"          /* LVM_Plugin_DLL_Interface, LVM_Common_Services_V1, Plugin_Function_Table_V1, PLUGIN_FUNCTION_TABLE_V1_TAG */
 #include "Bad_Block_Relocation.h"
@@ -140,6 +143,13 @@ typedef struct _Find_And_Parse_Record {
                                         CARDINAL32                        * Error_Code;
                                       } Find_And_Parse_Record;
 
+/* The following structure describes the start of each sector in a multi-sector table of feature data.  See Validate_Feature_Sectors. */
+typedef struct _Feature_Sector_Header {
+                                        CARDINAL32     Signature;
+                                        CARDINAL32     CRC;
+                                        CARDINAL32     Sequence_Number;
+                                      } Feature_Sector_Header;
+
 /*--------------------------------------------------
  * Private Global Variables.
  --------------------------------------------------*/
@@ -150,7 +160,6 @@ static BYTE       Kill_Sector[BYTES_PER_SECTOR];        /* Used to overwrite the
 /*--------------------------------------------------
  * Private functions.
  --------------------------------------------------*/
-static void      _System DetermineFreeSpace(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
 static void      _System Overwrite_Sectors(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
 static void      _System Close_All_Features(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
 static void      _System Assign_Serial_Numbers_And_Names(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
@@ -164,6 +173,9 @@ static void      _System Fill_Handle_Array(ADDRESS Object, TAG ObjectTag, CARDIN
 static INTEGER32 _System Sort_Plugins(ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag,CARDINAL32 * Error_Code);
 static void      _System Find_Feature_And_Parse(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
 static void      _System Free_Expansion_DLLs(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error);
+static BOOLEAN   _System Feature_ID_Key(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS * Key, CARDINAL32 * KeySize);
+static void      Set_Drive_Information_Record( Drive_Information_Record * Drive_Information, Disk_Drive_Data * Drive_Data, CARDINAL32 * Error_Code );
+static void      Transfer_Segment( Segment_Transfer * Segment, BOOLEAN Write );
 
 /*--------------------------------------------------
  * There are no additional public global variables
@@ -360,6 +372,23 @@ void _System Open_LVM_Engine2( BOOLEAN Ignore_CHS, LVM_Interface_Types Interface
 
   }
 
+  /* Index the Available_Features list by feature ID.  See Find_Feature_By_ID. */
+  CreateListIndex(Available_Features, &Feature_ID_Key, Error_Code);
+  if ( *Error_Code != DLIST_SUCCESS )
+  {
+
+    LOG_ERROR("LVM_ENGINE_OUT_OF_MEMORY.  Can't index the Available_Features list.")
+
+    DestroyList(&Available_Features, TRUE, &Ignore_Error);
+
+    API_EXIT( "Open_LVM_Engine" )
+
+    *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
+
+    return;
+
+  }
+
   /* Initialize the Filesystem_Expansion_DLLs list. */
   Filesystem_Expansion_DLLs = NULL;
   Filesystem_Expansion_DLLs = CreateList();
@@ -657,6 +686,12 @@ void _System Open_LVM_Engine2( BOOLEAN Ignore_CHS, LVM_Interface_Types Interface
     DriveArray[Index].Primary_Partition_Count = 0;
     DriveArray[Index].Logical_Partition_Count = 0;
 
+    /* The Partition Manager builds the free space index for the drive the first time it needs it. */
+    DriveArray[Index].Free_Space_Index = NULL;
+
+    /* The Partition Manager records the metadata sectors on the drive as it reads them. */
+    DriveArray[Index].Metadata_Table = NULL;
+
     /* Initialize the Drive_Serial_Number to 0 as that is currently not known.  That will be discovered when we start
        looking for partitions.  The same goes for the Drive_Name.                                                       */
     DriveArray[Index].Drive_Serial_Number = 0;
@@ -976,6 +1011,8 @@ BOOLEAN Commit_Changes( CARDINAL32 * Error_Code )
   CARDINAL32   Partition_Error = LVM_ENGINE_NO_ERROR;   /* Used to hold the error code from the Commit_Partition_Changes function. */
   CARDINAL32   Volume_Error = LVM_ENGINE_NO_ERROR;      /* Used to hold the error code from the Commit_Volume_Changes function. */
   CARDINAL32   Boot_Manager_Error = LVM_ENGINE_NO_ERROR;/* Used to hold the error code from the Commit_Boot_Manager_Changes function. */
+  CARDINAL32   Cache_Error = LVM_ENGINE_NO_ERROR;       /* Set to LVM_ENGINE_IO_ERROR if the DiskIO sector cache could not be flushed. */
+  CARDINAL32   Flush_Error;                             /* Used to hold the error code from the FlushSectorCache function. */
 
   CARDINAL32   Index;                                   /* Used to walk the drive array. */
 
@@ -1133,8 +1170,27 @@ BOOLEAN Commit_Changes( CARDINAL32 * Error_Code )
 
   }
 
+  /* The changes written above may still be sitting in the DiskIO sector cache.  Write them to disk now, one drive at a time, so that
+     we know which drives had I/O errors.                                                                                             */
+  for ( Index = 0; Index < DriveCount; Index++ )
+  {
+
+    FlushSectorCache( Index + 1, &Flush_Error );
+
+    if ( Flush_Error != DISKIO_NO_ERROR )
+    {
+
+      LOG_ERROR2("FlushSectorCache failed.", "Drive Number", Index + 1, "Error code", Flush_Error)
+
+      DriveArray[Index].IO_Error = TRUE;
+      Cache_Error = LVM_ENGINE_IO_ERROR;
+
+    }
+
+  }
+
   /* Were all of the changes committed successfully? */
-  if ( ( Partition_Error != LVM_ENGINE_NO_ERROR ) || ( Volume_Error != LVM_ENGINE_NO_ERROR ) || ( Boot_Manager_Error != LVM_ENGINE_NO_ERROR ) )
+  if ( ( Partition_Error != LVM_ENGINE_NO_ERROR ) || ( Volume_Error != LVM_ENGINE_NO_ERROR ) || ( Boot_Manager_Error != LVM_ENGINE_NO_ERROR ) || ( Cache_Error != LVM_ENGINE_NO_ERROR ) )
   {
 
     /* Was the error reported by the partition manager? */
@@ -1159,8 +1215,21 @@ BOOLEAN Commit_Changes( CARDINAL32 * Error_Code )
       else
       {
 
-        /* The error must have come from the Boot Manager.  Pass the error back to our caller. */
-        *Error_Code = Boot_Manager_Error;
+        /* Was the error reported by the Boot Manager? */
+        if ( Boot_Manager_Error != LVM_ENGINE_NO_ERROR )
+        {
+
+          /* Pass the error back to our caller. */
+          *Error_Code = Boot_Manager_Error;
+
+        }
+        else
+        {
+
+          /* The error must have come from flushing the sector cache.  Pass the error back to our caller. */
+          *Error_Code = Cache_Error;
+
+        }
 
       }
 
@@ -1707,58 +1776,193 @@ Drive_Information_Record Get_Drive_Status( ADDRESS Drive_Handle, CARDINAL32 * Er
   Drive_Data = (Disk_Drive_Data *) Object;
 
   /* Since the handle was good, lets get the data requested. */
+  Set_Drive_Information_Record( &ReturnValue, Drive_Data, Error_Code );
 
-  /* To get the Largest_Free_Block_Of_Sectors and the Total_Available_Sectors, we must run the list of partitions for the drive and determine these values. */
-  ForEachItem(Drive_Data->Partitions,&DetermineFreeSpace,&ReturnValue,TRUE,Error_Code);
+  /* Did we succeed? */
+  if ( *Error_Code != LVM_ENGINE_NO_ERROR )
+  {
 
-#ifdef DEBUG
+    API_EXIT( "Get_Drive_Status" )
 
-#ifdef PARANOID
+    return ReturnValue;
 
-  assert(*Error_Code == DLIST_SUCCESS);
+  }
 
-#else
+  LOG_EVENT3("Returning the following values:","Drive Index", Drive_Data->DriveArrayIndex, "Drive Name", ReturnValue.Drive_Name, "Largest block of freespace", ReturnValue.Largest_Free_Block_Of_Sectors)
 
-  /* Was the result successful? */
-  if ( *Error_Code != DLIST_SUCCESS )
+  LOG_EVENT3("Returning the following values:", "Total available sectors", ReturnValue.Total_Available_Sectors, "Corrupt Partition Table Flag", ReturnValue.Corrupt_Partition_Table, "I/O Error Flag", ReturnValue.IO_Error)
+
+  LOG_EVENT2("Returning the following values:", "Unusable Flag", ReturnValue.Unusable, "Is Big Floppy Flag", ReturnValue.Is_Big_Floppy )
+
+  API_EXIT( "Get_Drive_Status" )
+
+  /* Indicate success and return. */
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  return ReturnValue;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name:  Get_Drive_Status_Array                          */
+/*                                                                   */
+/*   Descriptive Name:  Returns the Drive_Information_Records for a  */
+/*                      group of drives in a single array.           */
+/*                                                                   */
+/*   Input: ADDRESS Drive_Handles[] - The handles of the drives to   */
+/*                             use.  If this is NULL, then the       */
+/*                             records for all of the drives are     */
+/*                             returned.                             */
+/*          CARDINAL32 Count - The number of entries in              */
+/*                             Drive_Handles.  This is ignored if    */
+/*                             Drive_Handles is NULL.                */
+/*          CARDINAL32 * Error_Code - The address of a CARDINAL32 in */
+/*                                    in which to store an error code*/
+/*                                    should an error occur.         */
+/*                                                                   */
+/*   Output: A Drive_Information_Array is returned.  If no errors    */
+/*           occur, the Nth entry of Drive_Information_Data will be  */
+/*           the record for the Nth entry of Drive_Handles, and      */
+/*           *Error_Code will be set to 0.  If an error does occur,  */
+/*           then *Error_Code will be non-zero.                      */
+/*                                                                   */
+/*   Error Handling:  If any entry of Drive_Handles is not the handle*/
+/*                    of a drive, *Error_Code will be                */
+/*                    LVM_ENGINE_BAD_HANDLE.  Any memory allocated   */
+/*                    for the return value will be freed, and the    */
+/*                    Drive_Information_Array returned will have a   */
+/*                    NULL Drive_Information_Data and a Count of 0.  */
+/*                                                                   */
+/*   Side Effects:  Memory for the returned array is allocated.      */
+/*                                                                   */
+/*   Notes:  This does the work of calling Get_Drive_Status for each */
+/*           handle, but with one entry into the engine and one      */
+/*           allocation.  When Drive_Handles is NULL, the records    */
+/*           are in the same order as the records returned by        */
+/*           Get_Drive_Control_Data.                                 */
+/*                                                                   */
+/*           The caller becomes responsible for the memory allocated */
+/*           for Drive_Information_Data, and should free it with     */
+/*           Free_Engine_Memory when they are done using it.         */
+/*                                                                   */
+/*********************************************************************/
+Drive_Information_Array Get_Drive_Status_Array( ADDRESS Drive_Handles[], CARDINAL32 Count, CARDINAL32 * Error_Code )
+{
+
+  Drive_Information_Array    ReturnValue;  /* The value returned by this function. */
+  Disk_Drive_Data *          Drive_Data;   /* Used to access the data for each drive. */
+  CARDINAL32                 Index;        /* Used to walk Drive_Handles or the DriveArray. */
+  ADDRESS                    Object;       /* Used when converting a drive handle into Drive_Data. */
+  TAG                        ObjectTag;    /* Used when converting a drive handle into Drive_Data. */
+
+  API_ENTRY( "Get_Drive_Status_Array" )
+
+  /* Initialize ReturnValue assuming failure. */
+  ReturnValue.Count = 0;
+  ReturnValue.Drive_Information_Data = NULL;
+
+  /* Has the Engine been opened yet? */
+  if ( DriveArray == NULL )
   {
 
-    LOG_ERROR1("ForEachItem failed while attempting to determine the largest free block of sectors and the total available sectors!","Error code", *Error_Code)
+    LOG_ERROR("The LVM Engine is NOT open!")
 
-    API_EXIT( "Get_Drive_Status" )
+    API_EXIT( "Get_Drive_Status_Array" )
 
-    /* Indicate an internal error! */
-    *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
+    /* The Engine has not been opened yet!  Nothing has been initialized yet, so we can not perform the function asked of us.  Abort. */
+    *Error_Code = LVM_ENGINE_NOT_OPEN;
 
-    /* Set the fields modified to 0 so that we return all 0's in ReturnValue. */
-    ReturnValue.Largest_Free_Block_Of_Sectors = 0;
-    ReturnValue.Total_Available_Sectors = 0;
+    return ReturnValue;
+
+  }
+
+  /* If we are to return all of the drives, then there is one record per entry in the DriveArray. */
+  if ( Drive_Handles == NULL )
+    Count = DriveCount;
+
+  /* If there is nothing to return, then we are done. */
+  if ( Count == 0 )
+  {
+
+    API_EXIT( "Get_Drive_Status_Array" )
+
+    *Error_Code = LVM_ENGINE_NO_ERROR;
 
-    /* Return to caller. */
     return ReturnValue;
 
   }
 
-#endif
+  /* Allocate memory for the Drive_Information_Data array in the ReturnValue. */
+  ReturnValue.Drive_Information_Data = ( Drive_Information_Record * ) malloc( Count * sizeof( Drive_Information_Record ) );
 
-#endif
+  /* Did we get the memory? */
+  if ( ReturnValue.Drive_Information_Data == NULL )
+  {
 
-  /* Copy the remaining data from the DriveArray to ReturnValue. */
-  strncpy( ReturnValue.Drive_Name , Drive_Data->Drive_Name, DISK_NAME_SIZE );
-  ReturnValue.Corrupt_Partition_Table = Drive_Data->Corrupt;
-  ReturnValue.IO_Error = Drive_Data->IO_Error;
-  ReturnValue.Unusable = Drive_Data->Unusable;
-  ReturnValue.Is_Big_Floppy = Drive_Data->Is_Big_Floppy;
+    LOG_ERROR("LVM_ENGINE_OUT_OF_MEMORY")
 
-  LOG_EVENT3("Returning the following values:","Drive Index", Drive_Data->DriveArrayIndex, "Drive Name", ReturnValue.Drive_Name, "Largest block of freespace", ReturnValue.Largest_Free_Block_Of_Sectors)
+    API_EXIT( "Get_Drive_Status_Array" )
 
-  LOG_EVENT3("Returning the following values:", "Total available sectors", ReturnValue.Total_Available_Sectors, "Corrupt Partition Table Flag", ReturnValue.Corrupt_Partition_Table, "I/O Error Flag", ReturnValue.IO_Error)
+    /* Since we could not get the memory, we can not complete the operation.  Abort. */
+    *Error_Code = LVM_ENGINE_OUT_OF_MEMORY;
 
-  LOG_EVENT2("Returning the following values:", "Unusable Flag", ReturnValue.Unusable, "Is Big Floppy Flag", ReturnValue.Is_Big_Floppy )
+    return ReturnValue;
 
-  API_EXIT( "Get_Drive_Status" )
+  }
 
-  /* Indicate success and return. */
+  for ( Index = 0; Index < Count; Index++ )
+  {
+
+    if ( Drive_Handles != NULL )
+    {
+
+      /* Is the drive handle valid? */
+      Translate_Handle( Drive_Handles[Index], &Object, &ObjectTag, Error_Code );
+      if ( ( *Error_Code != HANDLE_MANAGER_NO_ERROR ) || ( ObjectTag != DISK_DRIVE_DATA_TAG ) )
+      {
+
+        LOG_ERROR1("Bad drive handle!", "Index", Index)
+
+        /* We have a bad handle.  Abort. */
+        *Error_Code = LVM_ENGINE_BAD_HANDLE;
+        break;
+
+      }
+
+      Drive_Data = (Disk_Drive_Data *) Object;
+
+    }
+    else
+      Drive_Data = &( DriveArray[Index] );
+
+    Set_Drive_Information_Record( &( ReturnValue.Drive_Information_Data[Index] ), Drive_Data, Error_Code );
+    if ( *Error_Code != LVM_ENGINE_NO_ERROR )
+      break;
+
+  }
+
+  /* Did we fail part way through? */
+  if ( *Error_Code != LVM_ENGINE_NO_ERROR )
+  {
+
+    free( ReturnValue.Drive_Information_Data );
+    ReturnValue.Drive_Information_Data = NULL;
+
+    API_EXIT( "Get_Drive_Status_Array" )
+
+    return ReturnValue;
+
+  }
+
+  ReturnValue.Count = Count;
+
+  LOG_EVENT1("Returning status for X drives.", "X", ReturnValue.Count)
+
+  API_EXIT( "Get_Drive_Status_Array" )
+
+  /* Indicate success. */
   *Error_Code = LVM_ENGINE_NO_ERROR;
 
   return ReturnValue;
@@ -3414,6 +3618,50 @@ void Set_Free_Space_Threshold ( CARDINAL32  Min_Sectors )
 }
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Set_Partition_Alignment                          */
+/*                                                                   */
+/*   Descriptive Name: This function tells the LVM Engine what       */
+/*                     boundary to align partitions on when they are */
+/*                     created using the Aligned allocation          */
+/*                     algorithm.  The engine defaults to            */
+/*                     DEFAULT_PARTITION_ALIGNMENT, which is 2048    */
+/*                     sectors (1 MB).                               */
+/*                                                                   */
+/*   Input: CARDINAL32 Alignment_Sectors - The alignment, in sectors.*/
+/*                                         If this is 0, then the    */
+/*                                         default alignment is used.*/
+/*                                                                   */
+/*   Output: None.                                                   */
+/*                                                                   */
+/*   Error Handling: None required.                                  */
+/*                                                                   */
+/*   Side Effects: None.                                             */
+/*                                                                   */
+/*   Notes: None.                                                    */
+/*                                                                   */
+/*********************************************************************/
+void Set_Partition_Alignment ( CARDINAL32  Alignment_Sectors )
+{
+
+  API_ENTRY( "Set_Partition_Alignment" )
+
+  /* An alignment of 0 restores the default. */
+  if ( Alignment_Sectors == 0 )
+    Partition_Alignment = DEFAULT_PARTITION_ALIGNMENT;
+  else
+    Partition_Alignment = Alignment_Sectors;
+
+  LOG_EVENT1("The Partition Alignment has been changed.","The new Partition Alignment", Partition_Alignment)
+
+  API_EXIT( "Set_Partition_Alignment" )
+
+  return;
+
+}
+
+
 /*********************************************************************/
 /*                                                                   */
 /*   Function Name: Get_Partitions                                   */
@@ -4724,9 +4972,13 @@ void Read_Sectors ( CARDINAL32          Drive_Number,
 /*                                                                   */
 /*   Error Handling: *Error will be > 0 if an error occurs.          */
 /*                                                                   */
-/*   Side Effects: Data may be written to disk.                      */
+/*   Side Effects: Data may be written to disk.  Any other sectors   */
+/*                 on the drive which are waiting in the sector      */
+/*                 cache are written to disk as well.                */
 /*                                                                   */
-/*   Notes:  None.                                                   */
+/*   Notes:  The data is written through the sector cache, which is  */
+/*           then flushed, so that the data is on the disk before    */
+/*           this function returns.                                  */
 /*                                                                   */
 /*********************************************************************/
 void Write_Sectors ( CARDINAL32          Drive_Number,
@@ -4758,11 +5010,30 @@ void Write_Sectors ( CARDINAL32          Drive_Number,
 
   WriteSectors(Drive_Number, Starting_Sector, Sectors_To_Write, Buffer, Error);
 
+  /* The Partition Manager can no longer be sure what is in any of its metadata sectors that were just written. */
+  Forget_Metadata_Sectors(Drive_Number - 1, Starting_Sector, Sectors_To_Write);
+
   if ( *Error != DISKIO_NO_ERROR )
   {
 
     LOG_ERROR1("WriteSectors failed!","Error code", *Error)
 
+  }
+  else
+  {
+
+    /* WriteSectors may have left the data in the sector cache.  Our caller expects it to be on the disk when we return, so flush the
+       cache for the drive now, rather than leaving the data to be written by Commit_Changes or CloseDrives, where a failure could
+       not be reported to our caller.                                                                                              */
+    FlushSectorCache(Drive_Number, Error);
+
+    if ( *Error != DISKIO_NO_ERROR )
+    {
+
+      LOG_ERROR1("FlushSectorCache failed!","Error code", *Error)
+
+    }
+
   }
 
   /* Translate the error code into an LVM Engine error code. */
@@ -4911,115 +5182,109 @@ void _System Rediscover_PRMs( CARDINAL32 * Error_Code )
 
 /*********************************************************************/
 /*                                                                   */
-/*   Function Name: DetermineFreeSpace                               */
+/*   Function Name: Set_Drive_Information_Record                     */
 /*                                                                   */
-/*   Descriptive Name: This function is designed to be used with the */
-/*                     ForEachItem function in DLIST.  It should     */
-/*                     only be used on lists containing items of     */
-/*                     type Partition_Data.  Its purpose is to scan  */
-/*                     a list of Partition_Data items and add up the */
-/*                     total number of sectors residing in           */
-/*                     Partition_Data entries marked as FreeSpace.   */
-/*                     It also keeps the size of the largest         */
-/*                     Partition_Data entry marked as FreeSpace.     */
+/*   Descriptive Name: Fills in a Drive_Information_Record from the  */
+/*                     Disk_Drive_Data for a drive.                  */
 /*                                                                   */
-/*   Input: ADDRESS Object : This is the address of an entry in the  */
-/*                           DLIST being scanned.  It must point to  */
-/*                           item of type Partition_Data for this    */
-/*                           function to work correctly.             */
-/*          TAG ObjectTag : This is the TAG value assigned to Object.*/
-/*                          For this function to work, ObjectTag     */
-/*                          should be equal to PARTITION_DATA_TAG.   */
-/*          CARDINAL32 ObjectSize : This is the size, in bytes, of   */
-/*                                  the item pointed to by Object.   */
-/*                                  This value is not currently used */
-/*                                  by this function.                */
-/*          ADDRESS Parameters : This is the address of an item of   */
-/*                               type Drive_Information_Record.  This*/
-/*                               function will manipulate the        */
-/*                               Largest_Free_Block_Of_Sectors and   */
-/*                               Total_Available_Sectors fields of   */
-/*                               the Drive_Information_Record at the */
-/*                               address specified by Parameters.    */
-/*                               These fields should be set to 0     */
-/*                               before the first call to this       */
-/*                               function.                           */
+/*   Input: Drive_Information_Record * Drive_Information - The record*/
+/*                                                      to fill in.  */
+/*          Disk_Drive_Data * Drive_Data - The drive whose           */
+/*                                         information is to be      */
+/*                                         placed in                 */
+/*                                         Drive_Information.        */
+/*          CARDINAL32 * Error_Code - The address of a CARDINAL32 in */
+/*                                    which to store an error code   */
+/*                                    should an error occur.         */
 /*                                                                   */
-/*   Output: The Largest_Free_Block_Of_Sectors and                   */
-/*           Total_Available_Sectors fields of the                   */
-/*           Drive_Information_Record pointed to by Parameters may   */
-/*           be updated, if appropriate.                             */
+/*   Output: If successful, *Drive_Information is filled in and      */
+/*           *Error_Code will be LVM_ENGINE_NO_ERROR.                */
 /*                                                                   */
-/*   Error Handling: If an error occurs, *Error will be set to a     */
-/*                   non-zero value.                                 */
+/*   Error Handling: If the partition list of the drive holds        */
+/*                   something other than Partition_Data, then       */
+/*                   *Error_Code will be LVM_ENGINE_INTERNAL_ERROR   */
+/*                   and the free space counts in *Drive_Information */
+/*                   will be 0.                                      */
 /*                                                                   */
 /*   Side Effects:  None.                                            */
 /*                                                                   */
-/*   Notes:  None.                                                   */
+/*   Notes:  Used by Get_Drive_Status and Get_Drive_Status_Array.    */
 /*                                                                   */
 /*********************************************************************/
-static void _System DetermineFreeSpace(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS ObjectHandle, ADDRESS Parameters, CARDINAL32 * Error)
+static void Set_Drive_Information_Record( Drive_Information_Record * Drive_Information, Disk_Drive_Data * Drive_Data, CARDINAL32 * Error_Code )
 {
 
-  /* Declare a local variable so that we can access our parameters without having to typecast each time. */
-  Drive_Information_Record * ReturnValue = (Drive_Information_Record * ) Parameters;
+  ADDRESS                    Partition_Handle; /* Used to walk the Partitions list of the drive. */
+  Partition_Data *           PartitionRecord;  /* Used to walk the Partitions list of the drive. */
 
-  /* Declare a local variable so that we can access the Partition_Data without having to typecast each time. */
-  Partition_Data *           PartitionRecord = (Partition_Data *) Object;
+  FUNCTION_ENTRY( "Set_Drive_Information_Record" )
 
-  FUNCTION_ENTRY("DetermineFreeSpace")
+  Drive_Information->Total_Available_Sectors = 0;
+  Drive_Information->Largest_Free_Block_Of_Sectors = 0;
+
+  /* To get the Largest_Free_Block_Of_Sectors and the Total_Available_Sectors, we must run the list of partitions for the drive and determine these values. */
+  DLIST_FOREACH( Drive_Data->Partitions, Partition_Handle )
+  {
 
 #ifdef DEBUG
 
 #ifdef PARANOID
 
-  assert( ( ObjectTag == PARTITION_DATA_TAG ) && ( ObjectSize == sizeof(Partition_Data) ) );
+    assert( ( DLIST_HANDLE_TAG( Partition_Handle ) == PARTITION_DATA_TAG ) && ( DLIST_HANDLE_SIZE( Partition_Handle ) == sizeof(Partition_Data) ) );
 
 #else
 
-  /* Is Object what we think it should be? */
-  if ( ( ObjectTag != PARTITION_DATA_TAG ) || ( ObjectSize != sizeof( Partition_Data ) ) )
-  {
+    /* Is this item what we think it should be? */
+    if ( ( DLIST_HANDLE_TAG( Partition_Handle ) != PARTITION_DATA_TAG ) || ( DLIST_HANDLE_SIZE( Partition_Handle ) != sizeof(Partition_Data) ) )
+    {
 
-    LOG_ERROR2("Unexpected Object Tag or Object Size!", "Object Tag", ObjectTag, "Object Size", ObjectSize)
+      LOG_ERROR2("Unexpected Object Tag or Object Size!", "Object Tag", DLIST_HANDLE_TAG( Partition_Handle ), "Object Size", DLIST_HANDLE_SIZE( Partition_Handle ))
 
-    FUNCTION_EXIT("DetermineFreeSpace")
+      FUNCTION_EXIT( "Set_Drive_Information_Record" )
 
-    /* Object's TAG is not what we expected!  Abort! */
-    *Error = LVM_ENGINE_INTERNAL_ERROR;
+      /* Indicate an internal error! */
+      *Error_Code = LVM_ENGINE_INTERNAL_ERROR;
 
-    return;
+      /* Set the fields modified to 0 so that we return all 0's in *Drive_Information. */
+      Drive_Information->Largest_Free_Block_Of_Sectors = 0;
+      Drive_Information->Total_Available_Sectors = 0;
 
-  }
+      /* Return to caller. */
+      return;
 
-#endif
+    }
 
 #endif
 
-  /* Well, Object has the correct TAG so we will assume that it points to an item of type Partition_Data. */
+#endif
 
-  /* Does this partition record represent free space? */
-  if ( PartitionRecord->Partition_Type == FreeSpace )
-  {
+    PartitionRecord = (Partition_Data *) DLIST_HANDLE_OBJECT( Partition_Handle );
 
-    /* We are in business!  Is the size of this partition greater than any we have seen before? */
-    if ( ReturnValue->Largest_Free_Block_Of_Sectors < PartitionRecord->Partition_Size )
+    /* Does this partition record represent free space? */
+    if ( PartitionRecord->Partition_Type == FreeSpace )
     {
 
-      /* This is the biggest we have seen so far!  Save it. */
-      ReturnValue->Largest_Free_Block_Of_Sectors = PartitionRecord->Partition_Size;
+      /* Is the size of this block of free space greater than any we have seen before? */
+      if ( Drive_Information->Largest_Free_Block_Of_Sectors < PartitionRecord->Partition_Size )
+        Drive_Information->Largest_Free_Block_Of_Sectors = PartitionRecord->Partition_Size;
 
-    }
+      /* Add this block to the count of total free space on the drive. */
+      Drive_Information->Total_Available_Sectors += PartitionRecord->Partition_Size;
 
-    /* Add this partition to the count of total free space on the drive. */
-    ReturnValue->Total_Available_Sectors += PartitionRecord->Partition_Size;
+    }
 
   }
 
-  FUNCTION_EXIT("DetermineFreeSpace")
+  /* Copy the remaining data from the DriveArray to *Drive_Information. */
+  strncpy( Drive_Information->Drive_Name , Drive_Data->Drive_Name, DISK_NAME_SIZE );
+  Drive_Information->Corrupt_Partition_Table = Drive_Data->Corrupt;
+  Drive_Information->IO_Error = Drive_Data->IO_Error;
+  Drive_Information->Unusable = Drive_Data->Unusable;
+  Drive_Information->Is_Big_Floppy = Drive_Data->Is_Big_Floppy;
 
-  /* Indicate success and leave. */
-  *Error = DLIST_SUCCESS;
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+
+  FUNCTION_EXIT( "Set_Drive_Information_Record" )
 
   return;
 
@@ -5398,6 +5663,9 @@ static void _System Overwrite_Sectors(ADDRESS Object, TAG ObjectTag, CARDINAL32
   /* Overwrite the specified sector. */
   WriteSectors(Sector_Data->Drive_Index + 1, Sector_Data->Sector_ID, 1, &Kill_Sector, Error);
 
+  /* If the Partition Manager has a copy of this sector, it is no longer what is on disk. */
+  Forget_Metadata_Sectors(Sector_Data->Drive_Index, Sector_Data->Sector_ID, 1);
+
   /* If there was an I/O error, flag it in the DriveArray. */
   if ( Error != DISKIO_NO_ERROR )
   {
@@ -5519,6 +5787,363 @@ BOOLEAN _System Valid_Signature_Sector( Partition_Data * PartitionRecord, LVM_Si
 }
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Validate_Feature_Sectors                         */
+/*                                                                   */
+/*   Descriptive Name: Checks the signature, CRC and sequence number */
+/*                     of each sector in a multi-sector table of     */
+/*                     feature data, such as a BBR table or a Drive  */
+/*                     Linking link table.                           */
+/*                                                                   */
+/*   Input: ADDRESS Buffer : The sectors to check.                   */
+/*          CARDINAL32 Sector_Count : The number of sectors in       */
+/*                                    Buffer.                        */
+/*          CARDINAL32 First_Signature : The signature expected in   */
+/*                                       the first sector.           */
+/*          CARDINAL32 Signature : The signature expected in all     */
+/*                                 other sectors.                    */
+/*          BYTE * Valid_Sectors : If not NULL, a bitmap with at     */
+/*                                 least ( Sector_Count + 7 ) / 8    */
+/*                                 bytes.  Bit ( n % 8 ) of byte     */
+/*                                 ( n / 8 ) is set if sector n is   */
+/*                                 valid, and cleared otherwise.     */
+/*                                                                   */
+/*   Output: The number of valid sectors.  The table is valid if     */
+/*           this is equal to Sector_Count.                          */
+/*                                                                   */
+/*   Error Handling: None.                                           */
+/*                                                                   */
+/*   Side Effects:  None.  Unlike the checks this replaces, the CRC  */
+/*                  field of each sector is left untouched.          */
+/*                                                                   */
+/*   Notes:  Each sector must begin with a 32 bit signature, a 32    */
+/*           bit CRC and a 32 bit sequence number, in that order.    */
+/*           The CRC of a sector is calculated with its CRC field set*/
+/*           to 0.  A sector is valid if its signature and CRC are   */
+/*           correct and its sequence number matches that of the     */
+/*           first sector.                                           */
+/*                                                                   */
+/*********************************************************************/
+CARDINAL32 _System Validate_Feature_Sectors( ADDRESS     Buffer,
+                                             CARDINAL32  Sector_Count,
+                                             CARDINAL32  First_Signature,
+                                             CARDINAL32  Signature,
+                                             BYTE *      Valid_Sectors )
+{
+
+  Feature_Sector_Header *  Sector;                  /* The sector being checked. */
+  CARDINAL32               Sequence_Number;         /* The sequence number of the first sector. */
+  CARDINAL32               Calculated_CRC;
+  CARDINAL32               Zero_CRC = 0;            /* What the CRC field holds when the CRC is calculated. */
+  CARDINAL32               Valid_Count = 0;
+  CARDINAL32               Index;
+
+  FUNCTION_ENTRY("Validate_Feature_Sectors")
+
+  if ( Valid_Sectors != NULL )
+    memset(Valid_Sectors, 0, ( Sector_Count + 7 ) / 8 );
+
+  if ( Sector_Count == 0 )
+  {
+
+    FUNCTION_EXIT("Validate_Feature_Sectors")
+
+    return 0;
+
+  }
+
+  Sequence_Number = ( (Feature_Sector_Header *) Buffer )->Sequence_Number;
+
+  for ( Index = 0; Index < Sector_Count; Index++ )
+  {
+
+    Sector = (Feature_Sector_Header *) ( (BYTE *) Buffer + Index * BYTES_PER_SECTOR );
+
+    if ( Sector->Signature != ( Index == 0 ? First_Signature : Signature ) )
+      continue;
+
+    if ( Sector->Sequence_Number != Sequence_Number )
+      continue;
+
+    /* Calculate the CRC of the sector as it is, then patch the result to what it would be with the CRC field set to 0.  This avoids
+       having to modify the sector.                                                                                                   */
+    Calculated_CRC = CalculateCRC( INITIAL_CRC, Sector, BYTES_PER_SECTOR);
+    Calculated_CRC = PatchCRC( Calculated_CRC, BYTES_PER_SECTOR, offsetof(Feature_Sector_Header, CRC), &(Sector->CRC), &Zero_CRC, sizeof(CARDINAL32) );
+
+    if ( Calculated_CRC != Sector->CRC )
+      continue;
+
+    Valid_Count++;
+
+    if ( Valid_Sectors != NULL )
+      Valid_Sectors[ Index / 8 ] |= (BYTE) ( 1 << ( Index % 8 ) );
+
+  }
+
+  FUNCTION_EXIT("Validate_Feature_Sectors")
+
+  return Valid_Count;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Transfer_Segments                                */
+/*                                                                   */
+/*   Descriptive Name: Reads or writes a set of pieces of a request, */
+/*                     each on a partition of an aggregate, with the */
+/*                     pieces on different drives in progress at the */
+/*                     same time.                                    */
+/*                                                                   */
+/*   Input: Segment_Transfer * Segments : The pieces to transfer.    */
+/*          CARDINAL32 Segment_Count : The number of entries in      */
+/*                                     Segments.                     */
+/*          BOOLEAN Write : TRUE to write the pieces, FALSE to read  */
+/*                          them.                                    */
+/*          CARDINAL32 * Error_Code : The address of a CARDINAL32 in */
+/*                                    which to store an error code   */
+/*                                    should an error occur.         */
+/*                                                                   */
+/*   Output: The Error_Code field of each entry in Segments holds the*/
+/*           result for that piece.  *Error_Code is                  */
+/*           LVM_ENGINE_NO_ERROR if every piece was transferred, and */
+/*           the error of the first piece which failed otherwise.    */
+/*                                                                   */
+/*   Error Handling: A failure of one piece does not stop the others.*/
+/*                                                                   */
+/*   Side Effects:  Data may be read from or written to disk.        */
+/*                                                                   */
+/*   Notes:  The pieces which can be started without waiting are     */
+/*           started first, then the rest are done one at a time with*/
+/*           the Read or Write function of their partition while the */
+/*           first group is in progress.  Only the requests started  */
+/*           here are reaped here, and all of them are reaped before */
+/*           this function returns.                                  */
+/*                                                                   */
+/*********************************************************************/
+void _System Transfer_Segments( Segment_Transfer *  Segments,
+                                CARDINAL32          Segment_Count,
+                                BOOLEAN             Write,
+                                CARDINAL32 *        Error_Code )
+{
+
+  Sector_IO_Request *          Requests = NULL;    /* One per piece, for the pieces which are started without waiting. */
+  Sector_IO_Request *          Request;            /* The request returned by ReapSectorIO. */
+  Segment_Transfer *           Segment;            /* The piece being worked on. */
+  Plugin_Function_Table_V1 *   Function_Table;     /* The function table of the top layer on the partition for a piece. */
+  CARDINAL32                   Index;              /* Used to walk Segments and Requests. */
+  CARDINAL32                   Outstanding = 0;    /* The number of pieces started but not yet reaped. */
+  CARDINAL32                   Reap_Error;         /* Used to hold the error return code from ReapSectorIO. */
+  BOOLEAN                      Started;            /* Set to TRUE if a piece was started without waiting. */
+
+  FUNCTION_ENTRY("Transfer_Segments")
+
+  /* Starting a single piece without waiting for it gains nothing. */
+  if ( Segment_Count > 1 )
+    Requests = (Sector_IO_Request *) malloc( Segment_Count * sizeof(Sector_IO_Request) );
+
+  /* Start every piece that the layer below can start without waiting.  A request whose User_Data is NULL is not in progress. */
+  for ( Index = 0; Index < Segment_Count; Index++ )
+  {
+
+    Segment = &(Segments[Index]);
+    Segment->Error_Code = LVM_ENGINE_NO_ERROR;
+
+    if ( Requests == NULL )
+      continue;
+
+    Requests[Index].User_Data = NULL;
+
+    if ( ( Segment->PartitionRecord == NULL ) || ( Segment->PartitionRecord->Feature_Data == NULL ) || ( Segment->Sector_Count == 0 ) )
+      continue;
+
+    Function_Table = (Plugin_Function_Table_V1 *) Segment->PartitionRecord->Feature_Data->Function_Table;
+
+    Requests[Index].Starting_Sector = Segment->Starting_Sector;
+    Requests[Index].Sector_Count = Segment->Sector_Count;
+    Requests[Index].Buffer = Segment->Buffer;
+    Requests[Index].Write = Write;
+    Requests[Index].User_Data = Segment;
+
+    if ( Function_Table == (Plugin_Function_Table_V1 *) PassThru_Function_Table )
+      Started = Pass_Thru_Start_Transfer( Segment->PartitionRecord, &(Requests[Index]) );
+    else if ( Function_Table == (Plugin_Function_Table_V1 *) BBR_Function_Table )
+      Started = BBR_Start_Transfer( Segment->PartitionRecord, &(Requests[Index]) );
+    else
+      Started = FALSE;
+
+    if ( Started )
+      Outstanding++;
+    else
+      Requests[Index].User_Data = NULL;
+
+  }
+
+  /* Do the remaining pieces while the ones just started are in progress. */
+  for ( Index = 0; Index < Segment_Count; Index++ )
+  {
+
+    if ( ( Requests == NULL ) || ( Requests[Index].User_Data == NULL ) )
+      Transfer_Segment( &(Segments[Index]), Write );
+
+  }
+
+  /* Collect the pieces that were started. */
+  while ( Outstanding > 0 )
+  {
+
+    Request = ReapSectorIO(TRUE, &Reap_Error);
+
+    if ( Request == NULL )
+    {
+
+      /* If DiskIO has nothing in progress, then our pieces are not in progress either.  They are redone below. */
+      if ( ( Reap_Error == DISKIO_NO_IO_OUTSTANDING ) || ( Reap_Error == DISKIO_DRIVES_NOT_OPEN ) )
+      {
+
+        LOG_ERROR1("ReapSectorIO lost requests started by Transfer_Segments.", "Error code", Reap_Error)
+
+        break;
+
+      }
+
+      continue;
+
+    }
+
+    /* Only use requests that we started. */
+    for ( Index = 0; Index < Segment_Count; Index++ )
+    {
+
+      if ( &(Requests[Index]) == Request )
+        break;
+
+    }
+
+    if ( ( Index == Segment_Count ) || ( Request->User_Data == NULL ) )
+    {
+
+      LOG_ERROR("Transfer_Segments reaped a request which it did not start!  Ignoring it.")
+
+      continue;
+
+    }
+
+    Outstanding--;
+
+    Segment = (Segment_Transfer *) Request->User_Data;
+    Request->User_Data = NULL;
+
+    /* Let the layers on the partition handle, and report, the failure the same way as they would for any other request. */
+    if ( Request->Error != DISKIO_NO_ERROR )
+      Transfer_Segment( Segment, Write );
+
+  }
+
+  /* Anything still marked as in progress was lost by ReapSectorIO, so do it the slow way. */
+  for ( Index = 0; ( Outstanding > 0 ) && ( Index < Segment_Count ); Index++ )
+  {
+
+    if ( Requests[Index].User_Data != NULL )
+    {
+
+      Requests[Index].User_Data = NULL;
+      Outstanding--;
+
+      Transfer_Segment( &(Segments[Index]), Write );
+
+    }
+
+  }
+
+  free(Requests);
+
+  /* Combine the results. */
+  *Error_Code = LVM_ENGINE_NO_ERROR;
+  for ( Index = 0; Index < Segment_Count; Index++ )
+  {
+
+    if ( Segments[Index].Error_Code != LVM_ENGINE_NO_ERROR )
+    {
+
+      *Error_Code = Segments[Index].Error_Code;
+      break;
+
+    }
+
+  }
+
+  FUNCTION_EXIT("Transfer_Segments")
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Transfer_Segment                                 */
+/*                                                                   */
+/*   Descriptive Name: Reads or writes one piece for                 */
+/*                     Transfer_Segments using the Read or Write     */
+/*                     function of its partition.                    */
+/*                                                                   */
+/*   Input: Segment_Transfer * Segment : The piece to transfer.      */
+/*          BOOLEAN Write : TRUE to write the piece, FALSE to read   */
+/*                          it.                                      */
+/*                                                                   */
+/*   Output: Segment->Error_Code holds the result.                   */
+/*                                                                   */
+/*   Error Handling: A partition without a function table fails with */
+/*                   LVM_ENGINE_BAD_PARTITION.                       */
+/*                                                                   */
+/*   Side Effects:  Data may be read from or written to disk.        */
+/*                                                                   */
+/*   Notes:  None.                                                   */
+/*                                                                   */
+/*********************************************************************/
+static void Transfer_Segment( Segment_Transfer * Segment, BOOLEAN Write )
+{
+
+  Plugin_Function_Table_V1 *   Function_Table;
+
+  if ( ( Segment->PartitionRecord == NULL ) ||
+       ( Segment->PartitionRecord->Feature_Data == NULL ) ||
+       ( Segment->PartitionRecord->Feature_Data->Function_Table == NULL )
+     )
+  {
+
+    LOG_ERROR("Transfer_Segments was given a partition with bad feature data!")
+
+    Segment->Error_Code = LVM_ENGINE_BAD_PARTITION;
+
+    return;
+
+  }
+
+  if ( Segment->Sector_Count == 0 )
+  {
+
+    Segment->Error_Code = LVM_ENGINE_NO_ERROR;
+
+    return;
+
+  }
+
+  Function_Table = (Plugin_Function_Table_V1 *) Segment->PartitionRecord->Feature_Data->Function_Table;
+
+  if ( Write )
+    Function_Table->Write(Segment->PartitionRecord, Segment->Starting_Sector, Segment->Sector_Count, Segment->Buffer, &(Segment->Error_Code) );
+  else
+    Function_Table->Read(Segment->PartitionRecord, Segment->Starting_Sector, Segment->Sector_Count, Segment->Buffer, &(Segment->Error_Code) );
+
+  return;
+
+}
+
+
 /*********************************************************************/
 /*                                                                   */
 /*   Function Name: Set_Java_Call_Back                               */
@@ -7815,6 +8440,103 @@ void _System Find_Feature_Given_ID(ADDRESS Object, TAG ObjectTag, CARDINAL32 Obj
 }
 
 
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Find_Feature_By_ID                               */
+/*                                                                   */
+/*   Descriptive Name: Finds the function table of the feature with  */
+/*                     a given feature ID.                           */
+/*                                                                   */
+/*   Input: Find_Feature_Data_Record * Search_Data - The Feature_ID  */
+/*                                     field holds the feature ID to */
+/*                                     look for.                     */
+/*          CARDINAL32 * Error - The address of a variable to hold   */
+/*                               the error return code.              */
+/*                                                                   */
+/*   Output: Search_Data->Function_Table is set to the function      */
+/*           table of the feature, or to NULL if there is no feature */
+/*           with the specified ID.  *Error is set to DLIST_SUCCESS  */
+/*           unless a DLIST error occurred.                          */
+/*                                                                   */
+/*   Error Handling: If a DLIST error occurs, *Error will be set to  */
+/*                   the DLIST error code.                           */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  This gives the same results as using                    */
+/*           Find_Feature_Given_ID with ForEachItem on the           */
+/*           Available_Features list, but uses the index of the list */
+/*           instead of walking it.                                  */
+/*                                                                   */
+/*********************************************************************/
+void Find_Feature_By_ID( Find_Feature_Data_Record * Search_Data, CARDINAL32 * Error )
+{
+
+  ADDRESS                    Feature_Handle;
+  LVM_Plugin_Data_Record *   Plugin_Data;
+
+  FUNCTION_ENTRY("Find_Feature_By_ID")
+
+  Search_Data->Function_Table = NULL;
+
+  Feature_Handle = FindByKey(Available_Features, &(Search_Data->Feature_ID), sizeof(CARDINAL32), Error);
+  if ( ( *Error == DLIST_SUCCESS ) && ( Feature_Handle != NULL ) )
+  {
+
+    Plugin_Data = (LVM_Plugin_Data_Record *) GetObject(Available_Features, sizeof(LVM_Plugin_Data_Record), LVM_PLUGIN_DATA_RECORD_TAG, Feature_Handle, FALSE, Error);
+    if ( *Error == DLIST_SUCCESS )
+      Search_Data->Function_Table = (ADDRESS) Plugin_Data->Function_Table;
+
+  }
+
+  FUNCTION_EXIT("Find_Feature_By_ID")
+
+  return;
+
+}
+
+
+/*********************************************************************/
+/*                                                                   */
+/*   Function Name: Feature_ID_Key                                   */
+/*                                                                   */
+/*   Descriptive Name: Used by the index of the Available_Features   */
+/*                     list to get the key of an entry in the list.  */
+/*                                                                   */
+/*   Input: ADDRESS Object - The LVM_Plugin_Data_Record.             */
+/*          TAG ObjectTag - The tag of the record.                   */
+/*          CARDINAL32 ObjectSize - The size of the record.          */
+/*          ADDRESS * Key - Set to the address of the key.           */
+/*          CARDINAL32 * KeySize - Set to the size of the key.       */
+/*                                                                   */
+/*   Output: TRUE, with the feature ID of the plugin as the key, if  */
+/*           Object is an LVM_Plugin_Data_Record.  FALSE otherwise.  */
+/*                                                                   */
+/*   Error Handling: Records of the wrong type are not indexed.      */
+/*                                                                   */
+/*   Side Effects:  None.                                            */
+/*                                                                   */
+/*   Notes:  The feature ID lives in the function table of the       */
+/*           plugin, which does not change while the plugin is       */
+/*           loaded.                                                 */
+/*                                                                   */
+/*********************************************************************/
+static BOOLEAN _System Feature_ID_Key(ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, ADDRESS * Key, CARDINAL32 * KeySize)
+{
+
+  LVM_Plugin_Data_Record *   Plugin_Data = (LVM_Plugin_Data_Record *) Object;
+
+  if ( ( ObjectTag != LVM_PLUGIN_DATA_RECORD_TAG ) || ( ObjectSize != sizeof(LVM_Plugin_Data_Record) ) )
+    return FALSE;
+
+  *Key = &(Plugin_Data->Function_Table->Feature_ID->ID);
+  *KeySize = sizeof(CARDINAL32);
+
+  return TRUE;
+
+}
+
+
 
 /*********************************************************************/
 /*                                                                   */
@@ -8171,6 +8893,8 @@ static BOOLEAN Load_Plugins(CARDINAL32 * Error_Code)
   Services->PruneList = &PruneList;
   Services->AppendList = &AppendList;
   Services->TransferItem = &TransferItem;
+  Services->Validate_Feature_Sectors = &Validate_Feature_Sectors;
+  Services->Transfer_Segments = &Transfer_Segments;
 #ifdef DEBUG
   Services->CheckListIntegrity = &CheckListIntegrity;
 #endif
@@ -9008,34 +9732,41 @@ static INTEGER32 _System Sort_Plugins(ADDRESS Object1, TAG Object1Tag, ADDRESS O
 
 /*********************************************************************/
 /*                                                                   */
-/*   Function Name:                                                  */
+/*   Function Name: Feature_Sequence_Number_Key                      */
 /*                                                                   */
-/*   Descriptive Name:                                               */
+/*   Descriptive Name: Returns the sequence number of a feature as a */
+/*                     sort key for SortListByKey.                   */
 /*                                                                   */
-/*   Input:                                                          */
+/*   Input: ADDRESS Object : The Feature_Application_Data of the     */
+/*                           feature.                                */
+/*          TAG ObjectTag : Should be FEATURE_APPLICATION_DATA_TAG.  */
+/*          CARDINAL32 ObjectSize : Not used.                        */
+/*          CARDINAL32 * Error : The address of a variable to hold   */
+/*                               the error return code.              */
 /*                                                                   */
-/*   Output:                                                         */
+/*   Output: The Feature_Sequence_Number of the feature.             */
 /*                                                                   */
-/*   Error Handling:                                                 */
+/*   Error Handling: *Error is set to DLIST_CORRUPTED if ObjectTag   */
+/*                   is not what it should be.                       */
 /*                                                                   */
 /*   Side Effects:  None.                                            */
 /*                                                                   */
-/*   Notes:  None.                                                   */
+/*   Notes:  Used to put a features list in the order in which the   */
+/*           features should be applied.                             */
 /*                                                                   */
 /*********************************************************************/
-INTEGER32 _System Sort_By_Feature_Sequence_Number( ADDRESS Object1, TAG Object1Tag, ADDRESS Object2, TAG Object2Tag, CARDINAL32 * Error)
+CARDINAL32 _System Feature_Sequence_Number_Key( ADDRESS Object, TAG ObjectTag, CARDINAL32 ObjectSize, CARDINAL32 * Error)
 {
 
-  /* Declare local variables so that we can access the Feature_Application_Data objects without having to typecast each time. */
-  Feature_Application_Data *    Feature1 = (Feature_Application_Data *) Object1;
-  Feature_Application_Data *    Feature2 = (Feature_Application_Data *) Object2;
+  /* Declare a local variable so that we can access the Feature_Application_Data object without having to typecast each time. */
+  Feature_Application_Data *    Feature = (Feature_Application_Data *) Object;
 
-  FUNCTION_ENTRY("Sort_By_Feature_Sequence_Number")
+  FUNCTION_ENTRY("Feature_Sequence_Number_Key")
 
 #ifdef DEBUG
 
-  /* Are Object1 and Object2 what we think it should be? */
-  if ( ( Object1Tag != FEATURE_APPLICATION_DATA_TAG ) || ( Object2Tag != FEATURE_APPLICATION_DATA_TAG ) )
+  /* Is Object what we think it should be? */
+  if ( ObjectTag != FEATURE_APPLICATION_DATA_TAG )
   {
 
 
@@ -9045,9 +9776,9 @@ INTEGER32 _System Sort_By_Feature_Sequence_Number( ADDRESS Object1, TAG Object1T
 
 #endif
 
-    LOG_ERROR2("Invalid Object Tag detected!", "Object Tag1", Object1Tag, "Object Tag2", Object2Tag)
+    LOG_ERROR1("Invalid Object Tag detected!", "Object Tag", ObjectTag)
 
-    FUNCTION_EXIT("Sort_By_Feature_Sequence_Number")
+    FUNCTION_EXIT("Feature_Sequence_Number_Key")
 
     /* We have a TAG that is not what we expected!  Abort! */
     *Error = DLIST_CORRUPTED;
@@ -9061,33 +9792,9 @@ INTEGER32 _System Sort_By_Feature_Sequence_Number( ADDRESS Object1, TAG Object1T
   /* Assume success. */
   *Error = DLIST_SUCCESS;
 
-  /* Well, the Object Tags look OK, so lets get to it. */
-
-  /* Is Feature1 < Feature2? */
-  if ( Feature1->Feature_Sequence_Number < Feature2->Feature_Sequence_Number )
-  {
-
-    FUNCTION_EXIT("Sort_By_Feature_Sequence_Number")
-
-    return -1;
-
-  }
-
-  /* Is Feature1 > Feature2? */
-  if ( Feature1->Feature_Sequence_Number > Feature2->Feature_Sequence_Number )
-  {
-
-    FUNCTION_EXIT("Sort_By_Feature_Sequence_Number")
-
-    return 1;
-
-  }
-
-  /* They must be equal! */
-
-  FUNCTION_EXIT("Sort_By_Feature_Sequence_Number")
+  FUNCTION_EXIT("Feature_Sequence_Number_Key")
 
-  return 0;
+  return Feature->Feature_Sequence_Number;
 
 }
 
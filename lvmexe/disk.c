@@ -376,15 +376,17 @@ update_disk_lines ( void )
             largest;
     static
     bool    first_call = TRUE;
+    Drive_Information_Array     status;
     Drive_Information_Record    info;
     CARDINAL32                  error;
 
+    status = Get_Drive_Status_Array ( NULL, 0, &error );
+    if ( error  ||  status.Count != Total_disks ) {
+        Quit ( Cannot_get_disk_data );
+    }
+
     for ( disk = 0;  disk < Total_disks;  ++disk ) {
-        info = Get_Drive_Status ( Disk.Drive_Control_Data [disk].Drive_Handle,
-                                  &error );
-        if ( error ) {
-            Quit ( Cannot_get_disk_data );
-        }
+        info = status.Drive_Information_Data [disk];
         number = Disk.Drive_Control_Data [disk].Drive_Number;
         size = Disk.Drive_Control_Data [disk].Drive_Size / SECTORS_PER_MEG;
         total = info.Total_Available_Sectors / SECTORS_PER_MEG;
@@ -450,6 +452,10 @@ update_disk_lines ( void )
         }
     }
 
+    if ( status.Drive_Information_Data ) {
+        Free_Engine_Memory ( status.Drive_Information_Data );
+    }
+
     first_call = FALSE;
 }
 
@@ -874,6 +874,7 @@ update_volume_lines ( void )
     char    drive_string[VOLUME_DRIVE_WIDTH];
     uint    size;
     Volume_Control_Record       *memory;
+    Volume_Information_Array    status;
     Volume_Information_Record   info;
     CARDINAL32                  error;
 
@@ -896,13 +897,13 @@ update_volume_lines ( void )
         strncpy ( Volume_panel_text [ 0 ], No_volumes_defined, SCREEN_WIDTH );
     }
 
+    status = Get_Volume_Information_Array ( NULL, 0, &error );
+    if ( error  ||  status.Count != Total_volumes ) {
+        Quit ( Cannot_get_volume_data );
+    }
+
     for ( volume = 0;  volume < Total_volumes;  ++volume ) {
-        info = Get_Volume_Information (
-                            Volume.Volume_Control_Data [volume].Volume_Handle,
-                            &error );
-        if ( error ) {
-            Quit ( Cannot_get_volume_data );
-        }
+        info = status.Volume_Information_Data [volume];
         volume_name = info.Volume_Name;
         volume_type = ! info.Compatibility_Volume;
 
@@ -930,6 +931,10 @@ update_volume_lines ( void )
         update_partitions_lines ( volume );
     }
 
+    if ( status.Volume_Information_Data ) {
+        Free_Engine_Memory ( status.Volume_Information_Data );
+    }
+
     set_available_drive_letters ();
 
 }